@@ -37,6 +37,14 @@ inline constexpr string_view::string_view(const std::string &str) noexcept
 {
 }
 
+template <typename allocator_t>
+    requires(!std::same_as<allocator_t, std::allocator<char>>)
+inline constexpr string_view::string_view(
+    const std::basic_string<char, std::char_traits<char>, allocator_t> &str) noexcept
+    : str_{std::data(str), std::size(str)}
+{
+}
+
 inline string_view::string_view(const std::u8string &str)
     : str_{reinterpret_cast<const char *const>(std::data(str)), std::size(str)}
 {
@@ -0,0 +1,427 @@
+// Distributed under the BSD 2-Clause License - Copyright 2012-2023 Robin Degen
+
+#pragma once
+
+#include <algorithm>
+#include <functional>
+#include <vector>
+#include <initializer_list>
+#include <stdexcept>
+#include <concepts>
+#include <type_traits>
+#include <limits>
+#include <bit>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+
+namespace aeon::common
+{
+
+namespace internal
+{
+
+template <typename hash_type_t>
+concept transparent_hash = requires { typename hash_type_t::is_transparent; };
+
+template <typename lookup_key_t, typename key_type_t, typename hash_type_t>
+concept heterogeneous_lookup_key =
+    !std::same_as<std::remove_cvref_t<lookup_key_t>, key_type_t> && transparent_hash<hash_type_t> &&
+    std::invocable<const hash_type_t &, const lookup_key_t &> &&
+    requires(const key_type_t &key, const lookup_key_t &lookup) {
+        {
+            key == lookup
+        } -> std::convertible_to<bool>;
+    };
+
+} // namespace internal
+
+/*!
+ * An insertion ordered map, stored as a contiguous vector of key/value pairs like unordered_flatmap.
+ *
+ * Small maps are searched linearly. Once the map grows beyond index_threshold entries, an open addressing hash index
+ * (linear probing) is built on top of the vector, so that lookups no longer depend on the amount of entries.
+ * Iteration always happens in insertion order.
+ *
+ * When the hash type is transparent (defines is_transparent), lookups can be done with any type that can be hashed
+ * and compared with the key type (for example a string_view for string keys), without constructing a temporary key.
+ *
+ * The allocator is used for both the entries and the index. When used with a std::pmr::polymorphic_allocator, the
+ * memory resource is also passed on to values that are allocator aware.
+ *
+ * Keys must not be modified through iterators, since this would invalidate the index.
+ */
+template <typename key_type_t, typename value_type_t, typename hash_type_t = std::hash<key_type_t>,
+          typename allocator_type_t = std::allocator<std::pair<key_type_t, value_type_t>>>
+class indexed_flatmap final
+{
+public:
+    using key_type = key_type_t;
+    using value_type = value_type_t;
+    using hasher = hash_type_t;
+    using allocator_type = allocator_type_t;
+    using pair_type = std::pair<key_type, value_type>;
+    using map_type = std::vector<pair_type, allocator_type>;
+    using iterator = typename map_type::iterator;
+    using const_iterator = typename map_type::const_iterator;
+
+    /*!
+     * Maps with up to this amount of entries are searched linearly, which is faster than hashing for small maps.
+     */
+    static constexpr std::size_t index_threshold = 16;
+
+    indexed_flatmap() = default;
+
+    explicit indexed_flatmap(const allocator_type &allocator)
+        : map_{allocator}
+        , index_{allocator}
+    {
+    }
+
+    indexed_flatmap(std::initializer_list<pair_type> init, const allocator_type &allocator = allocator_type{})
+        : map_{allocator}
+        , index_{allocator}
+    {
+        for (auto &&val : init)
+        {
+            insert(std::move(val));
+        }
+    }
+
+    indexed_flatmap(const indexed_flatmap &other, const allocator_type &allocator)
+        : map_{other.map_, allocator}
+        , index_{other.index_, allocator}
+    {
+    }
+
+    indexed_flatmap(indexed_flatmap &&other, const allocator_type &allocator)
+        : map_{std::move(other.map_), allocator}
+        , index_{std::move(other.index_), allocator}
+    {
+    }
+
+    ~indexed_flatmap() = default;
+
+    indexed_flatmap(const indexed_flatmap &) = default;
+    auto operator=(const indexed_flatmap &) -> indexed_flatmap & = default;
+    indexed_flatmap(indexed_flatmap &&) noexcept = default;
+    auto operator=(indexed_flatmap &&) noexcept -> indexed_flatmap & = default;
+
+    [[nodiscard]] auto get_allocator() const noexcept -> allocator_type
+    {
+        return map_.get_allocator();
+    }
+
+    auto insert(key_type key, value_type value) -> iterator
+    {
+        return insert({std::move(key), std::move(value)});
+    }
+
+    auto emplace(key_type &&key, value_type &&value) -> iterator
+    {
+        return emplace({std::move(key), std::move(value)});
+    }
+
+    auto insert(pair_type pair) -> iterator
+    {
+        return emplace(std::move(pair));
+    }
+
+    auto emplace(pair_type &&pair) -> iterator
+    {
+        const auto index = find_index(pair.first);
+
+        if (index == std::size(map_))
+            return append(std::move(pair));
+
+        auto itr = std::begin(map_) + static_cast<typename map_type::difference_type>(index);
+        itr->second = std::move(pair.second);
+        return itr;
+    }
+
+    /*!
+     * Add a key/value pair to the end of the map without checking if the key already exists.
+     */
+    void push_back(const key_type &key, const value_type &value)
+    {
+        push_back({key, value});
+    }
+
+    void push_back(const pair_type &pair)
+    {
+        append(pair_type{pair});
+    }
+
+    [[nodiscard]] auto &at(const key_type &key)
+    {
+        return at_impl(*this, key);
+    }
+
+    [[nodiscard]] const auto &at(const key_type &key) const
+    {
+        return at_impl(*this, key);
+    }
+
+    template <internal::heterogeneous_lookup_key<key_type, hasher> lookup_key_t>
+    [[nodiscard]] auto &at(const lookup_key_t &key)
+    {
+        return at_impl(*this, key);
+    }
+
+    template <internal::heterogeneous_lookup_key<key_type, hasher> lookup_key_t>
+    [[nodiscard]] const auto &at(const lookup_key_t &key) const
+    {
+        return at_impl(*this, key);
+    }
+
+    auto &operator[](const key_type &key)
+    {
+        auto itr = find(key);
+
+        if (itr == std::end(map_))
+            itr = append({key, value_type{}});
+
+        return itr->second;
+    }
+
+    auto &operator[](key_type &&key)
+    {
+        auto itr = find(key);
+
+        if (itr == std::end(map_))
+            itr = append({std::move(key), value_type{}});
+
+        return itr->second;
+    }
+
+    [[nodiscard]] auto contains(const key_type &key) const noexcept -> bool
+    {
+        return find_index(key) != std::size(map_);
+    }
+
+    template <internal::heterogeneous_lookup_key<key_type, hasher> lookup_key_t>
+    [[nodiscard]] auto contains(const lookup_key_t &key) const noexcept -> bool
+    {
+        return find_index(key) != std::size(map_);
+    }
+
+    [[nodiscard]] auto find(const key_type &key) noexcept -> iterator
+    {
+        return std::begin(map_) + static_cast<typename map_type::difference_type>(find_index(key));
+    }
+
+    [[nodiscard]] auto find(const key_type &key) const noexcept -> const_iterator
+    {
+        return std::begin(map_) + static_cast<typename map_type::difference_type>(find_index(key));
+    }
+
+    template <internal::heterogeneous_lookup_key<key_type, hasher> lookup_key_t>
+    [[nodiscard]] auto find(const lookup_key_t &key) noexcept -> iterator
+    {
+        return std::begin(map_) + static_cast<typename map_type::difference_type>(find_index(key));
+    }
+
+    template <internal::heterogeneous_lookup_key<key_type, hasher> lookup_key_t>
+    [[nodiscard]] auto find(const lookup_key_t &key) const noexcept -> const_iterator
+    {
+        return std::begin(map_) + static_cast<typename map_type::difference_type>(find_index(key));
+    }
+
+    [[nodiscard]] auto begin() noexcept
+    {
+        return std::begin(map_);
+    }
+
+    [[nodiscard]] auto end() noexcept
+    {
+        return std::end(map_);
+    }
+
+    [[nodiscard]] auto begin() const noexcept
+    {
+        return std::begin(map_);
+    }
+
+    [[nodiscard]] auto end() const noexcept
+    {
+        return std::end(map_);
+    }
+
+    auto erase(const key_type &key) -> iterator
+    {
+        auto itr = find(key);
+
+        if (itr != std::end(map_))
+            return erase(itr);
+
+        return itr;
+    }
+
+    void erase_if(std::function<bool(const pair_type &)> pred)
+    {
+        const auto old_size = std::size(map_);
+        std::erase_if(map_, pred);
+
+        if (std::size(map_) != old_size)
+            rebuild_index();
+    }
+
+    auto erase(const_iterator itr) -> iterator
+    {
+        const auto index = std::distance(std::cbegin(map_), itr);
+        map_.erase(itr);
+
+        // Removing an entry shifts all following entries, so the index has to be rebuilt. This is linear, like the
+        // erase itself.
+        rebuild_index();
+        return std::begin(map_) + index;
+    }
+
+    [[nodiscard]] auto empty() const
+    {
+        return std::empty(map_);
+    }
+
+    void clear()
+    {
+        map_.clear();
+        index_.clear();
+    }
+
+    [[nodiscard]] auto size() const noexcept
+    {
+        return std::size(map_);
+    }
+
+    void reserve(const std::size_t size)
+    {
+        map_.reserve(size);
+    }
+
+    auto operator==(const indexed_flatmap &other) const noexcept -> bool
+    {
+        if (size() != std::size(other))
+            return false;
+
+        for (const auto &[key, val] : map_)
+        {
+            const auto result = other.find(key);
+
+            if (result == std::end(other))
+                return false;
+
+            if (result->second != val)
+                return false;
+        }
+
+        return true;
+    }
+
+    auto operator!=(const indexed_flatmap &other) const noexcept -> bool
+    {
+        return !(*this == other);
+    }
+
+private:
+    struct index_slot final
+    {
+        std::uint32_t entry;
+        std::uint32_t hash;
+    };
+
+    using index_type =
+        std::vector<index_slot, typename std::allocator_traits<allocator_type>::template rebind_alloc<index_slot>>;
+
+    static constexpr auto empty_slot = std::numeric_limits<std::uint32_t>::max();
+
+    template <typename self_t, typename lookup_key_t>
+    [[nodiscard]] static auto &at_impl(self_t &self, const lookup_key_t &key)
+    {
+        const auto index = self.find_index(key);
+
+        if (index == std::size(self.map_))
+            throw std::out_of_range{"aeon indexed_flatmap key out of range."};
+
+        return self.map_[index].second;
+    }
+
+    /*!
+     * Returns the position of the given key in the vector, or the size of the vector if it was not found.
+     */
+    template <typename lookup_key_t>
+    [[nodiscard]] auto find_index(const lookup_key_t &key) const noexcept -> std::size_t
+    {
+        if (std::empty(index_))
+        {
+            for (std::size_t i = 0; i < std::size(map_); ++i)
+            {
+                if (map_[i].first == key)
+                    return i;
+            }
+
+            return std::size(map_);
+        }
+
+        const auto hash = hasher{}(key);
+        const auto mask = std::size(index_) - 1;
+
+        for (auto slot = hash & mask;; slot = (slot + 1) & mask)
+        {
+            const auto &s = index_[slot];
+
+            if (s.entry == empty_slot)
+                return std::size(map_);
+
+            if (s.hash == static_cast<std::uint32_t>(hash) && map_[s.entry].first == key)
+                return s.entry;
+        }
+    }
+
+    auto append(pair_type &&pair) -> iterator
+    {
+        map_.push_back(std::move(pair));
+
+        // Keep the load factor of the index at or below 50% so that probe sequences stay short.
+        if (std::size(map_) * 2 > std::size(index_))
+            rebuild_index();
+        else
+            add_to_index(std::size(map_) - 1);
+
+        return std::end(map_) - 1;
+    }
+
+    void rebuild_index()
+    {
+        if (std::size(map_) <= index_threshold)
+        {
+            index_.clear();
+            index_.shrink_to_fit();
+            return;
+        }
+
+        index_.assign(std::bit_ceil(std::size(map_) * 2), index_slot{empty_slot, 0});
+
+        for (std::size_t i = 0; i < std::size(map_); ++i)
+        {
+            add_to_index(i);
+        }
+    }
+
+    void add_to_index(const std::size_t entry)
+    {
+        const auto hash = hasher{}(map_[entry].first);
+        const auto mask = std::size(index_) - 1;
+
+        auto slot = hash & mask;
+
+        while (index_[slot].entry != empty_slot)
+            slot = (slot + 1) & mask;
+
+        index_[slot] = index_slot{static_cast<std::uint32_t>(entry), static_cast<std::uint32_t>(hash)};
+    }
+
+    map_type map_;
+    index_type index_;
+};
+
+} // namespace aeon::common
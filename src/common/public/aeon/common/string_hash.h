@@ -0,0 +1,47 @@
+// Distributed under the BSD 2-Clause License - Copyright 2012-2023 Robin Degen
+
+#pragma once
+
+#include <aeon/common/string.h>
+#include <aeon/common/string_view.h>
+#include <string_view>
+#include <functional>
+#include <cstddef>
+
+namespace aeon::common
+{
+
+/*!
+ * Transparent hash for string types. A common::string, common::string_view, std::string, std::string_view and
+ * string literals with the same content all result in the same hash, which allows for heterogeneous lookup in
+ * containers without having to construct a temporary string.
+ */
+struct string_hash final
+{
+    using is_transparent = void;
+
+    [[nodiscard]] auto operator()(const string_view &str) const noexcept -> std::size_t
+    {
+        return std::hash<std::string_view>{}(str.as_std_string_view());
+    }
+};
+
+} // namespace aeon::common
+
+template <>
+struct std::hash<aeon::common::string>
+{
+    inline auto operator()(const aeon::common::string &val) const noexcept -> std::size_t
+    {
+        return aeon::common::string_hash{}(val);
+    }
+};
+
+template <>
+struct std::hash<aeon::common::string_view>
+{
+    inline auto operator()(const aeon::common::string_view &val) const noexcept -> std::size_t
+    {
+        return aeon::common::string_hash{}(val);
+    }
+};
@@ -3,6 +3,7 @@
 #pragma once
 
 #include <string_view>
+#include <string>
 #include <ostream>
 #include <concepts>
 
@@ -50,6 +51,13 @@ public:
 
     constexpr string_view(const std::string &str) noexcept;
 
+    /*!
+     * View a std::basic_string with a different allocator, for example a std::pmr::string.
+     */
+    template <typename allocator_t>
+        requires(!std::same_as<allocator_t, std::allocator<char>>)
+    constexpr string_view(const std::basic_string<char, std::char_traits<char>, allocator_t> &str) noexcept;
+
     string_view(const std::u8string &str);
 
     constexpr string_view(const std::string_view &str) noexcept;
@@ -0,0 +1,127 @@
+// Distributed under the BSD 2-Clause License - Copyright 2012-2023 Robin Degen
+
+#include <aeon/common/indexed_flatmap.h>
+#include <aeon/common/string_hash.h>
+#include <aeon/common/string.h>
+#include <aeon/common/string_view.h>
+#include <gtest/gtest.h>
+#include <string>
+
+using namespace aeon;
+
+namespace
+{
+
+using test_map = common::indexed_flatmap<common::string, int, common::string_hash>;
+
+[[nodiscard]] auto make_key(const int i) -> common::string
+{
+    return common::string{"key_" + std::to_string(i)};
+}
+
+[[nodiscard]] auto make_map(const int count) -> test_map
+{
+    test_map map;
+
+    for (auto i = 0; i < count; ++i)
+        map[make_key(i)] = i;
+
+    return map;
+}
+
+} // namespace
+
+TEST(test_indexed_flatmap, find_and_at)
+{
+    // Test both below and above the threshold where the hash index is created.
+    for (const auto count : {5, static_cast<int>(test_map::index_threshold) + 1, 1000})
+    {
+        auto map = make_map(count);
+        ASSERT_EQ(static_cast<std::size_t>(count), std::size(map));
+
+        for (auto i = 0; i < count; ++i)
+        {
+            const auto key = make_key(i);
+            EXPECT_TRUE(map.contains(key));
+            EXPECT_EQ(i, map.at(key));
+            EXPECT_EQ(i, map.find(key)->second);
+        }
+
+        EXPECT_FALSE(map.contains("does_not_exist"));
+        EXPECT_EQ(std::end(map), map.find("does_not_exist"));
+        EXPECT_THROW([[maybe_unused]] auto &val = map.at("does_not_exist"), std::out_of_range);
+    }
+}
+
+TEST(test_indexed_flatmap, heterogeneous_lookup)
+{
+    const auto map = make_map(100);
+
+    const common::string_view key = "key_42";
+    EXPECT_TRUE(map.contains(key));
+    EXPECT_EQ(42, map.at(key));
+    EXPECT_EQ(42, map.at("key_42"));
+    EXPECT_EQ(42, map.find(std::string_view{"key_42"})->second);
+}
+
+TEST(test_indexed_flatmap, keeps_insertion_order)
+{
+    auto map = make_map(100);
+
+    auto i = 0;
+    for (const auto &[key, value] : map)
+    {
+        EXPECT_EQ(make_key(i), key);
+        EXPECT_EQ(i, value);
+        ++i;
+    }
+}
+
+TEST(test_indexed_flatmap, insert_overwrites_existing)
+{
+    auto map = make_map(100);
+    map.insert(make_key(10), 1234);
+    map.emplace(make_key(90), 5678);
+    map["key_50"] = 42;
+
+    EXPECT_EQ(100u, std::size(map));
+    EXPECT_EQ(1234, map.at("key_10"));
+    EXPECT_EQ(5678, map.at("key_90"));
+    EXPECT_EQ(42, map.at("key_50"));
+}
+
+TEST(test_indexed_flatmap, erase)
+{
+    auto map = make_map(100);
+
+    map.erase(make_key(0));
+    map.erase(map.find("key_50"));
+    map.erase_if([](const auto &pair) { return pair.second % 2 == 1; });
+
+    EXPECT_EQ(48u, std::size(map));
+    EXPECT_FALSE(map.contains("key_0"));
+    EXPECT_FALSE(map.contains("key_50"));
+    EXPECT_FALSE(map.contains("key_51"));
+
+    for (auto i = 2; i < 100; i += 2)
+    {
+        if (i != 50)
+            EXPECT_EQ(i, map.at(make_key(i)));
+    }
+
+    // Shrinking below the threshold removes the index; lookups must still work.
+    map.erase_if([](const auto &pair) { return pair.second > 10; });
+    EXPECT_EQ(5u, std::size(map));
+    EXPECT_EQ(10, map.at("key_10"));
+    EXPECT_FALSE(map.contains("key_12"));
+}
+
+TEST(test_indexed_flatmap, compare)
+{
+    const auto map1 = make_map(100);
+    auto map2 = make_map(100);
+    EXPECT_EQ(map1, map2);
+
+    map2["key_3"] = 4;
+    EXPECT_NE(map1, map2);
+}
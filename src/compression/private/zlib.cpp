@@ -7,8 +7,8 @@
 namespace aeon::compression
 {
 
-zlib_compress::zlib_compress(const zlib_compression_mode mode, const int buffer_size)
-    : compress_{std::make_unique<internal::zlib_compress>(static_cast<int>(mode))}
+zlib_compress::zlib_compress(const zlib_compression_mode mode, const int buffer_size, const zlib_format format)
+    : compress_{std::make_unique<internal::zlib_compress>(static_cast<int>(mode), format)}
     , buffer_{}
 {
     buffer_.resize(buffer_size);
@@ -25,11 +25,34 @@ void zlib_compress::write(const std::byte *data, const std::streamsize size, con
     compress_->stream().avail_in = static_cast<uInt>(size);
     compress_->stream().next_in = reinterpret_cast<const unsigned char *>(data);
 
+    flush(Z_SYNC_FLUSH, cb);
+
+    aeon_assert(compress_->stream().avail_in == 0, "Did not write all expected compressed bytes.");
+}
+
+void zlib_compress::finish(const write_callback &cb)
+{
+    compress_->stream().avail_in = 0;
+    compress_->stream().next_in = nullptr;
+
+    flush(Z_FINISH, cb);
+}
+
+void zlib_compress::flush(const int flush_mode, const write_callback &cb)
+{
+    auto result = Z_OK;
+
     do
     {
         compress_->stream().avail_out = static_cast<uInt>(std::size(buffer_));
         compress_->stream().next_out = reinterpret_cast<unsigned char *>(std::data(buffer_));
-        if (deflate(&compress_->stream(), Z_SYNC_FLUSH) != Z_OK)
+        result = deflate(&compress_->stream(), flush_mode);
+
+        // No progress was possible; the previous call already filled the output buffer exactly.
+        if (result == Z_BUF_ERROR)
+            break;
+
+        if (result != Z_OK && result != Z_STREAM_END)
             throw zlib_compress_exception{};
 
         const auto write_size = static_cast<std::streamsize>(std::size(buffer_) - compress_->stream().avail_out);
@@ -40,9 +63,7 @@ void zlib_compress::write(const std::byte *data, const std::streamsize size, con
             if (cb(std::data(buffer_), write_size) != write_size)
                 throw zlib_compress_exception{};
         }
-    } while (compress_->stream().avail_out == 0);
-
-    aeon_assert(compress_->stream().avail_in == 0, "Did not write all expected compressed bytes.");
+    } while (compress_->stream().avail_out == 0 && result != Z_STREAM_END);
 }
 
 zlib_decompress::zlib_decompress(const int buffer_size)
@@ -83,13 +104,19 @@ auto zlib_decompress::read(std::byte *data, const std::streamsize size, const re
         zstream.next_out = reinterpret_cast<Bytef *>(data_buffer);
         zstream.avail_out = static_cast<uInt>(read_size_remaining);
 
-        if (inflate(&zstream, Z_SYNC_FLUSH) != Z_OK)
+        const auto result = inflate(&zstream, Z_SYNC_FLUSH);
+
+        if (result != Z_OK && result != Z_STREAM_END)
             throw zlib_decompress_exception{};
 
         const auto bytes_inflated = zstream.total_out - prev_total_out;
         read_size_remaining -= bytes_inflated;
 
         data_buffer += bytes_inflated;
+
+        // The end of a stream that was finished with zlib_compress::finish
+        if (result == Z_STREAM_END)
+            break;
     } while (read_size_remaining != 0);
 
     return size - read_size_remaining;
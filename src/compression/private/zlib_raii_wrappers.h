@@ -15,10 +15,15 @@ namespace aeon::compression::internal
 class zlib_compress final
 {
 public:
-    explicit zlib_compress(const int level)
+    explicit zlib_compress(const int level, const zlib_format format)
         : zstream_{}
     {
-        if (deflateInit(&zstream_, level) != Z_OK)
+        // Adding 16 to the window bits writes a gzip header and trailer instead of a zlib wrapper.
+        static constexpr int window_bits = 15;
+        static constexpr int memory_level = 8;
+        const auto bits = (format == zlib_format::gzip) ? window_bits + 16 : window_bits;
+
+        if (deflateInit2(&zstream_, level, Z_DEFLATED, bits, memory_level, Z_DEFAULT_STRATEGY) != Z_OK)
             throw zlib_compress_exception{};
     }
 
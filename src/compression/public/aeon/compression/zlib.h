@@ -23,12 +23,22 @@ enum class zlib_compression_mode : int
     fastest = 1
 };
 
+enum class zlib_format
+{
+    // A zlib header and adler32 checksum (RFC 1950); also known as "deflate" in HTTP.
+    zlib,
+
+    // A gzip header and crc32 checksum (RFC 1952)
+    gzip
+};
+
 class zlib_compress final
 {
 public:
     using write_callback = std::function<std::streamsize(const std::byte *, const std::streamsize)>;
 
-    explicit zlib_compress(const zlib_compression_mode mode, const int buffer_size = 256);
+    explicit zlib_compress(const zlib_compression_mode mode, const int buffer_size = 256,
+                           const zlib_format format = zlib_format::zlib);
     ~zlib_compress();
 
     zlib_compress(zlib_compress &&) noexcept;
@@ -39,7 +49,14 @@ public:
 
     void write(const std::byte *data, const std::streamsize size, const write_callback &cb);
 
+    /*!
+     * Write the end of the compressed stream (including the checksum). Nothing can be written after this.
+     */
+    void finish(const write_callback &cb);
+
 private:
+    void flush(const int flush_mode, const write_callback &cb);
+
     std::unique_ptr<internal::zlib_compress> compress_;
     std::vector<std::byte> buffer_;
 };
@@ -66,3 +66,48 @@ TEST(test_streams, test_zlib_compress_filter_read_write_basic)
     test_decompress_data(pipeline.device().data(), static_cast<int>(std::size(data)), data);
     test_decompress_data(pipeline.device().data(), static_cast<int>(std::size(data) * 2), data);
 }
+
+TEST(test_streams, test_zlib_compress_finish)
+{
+    const common::string data = "Lorem ipsum dolor sit amet, consectetur adipiscing elit. Lorem ipsum dolor sit amet, "
+                                "consectetur adipiscing elit. Lorem ipsum dolor sit amet, consectetur adipiscing elit.";
+
+    std::vector<char> compressed;
+    const auto append = [&compressed](const std::byte *data, const std::streamsize size)
+    {
+        compressed.insert(std::end(compressed), reinterpret_cast<const char *>(data),
+                          reinterpret_cast<const char *>(data) + size);
+        return size;
+    };
+
+    compression::zlib_compress compress{compression::zlib_compression_mode::balanced, 16};
+    compress.write(reinterpret_cast<const std::byte *>(std::data(data)), std::size(data), append);
+    compress.finish(append);
+
+    EXPECT_LT(std::size(compressed), std::size(data));
+    test_decompress_data(compressed, static_cast<int>(std::size(data)), data);
+}
+
+TEST(test_streams, test_zlib_compress_gzip_format)
+{
+    const common::string data = "Lorem ipsum dolor sit amet, consectetur adipiscing elit.";
+
+    std::vector<unsigned char> compressed;
+    const auto append = [&compressed](const std::byte *data, const std::streamsize size)
+    {
+        compressed.insert(std::end(compressed), reinterpret_cast<const unsigned char *>(data),
+                          reinterpret_cast<const unsigned char *>(data) + size);
+        return size;
+    };
+
+    compression::zlib_compress compress{compression::zlib_compression_mode::fastest, 256,
+                                        compression::zlib_format::gzip};
+    compress.write(reinterpret_cast<const std::byte *>(std::data(data)), std::size(data), append);
+    compress.finish(append);
+
+    // The gzip magic number, and the uncompressed size in the trailer.
+    ASSERT_GT(std::size(compressed), 18u);
+    EXPECT_EQ(0x1f, compressed[0]);
+    EXPECT_EQ(0x8b, compressed[1]);
+    EXPECT_EQ(std::size(data), compressed[std::size(compressed) - 4]);
+}
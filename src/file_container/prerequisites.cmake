@@ -3,3 +3,4 @@
 depend_on(common)
 depend_on(streams)
 depend_on(ptree)
+depend_on(compression)
@@ -0,0 +1,304 @@
+// Distributed under the BSD 2-Clause License - Copyright 2012-2023 Robin Degen
+
+#include <aeon/file_container/archive.h>
+#include <aeon/file_container/exception.h>
+#include <aeon/streams/dynamic_stream.h>
+#include <aeon/streams/devices/span_device.h>
+#include "archive_format.h"
+#include "archive_codec.h"
+#include "mapped_file.h"
+#include "positional_file.h"
+#include <stdexcept>
+#include <cstring>
+#include <bit>
+
+namespace aeon::file_container
+{
+
+namespace internal
+{
+
+template <typename T>
+[[nodiscard]] static auto read_at(const std::span<const std::byte> data, const std::size_t offset) -> T
+{
+    if (offset > std::size(data) || std::size(data) - offset < sizeof(T))
+        throw archive_exception{};
+
+    T value;
+    std::memcpy(&value, std::data(data) + offset, sizeof(T));
+    return value;
+}
+
+[[nodiscard]] static auto is_in_range(const std::uint64_t offset, const std::uint64_t size,
+                                      const std::uint64_t limit) noexcept -> bool
+{
+    return offset <= limit && size <= limit - offset;
+}
+
+} // namespace internal
+
+archive::archive(const std::filesystem::path &path, const archive_open_mode mode)
+    : data_{}
+    , toc_{}
+    , toc_buffer_{}
+    , file_size_{0}
+    , toc_offset_{0}
+    , count_{0}
+    , bucket_count_{0}
+    , mapped_file_{}
+    , file_{}
+{
+    if (mode == archive_open_mode::memory_mapped && internal::mapped_file::is_supported())
+    {
+        // Entries are accessed in random order; reading ahead would only read the data of unrelated entries.
+        mapped_file_ = std::make_unique<internal::mapped_file>(path, true);
+        data_ = mapped_file_->data();
+        file_size_ = std::size(data_);
+    }
+    else
+    {
+        file_ = std::make_unique<internal::positional_file>(path);
+        file_size_ = file_->size();
+    }
+
+    parse();
+}
+
+archive::archive(const std::span<const std::byte> data)
+    : data_{data}
+    , toc_{}
+    , toc_buffer_{}
+    , file_size_{std::size(data)}
+    , toc_offset_{0}
+    , count_{0}
+    , bucket_count_{0}
+    , mapped_file_{}
+    , file_{}
+{
+    parse();
+}
+
+archive::~archive() = default;
+
+auto archive::size() const noexcept -> std::size_t
+{
+    return count_;
+}
+
+auto archive::data_size() const noexcept -> std::uint64_t
+{
+    return toc_offset_;
+}
+
+auto archive::entry(const std::size_t index) const -> archive_entry
+{
+    if (index >= count_)
+        throw std::out_of_range{"Archive entry index out of range."};
+
+    return record_entry(index);
+}
+
+auto archive::find(const common::string_view name) const -> std::optional<archive_entry>
+{
+    const auto names_offset = count_ * sizeof(internal::archive_record);
+    const auto mask = bucket_count_ - 1;
+    auto bucket = internal::hash_name(name.as_std_string_view()) & mask;
+
+    // The table always has empty buckets, but the probe is bounded in case the archive is malformed.
+    for (std::size_t i = 0; i < bucket_count_; ++i, bucket = (bucket + 1) & mask)
+    {
+        const auto index =
+            internal::read_at<std::uint32_t>(toc_, names_offset + bucket * sizeof(std::uint32_t));
+
+        if (index == internal::empty_bucket)
+            return std::nullopt;
+
+        auto candidate = entry(index);
+
+        if (candidate.name == name)
+            return candidate;
+    }
+
+    return std::nullopt;
+}
+
+auto archive::find(const common::uuid &id) const -> std::optional<archive_entry>
+{
+    if (id.is_nil())
+        return std::nullopt;
+
+    const auto uuids_offset = count_ * sizeof(internal::archive_record) + bucket_count_ * sizeof(std::uint32_t);
+    const auto mask = bucket_count_ - 1;
+    auto bucket = internal::hash_uuid(id.data) & mask;
+
+    for (std::size_t i = 0; i < bucket_count_; ++i, bucket = (bucket + 1) & mask)
+    {
+        const auto index =
+            internal::read_at<std::uint32_t>(toc_, uuids_offset + bucket * sizeof(std::uint32_t));
+
+        if (index == internal::empty_bucket)
+            return std::nullopt;
+
+        auto candidate = entry(index);
+
+        if (candidate.id == id)
+            return candidate;
+    }
+
+    return std::nullopt;
+}
+
+auto archive::contains(const common::string_view name) const -> bool
+{
+    return find(name).has_value();
+}
+
+auto archive::contains(const common::uuid &id) const -> bool
+{
+    return find(id).has_value();
+}
+
+auto archive::read(const archive_entry &entry) const -> std::vector<std::byte>
+{
+    std::vector<std::byte> data(entry.size);
+    read(entry, data);
+    return data;
+}
+
+void archive::read(const archive_entry &entry, const std::span<std::byte> destination) const
+{
+    if (std::size(destination) != entry.size)
+        throw std::invalid_argument{"Destination size does not match the size of the archive entry."};
+
+    // Uncompressed entries are read from the file directly into the destination.
+    if (std::empty(data_) && entry.compression == archive_compression::none)
+    {
+        if (entry.stored_size != entry.size || !internal::is_in_range(entry.offset, entry.stored_size, file_size_))
+            throw archive_exception{};
+
+        return read_file(entry.offset, destination);
+    }
+
+    std::vector<std::byte> buffer;
+    internal::decompress(stored_data(entry, buffer), entry.compression, destination);
+}
+
+auto archive::is_viewable(const archive_entry &entry) const noexcept -> bool
+{
+    return !std::empty(data_) && entry.compression == archive_compression::none;
+}
+
+auto archive::view(const archive_entry &entry) const -> std::span<const std::byte>
+{
+    if (!is_viewable(entry))
+        throw std::invalid_argument{"Archive entry can not be viewed in place."};
+
+    std::vector<std::byte> unused;
+    return stored_data(entry, unused);
+}
+
+auto archive::read_container(const archive_entry &entry, const common::flags<read_items> items) const
+    -> std::unique_ptr<container>
+{
+    auto data = read(entry);
+    auto stream = streams::make_dynamic_stream(streams::span_device{std::span{data}});
+    return std::make_unique<container>(stream, items);
+}
+
+void archive::parse()
+{
+    if (file_size_ < internal::archive_header_size + internal::archive_trailer_size)
+        throw archive_exception{};
+
+    internal::archive_header header{};
+    internal::archive_trailer trailer{};
+
+    if (!std::empty(data_))
+    {
+        header = internal::read_at<internal::archive_header>(data_, 0);
+        trailer = internal::read_at<internal::archive_trailer>(data_, file_size_ - internal::archive_trailer_size);
+    }
+    else
+    {
+        read_file(0, std::as_writable_bytes(std::span{&header, 1}));
+        read_file(file_size_ - internal::archive_trailer_size, std::as_writable_bytes(std::span{&trailer, 1}));
+    }
+
+    if (header.magic != internal::archive_magic || header.version != internal::archive_version ||
+        trailer.magic != internal::archive_magic)
+        throw archive_exception{};
+
+    const auto toc_limit = file_size_ - internal::archive_trailer_size;
+
+    if (trailer.toc_offset < internal::archive_header_size ||
+        !internal::is_in_range(trailer.toc_offset, trailer.toc_size, toc_limit))
+        throw archive_exception{};
+
+    // There must be at least one empty bucket, so that every probe sequence ends.
+    if (!std::has_single_bit(trailer.bucket_count) || trailer.bucket_count <= trailer.count ||
+        trailer.toc_size < internal::toc_size(trailer.count, trailer.bucket_count, 0))
+        throw archive_exception{};
+
+    toc_offset_ = trailer.toc_offset;
+    count_ = trailer.count;
+    bucket_count_ = trailer.bucket_count;
+
+    if (!std::empty(data_))
+    {
+        toc_ = data_.subspan(static_cast<std::size_t>(trailer.toc_offset), static_cast<std::size_t>(trailer.toc_size));
+        return;
+    }
+
+    toc_buffer_.resize(static_cast<std::size_t>(trailer.toc_size));
+    read_file(trailer.toc_offset, toc_buffer_);
+    toc_ = toc_buffer_;
+}
+
+auto archive::record_entry(const std::size_t index) const -> archive_entry
+{
+    const auto record = internal::read_at<internal::archive_record>(toc_, index * sizeof(internal::archive_record));
+
+    const auto names_offset = count_ * sizeof(internal::archive_record) + bucket_count_ * sizeof(std::uint32_t) * 2;
+    const auto names = std::span{toc_}.subspan(names_offset);
+
+    if (!internal::is_in_range(record.name_offset, record.name_size, std::size(names)) ||
+        !internal::is_in_range(record.offset, record.stored_size, file_size_ - internal::archive_trailer_size) ||
+        record.offset < internal::archive_header_size ||
+        record.compression > static_cast<std::uint32_t>(archive_compression::zlib))
+        throw archive_exception{};
+
+    archive_entry entry;
+    entry.name = common::string_view{reinterpret_cast<const char *>(std::data(names)) + record.name_offset,
+                                     record.name_size};
+    entry.id = common::uuid{record.id};
+    entry.offset = record.offset;
+    entry.stored_size = record.stored_size;
+    entry.size = record.size;
+    entry.content_hash = record.content_hash;
+    entry.compression = static_cast<archive_compression>(record.compression);
+    entry.alignment = record.alignment;
+    return entry;
+}
+
+auto archive::stored_data(const archive_entry &entry, std::vector<std::byte> &buffer) const
+    -> std::span<const std::byte>
+{
+    if (!internal::is_in_range(entry.offset, entry.stored_size, file_size_))
+        throw archive_exception{};
+
+    if (!std::empty(data_))
+        return data_.subspan(static_cast<std::size_t>(entry.offset), static_cast<std::size_t>(entry.stored_size));
+
+    buffer.resize(static_cast<std::size_t>(entry.stored_size));
+    read_file(entry.offset, buffer);
+    return buffer;
+}
+
+void archive::read_file(const std::uint64_t offset, const std::span<std::byte> destination) const
+{
+    // Reads are positional, so they don't need to be serialized.
+    if (!file_->read(offset, destination))
+        throw archive_exception{};
+}
+
+} // namespace aeon::file_container
@@ -0,0 +1,584 @@
+// Distributed under the BSD 2-Clause License - Copyright 2012-2023 Robin Degen
+
+#include <aeon/file_container/archive_builder.h>
+#include <aeon/file_container/exception.h>
+#include <aeon/streams/dynamic_stream.h>
+#include <aeon/streams/devices/file_device.h>
+#include <aeon/streams/devices/memory_view_device.h>
+#include "archive_format.h"
+#include "archive_codec.h"
+#include "positional_file.h"
+#include <unordered_map>
+#include <unordered_set>
+#include <condition_variable>
+#include <algorithm>
+#include <exception>
+#include <optional>
+#include <future>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <bit>
+
+namespace aeon::file_container
+{
+
+namespace internal
+{
+
+/*!
+ * Start threads that call the given function for every index up to count, taking the next index from the given
+ * counter. The threads are joined when the returned vector is destroyed.
+ */
+template <typename function_t>
+[[nodiscard]] static auto start_workers(const unsigned int concurrency, const std::size_t count,
+                                        std::atomic<std::size_t> &next, function_t &function)
+    -> std::vector<std::jthread>
+{
+    const auto thread_count = std::min(static_cast<std::size_t>(std::max(concurrency, 1u)), count);
+
+    std::vector<std::jthread> threads;
+    threads.reserve(thread_count);
+
+    for (std::size_t i = 0; i < thread_count; ++i)
+    {
+        threads.emplace_back(
+            [count, &next, &function]()
+            {
+                for (auto index = next++; index < count; index = next++)
+                    function(index);
+            });
+    }
+
+    return threads;
+}
+
+/*!
+ * Collects the first exception that is thrown on any of the worker threads, so that it can be rethrown on the thread
+ * that started the work.
+ */
+class first_exception final
+{
+public:
+    template <typename function_t>
+    void capture(function_t &&function) noexcept
+    {
+        try
+        {
+            function();
+        }
+        catch (...)
+        {
+            std::scoped_lock lock{mutex_};
+
+            if (!exception_)
+                exception_ = std::current_exception();
+        }
+    }
+
+    void rethrow()
+    {
+        if (exception_)
+            std::rethrow_exception(exception_);
+    }
+
+private:
+    std::mutex mutex_;
+    std::exception_ptr exception_;
+};
+
+/*!
+ * Limits how far the workers can run ahead of the entry that is being written, so that only the data of a few entries
+ * is in memory at any time.
+ */
+class load_window final
+{
+public:
+    explicit load_window(const std::size_t size) noexcept
+        : size_{size}
+        , written_{0}
+        , closed_{false}
+    {
+    }
+
+    /*!
+     * Wait until the entry with the given index may be loaded. Returns false if the build was aborted.
+     */
+    [[nodiscard]] auto wait(const std::size_t index) -> bool
+    {
+        std::unique_lock lock{mutex_};
+        condition_.wait(lock, [this, index]() { return closed_ || index < written_ + size_; });
+        return !closed_;
+    }
+
+    void advance()
+    {
+        {
+            std::scoped_lock lock{mutex_};
+            ++written_;
+        }
+
+        condition_.notify_all();
+    }
+
+    void close()
+    {
+        {
+            std::scoped_lock lock{mutex_};
+            closed_ = true;
+        }
+
+        condition_.notify_all();
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable condition_;
+    std::size_t size_;
+    std::size_t written_;
+    bool closed_;
+};
+
+/*!
+ * The data of an entry between loading and writing it.
+ */
+struct loaded_entry
+{
+    std::vector<std::byte> data;
+    std::vector<std::byte> compressed;
+};
+
+[[nodiscard]] static auto load_file(const std::filesystem::path &path) -> std::vector<std::byte>
+{
+    streams::file_source_device file{path};
+
+    std::vector<std::byte> data(static_cast<std::size_t>(file.size()));
+
+    if (file.read(std::data(data), std::ssize(data)) != std::ssize(data))
+        throw archive_exception{};
+
+    return data;
+}
+
+/*!
+ * Read data back from an archive file that is being written through the given stream. The file is only opened once
+ * it is needed.
+ */
+[[nodiscard]] static auto make_file_reader(streams::idynamic_stream &stream, const std::filesystem::path &path,
+                                           std::optional<positional_file> &file)
+{
+    return [&stream, &path, &file](const std::uint64_t offset, const std::span<std::byte> destination)
+    {
+        if (stream.is_flushable())
+            stream.flush();
+
+        if (!file)
+            file.emplace(path);
+
+        return file->read(offset, destination);
+    };
+}
+
+/*!
+ * Returns true if the stored data of an entry, read back from the archive, is the given content.
+ */
+template <typename read_function_t>
+[[nodiscard]] static auto stored_data_equals(const read_function_t &read_back, const archive_entry &stored,
+                                             const std::span<const std::byte> content) -> bool
+{
+    if (stored.size != std::size(content))
+        return false;
+
+    std::vector<std::byte> buffer(static_cast<std::size_t>(stored.stored_size));
+
+    if (!read_back(stored.offset, buffer))
+        throw archive_exception{};
+
+    if (stored.compression == archive_compression::none)
+        return std::ranges::equal(buffer, content);
+
+    std::vector<std::byte> decompressed(std::size(content));
+    decompress(buffer, stored.compression, decompressed);
+    return std::ranges::equal(decompressed, content);
+}
+
+[[nodiscard]] static auto elapsed_since(const std::chrono::steady_clock::time_point start) noexcept
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+}
+
+} // namespace internal
+
+auto archive_builder_statistics::throughput() const noexcept -> double
+{
+    if (elapsed.count() == 0)
+        return 0.0;
+
+    return static_cast<double>(input_bytes) / std::chrono::duration<double>{elapsed}.count();
+}
+
+archive_builder::archive_builder(const unsigned int concurrency)
+    : concurrency_{std::max(concurrency, 1u)}
+    , entries_{}
+{
+}
+
+archive_builder::~archive_builder() = default;
+
+void archive_builder::add(common::string name, const common::uuid &id, std::vector<std::byte> data,
+                          const archive_compression compression, const std::uint32_t alignment)
+{
+    if (!std::has_single_bit(alignment))
+        throw std::invalid_argument{"Archive entry alignment must be a power of 2."};
+
+    entries_.push_back(entry{.name = std::move(name),
+                             .id = id,
+                             .data = std::move(data),
+                             .compression = compression,
+                             .alignment = alignment});
+}
+
+void archive_builder::add(common::string name, const common::uuid &id, std::filesystem::path path,
+                          const archive_compression compression, const std::uint32_t alignment)
+{
+    if (!std::has_single_bit(alignment))
+        throw std::invalid_argument{"Archive entry alignment must be a power of 2."};
+
+    entries_.push_back(entry{
+        .name = std::move(name), .id = id, .path = std::move(path), .compression = compression, .alignment = alignment});
+}
+
+void archive_builder::add(const container &c, const archive_compression compression, const std::uint32_t alignment)
+{
+    std::vector<std::uint8_t> data;
+    auto stream = streams::make_dynamic_stream(streams::memory_view_device{data});
+    c.write(stream);
+
+    const auto bytes = std::as_bytes(std::span{data});
+    add(c.name(), c.id(), std::vector<std::byte>{std::begin(bytes), std::end(bytes)}, compression, alignment);
+}
+
+auto archive_builder::size() const noexcept -> std::size_t
+{
+    return std::size(entries_);
+}
+
+auto archive_builder::build(streams::idynamic_stream &stream) -> archive_builder_statistics
+{
+    const auto start = std::chrono::steady_clock::now();
+
+    // Written data can only be compared with new entries if the stream can be read back.
+    read_function read_back;
+
+    if (stream.is_input() && stream.is_input_seekable())
+    {
+        read_back = [&stream](const std::uint64_t offset, const std::span<std::byte> destination)
+        {
+            // Restore the write position, in case the stream only has one position for reading and writing.
+            const auto position = stream.tellp();
+            const auto size = static_cast<std::streamsize>(std::size(destination));
+
+            const auto result = stream.seekg(static_cast<std::streamoff>(offset), streams::seek_direction::begin) &&
+                                stream.read(std::data(destination), size) == size;
+
+            stream.seekp(position, streams::seek_direction::begin);
+            return result;
+        };
+    }
+
+    archive_builder_statistics statistics;
+    archive_writer writer{stream};
+    write(writer, statistics, read_back);
+
+    statistics.archive_size = writer.archive_size();
+    statistics.elapsed = internal::elapsed_since(start);
+    return statistics;
+}
+
+auto archive_builder::build(const std::filesystem::path &path) -> archive_builder_statistics
+{
+    const auto start = std::chrono::steady_clock::now();
+
+    archive_builder_statistics statistics;
+    std::uint64_t existing_file_size = 0;
+
+    if (std::filesystem::exists(path))
+    {
+        const archive existing{path};
+        match_existing(existing, statistics);
+
+        std::unordered_set<std::uint64_t> used_offsets;
+        std::uint64_t used_size = 0;
+
+        for (const auto &e : entries_)
+        {
+            if (e.has_stored && used_offsets.insert(e.stored.offset).second)
+                used_size += e.stored.stored_size;
+        }
+
+        const auto existing_size = existing.data_size() - internal::archive_header_size;
+
+        if (static_cast<double>(used_size) < static_cast<double>(existing_size) * archive_builder_compaction_ratio)
+        {
+            for (auto &e : entries_)
+                e.has_stored = false;
+
+            statistics.rebuilt = true;
+        }
+        else
+        {
+            existing_file_size = std::filesystem::file_size(path);
+        }
+    }
+
+    std::optional<internal::positional_file> output;
+
+    if (existing_file_size != 0)
+    {
+        // The new data and table of contents are appended after the trailer of the existing archive, so that it stays
+        // intact until the new trailer is written. If the build fails, the file is truncated back to it.
+        try
+        {
+            auto stream = streams::make_dynamic_stream(
+                streams::file_sink_device{path, streams::file_mode::binary, streams::file_flag::append});
+            archive_writer writer{stream, existing_file_size};
+            write(writer, statistics, internal::make_file_reader(stream, path, output));
+            statistics.archive_size = writer.archive_size();
+        }
+        catch (...)
+        {
+            output.reset();
+
+            std::error_code ec;
+            std::filesystem::resize_file(path, existing_file_size, ec);
+            throw;
+        }
+    }
+    else
+    {
+        // A new archive is written next to the existing one, so that it is only replaced when it is complete.
+        auto temporary_path = path;
+        temporary_path += ".tmp";
+
+        try
+        {
+            {
+                auto stream = streams::make_dynamic_stream(streams::file_sink_device{temporary_path});
+                archive_writer writer{stream};
+                write(writer, statistics, internal::make_file_reader(stream, temporary_path, output));
+                statistics.archive_size = writer.archive_size();
+            }
+
+            output.reset();
+            std::filesystem::rename(temporary_path, path);
+        }
+        catch (...)
+        {
+            output.reset();
+
+            std::error_code ec;
+            std::filesystem::remove(temporary_path, ec);
+            throw;
+        }
+    }
+
+    statistics.elapsed = internal::elapsed_since(start);
+    return statistics;
+}
+
+auto archive_builder::default_concurrency() noexcept -> unsigned int
+{
+    return std::max(std::thread::hardware_concurrency(), 1u);
+}
+
+void archive_builder::match_existing(const archive &existing, archive_builder_statistics &statistics)
+{
+    const auto start = std::chrono::steady_clock::now();
+
+    // The existing entries by content, so that data that is already in the archive is found under any name.
+    std::unordered_multimap<std::uint64_t, archive_entry> existing_entries;
+
+    for (std::size_t i = 0; i < existing.size(); ++i)
+    {
+        const auto e = existing.entry(i);
+        existing_entries.emplace(e.content_hash, e);
+    }
+
+    internal::first_exception exception;
+    std::atomic<std::size_t> next{0};
+
+    auto job = [this, &existing, &existing_entries, &exception](const std::size_t index)
+    {
+        exception.capture(
+            [this, &existing, &existing_entries, index]()
+            {
+                auto &e = entries_[index];
+
+                // Files are only loaded to be compared; they are loaded again if they have to be written.
+                std::vector<std::byte> file_data;
+
+                if (!e.path.empty())
+                    file_data = internal::load_file(e.path);
+
+                const auto data = e.path.empty() ? std::span<const std::byte>{e.data} : std::span{file_data};
+                e.content_hash = internal::hash_bytes(data);
+
+                const auto [first, last] = existing_entries.equal_range(e.content_hash);
+
+                for (auto itr = first; itr != last; ++itr)
+                {
+                    const auto &candidate = itr->second;
+
+                    if (candidate.size != std::size(data) || candidate.offset % e.alignment != 0)
+                        continue;
+
+                    // The hash only finds candidates; the content must actually be the same.
+                    if (!std::ranges::equal(existing.read(candidate), data))
+                        continue;
+
+                    e.stored = candidate;
+                    e.stored.name = common::string_view{};
+                    e.stored.id = e.id;
+                    e.stored.alignment = e.alignment;
+                    e.has_stored = true;
+                    break;
+                }
+            });
+    };
+
+    {
+        const auto workers = internal::start_workers(concurrency_, std::size(entries_), next, job);
+    }
+
+    exception.rethrow();
+
+    statistics.hash_time = internal::elapsed_since(start);
+}
+
+void archive_builder::write(archive_writer &writer, archive_builder_statistics &statistics,
+                            const read_function &read_back)
+{
+    const auto start = std::chrono::steady_clock::now();
+
+    std::vector<std::size_t> pending;
+
+    for (std::size_t i = 0; i < std::size(entries_); ++i)
+    {
+        auto &e = entries_[i];
+
+        if (!e.has_stored)
+        {
+            pending.push_back(i);
+            continue;
+        }
+
+        e.data = {};
+        ++statistics.unchanged_entries;
+    }
+
+    std::vector<internal::loaded_entry> loaded(std::size(pending));
+    std::vector<std::promise<void>> ready(std::size(pending));
+    internal::load_window window{static_cast<std::size_t>(concurrency_) * 2};
+    std::atomic<std::size_t> next{0};
+
+    auto job = [this, &pending, &loaded, &ready, &window](const std::size_t index)
+    {
+        if (!window.wait(index))
+            return;
+
+        try
+        {
+            auto &e = entries_[pending[index]];
+            auto &l = loaded[index];
+            l.data = e.path.empty() ? std::move(e.data) : internal::load_file(e.path);
+            e.content_hash = internal::hash_bytes(l.data);
+            l.compressed = internal::compress(l.data, e.compression);
+            ready[index].set_value();
+        }
+        catch (...)
+        {
+            ready[index].set_exception(std::current_exception());
+        }
+    };
+
+    // Entries that were written, by content hash. Only the stored location is kept; the data is read back from the
+    // archive to compare it with a new entry that has the same hash.
+    std::unordered_multimap<std::uint64_t, std::size_t> written;
+
+    {
+        // Entries are loaded and compressed on the workers, and written here in order as soon as they are done.
+        const auto workers = internal::start_workers(concurrency_, std::size(pending), next, job);
+
+        try
+        {
+            for (std::size_t i = 0; i < std::size(pending); ++i)
+            {
+                ready[i].get_future().get();
+
+                auto &e = entries_[pending[i]];
+                auto &l = loaded[i];
+
+                // An earlier entry can only be shared if its alignment is at least as large (both are a power of 2).
+                const auto [first, last] = written.equal_range(e.content_hash);
+                const auto duplicate = std::find_if(first, last,
+                                                    [this, &e, &l, &read_back](const auto &candidate)
+                                                    {
+                                                        const auto &other = entries_[candidate.second].stored;
+                                                        return other.alignment >= e.alignment &&
+                                                               internal::stored_data_equals(read_back, other, l.data);
+                                                    });
+
+                if (duplicate != last)
+                {
+                    e.stored = entries_[duplicate->second].stored;
+                    e.stored.id = e.id;
+                    ++statistics.deduplicated_entries;
+                }
+                else
+                {
+                    const auto is_compressed = !std::empty(l.compressed);
+                    const auto stored = is_compressed ? std::span<const std::byte>{l.compressed} : std::span{l.data};
+
+                    e.stored.id = e.id;
+                    e.stored.offset = writer.write_data(stored, e.alignment);
+                    e.stored.stored_size = std::size(stored);
+                    e.stored.size = std::size(l.data);
+                    e.stored.content_hash = e.content_hash;
+                    e.stored.compression = is_compressed ? e.compression : archive_compression::none;
+                    e.stored.alignment = e.alignment;
+
+                    statistics.written_bytes += std::size(stored);
+                    ++statistics.written_entries;
+
+                    if (read_back)
+                        written.emplace(e.content_hash, pending[i]);
+                }
+
+                e.has_stored = true;
+                l = {};
+                window.advance();
+            }
+        }
+        catch (...)
+        {
+            window.close();
+            throw;
+        }
+    }
+
+    for (const auto &e : entries_)
+    {
+        writer.add_entry(e.name, e.stored);
+        statistics.input_bytes += e.stored.size;
+    }
+
+    writer.finish();
+
+    statistics.entries = std::size(entries_);
+    statistics.write_time = internal::elapsed_since(start);
+
+    // The builder can be reused for another archive.
+    entries_.clear();
+}
+
+} // namespace aeon::file_container
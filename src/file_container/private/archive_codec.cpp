@@ -0,0 +1,82 @@
+// Distributed under the BSD 2-Clause License - Copyright 2012-2023 Robin Degen
+
+#include "archive_codec.h"
+#include <aeon/file_container/exception.h>
+#include <aeon/compression/zlib.h>
+#include <aeon/compression/exception.h>
+#include <algorithm>
+#include <cstring>
+#include <ios>
+
+namespace aeon::file_container::internal
+{
+
+static constexpr int codec_buffer_size = 64 * 1024;
+
+auto compress(const std::span<const std::byte> data, const archive_compression compression)
+    -> std::vector<std::byte>
+{
+    if (compression == archive_compression::none || std::empty(data))
+        return {};
+
+    std::vector<std::byte> result;
+    result.reserve(std::size(data) / 2);
+
+    compression::zlib_compress compress{compression::zlib_compression_mode::balanced, codec_buffer_size};
+
+    const auto append = [&result](const std::byte *buffer, const std::streamsize size)
+    {
+        result.insert(std::end(result), buffer, buffer + size);
+        return size;
+    };
+
+    compress.write(std::data(data), static_cast<std::streamsize>(std::size(data)), append);
+    compress.finish(append);
+
+    if (std::size(result) >= std::size(data))
+        return {};
+
+    return result;
+}
+
+void decompress(const std::span<const std::byte> stored, const archive_compression compression,
+                const std::span<std::byte> destination)
+{
+    if (compression == archive_compression::none)
+    {
+        if (std::size(stored) != std::size(destination))
+            throw archive_exception{};
+
+        std::memcpy(std::data(destination), std::data(stored), std::size(stored));
+        return;
+    }
+
+    if (compression != archive_compression::zlib)
+        throw archive_exception{};
+
+    compression::zlib_decompress decompress{codec_buffer_size};
+    auto remaining = stored;
+
+    const auto next_input = [&remaining](std::byte *buffer, const std::streamsize size)
+    {
+        const auto length = std::min(std::size(remaining), static_cast<std::size_t>(size));
+        std::memcpy(buffer, std::data(remaining), length);
+        remaining = remaining.subspan(length);
+        return static_cast<std::streamsize>(length);
+    };
+
+    try
+    {
+        const auto size = decompress.read(std::data(destination), static_cast<std::streamsize>(std::size(destination)),
+                                          next_input);
+
+        if (static_cast<std::size_t>(size) != std::size(destination))
+            throw archive_exception{};
+    }
+    catch (const compression::zlib_decompress_exception &)
+    {
+        throw archive_exception{};
+    }
+}
+
+} // namespace aeon::file_container::internal
@@ -0,0 +1,26 @@
+// Distributed under the BSD 2-Clause License - Copyright 2012-2023 Robin Degen
+
+#pragma once
+
+#include <aeon/file_container/archive.h>
+#include <vector>
+#include <span>
+#include <cstddef>
+
+namespace aeon::file_container::internal
+{
+
+/*!
+ * Compress the data of an entry. Returns an empty vector if the compressed data would not be smaller, in which case
+ * the entry should be stored uncompressed.
+ */
+[[nodiscard]] auto compress(const std::span<const std::byte> data, const archive_compression compression)
+    -> std::vector<std::byte>;
+
+/*!
+ * Decompress the stored data of an entry into the destination, which must be exactly the uncompressed size.
+ */
+void decompress(const std::span<const std::byte> stored, const archive_compression compression,
+                const std::span<std::byte> destination);
+
+} // namespace aeon::file_container::internal
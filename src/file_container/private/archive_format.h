@@ -0,0 +1,142 @@
+// Distributed under the BSD 2-Clause License - Copyright 2012-2023 Robin Degen
+
+#pragma once
+
+#include <aeon/common/fourcc.h>
+#include <aeon/common/uuid.h>
+#include <span>
+#include <cstring>
+#include <cstdint>
+#include <cstddef>
+
+namespace aeon::file_container::internal
+{
+
+/*
+ * Archive layout. All values are stored in native (little) endian. All offsets are absolute (from the start of the
+ * file).
+ *
+ * header:  u32 magic ('AFA1'), u32 version, u64 reserved
+ * data:    the (optionally compressed) data of every entry, each starting at the alignment of that entry
+ * toc:     record[count], sorted by name
+ *          u32 name bucket[bucket count]
+ *          u32 uuid bucket[bucket count]
+ *          name data
+ * trailer: u64 toc offset, u64 toc size, u32 count, u32 bucket count, u32 magic ('AFA1'), u32 reserved
+ *
+ * The buckets are open addressing hash tables (linear probing) of record indices, in which empty buckets are
+ * marked with empty_bucket. Entries with a nil uuid are not in the uuid table.
+ */
+static constexpr std::uint32_t archive_magic = common::fourcc('A', 'F', 'A', '1');
+static constexpr std::uint32_t archive_version = 1;
+static constexpr std::size_t archive_header_size = 16;
+static constexpr std::size_t archive_trailer_size = 32;
+static constexpr std::size_t archive_toc_alignment = 8;
+static constexpr std::uint32_t empty_bucket = 0xffffffff;
+
+struct archive_header final
+{
+    std::uint32_t magic;
+    std::uint32_t version;
+    std::uint64_t reserved;
+};
+
+struct archive_trailer final
+{
+    std::uint64_t toc_offset;
+    std::uint64_t toc_size;
+    std::uint32_t count;
+    std::uint32_t bucket_count;
+    std::uint32_t magic;
+    std::uint32_t reserved;
+};
+
+struct archive_record final
+{
+    common::uuid::data_type id;
+    std::uint64_t offset;
+    std::uint64_t stored_size;
+    std::uint64_t size;
+    std::uint64_t content_hash;
+
+    // Relative to the start of the name data
+    std::uint32_t name_offset;
+    std::uint32_t name_size;
+    std::uint32_t compression;
+    std::uint32_t alignment;
+};
+
+static_assert(sizeof(archive_header) == archive_header_size);
+static_assert(sizeof(archive_trailer) == archive_trailer_size);
+static_assert(sizeof(archive_record) == 64);
+
+/*!
+ * The amount of buckets of the hash tables for the given amount of entries; always a power of 2 with a load factor
+ * of at most 0.5, so that probe sequences stay short.
+ */
+[[nodiscard]] inline auto bucket_count(const std::size_t count) noexcept -> std::size_t
+{
+    std::size_t buckets = 1;
+
+    while (buckets < count * 2)
+        buckets *= 2;
+
+    return buckets;
+}
+
+[[nodiscard]] inline auto toc_size(const std::size_t count, const std::size_t buckets,
+                                   const std::size_t names_size) noexcept -> std::size_t
+{
+    return count * sizeof(archive_record) + buckets * sizeof(std::uint32_t) * 2 + names_size;
+}
+
+/*!
+ * A 64-bit hash that is stored in the archive, so unlike std::hash it must give the same result on every platform and
+ * in every build. The data is consumed 8 bytes at a time with a multiply-xorshift mix.
+ */
+[[nodiscard]] inline auto hash_bytes(const std::span<const std::byte> data) noexcept -> std::uint64_t
+{
+    constexpr std::uint64_t multiplier = 0x9e3779b97f4a7c15ull;
+
+    const auto mix = [](std::uint64_t value) noexcept
+    {
+        value ^= value >> 32;
+        value *= 0xd6e8feb86659fd93ull;
+        value ^= value >> 32;
+        return value;
+    };
+
+    auto hash = 0x2545f4914f6cdd1dull ^ (std::size(data) * multiplier);
+    auto *ptr = std::data(data);
+    auto remaining = std::size(data);
+
+    while (remaining >= sizeof(std::uint64_t))
+    {
+        std::uint64_t word;
+        std::memcpy(&word, ptr, sizeof(word));
+        hash = mix(hash ^ (word * multiplier)) * multiplier;
+        ptr += sizeof(word);
+        remaining -= sizeof(word);
+    }
+
+    if (remaining != 0)
+    {
+        std::uint64_t word = 0;
+        std::memcpy(&word, ptr, remaining);
+        hash = mix(hash ^ (word * multiplier)) * multiplier;
+    }
+
+    return mix(hash);
+}
+
+[[nodiscard]] inline auto hash_name(const std::string_view name) noexcept -> std::uint64_t
+{
+    return hash_bytes(std::as_bytes(std::span{std::data(name), std::size(name)}));
+}
+
+[[nodiscard]] inline auto hash_uuid(const common::uuid::data_type &id) noexcept -> std::uint64_t
+{
+    return hash_bytes(std::as_bytes(std::span{id}));
+}
+
+} // namespace aeon::file_container::internal
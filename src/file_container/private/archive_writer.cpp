@@ -0,0 +1,251 @@
+// Distributed under the BSD 2-Clause License - Copyright 2012-2023 Robin Degen
+
+#include <aeon/file_container/archive.h>
+#include <aeon/file_container/exception.h>
+#include <aeon/streams/dynamic_stream.h>
+#include <aeon/streams/devices/memory_view_device.h>
+#include "archive_format.h"
+#include "archive_codec.h"
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+#include <bit>
+
+namespace aeon::file_container
+{
+
+namespace internal
+{
+
+static constexpr std::array<std::byte, 64> padding{};
+
+template <typename T>
+[[nodiscard]] static auto as_bytes(const T &value) noexcept -> std::span<const std::byte>
+{
+    return std::as_bytes(std::span{&value, 1});
+}
+
+[[nodiscard]] static auto padding_size(const std::uint64_t offset, const std::uint64_t alignment) noexcept
+    -> std::uint64_t
+{
+    return (alignment - (offset & (alignment - 1))) & (alignment - 1);
+}
+
+/*!
+ * Insert a record index into an open addressing hash table. Returns the index of the record that is already in the
+ * table with the same key, if any.
+ */
+template <typename equal_t>
+[[nodiscard]] static auto insert_bucket(std::vector<std::uint32_t> &buckets, const std::uint64_t hash,
+                                        const std::uint32_t index, equal_t &&equal) -> std::uint32_t
+{
+    const auto mask = std::size(buckets) - 1;
+
+    for (auto bucket = hash & mask;; bucket = (bucket + 1) & mask)
+    {
+        if (buckets[bucket] == empty_bucket)
+        {
+            buckets[bucket] = index;
+            return empty_bucket;
+        }
+
+        if (equal(buckets[bucket]))
+            return buckets[bucket];
+    }
+}
+
+} // namespace internal
+
+archive_writer::archive_writer(streams::idynamic_stream &stream)
+    : stream_{stream}
+    , offset_{0}
+    , entries_{}
+    , finished_{false}
+{
+    const internal::archive_header header{internal::archive_magic, internal::archive_version, 0};
+    write(internal::as_bytes(header));
+}
+
+archive_writer::archive_writer(streams::idynamic_stream &stream, const std::uint64_t offset)
+    : stream_{stream}
+    , offset_{offset}
+    , entries_{}
+    , finished_{false}
+{
+    if (offset < internal::archive_header_size)
+        throw std::invalid_argument{"Archive data can not end before the header."};
+}
+
+archive_writer::~archive_writer() = default;
+
+void archive_writer::add(const common::string_view name, const common::uuid &id, const std::span<const std::byte> data,
+                         const archive_compression compression, const std::uint32_t alignment)
+{
+    const auto compressed = internal::compress(data, compression);
+    const auto stored = std::empty(compressed) ? data : std::span<const std::byte>{compressed};
+
+    archive_entry entry;
+    entry.id = id;
+    entry.offset = write_data(stored, alignment);
+    entry.stored_size = std::size(stored);
+    entry.size = std::size(data);
+    entry.content_hash = internal::hash_bytes(data);
+    entry.compression = std::empty(compressed) ? archive_compression::none : compression;
+    entry.alignment = alignment;
+
+    add_entry(name, entry);
+}
+
+void archive_writer::add(const container &c, const archive_compression compression, const std::uint32_t alignment)
+{
+    std::vector<std::uint8_t> data;
+    auto stream = streams::make_dynamic_stream(streams::memory_view_device{data});
+    c.write(stream);
+
+    add(c.name(), c.id(), std::as_bytes(std::span{data}), compression, alignment);
+}
+
+auto archive_writer::write_data(const std::span<const std::byte> stored, const std::uint32_t alignment)
+    -> std::uint64_t
+{
+    if (finished_)
+        throw std::logic_error{"Can not add entries to an archive that was finished."};
+
+    if (!std::has_single_bit(alignment))
+        throw std::invalid_argument{"Archive entry alignment must be a power of 2."};
+
+    write_padding(alignment);
+
+    const auto offset = offset_;
+    write(stored);
+    return offset;
+}
+
+void archive_writer::add_entry(const common::string_view name, const archive_entry &entry)
+{
+    if (finished_)
+        throw std::logic_error{"Can not add entries to an archive that was finished."};
+
+    if (std::size(entries_) >= internal::empty_bucket / 2)
+        throw std::length_error{"Too many entries in archive."};
+
+    if (!std::has_single_bit(entry.alignment) || entry.offset % entry.alignment != 0 ||
+        entry.offset < internal::archive_header_size || entry.offset + entry.stored_size > offset_)
+        throw std::invalid_argument{"Archive entry does not refer to data in the archive."};
+
+    entries_.push_back(pending_entry{common::string{name}, entry});
+}
+
+void archive_writer::finish()
+{
+    if (finished_)
+        return;
+
+    finished_ = true;
+
+    std::ranges::sort(entries_, [](const auto &lhs, const auto &rhs) { return lhs.name < rhs.name; });
+
+    const auto count = std::size(entries_);
+    const auto buckets = internal::bucket_count(count);
+
+    std::vector<internal::archive_record> records(count);
+    std::vector<std::uint32_t> name_buckets(buckets, internal::empty_bucket);
+    std::vector<std::uint32_t> uuid_buckets(buckets, internal::empty_bucket);
+    std::vector<std::byte> names;
+
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        const auto &[name, entry] = entries_[i];
+        const auto index = static_cast<std::uint32_t>(i);
+        const auto name_view = name.as_std_string_view();
+
+        if (i > 0 && entries_[i - 1].name == name)
+            throw archive_exception{};
+
+        auto &record = records[i];
+        record.id = entry.id.data;
+        record.offset = entry.offset;
+        record.stored_size = entry.stored_size;
+        record.size = entry.size;
+        record.content_hash = entry.content_hash;
+        record.name_offset = static_cast<std::uint32_t>(std::size(names));
+        record.name_size = static_cast<std::uint32_t>(std::size(name_view));
+        record.compression = static_cast<std::uint32_t>(entry.compression);
+        record.alignment = entry.alignment;
+
+        const auto name_bytes = std::as_bytes(std::span{std::data(name_view), std::size(name_view)});
+        names.insert(std::end(names), std::begin(name_bytes), std::end(name_bytes));
+
+        // Names are unique after the check above, so the name can not already be in the table.
+        [[maybe_unused]] const auto existing_name =
+            internal::insert_bucket(name_buckets, internal::hash_name(name_view), index, [](auto) { return false; });
+
+        if (entry.id.is_nil())
+            continue;
+
+        const auto existing_id = internal::insert_bucket(uuid_buckets, internal::hash_uuid(record.id), index,
+                                                         [&records, &record](const std::uint32_t other)
+                                                         { return records[other].id == record.id; });
+
+        if (existing_id != internal::empty_bucket)
+            throw archive_exception{};
+    }
+
+    if (std::size(names) > internal::empty_bucket)
+        throw std::length_error{"Names in archive are too large."};
+
+    write_padding(internal::archive_toc_alignment);
+
+    internal::archive_trailer trailer{};
+    trailer.toc_offset = offset_;
+    trailer.toc_size = internal::toc_size(count, buckets, std::size(names));
+    trailer.count = static_cast<std::uint32_t>(count);
+    trailer.bucket_count = static_cast<std::uint32_t>(buckets);
+    trailer.magic = internal::archive_magic;
+
+    write(std::as_bytes(std::span{records}));
+    write(std::as_bytes(std::span{name_buckets}));
+    write(std::as_bytes(std::span{uuid_buckets}));
+    write(names);
+    write(internal::as_bytes(trailer));
+
+    if (stream_.is_flushable())
+        stream_.flush();
+}
+
+auto archive_writer::size() const noexcept -> std::size_t
+{
+    return std::size(entries_);
+}
+
+auto archive_writer::archive_size() const noexcept -> std::uint64_t
+{
+    return offset_;
+}
+
+void archive_writer::write_padding(const std::uint32_t alignment)
+{
+    auto remaining = internal::padding_size(offset_, alignment);
+
+    while (remaining > 0)
+    {
+        const auto size = std::min(remaining, static_cast<std::uint64_t>(std::size(internal::padding)));
+        write(std::span{internal::padding}.first(size));
+        remaining -= size;
+    }
+}
+
+void archive_writer::write(const std::span<const std::byte> data)
+{
+    if (std::empty(data))
+        return;
+
+    const auto size = static_cast<std::streamsize>(std::size(data));
+
+    if (stream_.write(std::data(data), size) != size)
+        throw archive_exception{};
+
+    offset_ += std::size(data);
+}
+
+} // namespace aeon::file_container
@@ -5,53 +5,13 @@
 #include <aeon/ptree/serialization/serialization_abf.h>
 #include <aeon/streams/stream_reader.h>
 #include <aeon/streams/stream_writer.h>
-#include <aeon/streams/uuid_stream.h>
-#include <aeon/streams/length_prefix_string.h>
 #include <aeon/common/uuid.h>
-#include <aeon/common/fourcc.h>
+#include "container_format.h"
 #include <cstdint>
 
 namespace aeon::file_container
 {
 
-namespace internal
-{
-
-static constexpr std::uint32_t header_magic = common::fourcc('A', 'F', 'C', '1');
-
-struct header
-{
-    std::uint32_t fourcc = header_magic;
-    common::uuid id{};
-    std::uint32_t flags = 0;
-    std::uint64_t size = 0;
-    common::string name{};
-};
-
-template <typename device_t>
-inline auto &operator<<(streams::stream_writer<device_t> &writer, const header &h)
-{
-    writer << h.fourcc;
-    writer << h.id;
-    writer << h.flags;
-    writer << h.size;
-    writer << streams::length_prefix_string<std::uint16_t>{h.name};
-    return writer;
-}
-
-template <typename device_t>
-inline auto &operator>>(streams::stream_reader<device_t> &reader, header &h)
-{
-    reader >> h.fourcc;
-    reader >> h.id;
-    reader >> h.flags;
-    reader >> h.size;
-    reader >> streams::length_prefix_string<std::uint16_t>{h.name};
-    return reader;
-}
-
-} // namespace internal
-
 container::container(streams::idynamic_stream &stream, const common::flags<read_items> items)
     : name_{}
     , id_{}
@@ -133,7 +93,7 @@ auto container::metadata() const noexcept -> const ptree::property_tree &
     return metadata_;
 }
 
-void container::write(streams::idynamic_stream &stream) const
+void container::write(streams::idynamic_stream &stream, const ptree::serialization::abf_version metadata_version) const
 {
     internal::header header;
     header.id = id_;
@@ -146,7 +106,7 @@ void container::write(streams::idynamic_stream &stream) const
 
     writer.vector_write(data_);
 
-    ptree::serialization::to_abf(metadata_, stream);
+    ptree::serialization::to_abf(metadata_, stream, metadata_version);
 }
 
 } // namespace aeon::file_container
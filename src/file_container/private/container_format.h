@@ -0,0 +1,53 @@
+// Distributed under the BSD 2-Clause License - Copyright 2012-2023 Robin Degen
+
+#pragma once
+
+#include <aeon/streams/stream_reader.h>
+#include <aeon/streams/stream_writer.h>
+#include <aeon/streams/uuid_stream.h>
+#include <aeon/streams/length_prefix_string.h>
+#include <aeon/common/uuid.h>
+#include <aeon/common/string.h>
+#include <aeon/common/fourcc.h>
+#include <cstdint>
+
+namespace aeon::file_container::internal
+{
+
+static constexpr std::uint32_t header_magic = common::fourcc('A', 'F', 'C', '1');
+
+/*!
+ * The header at the start of a container; followed by the data (of the given size) and the ABF metadata.
+ */
+struct header
+{
+    std::uint32_t fourcc = header_magic;
+    common::uuid id{};
+    std::uint32_t flags = 0;
+    std::uint64_t size = 0;
+    common::string name{};
+};
+
+template <typename device_t>
+inline auto &operator<<(streams::stream_writer<device_t> &writer, const header &h)
+{
+    writer << h.fourcc;
+    writer << h.id;
+    writer << h.flags;
+    writer << h.size;
+    writer << streams::length_prefix_string<std::uint16_t>{h.name};
+    return writer;
+}
+
+template <typename device_t>
+inline auto &operator>>(streams::stream_reader<device_t> &reader, header &h)
+{
+    reader >> h.fourcc;
+    reader >> h.id;
+    reader >> h.flags;
+    reader >> h.size;
+    reader >> streams::length_prefix_string<std::uint16_t>{h.name};
+    return reader;
+}
+
+} // namespace aeon::file_container::internal
@@ -0,0 +1,356 @@
+// Distributed under the BSD 2-Clause License - Copyright 2012-2023 Robin Degen
+
+#include <aeon/file_container/lazy_container.h>
+#include <aeon/file_container/exception.h>
+#include <aeon/ptree/serialization/serialization_abf.h>
+#include <aeon/ptree/serialization/abf_view.h>
+#include <aeon/streams/dynamic_stream.h>
+#include <aeon/streams/stream_reader.h>
+#include <aeon/streams/devices/device.h>
+#include <aeon/streams/devices/file_device.h>
+#include <aeon/streams/tags.h>
+#include <aeon/streams/exception.h>
+#include "container_format.h"
+#include "mapped_file.h"
+#include <algorithm>
+#include <cstring>
+
+namespace aeon::file_container
+{
+
+namespace internal
+{
+
+/*!
+ * A read-only device on memory. span_device can not be used for this, since it is always an output device.
+ */
+class const_span_device final : public streams::device
+{
+public:
+    struct category : streams::input_tag, streams::input_seekable_tag, streams::has_eof_tag, streams::has_size_tag
+    {
+    };
+
+    explicit const_span_device(const std::span<const std::byte> data) noexcept
+        : data_{data}
+        , offset_{0}
+    {
+    }
+
+    auto read(std::byte *data, const std::streamsize size) noexcept -> std::streamsize
+    {
+        const auto length = std::min(static_cast<std::size_t>(size), std::size(data_) - offset_);
+        std::memcpy(data, std::data(data_) + offset_, length);
+        offset_ += length;
+        return static_cast<std::streamsize>(length);
+    }
+
+    auto seekg(const std::streamoff offset, const streams::seek_direction direction) noexcept -> bool
+    {
+        auto position = static_cast<std::streamoff>(offset_);
+
+        switch (direction)
+        {
+            case streams::seek_direction::begin:
+                position = offset;
+                break;
+            case streams::seek_direction::current:
+                position += offset;
+                break;
+            case streams::seek_direction::end:
+                position = std::ssize(data_) + offset;
+                break;
+        }
+
+        if (position < 0 || position > std::ssize(data_))
+            return false;
+
+        offset_ = static_cast<std::size_t>(position);
+        return true;
+    }
+
+    [[nodiscard]] auto tellg() const noexcept -> std::streamoff
+    {
+        return static_cast<std::streamoff>(offset_);
+    }
+
+    [[nodiscard]] auto eof() const noexcept -> bool
+    {
+        return offset_ >= std::size(data_);
+    }
+
+    [[nodiscard]] auto size() const noexcept -> std::streamoff
+    {
+        return std::ssize(data_);
+    }
+
+private:
+    std::span<const std::byte> data_;
+    std::size_t offset_;
+};
+
+template <typename device_t>
+[[nodiscard]] static auto read_header(device_t &device) -> header
+{
+    streams::stream_reader reader{device};
+
+    header h;
+
+    try
+    {
+        reader >> h;
+    }
+    catch (const streams::stream_exception &)
+    {
+        // A truncated header, or a name that does not fit.
+        throw resource_file_exception{};
+    }
+
+    if (h.fourcc != header_magic)
+        throw resource_file_exception{};
+
+    return h;
+}
+
+} // namespace internal
+
+lazy_container::lazy_container(streams::idynamic_stream &stream)
+    : name_{}
+    , id_{}
+    , data_size_{0}
+    , memory_{}
+    , mapped_file_{}
+    , entry_buffer_{}
+    , stream_{&stream}
+    , owned_stream_{}
+    , data_offset_{0}
+    , metadata_offset_{0}
+    , data_buffer_{}
+    , metadata_buffer_{}
+    , metadata_{}
+{
+    parse_header();
+}
+
+lazy_container::lazy_container(const std::span<const std::byte> data)
+    : name_{}
+    , id_{}
+    , data_size_{0}
+    , memory_{data}
+    , mapped_file_{}
+    , entry_buffer_{}
+    , stream_{nullptr}
+    , owned_stream_{}
+    , data_offset_{0}
+    , metadata_offset_{0}
+    , data_buffer_{}
+    , metadata_buffer_{}
+    , metadata_{}
+{
+    parse_header();
+}
+
+lazy_container::lazy_container(const std::filesystem::path &path)
+    : name_{}
+    , id_{}
+    , data_size_{0}
+    , memory_{}
+    , mapped_file_{}
+    , entry_buffer_{}
+    , stream_{nullptr}
+    , owned_stream_{}
+    , data_offset_{0}
+    , metadata_offset_{0}
+    , data_buffer_{}
+    , metadata_buffer_{}
+    , metadata_{}
+{
+    if (internal::mapped_file::is_supported())
+    {
+        mapped_file_ = std::make_unique<internal::mapped_file>(path, false);
+        memory_ = mapped_file_->data();
+    }
+    else
+    {
+        owned_stream_ = streams::make_dynamic_stream_ptr(streams::file_source_device{path});
+        stream_ = owned_stream_.get();
+    }
+
+    parse_header();
+}
+
+lazy_container::lazy_container(const archive &a, const archive_entry &entry)
+    : name_{}
+    , id_{}
+    , data_size_{0}
+    , memory_{}
+    , mapped_file_{}
+    , entry_buffer_{}
+    , stream_{nullptr}
+    , owned_stream_{}
+    , data_offset_{0}
+    , metadata_offset_{0}
+    , data_buffer_{}
+    , metadata_buffer_{}
+    , metadata_{}
+{
+    if (a.is_viewable(entry))
+    {
+        memory_ = a.view(entry);
+    }
+    else
+    {
+        entry_buffer_ = a.read(entry);
+        memory_ = entry_buffer_;
+    }
+
+    parse_header();
+}
+
+lazy_container::~lazy_container() = default;
+
+lazy_container::lazy_container(lazy_container &&) noexcept = default;
+
+auto lazy_container::operator=(lazy_container &&) noexcept -> lazy_container & = default;
+
+auto lazy_container::name() const noexcept -> const common::string &
+{
+    return name_;
+}
+
+auto lazy_container::id() const noexcept -> const common::uuid &
+{
+    return id_;
+}
+
+auto lazy_container::data_size() const noexcept -> std::size_t
+{
+    return static_cast<std::size_t>(data_size_);
+}
+
+auto lazy_container::is_zero_copy() const noexcept -> bool
+{
+    return !std::empty(memory_) && std::empty(entry_buffer_);
+}
+
+auto lazy_container::data() -> std::span<const std::byte>
+{
+    if (!stream_)
+        return memory_.subspan(static_cast<std::size_t>(data_offset_), static_cast<std::size_t>(data_size_));
+
+    if (!data_buffer_)
+    {
+        std::vector<std::byte> buffer(static_cast<std::size_t>(data_size_));
+
+        if (!stream_->seekg(static_cast<std::streamoff>(data_offset_), streams::seek_direction::begin) ||
+            stream_->read(std::data(buffer), std::ssize(buffer)) != std::ssize(buffer))
+            throw resource_file_exception{};
+
+        data_buffer_ = std::move(buffer);
+    }
+
+    return *data_buffer_;
+}
+
+auto lazy_container::metadata() -> const ptree::property_tree &
+{
+    if (!metadata_)
+    {
+        const auto data = metadata_data();
+        auto stream = streams::make_dynamic_stream(internal::const_span_device{data});
+
+        ptree::property_tree metadata;
+
+        if (!std::empty(data))
+            ptree::serialization::from_abf(stream, metadata);
+
+        metadata_ = std::move(metadata);
+    }
+
+    return *metadata_;
+}
+
+auto lazy_container::metadata_value(const common::string_view key) -> std::optional<ptree::property_tree>
+{
+    if (!metadata_)
+    {
+        const auto data = metadata_data();
+
+        if (ptree::serialization::abf_view::is_abf2(data))
+        {
+            const auto root = ptree::serialization::abf_view{data}.root();
+
+            if (!root.is_object())
+                return std::nullopt;
+
+            const auto value = root.find(key);
+
+            if (!value)
+                return std::nullopt;
+
+            return value->to_property_tree();
+        }
+    }
+
+    const auto &tree = metadata();
+    const common::string key_string{key};
+
+    if (!tree.is_object() || !tree.contains(key_string))
+        return std::nullopt;
+
+    return tree.at(key_string);
+}
+
+auto lazy_container::is_metadata_parsed() const noexcept -> bool
+{
+    return metadata_.has_value();
+}
+
+void lazy_container::parse_header()
+{
+    internal::header header;
+
+    if (stream_)
+    {
+        header = internal::read_header(*stream_);
+        data_offset_ = static_cast<std::uint64_t>(stream_->tellg());
+    }
+    else
+    {
+        internal::const_span_device device{memory_};
+        header = internal::read_header(device);
+        data_offset_ = static_cast<std::uint64_t>(device.tellg());
+    }
+
+    const auto total_size = stream_ ? static_cast<std::uint64_t>(stream_->size()) : std::size(memory_);
+
+    if (data_offset_ > total_size || header.size > total_size - data_offset_)
+        throw resource_file_exception{};
+
+    name_ = std::move(header.name);
+    id_ = header.id;
+    data_size_ = header.size;
+    metadata_offset_ = data_offset_ + data_size_;
+}
+
+auto lazy_container::metadata_data() -> std::span<const std::byte>
+{
+    if (!stream_)
+        return memory_.subspan(static_cast<std::size_t>(metadata_offset_));
+
+    if (!metadata_buffer_)
+    {
+        const auto size = static_cast<std::uint64_t>(stream_->size()) - metadata_offset_;
+        std::vector<std::byte> buffer(static_cast<std::size_t>(size));
+
+        if (!stream_->seekg(static_cast<std::streamoff>(metadata_offset_), streams::seek_direction::begin) ||
+            stream_->read(std::data(buffer), std::ssize(buffer)) != std::ssize(buffer))
+            throw resource_file_exception{};
+
+        metadata_buffer_ = std::move(buffer);
+    }
+
+    return *metadata_buffer_;
+}
+
+} // namespace aeon::file_container
@@ -0,0 +1,80 @@
+// Distributed under the BSD 2-Clause License - Copyright 2012-2023 Robin Degen
+
+#include "mapped_file.h"
+#include <system_error>
+
+#if (defined(AEON_PLATFORM_OS_UNIX) || defined(AEON_PLATFORM_OS_MACOS))
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+namespace aeon::file_container::internal
+{
+
+#if (defined(AEON_PLATFORM_OS_UNIX) || defined(AEON_PLATFORM_OS_MACOS))
+mapped_file::mapped_file(const std::filesystem::path &path, const bool random_access)
+    : data_{}
+{
+    const auto fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+
+    if (fd < 0)
+        throw std::system_error{errno, std::system_category(), "open"};
+
+    struct stat status
+    {
+    };
+
+    if (::fstat(fd, &status) != 0)
+    {
+        const auto error = errno;
+        ::close(fd);
+        throw std::system_error{error, std::system_category(), "fstat"};
+    }
+
+    const auto size = static_cast<std::size_t>(status.st_size);
+
+    if (size == 0)
+    {
+        ::close(fd);
+        return;
+    }
+
+    auto *const memory = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    const auto error = errno;
+
+    // The mapping keeps the file open; the descriptor is no longer needed.
+    ::close(fd);
+
+    if (memory == MAP_FAILED)
+        throw std::system_error{error, std::system_category(), "mmap"};
+
+    if (random_access)
+        ::madvise(memory, size, MADV_RANDOM);
+
+    data_ = std::span{static_cast<const std::byte *>(memory), size};
+}
+
+mapped_file::~mapped_file()
+{
+    if (!std::empty(data_))
+        ::munmap(const_cast<std::byte *>(std::data(data_)), std::size(data_));
+}
+#else
+mapped_file::mapped_file([[maybe_unused]] const std::filesystem::path &path, [[maybe_unused]] const bool random_access)
+    : data_{}
+{
+    throw std::system_error{std::make_error_code(std::errc::operation_not_supported), "mmap"};
+}
+
+mapped_file::~mapped_file() = default;
+#endif
+
+auto mapped_file::data() const noexcept -> std::span<const std::byte>
+{
+    return data_;
+}
+
+} // namespace aeon::file_container::internal
@@ -0,0 +1,52 @@
+// Distributed under the BSD 2-Clause License - Copyright 2012-2023 Robin Degen
+
+#pragma once
+
+#include <aeon/common/platform.h>
+#include <filesystem>
+#include <span>
+#include <cstddef>
+
+namespace aeon::file_container::internal
+{
+
+/*!
+ * A read-only memory mapping of a whole file. Only the pages that are accessed are actually read from disk.
+ */
+class mapped_file final
+{
+public:
+    /*!
+     * Map the given file. Throws std::system_error if the file could not be mapped. An empty file can not be mapped;
+     * the data is empty in that case.
+     *
+     * With random_access, the operating system is told not to read ahead, since the data is not accessed sequentially.
+     */
+    explicit mapped_file(const std::filesystem::path &path, const bool random_access);
+    ~mapped_file();
+
+    mapped_file(mapped_file &&) = delete;
+    auto operator=(mapped_file &&) -> mapped_file & = delete;
+
+    mapped_file(const mapped_file &) = delete;
+    auto operator=(const mapped_file &) -> mapped_file & = delete;
+
+    [[nodiscard]] auto data() const noexcept -> std::span<const std::byte>;
+
+    /*!
+     * Returns false on platforms on which files can not be mapped; the constructor always throws on those.
+     */
+    [[nodiscard]] static constexpr auto is_supported() noexcept -> bool
+    {
+#if (defined(AEON_PLATFORM_OS_UNIX) || defined(AEON_PLATFORM_OS_MACOS))
+        return true;
+#else
+        return false;
+#endif
+    }
+
+private:
+    std::span<const std::byte> data_;
+};
+
+} // namespace aeon::file_container::internal
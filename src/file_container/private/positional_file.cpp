@@ -0,0 +1,132 @@
+// Distributed under the BSD 2-Clause License - Copyright 2012-2023 Robin Degen
+
+#include "positional_file.h"
+#include <system_error>
+
+#if (defined(AEON_PLATFORM_OS_WINDOWS))
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#else
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+namespace aeon::file_container::internal
+{
+
+#if (defined(AEON_PLATFORM_OS_WINDOWS))
+// ReadFile takes a 32-bit size, so larger reads are split.
+static constexpr std::size_t max_read_size = 1u << 30;
+
+positional_file::positional_file(const std::filesystem::path &path)
+    : handle_{INVALID_HANDLE_VALUE}
+    , size_{0}
+{
+    handle_ = ::CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                            FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, nullptr);
+
+    if (handle_ == INVALID_HANDLE_VALUE)
+        throw std::system_error{static_cast<int>(::GetLastError()), std::system_category(), "CreateFileW"};
+
+    LARGE_INTEGER size{};
+
+    if (!::GetFileSizeEx(handle_, &size))
+    {
+        const auto error = ::GetLastError();
+        ::CloseHandle(handle_);
+        throw std::system_error{static_cast<int>(error), std::system_category(), "GetFileSizeEx"};
+    }
+
+    size_ = static_cast<std::uint64_t>(size.QuadPart);
+}
+
+positional_file::~positional_file()
+{
+    ::CloseHandle(handle_);
+}
+
+auto positional_file::read(const std::uint64_t offset, const std::span<std::byte> destination) const noexcept -> bool
+{
+    auto position = offset;
+    auto remaining = destination;
+
+    while (!std::empty(remaining))
+    {
+        // The offset in the OVERLAPPED structure is used instead of the file pointer of the handle.
+        OVERLAPPED overlapped{};
+        overlapped.Offset = static_cast<DWORD>(position);
+        overlapped.OffsetHigh = static_cast<DWORD>(position >> 32);
+
+        const auto size = static_cast<DWORD>(std::size(remaining) < max_read_size ? std::size(remaining) : max_read_size);
+        DWORD result = 0;
+
+        if (!::ReadFile(handle_, std::data(remaining), size, &result, &overlapped) || result == 0)
+            return false;
+
+        position += result;
+        remaining = remaining.subspan(result);
+    }
+
+    return true;
+}
+#else
+positional_file::positional_file(const std::filesystem::path &path)
+    : fd_{-1}
+    , size_{0}
+{
+    fd_ = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+
+    if (fd_ < 0)
+        throw std::system_error{errno, std::system_category(), "open"};
+
+    struct stat status
+    {
+    };
+
+    if (::fstat(fd_, &status) != 0)
+    {
+        const auto error = errno;
+        ::close(fd_);
+        throw std::system_error{error, std::system_category(), "fstat"};
+    }
+
+    size_ = static_cast<std::uint64_t>(status.st_size);
+}
+
+positional_file::~positional_file()
+{
+    ::close(fd_);
+}
+
+auto positional_file::read(const std::uint64_t offset, const std::span<std::byte> destination) const noexcept -> bool
+{
+    auto position = offset;
+    auto remaining = destination;
+
+    // A single pread may return less than was asked for.
+    while (!std::empty(remaining))
+    {
+        const auto result = ::pread(fd_, std::data(remaining), std::size(remaining), static_cast<off_t>(position));
+
+        if (result < 0 && errno == EINTR)
+            continue;
+
+        if (result <= 0)
+            return false;
+
+        position += static_cast<std::uint64_t>(result);
+        remaining = remaining.subspan(static_cast<std::size_t>(result));
+    }
+
+    return true;
+}
+#endif
+
+auto positional_file::size() const noexcept -> std::uint64_t
+{
+    return size_;
+}
+
+} // namespace aeon::file_container::internal
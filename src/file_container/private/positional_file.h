@@ -0,0 +1,50 @@
+// Distributed under the BSD 2-Clause License - Copyright 2012-2023 Robin Degen
+
+#pragma once
+
+#include <aeon/common/platform.h>
+#include <filesystem>
+#include <span>
+#include <cstdint>
+#include <cstddef>
+
+namespace aeon::file_container::internal
+{
+
+/*!
+ * A read-only file that is read at explicit offsets (pread, or ReadFile with an offset on Windows). Since there is no
+ * shared file position, reads from multiple threads run concurrently without locking.
+ */
+class positional_file final
+{
+public:
+    /*!
+     * Open the given file. Throws std::system_error if the file could not be opened.
+     */
+    explicit positional_file(const std::filesystem::path &path);
+    ~positional_file();
+
+    positional_file(positional_file &&) = delete;
+    auto operator=(positional_file &&) -> positional_file & = delete;
+
+    positional_file(const positional_file &) = delete;
+    auto operator=(const positional_file &) -> positional_file & = delete;
+
+    [[nodiscard]] auto size() const noexcept -> std::uint64_t;
+
+    /*!
+     * Fill the destination with the data at the given offset. Returns false if the data could not be read; for
+     * example because the file is shorter than expected.
+     */
+    [[nodiscard]] auto read(const std::uint64_t offset, const std::span<std::byte> destination) const noexcept -> bool;
+
+private:
+#if (defined(AEON_PLATFORM_OS_WINDOWS))
+    void *handle_;
+#else
+    int fd_;
+#endif
+    std::uint64_t size_;
+};
+
+} // namespace aeon::file_container::internal
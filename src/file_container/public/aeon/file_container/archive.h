@@ -0,0 +1,256 @@
+// Distributed under the BSD 2-Clause License - Copyright 2012-2023 Robin Degen
+
+#pragma once
+
+#include <aeon/file_container/container.h>
+#include <aeon/streams/idynamic_stream.h>
+#include <aeon/common/uuid.h>
+#include <aeon/common/string.h>
+#include <aeon/common/string_view.h>
+#include <filesystem>
+#include <optional>
+#include <memory>
+#include <vector>
+#include <span>
+#include <cstdint>
+#include <cstddef>
+
+namespace aeon::file_container
+{
+
+namespace internal
+{
+class mapped_file;
+class positional_file;
+} // namespace internal
+
+enum class archive_compression : std::uint32_t
+{
+    none = 0,
+    zlib = 1
+};
+
+enum class archive_open_mode
+{
+    // Map the whole file into memory. Only the pages that are accessed are actually read from disk, and uncompressed
+    // entries can be viewed without copying them. Falls back to positional_read on platforms without mmap.
+    memory_mapped,
+
+    // Only the table of contents is kept in memory; entries are read from the file when they are accessed.
+    positional_read
+};
+
+// The alignment of the data of an entry in the archive, unless specified otherwise.
+static constexpr std::uint32_t archive_default_alignment = 16;
+
+/*!
+ * Describes a single entry in an archive. The name refers to the table of contents of the archive, so it is only
+ * valid as long as the archive that it was returned from.
+ */
+struct archive_entry final
+{
+    common::string_view name;
+    common::uuid id;
+
+    // The offset and size of the data as stored in the archive file
+    std::uint64_t offset = 0;
+    std::uint64_t stored_size = 0;
+
+    // The size of the data after decompression
+    std::uint64_t size = 0;
+
+    // A hash of the uncompressed data
+    std::uint64_t content_hash = 0;
+
+    archive_compression compression = archive_compression::none;
+    std::uint32_t alignment = 0;
+};
+
+/*!
+ * Writes a pack of many entries into a single archive. The data of the entries is written to the stream as they are
+ * added; only the table of contents is kept in memory and written by finish().
+ *
+ * The archive starts at the current write position of the stream, which must be at the start of the stream, since
+ * all offsets in the archive are absolute.
+ */
+class archive_writer final
+{
+public:
+    explicit archive_writer(streams::idynamic_stream &stream);
+
+    /*!
+     * Continue writing an existing archive. The stream must be positioned at the given offset; either the end of the
+     * data of the existing archive (see archive::data_size), which overwrites its table of contents, or the end of the
+     * file, which leaves the existing table of contents in place as unused data. None of the existing entries are
+     * kept, unless they are added again with add_entry.
+     */
+    explicit archive_writer(streams::idynamic_stream &stream, const std::uint64_t offset);
+
+    ~archive_writer();
+
+    archive_writer(archive_writer &&) = delete;
+    auto operator=(archive_writer &&) -> archive_writer & = delete;
+
+    archive_writer(const archive_writer &) = delete;
+    auto operator=(const archive_writer &) -> archive_writer & = delete;
+
+    /*!
+     * Add an entry. Names must be unique, as must uuids that are not nil. When compression is requested but does not
+     * make the data smaller, the entry is stored uncompressed instead. The alignment must be a power of 2.
+     */
+    void add(const common::string_view name, const common::uuid &id, const std::span<const std::byte> data,
+             const archive_compression compression = archive_compression::none,
+             const std::uint32_t alignment = archive_default_alignment);
+
+    /*!
+     * Add a container as an entry, with the name and id of the container. It can be read back with
+     * archive::read_container.
+     */
+    void add(const container &c, const archive_compression compression = archive_compression::none,
+             const std::uint32_t alignment = archive_default_alignment);
+
+    /*!
+     * Write data that was already compressed (or not) by the caller at the given alignment, without adding an entry
+     * for it. Returns the offset at which the data was written. Use add_entry to add one or more entries that refer to
+     * it.
+     */
+    [[nodiscard]] auto write_data(const std::span<const std::byte> stored, const std::uint32_t alignment)
+        -> std::uint64_t;
+
+    /*!
+     * Add an entry for data that is already in the archive; either written with write_data, or kept from the archive
+     * that is continued. The name of the given entry is ignored. Multiple entries may refer to the same data.
+     */
+    void add_entry(const common::string_view name, const archive_entry &entry);
+
+    /*!
+     * Write the table of contents. Nothing can be added after this. Throws if names or uuids are not unique.
+     */
+    void finish();
+
+    /*!
+     * The amount of entries that were added.
+     */
+    [[nodiscard]] auto size() const noexcept -> std::size_t;
+
+    /*!
+     * The amount of bytes in the archive so far; the size of the whole archive after finish().
+     */
+    [[nodiscard]] auto archive_size() const noexcept -> std::uint64_t;
+
+private:
+    struct pending_entry
+    {
+        common::string name;
+        archive_entry entry;
+    };
+
+    void write_padding(const std::uint32_t alignment);
+    void write(const std::span<const std::byte> data);
+
+    streams::idynamic_stream &stream_;
+    std::uint64_t offset_;
+    std::vector<pending_entry> entries_;
+    bool finished_;
+};
+
+/*!
+ * Read access to an archive written by archive_writer. Opening an archive only reads the header and the table of
+ * contents; the data of an entry is only read when it is accessed.
+ *
+ * Entries can be listed by index (sorted by name), or found by name or uuid in O(1) through the hash tables in the
+ * table of contents. All accessors are const and can be called from multiple threads.
+ */
+class archive final
+{
+public:
+    explicit archive(const std::filesystem::path &path,
+                     const archive_open_mode mode = archive_open_mode::memory_mapped);
+
+    /*!
+     * Read an archive from memory. The data is not copied, so it must outlive the archive.
+     */
+    explicit archive(const std::span<const std::byte> data);
+
+    ~archive();
+
+    archive(archive &&) = delete;
+    auto operator=(archive &&) -> archive & = delete;
+
+    archive(const archive &) = delete;
+    auto operator=(const archive &) -> archive & = delete;
+
+    /*!
+     * The amount of entries in the archive.
+     */
+    [[nodiscard]] auto size() const noexcept -> std::size_t;
+
+    /*!
+     * The offset of the end of the data of all entries; the table of contents starts here.
+     */
+    [[nodiscard]] auto data_size() const noexcept -> std::uint64_t;
+
+    /*!
+     * Get an entry by index. Entries are sorted by name.
+     */
+    [[nodiscard]] auto entry(const std::size_t index) const -> archive_entry;
+
+    [[nodiscard]] auto find(const common::string_view name) const -> std::optional<archive_entry>;
+    [[nodiscard]] auto find(const common::uuid &id) const -> std::optional<archive_entry>;
+
+    [[nodiscard]] auto contains(const common::string_view name) const -> bool;
+    [[nodiscard]] auto contains(const common::uuid &id) const -> bool;
+
+    /*!
+     * Read and decompress the data of an entry.
+     */
+    [[nodiscard]] auto read(const archive_entry &entry) const -> std::vector<std::byte>;
+
+    /*!
+     * Read and decompress the data of an entry into the given buffer, which must be exactly entry.size bytes.
+     */
+    void read(const archive_entry &entry, const std::span<std::byte> destination) const;
+
+    /*!
+     * Returns true if the data of the given entry can be viewed in place, which is the case for uncompressed entries
+     * in a memory mapped or in memory archive.
+     */
+    [[nodiscard]] auto is_viewable(const archive_entry &entry) const noexcept -> bool;
+
+    /*!
+     * A view on the data of an entry, without copying it. Throws if the entry is not viewable.
+     */
+    [[nodiscard]] auto view(const archive_entry &entry) const -> std::span<const std::byte>;
+
+    /*!
+     * Read an entry that was added as a container.
+     */
+    [[nodiscard]] auto read_container(const archive_entry &entry,
+                                      const common::flags<read_items> items = read_items::all) const
+        -> std::unique_ptr<container>;
+
+private:
+    void parse();
+
+    [[nodiscard]] auto record_entry(const std::size_t index) const -> archive_entry;
+    [[nodiscard]] auto stored_data(const archive_entry &entry, std::vector<std::byte> &buffer) const
+        -> std::span<const std::byte>;
+    void read_file(const std::uint64_t offset, const std::span<std::byte> destination) const;
+
+    // The whole archive, if it is memory mapped or in memory.
+    std::span<const std::byte> data_;
+
+    // The table of contents; a part of data_, or toc_buffer_ when reading from a file.
+    std::span<const std::byte> toc_;
+    std::vector<std::byte> toc_buffer_;
+
+    std::uint64_t file_size_;
+    std::uint64_t toc_offset_;
+    std::size_t count_;
+    std::size_t bucket_count_;
+
+    std::unique_ptr<internal::mapped_file> mapped_file_;
+    std::unique_ptr<internal::positional_file> file_;
+};
+
+} // namespace aeon::file_container
@@ -0,0 +1,154 @@
+// Distributed under the BSD 2-Clause License - Copyright 2012-2023 Robin Degen
+
+#pragma once
+
+#include <aeon/file_container/archive.h>
+#include <aeon/file_container/container.h>
+#include <aeon/streams/idynamic_stream.h>
+#include <aeon/common/uuid.h>
+#include <aeon/common/string.h>
+#include <filesystem>
+#include <functional>
+#include <chrono>
+#include <span>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace aeon::file_container
+{
+
+// An incremental build rewrites the whole archive when less than this part of the existing data would still be used.
+static constexpr double archive_builder_compaction_ratio = 0.5;
+
+struct archive_builder_statistics final
+{
+    // The amount of entries in the archive
+    std::size_t entries = 0;
+
+    // Entries of which the data was compressed and written
+    std::size_t written_entries = 0;
+
+    // Entries that refer to the data of another entry with the same content
+    std::size_t deduplicated_entries = 0;
+
+    // Entries of which the data was kept from the existing archive in an incremental build
+    std::size_t unchanged_entries = 0;
+
+    // True if an incremental build had to rewrite the whole archive
+    bool rebuilt = false;
+
+    // The total size of the data of all entries, before compression and deduplication
+    std::uint64_t input_bytes = 0;
+
+    // The amount of entry data that was actually written
+    std::uint64_t written_bytes = 0;
+
+    std::uint64_t archive_size = 0;
+
+    // The time spent comparing the entries with an existing archive, loading, compressing and writing, and the total
+    // time
+    std::chrono::nanoseconds hash_time{};
+    std::chrono::nanoseconds write_time{};
+    std::chrono::nanoseconds elapsed{};
+
+    /*!
+     * The input bytes per second over the whole build.
+     */
+    [[nodiscard]] auto throughput() const noexcept -> double;
+};
+
+/*!
+ * Builds an archive from many entries, using multiple threads.
+ *
+ * Entries are loaded, hashed and compressed in parallel, and written to the archive in the order in which they were
+ * added as soon as they are ready. Only a few entries are loaded ahead of the one that is being written, and the data
+ * of an entry is released once it is written, so memory use does not grow with the size of the archive. An entry with
+ * the same content as one that was already written (same hash, and compared byte for byte with the data read back from
+ * the archive) refers to that data instead of storing it again.
+ *
+ * An incremental build updates an existing archive file in place. Entries of which the content is already in the
+ * archive (under any name) keep their data where it is; only new and changed data is appended, followed by a new table
+ * of contents. The existing archive stays valid until the build is complete, and is restored if the build fails. If
+ * too much of the existing data (including old tables of contents) would become unused, the archive is rewritten into
+ * a temporary file which then replaces it.
+ */
+class archive_builder final
+{
+public:
+    explicit archive_builder(const unsigned int concurrency = default_concurrency());
+    ~archive_builder();
+
+    archive_builder(archive_builder &&) = delete;
+    auto operator=(archive_builder &&) -> archive_builder & = delete;
+
+    archive_builder(const archive_builder &) = delete;
+    auto operator=(const archive_builder &) -> archive_builder & = delete;
+
+    void add(common::string name, const common::uuid &id, std::vector<std::byte> data,
+             const archive_compression compression = archive_compression::none,
+             const std::uint32_t alignment = archive_default_alignment);
+
+    /*!
+     * Add an entry with the contents of a file. The file is read on one of the build threads.
+     */
+    void add(common::string name, const common::uuid &id, std::filesystem::path path,
+             const archive_compression compression = archive_compression::none,
+             const std::uint32_t alignment = archive_default_alignment);
+
+    /*!
+     * Add a container as an entry, with the name and id of the container. The container is serialized immediately.
+     */
+    void add(const container &c, const archive_compression compression = archive_compression::none,
+             const std::uint32_t alignment = archive_default_alignment);
+
+    /*!
+     * The amount of entries that were added.
+     */
+    [[nodiscard]] auto size() const noexcept -> std::size_t;
+
+    /*!
+     * Build a new archive into the given stream, which must be at the start of the stream. Duplicate content is only
+     * detected if the stream can also be read (ie. a memory stream). All entries are removed from the builder
+     * afterwards, so it can be used for another archive.
+     */
+    auto build(streams::idynamic_stream &stream) -> archive_builder_statistics;
+
+    /*!
+     * Build the archive file at the given path. If it already exists, it is updated incrementally. All entries are
+     * removed from the builder afterwards.
+     */
+    auto build(const std::filesystem::path &path) -> archive_builder_statistics;
+
+    [[nodiscard]] static auto default_concurrency() noexcept -> unsigned int;
+
+private:
+    struct entry
+    {
+        common::string name;
+        common::uuid id;
+
+        // The data of an entry that was added from memory, until it is written. Otherwise the file it is loaded from.
+        std::vector<std::byte> data{};
+        std::filesystem::path path{};
+        archive_compression compression = archive_compression::none;
+        std::uint32_t alignment = archive_default_alignment;
+
+        std::uint64_t content_hash = 0;
+
+        // The data of this entry as it is, or will be, stored in the archive
+        archive_entry stored{};
+        bool has_stored = false;
+    };
+
+    // Reads data back from the archive that is being written; empty if that is not possible.
+    using read_function = std::function<bool(const std::uint64_t offset, const std::span<std::byte> destination)>;
+
+    void match_existing(const archive &existing, archive_builder_statistics &statistics);
+    void write(archive_writer &writer, archive_builder_statistics &statistics, const read_function &read_back);
+
+    unsigned int concurrency_;
+    std::vector<entry> entries_;
+};
+
+} // namespace aeon::file_container
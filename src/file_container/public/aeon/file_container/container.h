@@ -3,6 +3,7 @@
 #pragma once
 
 #include <aeon/ptree/ptree.h>
+#include <aeon/ptree/serialization/serialization_abf.h>
 #include <aeon/streams/idynamic_stream.h>
 #include <aeon/streams/devices/memory_view_device.h>
 #include <aeon/common/uuid.h>
@@ -51,7 +52,12 @@ public:
     [[nodiscard]] auto metadata() noexcept -> ptree::property_tree &;
     [[nodiscard]] auto metadata() const noexcept -> const ptree::property_tree &;
 
-    void write(streams::idynamic_stream &stream) const;
+    /*!
+     * Write the container. With ABF2 metadata, single metadata values can be read by lazy_container without decoding
+     * all metadata.
+     */
+    void write(streams::idynamic_stream &stream,
+               const ptree::serialization::abf_version metadata_version = ptree::serialization::abf_version::v1) const;
 
 private:
     common::string name_;
@@ -11,4 +11,12 @@ class resource_file_exception : public std::exception
 {
 };
 
+/*!
+ * Thrown when an archive is malformed or could not be read or written, or when it is written with duplicate names
+ * or uuids.
+ */
+class archive_exception : public resource_file_exception
+{
+};
+
 } // namespace aeon::file_container
@@ -0,0 +1,125 @@
+// Distributed under the BSD 2-Clause License - Copyright 2012-2023 Robin Degen
+
+#pragma once
+
+#include <aeon/file_container/archive.h>
+#include <aeon/ptree/ptree.h>
+#include <aeon/streams/idynamic_stream.h>
+#include <aeon/common/uuid.h>
+#include <aeon/common/string.h>
+#include <aeon/common/string_view.h>
+#include <filesystem>
+#include <optional>
+#include <memory>
+#include <vector>
+#include <span>
+#include <cstdint>
+#include <cstddef>
+
+namespace aeon::file_container
+{
+
+/*!
+ * Read access to a container (as written by container::write) that only reads what is used. Opening it only reads the
+ * header; the data and the metadata are read and parsed when they are first accessed.
+ *
+ * When the container is in memory, or in a memory mapped file or archive, the data is never copied; data() returns a
+ * view into that memory. Single metadata values can be read without decoding all metadata if it was written as ABF2.
+ *
+ * Unlike container, this is read-only. It is not thread-safe.
+ */
+class lazy_container final
+{
+public:
+    /*!
+     * Read a container from a seekable stream, starting at the current read position. The stream must outlive this
+     * object, and the metadata ends at the end of the stream.
+     */
+    explicit lazy_container(streams::idynamic_stream &stream);
+
+    /*!
+     * Read a container from memory. The data is not copied, so it must outlive this object.
+     */
+    explicit lazy_container(const std::span<const std::byte> data);
+
+    /*!
+     * Read a container file; memory mapped where possible.
+     */
+    explicit lazy_container(const std::filesystem::path &path);
+
+    /*!
+     * Read a container that was added to an archive. Viewable (uncompressed) entries of a memory mapped or in memory
+     * archive are not copied; the archive must outlive this object. Other entries are read and decompressed at once.
+     */
+    explicit lazy_container(const archive &a, const archive_entry &entry);
+
+    ~lazy_container();
+
+    lazy_container(lazy_container &&) noexcept;
+    auto operator=(lazy_container &&) noexcept -> lazy_container &;
+
+    lazy_container(const lazy_container &) = delete;
+    auto operator=(const lazy_container &) -> lazy_container & = delete;
+
+    [[nodiscard]] auto name() const noexcept -> const common::string &;
+    [[nodiscard]] auto id() const noexcept -> const common::uuid &;
+
+    /*!
+     * The size of the data, which is known without reading it.
+     */
+    [[nodiscard]] auto data_size() const noexcept -> std::size_t;
+
+    /*!
+     * Returns true if data() is a view into memory that was given, mapped or viewed from an archive, rather than a
+     * copy that was read.
+     */
+    [[nodiscard]] auto is_zero_copy() const noexcept -> bool;
+
+    /*!
+     * The data of the container. When reading from a stream, it is read on the first call.
+     */
+    [[nodiscard]] auto data() -> std::span<const std::byte>;
+
+    /*!
+     * All metadata. It is read and parsed on the first call.
+     */
+    [[nodiscard]] auto metadata() -> const ptree::property_tree &;
+
+    /*!
+     * A single value of the root object of the metadata, if it exists. ABF2 metadata is queried in place; ABF1
+     * metadata must be parsed completely, as with metadata().
+     */
+    [[nodiscard]] auto metadata_value(const common::string_view key) -> std::optional<ptree::property_tree>;
+
+    /*!
+     * Returns true if the metadata was parsed completely.
+     */
+    [[nodiscard]] auto is_metadata_parsed() const noexcept -> bool;
+
+private:
+    void parse_header();
+    [[nodiscard]] auto metadata_data() -> std::span<const std::byte>;
+
+    common::string name_;
+    common::uuid id_;
+    std::uint64_t data_size_;
+
+    // The whole container, if it is in memory or mapped.
+    std::span<const std::byte> memory_;
+    std::unique_ptr<internal::mapped_file> mapped_file_;
+    std::vector<std::byte> entry_buffer_;
+
+    // The stream to read from otherwise.
+    streams::idynamic_stream *stream_;
+    std::unique_ptr<streams::idynamic_stream> owned_stream_;
+
+    // Offsets of the data and metadata; relative to memory_, or positions in the stream.
+    std::uint64_t data_offset_;
+    std::uint64_t metadata_offset_;
+
+    std::optional<std::vector<std::byte>> data_buffer_;
+    std::optional<std::vector<std::byte>> metadata_buffer_;
+    std::optional<ptree::property_tree> metadata_;
+};
+
+} // namespace aeon::file_container
@@ -0,0 +1,307 @@
+// Distributed under the BSD 2-Clause License - Copyright 2012-2023 Robin Degen
+
+#include <aeon/file_container/archive.h>
+#include <aeon/file_container/exception.h>
+#include <aeon/streams/dynamic_stream.h>
+#include <aeon/streams/stream_writer.h>
+#include <aeon/streams/stream_reader.h>
+#include <aeon/streams/devices/memory_view_device.h>
+#include <aeon/streams/devices/file_device.h>
+#include <aeon/common/tempfile.h>
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <thread>
+#include <string>
+#include <vector>
+
+using namespace aeon;
+
+namespace
+{
+
+[[nodiscard]] auto make_data(const std::size_t size, const bool compressible) -> std::vector<std::byte>
+{
+    std::vector<std::byte> data(size);
+
+    std::uint32_t state = 0x12345678;
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        state = state * 1664525u + 1013904223u;
+        data[i] = compressible ? static_cast<std::byte>('a' + (i / 64) % 4) : static_cast<std::byte>(state >> 24);
+    }
+
+    return data;
+}
+
+[[nodiscard]] auto entry_name(const std::size_t index) -> std::string
+{
+    return "assets/texture_" + std::to_string(index) + ".bin";
+}
+
+struct archive_content
+{
+    std::vector<common::uuid> ids;
+    std::vector<std::vector<std::byte>> data;
+};
+
+[[nodiscard]] auto write_archive(streams::idynamic_stream &stream, const std::size_t count) -> archive_content
+{
+    archive_content content;
+    file_container::archive_writer writer{stream};
+
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        const auto compression = (i % 2 == 0) ? file_container::archive_compression::zlib
+                                              : file_container::archive_compression::none;
+        const auto alignment = (i % 3 == 0) ? 4096u : file_container::archive_default_alignment;
+
+        content.ids.push_back(common::uuid::generate());
+        content.data.push_back(make_data(100 + i * 37, i % 4 != 3));
+        writer.add(entry_name(i), content.ids.back(), content.data.back(), compression, alignment);
+    }
+
+    writer.finish();
+    return content;
+}
+
+void check_archive(const file_container::archive &archive, const archive_content &content)
+{
+    ASSERT_EQ(std::size(content.data), archive.size());
+
+    for (std::size_t i = 0; i < std::size(content.data); ++i)
+    {
+        const auto by_name = archive.find(entry_name(i));
+        ASSERT_TRUE(by_name.has_value());
+        EXPECT_EQ(entry_name(i), by_name->name);
+        EXPECT_EQ(content.ids[i], by_name->id);
+        EXPECT_EQ(std::size(content.data[i]), by_name->size);
+        EXPECT_EQ(0u, by_name->offset % by_name->alignment);
+        EXPECT_EQ(content.data[i], archive.read(*by_name));
+
+        const auto by_id = archive.find(content.ids[i]);
+        ASSERT_TRUE(by_id.has_value());
+        EXPECT_EQ(by_name->name, by_id->name);
+        EXPECT_EQ(by_name->offset, by_id->offset);
+    }
+
+    EXPECT_FALSE(archive.find("does_not_exist").has_value());
+    EXPECT_FALSE(archive.contains(common::uuid::generate()));
+    EXPECT_FALSE(archive.contains(common::uuid::nil()));
+}
+
+} // namespace
+
+TEST(test_archive, write_and_read_in_memory)
+{
+    std::vector<std::uint8_t> buffer;
+    auto stream = streams::make_dynamic_stream(streams::memory_view_device{buffer});
+    const auto content = write_archive(stream, 50);
+
+    const file_container::archive archive{std::as_bytes(std::span{buffer})};
+    check_archive(archive, content);
+
+    // Entries are listed by name.
+    for (std::size_t i = 1; i < archive.size(); ++i)
+        EXPECT_LT(archive.entry(i - 1).name, archive.entry(i).name);
+
+    EXPECT_THROW([[maybe_unused]] const auto entry = archive.entry(archive.size()), std::out_of_range);
+}
+
+TEST(test_archive, compression_and_views)
+{
+    std::vector<std::uint8_t> buffer;
+    auto stream = streams::make_dynamic_stream(streams::memory_view_device{buffer});
+
+    const auto compressible = make_data(64 * 1024, true);
+    const auto random = make_data(64 * 1024, false);
+
+    {
+        file_container::archive_writer writer{stream};
+        writer.add("compressible", common::uuid::nil(), compressible, file_container::archive_compression::zlib);
+        writer.add("random", common::uuid::nil(), random, file_container::archive_compression::zlib);
+        writer.add("empty", common::uuid::nil(), {});
+        writer.finish();
+    }
+
+    const file_container::archive archive{std::as_bytes(std::span{buffer})};
+
+    const auto compressed = archive.find("compressible").value();
+    EXPECT_EQ(file_container::archive_compression::zlib, compressed.compression);
+    EXPECT_LT(compressed.stored_size, compressed.size);
+    EXPECT_FALSE(archive.is_viewable(compressed));
+    EXPECT_THROW([[maybe_unused]] const auto view = archive.view(compressed), std::invalid_argument);
+    EXPECT_EQ(compressible, archive.read(compressed));
+
+    // Random data does not compress, so it is stored as is and can be viewed in place.
+    const auto stored = archive.find("random").value();
+    EXPECT_EQ(file_container::archive_compression::none, stored.compression);
+    ASSERT_TRUE(archive.is_viewable(stored));
+
+    const auto view = archive.view(stored);
+    EXPECT_EQ(reinterpret_cast<const std::byte *>(std::data(buffer)) + stored.offset, std::data(view));
+    EXPECT_TRUE(std::equal(std::begin(view), std::end(view), std::begin(random), std::end(random)));
+
+    const auto empty = archive.find("empty").value();
+    EXPECT_EQ(0u, empty.size);
+    EXPECT_TRUE(std::empty(archive.read(empty)));
+
+    // Nil uuids are not indexed.
+    EXPECT_FALSE(archive.find(common::uuid::nil()).has_value());
+}
+
+TEST(test_archive, open_from_file)
+{
+    const auto path = common::generate_temporary_file_path();
+
+    archive_content content;
+
+    {
+        auto stream = streams::make_dynamic_stream(streams::file_sink_device{path});
+        content = write_archive(stream, 20);
+    }
+
+    {
+        const file_container::archive archive{path, file_container::archive_open_mode::memory_mapped};
+        check_archive(archive, content);
+    }
+
+    {
+        const file_container::archive archive{path, file_container::archive_open_mode::positional_read};
+        check_archive(archive, content);
+
+        const auto entry = archive.entry(0);
+        EXPECT_FALSE(archive.is_viewable(entry));
+    }
+
+    std::filesystem::remove(path);
+}
+
+TEST(test_archive, concurrent_positional_reads)
+{
+    const auto path = common::generate_temporary_file_path();
+
+    archive_content content;
+
+    {
+        auto stream = streams::make_dynamic_stream(streams::file_sink_device{path});
+        content = write_archive(stream, 20);
+    }
+
+    {
+        const file_container::archive archive{path, file_container::archive_open_mode::positional_read};
+
+        std::vector<std::thread> threads;
+        std::vector<int> mismatches(8, 0);
+
+        for (std::size_t t = 0; t < std::size(mismatches); ++t)
+        {
+            threads.emplace_back(
+                [&archive, &content, &mismatches, t]()
+                {
+                    for (auto round = 0; round < 50; ++round)
+                    {
+                        for (std::size_t i = 0; i < archive.size(); ++i)
+                        {
+                            const auto index = (i + t) % archive.size();
+                            const auto entry = archive.find(entry_name(index));
+
+                            if (!entry || archive.read(*entry) != content.data[index])
+                                ++mismatches[t];
+                        }
+                    }
+                });
+        }
+
+        for (auto &thread : threads)
+            thread.join();
+
+        for (const auto count : mismatches)
+            EXPECT_EQ(0, count);
+    }
+
+    std::filesystem::remove(path);
+}
+
+TEST(test_archive, store_containers)
+{
+    std::vector<std::uint8_t> buffer;
+    auto stream = streams::make_dynamic_stream(streams::memory_view_device{buffer});
+
+    const auto id = common::uuid::generate();
+    const common::string test_data = "This is test data.";
+
+    {
+        file_container::container c{"container", id};
+        c.metadata()["test_metadata"] = 1337;
+
+        auto data_stream = c.stream();
+        streams::stream_writer writer{data_stream};
+        writer << test_data;
+
+        file_container::archive_writer archive_writer{stream};
+        archive_writer.add(c, file_container::archive_compression::zlib);
+        archive_writer.finish();
+    }
+
+    const file_container::archive archive{std::as_bytes(std::span{buffer})};
+    const auto entry = archive.find(id);
+    ASSERT_TRUE(entry.has_value());
+    EXPECT_EQ("container", entry->name);
+
+    const auto c = archive.read_container(*entry);
+    EXPECT_EQ(id, c->id());
+    EXPECT_EQ(1337, c->metadata().at("test_metadata"));
+
+    auto data_stream = c->stream();
+    streams::stream_reader reader{data_stream};
+    EXPECT_EQ(test_data, reader.read_to_string());
+}
+
+TEST(test_archive, duplicates_are_rejected)
+{
+    const auto data = make_data(16, true);
+
+    {
+        std::vector<std::uint8_t> buffer;
+        auto stream = streams::make_dynamic_stream(streams::memory_view_device{buffer});
+        file_container::archive_writer writer{stream};
+        writer.add("name", common::uuid::generate(), data);
+        writer.add("name", common::uuid::generate(), data);
+        EXPECT_THROW(writer.finish(), file_container::archive_exception);
+    }
+
+    {
+        std::vector<std::uint8_t> buffer;
+        auto stream = streams::make_dynamic_stream(streams::memory_view_device{buffer});
+        const auto id = common::uuid::generate();
+        file_container::archive_writer writer{stream};
+        writer.add("a", id, data);
+        writer.add("b", id, data);
+        EXPECT_THROW(writer.finish(), file_container::archive_exception);
+    }
+
+    {
+        std::vector<std::uint8_t> buffer;
+        auto stream = streams::make_dynamic_stream(streams::memory_view_device{buffer});
+        file_container::archive_writer writer{stream};
+        EXPECT_THROW(writer.add("a", common::uuid::nil(), data, file_container::archive_compression::none, 3),
+                     std::invalid_argument);
+    }
+}
+
+TEST(test_archive, malformed_archives_are_rejected)
+{
+    std::vector<std::uint8_t> buffer;
+    auto stream = streams::make_dynamic_stream(streams::memory_view_device{buffer});
+    [[maybe_unused]] const auto content = write_archive(stream, 5);
+
+    EXPECT_THROW(file_container::archive{std::span<const std::byte>{}}, file_container::archive_exception);
+
+    auto truncated = std::as_bytes(std::span{buffer}).first(std::size(buffer) - 1);
+    EXPECT_THROW(file_container::archive{truncated}, file_container::archive_exception);
+
+    auto corrupt = buffer;
+    corrupt[std::size(corrupt) - 32] = 0xff; // toc offset
+    corrupt[std::size(corrupt) - 26] = 0xff;
+    EXPECT_THROW(file_container::archive{std::as_bytes(std::span{corrupt})}, file_container::archive_exception);
+}
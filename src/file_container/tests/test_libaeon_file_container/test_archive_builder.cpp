@@ -0,0 +1,307 @@
+// Distributed under the BSD 2-Clause License - Copyright 2012-2023 Robin Degen
+
+#include <aeon/file_container/archive_builder.h>
+#include <aeon/file_container/exception.h>
+#include <aeon/streams/dynamic_stream.h>
+#include <aeon/streams/devices/memory_view_device.h>
+#include <aeon/streams/devices/file_device.h>
+#include <aeon/common/tempfile.h>
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+using namespace aeon;
+
+namespace
+{
+
+[[nodiscard]] auto make_data(const std::size_t size, const std::uint32_t seed) -> std::vector<std::byte>
+{
+    std::vector<std::byte> data(size);
+
+    auto state = seed;
+    for (auto &value : data)
+    {
+        state = state * 1664525u + 1013904223u;
+        value = static_cast<std::byte>('a' + (state >> 28));
+    }
+
+    return data;
+}
+
+[[nodiscard]] auto entry_name(const std::size_t index) -> common::string
+{
+    return common::string{"entry_" + std::to_string(index)};
+}
+
+} // namespace
+
+TEST(test_archive_builder, build_in_parallel)
+{
+    constexpr std::size_t count = 200;
+
+    file_container::archive_builder builder{4};
+    std::vector<std::vector<std::byte>> expected;
+
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        expected.push_back(make_data(1000 + i * 13, static_cast<std::uint32_t>(i)));
+        builder.add(entry_name(i), common::uuid::generate(), expected.back(),
+                    file_container::archive_compression::zlib);
+    }
+
+    std::vector<std::uint8_t> buffer;
+    auto stream = streams::make_dynamic_stream(streams::memory_view_device{buffer});
+    const auto statistics = builder.build(stream);
+
+    EXPECT_EQ(0u, builder.size());
+    EXPECT_EQ(count, statistics.entries);
+    EXPECT_EQ(count, statistics.written_entries);
+    EXPECT_EQ(0u, statistics.deduplicated_entries);
+    EXPECT_EQ(std::size(buffer), statistics.archive_size);
+    EXPECT_LT(statistics.written_bytes, statistics.input_bytes);
+    EXPECT_GT(statistics.throughput(), 0.0);
+
+    const file_container::archive archive{std::as_bytes(std::span{buffer})};
+    ASSERT_EQ(count, archive.size());
+
+    for (std::size_t i = 0; i < count; ++i)
+        EXPECT_EQ(expected[i], archive.read(archive.find(entry_name(i)).value()));
+}
+
+TEST(test_archive_builder, deduplicate_content)
+{
+    const auto shared = make_data(4096, 1);
+    const auto unique = make_data(4096, 2);
+
+    file_container::archive_builder builder{2};
+    builder.add("a", common::uuid::generate(), shared);
+    builder.add("b", common::uuid::generate(), unique);
+    builder.add("c", common::uuid::generate(), shared);
+    builder.add("d", common::uuid::generate(), shared, file_container::archive_compression::none, 4096);
+
+    std::vector<std::uint8_t> buffer;
+    auto stream = streams::make_dynamic_stream(streams::memory_view_device{buffer});
+    const auto statistics = builder.build(stream);
+
+    EXPECT_EQ(4u, statistics.entries);
+    EXPECT_EQ(1u, statistics.deduplicated_entries);
+    EXPECT_EQ(3u, statistics.written_entries);
+
+    const file_container::archive archive{std::as_bytes(std::span{buffer})};
+    const auto a = archive.find("a").value();
+    const auto c = archive.find("c").value();
+    const auto d = archive.find("d").value();
+
+    EXPECT_EQ(a.offset, c.offset);
+    EXPECT_NE(a.id, c.id);
+    EXPECT_EQ(shared, archive.read(c));
+
+    // The entry with the larger alignment can not share the data of an entry with a smaller alignment.
+    EXPECT_NE(a.offset, d.offset);
+    EXPECT_EQ(0u, d.offset % 4096);
+}
+
+TEST(test_archive_builder, incremental_build)
+{
+    constexpr std::size_t count = 20;
+
+    const auto path = common::generate_temporary_file_path();
+
+    std::vector<common::uuid> ids;
+    std::vector<std::vector<std::byte>> expected;
+
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        ids.push_back(common::uuid::generate());
+        expected.push_back(make_data(2000, static_cast<std::uint32_t>(i)));
+    }
+
+    {
+        file_container::archive_builder builder{2};
+
+        for (std::size_t i = 0; i < count; ++i)
+            builder.add(entry_name(i), ids[i], expected[i], file_container::archive_compression::zlib);
+
+        const auto statistics = builder.build(path);
+        EXPECT_EQ(count, statistics.written_entries);
+        EXPECT_EQ(std::filesystem::file_size(path), statistics.archive_size);
+    }
+
+    // Change one entry, rename another and add a new one; everything else is kept where it is.
+    expected[3] = make_data(3000, 1000);
+    expected.push_back(make_data(500, 1001));
+    ids.push_back(common::uuid::generate());
+
+    {
+        file_container::archive_builder builder{2};
+
+        for (std::size_t i = 0; i < std::size(expected); ++i)
+        {
+            const auto name = (i == 5) ? common::string{"renamed"} : entry_name(i);
+            builder.add(name, ids[i], expected[i], file_container::archive_compression::zlib);
+        }
+
+        const auto statistics = builder.build(path);
+        EXPECT_FALSE(statistics.rebuilt);
+        EXPECT_EQ(count + 1, statistics.entries);
+        EXPECT_EQ(count - 1, statistics.unchanged_entries);
+        EXPECT_EQ(2u, statistics.written_entries);
+        EXPECT_EQ(std::filesystem::file_size(path), statistics.archive_size);
+    }
+
+    {
+        const file_container::archive archive{path};
+        ASSERT_EQ(count + 1, archive.size());
+        EXPECT_FALSE(archive.contains(entry_name(5)));
+        EXPECT_EQ(expected[5], archive.read(archive.find("renamed").value()));
+
+        for (std::size_t i = 0; i < std::size(expected); ++i)
+            EXPECT_EQ(expected[i], archive.read(archive.find(ids[i]).value()));
+    }
+
+    // When most of the existing data is no longer used, the archive is rewritten.
+    {
+        file_container::archive_builder builder{2};
+        builder.add("only", common::uuid::generate(), make_data(100, 2000));
+
+        const auto statistics = builder.build(path);
+        EXPECT_TRUE(statistics.rebuilt);
+        EXPECT_EQ(1u, statistics.written_entries);
+
+        const file_container::archive archive{path};
+        EXPECT_EQ(1u, archive.size());
+        EXPECT_EQ(std::filesystem::file_size(path), statistics.archive_size);
+    }
+
+    std::filesystem::remove(path);
+}
+
+TEST(test_archive_builder, failed_incremental_build_keeps_the_existing_archive)
+{
+    constexpr std::size_t count = 10;
+
+    const auto path = common::generate_temporary_file_path();
+
+    std::vector<std::vector<std::byte>> expected;
+
+    {
+        file_container::archive_builder builder{2};
+
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            expected.push_back(make_data(2000, static_cast<std::uint32_t>(i)));
+            builder.add(entry_name(i), common::uuid::generate(), expected[i]);
+        }
+
+        [[maybe_unused]] const auto statistics = builder.build(path);
+    }
+
+    const auto size = std::filesystem::file_size(path);
+
+    // The new data is written before the duplicate name is found, when the table of contents is written.
+    {
+        file_container::archive_builder builder{2};
+
+        for (std::size_t i = 0; i < count; ++i)
+            builder.add(entry_name(i), common::uuid::generate(), expected[i]);
+
+        builder.add("duplicate", common::uuid::generate(), make_data(1000, 1000));
+        builder.add("duplicate", common::uuid::generate(), make_data(1000, 1001));
+
+        EXPECT_THROW([[maybe_unused]] const auto statistics = builder.build(path), file_container::archive_exception);
+    }
+
+    EXPECT_EQ(size, std::filesystem::file_size(path));
+
+    {
+        const file_container::archive archive{path};
+        ASSERT_EQ(count, archive.size());
+        EXPECT_FALSE(archive.contains("duplicate"));
+
+        for (std::size_t i = 0; i < count; ++i)
+            EXPECT_EQ(expected[i], archive.read(archive.find(entry_name(i)).value()));
+    }
+
+    std::filesystem::remove(path);
+}
+
+TEST(test_archive_builder, add_files)
+{
+    const auto input_path = common::generate_temporary_file_path();
+    const auto archive_path = common::generate_temporary_file_path();
+    const auto data = make_data(10000, 42);
+
+    {
+        streams::file_sink_device file{input_path};
+        file.write(std::data(data), std::ssize(data));
+    }
+
+    file_container::archive_builder builder;
+    builder.add("file", common::uuid::generate(), input_path, file_container::archive_compression::zlib);
+    const auto statistics = builder.build(archive_path);
+    EXPECT_EQ(std::size(data), statistics.input_bytes);
+
+    {
+        const file_container::archive archive{archive_path};
+        EXPECT_EQ(data, archive.read(archive.find("file").value()));
+    }
+
+    std::filesystem::remove(input_path);
+    std::filesystem::remove(archive_path);
+}
+
+TEST(test_archive_builder, deduplicate_files_against_the_written_archive)
+{
+    const auto input_path = common::generate_temporary_file_path();
+    const auto archive_path = common::generate_temporary_file_path();
+    const auto data = make_data(10000, 42);
+
+    {
+        streams::file_sink_device file{input_path};
+        file.write(std::data(data), std::ssize(data));
+    }
+
+    // The duplicates are compared with the compressed data that was already written to the archive file.
+    file_container::archive_builder builder{2};
+    builder.add("file", common::uuid::generate(), input_path, file_container::archive_compression::zlib);
+    builder.add("other", common::uuid::generate(), make_data(10000, 43), file_container::archive_compression::zlib);
+    builder.add("same_file", common::uuid::generate(), input_path, file_container::archive_compression::zlib);
+    builder.add("same_data", common::uuid::generate(), data);
+
+    const auto statistics = builder.build(archive_path);
+    EXPECT_EQ(4u, statistics.entries);
+    EXPECT_EQ(2u, statistics.written_entries);
+    EXPECT_EQ(2u, statistics.deduplicated_entries);
+    EXPECT_EQ(4 * std::size(data), statistics.input_bytes);
+
+    {
+        const file_container::archive archive{archive_path};
+        const auto file = archive.find("file").value();
+        EXPECT_EQ(file_container::archive_compression::zlib, file.compression);
+        EXPECT_EQ(file.offset, archive.find("same_file").value().offset);
+        EXPECT_EQ(file.offset, archive.find("same_data").value().offset);
+        EXPECT_EQ(data, archive.read(archive.find("same_data").value()));
+    }
+
+    std::filesystem::remove(input_path);
+    std::filesystem::remove(archive_path);
+}
+
+TEST(test_archive_builder, missing_file_fails_the_build)
+{
+    file_container::archive_builder builder{2};
+
+    for (std::size_t i = 0; i < 20; ++i)
+    {
+        if (i == 5)
+            builder.add("missing", common::uuid::generate(), common::generate_temporary_file_path());
+        else
+            builder.add(entry_name(i), common::uuid::generate(), make_data(1000, static_cast<std::uint32_t>(i)));
+    }
+
+    std::vector<std::uint8_t> buffer;
+    auto stream = streams::make_dynamic_stream(streams::memory_view_device{buffer});
+    EXPECT_ANY_THROW([[maybe_unused]] const auto statistics = builder.build(stream));
+}
@@ -0,0 +1,161 @@
+// Distributed under the BSD 2-Clause License - Copyright 2012-2023 Robin Degen
+
+#include <aeon/file_container/lazy_container.h>
+#include <aeon/file_container/container.h>
+#include <aeon/file_container/archive.h>
+#include <aeon/file_container/exception.h>
+#include <aeon/streams/stream_writer.h>
+#include <aeon/streams/dynamic_stream.h>
+#include <aeon/streams/devices/memory_view_device.h>
+#include <aeon/streams/devices/file_device.h>
+#include <aeon/common/tempfile.h>
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <vector>
+
+using namespace aeon;
+
+namespace
+{
+
+[[nodiscard]] auto make_container(const common::uuid &id, const ptree::serialization::abf_version version)
+    -> std::vector<std::uint8_t>
+{
+    file_container::container c{"lazy", id};
+    c.metadata()["width"] = 1920;
+    c.metadata()["format"] = "rgba";
+
+    auto stream = c.stream();
+    streams::stream_writer writer{stream};
+    writer << common::string{"This is test data."};
+
+    std::vector<std::uint8_t> data;
+    auto output_stream = streams::make_dynamic_stream(streams::memory_view_device{data});
+    c.write(output_stream, version);
+    return data;
+}
+
+[[nodiscard]] auto expected_data() -> std::vector<std::byte>
+{
+    std::vector<std::uint8_t> data;
+    auto stream = streams::make_dynamic_stream(streams::memory_view_device{data});
+    streams::stream_writer writer{stream};
+    writer << common::string{"This is test data."};
+
+    const auto bytes = std::as_bytes(std::span{data});
+    return {std::begin(bytes), std::end(bytes)};
+}
+
+[[nodiscard]] auto as_vector(const std::span<const std::byte> data) -> std::vector<std::byte>
+{
+    return {std::begin(data), std::end(data)};
+}
+
+} // namespace
+
+TEST(test_lazy_container, read_from_memory_without_copy)
+{
+    const auto id = common::uuid::generate();
+    const auto data = make_container(id, ptree::serialization::abf_version::v2);
+    const auto bytes = std::as_bytes(std::span{data});
+
+    file_container::lazy_container c{bytes};
+    EXPECT_EQ("lazy", c.name());
+    EXPECT_EQ(id, c.id());
+    EXPECT_EQ(std::size(expected_data()), c.data_size());
+    EXPECT_TRUE(c.is_zero_copy());
+
+    const auto view = c.data();
+    EXPECT_GE(std::data(view), std::data(bytes));
+    EXPECT_LE(std::data(view) + std::size(view), std::data(bytes) + std::size(bytes));
+    EXPECT_EQ(expected_data(), as_vector(view));
+}
+
+TEST(test_lazy_container, metadata_value_from_abf2_without_parsing)
+{
+    const auto data = make_container(common::uuid::generate(), ptree::serialization::abf_version::v2);
+    file_container::lazy_container c{std::as_bytes(std::span{data})};
+
+    EXPECT_EQ(1920, c.metadata_value("width").value());
+    EXPECT_EQ("rgba", c.metadata_value("format").value());
+    EXPECT_FALSE(c.metadata_value("height").has_value());
+    EXPECT_FALSE(c.is_metadata_parsed());
+
+    EXPECT_EQ(1920, c.metadata().at("width"));
+    EXPECT_TRUE(c.is_metadata_parsed());
+}
+
+TEST(test_lazy_container, read_from_stream)
+{
+    const auto id = common::uuid::generate();
+    auto data = make_container(id, ptree::serialization::abf_version::v1);
+
+    auto stream = streams::make_dynamic_stream(streams::memory_view_device{data});
+    file_container::lazy_container c{stream};
+    EXPECT_EQ("lazy", c.name());
+    EXPECT_EQ(id, c.id());
+    EXPECT_FALSE(c.is_zero_copy());
+
+    // ABF1 metadata can only be parsed completely.
+    EXPECT_EQ("rgba", c.metadata_value("format").value());
+    EXPECT_TRUE(c.is_metadata_parsed());
+    EXPECT_EQ(expected_data(), as_vector(c.data()));
+}
+
+TEST(test_lazy_container, read_from_file)
+{
+    const auto path = common::generate_temporary_file_path();
+    const auto id = common::uuid::generate();
+    const auto data = make_container(id, ptree::serialization::abf_version::v2);
+
+    {
+        streams::file_sink_device file{path};
+        file.write(std::as_bytes(std::span{data}).data(), std::ssize(data));
+    }
+
+    {
+        file_container::lazy_container c{path};
+        EXPECT_EQ(id, c.id());
+        EXPECT_EQ(1920, c.metadata_value("width").value());
+        EXPECT_EQ(expected_data(), as_vector(c.data()));
+    }
+
+    std::filesystem::remove(path);
+}
+
+TEST(test_lazy_container, read_from_archive)
+{
+    const auto id = common::uuid::generate();
+    const auto data = make_container(id, ptree::serialization::abf_version::v2);
+
+    std::vector<std::uint8_t> buffer;
+
+    {
+        auto stream = streams::make_dynamic_stream(streams::memory_view_device{buffer});
+        file_container::archive_writer writer{stream};
+        writer.add("plain", id, std::as_bytes(std::span{data}));
+        writer.add("compressed", common::uuid::generate(), std::as_bytes(std::span{data}),
+                   file_container::archive_compression::zlib);
+        writer.finish();
+    }
+
+    const file_container::archive archive{std::as_bytes(std::span{buffer})};
+
+    file_container::lazy_container plain{archive, archive.find("plain").value()};
+    EXPECT_TRUE(plain.is_zero_copy());
+    EXPECT_EQ(id, plain.id());
+    EXPECT_EQ(expected_data(), as_vector(plain.data()));
+
+    // Small entries are stored uncompressed when compression does not make them smaller.
+    const auto entry = archive.find("compressed").value();
+    file_container::lazy_container compressed{archive, entry};
+    EXPECT_EQ(entry.compression == file_container::archive_compression::none, compressed.is_zero_copy());
+    EXPECT_EQ("rgba", compressed.metadata_value("format").value());
+    EXPECT_EQ(expected_data(), as_vector(compressed.data()));
+}
+
+TEST(test_lazy_container, invalid_header)
+{
+    const std::vector<std::byte> data(64, std::byte{0x42});
+    EXPECT_THROW(file_container::lazy_container{std::span{data}}, file_container::resource_file_exception);
+}
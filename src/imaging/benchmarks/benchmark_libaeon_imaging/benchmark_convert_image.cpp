@@ -0,0 +1,145 @@
+// Distributed under the BSD 2-Clause License - Copyright 2012-2023 Robin Degen
+
+#include <benchmark/benchmark.h>
+
+#include <aeon/imaging/converters/convert_image.h>
+#include <aeon/imaging/converters/convert_pixel.h>
+#include <cstdint>
+
+using namespace aeon;
+
+namespace
+{
+
+[[nodiscard]] auto make_image(const imaging::format format, const int width, const int height) -> imaging::image
+{
+    imaging::image image{format, width, height};
+
+    auto *const data = std::data(image);
+    const auto size = math::stride(image) * static_cast<std::size_t>(height);
+
+    std::uint32_t state = 1;
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        state = state * 1664525u + 1013904223u;
+        data[i] = static_cast<std::byte>(state >> 24);
+    }
+
+    // Floats are kept within 0 to 1.
+    if (math::element_type(image).name == common::element_type_name::f32)
+    {
+        auto *const values = reinterpret_cast<float *>(data);
+        for (std::size_t i = 0; i < size / sizeof(float); ++i)
+            values[i] = static_cast<float>(i % 256) / 255.0f;
+    }
+
+    return image;
+}
+
+/*!
+ * Arguments: width, height, threads
+ */
+void convert_arguments(benchmark::internal::Benchmark *benchmark)
+{
+    constexpr int sizes[][2] = {{640, 480}, {1920, 1080}, {3840, 2160}};
+
+    for (const auto &size : sizes)
+    {
+        benchmark->Args({size[0], size[1], 1});
+        benchmark->Args({size[0], size[1], 0});
+    }
+}
+
+void convert(benchmark::State &state, const imaging::format source, const imaging::format destination)
+{
+    const auto width = static_cast<int>(state.range(0));
+    const auto height = static_cast<int>(state.range(1));
+    const auto concurrency = static_cast<unsigned int>(state.range(2));
+
+    const auto image = make_image(source, width, height);
+    imaging::image result{destination, width, height};
+
+    for ([[maybe_unused]] auto _ : state)
+    {
+        imaging::convert::to_format(image, result, concurrency);
+        benchmark::DoNotOptimize(std::data(result));
+    }
+
+    state.SetItemsProcessed(state.iterations() * width * height);
+}
+
+} // namespace
+
+static void benchmark_convert_rgb24_to_bgra32(benchmark::State &state)
+{
+    convert(state, imaging::format::r8g8b8_uint, imaging::format::b8g8r8a8_uint);
+}
+
+BENCHMARK(benchmark_convert_rgb24_to_bgra32)->Apply(convert_arguments)->UseRealTime();
+
+static void benchmark_convert_rgba32_to_bgra32(benchmark::State &state)
+{
+    convert(state, imaging::format::r8g8b8a8_uint, imaging::format::b8g8r8a8_uint);
+}
+
+BENCHMARK(benchmark_convert_rgba32_to_bgra32)->Apply(convert_arguments)->UseRealTime();
+
+static void benchmark_convert_rgba32_to_rgb24(benchmark::State &state)
+{
+    convert(state, imaging::format::r8g8b8a8_uint, imaging::format::r8g8b8_uint);
+}
+
+BENCHMARK(benchmark_convert_rgba32_to_rgb24)->Apply(convert_arguments)->UseRealTime();
+
+static void benchmark_convert_gray_to_rgba32(benchmark::State &state)
+{
+    convert(state, imaging::format::r8_uint, imaging::format::r8g8b8a8_uint);
+}
+
+BENCHMARK(benchmark_convert_gray_to_rgba32)->Apply(convert_arguments)->UseRealTime();
+
+static void benchmark_convert_rgba32_to_rgba_float(benchmark::State &state)
+{
+    convert(state, imaging::format::r8g8b8a8_uint, imaging::format::r32g32b32a32_float);
+}
+
+BENCHMARK(benchmark_convert_rgba32_to_rgba_float)->Apply(convert_arguments)->UseRealTime();
+
+static void benchmark_convert_rgba_float_to_rgba32(benchmark::State &state)
+{
+    convert(state, imaging::format::r32g32b32a32_float, imaging::format::r8g8b8a8_uint);
+}
+
+BENCHMARK(benchmark_convert_rgba_float_to_rgba32)->Apply(convert_arguments)->UseRealTime();
+
+/*!
+ * Converting one pixel at a time with convert::pixel, for comparison.
+ */
+static void benchmark_convert_rgb24_to_bgra32_per_pixel(benchmark::State &state)
+{
+    const auto width = static_cast<int>(state.range(0));
+    const auto height = static_cast<int>(state.range(1));
+
+    const auto image = make_image(imaging::format::r8g8b8_uint, width, height);
+    imaging::image result{imaging::format::b8g8r8a8_uint, width, height};
+
+    for ([[maybe_unused]] auto _ : state)
+    {
+        for (auto y = 0; y < height; ++y)
+        {
+            for (auto x = 0; x < width; ++x)
+                *math::at<imaging::bgra32>(result, x, y) =
+                    imaging::convert::pixel<imaging::rgb24>::to_bgra32(*math::at<imaging::rgb24>(image, x, y));
+        }
+
+        benchmark::DoNotOptimize(std::data(result));
+    }
+
+    state.SetItemsProcessed(state.iterations() * width * height);
+}
+
+BENCHMARK(benchmark_convert_rgb24_to_bgra32_per_pixel)
+    ->Args({640, 480})
+    ->Args({1920, 1080})
+    ->Args({3840, 2160})
+    ->UseRealTime();
@@ -0,0 +1,126 @@
+// Distributed under the BSD 2-Clause License - Copyright 2012-2023 Robin Degen
+
+#include <benchmark/benchmark.h>
+
+#include <aeon/imaging/filters/resample.h>
+#include <aeon/imaging/filters/resize.h>
+#include <cstdint>
+
+using namespace aeon;
+
+namespace
+{
+
+[[nodiscard]] auto make_image(const imaging::format format, const int width, const int height) -> imaging::image
+{
+    imaging::image image{format, width, height};
+
+    auto *const data = std::data(image);
+    const auto size = math::stride(image) * static_cast<std::size_t>(height);
+
+    std::uint32_t state = 1;
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        state = state * 1664525u + 1013904223u;
+        data[i] = static_cast<std::byte>(state >> 24);
+    }
+
+    return image;
+}
+
+/*!
+ * Arguments: source width, source height, destination width, destination height, filter, threads
+ */
+void resample_arguments(benchmark::internal::Benchmark *benchmark)
+{
+    constexpr int sizes[][4] = {
+        {640, 480, 320, 240},     // VGA to QVGA
+        {1920, 1080, 1280, 720},  // 1080p to 720p
+        {3840, 2160, 1920, 1080}, // 4K to 1080p
+        {512, 512, 2048, 2048},   // 4x upscale
+    };
+
+    for (const auto &size : sizes)
+    {
+        for (auto filter = 0; filter <= static_cast<int>(imaging::filters::resample_filter::lanczos3); ++filter)
+        {
+            benchmark->Args({size[0], size[1], size[2], size[3], filter, 1});
+            benchmark->Args({size[0], size[1], size[2], size[3], filter, 0});
+        }
+    }
+}
+
+void resample(benchmark::State &state, const imaging::format format)
+{
+    const auto image = make_image(format, static_cast<int>(state.range(0)), static_cast<int>(state.range(1)));
+    const math::size2d<imaging::image::dimensions_type> size{static_cast<int>(state.range(2)),
+                                                             static_cast<int>(state.range(3))};
+    const auto filter = static_cast<imaging::filters::resample_filter>(state.range(4));
+    const auto concurrency = static_cast<unsigned int>(state.range(5));
+
+    imaging::image result{math::element_type(image), format, size};
+
+    for ([[maybe_unused]] auto _ : state)
+    {
+        imaging::filters::resample(image, result, filter, concurrency);
+        benchmark::DoNotOptimize(std::data(result));
+    }
+
+    state.SetItemsProcessed(state.iterations() * math::width(size) * math::height(size));
+}
+
+} // namespace
+
+static void benchmark_resample_rgba32(benchmark::State &state)
+{
+    resample(state, imaging::format::r8g8b8a8_uint);
+}
+
+BENCHMARK(benchmark_resample_rgba32)->Apply(resample_arguments)->UseRealTime();
+
+static void benchmark_resample_rgb24(benchmark::State &state)
+{
+    resample(state, imaging::format::r8g8b8_uint);
+}
+
+BENCHMARK(benchmark_resample_rgb24)->Apply(resample_arguments)->UseRealTime();
+
+static void benchmark_resample_r32_float(benchmark::State &state)
+{
+    resample(state, imaging::format::r32_float);
+}
+
+BENCHMARK(benchmark_resample_r32_float)->Apply(resample_arguments)->UseRealTime();
+
+static void benchmark_resample_rgba32_float(benchmark::State &state)
+{
+    resample(state, imaging::format::r32g32b32a32_float);
+}
+
+BENCHMARK(benchmark_resample_rgba32_float)->Apply(resample_arguments)->UseRealTime();
+
+/*!
+ * The per pixel bilinear implementation, which is still used for f64 images, for comparison.
+ */
+static void benchmark_resize_bilinear_per_pixel(benchmark::State &state)
+{
+    const auto image = make_image(imaging::format::r8g8b8a8_uint, static_cast<int>(state.range(0)),
+                                  static_cast<int>(state.range(1)));
+    const math::size2d<imaging::image::dimensions_type> size{static_cast<int>(state.range(2)),
+                                                             static_cast<int>(state.range(3))};
+
+    for ([[maybe_unused]] auto _ : state)
+    {
+        benchmark::DoNotOptimize(imaging::filters::detail::resize_bilinear_impl<imaging::rgba32>::process(
+            image, common::element_type::u8_4, size));
+    }
+
+    state.SetItemsProcessed(state.iterations() * math::width(size) * math::height(size));
+}
+
+BENCHMARK(benchmark_resize_bilinear_per_pixel)
+    ->Args({640, 480, 320, 240})
+    ->Args({1920, 1080, 1280, 720})
+    ->Args({3840, 2160, 1920, 1080})
+    ->Args({512, 512, 2048, 2048})
+    ->UseRealTime();
@@ -0,0 +1,303 @@
+// Distributed under the BSD 2-Clause License - Copyright 2012-2023 Robin Degen
+
+#include <aeon/imaging/converters/convert_image.h>
+#include "convert_kernels.h"
+#include "../parallel_rows.h"
+#include <algorithm>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+#include <bit>
+#include <cstring>
+
+namespace aeon::imaging::convert
+{
+
+namespace detail
+{
+
+using imaging::detail::parallel_rows;
+
+// Logical channels of a pixel format, in the order of its components
+static constexpr int channel_r = 0;
+static constexpr int channel_g = 1;
+static constexpr int channel_b = 2;
+static constexpr int channel_a = 3;
+
+struct format_description
+{
+    common::element_type_name type = common::element_type_name::undefined;
+    int channels = 0;
+    std::array<int, 4> channel{};
+};
+
+[[nodiscard]] static auto describe(const format format) -> format_description
+{
+    using common::element_type_name;
+
+    switch (format)
+    {
+        case format::b8g8r8_uint:
+            return {element_type_name::u8, 3, {channel_b, channel_g, channel_r}};
+        case format::b8g8r8a8_uint:
+            return {element_type_name::u8, 4, {channel_b, channel_g, channel_r, channel_a}};
+        case format::r32_float:
+            return {element_type_name::f32, 1, {channel_r}};
+        case format::r32_uint:
+            return {element_type_name::u32, 1, {channel_r}};
+        case format::r32g32_float:
+            return {element_type_name::f32, 2, {channel_r, channel_g}};
+        case format::r32g32_uint:
+            return {element_type_name::u32, 2, {channel_r, channel_g}};
+        case format::r32g32b32_float:
+            return {element_type_name::f32, 3, {channel_r, channel_g, channel_b}};
+        case format::r32g32b32_uint:
+            return {element_type_name::u32, 3, {channel_r, channel_g, channel_b}};
+        case format::r32g32b32a32_float:
+            return {element_type_name::f32, 4, {channel_r, channel_g, channel_b, channel_a}};
+        case format::r32g32b32a32_uint:
+            return {element_type_name::u32, 4, {channel_r, channel_g, channel_b, channel_a}};
+        case format::r8_uint:
+            return {element_type_name::u8, 1, {channel_r}};
+        case format::r8g8_uint:
+            return {element_type_name::u8, 2, {channel_r, channel_g}};
+        case format::r8g8b8_uint:
+            return {element_type_name::u8, 3, {channel_r, channel_g, channel_b}};
+        case format::r8g8b8a8_uint:
+            return {element_type_name::u8, 4, {channel_r, channel_g, channel_b, channel_a}};
+        case format::undefined:
+        case format::bc1_rgb_srgb_block:
+        case format::bc1_rgba_srgb_block:
+        case format::bc2_srgb_block:
+        case format::bc3_srgb_block:
+        default:
+            throw std::runtime_error{"Unsupported format."};
+    }
+}
+
+/*!
+ * The amount of components between 2 pixels, including padding (like u8_3_stride_4).
+ */
+[[nodiscard]] static auto component_step(const image_view &view, const format_description &description) -> int
+{
+    const auto element_type = math::element_type(view);
+
+    if (element_type.name != description.type || element_type.count != static_cast<std::size_t>(description.channels))
+        throw std::runtime_error{"Unsupported format."};
+
+    if (element_type.stride % element_type.component_size != 0)
+        throw std::runtime_error{"Unsupported format."};
+
+    const auto step = static_cast<int>(element_type.stride / element_type.component_size);
+
+    if (step > 4)
+        throw std::runtime_error{"Unsupported format."};
+
+    return step;
+}
+
+[[nodiscard]] static auto make_component_map(const format_description &source, const int source_step,
+                                             const format_description &destination, const int destination_step)
+    -> component_map
+{
+    component_map map;
+    map.source_components = source_step;
+    map.destination_components = destination_step;
+    map.components.fill(component_zero);
+
+    for (auto c = 0; c < destination.channels; ++c)
+    {
+        const auto channel = destination.channel[c];
+        const auto *const begin = std::begin(source.channel);
+        const auto *const end = begin + source.channels;
+
+        if (const auto *const result = std::find(begin, end, channel); result != end)
+            map.components[c] = static_cast<int>(result - begin);
+        else if (source.channels == 1 && channel != channel_a)
+            map.components[c] = 0;
+        else if (channel == channel_a)
+            map.components[c] = component_one;
+    }
+
+    return map;
+}
+
+template <typename T>
+[[nodiscard]] static auto row_ptr(const image_view &view, const int y) noexcept -> const T *
+{
+    return reinterpret_cast<const T *>(std::data(view) + static_cast<std::size_t>(y) * math::stride(view));
+}
+
+template <typename T>
+[[nodiscard]] static auto row_ptr(image_view &view, const int y) noexcept -> T *
+{
+    return reinterpret_cast<T *>(std::data(view) + static_cast<std::size_t>(y) * math::stride(view));
+}
+
+template <typename T>
+static void shuffle(const T *src, T *dst, const std::size_t pixels, const component_map &map) noexcept
+{
+    if constexpr (std::is_same_v<T, std::uint8_t>)
+    {
+        shuffle_row(src, dst, pixels, map);
+    }
+    else
+    {
+        // 32-bit components are shuffled as raw bits, so only the value of an opaque alpha depends on the type.
+        constexpr auto one = std::is_same_v<T, float> ? std::bit_cast<std::uint32_t>(1.0f) : 0xffffffffu;
+        shuffle_row(reinterpret_cast<const std::uint32_t *>(src), reinterpret_cast<std::uint32_t *>(dst), pixels, map,
+                    one);
+    }
+}
+
+/*!
+ * Convert a row of pixels. When the component type changes, the shuffle is done on the side with the fewest
+ * components, so that the least amount of values is converted.
+ */
+template <typename source_t, typename destination_t>
+static void convert_pixels(const source_t *src, destination_t *dst, const std::size_t pixels,
+                           const component_map &map, const bool identity, std::byte *scratch) noexcept
+{
+    const auto source_size = pixels * static_cast<std::size_t>(map.source_components);
+    const auto destination_size = pixels * static_cast<std::size_t>(map.destination_components);
+
+    if constexpr (std::is_same_v<source_t, destination_t>)
+    {
+        if (identity)
+            std::memcpy(dst, src, destination_size * sizeof(destination_t));
+        else
+            shuffle(src, dst, pixels, map);
+    }
+    else
+    {
+        if (identity)
+        {
+            convert_row(src, dst, source_size);
+        }
+        else if (map.destination_components < map.source_components)
+        {
+            auto *const temp = reinterpret_cast<source_t *>(scratch);
+            shuffle(src, temp, pixels, map);
+            convert_row(temp, dst, destination_size);
+        }
+        else
+        {
+            auto *const temp = reinterpret_cast<destination_t *>(scratch);
+            convert_row(src, temp, source_size);
+            shuffle(temp, dst, pixels, map);
+        }
+    }
+}
+
+template <typename source_t, typename destination_t>
+static void convert_image(const image_view &src, image_view &dst, const component_map &map, const bool in_place,
+                          const unsigned int concurrency)
+{
+    const auto width = static_cast<std::size_t>(math::width(dst));
+    const auto identity = map.is_identity();
+    const auto largest_components = std::max(map.source_components, map.destination_components);
+    const auto largest_row =
+        width * static_cast<std::size_t>(largest_components) * std::max(sizeof(source_t), sizeof(destination_t));
+    const auto row_size = width * static_cast<std::size_t>(map.destination_components) * sizeof(destination_t);
+
+    parallel_rows(math::height(dst), row_size, concurrency,
+                  [&](const int begin, const int end)
+                  {
+                      // In place, rows are converted into a buffer first, since a row may grow or be shuffled.
+                      std::vector<std::byte> scratch(largest_row);
+                      std::vector<std::byte> row(in_place ? row_size : 0);
+
+                      for (auto y = begin; y < end; ++y)
+                      {
+                          if (in_place)
+                          {
+                              convert_pixels(row_ptr<source_t>(src, y),
+                                             reinterpret_cast<destination_t *>(std::data(row)), width, map, identity,
+                                             std::data(scratch));
+                              std::memcpy(row_ptr<destination_t>(dst, y), std::data(row), row_size);
+                          }
+                          else
+                          {
+                              convert_pixels(row_ptr<source_t>(src, y), row_ptr<destination_t>(dst, y), width,
+                                             map, identity, std::data(scratch));
+                          }
+                      }
+                  });
+}
+
+template <typename source_t>
+static void convert_image(const image_view &src, image_view &dst, const common::element_type_name destination_type,
+                          const component_map &map, const bool in_place, const unsigned int concurrency)
+{
+    switch (destination_type)
+    {
+        case common::element_type_name::u8:
+            convert_image<source_t, std::uint8_t>(src, dst, map, in_place, concurrency);
+            break;
+        case common::element_type_name::u32:
+            convert_image<source_t, std::uint32_t>(src, dst, map, in_place, concurrency);
+            break;
+        case common::element_type_name::f32:
+            convert_image<source_t, float>(src, dst, map, in_place, concurrency);
+            break;
+        default:
+            throw std::runtime_error{"Unsupported format."};
+    }
+}
+
+static void convert_image(const image_view &src, image_view &dst, const bool in_place, const unsigned int concurrency)
+{
+    const auto source = describe(pixel_format(src));
+    const auto destination = describe(pixel_format(dst));
+    const auto map = make_component_map(source, component_step(src, source), destination,
+                                        component_step(dst, destination));
+
+    if (in_place && static_cast<std::size_t>(math::width(dst)) * math::element_type(dst).stride > math::stride(dst))
+        throw std::invalid_argument{"Converted rows do not fit within the stride of the image."};
+
+    if (math::width(src) <= 0 || math::height(src) <= 0)
+        return;
+
+    const auto threads = imaging::detail::parallel_rows_concurrency(concurrency);
+
+    switch (source.type)
+    {
+        case common::element_type_name::u8:
+            convert_image<std::uint8_t>(src, dst, destination.type, map, in_place, threads);
+            break;
+        case common::element_type_name::u32:
+            convert_image<std::uint32_t>(src, dst, destination.type, map, in_place, threads);
+            break;
+        case common::element_type_name::f32:
+            convert_image<float>(src, dst, destination.type, map, in_place, threads);
+            break;
+        default:
+            throw std::runtime_error{"Unsupported format."};
+    }
+}
+
+} // namespace detail
+
+auto to_format(const image_view &img, const format format, const unsigned int concurrency) -> image
+{
+    image new_image{format, math::dimensions(img)};
+    to_format(img, new_image, concurrency);
+    return new_image;
+}
+
+void to_format(const image_view &src, image_view &dst, const unsigned int concurrency)
+{
+    if (math::dimensions(src) != math::dimensions(dst))
+        throw std::invalid_argument{"Source and destination must have the same dimensions."};
+
+    detail::convert_image(src, dst, false, concurrency);
+}
+
+auto to_format_in_place(image_view &img, const format format, const unsigned int concurrency) -> image_view
+{
+    image_view view{to_element_type(format), format, math::dimensions(img), math::stride(img), std::data(img)};
+    detail::convert_image(img, view, true, concurrency);
+    return view;
+}
+
+} // namespace aeon::imaging::convert
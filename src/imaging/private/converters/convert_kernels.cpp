@@ -0,0 +1,541 @@
+// Distributed under the BSD 2-Clause License - Copyright 2012-2023 Robin Degen
+
+#include "convert_kernels.h"
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <cmath>
+
+#if (!defined(AEON_DISABLE_SSE) && (defined(__SSE2__) || defined(_M_X64)))
+#define AEON_IMAGING_CONVERT_SSE2 1
+#include <immintrin.h>
+
+#if (defined(__SSSE3__))
+#define AEON_IMAGING_CONVERT_SSSE3 1
+#endif
+
+#if (defined(__AVX2__))
+#define AEON_IMAGING_CONVERT_AVX2 1
+#endif
+#endif
+
+#if (defined(__ARM_NEON) && defined(__aarch64__))
+#define AEON_IMAGING_CONVERT_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace aeon::imaging::convert::detail
+{
+
+namespace internal
+{
+
+static constexpr auto u8_scale = 1.0f / 255.0f;
+static constexpr auto u32_max = 4294967295.0;
+
+template <typename T, int source_components, int destination_components>
+static void shuffle_scalar(const T *src, T *dst, const std::size_t begin, const std::size_t pixels,
+                           const component_map &map, const T one) noexcept
+{
+    // Every pixel is copied into a local array that is followed by 0 and the opaque value, so that every destination
+    // component is a lookup without branches. The indices are local so that the compiler knows they don't alias.
+    std::array<int, destination_components> indices{};
+    for (auto c = 0; c < destination_components; ++c)
+    {
+        const auto index = map.components[c];
+        indices[c] = (index >= 0) ? index : ((index == component_one) ? source_components + 1 : source_components);
+    }
+
+    for (auto x = begin; x < pixels; ++x)
+    {
+        std::array<T, source_components + 2> pixel;
+        std::copy_n(src + x * source_components, source_components, std::begin(pixel));
+        pixel[source_components] = T{};
+        pixel[source_components + 1] = one;
+
+        auto *const d = dst + x * destination_components;
+        for (auto c = 0; c < destination_components; ++c)
+            d[c] = pixel[indices[c]];
+    }
+}
+
+/*!
+ * A shuffle with a map that is known at compile time, for the most common conversions between 3 and 4 components
+ * (like rgb to bgra), which have no SIMD kernel without a byte shuffle instruction.
+ */
+template <typename T, int source_components, int... components>
+static void shuffle_scalar_fixed(const T *src, T *dst, const std::size_t begin, const std::size_t pixels,
+                                 const T one) noexcept
+{
+    constexpr auto destination_components = static_cast<int>(sizeof...(components));
+
+    for (auto x = begin; x < pixels; ++x)
+    {
+        const auto *const s = src + x * source_components;
+        auto *const d = dst + x * destination_components;
+
+        auto c = 0;
+        ((d[c++] = (components >= 0) ? s[std::max(components, 0)] : ((components == component_one) ? one : T{})), ...);
+    }
+}
+
+template <typename T>
+[[nodiscard]] static auto shuffle_scalar_fixed(const T *src, T *dst, const std::size_t begin, const std::size_t pixels,
+                                               const component_map &map, const T one) noexcept -> bool
+{
+    const auto matches = [&map](const int source_components, const std::array<int, 4> components)
+    { return map.source_components == source_components && map.components == components; };
+
+    if (map.destination_components == 4)
+    {
+        if (matches(3, {0, 1, 2, component_one}))
+            shuffle_scalar_fixed<T, 3, 0, 1, 2, component_one>(src, dst, begin, pixels, one);
+        else if (matches(3, {2, 1, 0, component_one}))
+            shuffle_scalar_fixed<T, 3, 2, 1, 0, component_one>(src, dst, begin, pixels, one);
+        else
+            return false;
+
+        return true;
+    }
+
+    if (map.destination_components == 3)
+    {
+        if (matches(4, {0, 1, 2, component_zero}))
+            shuffle_scalar_fixed<T, 4, 0, 1, 2>(src, dst, begin, pixels, one);
+        else if (matches(4, {2, 1, 0, component_zero}))
+            shuffle_scalar_fixed<T, 4, 2, 1, 0>(src, dst, begin, pixels, one);
+        else if (matches(3, {2, 1, 0, component_zero}))
+            shuffle_scalar_fixed<T, 3, 2, 1, 0>(src, dst, begin, pixels, one);
+        else
+            return false;
+
+        return true;
+    }
+
+    return false;
+}
+
+/*!
+ * The scalar shuffle is instantiated for every amount of components, so that the compiler can unroll it.
+ */
+template <typename T>
+static void shuffle_scalar(const T *src, T *dst, const std::size_t begin, const std::size_t pixels,
+                           const component_map &map, const T one) noexcept
+{
+    if (shuffle_scalar_fixed(src, dst, begin, pixels, map, one))
+        return;
+
+    const auto dispatch = [&]<int source_components>()
+    {
+        switch (map.destination_components)
+        {
+            case 1:
+                shuffle_scalar<T, source_components, 1>(src, dst, begin, pixels, map, one);
+                break;
+            case 2:
+                shuffle_scalar<T, source_components, 2>(src, dst, begin, pixels, map, one);
+                break;
+            case 3:
+                shuffle_scalar<T, source_components, 3>(src, dst, begin, pixels, map, one);
+                break;
+            case 4:
+            default:
+                shuffle_scalar<T, source_components, 4>(src, dst, begin, pixels, map, one);
+                break;
+        }
+    };
+
+    switch (map.source_components)
+    {
+        case 1:
+            dispatch.template operator()<1>();
+            break;
+        case 2:
+            dispatch.template operator()<2>();
+            break;
+        case 3:
+            dispatch.template operator()<3>();
+            break;
+        case 4:
+        default:
+            dispatch.template operator()<4>();
+            break;
+    }
+}
+
+#if (defined(AEON_IMAGING_CONVERT_SSSE3) || defined(AEON_IMAGING_CONVERT_NEON))
+/*!
+ * A component map expressed as a byte shuffle of a block of 16 bytes, which holds a whole amount of source and
+ * destination pixels. Destination bytes that are not taken from the source are 0 in the shuffle and then or-ed with
+ * the constants.
+ */
+struct byte_shuffle
+{
+    std::size_t pixels = 0;
+    std::size_t source_bytes = 0;
+    std::size_t destination_bytes = 0;
+
+    alignas(16) std::uint8_t indices[16]{};
+    alignas(16) std::uint8_t constants[16]{};
+};
+
+[[nodiscard]] static auto make_byte_shuffle(const component_map &map, const std::size_t component_size,
+                                            const std::uint32_t one) noexcept -> byte_shuffle
+{
+    const auto source_components = static_cast<std::size_t>(map.source_components);
+    const auto destination_components = static_cast<std::size_t>(map.destination_components);
+
+    byte_shuffle shuffle;
+    shuffle.pixels = 16 / (std::max(source_components, destination_components) * component_size);
+    shuffle.source_bytes = shuffle.pixels * source_components * component_size;
+    shuffle.destination_bytes = shuffle.pixels * destination_components * component_size;
+    std::fill_n(shuffle.indices, 16, std::uint8_t{0x80});
+
+    for (std::size_t p = 0; p < shuffle.pixels; ++p)
+    {
+        for (std::size_t c = 0; c < destination_components; ++c)
+        {
+            const auto index = map.components[c];
+
+            for (std::size_t b = 0; b < component_size; ++b)
+            {
+                const auto i = (p * destination_components + c) * component_size + b;
+
+                if (index >= 0)
+                    shuffle.indices[i] = static_cast<std::uint8_t>(
+                        (p * source_components + static_cast<std::size_t>(index)) * component_size + b);
+                else if (index == component_one)
+                    shuffle.constants[i] = static_cast<std::uint8_t>(one >> (b * 8));
+            }
+        }
+    }
+
+    return shuffle;
+}
+
+/*!
+ * Shuffle blocks of 16 bytes for as long as both rows have 16 bytes left. The part of every store beyond the
+ * destination pixels of the block is overwritten by the next block, or by the scalar remainder.
+ */
+[[nodiscard]] static auto shuffle_simd(const std::uint8_t *src, std::uint8_t *dst, const std::size_t source_size,
+                                       const std::size_t destination_size, const byte_shuffle &shuffle) noexcept
+    -> std::size_t
+{
+    std::size_t pixels = 0;
+    std::size_t source_offset = 0;
+    std::size_t destination_offset = 0;
+
+#if (defined(AEON_IMAGING_CONVERT_SSSE3))
+    const auto indices = _mm_load_si128(reinterpret_cast<const __m128i *>(shuffle.indices));
+    const auto constants = _mm_load_si128(reinterpret_cast<const __m128i *>(shuffle.constants));
+
+    while (source_offset + 16 <= source_size && destination_offset + 16 <= destination_size)
+    {
+        const auto block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + source_offset));
+        const auto result = _mm_or_si128(_mm_shuffle_epi8(block, indices), constants);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + destination_offset), result);
+
+        source_offset += shuffle.source_bytes;
+        destination_offset += shuffle.destination_bytes;
+        pixels += shuffle.pixels;
+    }
+#else
+    const auto indices = vld1q_u8(shuffle.indices);
+    const auto constants = vld1q_u8(shuffle.constants);
+
+    while (source_offset + 16 <= source_size && destination_offset + 16 <= destination_size)
+    {
+        const auto block = vld1q_u8(src + source_offset);
+        vst1q_u8(dst + destination_offset, vorrq_u8(vqtbl1q_u8(block, indices), constants));
+
+        source_offset += shuffle.source_bytes;
+        destination_offset += shuffle.destination_bytes;
+        pixels += shuffle.pixels;
+    }
+#endif
+
+    return pixels;
+}
+#elif (defined(AEON_IMAGING_CONVERT_SSE2))
+/*!
+ * Without SSSE3 there is no byte shuffle; only the most common 8-bit conversions have a kernel: swapping red and blue
+ * of 4 component pixels (for example rgba to bgra) and expanding gray to 4 components.
+ */
+[[nodiscard]] static auto shuffle_sse2(const std::uint8_t *src, std::uint8_t *dst, const std::size_t pixels,
+                                       const component_map &map) noexcept -> std::size_t
+{
+    std::size_t x = 0;
+
+    if (map.source_components == 4 && map.destination_components == 4 && map.components[0] == 2 &&
+        map.components[1] == 1 && map.components[2] == 0 && (map.components[3] == 3 || map.components[3] < 0))
+    {
+        const auto keep_mask = _mm_set1_epi32((map.components[3] == 3) ? 0xff00ff00 : 0x0000ff00);
+        const auto alpha = _mm_set1_epi32((map.components[3] == component_one) ? static_cast<int>(0xff000000) : 0);
+        const auto swap_mask = _mm_set1_epi32(0x00ff00ff);
+
+        for (; x + 4 <= pixels; x += 4)
+        {
+            const auto block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + x * 4));
+            const auto swap = _mm_and_si128(block, swap_mask);
+            const auto swapped = _mm_or_si128(_mm_slli_epi32(swap, 16), _mm_srli_epi32(swap, 16));
+            const auto result = _mm_or_si128(_mm_or_si128(_mm_and_si128(block, keep_mask), swapped), alpha);
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + x * 4), result);
+        }
+    }
+    else if (map.source_components == 1 && map.destination_components == 4 && map.components[0] == 0 &&
+             map.components[1] == 0 && map.components[2] == 0 && map.components[3] == component_one)
+    {
+        const auto one = _mm_set1_epi8(static_cast<char>(0xff));
+
+        for (; x + 16 <= pixels; x += 16)
+        {
+            const auto gray = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + x));
+            const auto gray_lo = _mm_unpacklo_epi8(gray, gray);
+            const auto gray_hi = _mm_unpackhi_epi8(gray, gray);
+            const auto alpha_lo = _mm_unpacklo_epi8(gray, one);
+            const auto alpha_hi = _mm_unpackhi_epi8(gray, one);
+
+            auto *const out = reinterpret_cast<__m128i *>(dst + x * 4);
+            _mm_storeu_si128(out, _mm_unpacklo_epi16(gray_lo, alpha_lo));
+            _mm_storeu_si128(out + 1, _mm_unpackhi_epi16(gray_lo, alpha_lo));
+            _mm_storeu_si128(out + 2, _mm_unpacklo_epi16(gray_hi, alpha_hi));
+            _mm_storeu_si128(out + 3, _mm_unpackhi_epi16(gray_hi, alpha_hi));
+        }
+    }
+
+    return x;
+}
+#endif
+
+[[nodiscard]] static auto to_u8(float value) noexcept -> std::uint8_t
+{
+    // The same clamping as _mm_max_ps and _mm_min_ps, so that NaN becomes 0.
+    value *= 255.0f;
+    value = (value > 0.0f) ? value : 0.0f;
+    value = (value < 255.0f) ? value : 255.0f;
+    return static_cast<std::uint8_t>(std::lrint(value));
+}
+
+} // namespace internal
+
+auto component_map::is_identity() const noexcept -> bool
+{
+    if (source_components != destination_components)
+        return false;
+
+    for (auto c = 0; c < destination_components; ++c)
+    {
+        if (components[c] != c)
+            return false;
+    }
+
+    return true;
+}
+
+void shuffle_row(const std::uint8_t *src, std::uint8_t *dst, const std::size_t pixels,
+                 const component_map &map) noexcept
+{
+    std::size_t x = 0;
+
+#if (defined(AEON_IMAGING_CONVERT_SSSE3) || defined(AEON_IMAGING_CONVERT_NEON))
+    x = internal::shuffle_simd(src, dst, pixels * map.source_components, pixels * map.destination_components,
+                               internal::make_byte_shuffle(map, 1, 0xff));
+#elif (defined(AEON_IMAGING_CONVERT_SSE2))
+    x = internal::shuffle_sse2(src, dst, pixels, map);
+#endif
+
+    internal::shuffle_scalar<std::uint8_t>(src, dst, x, pixels, map, 0xff);
+}
+
+void shuffle_row(const std::uint32_t *src, std::uint32_t *dst, const std::size_t pixels, const component_map &map,
+                 const std::uint32_t one) noexcept
+{
+    std::size_t x = 0;
+
+#if (defined(AEON_IMAGING_CONVERT_SSSE3) || defined(AEON_IMAGING_CONVERT_NEON))
+    x = internal::shuffle_simd(reinterpret_cast<const std::uint8_t *>(src), reinterpret_cast<std::uint8_t *>(dst),
+                               pixels * map.source_components * 4, pixels * map.destination_components * 4,
+                               internal::make_byte_shuffle(map, 4, one));
+#endif
+
+    internal::shuffle_scalar<std::uint32_t>(src, dst, x, pixels, map, one);
+}
+
+void convert_row(const std::uint8_t *src, float *dst, const std::size_t size) noexcept
+{
+    std::size_t i = 0;
+
+#if (defined(AEON_IMAGING_CONVERT_AVX2))
+    const auto scale = _mm256_set1_ps(internal::u8_scale);
+
+    for (; i + 8 <= size; i += 8)
+    {
+        const auto values = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(src + i)));
+        _mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_cvtepi32_ps(values), scale));
+    }
+#elif (defined(AEON_IMAGING_CONVERT_SSE2))
+    const auto scale = _mm_set1_ps(internal::u8_scale);
+    const auto zero = _mm_setzero_si128();
+
+    for (; i + 16 <= size; i += 16)
+    {
+        const auto values = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+        const auto lo = _mm_unpacklo_epi8(values, zero);
+        const auto hi = _mm_unpackhi_epi8(values, zero);
+
+        _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(lo, zero)), scale));
+        _mm_storeu_ps(dst + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(lo, zero)), scale));
+        _mm_storeu_ps(dst + i + 8, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(hi, zero)), scale));
+        _mm_storeu_ps(dst + i + 12, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(hi, zero)), scale));
+    }
+#elif (defined(AEON_IMAGING_CONVERT_NEON))
+    for (; i + 16 <= size; i += 16)
+    {
+        const auto values = vld1q_u8(src + i);
+        const auto lo = vmovl_u8(vget_low_u8(values));
+        const auto hi = vmovl_u8(vget_high_u8(values));
+
+        vst1q_f32(dst + i, vmulq_n_f32(vcvtq_f32_u32(vmovl_u16(vget_low_u16(lo))), internal::u8_scale));
+        vst1q_f32(dst + i + 4, vmulq_n_f32(vcvtq_f32_u32(vmovl_u16(vget_high_u16(lo))), internal::u8_scale));
+        vst1q_f32(dst + i + 8, vmulq_n_f32(vcvtq_f32_u32(vmovl_u16(vget_low_u16(hi))), internal::u8_scale));
+        vst1q_f32(dst + i + 12, vmulq_n_f32(vcvtq_f32_u32(vmovl_u16(vget_high_u16(hi))), internal::u8_scale));
+    }
+#endif
+
+    for (; i < size; ++i)
+        dst[i] = static_cast<float>(src[i]) * internal::u8_scale;
+}
+
+void convert_row(const float *src, std::uint8_t *dst, const std::size_t size) noexcept
+{
+    std::size_t i = 0;
+
+#if (defined(AEON_IMAGING_CONVERT_AVX2))
+    const auto scale = _mm256_set1_ps(255.0f);
+    const auto zero = _mm256_setzero_ps();
+    const auto max = _mm256_set1_ps(255.0f);
+    const auto order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+
+    const auto load = [&](const std::size_t offset)
+    {
+        const auto value = _mm256_mul_ps(_mm256_loadu_ps(src + offset), scale);
+        return _mm256_cvtps_epi32(_mm256_min_ps(_mm256_max_ps(value, zero), max));
+    };
+
+    for (; i + 32 <= size; i += 32)
+    {
+        // The packs work within 128-bit lanes, so the result is permuted back into order.
+        const auto ab = _mm256_packs_epi32(load(i), load(i + 8));
+        const auto cd = _mm256_packs_epi32(load(i + 16), load(i + 24));
+        const auto result = _mm256_permutevar8x32_epi32(_mm256_packus_epi16(ab, cd), order);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i), result);
+    }
+#elif (defined(AEON_IMAGING_CONVERT_SSE2))
+    const auto scale = _mm_set1_ps(255.0f);
+    const auto zero = _mm_setzero_ps();
+    const auto max = _mm_set1_ps(255.0f);
+
+    const auto load = [&](const std::size_t offset)
+    {
+        const auto value = _mm_mul_ps(_mm_loadu_ps(src + offset), scale);
+        return _mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(value, zero), max));
+    };
+
+    for (; i + 16 <= size; i += 16)
+    {
+        const auto lo = _mm_packs_epi32(load(i), load(i + 4));
+        const auto hi = _mm_packs_epi32(load(i + 8), load(i + 12));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), _mm_packus_epi16(lo, hi));
+    }
+#elif (defined(AEON_IMAGING_CONVERT_NEON))
+    const auto zero = vdupq_n_f32(0.0f);
+    const auto max = vdupq_n_f32(255.0f);
+
+    const auto load = [&](const std::size_t offset)
+    {
+        const auto value = vmulq_n_f32(vld1q_f32(src + offset), 255.0f);
+        return vmovn_u32(vcvtnq_u32_f32(vminq_f32(vmaxq_f32(value, zero), max)));
+    };
+
+    for (; i + 16 <= size; i += 16)
+    {
+        const auto lo = vmovn_u16(vcombine_u16(load(i), load(i + 4)));
+        const auto hi = vmovn_u16(vcombine_u16(load(i + 8), load(i + 12)));
+        vst1q_u8(dst + i, vcombine_u8(lo, hi));
+    }
+#endif
+
+    for (; i < size; ++i)
+        dst[i] = internal::to_u8(src[i]);
+}
+
+void convert_row(const std::uint8_t *src, std::uint32_t *dst, const std::size_t size) noexcept
+{
+    std::size_t i = 0;
+
+#if (defined(AEON_IMAGING_CONVERT_SSE2))
+    const auto zero = _mm_setzero_si128();
+
+    // Multiplying by 0x01010101 repeats the byte, so that 255 becomes the maximum 32-bit value.
+    const auto expand = [](const __m128i value)
+    {
+        const auto repeated = _mm_or_si128(value, _mm_slli_epi32(value, 8));
+        return _mm_or_si128(repeated, _mm_slli_epi32(repeated, 16));
+    };
+
+    for (; i + 16 <= size; i += 16)
+    {
+        const auto values = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+        const auto lo = _mm_unpacklo_epi8(values, zero);
+        const auto hi = _mm_unpackhi_epi8(values, zero);
+
+        auto *const out = reinterpret_cast<__m128i *>(dst + i);
+        _mm_storeu_si128(out, expand(_mm_unpacklo_epi16(lo, zero)));
+        _mm_storeu_si128(out + 1, expand(_mm_unpackhi_epi16(lo, zero)));
+        _mm_storeu_si128(out + 2, expand(_mm_unpacklo_epi16(hi, zero)));
+        _mm_storeu_si128(out + 3, expand(_mm_unpackhi_epi16(hi, zero)));
+    }
+#endif
+
+    for (; i < size; ++i)
+        dst[i] = src[i] * 0x01010101u;
+}
+
+void convert_row(const std::uint32_t *src, std::uint8_t *dst, const std::size_t size) noexcept
+{
+    std::size_t i = 0;
+
+#if (defined(AEON_IMAGING_CONVERT_SSE2))
+    const auto load = [&](const std::size_t offset)
+    { return _mm_srli_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(src + offset)), 24); };
+
+    for (; i + 16 <= size; i += 16)
+    {
+        const auto lo = _mm_packs_epi32(load(i), load(i + 4));
+        const auto hi = _mm_packs_epi32(load(i + 8), load(i + 12));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), _mm_packus_epi16(lo, hi));
+    }
+#endif
+
+    for (; i < size; ++i)
+        dst[i] = static_cast<std::uint8_t>(src[i] >> 24);
+}
+
+void convert_row(const std::uint32_t *src, float *dst, const std::size_t size) noexcept
+{
+    for (std::size_t i = 0; i < size; ++i)
+        dst[i] = static_cast<float>(static_cast<double>(src[i]) / internal::u32_max);
+}
+
+void convert_row(const float *src, std::uint32_t *dst, const std::size_t size) noexcept
+{
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        auto value = static_cast<double>(src[i]);
+        value = (value > 0.0) ? value : 0.0;
+        value = (value < 1.0) ? value : 1.0;
+        dst[i] = static_cast<std::uint32_t>(std::llrint(value * internal::u32_max));
+    }
+}
+
+} // namespace aeon::imaging::convert::detail
@@ -0,0 +1,51 @@
+// Distributed under the BSD 2-Clause License - Copyright 2012-2023 Robin Degen
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <cstddef>
+
+namespace aeon::imaging::convert::detail
+{
+
+// A destination component that is not taken from the source, but set to 0 or to the maximum (opaque) value.
+static constexpr int component_zero = -1;
+static constexpr int component_one = -2;
+
+/*!
+ * Describes how the components of every destination pixel are taken from a source pixel. Pixels may contain padding,
+ * so the amount of components is the element stride in components.
+ */
+struct component_map
+{
+    int source_components = 0;
+    int destination_components = 0;
+
+    // For every destination component the index of the source component, component_zero or component_one
+    std::array<int, 4> components{};
+
+    [[nodiscard]] auto is_identity() const noexcept -> bool;
+};
+
+/*!
+ * Shuffle the components of a row of pixels according to the given map. The value of component_one is given as raw
+ * bits for 32-bit components, since these may be integers or floats.
+ */
+void shuffle_row(const std::uint8_t *src, std::uint8_t *dst, const std::size_t pixels,
+                 const component_map &map) noexcept;
+void shuffle_row(const std::uint32_t *src, std::uint32_t *dst, const std::size_t pixels, const component_map &map,
+                 const std::uint32_t one) noexcept;
+
+/*!
+ * Convert the given amount of components to another type. 8-bit and 32-bit integers are normalized to the range
+ * 0 to 1 of floats; floats are clamped and rounded.
+ */
+void convert_row(const std::uint8_t *src, float *dst, const std::size_t size) noexcept;
+void convert_row(const float *src, std::uint8_t *dst, const std::size_t size) noexcept;
+void convert_row(const std::uint8_t *src, std::uint32_t *dst, const std::size_t size) noexcept;
+void convert_row(const std::uint32_t *src, std::uint8_t *dst, const std::size_t size) noexcept;
+void convert_row(const std::uint32_t *src, float *dst, const std::size_t size) noexcept;
+void convert_row(const float *src, std::uint32_t *dst, const std::size_t size) noexcept;
+
+} // namespace aeon::imaging::convert::detail
@@ -0,0 +1,149 @@
+// Distributed under the BSD 2-Clause License - Copyright 2012-2023 Robin Degen
+
+#pragma once
+
+#include <aeon/streams/idynamic_stream.h>
+#include <array>
+#include <csetjmp>
+#include <cstdio>
+#include <jpeglib.h>
+
+namespace aeon::imaging::file::jpg::detail
+{
+
+// The size of the blocks in which the compressed data is read from the stream
+static constexpr std::size_t jpeg_read_buffer_size = 16 * 1024;
+
+/*!
+ * A libjpeg decompressor that reads from a stream. Errors in libjpeg jump to jump_buffer(), so setjmp must be
+ * called on it before calling into libjpeg.
+ */
+class [[nodiscard]] jpeg_decompress_wrapper final
+{
+public:
+    explicit jpeg_decompress_wrapper(streams::idynamic_stream &stream);
+    ~jpeg_decompress_wrapper();
+
+    jpeg_decompress_wrapper(const jpeg_decompress_wrapper &) = delete;
+    auto operator=(const jpeg_decompress_wrapper &) -> jpeg_decompress_wrapper & = delete;
+
+    jpeg_decompress_wrapper(jpeg_decompress_wrapper &&) = delete;
+    auto operator=(jpeg_decompress_wrapper &&) -> jpeg_decompress_wrapper & = delete;
+
+    [[nodiscard]] auto info() noexcept -> jpeg_decompress_struct &;
+    [[nodiscard]] auto jump_buffer() noexcept -> std::jmp_buf &;
+
+private:
+    [[nodiscard]] static auto from_info(j_common_ptr info) noexcept -> jpeg_decompress_wrapper &;
+
+    [[noreturn]] static void error_exit(j_common_ptr info);
+    static void output_message(j_common_ptr info);
+
+    static void init_source(j_decompress_ptr info);
+    static auto fill_input_buffer(j_decompress_ptr info) -> boolean;
+    static void skip_input_data(j_decompress_ptr info, long size);
+    static void term_source(j_decompress_ptr info);
+
+    streams::idynamic_stream &stream_;
+    jpeg_decompress_struct info_;
+    jpeg_error_mgr error_;
+    jpeg_source_mgr source_;
+    std::jmp_buf jump_buffer_;
+    std::array<JOCTET, jpeg_read_buffer_size> buffer_;
+};
+
+inline jpeg_decompress_wrapper::jpeg_decompress_wrapper(streams::idynamic_stream &stream)
+    : stream_{stream}
+    , info_{}
+    , error_{}
+    , source_{}
+    , jump_buffer_{}
+    , buffer_{}
+{
+    info_.err = jpeg_std_error(&error_);
+    error_.error_exit = &jpeg_decompress_wrapper::error_exit;
+    error_.output_message = &jpeg_decompress_wrapper::output_message;
+
+    // The client data survives jpeg_create_decompress.
+    info_.client_data = this;
+    jpeg_create_decompress(&info_);
+
+    source_.init_source = &jpeg_decompress_wrapper::init_source;
+    source_.fill_input_buffer = &jpeg_decompress_wrapper::fill_input_buffer;
+    source_.skip_input_data = &jpeg_decompress_wrapper::skip_input_data;
+    source_.resync_to_restart = &jpeg_resync_to_restart;
+    source_.term_source = &jpeg_decompress_wrapper::term_source;
+    info_.src = &source_;
+}
+
+inline jpeg_decompress_wrapper::~jpeg_decompress_wrapper()
+{
+    jpeg_destroy_decompress(&info_);
+}
+
+[[nodiscard]] inline auto jpeg_decompress_wrapper::info() noexcept -> jpeg_decompress_struct &
+{
+    return info_;
+}
+
+[[nodiscard]] inline auto jpeg_decompress_wrapper::jump_buffer() noexcept -> std::jmp_buf &
+{
+    return jump_buffer_;
+}
+
+[[nodiscard]] inline auto jpeg_decompress_wrapper::from_info(j_common_ptr info) noexcept -> jpeg_decompress_wrapper &
+{
+    return *static_cast<jpeg_decompress_wrapper *>(info->client_data);
+}
+
+inline void jpeg_decompress_wrapper::error_exit(j_common_ptr info)
+{
+    std::longjmp(from_info(info).jump_buffer_, 1);
+}
+
+inline void jpeg_decompress_wrapper::output_message([[maybe_unused]] j_common_ptr info)
+{
+    // Warnings are not written to stderr.
+}
+
+inline void jpeg_decompress_wrapper::init_source([[maybe_unused]] j_decompress_ptr info)
+{
+}
+
+inline auto jpeg_decompress_wrapper::fill_input_buffer(j_decompress_ptr info) -> boolean
+{
+    auto &wrapper = from_info(reinterpret_cast<j_common_ptr>(info));
+    const auto size = wrapper.stream_.read(reinterpret_cast<std::byte *>(std::data(wrapper.buffer_)),
+                                           static_cast<std::streamsize>(std::size(wrapper.buffer_)));
+
+    // A truncated image is an error, just like in the other loaders.
+    if (size <= 0)
+        error_exit(reinterpret_cast<j_common_ptr>(info));
+
+    wrapper.source_.next_input_byte = std::data(wrapper.buffer_);
+    wrapper.source_.bytes_in_buffer = static_cast<std::size_t>(size);
+    return TRUE;
+}
+
+inline void jpeg_decompress_wrapper::skip_input_data(j_decompress_ptr info, long size)
+{
+    if (size <= 0)
+        return;
+
+    auto &source = *info->src;
+
+    while (static_cast<std::size_t>(size) > source.bytes_in_buffer)
+    {
+        size -= static_cast<long>(source.bytes_in_buffer);
+        fill_input_buffer(info);
+    }
+
+    source.next_input_byte += size;
+    source.bytes_in_buffer -= static_cast<std::size_t>(size);
+}
+
+inline void jpeg_decompress_wrapper::term_source([[maybe_unused]] j_decompress_ptr info)
+{
+}
+
+} // namespace aeon::imaging::file::jpg::detail
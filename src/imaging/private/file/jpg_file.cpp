@@ -1,13 +1,17 @@
 // Distributed under the BSD 2-Clause License - Copyright 2012-2023 Robin Degen
 
 #include <aeon/imaging/file/jpg_file.h>
+#include <aeon/imaging/converters/convert_image.h>
 #include <aeon/streams/devices/file_device.h>
 #include <aeon/streams/dynamic_stream.h>
-#include <aeon/streams/stream_reader.h>
 #include <aeon/streams/stream_writer.h>
 #include <aeon/common/assert.h>
+#include <aeon/common/compilers.h>
+#include "jpeg_decompress_wrapper.h"
 #include "tjhandle_wrapper.h"
 #include <turbojpeg.h>
+#include <optional>
+#include <stdexcept>
 
 namespace aeon::imaging::file::jpg
 {
@@ -36,35 +40,178 @@ namespace detail
     throw save_exception{};
 }
 
-} // namespace detail
+class jpg_decoder_state final
+{
+public:
+    explicit jpg_decoder_state(streams::idynamic_stream &stream)
+        : decompress{stream}
+        , decoded{false}
+    {
+    }
+
+    ~jpg_decoder_state() = default;
+
+    jpg_decoder_state(const jpg_decoder_state &) = delete;
+    auto operator=(const jpg_decoder_state &) -> jpg_decoder_state & = delete;
+
+    jpg_decoder_state(jpg_decoder_state &&) = delete;
+    auto operator=(jpg_decoder_state &&) -> jpg_decoder_state & = delete;
 
-[[nodiscard]] auto load(const std::filesystem::path &path) -> image
+    jpeg_decompress_wrapper decompress;
+    bool decoded;
+};
+
+/*!
+ * The libjpeg color space that decodes directly into the given format, if any.
+ */
+[[nodiscard]] static auto format_to_color_space(const format format) noexcept -> std::optional<J_COLOR_SPACE>
 {
-    auto stream = streams::make_dynamic_stream(streams::file_source_device{path});
-    return load(stream);
+    switch (format)
+    {
+        case format::r8_uint:
+            return JCS_GRAYSCALE;
+        case format::r8g8b8_uint:
+            return JCS_EXT_RGB;
+        case format::b8g8r8_uint:
+            return JCS_EXT_BGR;
+        case format::r8g8b8a8_uint:
+            return JCS_EXT_RGBA;
+        case format::b8g8r8a8_uint:
+            return JCS_EXT_BGRA;
+        default:
+            return std::nullopt;
+    }
 }
 
-[[nodiscard]] auto load(streams::idynamic_stream &stream) -> image
+/*!
+ * Decode all rows in the given color space into the pointers returned by row(y) and call row_done(y) for every row.
+ */
+template <typename row_function_t, typename row_done_function_t>
+static void read_rows(jpg_decoder_state &state, const J_COLOR_SPACE color_space, const row_function_t &row,
+                      const row_done_function_t &row_done)
 {
-    detail::tjhandle_decompress_wrapper wrapper;
+    if (state.decoded)
+        throw load_exception{};
 
-    streams::stream_reader reader{stream};
-    auto data = reader.read_to_vector<unsigned char>();
-    const auto data_size = static_cast<unsigned long>(std::size(data));
+    state.decoded = true;
 
-    int width = 0;
-    int height = 0;
+    auto &info = state.decompress.info();
 
-    if (tjDecompressHeader(wrapper.handle(), std::data(data), data_size, &width, &height) != 0)
+    // Bind errors from libjpeg
+    AEON_IGNORE_VS_WARNING_PUSH(4611)
+    if (setjmp(state.decompress.jump_buffer()))
         throw load_exception{};
+    AEON_IGNORE_VS_WARNING_POP()
 
-    image loaded_image{format::r8g8b8_uint, width, height};
+    info.out_color_space = color_space;
+    jpeg_start_decompress(&info);
 
-    if (tjDecompress2(wrapper.handle(), std::data(data), data_size,
-                      reinterpret_cast<unsigned char *>(std::data(loaded_image)), width, 0, height, TJPF_RGB,
-                      TJFLAG_FASTDCT) != 0)
+    while (info.output_scanline < info.output_height)
+    {
+        const auto y = static_cast<image::dimensions_type>(info.output_scanline);
+        auto *scanline = reinterpret_cast<JSAMPROW>(row(y));
+        jpeg_read_scanlines(&info, &scanline, 1);
+        row_done(y);
+    }
+
+    jpeg_finish_decompress(&info);
+}
+
+} // namespace detail
+
+decoder::decoder(streams::idynamic_stream &stream, const scale scale)
+    : state_{std::make_unique<detail::jpg_decoder_state>(stream)}
+{
+    auto &info = state_->decompress.info();
+
+    // Bind errors from libjpeg
+    AEON_IGNORE_VS_WARNING_PUSH(4611)
+    if (setjmp(state_->decompress.jump_buffer()))
         throw load_exception{};
+    AEON_IGNORE_VS_WARNING_POP()
+
+    jpeg_read_header(&info, TRUE);
+
+    // libjpeg can not convert cmyk to rgb.
+    if (info.jpeg_color_space == JCS_CMYK || info.jpeg_color_space == JCS_YCCK)
+        throw load_exception{};
+
+    info.scale_num = 1;
+    info.scale_denom = static_cast<unsigned int>(scale);
+    info.dct_method = JDCT_IFAST;
+    info.out_color_space = (info.jpeg_color_space == JCS_GRAYSCALE) ? JCS_GRAYSCALE : JCS_RGB;
+    jpeg_calc_output_dimensions(&info);
+}
+
+decoder::~decoder() = default;
 
+decoder::decoder(decoder &&) noexcept = default;
+
+auto decoder::operator=(decoder &&) noexcept -> decoder & = default;
+
+auto decoder::dimensions() const noexcept -> math::size2d<image::dimensions_type>
+{
+    const auto &info = state_->decompress.info();
+    return {static_cast<image::dimensions_type>(info.output_width),
+            static_cast<image::dimensions_type>(info.output_height)};
+}
+
+auto decoder::pixel_format() const noexcept -> format
+{
+    if (state_->decompress.info().jpeg_color_space == JCS_GRAYSCALE)
+        return format::r8_uint;
+
+    return format::r8g8b8_uint;
+}
+
+void decoder::decode(image_view &destination)
+{
+    if (math::dimensions(destination) != dimensions())
+        throw std::invalid_argument{"The destination must have the same dimensions as the image."};
+
+    const auto format = imaging::pixel_format(destination);
+    const auto color_space = detail::format_to_color_space(format);
+
+    if (color_space && math::element_type(destination) == to_element_type(format))
+    {
+        detail::read_rows(
+            *state_, *color_space,
+            [&destination](const image::dimensions_type y)
+            { return std::data(destination) + static_cast<std::size_t>(y) * math::stride(destination); },
+            [](const image::dimensions_type) {});
+
+        return;
+    }
+
+    decode(
+        [&destination](const image::dimensions_type y, const image_view &row)
+        {
+            auto destination_row = make_view(destination, {0, y, math::width(destination), y + 1});
+            convert::to_format(row, destination_row, 1);
+        });
+}
+
+void decoder::decode(const row_callback &callback)
+{
+    image row{pixel_format(), math::width(dimensions()), 1};
+
+    detail::read_rows(
+        *state_, *detail::format_to_color_space(pixel_format()),
+        [&row](const image::dimensions_type) { return std::data(row); },
+        [&row, &callback](const image::dimensions_type y) { callback(y, row); });
+}
+
+[[nodiscard]] auto load(const std::filesystem::path &path, const scale scale) -> image
+{
+    auto stream = streams::make_dynamic_stream(streams::file_source_device{path});
+    return load(stream, scale);
+}
+
+[[nodiscard]] auto load(streams::idynamic_stream &stream, const scale scale) -> image
+{
+    decoder jpg_decoder{stream, scale};
+    image loaded_image{format::r8g8b8_uint, jpg_decoder.dimensions()};
+    jpg_decoder.decode(loaded_image);
     return loaded_image;
 }
 
@@ -1,6 +1,7 @@
 // Distributed under the BSD 2-Clause License - Copyright 2012-2023 Robin Degen
 
 #include <aeon/imaging/file/png_file.h>
+#include <aeon/imaging/converters/convert_image.h>
 #include <aeon/streams/dynamic_stream.h>
 #include <aeon/streams/devices/file_device.h>
 #include <aeon/common/compilers.h>
@@ -9,6 +10,7 @@
 #include "png_structs.h"
 #include <png.h>
 #include <array>
+#include <stdexcept>
 
 #define PNG_HEADER_SIGNATURE_SIZE 8
 
@@ -22,14 +24,15 @@ void png_read_callback(png_structp png_ptr, png_bytep output_ptr, png_size_t out
 {
     auto *stream = static_cast<streams::idynamic_stream *>(png_get_io_ptr(png_ptr));
 
-    // Do we have a stream?
+    // Errors are reported through png_error, so that they unwind to the setjmp of the caller instead of throwing
+    // through libpng.
     if (!stream)
-        throw load_exception();
+        png_error(png_ptr, "No stream.");
 
     // Read the data
     if (stream->read(reinterpret_cast<std::byte *>(output_ptr), static_cast<size_t>(output_size)) !=
         static_cast<std::streamoff>(output_size))
-        throw load_exception();
+        png_error(png_ptr, "Unexpected end of stream.");
 }
 
 void png_write_callback(png_structp png_ptr, png_bytep data, png_size_t length)
@@ -70,23 +73,93 @@ void png_write_callback(png_structp png_ptr, png_bytep data, png_size_t length)
     }
 }
 
-} // namespace detail
+class png_decoder_state final
+{
+public:
+    explicit png_decoder_state(streams::idynamic_stream &stream)
+        : stream{stream}
+        , structs{}
+        , dimensions{}
+        , format{format::undefined}
+        , passes{1}
+        , decoded{false}
+    {
+    }
 
-[[nodiscard]] auto load(const std::filesystem::path &path) -> image
+    ~png_decoder_state() = default;
+
+    png_decoder_state(const png_decoder_state &) = delete;
+    auto operator=(const png_decoder_state &) -> png_decoder_state & = delete;
+
+    png_decoder_state(png_decoder_state &&) = delete;
+    auto operator=(png_decoder_state &&) -> png_decoder_state & = delete;
+
+    streams::idynamic_stream &stream;
+    png_read_structs structs;
+    math::size2d<image::dimensions_type> dimensions;
+    imaging::format format;
+    int passes;
+    bool decoded;
+};
+
+[[nodiscard]] static auto color_type_to_format(const int color_type) -> format
 {
-    auto stream = streams::make_dynamic_stream(streams::file_source_device{path});
-    return load(stream);
+    switch (color_type)
+    {
+        case PNG_COLOR_TYPE_RGB:
+            return format::r8g8b8_uint;
+        case PNG_COLOR_TYPE_RGB_ALPHA:
+            return format::r8g8b8a8_uint;
+        case PNG_COLOR_TYPE_GRAY:
+            return format::r8_uint;
+        case PNG_COLOR_TYPE_GRAY_ALPHA:
+            return format::r8g8_uint;
+        default:
+            throw load_exception{};
+    }
 }
 
-[[nodiscard]] auto load(streams::idynamic_stream &stream) -> image
+/*!
+ * Read all rows into the pointers returned by row(y). Interlaced images are read in multiple passes over the same
+ * rows; row_done(y) is called once a row is complete.
+ */
+template <typename row_function_t, typename row_done_function_t>
+static void read_rows(png_decoder_state &state, const row_function_t &row, const row_done_function_t &row_done)
 {
-    // Check our stream
-    if (!stream.good())
+    if (state.decoded)
         throw load_exception{};
 
-    const auto size = stream.size();
+    state.decoded = true;
 
-    if (size == 0)
+    // Bind errors from libpng
+    AEON_IGNORE_VS_WARNING_PUSH(4611)
+    if (setjmp(png_jmpbuf(state.structs.png_ptr())))
+        throw load_exception{};
+    AEON_IGNORE_VS_WARNING_POP()
+
+    const auto height = math::height(state.dimensions);
+
+    for (auto pass = 0; pass < state.passes; ++pass)
+    {
+        for (auto y = 0; y < height; ++y)
+        {
+            png_read_row(state.structs.png_ptr(), reinterpret_cast<png_bytep>(row(y)), nullptr);
+
+            if (pass == state.passes - 1)
+                row_done(y);
+        }
+    }
+
+    png_read_end(state.structs.png_ptr(), nullptr);
+}
+
+} // namespace detail
+
+decoder::decoder(streams::idynamic_stream &stream)
+    : state_{std::make_unique<detail::png_decoder_state>(stream)}
+{
+    // Check our stream
+    if (!stream.good())
         throw load_exception{};
 
     // Read the header
@@ -100,84 +173,120 @@ void png_write_callback(png_structp png_ptr, png_bytep data, png_size_t length)
     if (png_sig_cmp(png_header.data(), 0, PNG_HEADER_SIGNATURE_SIZE))
         throw load_exception{};
 
-    const auto png_structs = detail::png_read_structs{};
+    auto *const png_ptr = state_->structs.png_ptr();
+    auto *const info_ptr = state_->structs.info_ptr();
 
     // Bind errors from libpng
     AEON_IGNORE_VS_WARNING_PUSH(4611)
-    if (setjmp(png_jmpbuf(png_structs.png_ptr())))
+    if (setjmp(png_jmpbuf(png_ptr)))
         throw load_exception{};
     AEON_IGNORE_VS_WARNING_POP()
 
     // Init png reading. We will be using a read function, as we can't read
     // from a file.
-    png_set_read_fn(png_structs.png_ptr(), &stream, detail::png_read_callback);
+    png_set_read_fn(png_ptr, &stream, detail::png_read_callback);
 
     // Let libpng know we already read the signature
-    png_set_sig_bytes(png_structs.png_ptr(), PNG_HEADER_SIGNATURE_SIZE);
+    png_set_sig_bytes(png_ptr, PNG_HEADER_SIGNATURE_SIZE);
 
     // Read all the info up to the image data
-    png_read_info(png_structs.png_ptr(), png_structs.info_ptr());
+    png_read_info(png_ptr, info_ptr);
 
-    // Variables to pass to get info
-    auto bit_depth = 0;
-    auto color_type = 0;
-    auto temp_width = png_uint_32();
-    auto temp_height = png_uint_32();
+    // Palettes become rgb, transparency becomes an alpha channel and every component becomes 8 bits.
+    png_set_expand(png_ptr);
+    png_set_strip_16(png_ptr);
+    state_->passes = png_set_interlace_handling(png_ptr);
 
-    // Get info about png
-    png_get_IHDR(png_structs.png_ptr(), png_structs.info_ptr(), &temp_width, &temp_height, &bit_depth, &color_type,
-                 nullptr, nullptr, nullptr);
+    // Update the png info struct, so that it describes the rows after the transformations.
+    png_read_update_info(png_ptr, info_ptr);
 
-    // Update the png info struct.
-    png_read_update_info(png_structs.png_ptr(), png_structs.info_ptr());
+    state_->dimensions = {static_cast<image::dimensions_type>(png_get_image_width(png_ptr, info_ptr)),
+                          static_cast<image::dimensions_type>(png_get_image_height(png_ptr, info_ptr))};
+    state_->format = detail::color_type_to_format(png_get_color_type(png_ptr, info_ptr));
+}
 
-    const auto rowbytes = png_get_rowbytes(png_structs.png_ptr(), png_structs.info_ptr());
+decoder::~decoder() = default;
 
-    // Allocate the image_data as a big block
-    const auto bitmap_buff_size = rowbytes * temp_height * sizeof(png_byte);
+decoder::decoder(decoder &&) noexcept = default;
 
-    auto bitmap_buffer = std::vector<std::byte>(bitmap_buff_size);
+auto decoder::operator=(decoder &&) noexcept -> decoder & = default;
 
-    // Cast to png_byte since this is what libpng likes as buffer.
-    // Just passing the pointer should be fine. But this ensures 100%
-    // compatibility.
-    auto *const image_data = reinterpret_cast<png_byte *>(&(bitmap_buffer)[0]);
+auto decoder::dimensions() const noexcept -> math::size2d<image::dimensions_type>
+{
+    return state_->dimensions;
+}
 
-    // Row_pointers is for pointing to image_data for reading the
-    // png with libpng
-    // TODO: shouldn't this just be height? not times sizeof? Remaining of old code?
-    const auto rowpointer_buff_size = temp_height * sizeof(png_bytep);
-    auto rowpointer_buffer = std::vector<std::uint8_t *>(rowpointer_buff_size);
+auto decoder::pixel_format() const noexcept -> format
+{
+    return state_->format;
+}
 
-    // Cast to png_bytep
-    auto *const row_pointers = static_cast<png_bytep *>(&(rowpointer_buffer)[0]);
+void decoder::decode(image_view &destination)
+{
+    if (math::dimensions(destination) != dimensions())
+        throw std::invalid_argument{"The destination must have the same dimensions as the image."};
 
-    // Set the individual row_pointers to point at the correct offsets
-    // of image_data
-    for (auto i = 0ul; i < temp_height; ++i)
+    if (imaging::pixel_format(destination) == pixel_format() &&
+        math::element_type(destination) == to_element_type(pixel_format()))
     {
-        row_pointers[i] = image_data + i * rowbytes;
+        detail::read_rows(
+            *state_,
+            [&destination](const image::dimensions_type y)
+            { return std::data(destination) + static_cast<std::size_t>(y) * math::stride(destination); },
+            [](const image::dimensions_type) {});
+
+        return;
     }
 
-    // Read the png into image_data through row_pointers
-    png_read_image(png_structs.png_ptr(), row_pointers);
+    // Interlaced images are only complete after the last pass, so they are converted from a temporary image.
+    if (state_->passes > 1)
+    {
+        image decoded{pixel_format(), dimensions()};
+        decode(decoded);
+        convert::to_format(decoded, destination, 1);
+        return;
+    }
 
-    const auto width = static_cast<image::dimensions_type>(temp_width);
-    const auto height = static_cast<image::dimensions_type>(temp_height);
+    decode(
+        [&destination](const image::dimensions_type y, const image_view &row)
+        {
+            auto destination_row = make_view(destination, {0, y, math::width(destination), y + 1});
+            convert::to_format(row, destination_row, 1);
+        });
+}
 
-    switch (color_type)
+void decoder::decode(const row_callback &callback)
+{
+    if (state_->passes > 1)
     {
-        case PNG_COLOR_TYPE_RGB:
-            return image{format::r8g8b8_uint, width, height, std::move(bitmap_buffer)};
-        case PNG_COLOR_TYPE_RGB_ALPHA:
-            return image{format::r8g8b8a8_uint, width, height, std::move(bitmap_buffer)};
-        case PNG_COLOR_TYPE_GRAY:
-            return image{format::r8_uint, width, height, std::move(bitmap_buffer)};
-        case PNG_COLOR_TYPE_GRAY_ALPHA:
-            return image{format::r8g8_uint, width, height, std::move(bitmap_buffer)};
-        default:
-            throw load_exception{};
+        image decoded{pixel_format(), dimensions()};
+        decode(decoded);
+
+        for (auto y = 0; y < math::height(decoded); ++y)
+            callback(y, make_view(decoded, {0, y, math::width(decoded), y + 1}));
+
+        return;
     }
+
+    image row{pixel_format(), math::width(dimensions()), 1};
+
+    detail::read_rows(
+        *state_, [&row](const image::dimensions_type) { return std::data(row); },
+        [&row, &callback](const image::dimensions_type y) { callback(y, row); });
+}
+
+[[nodiscard]] auto load(const std::filesystem::path &path) -> image
+{
+    auto stream = streams::make_dynamic_stream(streams::file_source_device{path});
+    return load(stream);
+}
+
+[[nodiscard]] auto load(streams::idynamic_stream &stream) -> image
+{
+    decoder png_decoder{stream};
+    image loaded_image{png_decoder.pixel_format(), png_decoder.dimensions()};
+    png_decoder.decode(loaded_image);
+    return loaded_image;
 }
 
 void save(const image_view &image, streams::idynamic_stream &stream)
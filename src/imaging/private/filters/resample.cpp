@@ -0,0 +1,288 @@
+// Distributed under the BSD 2-Clause License - Copyright 2012-2023 Robin Degen
+
+#include <aeon/imaging/filters/resample.h>
+#include "resample_kernels.h"
+#include "../parallel_rows.h"
+#include <algorithm>
+#include <stdexcept>
+#include <type_traits>
+#include <numbers>
+#include <cstring>
+#include <cmath>
+
+namespace aeon::imaging::filters
+{
+
+namespace detail
+{
+
+using imaging::detail::parallel_rows;
+
+[[nodiscard]] static auto filter_support(const resample_filter filter) noexcept -> double
+{
+    switch (filter)
+    {
+        case resample_filter::box:
+            return 0.5;
+        case resample_filter::bilinear:
+            return 1.0;
+        case resample_filter::bicubic:
+            return 2.0;
+        case resample_filter::lanczos3:
+            return 3.0;
+    }
+
+    return 1.0;
+}
+
+[[nodiscard]] static auto sinc(const double x) noexcept -> double
+{
+    if (x == 0.0)
+        return 1.0;
+
+    const auto value = x * std::numbers::pi;
+    return std::sin(value) / value;
+}
+
+[[nodiscard]] static auto filter_weight(const resample_filter filter, const double x) noexcept -> double
+{
+    switch (filter)
+    {
+        case resample_filter::box:
+            return (x >= -0.5 && x < 0.5) ? 1.0 : 0.0;
+        case resample_filter::bilinear:
+            return std::max(1.0 - std::abs(x), 0.0);
+        case resample_filter::bicubic:
+        {
+            // Keys cubic convolution with a = -0.5 (Catmull-Rom)
+            constexpr auto a = -0.5;
+            const auto t = std::abs(x);
+
+            if (t < 1.0)
+                return ((a + 2.0) * t - (a + 3.0)) * t * t + 1.0;
+
+            if (t < 2.0)
+                return ((a * t - 5.0 * a) * t + 8.0 * a) * t - 4.0 * a;
+
+            return 0.0;
+        }
+        case resample_filter::lanczos3:
+            return (std::abs(x) < 3.0) ? sinc(x) * sinc(x / 3.0) : 0.0;
+    }
+
+    return 0.0;
+}
+
+[[nodiscard]] static auto make_resample_weights(const resample_filter filter, const int source_size,
+                                                const int destination_size) -> resample_weights
+{
+    const auto scale = static_cast<double>(source_size) / static_cast<double>(destination_size);
+
+    // When downscaling, the filter is stretched so that it covers all source pixels.
+    const auto filter_scale = std::max(scale, 1.0);
+    const auto support = filter_support(filter) * filter_scale;
+
+    resample_weights weights;
+    weights.taps = static_cast<int>(std::ceil(support)) * 2 + 1;
+    weights.first.resize(static_cast<std::size_t>(destination_size));
+    weights.count.resize(static_cast<std::size_t>(destination_size));
+    weights.weights.resize(static_cast<std::size_t>(destination_size * weights.taps));
+    weights.fixed_weights.resize(static_cast<std::size_t>(destination_size * weights.taps));
+
+    std::vector<double> values(static_cast<std::size_t>(weights.taps));
+
+    for (auto x = 0; x < destination_size; ++x)
+    {
+        const auto center = (x + 0.5) * scale;
+        auto first = std::max(static_cast<int>(center - support + 0.5), 0);
+        auto last = std::min(static_cast<int>(center + support + 0.5), source_size);
+        last = std::min(last, first + weights.taps);
+
+        auto total = 0.0;
+        for (auto i = first; i < last; ++i)
+        {
+            values[i - first] = filter_weight(filter, (i - center + 0.5) / filter_scale);
+            total += values[i - first];
+        }
+
+        // Source pixels that do not contribute at the edges of the window are skipped.
+        auto offset = 0;
+        while (first + 1 < last && values[offset] == 0.0)
+        {
+            ++first;
+            ++offset;
+        }
+
+        while (last - 1 > first && values[last - 1 - first + offset] == 0.0)
+            --last;
+
+        const auto count = last - first;
+        auto *const w = &weights.weights[static_cast<std::size_t>(x * weights.taps)];
+        auto *const fixed = &weights.fixed_weights[static_cast<std::size_t>(x * weights.taps)];
+
+        auto fixed_total = 0;
+        auto largest = 0;
+
+        for (auto i = 0; i < count; ++i)
+        {
+            const auto value = (total != 0.0) ? values[i + offset] / total : 0.0;
+            w[i] = static_cast<float>(value);
+            fixed[i] = static_cast<std::int16_t>(std::lround(value * (1 << resample_precision_bits)));
+            fixed_total += fixed[i];
+
+            if (std::abs(fixed[i]) > std::abs(fixed[largest]))
+                largest = i;
+        }
+
+        // Rounding must not make the image brighter or darker; the difference goes to the largest weight.
+        fixed[largest] = static_cast<std::int16_t>(fixed[largest] + (1 << resample_precision_bits) - fixed_total);
+
+        weights.first[x] = first;
+        weights.count[x] = count;
+    }
+
+    return weights;
+}
+
+template <typename T>
+[[nodiscard]] static auto row_ptr(const image_view &view, const int y) noexcept -> const T *
+{
+    return reinterpret_cast<const T *>(std::data(view) + static_cast<std::size_t>(y) * math::stride(view));
+}
+
+template <typename T>
+[[nodiscard]] static auto row_ptr(image_view &view, const int y) noexcept -> T *
+{
+    return reinterpret_cast<T *>(std::data(view) + static_cast<std::size_t>(y) * math::stride(view));
+}
+
+template <typename T>
+static void resample(const image_view &src, image_view &dst, const resample_filter filter, const int components,
+                     const unsigned int concurrency)
+{
+    const auto src_width = math::width(src);
+    const auto src_height = math::height(src);
+    const auto dst_width = math::width(dst);
+    const auto dst_height = math::height(dst);
+
+    const auto horizontal = src_width != dst_width;
+    const auto vertical = src_height != dst_height;
+    const auto row_bytes = static_cast<std::size_t>(dst_width) * math::element_type(dst).stride;
+
+    if (!horizontal && !vertical)
+    {
+        for (auto y = 0; y < dst_height; ++y)
+            std::memcpy(row_ptr<T>(dst, y), row_ptr<T>(src, y), row_bytes);
+
+        return;
+    }
+
+    const auto row_size = static_cast<std::size_t>(dst_width * components);
+    const auto row_size_bytes = row_size * sizeof(T);
+    const auto horizontal_weights = make_resample_weights(filter, src_width, dst_width);
+    const auto vertical_weights = make_resample_weights(filter, src_height, dst_height);
+
+    if (!vertical)
+    {
+        parallel_rows(dst_height, row_size_bytes, concurrency,
+                      [&](const int begin, const int end)
+                      {
+                          for (auto y = begin; y < end; ++y)
+                              resample_row(row_ptr<T>(src, y), row_ptr<T>(dst, y), components, horizontal_weights);
+                      });
+
+        return;
+    }
+
+    // Only the source rows that contribute to the destination are resampled horizontally; into a temporary image
+    // with the destination width.
+    const auto first_row = vertical_weights.first.front();
+    const auto last_row = vertical_weights.first.back() + vertical_weights.count.back();
+
+    std::vector<T> intermediate;
+
+    if (horizontal)
+    {
+        intermediate.resize(static_cast<std::size_t>(last_row - first_row) * row_size);
+
+        parallel_rows(last_row - first_row, row_size_bytes, concurrency,
+                      [&](const int begin, const int end)
+                      {
+                          for (auto y = begin; y < end; ++y)
+                              resample_row(row_ptr<T>(src, first_row + y), &intermediate[y * row_size], components,
+                                           horizontal_weights);
+                      });
+    }
+
+    const auto source_row = [&](const int y) -> const T *
+    {
+        if (horizontal)
+            return &intermediate[static_cast<std::size_t>(y - first_row) * row_size];
+
+        return row_ptr<T>(src, y);
+    };
+
+    parallel_rows(dst_height, row_size_bytes, concurrency,
+                  [&](const int begin, const int end)
+                  {
+                      std::vector<const T *> rows(static_cast<std::size_t>(vertical_weights.taps));
+
+                      for (auto y = begin; y < end; ++y)
+                      {
+                          const auto first = vertical_weights.first[y];
+                          const auto count = vertical_weights.count[y];
+
+                          for (auto i = 0; i < count; ++i)
+                              rows[i] = source_row(first + i);
+
+                          const auto offset = static_cast<std::size_t>(y * vertical_weights.taps);
+
+                          if constexpr (std::is_same_v<T, std::uint8_t>)
+                              resample_column(std::data(rows), &vertical_weights.fixed_weights[offset], count,
+                                              row_ptr<T>(dst, y), row_size);
+                          else
+                              resample_column(std::data(rows), &vertical_weights.weights[offset], count,
+                                              row_ptr<T>(dst, y), row_size);
+                      }
+                  });
+}
+
+} // namespace detail
+
+auto resample(const image_view &img, const math::size2d<image::dimensions_type> size, const resample_filter filter,
+              const unsigned int concurrency) -> image
+{
+    image new_image{math::element_type(img), pixel_format(img), size};
+    resample(img, new_image, filter, concurrency);
+    return new_image;
+}
+
+void resample(const image_view &src, image_view &dst, const resample_filter filter, const unsigned int concurrency)
+{
+    const auto element_type = math::element_type(src);
+
+    if (element_type != math::element_type(dst))
+        throw std::invalid_argument{"Source and destination must have the same element type."};
+
+    if (math::width(src) <= 0 || math::height(src) <= 0 || math::width(dst) <= 0 || math::height(dst) <= 0)
+        return;
+
+    const auto threads = imaging::detail::parallel_rows_concurrency(concurrency);
+
+    // Padding within elements (like u8_3_stride_4) is resampled as if it were a component.
+    if (element_type.name == common::element_type_name::u8 && element_type.stride <= 4)
+    {
+        detail::resample<std::uint8_t>(src, dst, filter, static_cast<int>(element_type.stride), threads);
+    }
+    else if (element_type.name == common::element_type_name::f32 && element_type.stride <= 4 * sizeof(float) &&
+             element_type.stride % sizeof(float) == 0)
+    {
+        detail::resample<float>(src, dst, filter, static_cast<int>(element_type.stride / sizeof(float)), threads);
+    }
+    else
+    {
+        throw std::runtime_error{"Unsupported format."};
+    }
+}
+
+} // namespace aeon::imaging::filters
@@ -0,0 +1,451 @@
+// Distributed under the BSD 2-Clause License - Copyright 2012-2023 Robin Degen
+
+#include "resample_kernels.h"
+#include <algorithm>
+#include <cstring>
+
+#if (!defined(AEON_DISABLE_SSE) && (defined(__SSE2__) || defined(_M_X64)))
+#define AEON_IMAGING_RESAMPLE_SSE2 1
+#include <immintrin.h>
+
+#if (defined(__AVX2__))
+#define AEON_IMAGING_RESAMPLE_AVX2 1
+#endif
+#endif
+
+#if (defined(__ARM_NEON))
+#define AEON_IMAGING_RESAMPLE_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace aeon::imaging::filters::detail
+{
+
+namespace internal
+{
+
+static constexpr int rounding = 1 << (resample_precision_bits - 1);
+
+[[nodiscard]] static auto to_u8(const int sum) noexcept -> std::uint8_t
+{
+    return static_cast<std::uint8_t>(std::clamp(sum >> resample_precision_bits, 0, 255));
+}
+
+#if (defined(AEON_IMAGING_RESAMPLE_SSE2))
+/*!
+ * Two weights in one 32-bit value, as used by _mm_madd_epi16 on interleaved pairs of 16-bit values.
+ */
+[[nodiscard]] static auto weight_pair(const std::int16_t first, const std::int16_t second) noexcept -> int
+{
+    return static_cast<int>(static_cast<std::uint32_t>(static_cast<std::uint16_t>(first)) |
+                            (static_cast<std::uint32_t>(static_cast<std::uint16_t>(second)) << 16));
+}
+
+[[nodiscard]] static auto load_u32(const std::uint8_t *data) noexcept -> int
+{
+    int value;
+    std::memcpy(&value, data, sizeof(value));
+    return value;
+}
+#endif
+
+/*!
+ * Resample a row of pixels with 4 8-bit components; 2 source pixels at a time.
+ */
+static void resample_row_u8_4(const std::uint8_t *src, std::uint8_t *dst, const resample_weights &weights) noexcept
+{
+    const auto size = std::ssize(weights.first);
+
+    for (auto x = 0; x < size; ++x)
+    {
+        const auto *const w = &weights.fixed_weights[static_cast<std::size_t>(x * weights.taps)];
+        const auto *const pixels = src + weights.first[x] * 4;
+        const auto count = weights.count[x];
+
+#if (defined(AEON_IMAGING_RESAMPLE_SSE2))
+        const auto zero = _mm_setzero_si128();
+        auto sum = _mm_set1_epi32(rounding);
+
+        auto i = 0;
+        for (; i + 1 < count; i += 2)
+        {
+            // Interleave the components of both pixels, so that madd multiplies and adds them per component.
+            const auto pair = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(pixels + i * 4));
+            const auto interleaved = _mm_unpacklo_epi8(_mm_unpacklo_epi8(pair, _mm_srli_si128(pair, 4)), zero);
+            sum = _mm_add_epi32(sum, _mm_madd_epi16(interleaved, _mm_set1_epi32(weight_pair(w[i], w[i + 1]))));
+        }
+
+        if (i < count)
+        {
+            const auto pixel = _mm_cvtsi32_si128(load_u32(pixels + i * 4));
+            const auto interleaved = _mm_unpacklo_epi8(_mm_unpacklo_epi8(pixel, zero), zero);
+            sum = _mm_add_epi32(sum, _mm_madd_epi16(interleaved, _mm_set1_epi32(weight_pair(w[i], 0))));
+        }
+
+        sum = _mm_srai_epi32(sum, resample_precision_bits);
+        const auto result = _mm_cvtsi128_si32(_mm_packus_epi16(_mm_packs_epi32(sum, sum), zero));
+        std::memcpy(dst + x * 4, &result, sizeof(result));
+#elif (defined(AEON_IMAGING_RESAMPLE_NEON))
+        auto sum = vdupq_n_s32(rounding);
+
+        for (auto i = 0; i < count; ++i)
+        {
+            std::uint32_t packed;
+            std::memcpy(&packed, pixels + i * 4, sizeof(packed));
+            const auto pixel = vreinterpret_s16_u16(vget_low_u16(vmovl_u8(vreinterpret_u8_u32(vdup_n_u32(packed)))));
+            sum = vmlal_n_s16(sum, pixel, w[i]);
+        }
+
+        const auto narrowed = vqshrn_n_s32(sum, resample_precision_bits);
+        const auto result = vget_lane_u32(vreinterpret_u32_u8(vqmovun_s16(vcombine_s16(narrowed, narrowed))), 0);
+        std::memcpy(dst + x * 4, &result, sizeof(result));
+#else
+        int sum[4] = {rounding, rounding, rounding, rounding};
+
+        for (auto i = 0; i < count; ++i)
+        {
+            for (auto c = 0; c < 4; ++c)
+                sum[c] += pixels[i * 4 + c] * w[i];
+        }
+
+        for (auto c = 0; c < 4; ++c)
+            dst[x * 4 + c] = to_u8(sum[c]);
+#endif
+    }
+}
+
+template <int components_t>
+static void resample_row_u8(const std::uint8_t *src, std::uint8_t *dst, const resample_weights &weights) noexcept
+{
+    const auto size = std::ssize(weights.first);
+
+    for (auto x = 0; x < size; ++x)
+    {
+        const auto *const w = &weights.fixed_weights[static_cast<std::size_t>(x * weights.taps)];
+        const auto *const pixels = src + weights.first[x] * components_t;
+        const auto count = weights.count[x];
+
+        int sum[components_t];
+        std::fill_n(sum, components_t, rounding);
+
+        for (auto i = 0; i < count; ++i)
+        {
+            for (auto c = 0; c < components_t; ++c)
+                sum[c] += pixels[i * components_t + c] * w[i];
+        }
+
+        for (auto c = 0; c < components_t; ++c)
+            dst[x * components_t + c] = to_u8(sum[c]);
+    }
+}
+
+static void resample_row_f32_4(const float *src, float *dst, const resample_weights &weights) noexcept
+{
+    const auto size = std::ssize(weights.first);
+
+    for (auto x = 0; x < size; ++x)
+    {
+        const auto *const w = &weights.weights[static_cast<std::size_t>(x * weights.taps)];
+        const auto *const pixels = src + weights.first[x] * 4;
+        const auto count = weights.count[x];
+
+#if (defined(AEON_IMAGING_RESAMPLE_SSE2))
+        auto sum = _mm_setzero_ps();
+
+        for (auto i = 0; i < count; ++i)
+            sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(pixels + i * 4), _mm_set1_ps(w[i])));
+
+        _mm_storeu_ps(dst + x * 4, sum);
+#elif (defined(AEON_IMAGING_RESAMPLE_NEON))
+        auto sum = vdupq_n_f32(0.0f);
+
+        for (auto i = 0; i < count; ++i)
+            sum = vmlaq_n_f32(sum, vld1q_f32(pixels + i * 4), w[i]);
+
+        vst1q_f32(dst + x * 4, sum);
+#else
+        float sum[4] = {};
+
+        for (auto i = 0; i < count; ++i)
+        {
+            for (auto c = 0; c < 4; ++c)
+                sum[c] += pixels[i * 4 + c] * w[i];
+        }
+
+        std::copy_n(sum, 4, dst + x * 4);
+#endif
+    }
+}
+
+template <int components_t>
+static void resample_row_f32(const float *src, float *dst, const resample_weights &weights) noexcept
+{
+    const auto size = std::ssize(weights.first);
+
+    for (auto x = 0; x < size; ++x)
+    {
+        const auto *const w = &weights.weights[static_cast<std::size_t>(x * weights.taps)];
+        const auto *const pixels = src + weights.first[x] * components_t;
+        const auto count = weights.count[x];
+
+        float sum[components_t] = {};
+
+        for (auto i = 0; i < count; ++i)
+        {
+            for (auto c = 0; c < components_t; ++c)
+                sum[c] += pixels[i * components_t + c] * w[i];
+        }
+
+        std::copy_n(sum, components_t, dst + x * components_t);
+    }
+}
+
+#if (defined(AEON_IMAGING_RESAMPLE_AVX2))
+[[nodiscard]] static auto resample_column_u8_avx2(const std::uint8_t *const *rows, const std::int16_t *weights,
+                                                  const int count, std::uint8_t *dst, const std::size_t size) noexcept
+    -> std::size_t
+{
+    const auto zero = _mm256_setzero_si256();
+
+    std::size_t x = 0;
+    for (; x + 32 <= size; x += 32)
+    {
+        auto sum0 = _mm256_set1_epi32(rounding);
+        auto sum1 = sum0;
+        auto sum2 = sum0;
+        auto sum3 = sum0;
+
+        auto i = 0;
+        for (; i < count; i += 2)
+        {
+            // Interleave 2 rows, so that madd multiplies and adds them per byte. An odd last row is paired with 0.
+            const auto a = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(rows[i] + x));
+            const auto b =
+                (i + 1 < count) ? _mm256_loadu_si256(reinterpret_cast<const __m256i *>(rows[i + 1] + x)) : zero;
+            const auto w = _mm256_set1_epi32(weight_pair(weights[i], (i + 1 < count) ? weights[i + 1] : 0));
+
+            const auto lo = _mm256_unpacklo_epi8(a, b);
+            const auto hi = _mm256_unpackhi_epi8(a, b);
+            sum0 = _mm256_add_epi32(sum0, _mm256_madd_epi16(_mm256_unpacklo_epi8(lo, zero), w));
+            sum1 = _mm256_add_epi32(sum1, _mm256_madd_epi16(_mm256_unpackhi_epi8(lo, zero), w));
+            sum2 = _mm256_add_epi32(sum2, _mm256_madd_epi16(_mm256_unpacklo_epi8(hi, zero), w));
+            sum3 = _mm256_add_epi32(sum3, _mm256_madd_epi16(_mm256_unpackhi_epi8(hi, zero), w));
+        }
+
+        // The unpacks and packs both work within 128-bit lanes, so the bytes end up in their original order.
+        const auto low = _mm256_packs_epi32(_mm256_srai_epi32(sum0, resample_precision_bits),
+                                            _mm256_srai_epi32(sum1, resample_precision_bits));
+        const auto high = _mm256_packs_epi32(_mm256_srai_epi32(sum2, resample_precision_bits),
+                                             _mm256_srai_epi32(sum3, resample_precision_bits));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + x), _mm256_packus_epi16(low, high));
+    }
+
+    return x;
+}
+#endif
+
+#if (defined(AEON_IMAGING_RESAMPLE_SSE2))
+[[nodiscard]] static auto resample_column_u8_sse2(const std::uint8_t *const *rows, const std::int16_t *weights,
+                                                  const int count, std::uint8_t *dst, std::size_t x,
+                                                  const std::size_t size) noexcept -> std::size_t
+{
+    const auto zero = _mm_setzero_si128();
+
+    for (; x + 16 <= size; x += 16)
+    {
+        auto sum0 = _mm_set1_epi32(rounding);
+        auto sum1 = sum0;
+        auto sum2 = sum0;
+        auto sum3 = sum0;
+
+        auto i = 0;
+        for (; i < count; i += 2)
+        {
+            const auto a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(rows[i] + x));
+            const auto b = (i + 1 < count) ? _mm_loadu_si128(reinterpret_cast<const __m128i *>(rows[i + 1] + x)) : zero;
+            const auto w = _mm_set1_epi32(weight_pair(weights[i], (i + 1 < count) ? weights[i + 1] : 0));
+
+            const auto lo = _mm_unpacklo_epi8(a, b);
+            const auto hi = _mm_unpackhi_epi8(a, b);
+            sum0 = _mm_add_epi32(sum0, _mm_madd_epi16(_mm_unpacklo_epi8(lo, zero), w));
+            sum1 = _mm_add_epi32(sum1, _mm_madd_epi16(_mm_unpackhi_epi8(lo, zero), w));
+            sum2 = _mm_add_epi32(sum2, _mm_madd_epi16(_mm_unpacklo_epi8(hi, zero), w));
+            sum3 = _mm_add_epi32(sum3, _mm_madd_epi16(_mm_unpackhi_epi8(hi, zero), w));
+        }
+
+        const auto low = _mm_packs_epi32(_mm_srai_epi32(sum0, resample_precision_bits),
+                                         _mm_srai_epi32(sum1, resample_precision_bits));
+        const auto high = _mm_packs_epi32(_mm_srai_epi32(sum2, resample_precision_bits),
+                                          _mm_srai_epi32(sum3, resample_precision_bits));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + x), _mm_packus_epi16(low, high));
+    }
+
+    return x;
+}
+#endif
+
+#if (defined(AEON_IMAGING_RESAMPLE_NEON))
+[[nodiscard]] static auto resample_column_u8_neon(const std::uint8_t *const *rows, const std::int16_t *weights,
+                                                  const int count, std::uint8_t *dst, const std::size_t size) noexcept
+    -> std::size_t
+{
+    std::size_t x = 0;
+    for (; x + 16 <= size; x += 16)
+    {
+        auto sum0 = vdupq_n_s32(rounding);
+        auto sum1 = sum0;
+        auto sum2 = sum0;
+        auto sum3 = sum0;
+
+        for (auto i = 0; i < count; ++i)
+        {
+            const auto row = vld1q_u8(rows[i] + x);
+            const auto lo = vreinterpretq_s16_u16(vmovl_u8(vget_low_u8(row)));
+            const auto hi = vreinterpretq_s16_u16(vmovl_u8(vget_high_u8(row)));
+            sum0 = vmlal_n_s16(sum0, vget_low_s16(lo), weights[i]);
+            sum1 = vmlal_n_s16(sum1, vget_high_s16(lo), weights[i]);
+            sum2 = vmlal_n_s16(sum2, vget_low_s16(hi), weights[i]);
+            sum3 = vmlal_n_s16(sum3, vget_high_s16(hi), weights[i]);
+        }
+
+        const auto low = vcombine_s16(vqshrn_n_s32(sum0, resample_precision_bits),
+                                      vqshrn_n_s32(sum1, resample_precision_bits));
+        const auto high = vcombine_s16(vqshrn_n_s32(sum2, resample_precision_bits),
+                                       vqshrn_n_s32(sum3, resample_precision_bits));
+        vst1q_u8(dst + x, vcombine_u8(vqmovun_s16(low), vqmovun_s16(high)));
+    }
+
+    return x;
+}
+#endif
+
+[[nodiscard]] static auto resample_column_f32_simd(const float *const *rows, const float *weights, const int count,
+                                                   float *dst, const std::size_t size) noexcept -> std::size_t
+{
+    std::size_t x = 0;
+
+#if (defined(AEON_IMAGING_RESAMPLE_AVX2))
+    for (; x + 8 <= size; x += 8)
+    {
+        auto sum = _mm256_setzero_ps();
+
+        for (auto i = 0; i < count; ++i)
+            sum = _mm256_add_ps(sum, _mm256_mul_ps(_mm256_loadu_ps(rows[i] + x), _mm256_set1_ps(weights[i])));
+
+        _mm256_storeu_ps(dst + x, sum);
+    }
+#endif
+
+#if (defined(AEON_IMAGING_RESAMPLE_SSE2))
+    for (; x + 4 <= size; x += 4)
+    {
+        auto sum = _mm_setzero_ps();
+
+        for (auto i = 0; i < count; ++i)
+            sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(rows[i] + x), _mm_set1_ps(weights[i])));
+
+        _mm_storeu_ps(dst + x, sum);
+    }
+#elif (defined(AEON_IMAGING_RESAMPLE_NEON))
+    for (; x + 4 <= size; x += 4)
+    {
+        auto sum = vdupq_n_f32(0.0f);
+
+        for (auto i = 0; i < count; ++i)
+            sum = vmlaq_n_f32(sum, vld1q_f32(rows[i] + x), weights[i]);
+
+        vst1q_f32(dst + x, sum);
+    }
+#endif
+
+    return x;
+}
+
+} // namespace internal
+
+void resample_row(const std::uint8_t *src, std::uint8_t *dst, const int components,
+                  const resample_weights &weights) noexcept
+{
+    switch (components)
+    {
+        case 1:
+            internal::resample_row_u8<1>(src, dst, weights);
+            break;
+        case 2:
+            internal::resample_row_u8<2>(src, dst, weights);
+            break;
+        case 3:
+            internal::resample_row_u8<3>(src, dst, weights);
+            break;
+        case 4:
+            internal::resample_row_u8_4(src, dst, weights);
+            break;
+        default:
+            break;
+    }
+}
+
+void resample_row(const float *src, float *dst, const int components, const resample_weights &weights) noexcept
+{
+    switch (components)
+    {
+        case 1:
+            internal::resample_row_f32<1>(src, dst, weights);
+            break;
+        case 2:
+            internal::resample_row_f32<2>(src, dst, weights);
+            break;
+        case 3:
+            internal::resample_row_f32<3>(src, dst, weights);
+            break;
+        case 4:
+            internal::resample_row_f32_4(src, dst, weights);
+            break;
+        default:
+            break;
+    }
+}
+
+void resample_column(const std::uint8_t *const *rows, const std::int16_t *weights, const int count,
+                     std::uint8_t *dst, const std::size_t size) noexcept
+{
+    std::size_t x = 0;
+
+#if (defined(AEON_IMAGING_RESAMPLE_AVX2))
+    x = internal::resample_column_u8_avx2(rows, weights, count, dst, size);
+#endif
+
+#if (defined(AEON_IMAGING_RESAMPLE_SSE2))
+    x = internal::resample_column_u8_sse2(rows, weights, count, dst, x, size);
+#elif (defined(AEON_IMAGING_RESAMPLE_NEON))
+    x = internal::resample_column_u8_neon(rows, weights, count, dst, size);
+#endif
+
+    for (; x < size; ++x)
+    {
+        auto sum = internal::rounding;
+
+        for (auto i = 0; i < count; ++i)
+            sum += rows[i][x] * weights[i];
+
+        dst[x] = internal::to_u8(sum);
+    }
+}
+
+void resample_column(const float *const *rows, const float *weights, const int count, float *dst,
+                     const std::size_t size) noexcept
+{
+    auto x = internal::resample_column_f32_simd(rows, weights, count, dst, size);
+
+    for (; x < size; ++x)
+    {
+        auto sum = 0.0f;
+
+        for (auto i = 0; i < count; ++i)
+            sum += rows[i][x] * weights[i];
+
+        dst[x] = sum;
+    }
+}
+
+} // namespace aeon::imaging::filters::detail
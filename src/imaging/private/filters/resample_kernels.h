@@ -0,0 +1,47 @@
+// Distributed under the BSD 2-Clause License - Copyright 2012-2023 Robin Degen
+
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace aeon::imaging::filters::detail
+{
+
+// The amount of fractional bits of the fixed point weights that are used for 8-bit images.
+static constexpr int resample_precision_bits = 14;
+
+/*!
+ * The weights with which the source pixels are combined into every destination pixel, along one axis.
+ */
+struct resample_weights
+{
+    // The first source pixel and the amount of source pixels that contribute to every destination pixel
+    std::vector<int> first;
+    std::vector<int> count;
+
+    // The maximum amount of source pixels for a destination pixel; the size of the weights of every destination pixel
+    int taps = 0;
+
+    std::vector<float> weights;
+    std::vector<std::int16_t> fixed_weights;
+};
+
+/*!
+ * Resample a row horizontally. The source row must contain all pixels referred to by the weights; the destination
+ * row has a pixel for every set of weights. Every pixel has the given amount of components.
+ */
+void resample_row(const std::uint8_t *src, std::uint8_t *dst, const int components,
+                  const resample_weights &weights) noexcept;
+void resample_row(const float *src, float *dst, const int components, const resample_weights &weights) noexcept;
+
+/*!
+ * Resample vertically by combining the given rows with the given weights into one row of size components.
+ */
+void resample_column(const std::uint8_t *const *rows, const std::int16_t *weights, const int count,
+                     std::uint8_t *dst, const std::size_t size) noexcept;
+void resample_column(const float *const *rows, const float *weights, const int count, float *dst,
+                     const std::size_t size) noexcept;
+
+} // namespace aeon::imaging::filters::detail
@@ -0,0 +1,117 @@
+// Distributed under the BSD 2-Clause License - Copyright 2012-2023 Robin Degen
+
+#include "parallel_rows.h"
+
+namespace aeon::imaging::detail
+{
+
+parallel_rows_pool::parallel_rows_pool(const unsigned int thread_count)
+    : mutex_{}
+    , work_available_{}
+    , job_done_{}
+    , queue_{}
+    , stopped_{false}
+    , threads_{}
+{
+    threads_.reserve(thread_count);
+
+    for (auto i = 0u; i < thread_count; ++i)
+        threads_.emplace_back([this]() { worker(); });
+}
+
+parallel_rows_pool::~parallel_rows_pool()
+{
+    {
+        std::scoped_lock lock{mutex_};
+        stopped_ = true;
+    }
+
+    work_available_.notify_all();
+
+    for (auto &thread : threads_)
+        thread.join();
+}
+
+auto parallel_rows_pool::size() const noexcept -> unsigned int
+{
+    return static_cast<unsigned int>(std::size(threads_));
+}
+
+void parallel_rows_pool::run(const unsigned int helpers, const std::function<void()> &task)
+{
+    job current{&task, helpers, nullptr};
+
+    {
+        std::scoped_lock lock{mutex_};
+        queue_.insert(std::end(queue_), helpers, &current);
+    }
+
+    work_available_.notify_all();
+
+    std::exception_ptr exception;
+
+    try
+    {
+        task();
+    }
+    catch (...)
+    {
+        exception = std::current_exception();
+    }
+
+    // Once the task returned here, no work is left to take. Pool threads that did not start it yet are skipped.
+    std::unique_lock lock{mutex_};
+    const auto skipped = std::erase(queue_, &current);
+    current.pending -= static_cast<unsigned int>(skipped);
+    job_done_.wait(lock, [&current]() { return current.pending == 0; });
+
+    if (!exception)
+        exception = current.exception;
+
+    if (exception)
+        std::rethrow_exception(exception);
+}
+
+void parallel_rows_pool::worker()
+{
+    std::unique_lock lock{mutex_};
+
+    while (true)
+    {
+        work_available_.wait(lock, [this]() { return stopped_ || !std::empty(queue_); });
+
+        if (stopped_)
+            return;
+
+        auto *const current = queue_.front();
+        queue_.pop_front();
+
+        lock.unlock();
+        std::exception_ptr exception;
+
+        try
+        {
+            (*current->task)();
+        }
+        catch (...)
+        {
+            exception = std::current_exception();
+        }
+
+        lock.lock();
+
+        if (exception && !current->exception)
+            current->exception = exception;
+
+        --current->pending;
+        job_done_.notify_all();
+    }
+}
+
+auto get_parallel_rows_pool() -> parallel_rows_pool &
+{
+    static parallel_rows_pool pool{std::max(std::thread::hardware_concurrency(), 1u) - 1};
+    return pool;
+}
+
+} // namespace aeon::imaging::detail
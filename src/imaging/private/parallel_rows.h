@@ -0,0 +1,134 @@
+// Distributed under the BSD 2-Clause License - Copyright 2012-2023 Robin Degen
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <deque>
+#include <vector>
+#include <cstddef>
+
+namespace aeon::imaging::detail
+{
+
+// Rows are divided over threads in blocks of at least this amount of bytes, so that small images are not split into
+// more work than the threads cost.
+static constexpr std::size_t parallel_rows_min_block_size = 64 * 1024;
+
+// Images smaller than this amount of bytes are always processed on the calling thread.
+static constexpr std::size_t parallel_rows_min_image_size = 256 * 1024;
+
+/*!
+ * Threads that help the calling thread of parallel_rows. They are shared by all conversions and filters, so that
+ * processing many images does not start and join threads for every image.
+ */
+class parallel_rows_pool final
+{
+public:
+    explicit parallel_rows_pool(const unsigned int thread_count);
+    ~parallel_rows_pool();
+
+    parallel_rows_pool(parallel_rows_pool &&) = delete;
+    auto operator=(parallel_rows_pool &&) -> parallel_rows_pool & = delete;
+
+    parallel_rows_pool(const parallel_rows_pool &) = delete;
+    auto operator=(const parallel_rows_pool &) -> parallel_rows_pool & = delete;
+
+    [[nodiscard]] auto size() const noexcept -> unsigned int;
+
+    /*!
+     * Call the task on the calling thread and on up to the given amount of pool threads, and wait until all of those
+     * calls returned. Pool threads that did not start the task yet when it returns on the calling thread are skipped,
+     * so the task must take its work from a shared counter rather than expect a fixed amount of calls. An exception
+     * thrown by the task on any thread is rethrown here.
+     */
+    void run(const unsigned int helpers, const std::function<void()> &task);
+
+private:
+    struct job
+    {
+        const std::function<void()> *task;
+
+        // The amount of pool threads that are queued for, or are running, the task.
+        unsigned int pending;
+
+        // The first exception thrown by the task on any thread; rethrown on the calling thread.
+        std::exception_ptr exception;
+    };
+
+    void worker();
+
+    std::mutex mutex_;
+    std::condition_variable work_available_;
+    std::condition_variable job_done_;
+    std::deque<job *> queue_;
+    bool stopped_;
+    std::vector<std::thread> threads_;
+};
+
+/*!
+ * The pool that parallel_rows uses; one thread less than the hardware threads, since the calling thread also works.
+ * The threads are started on first use.
+ */
+[[nodiscard]] auto get_parallel_rows_pool() -> parallel_rows_pool &;
+
+/*!
+ * The amount of threads to use for the given concurrency, where 0 means all hardware threads.
+ */
+[[nodiscard]] inline auto parallel_rows_concurrency(const unsigned int concurrency) noexcept -> unsigned int
+{
+    if (concurrency != 0)
+        return concurrency;
+
+    return std::max(std::thread::hardware_concurrency(), 1u);
+}
+
+/*!
+ * Call the given function for ranges of rows (begin, end), divided over the calling thread and the threads of the
+ * shared pool; at most the given amount of threads in total. Small images are processed on the calling thread.
+ */
+template <typename function_t>
+void parallel_rows(const int rows, const std::size_t row_size, const unsigned int concurrency,
+                   const function_t &function)
+{
+    const auto block_rows = static_cast<int>(
+        std::max(parallel_rows_min_block_size / std::max(row_size, std::size_t{1}), std::size_t{1}));
+    const auto blocks = (rows + block_rows - 1) / block_rows;
+    const auto thread_count = std::min(static_cast<int>(concurrency), blocks);
+
+    if (thread_count <= 1 || static_cast<std::size_t>(rows) * row_size < parallel_rows_min_image_size)
+    {
+        function(0, rows);
+        return;
+    }
+
+    auto &pool = get_parallel_rows_pool();
+    const auto helpers = std::min(static_cast<unsigned int>(thread_count - 1), pool.size());
+
+    if (helpers == 0)
+    {
+        function(0, rows);
+        return;
+    }
+
+    // Smaller blocks than the minimum are used when there are enough rows, so that the threads stay balanced.
+    const auto rows_per_block = std::max(block_rows, rows / (thread_count * 4));
+    std::atomic<int> next{0};
+
+    pool.run(helpers,
+             [rows, rows_per_block, &next, &function]()
+             {
+                 for (auto begin = next.fetch_add(rows_per_block); begin < rows;
+                      begin = next.fetch_add(rows_per_block))
+                 {
+                     function(begin, std::min(begin + rows_per_block, rows));
+                 }
+             });
+}
+
+} // namespace aeon::imaging::detail
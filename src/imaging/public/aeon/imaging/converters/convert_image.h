@@ -0,0 +1,45 @@
+// Distributed under the BSD 2-Clause License - Copyright 2012-2023 Robin Degen
+
+#pragma once
+
+#include <aeon/imaging/image.h>
+
+namespace aeon::imaging::convert
+{
+
+/*!
+ * Convert an image to another pixel format. Components are matched by name (r, g, b, a), so for example r8g8b8_uint
+ * to b8g8r8a8_uint swaps red and blue and adds an opaque alpha. A single component (gray) source is expanded into
+ * red, green and blue; other components that are missing in the source are set to 0.
+ *
+ * 8-bit and 32-bit integer components are normalized to the range 0 to 1 when converted to floats; floats are clamped
+ * and rounded. Rows are converted with SIMD shuffles where available and divided over the given amount of threads;
+ * 0 uses all hardware threads. Views with a stride and elements with padding are supported. Compressed formats are
+ * not.
+ *
+ * \param[in] img - The image to convert
+ * \param[in] format - The pixel format of the converted image
+ * \param[in] concurrency - The maximum amount of threads to use
+ * \return A new image in the given format.
+ */
+[[nodiscard]] auto to_format(const image_view &img, const format format, const unsigned int concurrency = 0) -> image;
+
+/*!
+ * Convert an image into an existing view (for example a region of an atlas) with the same dimensions. The pixel
+ * format of the destination determines the conversion. The views may not overlap.
+ */
+void to_format(const image_view &src, image_view &dst, const unsigned int concurrency = 0);
+
+/*!
+ * Convert an image in place. Every converted row must fit within the stride of the image, which is always the case
+ * when the new format does not have larger pixels.
+ *
+ * \param[in] img - The image to convert. Only the returned view describes the data afterwards.
+ * \param[in] format - The new pixel format
+ * \param[in] concurrency - The maximum amount of threads to use
+ * \return A view on the same data with the new format.
+ */
+[[nodiscard]] auto to_format_in_place(image_view &img, const format format, const unsigned int concurrency = 0)
+    -> image_view;
+
+} // namespace aeon::imaging::convert
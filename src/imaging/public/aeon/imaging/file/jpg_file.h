@@ -5,17 +5,78 @@
 #include <aeon/imaging/image.h>
 #include <aeon/imaging/exceptions.h>
 #include <aeon/streams/idynamic_stream.h>
+#include <aeon/math/size2d.h>
 #include <filesystem>
+#include <functional>
+#include <memory>
 
 namespace aeon::imaging::file::jpg
 {
 
+namespace detail
+{
+class jpg_decoder_state;
+} // namespace detail
+
 class load_exception : public imaging_exception
 {
 };
 
-[[nodiscard]] auto load(const std::filesystem::path &path) -> image;
-[[nodiscard]] auto load(streams::idynamic_stream &stream) -> image;
+/*!
+ * Scale an image while decoding. This is done on the DCT coefficients, which is much faster than decoding the full
+ * image and resizing it afterwards. The dimensions are rounded up.
+ */
+enum class scale : int
+{
+    full = 1,
+    half = 2,
+    quarter = 4,
+    eighth = 8
+};
+
+/*!
+ * Decodes a jpg image row by row, while reading the stream in small blocks; the file is never completely in memory.
+ * The header is read on construction, so that the (scaled) dimensions and format are known before a destination is
+ * given. Grayscale images are r8_uint; all others are r8g8b8_uint.
+ *
+ * An image can only be decoded once. The stream must outlive the decoder.
+ */
+class decoder final
+{
+public:
+    // Called for every row from top to bottom, with a view of 1 row that is only valid during the call.
+    using row_callback = std::function<void(const image::dimensions_type y, const image_view &row)>;
+
+    explicit decoder(streams::idynamic_stream &stream, const scale scale = scale::full);
+    ~decoder();
+
+    decoder(decoder &&) noexcept;
+    auto operator=(decoder &&) noexcept -> decoder &;
+
+    decoder(const decoder &) noexcept = delete;
+    auto operator=(const decoder &) noexcept -> decoder & = delete;
+
+    [[nodiscard]] auto dimensions() const noexcept -> math::size2d<image::dimensions_type>;
+    [[nodiscard]] auto pixel_format() const noexcept -> format;
+
+    /*!
+     * Decode into an existing view with the same dimensions, for example a region of an atlas. Rows are decoded
+     * directly into r8_uint, r8g8b8_uint, b8g8r8_uint, r8g8b8a8_uint and b8g8r8a8_uint views (with an opaque alpha);
+     * for other formats every row is converted with convert::to_format.
+     */
+    void decode(image_view &destination);
+
+    void decode(const row_callback &callback);
+
+private:
+    std::unique_ptr<detail::jpg_decoder_state> state_;
+};
+
+/*!
+ * Load a jpg image as r8g8b8_uint, optionally scaled while decoding.
+ */
+[[nodiscard]] auto load(const std::filesystem::path &path, const scale scale = scale::full) -> image;
+[[nodiscard]] auto load(streams::idynamic_stream &stream, const scale scale = scale::full) -> image;
 
 class save_exception : public imaging_exception
 {
@@ -5,11 +5,19 @@
 #include <aeon/imaging/image.h>
 #include <aeon/imaging/exceptions.h>
 #include <aeon/streams/idynamic_stream.h>
+#include <aeon/math/size2d.h>
 #include <filesystem>
+#include <functional>
+#include <memory>
 
 namespace aeon::imaging::file::png
 {
 
+namespace detail
+{
+class png_decoder_state;
+} // namespace detail
+
 class load_exception : public imaging_exception
 {
 };
@@ -18,6 +26,43 @@ class save_exception : public imaging_exception
 {
 };
 
+/*!
+ * Decodes a png image row by row, without first decoding the whole image into memory. The header is read on
+ * construction, so that the dimensions and format are known before a destination is given. Palette, 16-bit and lower
+ * bit depth images are expanded to 8 bits per component.
+ *
+ * An image can only be decoded once. The stream must outlive the decoder.
+ */
+class decoder final
+{
+public:
+    // Called for every row from top to bottom, with a view of 1 row that is only valid during the call.
+    using row_callback = std::function<void(const image::dimensions_type y, const image_view &row)>;
+
+    explicit decoder(streams::idynamic_stream &stream);
+    ~decoder();
+
+    decoder(decoder &&) noexcept;
+    auto operator=(decoder &&) noexcept -> decoder &;
+
+    decoder(const decoder &) noexcept = delete;
+    auto operator=(const decoder &) noexcept -> decoder & = delete;
+
+    [[nodiscard]] auto dimensions() const noexcept -> math::size2d<image::dimensions_type>;
+    [[nodiscard]] auto pixel_format() const noexcept -> format;
+
+    /*!
+     * Decode into an existing view with the same dimensions, for example a region of an atlas. When the view has
+     * another pixel format, every row is converted with convert::to_format.
+     */
+    void decode(image_view &destination);
+
+    void decode(const row_callback &callback);
+
+private:
+    std::unique_ptr<detail::png_decoder_state> state_;
+};
+
 [[nodiscard]] auto load(const std::filesystem::path &path) -> image;
 [[nodiscard]] auto load(streams::idynamic_stream &stream) -> image;
 
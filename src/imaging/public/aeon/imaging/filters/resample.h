@@ -0,0 +1,44 @@
+// Distributed under the BSD 2-Clause License - Copyright 2012-2023 Robin Degen
+
+#pragma once
+
+#include <aeon/imaging/image.h>
+#include <aeon/math/size2d.h>
+
+namespace aeon::imaging::filters
+{
+
+enum class resample_filter
+{
+    box,
+    bilinear,
+    bicubic,
+    lanczos3
+};
+
+/*!
+ * Resample an image to the given size with a separable filter. The image is first resampled horizontally and then
+ * vertically, with weights that are calculated once for every column and row. When downscaling, the filter is
+ * widened so that every source pixel contributes.
+ *
+ * Images with 8-bit or 32-bit float components (1 to 4 per pixel) are supported; for 8-bit images the weights are in
+ * fixed point. Rows are divided over the given amount of threads; 0 uses all hardware threads.
+ *
+ * \param[in] img - The image to resample
+ * \param[in] size - The size of the resampled image
+ * \param[in] filter - The filter to resample with
+ * \param[in] concurrency - The maximum amount of threads to use
+ * \return A new image with the same element type and format as the given image.
+ */
+[[nodiscard]] auto resample(const image_view &img, const math::size2d<image::dimensions_type> size,
+                            const resample_filter filter = resample_filter::bilinear,
+                            const unsigned int concurrency = 0) -> image;
+
+/*!
+ * Resample an image into an existing view (for example a region of an atlas), which determines the size. The
+ * destination must have the same element type as the source and may not overlap with it.
+ */
+void resample(const image_view &src, image_view &dst, const resample_filter filter = resample_filter::bilinear,
+              const unsigned int concurrency = 0);
+
+} // namespace aeon::imaging::filters
@@ -57,6 +57,10 @@ struct resize_bilinear_impl
 
 } // namespace detail
 
+/*!
+ * Resize an image with bilinear filtering, on the calling thread. Unlike resample(), the filter is not widened when
+ * downscaling, so only the 4 nearest source pixels contribute to each destination pixel.
+ */
 [[nodiscard]] inline auto resize_bilinear(const image_view &img, const math::size2d<image::dimensions_type> size)
     -> image
 {
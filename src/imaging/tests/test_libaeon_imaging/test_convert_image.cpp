@@ -0,0 +1,350 @@
+// Distributed under the BSD 2-Clause License - Copyright 2012-2023 Robin Degen
+
+#include <aeon/imaging/converters/convert_image.h>
+#include <aeon/imaging/pixel_encoding.h>
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <array>
+#include <span>
+#include <thread>
+#include <vector>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+using namespace aeon;
+
+namespace
+{
+
+constexpr std::array formats{imaging::format::b8g8r8_uint,        imaging::format::b8g8r8a8_uint,
+                             imaging::format::r32_float,          imaging::format::r32_uint,
+                             imaging::format::r32g32_float,       imaging::format::r32g32_uint,
+                             imaging::format::r32g32b32_float,    imaging::format::r32g32b32_uint,
+                             imaging::format::r32g32b32a32_float, imaging::format::r32g32b32a32_uint,
+                             imaging::format::r8_uint,            imaging::format::r8g8_uint,
+                             imaging::format::r8g8b8_uint,        imaging::format::r8g8b8a8_uint};
+
+// Sizes that are not a multiple of the SIMD widths, so that the remainders are tested too.
+constexpr std::array<math::size2d<imaging::image::dimensions_type>, 3> sizes{{{67, 3}, {5, 2}, {1, 1}}};
+
+// The logical channels (r = 0, g = 1, b = 2, a = 3) of every component of a format.
+[[nodiscard]] auto channels(const imaging::format format) -> std::vector<int>
+{
+    switch (format)
+    {
+        case imaging::format::b8g8r8_uint:
+            return {2, 1, 0};
+        case imaging::format::b8g8r8a8_uint:
+            return {2, 1, 0, 3};
+        default:
+        {
+            std::vector<int> result(imaging::to_element_type(format).count);
+            for (auto i = 0u; i < std::size(result); ++i)
+                result[i] = static_cast<int>(i);
+            return result;
+        }
+    }
+}
+
+[[nodiscard]] auto bytes(imaging::image &image) -> std::span<std::byte>
+{
+    return {std::data(image), math::stride(image) * static_cast<std::size_t>(math::height(image))};
+}
+
+[[nodiscard]] auto make_noise_image(const imaging::format format, const math::size2d<int> size) -> imaging::image
+{
+    imaging::image image{format, size};
+
+    std::uint32_t state = 12345;
+    const auto next = [&state]()
+    {
+        state = state * 1664525u + 1013904223u;
+        return state;
+    };
+
+    if (math::element_type(image).name == common::element_type_name::f32)
+    {
+        // Also values outside of 0 to 1, which must be clamped.
+        auto *const data = reinterpret_cast<float *>(std::data(image));
+        for (std::size_t i = 0; i < std::size(bytes(image)) / sizeof(float); ++i)
+            data[i] = static_cast<float>(next() >> 8) / 16777216.0f * 1.5f - 0.25f;
+    }
+    else
+    {
+        for (auto &value : bytes(image))
+            value = static_cast<std::byte>(next() >> 24);
+    }
+
+    return image;
+}
+
+/*!
+ * Read a component as the raw value of its type (converted to double) and write it to another type, the same way
+ * as the conversion is documented.
+ */
+[[nodiscard]] auto convert_component(const imaging::image_view &view, const int x, const int y, const int component,
+                                     const common::element_type_name destination) -> double
+{
+    const auto source = math::element_type(view).name;
+    const auto *const pixel = math::at<std::byte>(view, x, y);
+
+    if (source == common::element_type_name::u8)
+    {
+        const auto value = reinterpret_cast<const std::uint8_t *>(pixel)[component];
+
+        if (destination == common::element_type_name::f32)
+            return static_cast<float>(value) * (1.0f / 255.0f);
+
+        if (destination == common::element_type_name::u32)
+            return value * 0x01010101u;
+
+        return value;
+    }
+
+    if (source == common::element_type_name::u32)
+    {
+        const auto value = reinterpret_cast<const std::uint32_t *>(pixel)[component];
+
+        if (destination == common::element_type_name::f32)
+            return static_cast<float>(static_cast<double>(value) / 4294967295.0);
+
+        if (destination == common::element_type_name::u8)
+            return value >> 24;
+
+        return value;
+    }
+
+    const auto value = reinterpret_cast<const float *>(pixel)[component];
+
+    if (destination == common::element_type_name::u8)
+        return static_cast<double>(std::lrint(std::clamp(value * 255.0f, 0.0f, 255.0f)));
+
+    if (destination == common::element_type_name::u32)
+        return static_cast<double>(std::llrint(std::clamp(static_cast<double>(value), 0.0, 1.0) * 4294967295.0));
+
+    return value;
+}
+
+[[nodiscard]] auto read_component(const imaging::image_view &view, const int x, const int y, const int component)
+    -> double
+{
+    const auto *const pixel = math::at<std::byte>(view, x, y);
+
+    switch (math::element_type(view).name)
+    {
+        case common::element_type_name::u8:
+            return reinterpret_cast<const std::uint8_t *>(pixel)[component];
+        case common::element_type_name::u32:
+            return reinterpret_cast<const std::uint32_t *>(pixel)[component];
+        default:
+            return reinterpret_cast<const float *>(pixel)[component];
+    }
+}
+
+void expect_converted(const imaging::image_view &src, const imaging::image_view &dst)
+{
+    const auto source_channels = channels(imaging::pixel_format(src));
+    const auto destination_channels = channels(imaging::pixel_format(dst));
+    const auto destination_type = math::element_type(dst).name;
+
+    const auto one = (destination_type == common::element_type_name::u8)    ? 255.0
+                     : (destination_type == common::element_type_name::u32) ? 4294967295.0
+                                                                            : 1.0;
+
+    for (auto y = 0; y < math::height(dst); ++y)
+    {
+        for (auto x = 0; x < math::width(dst); ++x)
+        {
+            for (auto c = 0; c < static_cast<int>(std::size(destination_channels)); ++c)
+            {
+                const auto channel = destination_channels[c];
+                const auto found = std::ranges::find(source_channels, channel);
+
+                auto expected = 0.0;
+
+                if (found != std::end(source_channels))
+                    expected = convert_component(src, x, y, static_cast<int>(found - std::begin(source_channels)),
+                                                 destination_type);
+                else if (std::size(source_channels) == 1 && channel != 3)
+                    expected = convert_component(src, x, y, 0, destination_type);
+                else if (channel == 3)
+                    expected = one;
+
+                ASSERT_DOUBLE_EQ(expected, read_component(dst, x, y, c))
+                    << "at " << x << ", " << y << " component " << c << " from "
+                    << static_cast<int>(imaging::pixel_format(src)) << " to "
+                    << static_cast<int>(imaging::pixel_format(dst));
+            }
+        }
+    }
+}
+
+} // namespace
+
+TEST(test_convert_image, all_format_pairs)
+{
+    for (const auto source : formats)
+    {
+        for (const auto size : sizes)
+        {
+            const auto image = make_noise_image(source, size);
+
+            for (const auto destination : formats)
+            {
+                const auto result = imaging::convert::to_format(image, destination);
+                ASSERT_EQ(destination, imaging::pixel_format(result));
+                ASSERT_EQ(size, math::dimensions(result));
+                expect_converted(image, result);
+            }
+        }
+    }
+}
+
+TEST(test_convert_image, known_values)
+{
+    imaging::image gray{imaging::format::r8_uint, 1, 1};
+    *math::at<std::uint8_t>(gray, 0, 0) = 100;
+
+    const auto rgba = imaging::convert::to_format(gray, imaging::format::r8g8b8a8_uint);
+    const auto expanded = *math::at<imaging::rgba32>(rgba, 0, 0);
+    EXPECT_EQ(100, expanded.r);
+    EXPECT_EQ(100, expanded.g);
+    EXPECT_EQ(100, expanded.b);
+    EXPECT_EQ(255, expanded.a);
+
+    imaging::image rgb{imaging::format::r8g8b8_uint, 1, 1};
+    *math::at<imaging::rgb24>(rgb, 0, 0) = imaging::rgb24{10, 20, 30};
+
+    const auto bgra = imaging::convert::to_format(rgb, imaging::format::b8g8r8a8_uint);
+    const auto swapped = *math::at<imaging::bgra32>(bgra, 0, 0);
+    EXPECT_EQ(10, swapped.r);
+    EXPECT_EQ(20, swapped.g);
+    EXPECT_EQ(30, swapped.b);
+    EXPECT_EQ(255, swapped.a);
+
+    const auto floats = imaging::convert::to_format(rgb, imaging::format::r32g32b32a32_float);
+    EXPECT_FLOAT_EQ(20.0f / 255.0f, math::at<float>(floats, 0, 0)[1]);
+    EXPECT_FLOAT_EQ(1.0f, math::at<float>(floats, 0, 0)[3]);
+}
+
+TEST(test_convert_image, convert_between_views_with_stride)
+{
+    auto image = make_noise_image(imaging::format::r8g8b8a8_uint, {100, 50});
+    const auto source = imaging::make_view(image, {3, 5, 3 + 61, 5 + 33});
+
+    imaging::image atlas{imaging::format::b8g8r8_uint, 128, 64};
+    math::fill(atlas, imaging::bgr24{1, 2, 3});
+
+    auto region = imaging::make_view(atlas, {20, 10, 20 + 61, 10 + 33});
+    imaging::convert::to_format(source, region);
+    expect_converted(source, region);
+
+    // Pixels outside of the region are untouched.
+    const auto outside = *math::at<imaging::bgr24>(atlas, 19, 10);
+    EXPECT_EQ(1, outside.b);
+    EXPECT_EQ(2, outside.g);
+    EXPECT_EQ(3, outside.r);
+
+    imaging::image wrong_size{imaging::format::b8g8r8_uint, 60, 33};
+    EXPECT_THROW(imaging::convert::to_format(source, wrong_size), std::invalid_argument);
+}
+
+TEST(test_convert_image, convert_padded_elements)
+{
+    // The default stride is based on the element size, so padded elements need an explicit stride.
+    imaging::image image{common::element_type::u8_3_stride_4, imaging::format::r8g8b8_uint, 37, 9, 37 * 4};
+
+    for (auto y = 0; y < math::height(image); ++y)
+    {
+        for (auto x = 0; x < math::width(image); ++x)
+        {
+            const std::array<std::uint8_t, 4> pixel{static_cast<std::uint8_t>(x), static_cast<std::uint8_t>(y),
+                                                    static_cast<std::uint8_t>(x + y), 255};
+            std::memcpy(math::at<std::uint8_t>(image, x, y), std::data(pixel), std::size(pixel));
+        }
+    }
+
+    const auto result = imaging::convert::to_format(image, imaging::format::b8g8r8a8_uint);
+    expect_converted(image, result);
+
+    imaging::image padded{common::element_type::u8_3_stride_4, imaging::format::b8g8r8_uint, 37, 9, 37 * 4};
+    imaging::convert::to_format(result, padded);
+    expect_converted(result, padded);
+    EXPECT_EQ(0, math::at<std::uint8_t>(padded, 5, 5)[3]);
+}
+
+TEST(test_convert_image, convert_in_place)
+{
+    auto image = make_noise_image(imaging::format::r8g8b8a8_uint, {67, 13});
+    const auto original = image.clone();
+
+    auto bgra = imaging::convert::to_format_in_place(image, imaging::format::b8g8r8a8_uint);
+    EXPECT_EQ(std::data(image), std::data(bgra));
+    expect_converted(original, bgra);
+
+    const auto rgb = imaging::convert::to_format_in_place(bgra, imaging::format::r8g8b8_uint);
+    EXPECT_EQ(math::stride(original), math::stride(rgb));
+    expect_converted(original, rgb);
+
+    // Larger pixels only fit when the stride allows it.
+    auto gray = make_noise_image(imaging::format::r8_uint, {67, 13});
+    EXPECT_THROW((void)imaging::convert::to_format_in_place(gray, imaging::format::r8g8b8a8_uint),
+                 std::invalid_argument);
+
+    auto wide = make_noise_image(imaging::format::r8g8b8a8_uint, {67, 13});
+    imaging::image_view narrow{imaging::format::r8_uint, {67, 13}, math::stride(wide), std::data(wide)};
+    const auto narrow_original = imaging::image{common::element_type::u8_1, imaging::format::r8_uint, {67, 13},
+                                                math::stride(wide), std::data(wide)};
+
+    const auto expanded = imaging::convert::to_format_in_place(narrow, imaging::format::r8g8b8a8_uint);
+    expect_converted(narrow_original, expanded);
+}
+
+TEST(test_convert_image, threads_give_the_same_result)
+{
+    const auto image = make_noise_image(imaging::format::r8g8b8_uint, {1024, 300});
+
+    auto single = imaging::convert::to_format(image, imaging::format::r32g32b32a32_float, 1);
+    auto multiple = imaging::convert::to_format(image, imaging::format::r32g32b32a32_float, 8);
+    EXPECT_TRUE(std::ranges::equal(bytes(single), bytes(multiple)));
+}
+
+TEST(test_convert_image, conversions_from_multiple_threads_share_the_pool)
+{
+    const auto image = make_noise_image(imaging::format::r8g8b8_uint, {1024, 300});
+    auto expected = imaging::convert::to_format(image, imaging::format::r32g32b32a32_float, 1);
+
+    std::vector<std::thread> threads;
+    std::vector<int> mismatches(4, 0);
+
+    for (std::size_t t = 0; t < std::size(mismatches); ++t)
+    {
+        threads.emplace_back(
+            [&image, &expected, &mismatches, t]()
+            {
+                for (auto i = 0; i < 10; ++i)
+                {
+                    auto result = imaging::convert::to_format(image, imaging::format::r32g32b32a32_float, 0);
+
+                    if (!std::ranges::equal(bytes(expected), bytes(result)))
+                        ++mismatches[t];
+                }
+            });
+    }
+
+    for (auto &thread : threads)
+        thread.join();
+
+    for (const auto count : mismatches)
+        EXPECT_EQ(0, count);
+}
+
+TEST(test_convert_image, unsupported_formats_throw)
+{
+    imaging::image image{imaging::format::r8g8b8a8_uint, 4, 4};
+    EXPECT_THROW((void)imaging::convert::to_format(image, imaging::format::bc1_rgb_srgb_block), std::runtime_error);
+
+    imaging::image mismatch{common::element_type::u8_2, imaging::format::r8g8b8_uint, 4, 4};
+    EXPECT_THROW((void)imaging::convert::to_format(mismatch, imaging::format::r8g8b8a8_uint), std::runtime_error);
+}
@@ -2,8 +2,14 @@
 
 #include <aeon/imaging/file/jpg_file.h>
 #include <aeon/imaging/file/png_file.h>
+#include <aeon/imaging/pixel_encoding.h>
+#include <aeon/streams/dynamic_stream.h>
+#include <aeon/streams/devices/file_device.h>
+#include <aeon/streams/devices/iostream_device.h>
 #include "imaging_unittest_data.h"
 #include <gtest/gtest.h>
+#include <sstream>
+#include <string>
 
 using namespace aeon;
 
@@ -27,3 +33,93 @@ TEST(test_imaging, test_load_and_save_jpg_make_view_crop)
     const auto view = imaging::make_view(image, {400, 300, 450 + 200, 300 + 130});
     imaging::file::jpg::save(view, imaging::file::jpg::subsample_mode::subsample_440, 60, "test_save_jpg_cropped.jpg");
 }
+
+TEST(test_imaging, test_decode_jpg_scaled)
+{
+    const auto image = imaging::file::jpg::load(AEON_IMAGING_UNITTEST_DATA_PATH "felix.jpg");
+
+    for (const auto scale : {imaging::file::jpg::scale::half, imaging::file::jpg::scale::quarter,
+                             imaging::file::jpg::scale::eighth})
+    {
+        const auto denominator = static_cast<int>(scale);
+        const auto width = (math::width(image) + denominator - 1) / denominator;
+        const auto height = (math::height(image) + denominator - 1) / denominator;
+        const math::size2d<imaging::image::dimensions_type> expected{width, height};
+
+        auto stream =
+            streams::make_dynamic_stream(streams::file_source_device{AEON_IMAGING_UNITTEST_DATA_PATH "felix.jpg"});
+        imaging::file::jpg::decoder decoder{stream, scale};
+        EXPECT_EQ(expected, decoder.dimensions());
+
+        const auto scaled = imaging::file::jpg::load(AEON_IMAGING_UNITTEST_DATA_PATH "felix.jpg", scale);
+        EXPECT_EQ(expected, math::dimensions(scaled));
+        EXPECT_EQ(imaging::format::r8g8b8_uint, imaging::pixel_format(scaled));
+    }
+}
+
+TEST(test_imaging, test_decode_jpg_into_atlas_region)
+{
+    const auto image = imaging::file::jpg::load(AEON_IMAGING_UNITTEST_DATA_PATH "felix.jpg");
+
+    auto stream =
+        streams::make_dynamic_stream(streams::file_source_device{AEON_IMAGING_UNITTEST_DATA_PATH "felix.jpg"});
+    imaging::file::jpg::decoder decoder{stream};
+    ASSERT_EQ(math::dimensions(image), decoder.dimensions());
+
+    // Decoded directly into 4 components with an opaque alpha
+    imaging::image atlas{imaging::format::b8g8r8a8_uint, math::width(image) + 20, math::height(image) + 10};
+    math::fill(atlas, imaging::bgra32{1, 2, 3, 4});
+
+    auto region = imaging::make_view(atlas, {15, 5, 15 + math::width(image), 5 + math::height(image)});
+    decoder.decode(region);
+
+    for (auto y = 0; y < math::height(image); ++y)
+    {
+        for (auto x = 0; x < math::width(image); ++x)
+        {
+            const auto expected = *math::at<imaging::rgb24>(image, x, y);
+            ASSERT_EQ((imaging::bgra32{expected.b, expected.g, expected.r, 255}),
+                      *math::at<imaging::bgra32>(region, x, y));
+        }
+    }
+
+    EXPECT_EQ((imaging::bgra32{1, 2, 3, 4}), *math::at<imaging::bgra32>(atlas, 14, 5));
+    EXPECT_THROW(decoder.decode(region), imaging::file::jpg::load_exception);
+}
+
+TEST(test_imaging, test_decode_jpg_rows)
+{
+    const auto image = imaging::file::jpg::load(AEON_IMAGING_UNITTEST_DATA_PATH "felix.jpg");
+
+    auto stream =
+        streams::make_dynamic_stream(streams::file_source_device{AEON_IMAGING_UNITTEST_DATA_PATH "felix.jpg"});
+    imaging::file::jpg::decoder decoder{stream};
+    ASSERT_EQ(imaging::format::r8g8b8_uint, decoder.pixel_format());
+
+    auto next_row = 0;
+    decoder.decode(
+        [&](const imaging::image::dimensions_type y, const imaging::image_view &row)
+        {
+            ASSERT_EQ(next_row++, y);
+
+            for (auto x = 0; x < math::width(image); ++x)
+                ASSERT_EQ(*math::at<imaging::rgb24>(image, x, y), *math::at<imaging::rgb24>(row, x, 0));
+        });
+
+    EXPECT_EQ(math::height(image), next_row);
+}
+
+TEST(test_imaging, test_load_truncated_jpg_throws)
+{
+    auto file = streams::make_dynamic_stream(streams::file_source_device{AEON_IMAGING_UNITTEST_DATA_PATH "felix.jpg"});
+    std::string data(static_cast<std::size_t>(file.size()), '\0');
+    file.read(reinterpret_cast<std::byte *>(std::data(data)), static_cast<std::streamsize>(std::size(data)));
+
+    // Cut inside the markers before the frame header, and inside the entropy coded data.
+    for (const auto size : {std::size_t{2}, std::size_t{100}, std::size(data) / 2})
+    {
+        std::stringstream truncated{data.substr(0, size)};
+        auto stream = streams::make_dynamic_stream(streams::iostream_source_device{truncated});
+        EXPECT_THROW((void)imaging::file::jpg::load(stream), imaging::file::jpg::load_exception) << size;
+    }
+}
@@ -2,11 +2,57 @@
 
 #include <aeon/imaging/file/png_file.h>
 #include <aeon/imaging/filters/resize.h>
+#include <aeon/imaging/converters/convert_image.h>
+#include <aeon/imaging/pixel_encoding.h>
+#include <aeon/streams/dynamic_stream.h>
+#include <aeon/streams/devices/file_device.h>
+#include <aeon/streams/devices/iostream_device.h>
 #include "imaging_unittest_data.h"
 #include <gtest/gtest.h>
+#include <cstdint>
+#include <sstream>
+#include <string>
 
 using namespace aeon;
 
+namespace
+{
+
+// The fixtures are 13x11 so that every Adam7 pass and every packed row ends on a partial byte.
+constexpr auto fixture_width = 13;
+constexpr auto fixture_height = 11;
+
+// 16 entries of {i * 16, 255 - i * 16, i * 5}, with an alpha of i * 17 in palette_trns.png.
+[[nodiscard]] auto fixture_palette_index(const int x, const int y) noexcept -> std::uint8_t
+{
+    return static_cast<std::uint8_t>((x + y * fixture_width) % 16);
+}
+
+// The 16 bit fixtures store every component as (value << 8) | (255 - value).
+[[nodiscard]] auto fixture_rgba(const int x, const int y) noexcept -> imaging::rgba32
+{
+    return {static_cast<std::uint8_t>(x * 20), static_cast<std::uint8_t>(y * 23), static_cast<std::uint8_t>(x * y),
+            static_cast<std::uint8_t>((x + y) * 9)};
+}
+
+[[nodiscard]] auto load_fixture(const char *const name) -> imaging::image
+{
+    auto image = imaging::file::png::load(std::string{AEON_IMAGING_UNITTEST_DATA_PATH} + name);
+    EXPECT_EQ(fixture_width, math::width(image));
+    EXPECT_EQ(fixture_height, math::height(image));
+    return image;
+}
+
+[[nodiscard]] auto read_file(const char *const path) -> std::string
+{
+    auto stream = streams::make_dynamic_stream(streams::file_source_device{path});
+    std::string data(static_cast<std::size_t>(stream.size()), '\0');
+    stream.read(reinterpret_cast<std::byte *>(std::data(data)), static_cast<std::streamsize>(std::size(data)));
+    return data;
+}
+
+} // namespace
+
 TEST(test_imaging, test_load_and_save_png)
 {
     const auto image = imaging::file::png::load(AEON_IMAGING_UNITTEST_DATA_PATH "felix.png");
@@ -51,3 +97,204 @@ TEST(test_imaging, test_load_and_save_png_resize_downscale)
     const auto scaled_image = imaging::filters::resize_bilinear(image, {24, 24});
     imaging::file::png::save(scaled_image, "felix_24x24.png");
 }
+
+TEST(test_imaging, test_decode_png_into_atlas_region)
+{
+    const auto image = imaging::file::png::load(AEON_IMAGING_UNITTEST_DATA_PATH "felix.png");
+
+    auto stream =
+        streams::make_dynamic_stream(streams::file_source_device{AEON_IMAGING_UNITTEST_DATA_PATH "felix.png"});
+    imaging::file::png::decoder decoder{stream};
+    ASSERT_EQ(math::dimensions(image), decoder.dimensions());
+    ASSERT_EQ(imaging::format::r8g8b8a8_uint, decoder.pixel_format());
+
+    imaging::image atlas{imaging::format::r8g8b8a8_uint, math::width(image) + 20, math::height(image) + 10};
+    math::fill(atlas, imaging::rgba32{1, 2, 3, 4});
+
+    auto region = imaging::make_view(atlas, {15, 5, 15 + math::width(image), 5 + math::height(image)});
+    decoder.decode(region);
+
+    for (auto y = 0; y < math::height(image); ++y)
+    {
+        for (auto x = 0; x < math::width(image); ++x)
+            ASSERT_EQ(*math::at<imaging::rgba32>(image, x, y), *math::at<imaging::rgba32>(region, x, y));
+    }
+
+    EXPECT_EQ((imaging::rgba32{1, 2, 3, 4}), *math::at<imaging::rgba32>(atlas, 14, 5));
+
+    // An image can only be decoded once.
+    EXPECT_THROW(decoder.decode(region), imaging::file::png::load_exception);
+}
+
+TEST(test_imaging, test_decode_png_converts_to_destination_format)
+{
+    const auto image = imaging::file::png::load(AEON_IMAGING_UNITTEST_DATA_PATH "felix.png");
+    const auto expected = imaging::convert::to_format(image, imaging::format::b8g8r8_uint);
+
+    auto stream =
+        streams::make_dynamic_stream(streams::file_source_device{AEON_IMAGING_UNITTEST_DATA_PATH "felix.png"});
+    imaging::file::png::decoder decoder{stream};
+
+    imaging::image result{imaging::format::b8g8r8_uint, decoder.dimensions()};
+    decoder.decode(result);
+
+    for (auto y = 0; y < math::height(image); ++y)
+    {
+        for (auto x = 0; x < math::width(image); ++x)
+            ASSERT_EQ(*math::at<imaging::bgr24>(expected, x, y), *math::at<imaging::bgr24>(result, x, y));
+    }
+}
+
+TEST(test_imaging, test_decode_png_rows)
+{
+    const auto image = imaging::file::png::load(AEON_IMAGING_UNITTEST_DATA_PATH "felix.png");
+
+    auto stream =
+        streams::make_dynamic_stream(streams::file_source_device{AEON_IMAGING_UNITTEST_DATA_PATH "felix.png"});
+    imaging::file::png::decoder decoder{stream};
+
+    auto next_row = 0;
+    decoder.decode(
+        [&](const imaging::image::dimensions_type y, const imaging::image_view &row)
+        {
+            ASSERT_EQ(next_row++, y);
+            ASSERT_EQ(math::width(image), math::width(row));
+            ASSERT_EQ(1, math::height(row));
+
+            for (auto x = 0; x < math::width(image); ++x)
+                ASSERT_EQ(*math::at<imaging::rgba32>(image, x, y), *math::at<imaging::rgba32>(row, x, 0));
+        });
+
+    EXPECT_EQ(math::height(image), next_row);
+}
+
+TEST(test_imaging, test_load_png_palette_expands_to_rgb)
+{
+    auto image = load_fixture("palette_4bit.png");
+    ASSERT_EQ(imaging::format::r8g8b8_uint, imaging::pixel_format(image));
+
+    for (auto y = 0; y < fixture_height; ++y)
+    {
+        for (auto x = 0; x < fixture_width; ++x)
+        {
+            const auto i = fixture_palette_index(x, y);
+            ASSERT_EQ((imaging::rgb24{static_cast<std::uint8_t>(i * 16), static_cast<std::uint8_t>(255 - i * 16),
+                                      static_cast<std::uint8_t>(i * 5)}),
+                      *math::at<imaging::rgb24>(image, x, y));
+        }
+    }
+}
+
+TEST(test_imaging, test_load_png_palette_with_transparency_expands_to_rgba)
+{
+    auto image = load_fixture("palette_trns.png");
+    ASSERT_EQ(imaging::format::r8g8b8a8_uint, imaging::pixel_format(image));
+
+    for (auto y = 0; y < fixture_height; ++y)
+    {
+        for (auto x = 0; x < fixture_width; ++x)
+        {
+            const auto i = fixture_palette_index(x, y);
+            ASSERT_EQ((imaging::rgba32{static_cast<std::uint8_t>(i * 16), static_cast<std::uint8_t>(255 - i * 16),
+                                       static_cast<std::uint8_t>(i * 5), static_cast<std::uint8_t>(i * 17)}),
+                      *math::at<imaging::rgba32>(image, x, y));
+        }
+    }
+}
+
+TEST(test_imaging, test_load_png_low_bit_depth_grey_expands_to_8_bit)
+{
+    auto image = load_fixture("grey_2bit.png");
+    ASSERT_EQ(imaging::format::r8_uint, imaging::pixel_format(image));
+
+    for (auto y = 0; y < fixture_height; ++y)
+    {
+        for (auto x = 0; x < fixture_width; ++x)
+            ASSERT_EQ(((x + y) % 4) * 85, *math::at<std::uint8_t>(image, x, y));
+    }
+}
+
+TEST(test_imaging, test_load_png_grey_alpha)
+{
+    auto image = load_fixture("grey_alpha.png");
+    ASSERT_EQ(imaging::format::r8g8_uint, imaging::pixel_format(image));
+
+    for (auto y = 0; y < fixture_height; ++y)
+    {
+        for (auto x = 0; x < fixture_width; ++x)
+        {
+            const auto *const pixel = math::at<std::uint8_t>(image, x, y);
+            ASSERT_EQ((x * 19 + y * 7) & 255, pixel[0]);
+            ASSERT_EQ((x * y * 3) & 255, pixel[1]);
+        }
+    }
+}
+
+TEST(test_imaging, test_load_png_16_bit_keeps_the_high_byte)
+{
+    auto rgb = load_fixture("rgb_16bit.png");
+    ASSERT_EQ(imaging::format::r8g8b8_uint, imaging::pixel_format(rgb));
+
+    auto rgba = load_fixture("rgba_16bit.png");
+    ASSERT_EQ(imaging::format::r8g8b8a8_uint, imaging::pixel_format(rgba));
+
+    for (auto y = 0; y < fixture_height; ++y)
+    {
+        for (auto x = 0; x < fixture_width; ++x)
+        {
+            const auto expected = fixture_rgba(x, y);
+            ASSERT_EQ((imaging::rgb24{expected.r, expected.g, expected.b}), *math::at<imaging::rgb24>(rgb, x, y));
+            ASSERT_EQ(expected, *math::at<imaging::rgba32>(rgba, x, y));
+        }
+    }
+}
+
+TEST(test_imaging, test_load_png_interlaced)
+{
+    auto image = load_fixture("interlaced_rgba.png");
+    ASSERT_EQ(imaging::format::r8g8b8a8_uint, imaging::pixel_format(image));
+
+    for (auto y = 0; y < fixture_height; ++y)
+    {
+        for (auto x = 0; x < fixture_width; ++x)
+            ASSERT_EQ(fixture_rgba(x, y), *math::at<imaging::rgba32>(image, x, y));
+    }
+
+    // Interlaced images are decoded through a temporary image before they are converted or handed out as rows.
+    auto stream = streams::make_dynamic_stream(
+        streams::file_source_device{AEON_IMAGING_UNITTEST_DATA_PATH "interlaced_rgba.png"});
+    imaging::file::png::decoder decoder{stream};
+
+    imaging::image converted{imaging::format::b8g8r8a8_uint, decoder.dimensions()};
+    decoder.decode(converted);
+
+    for (auto y = 0; y < fixture_height; ++y)
+    {
+        for (auto x = 0; x < fixture_width; ++x)
+        {
+            const auto expected = fixture_rgba(x, y);
+            ASSERT_EQ((imaging::bgra32{expected.b, expected.g, expected.r, expected.a}),
+                      *math::at<imaging::bgra32>(converted, x, y));
+        }
+    }
+}
+
+TEST(test_imaging, test_load_truncated_png_throws)
+{
+    const auto data = read_file(AEON_IMAGING_UNITTEST_DATA_PATH "felix.png");
+
+    // Cut inside the signature, the header, the image data and right before the end chunk.
+    for (const auto size : {std::size_t{4}, std::size_t{20}, std::size(data) / 2, std::size(data) - 12})
+    {
+        std::stringstream truncated{data.substr(0, size)};
+        auto stream = streams::make_dynamic_stream(streams::iostream_source_device{truncated});
+        EXPECT_THROW((void)imaging::file::png::load(stream), imaging::file::png::load_exception) << size;
+    }
+
+    // The header is intact, but most of the image data is missing when decoding.
+    std::stringstream truncated{data.substr(0, 3000)};
+    auto stream = streams::make_dynamic_stream(streams::iostream_source_device{truncated});
+    imaging::file::png::decoder decoder{stream};
+    imaging::image image{decoder.pixel_format(), decoder.dimensions()};
+    EXPECT_THROW(decoder.decode(image), imaging::file::png::load_exception);
+}
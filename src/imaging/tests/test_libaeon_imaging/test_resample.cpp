@@ -0,0 +1,221 @@
+// Distributed under the BSD 2-Clause License - Copyright 2012-2023 Robin Degen
+
+#include <aeon/imaging/filters/resample.h>
+#include <aeon/imaging/pixel_encoding.h>
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <array>
+#include <span>
+#include <cstdint>
+
+using namespace aeon;
+
+namespace
+{
+
+constexpr std::array filters{imaging::filters::resample_filter::box, imaging::filters::resample_filter::bilinear,
+                             imaging::filters::resample_filter::bicubic, imaging::filters::resample_filter::lanczos3};
+
+// Sizes that are not a multiple of the SIMD widths, so that the remainders are tested too.
+constexpr std::array<math::size2d<imaging::image::dimensions_type>, 3> sizes{{{101, 59}, {13, 7}, {37, 80}}};
+
+[[nodiscard]] auto bytes(imaging::image &image) -> std::span<std::byte>
+{
+    return {std::data(image), math::stride(image) * static_cast<std::size_t>(math::height(image))};
+}
+
+[[nodiscard]] auto make_noise_image(const imaging::format format, const int width, const int height) -> imaging::image
+{
+    imaging::image image{format, width, height};
+
+    std::uint32_t state = 12345;
+    for (auto &value : bytes(image))
+    {
+        state = state * 1664525u + 1013904223u;
+        value = static_cast<std::byte>(state >> 24);
+    }
+
+    return image;
+}
+
+} // namespace
+
+TEST(test_resample, constant_image_stays_constant)
+{
+    imaging::image image{imaging::format::r8g8b8a8_uint, 37, 23};
+    math::fill(image, imaging::rgba32{10, 128, 200, 255});
+
+    for (const auto filter : filters)
+    {
+        for (const auto size : sizes)
+        {
+            const auto result = imaging::filters::resample(image, size, filter);
+            ASSERT_EQ(size, math::dimensions(result));
+
+            for (auto y = 0; y < math::height(result); ++y)
+            {
+                for (auto x = 0; x < math::width(result); ++x)
+                {
+                    const auto pixel = *math::at<imaging::rgba32>(result, x, y);
+                    ASSERT_EQ(10, pixel.r);
+                    ASSERT_EQ(128, pixel.g);
+                    ASSERT_EQ(200, pixel.b);
+                    ASSERT_EQ(255, pixel.a);
+                }
+            }
+        }
+    }
+}
+
+TEST(test_resample, constant_float_image_stays_constant)
+{
+    imaging::image image{imaging::format::r32_float, 37, 23};
+    math::fill(image, 0.25f);
+
+    for (const auto filter : filters)
+    {
+        for (const auto size : sizes)
+        {
+            const auto result = imaging::filters::resample(image, size, filter);
+
+            for (auto y = 0; y < math::height(result); ++y)
+            {
+                for (auto x = 0; x < math::width(result); ++x)
+                    ASSERT_NEAR(0.25f, *math::at<float>(result, x, y), 1e-5f);
+            }
+        }
+    }
+}
+
+TEST(test_resample, components_are_resampled_independently)
+{
+    // The 4 component kernels must give the same result as resampling each component as a separate image.
+    const auto image = make_noise_image(imaging::format::r8g8b8a8_uint, 67, 41);
+
+    for (const auto filter : filters)
+    {
+        for (const auto size : sizes)
+        {
+            const auto result = imaging::filters::resample(image, size, filter, 4);
+
+            for (auto c = 0; c < 4; ++c)
+            {
+                imaging::image component{imaging::format::r8_uint, math::width(image), math::height(image)};
+
+                for (auto y = 0; y < math::height(image); ++y)
+                {
+                    for (auto x = 0; x < math::width(image); ++x)
+                        *math::at<std::uint8_t>(component, x, y) = math::at<std::uint8_t>(image, x, y)[c];
+                }
+
+                const auto component_result = imaging::filters::resample(component, size, filter, 1);
+
+                for (auto y = 0; y < math::height(result); ++y)
+                {
+                    for (auto x = 0; x < math::width(result); ++x)
+                    {
+                        ASSERT_EQ(*math::at<std::uint8_t>(component_result, x, y),
+                                  math::at<std::uint8_t>(result, x, y)[c]);
+                    }
+                }
+            }
+        }
+    }
+}
+
+TEST(test_resample, float_components_are_resampled_independently)
+{
+    imaging::image image{imaging::format::r32g32b32a32_float, 29, 31};
+
+    for (auto y = 0; y < math::height(image); ++y)
+    {
+        for (auto x = 0; x < math::width(image); ++x)
+        {
+            auto *const pixel = math::at<float>(image, x, y);
+            for (auto c = 0; c < 4; ++c)
+                pixel[c] = static_cast<float>((x * 7 + y * 13 + c * 17) % 31) / 31.0f;
+        }
+    }
+
+    for (const auto filter : filters)
+    {
+        const auto result = imaging::filters::resample(image, {50, 17}, filter);
+
+        for (auto c = 0; c < 4; ++c)
+        {
+            imaging::image component{imaging::format::r32_float, math::width(image), math::height(image)};
+
+            for (auto y = 0; y < math::height(image); ++y)
+            {
+                for (auto x = 0; x < math::width(image); ++x)
+                    *math::at<float>(component, x, y) = math::at<float>(image, x, y)[c];
+            }
+
+            const auto component_result = imaging::filters::resample(component, {50, 17}, filter);
+
+            for (auto y = 0; y < math::height(result); ++y)
+            {
+                for (auto x = 0; x < math::width(result); ++x)
+                    ASSERT_FLOAT_EQ(*math::at<float>(component_result, x, y), math::at<float>(result, x, y)[c]);
+            }
+        }
+    }
+}
+
+TEST(test_resample, threads_give_the_same_result)
+{
+    const auto image = make_noise_image(imaging::format::r8g8b8_uint, 640, 480);
+
+    for (const auto filter : filters)
+    {
+        auto single = imaging::filters::resample(image, {333, 1001}, filter, 1);
+        auto multiple = imaging::filters::resample(image, {333, 1001}, filter, 8);
+        EXPECT_TRUE(std::ranges::equal(bytes(single), bytes(multiple)));
+    }
+}
+
+TEST(test_resample, box_downscale_averages)
+{
+    imaging::image image{imaging::format::r8_uint, 4, 2};
+
+    const std::array<std::uint8_t, 8> values{10, 20, 30, 50, 30, 40, 70, 90};
+    for (auto i = 0; i < 8; ++i)
+        *math::at<std::uint8_t>(image, i % 4, i / 4) = values[i];
+
+    const auto result = imaging::filters::resample(image, {2, 1}, imaging::filters::resample_filter::box);
+    EXPECT_NEAR(25, *math::at<std::uint8_t>(result, 0, 0), 1);
+    EXPECT_NEAR(60, *math::at<std::uint8_t>(result, 1, 0), 1);
+}
+
+TEST(test_resample, resample_into_view)
+{
+    const auto image = make_noise_image(imaging::format::r8g8b8a8_uint, 64, 64);
+
+    imaging::image atlas{imaging::format::r8g8b8a8_uint, 128, 128};
+    math::fill(atlas, imaging::rgba32{1, 2, 3, 4});
+
+    auto region = imaging::make_view(atlas, {10, 20, 10 + 48, 20 + 40});
+    imaging::filters::resample(image, region, imaging::filters::resample_filter::lanczos3);
+
+    const auto expected = imaging::filters::resample(image, {48, 40}, imaging::filters::resample_filter::lanczos3);
+
+    for (auto y = 0; y < math::height(atlas); ++y)
+    {
+        for (auto x = 0; x < math::width(atlas); ++x)
+        {
+            const auto pixel = *math::at<std::uint32_t>(atlas, x, y);
+            const auto inside = x >= 10 && x < 58 && y >= 20 && y < 60;
+
+            if (inside)
+                ASSERT_EQ(*math::at<std::uint32_t>(expected, x - 10, y - 20), pixel);
+            else
+                ASSERT_EQ(*math::at<std::uint32_t>(atlas, 0, 0), pixel);
+        }
+    }
+}
+
+TEST(test_resample, unsupported_format)
+{
+    const imaging::image image{imaging::format::r32g32b32a32_uint, 16, 16};
+    EXPECT_THROW([[maybe_unused]] const auto result = imaging::filters::resample(image, {8, 8}), std::runtime_error);
+}
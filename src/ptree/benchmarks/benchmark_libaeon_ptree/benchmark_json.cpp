@@ -0,0 +1,226 @@
+// Distributed under the BSD 2-Clause License - Copyright 2012-2023 Robin Degen
+
+#include <benchmark/benchmark.h>
+
+#include <aeon/ptree/ptree.h>
+#include <aeon/ptree/serialization/serialization_json.h>
+#include <aeon/unicode/stringutils.h>
+#include <aeon/streams/devices/memory_view_device.h>
+#include <aeon/streams/dynamic_stream.h>
+#include <aeon/streams/stream_writer.h>
+#include <string>
+
+using namespace aeon;
+
+namespace
+{
+
+[[nodiscard]] auto generate_document(const int count) -> ptree::property_tree
+{
+    ptree::array items;
+
+    for (auto i = 0; i < count; ++i)
+    {
+        items.push_back(ptree::object{
+            {"id", i},
+            {"name", common::string{"Item number " + std::to_string(i)}},
+            {"description", "A somewhat longer description of an item that contains a \"quote\" and a\nnewline."},
+            {"price", i * 1.37},
+            {"ratio", 1.0 / (i + 1)},
+            {"enabled", i % 2 == 0},
+            {"tags", ptree::array{"first", "second", "third"}},
+            {"parent", nullptr}});
+    }
+
+    return ptree::object{{"items", std::move(items)}};
+}
+
+// The original serializer that creates a stream writer for every value, formats numbers through std::to_string and
+// escapes strings into a temporary copy. Kept here as a reference.
+namespace reference
+{
+
+void to_json(const ptree::property_tree &pt, streams::idynamic_stream &stream);
+
+void to_json(const std::monostate, streams::idynamic_stream &stream)
+{
+    streams::stream_writer writer{stream};
+    writer << "null";
+}
+
+void to_json(const common::string &str, streams::idynamic_stream &stream)
+{
+    streams::stream_writer writer{stream};
+    writer << '"';
+    writer << unicode::stringutils::escape(str);
+    writer << '"';
+}
+
+void to_json(const ptree::array &arr, streams::idynamic_stream &stream)
+{
+    streams::stream_writer writer{stream};
+    writer << '[';
+
+    bool first = true;
+
+    for (const auto &pt : arr)
+    {
+        if (first)
+            first = false;
+        else
+            writer << ',';
+
+        to_json(pt, stream);
+    }
+
+    writer << ']';
+}
+
+void to_json(const ptree::object &obj, streams::idynamic_stream &stream)
+{
+    streams::stream_writer writer{stream};
+    writer << '{';
+
+    bool first = true;
+
+    for (const auto &[key, val] : obj)
+    {
+        if (first)
+            first = false;
+        else
+            writer << ',';
+
+        to_json(key, stream);
+        writer << ':';
+        to_json(val, stream);
+    }
+
+    writer << '}';
+}
+
+void to_json(const common::uuid &uuid, streams::idynamic_stream &stream)
+{
+    to_json(uuid.str(), stream);
+}
+
+void to_json(const std::int64_t val, streams::idynamic_stream &stream)
+{
+    streams::stream_writer writer{stream};
+    writer << std::to_string(val);
+}
+
+void to_json(const double val, streams::idynamic_stream &stream)
+{
+    streams::stream_writer writer{stream};
+    writer << std::to_string(val);
+}
+
+void to_json(const bool val, streams::idynamic_stream &stream)
+{
+    streams::stream_writer writer{stream};
+    writer << (val ? "true" : "false");
+}
+
+void to_json(const ptree::blob &, streams::idynamic_stream &)
+{
+}
+
+void to_json(const ptree::property_tree &pt, streams::idynamic_stream &stream)
+{
+    std::visit([&stream](auto &&arg) { to_json(arg, stream); }, pt.value());
+}
+
+} // namespace reference
+
+} // namespace
+
+static void benchmark_json_serialize_reference(benchmark::State &state)
+{
+    const auto pt = generate_document(static_cast<int>(state.range(0)));
+    std::int64_t bytes = 0;
+
+    for ([[maybe_unused]] auto _ : state)
+    {
+        common::string str;
+        auto stream = streams::make_dynamic_stream(streams::memory_view_device{str});
+        reference::to_json(pt, stream);
+        bytes += static_cast<std::int64_t>(std::size(str));
+        benchmark::DoNotOptimize(str);
+    }
+
+    state.SetBytesProcessed(bytes);
+}
+
+BENCHMARK(benchmark_json_serialize_reference)->Arg(10)->Arg(1000)->Arg(10000);
+
+static void benchmark_json_serialize(benchmark::State &state)
+{
+    const auto pt = generate_document(static_cast<int>(state.range(0)));
+    std::int64_t bytes = 0;
+
+    for ([[maybe_unused]] auto _ : state)
+    {
+        const auto str = ptree::serialization::to_json(pt);
+        bytes += static_cast<std::int64_t>(std::size(str));
+        benchmark::DoNotOptimize(str);
+    }
+
+    state.SetBytesProcessed(bytes);
+}
+
+BENCHMARK(benchmark_json_serialize)->Arg(10)->Arg(1000)->Arg(10000);
+
+static void benchmark_json_serialize_reuse_buffer(benchmark::State &state)
+{
+    const auto pt = generate_document(static_cast<int>(state.range(0)));
+    common::string buffer;
+    std::int64_t bytes = 0;
+
+    for ([[maybe_unused]] auto _ : state)
+    {
+        buffer.clear();
+        ptree::serialization::to_json(pt, buffer);
+        bytes += static_cast<std::int64_t>(std::size(buffer));
+        benchmark::DoNotOptimize(buffer);
+    }
+
+    state.SetBytesProcessed(bytes);
+}
+
+BENCHMARK(benchmark_json_serialize_reuse_buffer)->Arg(10)->Arg(1000)->Arg(10000);
+
+static void benchmark_json_serialize_pretty(benchmark::State &state)
+{
+    const auto pt = generate_document(static_cast<int>(state.range(0)));
+    std::int64_t bytes = 0;
+
+    for ([[maybe_unused]] auto _ : state)
+    {
+        const auto str = ptree::serialization::to_json(pt, ptree::serialization::json_serialize_mode::pretty);
+        bytes += static_cast<std::int64_t>(std::size(str));
+        benchmark::DoNotOptimize(str);
+    }
+
+    state.SetBytesProcessed(bytes);
+}
+
+BENCHMARK(benchmark_json_serialize_pretty)->Arg(10)->Arg(1000)->Arg(10000);
+
+static void benchmark_json_serialize_stream(benchmark::State &state)
+{
+    const auto pt = generate_document(static_cast<int>(state.range(0)));
+    std::int64_t bytes = 0;
+
+    for ([[maybe_unused]] auto _ : state)
+    {
+        common::string str;
+        auto stream = streams::make_dynamic_stream(streams::memory_view_device{str});
+        ptree::serialization::to_json(pt, stream);
+        bytes += static_cast<std::int64_t>(std::size(str));
+        benchmark::DoNotOptimize(str);
+    }
+
+    state.SetBytesProcessed(bytes);
+}
+
+BENCHMARK(benchmark_json_serialize_stream)->Arg(10)->Arg(1000)->Arg(10000);
@@ -22,8 +22,7 @@ namespace aeon::ptree
 
     for (const auto &field : field_info)
     {
-        const auto field_name_str = field.name();
-        const auto result = pt_object.find(common::string{field_name_str});
+        const auto result = pt_object.find(field.name());
 
         if (result == std::end(pt_object))
             continue;
@@ -68,7 +67,7 @@ namespace aeon::ptree
             if (!result->second.is_string())
                 throw ptree_exception{};
 
-            field.set(*obj, result->second.string_value());
+            field.set(*obj, common::string{result->second.string_value()});
         }
         else if (field.type() == "aeon::common::uuid")
         {
@@ -82,7 +81,8 @@ namespace aeon::ptree
             if (!result->second.is_blob())
                 throw ptree_exception{};
 
-            field.set(*obj, result->second.blob_value());
+            const auto &data = result->second.blob_value();
+            field.set(*obj, std::vector<std::uint8_t>{std::begin(data), std::end(data)});
         }
         else
             throw ptree_exception{};
@@ -100,7 +100,7 @@ auto from_reflection_object(const reflection::reflection_object &obj,
 
     for (const auto &field : field_info)
     {
-        const auto field_name = common::string{field.name()};
+        const auto field_name = string{field.name().as_std_string_view()};
 
         if (field.type() == "std::int64_t")
         {
@@ -132,7 +132,8 @@ auto from_reflection_object(const reflection::reflection_object &obj,
         }
         else if (field.type() == "std::vector<std::uint8_t>")
         {
-            pt_obj.insert(field_name, field.get<std::vector<std::uint8_t>>(obj));
+            const auto &data = field.get<std::vector<std::uint8_t>>(obj);
+            pt_obj.insert(field_name, blob{std::begin(data), std::end(data)});
         }
         else
             throw ptree_exception{};
@@ -0,0 +1,46 @@
+// Distributed under the BSD 2-Clause License - Copyright 2012-2023 Robin Degen
+
+#pragma once
+
+#include <aeon/common/fourcc.h>
+#include <cstdint>
+#include <cstddef>
+
+namespace aeon::ptree::serialization::internal
+{
+
+static constexpr std::uint32_t header_magic = common::fourcc('A', 'B', 'F', '1');
+static constexpr std::uint32_t header_magic_v2 = common::fourcc('A', 'B', 'F', '2');
+
+static constexpr std::uint8_t chunk_type_null = 0x00;
+static constexpr std::uint8_t chunk_type_array = 0x01;
+static constexpr std::uint8_t chunk_type_object = 0x02;
+static constexpr std::uint8_t chunk_type_string = 0x03;
+static constexpr std::uint8_t chunk_type_integer = 0x04;
+static constexpr std::uint8_t chunk_type_double = 0x05;
+static constexpr std::uint8_t chunk_type_bool = 0x06;
+static constexpr std::uint8_t chunk_type_uuid = 0x07;
+static constexpr std::uint8_t chunk_type_blob = 0x08;
+
+/*
+ * ABF2 layout. All values are stored in native (little) endian. All offsets are absolute (from the start of the
+ * header) and every node starts at an 8 byte aligned offset, so that scalars can be read in place.
+ *
+ * header:  u32 magic ('ABF2'), u32 reserved, u64 offset of the root node
+ * node:    u8 type, u8 bool value, u8[6] reserved, followed by the payload of the type:
+ *   null, bool:      (none)
+ *   integer, double: 8 byte value
+ *   uuid:            16 bytes
+ *   string, blob:    u64 size, data, padding
+ *   array:           u64 count, u64 node offset[count]
+ *   object:          u64 count, {u64 key offset, u64 node offset}[count] in insertion order,
+ *                    u32 entry index[count] sorted by key, padding
+ * key:     u64 size, data, padding
+ */
+static constexpr std::size_t abf2_alignment = 8;
+static constexpr std::size_t abf2_header_size = 16;
+static constexpr std::size_t abf2_root_offset_position = 8;
+static constexpr std::size_t abf2_node_header_size = 8;
+static constexpr std::size_t abf2_bool_value_position = 1;
+
+} // namespace aeon::ptree::serialization::internal
@@ -0,0 +1,398 @@
+// Distributed under the BSD 2-Clause License - Copyright 2012-2023 Robin Degen
+
+#include <aeon/ptree/serialization/abf_view.h>
+#include <aeon/ptree/serialization/exception.h>
+#include "abf_format.h"
+#include <stdexcept>
+#include <cstring>
+
+namespace aeon::ptree::serialization
+{
+
+namespace internal
+{
+
+/*!
+ * Read a value from the given offset. All reads are bounds checked, since the data may come from an untrusted source.
+ */
+template <typename T>
+[[nodiscard]] static auto read_at(const std::span<const std::byte> data, const std::size_t offset) -> T
+{
+    if (offset > std::size(data) || std::size(data) - offset < sizeof(T))
+        throw ptree_serialization_exception{};
+
+    T value;
+    std::memcpy(&value, std::data(data) + offset, sizeof(T));
+    return value;
+}
+
+/*!
+ * Get a bounds checked view on size bytes at the given offset.
+ */
+[[nodiscard]] static auto read_span(const std::span<const std::byte> data, const std::size_t offset,
+                                    const std::uint64_t size) -> std::span<const std::byte>
+{
+    if (offset > std::size(data) || std::size(data) - offset < size)
+        throw ptree_serialization_exception{};
+
+    return data.subspan(offset, static_cast<std::size_t>(size));
+}
+
+/*!
+ * Read the element count of a container and make sure that a table of count elements of the given size fits in the
+ * data, so that further offset calculations can not overflow.
+ */
+[[nodiscard]] static auto read_count(const std::span<const std::byte> data, const std::size_t offset,
+                                     const std::size_t element_size) -> std::size_t
+{
+    const auto count = read_at<std::uint64_t>(data, offset);
+
+    if (count > (std::size(data) - offset) / element_size)
+        throw ptree_serialization_exception{};
+
+    return static_cast<std::size_t>(count);
+}
+
+[[nodiscard]] static auto to_string_view(const std::span<const std::byte> data) noexcept -> common::string_view
+{
+    return common::string_view{reinterpret_cast<const char *>(std::data(data)), std::size(data)};
+}
+
+} // namespace internal
+
+abf_value_view::abf_value_view(const std::span<const std::byte> data, const std::size_t offset)
+    : data_{data}
+    , offset_{offset}
+{
+    if (offset % internal::abf2_alignment != 0 || offset > std::size(data) ||
+        std::size(data) - offset < internal::abf2_node_header_size)
+        throw ptree_serialization_exception{};
+}
+
+auto abf_value_view::is_null() const noexcept -> bool
+{
+    return type() == internal::chunk_type_null;
+}
+
+auto abf_value_view::is_array() const noexcept -> bool
+{
+    return type() == internal::chunk_type_array;
+}
+
+auto abf_value_view::is_object() const noexcept -> bool
+{
+    return type() == internal::chunk_type_object;
+}
+
+auto abf_value_view::is_string() const noexcept -> bool
+{
+    return type() == internal::chunk_type_string;
+}
+
+auto abf_value_view::is_uuid() const noexcept -> bool
+{
+    return type() == internal::chunk_type_uuid;
+}
+
+auto abf_value_view::is_integer() const noexcept -> bool
+{
+    return type() == internal::chunk_type_integer;
+}
+
+auto abf_value_view::is_double() const noexcept -> bool
+{
+    return type() == internal::chunk_type_double;
+}
+
+auto abf_value_view::is_bool() const noexcept -> bool
+{
+    return type() == internal::chunk_type_bool;
+}
+
+auto abf_value_view::is_blob() const noexcept -> bool
+{
+    return type() == internal::chunk_type_blob;
+}
+
+auto abf_value_view::string_value() const -> common::string_view
+{
+    const auto payload = checked_type(internal::chunk_type_string);
+    const auto size = internal::read_at<std::uint64_t>(data_, payload);
+    return internal::to_string_view(internal::read_span(data_, payload + sizeof(std::uint64_t), size));
+}
+
+auto abf_value_view::uuid_value() const -> common::uuid
+{
+    const auto payload = checked_type(internal::chunk_type_uuid);
+    return common::uuid{internal::read_at<common::uuid::data_type>(data_, payload)};
+}
+
+auto abf_value_view::integer_value() const -> std::int64_t
+{
+    return internal::read_at<std::int64_t>(data_, checked_type(internal::chunk_type_integer));
+}
+
+auto abf_value_view::double_value() const -> double
+{
+    return internal::read_at<double>(data_, checked_type(internal::chunk_type_double));
+}
+
+auto abf_value_view::bool_value() const -> bool
+{
+    [[maybe_unused]] const auto payload = checked_type(internal::chunk_type_bool);
+    return internal::read_at<std::uint8_t>(data_, offset_ + internal::abf2_bool_value_position) != 0;
+}
+
+auto abf_value_view::blob_value() const -> std::span<const std::uint8_t>
+{
+    const auto payload = checked_type(internal::chunk_type_blob);
+    const auto size = internal::read_at<std::uint64_t>(data_, payload);
+    const auto data = internal::read_span(data_, payload + sizeof(std::uint64_t), size);
+    return std::span<const std::uint8_t>{reinterpret_cast<const std::uint8_t *>(std::data(data)), std::size(data)};
+}
+
+auto abf_value_view::size() const -> std::size_t
+{
+    if (is_array())
+        return internal::read_count(data_, offset_ + internal::abf2_node_header_size, sizeof(std::uint64_t));
+
+    if (is_object())
+        return internal::read_count(data_, offset_ + internal::abf2_node_header_size, sizeof(std::uint64_t) * 2);
+
+    throw ptree_serialization_exception{};
+}
+
+auto abf_value_view::at(const std::size_t index) const -> abf_value_view
+{
+    const auto payload = checked_type(internal::chunk_type_array);
+    const auto count = internal::read_count(data_, payload, sizeof(std::uint64_t));
+
+    if (index >= count)
+        throw std::out_of_range{"abf array index out of range."};
+
+    const auto offset = internal::read_at<std::uint64_t>(data_, payload + (index + 1) * sizeof(std::uint64_t));
+
+    // Child nodes are always written after their parent. Enforcing this guarantees that malformed data can not cause
+    // endless recursion.
+    if (offset <= offset_)
+        throw ptree_serialization_exception{};
+
+    return abf_value_view{data_, static_cast<std::size_t>(offset)};
+}
+
+auto abf_value_view::operator[](const std::size_t index) const -> abf_value_view
+{
+    return at(index);
+}
+
+auto abf_value_view::at(const common::string_view &key) const -> abf_value_view
+{
+    const auto result = find(key);
+
+    if (!result)
+        throw std::out_of_range{"abf object key not found."};
+
+    return *result;
+}
+
+auto abf_value_view::find(const common::string_view &key) const -> std::optional<abf_value_view>
+{
+    const auto payload = checked_type(internal::chunk_type_object);
+    const auto count = internal::read_count(data_, payload, sizeof(std::uint64_t) * 2);
+    const auto entries = payload + sizeof(std::uint64_t);
+    const auto sorted = entries + count * sizeof(std::uint64_t) * 2;
+    const auto search_key = key.as_std_string_view();
+
+    std::size_t first = 0;
+    std::size_t last = count;
+
+    while (first < last)
+    {
+        const auto middle = first + (last - first) / 2;
+        const auto index = internal::read_at<std::uint32_t>(data_, sorted + middle * sizeof(std::uint32_t));
+
+        if (index >= count)
+            throw ptree_serialization_exception{};
+
+        const auto result = entry_key(entries, index).as_std_string_view().compare(search_key);
+
+        if (result == 0)
+            return value_at(index);
+
+        if (result < 0)
+            first = middle + 1;
+        else
+            last = middle;
+    }
+
+    return std::nullopt;
+}
+
+auto abf_value_view::contains(const common::string_view &key) const -> bool
+{
+    return find(key).has_value();
+}
+
+auto abf_value_view::key_at(const std::size_t index) const -> common::string_view
+{
+    const auto payload = checked_type(internal::chunk_type_object);
+
+    if (index >= internal::read_count(data_, payload, sizeof(std::uint64_t) * 2))
+        throw std::out_of_range{"abf object index out of range."};
+
+    return entry_key(payload + sizeof(std::uint64_t), index);
+}
+
+auto abf_value_view::value_at(const std::size_t index) const -> abf_value_view
+{
+    const auto payload = checked_type(internal::chunk_type_object);
+
+    if (index >= internal::read_count(data_, payload, sizeof(std::uint64_t) * 2))
+        throw std::out_of_range{"abf object index out of range."};
+
+    const auto entry = payload + sizeof(std::uint64_t) + index * sizeof(std::uint64_t) * 2;
+    const auto offset = internal::read_at<std::uint64_t>(data_, entry + sizeof(std::uint64_t));
+
+    if (offset <= offset_)
+        throw ptree_serialization_exception{};
+
+    return abf_value_view{data_, static_cast<std::size_t>(offset)};
+}
+
+auto abf_value_view::to_property_tree(const abf_deserialize_mode mode, std::pmr::memory_resource *resource) const
+    -> property_tree
+{
+    auto previous_offset = offset_;
+    return to_property_tree(mode, resource, previous_offset);
+}
+
+auto abf_value_view::to_property_tree(const abf_deserialize_mode mode, std::pmr::memory_resource *resource,
+                                      std::size_t &previous_offset) const -> property_tree
+{
+    switch (type())
+    {
+        case internal::chunk_type_null:
+            return nullptr;
+        case internal::chunk_type_array:
+        {
+            const auto count = size();
+            array data(resource);
+            data.reserve(count);
+
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                data.push_back(at(i).to_child_property_tree(mode, resource, previous_offset));
+            }
+
+            return data;
+        }
+        case internal::chunk_type_object:
+        {
+            const auto count = size();
+            object data(resource);
+            data.reserve(count);
+
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                data.emplace(string{key_at(i).as_std_string_view(), resource},
+                             value_at(i).to_child_property_tree(mode, resource, previous_offset));
+            }
+
+            return data;
+        }
+        case internal::chunk_type_string:
+            return string{string_value().as_std_string_view(), resource};
+        case internal::chunk_type_integer:
+            return integer_value();
+        case internal::chunk_type_double:
+            return double_value();
+        case internal::chunk_type_bool:
+            return bool_value();
+        case internal::chunk_type_uuid:
+            return uuid_value();
+        case internal::chunk_type_blob:
+        {
+            if (mode == abf_deserialize_mode::skip_blobs)
+                return blob(resource);
+
+            const auto data = blob_value();
+            return blob{std::begin(data), std::end(data), resource};
+        }
+        default:
+            throw ptree_serialization_exception{};
+    }
+}
+
+auto abf_value_view::to_child_property_tree(const abf_deserialize_mode mode, std::pmr::memory_resource *resource,
+                                            std::size_t &previous_offset) const -> property_tree
+{
+    // Nodes are written depth first, so they are always visited in the order in which they are stored. Requiring this
+    // guarantees that every node is decoded only once; otherwise a small malformed file could reference the same
+    // nodes from multiple places and expand exponentially.
+    if (offset_ <= previous_offset)
+        throw ptree_serialization_exception{};
+
+    previous_offset = offset_;
+    return to_property_tree(mode, resource, previous_offset);
+}
+
+auto abf_value_view::type() const noexcept -> std::uint8_t
+{
+    return static_cast<std::uint8_t>(data_[offset_]);
+}
+
+auto abf_value_view::checked_type(const std::uint8_t expected) const -> std::size_t
+{
+    if (type() != expected)
+        throw ptree_serialization_exception{};
+
+    return offset_ + internal::abf2_node_header_size;
+}
+
+auto abf_value_view::entry_key(const std::size_t entries_offset, const std::size_t index) const
+    -> common::string_view
+{
+    const auto key_offset =
+        internal::read_at<std::uint64_t>(data_, entries_offset + index * sizeof(std::uint64_t) * 2);
+
+    if (key_offset > std::size(data_))
+        throw ptree_serialization_exception{};
+
+    const auto size = internal::read_at<std::uint64_t>(data_, static_cast<std::size_t>(key_offset));
+    return internal::to_string_view(
+        internal::read_span(data_, static_cast<std::size_t>(key_offset) + sizeof(std::uint64_t), size));
+}
+
+abf_view::abf_view(const std::span<const std::byte> data)
+    : data_{data}
+{
+    if (!is_abf2(data))
+        throw ptree_serialization_exception{};
+}
+
+abf_view::abf_view(const std::span<const std::uint8_t> data)
+    : abf_view{std::as_bytes(data)}
+{
+}
+
+auto abf_view::is_abf2(const std::span<const std::byte> data) noexcept -> bool
+{
+    if (std::size(data) < internal::abf2_header_size)
+        return false;
+
+    std::uint32_t magic = 0;
+    std::memcpy(&magic, std::data(data), sizeof(magic));
+    return magic == internal::header_magic_v2;
+}
+
+auto abf_view::root() const -> abf_value_view
+{
+    const auto offset = internal::read_at<std::uint64_t>(data_, internal::abf2_root_offset_position);
+
+    if (offset < internal::abf2_header_size)
+        throw ptree_serialization_exception{};
+
+    return abf_value_view{data_, static_cast<std::size_t>(offset)};
+}
+
+} // namespace aeon::ptree::serialization
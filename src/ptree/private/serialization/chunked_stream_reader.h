@@ -0,0 +1,176 @@
+// Distributed under the BSD 2-Clause License - Copyright 2012-2023 Robin Degen
+
+#pragma once
+
+#include <aeon/ptree/serialization/exception.h>
+#include <aeon/streams/idynamic_stream.h>
+#include <aeon/common/string.h>
+#include <vector>
+#include <cstddef>
+
+namespace aeon::ptree::serialization::internal
+{
+
+/*!
+ * Reads an input stream in fixed size chunks and hands it out byte by byte or as runs of bytes. Only a single chunk
+ * is held in memory at any time. Tokens that are split across chunk boundaries are handled transparently by the
+ * run functions, which continue in the next chunk as required.
+ */
+class chunked_stream_reader final
+{
+public:
+    static constexpr int eof_value = -1;
+
+    explicit chunked_stream_reader(streams::idynamic_stream &stream, const std::size_t chunk_size)
+        : stream_{&stream}
+        , buffer_(chunk_size != 0 ? chunk_size : 1)
+        , position_{0}
+        , size_{0}
+        , offset_{0}
+        , eof_{false}
+    {
+    }
+
+    ~chunked_stream_reader() = default;
+
+    chunked_stream_reader(const chunked_stream_reader &) = delete;
+    auto operator=(const chunked_stream_reader &) -> chunked_stream_reader & = delete;
+
+    chunked_stream_reader(chunked_stream_reader &&) noexcept = delete;
+    auto operator=(chunked_stream_reader &&) noexcept -> chunked_stream_reader & = delete;
+
+    /*!
+     * Returns true if all data from the underlying stream was consumed.
+     */
+    [[nodiscard]] auto eof() -> bool
+    {
+        return !ensure_data();
+    }
+
+    /*!
+     * Returns the next byte without consuming it, or eof_value if the end of the stream was reached.
+     */
+    [[nodiscard]] auto peek() -> int
+    {
+        if (!ensure_data())
+            return eof_value;
+
+        return static_cast<unsigned char>(buffer_[position_]);
+    }
+
+    /*!
+     * Returns and consumes the next byte, or eof_value if the end of the stream was reached.
+     */
+    auto get() -> int
+    {
+        if (!ensure_data())
+            return eof_value;
+
+        ++offset_;
+        return static_cast<unsigned char>(buffer_[position_++]);
+    }
+
+    /*!
+     * Consume the next byte. Throws if the end of the stream was reached.
+     */
+    auto get_checked() -> char
+    {
+        const auto c = get();
+
+        if (c == eof_value)
+            throw ptree_serialization_exception{};
+
+        return static_cast<char>(c);
+    }
+
+    /*!
+     * Consume the next byte if it equals the given character.
+     */
+    [[nodiscard]] auto check(const char c) -> bool
+    {
+        if (peek() != static_cast<unsigned char>(c))
+            return false;
+
+        ++position_;
+        ++offset_;
+        return true;
+    }
+
+    /*!
+     * Consume bytes for as long as the given predicate returns true.
+     */
+    template <typename predicate_t>
+    void skip_while(predicate_t &&pred)
+    {
+        while (ensure_data())
+        {
+            const auto begin = position_;
+            while (position_ < size_ && pred(buffer_[position_]))
+                ++position_;
+
+            offset_ += position_ - begin;
+
+            if (position_ < size_)
+                return;
+        }
+    }
+
+    /*!
+     * Append bytes to the given string for as long as the given predicate returns true. Runs within a chunk are
+     * appended in bulk.
+     */
+    template <typename predicate_t>
+    void read_while(common::string &out, predicate_t &&pred)
+    {
+        while (ensure_data())
+        {
+            const auto begin = position_;
+            while (position_ < size_ && pred(buffer_[position_]))
+                ++position_;
+
+            out.append(std::data(buffer_) + begin, position_ - begin);
+            offset_ += position_ - begin;
+
+            if (position_ < size_)
+                return;
+        }
+    }
+
+    /*!
+     * The amount of bytes consumed so far. Used for error reporting.
+     */
+    [[nodiscard]] auto offset() const noexcept
+    {
+        return offset_;
+    }
+
+private:
+    [[nodiscard]] auto ensure_data() -> bool
+    {
+        if (position_ < size_)
+            return true;
+
+        if (eof_)
+            return false;
+
+        const auto result = stream_->read(reinterpret_cast<std::byte *>(std::data(buffer_)),
+                                          static_cast<std::streamsize>(std::size(buffer_)));
+
+        position_ = 0;
+        size_ = result > 0 ? static_cast<std::size_t>(result) : 0;
+
+        if (size_ == 0)
+            eof_ = true;
+
+        return size_ != 0;
+    }
+
+    streams::idynamic_stream *stream_;
+    std::vector<char> buffer_;
+    std::size_t position_;
+    std::size_t size_;
+    std::size_t offset_;
+    bool eof_;
+};
+
+} // namespace aeon::ptree::serialization::internal
@@ -0,0 +1,116 @@
+// Distributed under the BSD 2-Clause License - Copyright 2012-2023 Robin Degen
+
+#include <aeon/ptree/serialization/sax_handler.h>
+#include <aeon/common/assert.h>
+
+namespace aeon::ptree::serialization
+{
+
+property_tree_builder::property_tree_builder(std::pmr::memory_resource *resource)
+    : resource_{resource}
+    , stack_{}
+    , result_{}
+    , complete_{false}
+{
+}
+
+property_tree_builder::~property_tree_builder() = default;
+
+property_tree_builder::property_tree_builder(property_tree_builder &&) noexcept = default;
+
+auto property_tree_builder::operator=(property_tree_builder &&) noexcept -> property_tree_builder & = default;
+
+void property_tree_builder::on_start_object()
+{
+    stack_.push_back(frame{object(resource_), string(resource_)});
+}
+
+void property_tree_builder::on_end_object()
+{
+    aeon_assert(!std::empty(stack_) && stack_.back().value.is_object(), "Unexpected end of object.");
+    auto value = std::move(stack_.back().value);
+    stack_.pop_back();
+    add_value(std::move(value));
+}
+
+void property_tree_builder::on_start_array()
+{
+    stack_.push_back(frame{array(resource_), string(resource_)});
+}
+
+void property_tree_builder::on_end_array()
+{
+    aeon_assert(!std::empty(stack_) && stack_.back().value.is_array(), "Unexpected end of array.");
+    auto value = std::move(stack_.back().value);
+    stack_.pop_back();
+    add_value(std::move(value));
+}
+
+void property_tree_builder::on_key(const common::string_view &key)
+{
+    aeon_assert(!std::empty(stack_) && stack_.back().value.is_object(), "Key given outside of an object.");
+    stack_.back().key.assign(key.as_std_string_view());
+}
+
+void property_tree_builder::on_null()
+{
+    add_value(property_tree{});
+}
+
+void property_tree_builder::on_bool(const bool value)
+{
+    add_value(property_tree{value});
+}
+
+void property_tree_builder::on_integer(const std::int64_t value)
+{
+    add_value(property_tree{value});
+}
+
+void property_tree_builder::on_double(const double value)
+{
+    add_value(property_tree{value});
+}
+
+void property_tree_builder::on_string(const common::string_view &value)
+{
+    add_value(property_tree{string{value.as_std_string_view(), resource_}});
+}
+
+auto property_tree_builder::is_complete() const noexcept -> bool
+{
+    return complete_ && std::empty(stack_);
+}
+
+auto property_tree_builder::release() -> property_tree
+{
+    auto result = std::move(result_);
+    stack_.clear();
+    result_ = property_tree{};
+    complete_ = false;
+    return result;
+}
+
+void property_tree_builder::add_value(property_tree &&value)
+{
+    if (std::empty(stack_))
+    {
+        result_ = std::move(value);
+        complete_ = true;
+        return;
+    }
+
+    auto &parent = stack_.back();
+
+    if (parent.value.is_array())
+    {
+        parent.value.array_value().push_back(std::move(value));
+    }
+    else
+    {
+        parent.value.object_value().emplace(std::move(parent.key), std::move(value));
+        parent.key.clear();
+    }
+}
+
+} // namespace aeon::ptree::serialization
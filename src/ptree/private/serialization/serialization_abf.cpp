@@ -1,14 +1,19 @@
 // Distributed under the BSD 2-Clause License - Copyright 2012-2023 Robin Degen
 
 #include <aeon/ptree/serialization/serialization_abf.h>
+#include <aeon/ptree/serialization/abf_view.h>
 #include <aeon/ptree/serialization/exception.h>
 #include <aeon/streams/devices/memory_view_device.h>
 #include <aeon/streams/dynamic_stream.h>
 #include <aeon/streams/stream_writer.h>
 #include <aeon/streams/stream_reader.h>
-#include <aeon/streams/length_prefix_string.h>
+#include <aeon/streams/varint.h>
+#include <aeon/streams/exception.h>
 #include <aeon/streams/uuid_stream.h>
-#include <aeon/common/fourcc.h>
+#include "abf_format.h"
+#include <algorithm>
+#include <numeric>
+#include <cstring>
 
 namespace aeon::ptree::serialization
 {
@@ -16,27 +21,29 @@ namespace aeon::ptree::serialization
 namespace internal
 {
 
-static constexpr std::uint32_t header_magic = common::fourcc('A', 'B', 'F', '1');
-static constexpr std::uint8_t chunk_type_null = 0x00;
-static constexpr std::uint8_t chunk_type_array = 0x01;
-static constexpr std::uint8_t chunk_type_object = 0x02;
-static constexpr std::uint8_t chunk_type_string = 0x03;
-static constexpr std::uint8_t chunk_type_integer = 0x04;
-static constexpr std::uint8_t chunk_type_double = 0x05;
-static constexpr std::uint8_t chunk_type_bool = 0x06;
-static constexpr std::uint8_t chunk_type_uuid = 0x07;
-static constexpr std::uint8_t chunk_type_blob = 0x08;
-
 static void to_abf(const std::monostate, streams::idynamic_stream &);
 static void to_abf(const array &arr, streams::idynamic_stream &stream);
 static void to_abf(const object &obj, streams::idynamic_stream &stream);
-static void to_abf(const common::string &obj_str, streams::idynamic_stream &stream);
+static void to_abf(const string &obj_str, streams::idynamic_stream &stream);
 static void to_abf(const common::uuid &uuid, streams::idynamic_stream &stream);
 static void to_abf(const std::int64_t val, streams::idynamic_stream &stream);
 static void to_abf(const double val, streams::idynamic_stream &stream);
 static void to_abf(const bool val, streams::idynamic_stream &stream);
 static void to_abf(const blob &val, streams::idynamic_stream &stream);
 
+/*!
+ * Write a string prefixed with its length as a varint. This is the same encoding as
+ * streams::length_prefix_string<streams::varint>, which only accepts a common::string.
+ */
+static void write_string(streams::stream_writer<streams::idynamic_stream> &writer, const string &str)
+{
+    writer << streams::varint{std::size(str)};
+
+    if (writer.device().write(reinterpret_cast<const std::byte *>(std::data(str)), std::size(str)) !=
+        static_cast<std::streamsize>(std::size(str)))
+        throw streams::stream_exception{};
+}
+
 static void write_header(streams::idynamic_stream &stream)
 {
     streams::stream_writer writer{stream};
@@ -76,16 +83,16 @@ static void to_abf(const object &obj, streams::idynamic_stream &stream)
 
     for (const auto &[key, val] : obj)
     {
-        writer << streams::length_prefix_string<streams::varint>{key};
+        write_string(writer, key);
         to_abf(val, stream);
     }
 }
 
-static void to_abf(const common::string &obj_str, streams::idynamic_stream &stream)
+static void to_abf(const string &obj_str, streams::idynamic_stream &stream)
 {
     streams::stream_writer writer{stream};
     writer << chunk_type_string;
-    writer << streams::length_prefix_string<streams::varint>{obj_str};
+    write_string(writer, obj_str);
 }
 
 static void to_abf(const common::uuid &uuid, streams::idynamic_stream &stream)
@@ -126,14 +133,171 @@ static void to_abf(const blob &val, streams::idynamic_stream &stream)
     writer.vector_write(val);
 }
 
+class abf2_writer final
+{
+public:
+    explicit abf2_writer(std::vector<std::uint8_t> &buffer)
+        : buffer_{&buffer}
+    {
+    }
+
+    void write(const property_tree &ptree)
+    {
+        const auto header = allocate(abf2_header_size);
+        write_at(header, header_magic_v2);
+
+        const auto root = write_value(ptree);
+        write_at(header + abf2_root_offset_position, root);
+    }
+
+private:
+    [[nodiscard]] auto write_value(const property_tree &ptree) -> std::uint64_t
+    {
+        return std::visit([this](const auto &value) { return write_node(value); }, ptree.value());
+    }
+
+    [[nodiscard]] auto write_node(const std::monostate) -> std::uint64_t
+    {
+        return begin_node(chunk_type_null, 0);
+    }
+
+    [[nodiscard]] auto write_node(const array &arr) -> std::uint64_t
+    {
+        const auto count = std::size(arr);
+        const auto offset = begin_node(chunk_type_array, sizeof(std::uint64_t) * (count + 1));
+        const auto table = offset + abf2_node_header_size + sizeof(std::uint64_t);
+        write_at(offset + abf2_node_header_size, static_cast<std::uint64_t>(count));
+
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            write_at(table + i * sizeof(std::uint64_t), write_value(arr[i]));
+        }
+
+        return offset;
+    }
+
+    [[nodiscard]] auto write_node(const object &obj) -> std::uint64_t
+    {
+        const auto count = std::size(obj);
+        const auto entries_size = count * sizeof(std::uint64_t) * 2;
+        const auto offset =
+            begin_node(chunk_type_object, sizeof(std::uint64_t) + entries_size + count * sizeof(std::uint32_t));
+        const auto entries = offset + abf2_node_header_size + sizeof(std::uint64_t);
+        write_at(offset + abf2_node_header_size, static_cast<std::uint64_t>(count));
+
+        std::vector<std::uint32_t> sorted(count);
+        std::iota(std::begin(sorted), std::end(sorted), 0u);
+        std::ranges::sort(sorted, [begin = std::begin(obj)](const auto lhs, const auto rhs)
+                          { return begin[lhs].first < begin[rhs].first; });
+
+        auto entry = entries;
+        for (const auto &[key, value] : obj)
+        {
+            write_at(entry, write_key(key));
+            write_at(entry + sizeof(std::uint64_t), write_value(value));
+            entry += sizeof(std::uint64_t) * 2;
+        }
+
+        write_at(entries + entries_size, std::data(sorted), std::size(sorted) * sizeof(std::uint32_t));
+        return offset;
+    }
+
+    [[nodiscard]] auto write_node(const string &str) -> std::uint64_t
+    {
+        return write_sized_node(chunk_type_string, std::data(str), std::size(str));
+    }
+
+    [[nodiscard]] auto write_node(const common::uuid &uuid) -> std::uint64_t
+    {
+        const auto offset = begin_node(chunk_type_uuid, uuid.size());
+        write_at(offset + abf2_node_header_size, uuid.data.data(), uuid.size());
+        return offset;
+    }
+
+    [[nodiscard]] auto write_node(const std::int64_t val) -> std::uint64_t
+    {
+        const auto offset = begin_node(chunk_type_integer, sizeof(val));
+        write_at(offset + abf2_node_header_size, val);
+        return offset;
+    }
+
+    [[nodiscard]] auto write_node(const double val) -> std::uint64_t
+    {
+        const auto offset = begin_node(chunk_type_double, sizeof(val));
+        write_at(offset + abf2_node_header_size, val);
+        return offset;
+    }
+
+    [[nodiscard]] auto write_node(const bool val) -> std::uint64_t
+    {
+        const auto offset = begin_node(chunk_type_bool, 0);
+        write_at(offset + abf2_bool_value_position, static_cast<std::uint8_t>(val));
+        return offset;
+    }
+
+    [[nodiscard]] auto write_node(const blob &val) -> std::uint64_t
+    {
+        return write_sized_node(chunk_type_blob, std::data(val), std::size(val));
+    }
+
+    [[nodiscard]] auto write_sized_node(const std::uint8_t type, const void *data, const std::size_t size)
+        -> std::uint64_t
+    {
+        const auto offset = begin_node(type, sizeof(std::uint64_t) + size);
+        write_at(offset + abf2_node_header_size, static_cast<std::uint64_t>(size));
+        write_at(offset + abf2_node_header_size + sizeof(std::uint64_t), data, size);
+        return offset;
+    }
+
+    [[nodiscard]] auto write_key(const string &key) -> std::uint64_t
+    {
+        const auto offset = allocate(sizeof(std::uint64_t) + std::size(key));
+        write_at(offset, static_cast<std::uint64_t>(std::size(key)));
+        write_at(offset + sizeof(std::uint64_t), std::data(key), std::size(key));
+        return offset;
+    }
+
+    [[nodiscard]] auto begin_node(const std::uint8_t type, const std::size_t payload_size) -> std::uint64_t
+    {
+        const auto offset = allocate(abf2_node_header_size + payload_size);
+        write_at(offset, type);
+        return offset;
+    }
+
+    /*!
+     * Reserve the given amount of zero initialized bytes at the next aligned offset.
+     */
+    [[nodiscard]] auto allocate(const std::size_t size) const -> std::uint64_t
+    {
+        const auto offset = (std::size(*buffer_) + abf2_alignment - 1) & ~(abf2_alignment - 1);
+        buffer_->resize(offset + size);
+        return offset;
+    }
+
+    template <typename T>
+    void write_at(const std::size_t offset, const T value) const
+    {
+        write_at(offset, &value, sizeof(T));
+    }
+
+    void write_at(const std::size_t offset, const void *data, const std::size_t size) const
+    {
+        if (size > 0)
+            std::memcpy(std::data(*buffer_) + offset, data, size);
+    }
+
+    std::vector<std::uint8_t> *buffer_;
+};
+
 class abf_parser final
 {
 public:
-    explicit abf_parser(streams::idynamic_stream &stream, const abf_deserialize_mode mode)
+    explicit abf_parser(streams::idynamic_stream &stream, const abf_deserialize_mode mode,
+                        std::pmr::memory_resource *resource)
         : reader_{stream}
         , mode_{mode}
+        , allocator_{resource}
     {
-        parse_header();
     }
 
     [[nodiscard]] auto parse() -> property_tree
@@ -151,8 +315,8 @@ public:
                 return parse_object();
             case chunk_type_string:
             {
-                common::string str;
-                reader_ >> streams::length_prefix_string<streams::varint>{str};
+                string str{allocator_};
+                read_string(str);
                 return str;
             }
             case chunk_type_integer:
@@ -184,7 +348,7 @@ public:
                 std::uint64_t size = 0;
                 reader_ >> streams::varint{size};
 
-                blob data;
+                blob data{allocator_};
 
                 if (size > 0)
                 {
@@ -207,18 +371,9 @@ private:
         return mode_ == abf_deserialize_mode::skip_blobs;
     }
 
-    void parse_header()
-    {
-        std::uint32_t magic = 0;
-        reader_ >> magic;
-
-        if (magic != header_magic)
-            throw ptree_serialization_exception{};
-    }
-
     [[nodiscard]] auto parse_object() -> property_tree
     {
-        object data;
+        object data{allocator_};
 
         std::uint64_t count = 0;
         reader_ >> count;
@@ -227,8 +382,8 @@ private:
 
         while (count != 0)
         {
-            common::string key;
-            reader_ >> streams::length_prefix_string<streams::varint>{key};
+            string key{allocator_};
+            read_string(key);
             data.emplace(std::move(key), parse());
             --count;
         }
@@ -236,9 +391,20 @@ private:
         return data;
     }
 
+    void read_string(string &str)
+    {
+        std::uint64_t size = 0;
+        reader_ >> streams::varint{size};
+        str.resize(size);
+
+        if (reader_.device().read(reinterpret_cast<std::byte *>(std::data(str)), size) !=
+            static_cast<std::streamoff>(size))
+            throw ptree_serialization_exception{};
+    }
+
     [[nodiscard]] auto parse_array() -> property_tree
     {
-        array data;
+        array data{allocator_};
 
         std::uint64_t count = 0;
         reader_ >> count;
@@ -256,35 +422,89 @@ private:
 
     streams::stream_reader<streams::idynamic_stream> reader_;
     abf_deserialize_mode mode_;
+    property_tree::allocator_type allocator_;
 };
 
 } // namespace internal
 
-void to_abf(const property_tree &ptree, streams::idynamic_stream &stream)
+void to_abf(const property_tree &ptree, streams::idynamic_stream &stream, const abf_version version)
 {
+    if (version == abf_version::v2)
+    {
+        const auto data = to_abf(ptree, version);
+        const auto size = static_cast<std::streamsize>(std::size(data));
+
+        if (stream.write(reinterpret_cast<const std::byte *>(std::data(data)), size) != size)
+            throw ptree_serialization_exception{};
+
+        return;
+    }
+
     internal::write_header(stream);
     internal::to_abf(ptree, stream);
 }
 
-[[nodiscard]] auto to_abf(const property_tree &ptree) -> std::vector<std::uint8_t>
+[[nodiscard]] auto to_abf(const property_tree &ptree, const abf_version version) -> std::vector<std::uint8_t>
 {
     std::vector<std::uint8_t> data;
+
+    if (version == abf_version::v2)
+    {
+        internal::abf2_writer writer{data};
+        writer.write(ptree);
+        return data;
+    }
+
     auto stream = streams::make_dynamic_stream(streams::memory_view_device{data});
-    to_abf(ptree, stream);
+    to_abf(ptree, stream, version);
     return data;
 }
 
 void from_abf(streams::idynamic_stream &stream, property_tree &ptree, const abf_deserialize_mode mode)
 {
-    internal::abf_parser parser{stream, mode};
-    ptree = parser.parse();
+    ptree = from_abf(stream, std::pmr::get_default_resource(), mode);
 }
 
 [[nodiscard]] auto from_abf(streams::idynamic_stream &stream, const abf_deserialize_mode mode) -> property_tree
 {
-    property_tree pt;
-    from_abf(stream, pt, mode);
-    return pt;
+    return from_abf(stream, std::pmr::get_default_resource(), mode);
+}
+
+[[nodiscard]] auto from_abf(streams::idynamic_stream &stream, std::pmr::memory_resource *resource,
+                            const abf_deserialize_mode mode) -> property_tree
+{
+    std::uint32_t magic = 0;
+    streams::stream_reader<streams::idynamic_stream> reader{stream};
+    reader >> magic;
+
+    if (magic == internal::header_magic)
+    {
+        internal::abf_parser parser{stream, mode, resource};
+        return parser.parse();
+    }
+
+    if (magic != internal::header_magic_v2)
+        throw ptree_serialization_exception{};
+
+    // ABF2 is designed to be used in place, so the stream is read into memory as a whole.
+    std::vector<std::uint8_t> data(sizeof(magic));
+    std::memcpy(std::data(data), &magic, sizeof(magic));
+
+    static constexpr std::streamsize read_chunk_size = 64 * 1024;
+
+    while (true)
+    {
+        const auto offset = std::size(data);
+        data.resize(offset + read_chunk_size);
+        const auto result = stream.read(reinterpret_cast<std::byte *>(std::data(data) + offset), read_chunk_size);
+        data.resize(offset + static_cast<std::size_t>(std::max(result, std::streamsize{0})));
+
+        if (result < read_chunk_size)
+            break;
+    }
+
+    const abf_view view{data};
+    return view.root().to_property_tree(mode, resource);
 }
 
 } // namespace aeon::ptree::serialization
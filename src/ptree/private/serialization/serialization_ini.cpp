@@ -20,7 +20,7 @@ namespace internal
 static void to_string(const std::monostate, streams::idynamic_stream &);
 static void to_string(const array &arr, streams::idynamic_stream &);
 static void to_string(const object &obj, streams::idynamic_stream &);
-static void to_string(const common::string &obj_str, streams::idynamic_stream &stream);
+static void to_string(const string &obj_str, streams::idynamic_stream &stream);
 static void to_string(const common::uuid &uuid, streams::idynamic_stream &stream);
 static void to_string(const std::int64_t val, streams::idynamic_stream &stream);
 static void to_string(const double val, streams::idynamic_stream &stream);
@@ -54,7 +54,7 @@ static void to_string(const common::uuid &uuid, streams::idynamic_stream &stream
     writer << uuid.str();
 }
 
-static void to_string(const common::string &obj_str, streams::idynamic_stream &stream)
+static void to_string(const string &obj_str, streams::idynamic_stream &stream)
 {
     streams::stream_writer writer{stream};
     writer << '"';
@@ -201,7 +201,7 @@ private:
 
         if (const auto string_result = match_string(); string_result.result())
         {
-            common::string string_value{std::cbegin(string_result.value()), std::end(string_result.value())};
+            string string_value{std::cbegin(string_result.value()), std::end(string_result.value())};
             return rdp::matched{property_tree{std::move(string_value)}};
         }
         else if (string_result.is_error())
@@ -228,7 +228,7 @@ private:
         if (!check_comment() && !rdp::check_newline(parser_))
             return rdp::parse_error{parser_, "Expected newline."};
 
-        common::string string_value{std::cbegin(header_name_result.value()), std::end(header_name_result.value())};
+        string string_value{std::cbegin(header_name_result.value()), std::end(header_name_result.value())};
         auto result = headers_.insert(std::move(string_value), object{});
         current_header_ = &(result->second.object_value());
 
@@ -266,7 +266,7 @@ private:
         if (!current_header_)
             return rdp::parse_error{parser_, "Expected header"};
 
-        common::string string_value{std::cbegin(key_name_result.value()), std::cend(key_name_result.value())};
+        string string_value{std::cbegin(key_name_result.value()), std::cend(key_name_result.value())};
         current_header_->push_back(std::move(string_value), value_result.value());
 
         state.accept();
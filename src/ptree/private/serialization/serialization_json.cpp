@@ -2,15 +2,25 @@
 
 #include <aeon/ptree/serialization/serialization_json.h>
 #include <aeon/ptree/serialization/exception.h>
-#include <aeon/unicode/utf_string_view.h>
-#include <aeon/unicode/stringutils.h>
+#include <aeon/unicode/encoding.h>
 #include <aeon/streams/devices/memory_view_device.h>
-#include <aeon/streams/stream_reader.h>
-#include <aeon/streams/stream_writer.h>
 #include <aeon/streams/dynamic_stream.h>
 #include <aeon/common/type_traits.h>
 #include <aeon/common/lexical_parse.h>
+#include <aeon/common/assert.h>
+#include "chunked_stream_reader.h"
+
+#if (!defined(AEON_DISABLE_SSE))
+#include <emmintrin.h>
+#endif
+
+#include <string_view>
+#include <charconv>
 #include <variant>
+#include <vector>
+#include <array>
+#include <bit>
+#include <cmath>
 #include <cctype>
 
 namespace aeon::ptree::serialization
@@ -19,367 +29,653 @@ namespace aeon::ptree::serialization
 namespace internal
 {
 
-static void to_json(const std::monostate, streams::idynamic_stream &);
-static void to_json(const array &arr, streams::idynamic_stream &stream);
-static void to_json(const object &obj, streams::idynamic_stream &stream);
-static void to_json(const common::string &obj_str, streams::idynamic_stream &stream);
-static void to_json(const common::uuid &uuid, streams::idynamic_stream &stream);
-static void to_json(const std::int64_t val, streams::idynamic_stream &stream);
-static void to_json(const double val, streams::idynamic_stream &stream);
-static void to_json(const bool val, streams::idynamic_stream &stream);
-static void to_json(const blob &val, streams::idynamic_stream &stream);
-
-static void to_json(const property_tree &ptree, streams::idynamic_stream &stream)
-{
-    std::visit([&stream](auto &&arg) { internal::to_json(arg, stream); }, ptree.value());
-}
+// When serializing to a stream, the buffer is written to the stream whenever it grows beyond this size.
+static constexpr std::size_t stream_flush_size = 64 * 1024;
 
-static void to_json(const std::monostate, streams::idynamic_stream &stream)
+static constexpr std::size_t pretty_indent_size = 4;
+
+[[nodiscard]] static auto must_escape(const char c) noexcept
 {
-    streams::stream_writer writer{stream};
-    writer << "null";
+    return c == '"' || c == '\\' || c == '/' || static_cast<unsigned char>(c) < 0x20;
 }
 
-static void to_json(const array &arr, streams::idynamic_stream &stream)
+/*!
+ * Find the offset of the first character that must be escaped, or the size of the string if there is none.
+ * With SSE enabled, 16 characters are checked at once.
+ */
+[[nodiscard]] static auto find_escape_character(const std::string_view str) noexcept -> std::size_t
 {
-    streams::stream_writer writer{stream};
-    writer << '[';
+    const auto size = std::size(str);
+    std::size_t offset = 0;
 
-    bool first = true;
+#if (!defined(AEON_DISABLE_SSE))
+    const auto quote = _mm_set1_epi8('"');
+    const auto backslash = _mm_set1_epi8('\\');
+    const auto slash = _mm_set1_epi8('/');
+    const auto control_max = _mm_set1_epi8(0x1F);
 
-    for (const auto &pt : arr)
+    for (; offset + 16 <= size; offset += 16)
     {
-        if (first)
-            first = false;
-        else
-            writer << ',';
+        const auto chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(std::data(str) + offset));
+
+        // Unsigned chunk <= 0x1F
+        const auto control = _mm_cmpeq_epi8(_mm_min_epu8(chunk, control_max), chunk);
+        const auto special = _mm_or_si128(_mm_cmpeq_epi8(chunk, quote),
+                                          _mm_or_si128(_mm_cmpeq_epi8(chunk, backslash), _mm_cmpeq_epi8(chunk, slash)));
+        const auto mask = static_cast<unsigned int>(_mm_movemask_epi8(_mm_or_si128(special, control)));
 
-        to_json(pt, stream);
+        if (mask != 0)
+            return offset + static_cast<std::size_t>(std::countr_zero(mask));
     }
+#endif
 
-    writer << ']';
+    for (; offset < size; ++offset)
+    {
+        if (must_escape(str[offset]))
+            return offset;
+    }
+
+    return size;
 }
 
-static void to_json(const object &obj, streams::idynamic_stream &stream)
+/*!
+ * Serializes a property tree into a single growable buffer. If a stream is given, the buffer is periodically
+ * written to it so that the buffer does not grow beyond stream_flush_size (plus the size of a single value).
+ */
+class json_writer final
 {
-    streams::stream_writer writer{stream};
-    writer << '{';
+public:
+    explicit json_writer(common::string &buffer, streams::idynamic_stream *stream, const json_serialize_mode mode)
+        : buffer_{&buffer}
+        , stream_{stream}
+        , mode_{mode}
+        , depth_{0}
+    {
+    }
 
-    bool first = true;
+    void write(const property_tree &ptree)
+    {
+        std::visit([this](auto &&arg) { write(arg); }, ptree.value());
+    }
 
-    for (const auto &[key, val] : obj)
+    void flush()
     {
-        if (first)
-            first = false;
-        else
-            writer << ',';
+        if (!stream_ || std::empty(*buffer_))
+            return;
 
-        to_json(key, stream);
-        writer << ':';
-        to_json(val, stream);
+        stream_->write(reinterpret_cast<const std::byte *>(std::data(*buffer_)),
+                       static_cast<std::streamsize>(std::size(*buffer_)));
+        buffer_->clear();
     }
 
-    writer << '}';
-}
+private:
+    void write(const std::monostate)
+    {
+        append("null");
+    }
 
-static void to_json(const common::uuid &uuid, streams::idynamic_stream &stream)
-{
-    to_json(uuid.str().u8str(), stream);
-}
+    void write(const array &arr)
+    {
+        if (std::empty(arr))
+        {
+            append("[]");
+            return;
+        }
 
-static void to_json(const common::string &obj_str, streams::idynamic_stream &stream)
-{
-    streams::stream_writer writer{stream};
-    writer << '"';
-    // TODO: Add utf8 support to ptree
-    common::string str{std::cbegin(obj_str), std::cend(obj_str)};
-    writer << unicode::stringutils::escape(str);
-    writer << '"';
-}
+        append('[');
+        ++depth_;
 
-static void to_json(const std::int64_t val, streams::idynamic_stream &stream)
-{
-    streams::stream_writer writer{stream};
-    writer << std::to_string(val);
-}
+        bool first = true;
 
-static void to_json(const double val, streams::idynamic_stream &stream)
-{
-    streams::stream_writer writer{stream};
-    writer << std::to_string(val);
-}
+        for (const auto &pt : arr)
+        {
+            if (first)
+                first = false;
+            else
+                append(',');
 
-static void to_json(const bool val, streams::idynamic_stream &stream)
-{
-    streams::stream_writer writer{stream};
+            write_newline();
+            write(pt);
+            flush_if_needed();
+        }
 
-    if (val)
-        writer << "true";
-    else
-        writer << "false";
-}
+        --depth_;
+        write_newline();
+        append(']');
+    }
 
-static void to_json([[maybe_unused]] const blob &val, [[maybe_unused]] streams::idynamic_stream &stream)
-{
-    aeon_assert_fail("Json serializer does not support binary blobs.");
-    throw ptree_serialization_exception{};
-}
+    void write(const object &obj)
+    {
+        if (std::empty(obj))
+        {
+            append("{}");
+            return;
+        }
 
-class json_parser final
-{
-public:
-    explicit json_parser(const common::string_view &view)
-        : view_{view}
-        , itr_{std::begin(view_)}
-        , prev_itr_{itr_}
+        append('{');
+        ++depth_;
+
+        bool first = true;
+
+        for (const auto &[key, val] : obj)
+        {
+            if (first)
+                first = false;
+            else
+                append(',');
+
+            write_newline();
+            write(std::string_view{key});
+
+            if (mode_ == json_serialize_mode::pretty)
+                append(": ");
+            else
+                append(':');
+
+            write(val);
+            flush_if_needed();
+        }
+
+        --depth_;
+        write_newline();
+        append('}');
+    }
+
+    void write(const common::uuid &uuid)
+    {
+        write(uuid.str().as_std_string_view());
+    }
+
+    void write(const string &str)
     {
+        write(std::string_view{str});
     }
 
-    [[nodiscard]] auto parse() -> property_tree
+    void write(std::string_view str)
     {
-        const auto token = next_token();
+        append('"');
 
-        if (std::isdigit(token) || token == '-')
+        while (!std::empty(str))
         {
-            itr_ = prev_itr_;
-            return parse_number();
+            // Copy runs of characters that don't need to be escaped in bulk.
+            const auto offset = find_escape_character(str);
+            append(str.substr(0, offset));
+
+            if (offset == std::size(str))
+                break;
+
+            write_escape_sequence(str[offset]);
+            str.remove_prefix(offset + 1);
         }
 
-        if (token == 't' || token == 'f')
-            return parse_boolean(token);
+        append('"');
+    }
 
-        if (token == 'n')
-            return parse_null();
+    void write(const std::int64_t val)
+    {
+        std::array<char, 24> data;
+        const auto result = std::to_chars(std::data(data), std::data(data) + std::size(data), val);
+        append(std::string_view{std::data(data), static_cast<std::size_t>(result.ptr - std::data(data))});
+    }
 
-        if (token == '"')
-            return parse_string();
+    void write(const double val)
+    {
+        // Json has no representation for nan or infinity.
+        if (!std::isfinite(val))
+        {
+            append("null");
+            return;
+        }
 
-        if (token == '{')
-            return parse_object();
+        // Without a precision, to_chars gives the shortest representation that round-trips to the same value.
+        std::array<char, 32> data;
+        const auto result = std::to_chars(std::data(data), std::data(data) + std::size(data), val);
+        const std::string_view str{std::data(data), static_cast<std::size_t>(result.ptr - std::data(data))};
+        append(str);
 
-        if (token == '[')
-            return parse_array();
+        // Make sure the value is parsed back as a double instead of an integer.
+        if (str.find_first_of(".e") == std::string_view::npos)
+            append(".0");
+    }
 
-        throw ptree_serialization_exception{};
+    void write(const bool val)
+    {
+        if (val)
+            append("true");
+        else
+            append("false");
     }
 
-private:
-    void consume_whitespace() noexcept
+    void write([[maybe_unused]] const blob &val)
     {
-        while ((*itr_ == ' ' || *itr_ == '\r' || *itr_ == '\n' || *itr_ == '\t') && itr_ != std::end(view_))
-            ++itr_;
+        aeon_assert_fail("Json serializer does not support binary blobs.");
+        throw ptree_serialization_exception{};
     }
 
-    [[nodiscard]] auto parse_boolean(const char32_t token) -> property_tree
+    void write_escape_sequence(const char c)
     {
-        if (token == 't')
+        switch (c)
         {
-            check("true");
-            return true;
+            case '\b':
+                append("\\b");
+                break;
+            case '\f':
+                append("\\f");
+                break;
+            case '\n':
+                append("\\n");
+                break;
+            case '\r':
+                append("\\r");
+                break;
+            case '\t':
+                append("\\t");
+                break;
+            case '"':
+                append("\\\"");
+                break;
+            case '\\':
+                append("\\\\");
+                break;
+            case '/':
+                append("\\/");
+                break;
+            default:
+            {
+                static constexpr std::string_view hex_digits = "0123456789abcdef";
+                const auto value = static_cast<unsigned char>(c);
+                append("\\u00");
+                append(hex_digits[value >> 4]);
+                append(hex_digits[value & 0x0F]);
+            }
         }
+    }
 
-        if (token == 'f')
-        {
-            check("false");
-            return false;
-        }
+    void write_newline()
+    {
+        if (mode_ != json_serialize_mode::pretty)
+            return;
 
-        throw ptree_serialization_exception{};
+        append('\n');
+        buffer_->str().append(depth_ * pretty_indent_size, ' ');
     }
 
-    [[nodiscard]] auto parse_null() -> property_tree
+    void append(const char c)
     {
-        check("null");
-        return nullptr;
+        buffer_->str().push_back(c);
     }
 
-    [[nodiscard]] auto parse_object() -> property_tree
+    void append(const std::string_view str)
     {
-        object data;
-        auto token = next_token();
+        buffer_->str().append(str);
+    }
 
-        if (token == '}')
-            return std::move(data);
+    void flush_if_needed()
+    {
+        if (std::size(*buffer_) >= stream_flush_size)
+            flush();
+    }
 
-        while (true)
-        {
-            if (token != '"')
-                throw ptree_serialization_exception{};
+    common::string *buffer_;
+    streams::idynamic_stream *stream_;
+    json_serialize_mode mode_;
+    std::size_t depth_;
+};
 
-            auto key = parse_string();
+class json_sax_parser final
+{
+    enum class container_type
+    {
+        object,
+        array
+    };
 
-            token = next_token();
+    enum class parse_state
+    {
+        value,
+        object_first,
+        array_first,
+        after_value
+    };
 
-            if (token != ':')
-                throw ptree_serialization_exception{};
+public:
+    explicit json_sax_parser(streams::idynamic_stream &stream, sax_handler &handler, const std::size_t chunk_size)
+        : reader_{stream, chunk_size}
+        , handler_{&handler}
+        , stack_{}
+        , token_{}
+    {
+    }
 
-            data.emplace(std::move(key), parse());
+    void parse()
+    {
+        auto state = parse_state::value;
 
-            token = next_token();
-            if (token == '}')
-                break;
+        while (true)
+        {
+            const auto token = next_token();
 
-            if (token != ',')
-                throw ptree_serialization_exception{};
+            switch (state)
+            {
+                case parse_state::value:
+                    state = parse_value(token);
+                    break;
+                case parse_state::object_first:
+                    if (token == '}')
+                    {
+                        end_container(container_type::object);
+                        state = parse_state::after_value;
+                        break;
+                    }
+
+                    parse_key(token);
+                    state = parse_state::value;
+                    break;
+                case parse_state::array_first:
+                    if (token == ']')
+                    {
+                        end_container(container_type::array);
+                        state = parse_state::after_value;
+                        break;
+                    }
+
+                    state = parse_value(token);
+                    break;
+                case parse_state::after_value:
+                    state = parse_separator(token);
+                    break;
+            }
 
-            token = next_token();
+            if (state == parse_state::after_value && std::empty(stack_))
+                return;
         }
-        return std::move(data);
     }
 
-    [[nodiscard]] auto parse_array() -> property_tree
+private:
+    [[nodiscard]] auto parse_value(const char token) -> parse_state
     {
-        array data;
-        auto token = next_token();
-
-        if (token == ']')
-            return std::move(data);
+        if (std::isdigit(static_cast<unsigned char>(token)) || token == '-')
+        {
+            parse_number(token);
+            return parse_state::after_value;
+        }
 
-        while (true)
+        switch (token)
         {
-            itr_ = prev_itr_;
-            data.push_back(parse());
+            case 't':
+                check("rue");
+                handler_->on_bool(true);
+                return parse_state::after_value;
+            case 'f':
+                check("alse");
+                handler_->on_bool(false);
+                return parse_state::after_value;
+            case 'n':
+                check("ull");
+                handler_->on_null();
+                return parse_state::after_value;
+            case '"':
+                parse_string();
+                handler_->on_string(token_);
+                return parse_state::after_value;
+            case '{':
+                handler_->on_start_object();
+                stack_.push_back(container_type::object);
+                return parse_state::object_first;
+            case '[':
+                handler_->on_start_array();
+                stack_.push_back(container_type::array);
+                return parse_state::array_first;
+            default:
+                throw ptree_serialization_exception{};
+        }
+    }
 
-            token = next_token();
+    [[nodiscard]] auto parse_separator(const char token) -> parse_state
+    {
+        const auto container = stack_.back();
 
-            if (token == ']')
-                break;
+        if (container == container_type::object)
+        {
+            if (token == '}')
+            {
+                end_container(container_type::object);
+                return parse_state::after_value;
+            }
 
             if (token != ',')
                 throw ptree_serialization_exception{};
 
-            next_token();
+            parse_key(next_token());
+            return parse_state::value;
+        }
+
+        if (token == ']')
+        {
+            end_container(container_type::array);
+            return parse_state::after_value;
         }
 
-        return std::move(data);
+        if (token != ',')
+            throw ptree_serialization_exception{};
+
+        return parse_state::value;
     }
 
-    [[nodiscard]] auto parse_number() -> property_tree
+    void end_container(const container_type type)
     {
-        const auto str = common::lexical_parse::extract_number_string(view_.str().substr(itr_.offset()));
-        const auto result = common::lexical_parse::number(str);
+        stack_.pop_back();
 
-        std::advance(itr_, result.offset());
+        if (type == container_type::object)
+            handler_->on_end_object();
+        else
+            handler_->on_end_array();
+    }
 
-        if (result.is_integer())
-            return result.integer_value();
+    void parse_key(const char token)
+    {
+        if (token != '"')
+            throw ptree_serialization_exception{};
 
-        return result.double_value();
+        parse_string();
+
+        if (next_token() != ':')
+            throw ptree_serialization_exception{};
+
+        handler_->on_key(token_);
     }
 
-    void check(const common::string_view &expected)
+    void parse_number(const char first)
     {
-        itr_ = prev_itr_;
-        if (view_.str().compare(itr_.offset(), std::size(expected), expected) == 0)
+        token_.clear();
+        token_ += first;
+        reader_.read_while(token_, [](const char c)
+                           { return std::isdigit(static_cast<unsigned char>(c)) || c == '.' || c == 'e' || c == 'E' ||
+                                    c == '-' || c == '+'; });
+
+        try
         {
-            std::advance(itr_, std::size(expected));
+            const auto result = common::lexical_parse::number(token_);
+
+            if (result.offset() != std::size(token_))
+                throw ptree_serialization_exception{};
+
+            if (result.is_integer())
+                handler_->on_integer(result.integer_value());
+            else
+                handler_->on_double(result.double_value());
         }
-        else
+        catch (const common::lexical_parse::lexical_parse_exception &)
         {
             throw ptree_serialization_exception{};
         }
     }
 
-    [[nodiscard]] auto parse_string() -> common::string
+    void check(const common::string_view &expected)
     {
-        common::string out;
+        for (const auto c : expected)
+        {
+            if (reader_.get() != c)
+                throw ptree_serialization_exception{};
+        }
+    }
+
+    /*!
+     * Parse a string into token_. The opening quote must already be consumed. Runs of characters that don't need
+     * special handling are copied in bulk.
+     */
+    void parse_string()
+    {
+        token_.clear();
 
         while (true)
         {
-            if (itr_ == std::end(view_))
-                throw ptree_serialization_exception{};
+            reader_.read_while(token_, [](const char c)
+                               { return c != '"' && c != '\\' && static_cast<unsigned char>(c) >= 0x20; });
 
-            if (*itr_ == '"')
-            {
-                ++itr_;
-                return out;
-            }
+            const auto c = reader_.get_checked();
+
+            if (c == '"')
+                return;
 
-            if (std::iscntrl(*itr_))
+            if (c != '\\')
                 throw ptree_serialization_exception{};
 
-            if (*itr_ != '\\')
-            {
-                out += itr_.character_str();
-                ++itr_;
-                continue;
-            }
+            parse_escape_sequence();
+        }
+    }
 
-            ++itr_;
+    void parse_escape_sequence()
+    {
+        switch (reader_.get_checked())
+        {
+            case 'b':
+                token_ += '\b';
+                break;
+            case 'f':
+                token_ += '\f';
+                break;
+            case 'n':
+                token_ += '\n';
+                break;
+            case 'r':
+                token_ += '\r';
+                break;
+            case 't':
+                token_ += '\t';
+                break;
+            case '"':
+                token_ += '"';
+                break;
+            case '\\':
+                token_ += '\\';
+                break;
+            case '/':
+                token_ += '/';
+                break;
+            case 'u':
+                parse_unicode_escape_sequence();
+                break;
+            default:
+                throw ptree_serialization_exception{};
+        }
+    }
+
+    void parse_unicode_escape_sequence()
+    {
+        auto codepoint = parse_hex4();
 
-            if (itr_ == std::end(view_))
+        // Surrogate pairs are written as 2 consecutive escape sequences
+        if (codepoint >= 0xD800 && codepoint <= 0xDBFF)
+        {
+            if (reader_.get_checked() != '\\' || reader_.get_checked() != 'u')
                 throw ptree_serialization_exception{};
 
-            const auto c = *itr_++;
-            if (c == 'b')
-            {
-                out += '\b';
-            }
-            else if (c == 'f')
-            {
-                out += '\f';
-            }
-            else if (c == 'n')
-            {
-                out += '\n';
-            }
-            else if (c == 'r')
-            {
-                out += '\r';
-            }
-            else if (c == 't')
-            {
-                out += '\t';
-            }
-            else if (c == '"' || c == '\\' || c == '/')
-            {
-                out += static_cast<char>(c);
-            }
-            else
-            {
+            const auto low = parse_hex4();
+
+            if (low < 0xDC00 || low > 0xDFFF)
                 throw ptree_serialization_exception{};
-            }
+
+            codepoint = 0x10000 + ((codepoint - 0xD800) << 10) + (low - 0xDC00);
+        }
+        else if (codepoint >= 0xDC00 && codepoint <= 0xDFFF)
+        {
+            throw ptree_serialization_exception{};
         }
+
+        token_ += unicode::utf32::to_utf8(codepoint);
     }
 
-    auto next_token() -> char32_t
+    [[nodiscard]] auto parse_hex4() -> char32_t
     {
-        consume_whitespace();
+        char32_t value = 0;
 
-        if (itr_ == std::end(view_))
-            throw ptree_serialization_exception{};
+        for (auto i = 0; i < 4; ++i)
+        {
+            const auto c = reader_.get_checked();
+            value <<= 4;
+
+            if (c >= '0' && c <= '9')
+                value |= static_cast<char32_t>(c - '0');
+            else if (c >= 'a' && c <= 'f')
+                value |= static_cast<char32_t>(c - 'a' + 10);
+            else if (c >= 'A' && c <= 'F')
+                value |= static_cast<char32_t>(c - 'A' + 10);
+            else
+                throw ptree_serialization_exception{};
+        }
 
-        prev_itr_ = itr_;
+        return value;
+    }
 
-        return *itr_++;
+    auto next_token() -> char
+    {
+        reader_.skip_while([](const char c) { return c == ' ' || c == '\r' || c == '\n' || c == '\t'; });
+        return reader_.get_checked();
     }
 
-    unicode::utf_string_view<common::string_view> view_;
-    unicode::utf_string_view<common::string_view>::iterator itr_;
-    unicode::utf_string_view<common::string_view>::iterator prev_itr_;
+    chunked_stream_reader reader_;
+    sax_handler *handler_;
+    std::vector<container_type> stack_;
+    common::string token_;
 };
 
 } // namespace internal
 
-void to_json(const property_tree &ptree, streams::idynamic_stream &stream)
+void to_json(const property_tree &ptree, streams::idynamic_stream &stream, const json_serialize_mode mode)
 {
-    internal::to_json(ptree, stream);
+    common::string buffer;
+    buffer.reserve(internal::stream_flush_size);
+
+    internal::json_writer writer{buffer, &stream, mode};
+    writer.write(ptree);
+    writer.flush();
 }
 
-[[nodiscard]] auto to_json(const property_tree &ptree) -> common::string
+void to_json(const property_tree &ptree, common::string &buffer, const json_serialize_mode mode)
+{
+    internal::json_writer writer{buffer, nullptr, mode};
+    writer.write(ptree);
+}
+
+[[nodiscard]] auto to_json(const property_tree &ptree, const json_serialize_mode mode) -> common::string
 {
     common::string str;
-    auto stream = streams::make_dynamic_stream(streams::memory_view_device{str});
-    to_json(ptree, stream);
+    to_json(ptree, str, mode);
     return str;
 }
 
 void from_json(streams::idynamic_stream &stream, property_tree &ptree)
 {
-    streams::stream_reader reader{stream};
-    const auto str = reader.read_to_string();
-    internal::json_parser parser{str};
-    ptree = parser.parse();
+    property_tree_builder builder;
+    from_json(stream, builder);
+    ptree = builder.release();
+}
+
+void from_json(streams::idynamic_stream &stream, sax_handler &handler, const std::size_t chunk_size)
+{
+    internal::json_sax_parser parser{stream, handler, chunk_size};
+    parser.parse();
 }
 
 [[nodiscard]] auto from_json(streams::idynamic_stream &stream) -> property_tree
@@ -389,6 +685,13 @@ void from_json(streams::idynamic_stream &stream, property_tree &ptree)
     return pt;
 }
 
+[[nodiscard]] auto from_json(streams::idynamic_stream &stream, std::pmr::memory_resource *resource) -> property_tree
+{
+    property_tree_builder builder{resource};
+    from_json(stream, builder);
+    return builder.release();
+}
+
 [[nodiscard]] auto from_json(const common::string &str) -> property_tree
 {
     auto stream = streams::make_dynamic_stream(streams::memory_view_device{str});
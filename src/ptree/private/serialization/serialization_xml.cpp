@@ -2,11 +2,12 @@
 
 #include <aeon/ptree/serialization/serialization_xml.h>
 #include <aeon/streams/devices/memory_view_device.h>
-#include <aeon/streams/stream_reader.h>
 #include <aeon/streams/dynamic_stream.h>
-#include <aeon/rdp/matchers.h>
-#include <aeon/rdp/scoped_state.h>
-#include <aeon/rdp/parser.h>
+#include <aeon/common/string_utils.h>
+#include "chunked_stream_reader.h"
+#include <string_view>
+#include <vector>
+#include <cctype>
 
 namespace aeon::ptree::serialization
 {
@@ -14,254 +15,315 @@ namespace aeon::ptree::serialization
 namespace internal
 {
 
-static constexpr auto cdata_begin = "<![CDATA[";
-static constexpr auto cdata_end = "]]>";
+static constexpr std::string_view cdata_begin = "[CDATA[";
+static constexpr std::string_view cdata_end = "]]>";
 
-static constexpr auto comment_begin = "<!--";
-static constexpr auto comment_end = "-->";
+static constexpr std::string_view comment_begin = "--";
+static constexpr std::string_view comment_end = "-->";
 
-static constexpr auto header_begin = "<?xml";
-static constexpr auto header_end = "?>";
+static constexpr std::string_view header_begin = "xml";
 
-static constexpr auto dtd_begin = "<!";
+[[nodiscard]] static auto is_whitespace(const char c) noexcept
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
 
-static constexpr auto element_begin = '<';
-static constexpr auto element_end = '>';
-static constexpr auto element_self_closing_end = "/>";
-static constexpr auto element_closing_begin = "</";
+[[nodiscard]] static auto is_name_character(const char c) noexcept
+{
+    return std::isalnum(static_cast<unsigned char>(c)) != 0 || c == '_' || c == '-' || c == '.' || c == ':' ||
+           static_cast<unsigned char>(c) >= 0x80;
+}
 
-class xml_parser final
+class xml_sax_parser final
 {
 public:
-    explicit xml_parser(const common::string_view &view, common::string attribute_placeholder)
-        : parser_{view}
-        , attribute_placeholder_{std::move(attribute_placeholder)}
+    explicit xml_sax_parser(streams::idynamic_stream &stream, xml_sax_handler &handler, const std::size_t chunk_size)
+        : reader_{stream, chunk_size}
+        , handler_{&handler}
+        , element_stack_{}
+        , name_{}
+        , attribute_name_{}
+        , attribute_value_{}
+        , text_{}
     {
     }
 
-    void parse(property_tree &ptree)
+    void parse()
     {
-        if (rdp::eof(parser_))
-            return;
+        skip_byte_order_marker();
 
-        rdp::skip_byte_order_marker(parser_);
-
-        auto arr = parse_nodes("");
-
-        if (arr.is_error())
+        while (!reader_.eof())
         {
-            rdp::print_parse_error(arr.error());
-            throw ptree_xml_deserialize_exception{arr.error().message()};
+            if (reader_.check('<'))
+                parse_markup();
+            else
+                parse_text();
         }
 
-        ptree = std::move(arr.value());
+        if (!std::empty(element_stack_))
+            error("Unexpected end of file. Expected closing tag for " + element_stack_.back() + ".");
     }
 
 private:
-    struct attribute final
+    void skip_byte_order_marker()
     {
-        common::string_view name;
-        common::string_view value;
-    };
-
-    [[nodiscard]] auto parse_attribute_and_value() -> rdp::parse_result<attribute>
-    {
-        rdp::skip_whitespace(parser_);
+        if (!reader_.check(static_cast<char>(0xEF)))
+            return;
 
-        const auto attribute_name_result = rdp::match_alnum(parser_);
+        if (!reader_.check(static_cast<char>(0xBB)) || !reader_.check(static_cast<char>(0xBF)))
+            error("Invalid byte order marker.");
+    }
 
-        if (!attribute_name_result)
-            return rdp::parse_error{parser_, "Expected attribute name."};
+    void parse_markup()
+    {
+        if (reader_.check('/'))
+        {
+            parse_closing_tag();
+        }
+        else if (reader_.check('!'))
+        {
+            if (check(comment_begin))
+                skip_until(comment_end, "Unmatched comment section.");
+            else if (check(cdata_begin))
+                parse_cdata();
+            else
+                error("DTD is not yet supported.");
+        }
+        else if (reader_.check('?'))
+        {
+            if (!check(header_begin))
+                error("Unsupported processing instruction.");
 
-        rdp::skip_whitespace(parser_);
+            parse_declaration();
+        }
+        else
+        {
+            parse_element();
+        }
+    }
 
-        if (!parser_.check('='))
-            return rdp::parse_error{parser_, "Expected '='."};
+    void parse_declaration()
+    {
+        if (!is_whitespace(static_cast<char>(reader_.peek())))
+            error("Expected whitespace after <?xml.");
 
-        rdp::skip_whitespace(parser_);
+        handler_->on_start_declaration();
 
-        if (!parser_.check('"'))
-            return rdp::parse_error{parser_, "Expected '\"'."};
+        while (true)
+        {
+            skip_whitespace();
 
-        const auto attribute_value_result = parser_.match_until('"');
+            if (reader_.check('?'))
+            {
+                if (!reader_.check('>'))
+                    error("Expected '?>'.");
 
-        if (!attribute_value_result)
-            return rdp::parse_error{parser_, "Expected value closed by '\"'."};
+                break;
+            }
 
-        if (!parser_.check('"'))
-            return rdp::parse_error{parser_, "Expected value closed by '\"'."};
+            parse_attribute();
+        }
 
-        return rdp::matched{attribute{attribute_name_result.value(), attribute_value_result.value()}};
+        handler_->on_end_declaration();
     }
 
-    [[nodiscard]] auto parse_header() -> rdp::parse_result<property_tree>
+    void parse_element()
     {
-        if (!rdp::check_whitespace(parser_))
-            return rdp::parse_error{parser_, "Expected whitespace after <?xml."};
+        skip_whitespace();
+        read_name(name_);
+
+        if (std::empty(name_))
+            error("Expected element name.");
 
-        object obj;
+        handler_->on_start_element(name_);
 
-        while (!parser_.check(header_end))
+        while (true)
         {
-            const auto result = parse_attribute_and_value();
+            skip_whitespace();
 
-            if (!result)
-                return result.error();
+            if (reader_.check('/'))
+            {
+                if (!reader_.check('>'))
+                    error("Expected '/>'.");
 
-            obj.emplace(common::string{result.value().name}, common::string{result.value().value});
+                handler_->on_end_element(name_, true);
+                return;
+            }
+
+            if (reader_.check('>'))
+                break;
+
+            if (reader_.eof())
+                error("Unexpected end of file. Expected attribute or />.");
+
+            parse_attribute();
         }
 
-        return rdp::matched{property_tree{object{{"?xml", std::move(obj)}}}};
+        element_stack_.push_back(name_);
     }
 
-    [[nodiscard]] auto parse_element() -> rdp::parse_result<property_tree>
+    void parse_closing_tag()
     {
-        rdp::skip_whitespace_and_newline(parser_);
+        read_name(name_);
+        skip_whitespace();
 
-        const auto element_name = parser_.match(
-            [](const auto c) { return std::isalnum(c) != 0 || c == '_' || c == '-' || c == '.' || c == ':'; });
+        if (!reader_.check('>'))
+            error("Expected '>'.");
 
-        if (!element_name)
-            return rdp::parse_error{parser_, "Expected element name."};
+        if (std::empty(element_stack_) || element_stack_.back() != name_)
+            error("Unexpected closing tag for " + name_ + ".");
 
-        rdp::skip_whitespace(parser_);
+        handler_->on_end_element(name_, false);
+        element_stack_.pop_back();
+    }
 
-        object attributes;
+    void parse_attribute()
+    {
+        read_name(attribute_name_);
 
-        while (!rdp::eof(parser_))
-        {
-            rdp::skip_whitespace(parser_);
+        if (std::empty(attribute_name_))
+            error("Expected attribute name.");
 
-            if (parser_.check(element_self_closing_end))
-            {
-                if (std::empty(attributes))
-                    return rdp::matched{property_tree{object{{common::string{element_name.value()}, array{{}}}}}};
-                else
-                    return rdp::matched{
-                        property_tree{object{{common::string{element_name.value()},
-                                              array{{object{{attribute_placeholder_, std::move(attributes)}}}}}}}};
-            }
+        skip_whitespace();
 
-            if (parser_.check(element_end))
-                break;
+        if (!reader_.check('='))
+            error("Expected '='.");
 
-            const auto result = parse_attribute_and_value();
+        skip_whitespace();
 
-            if (!result)
-                return rdp::parse_error{parser_, "Expected attribute or />."};
+        const auto quote = reader_.get();
 
-            attributes.emplace(common::string{result.value().name}, common::string{result.value().value});
-        }
+        if (quote != '"' && quote != '\'')
+            error("Expected '\"'.");
 
-        auto children_result = parse_nodes(common::string{element_name.value()});
+        attribute_value_.clear();
+        reader_.read_while(attribute_value_, [quote](const char c) { return c != quote; });
 
-        if (children_result.is_error())
-            return children_result.error();
+        if (!reader_.check(static_cast<char>(quote)))
+            error("Expected value closed by '\"'.");
 
-        auto children = std::move(children_result.value());
+        handler_->on_attribute(attribute_name_, attribute_value_);
+    }
 
-        if (!std::empty(attributes))
-            children.push_back(object{{attribute_placeholder_, std::move(attributes)}});
+    void parse_cdata()
+    {
+        skip_whitespace();
 
-        return rdp::matched{property_tree{object{{common::string{element_name.value()}, std::move(children)}}}};
+        text_.clear();
+        read_until(cdata_end, text_, "Expected ]]>.");
+        handler_->on_cdata(text_);
     }
 
-    [[nodiscard]] auto parse_cdata() -> rdp::parse_result<property_tree>
+    void parse_text()
     {
-        rdp::skip_whitespace_and_newline(parser_);
-        const auto result = parser_.match_until(cdata_end);
-
-        if (result.is_error())
-            return result.error();
+        text_.clear();
+        reader_.read_while(text_, [](const char c) { return c != '<'; });
 
-        if (!parser_.check(cdata_end))
-            return rdp::parse_error{parser_, "Expected ]]>."};
+        const auto value = common::string_utils::trimmedsv(text_);
 
-        return rdp::matched{property_tree{common::string{result.value()}}};
+        if (!std::empty(value))
+            handler_->on_text(value);
     }
 
-    [[nodiscard]] auto parse_nodes(const common::string &parent_node) -> rdp::parse_result<array>
+    void read_name(common::string &out)
     {
-        array nodes;
+        out.clear();
+        reader_.read_while(out, [](const char c) { return is_name_character(c); });
+    }
 
-        const auto parent_closing_node =
-            common::string{element_closing_begin} + parent_node + common::string{element_end};
+    /*!
+     * Read until the given terminator. The terminator is consumed, but not added to out.
+     */
+    void read_until(const std::string_view terminator, common::string &out, const char *const message)
+    {
+        const auto last = terminator.back();
 
-        while (!rdp::eof(parser_))
+        while (true)
         {
-            // If there is no parent (root of the file), then don't check for the closing tag.
-            if (!std::empty(parent_node))
-            {
-                if (parser_.check(parent_closing_node))
-                    break;
-            }
+            reader_.read_while(out, [last](const char c) { return c != last; });
 
-            auto result = parse_node();
+            const auto c = reader_.get();
 
-            if (result.is_unmatched())
-                continue;
+            if (c == chunked_stream_reader::eof_value)
+                error(message);
 
-            if (result.is_error())
-                return result.error();
+            out += static_cast<char>(c);
 
-            nodes.push_back(std::move(result.value()));
+            if (out.ends_with(terminator))
+            {
+                out.resize(std::size(out) - std::size(terminator));
+                return;
+            }
         }
-
-        return rdp::matched{std::move(nodes)};
     }
 
-    [[nodiscard]] auto parse_node() -> rdp::parse_result<property_tree>
+    /*!
+     * Skip until the given terminator. At most a single chunk is kept in memory to match the terminator.
+     */
+    void skip_until(const std::string_view terminator, const char *const message)
     {
-        if (parser_.check(cdata_begin))
-        {
-            return parse_cdata();
-        }
-        else if (parser_.check(comment_begin))
-        {
-            if (!parser_.match_until(comment_end))
-                return rdp::parse_error{parser_, "Unmatched comment section."};
+        const auto last = terminator.back();
+        text_.clear();
 
-            if (!parser_.check(comment_end))
-                return rdp::parse_error{parser_, "Unmatched comment section."};
-        }
-        else if (parser_.check(header_begin))
-        {
-            return parse_header();
-        }
-        else if (parser_.check(dtd_begin))
-        {
-            return rdp::parse_error{parser_, "DTD is not yet unsupported."};
-        }
-        else if (parser_.check(element_begin))
+        while (true)
         {
-            return parse_element();
+            reader_.read_while(text_, [last](const char c) { return c != last; });
+
+            const auto c = reader_.get();
+
+            if (c == chunked_stream_reader::eof_value)
+                error(message);
+
+            text_ += static_cast<char>(c);
+
+            if (text_.ends_with(terminator))
+                return;
+
+            if (std::size(text_) >= std::size(terminator))
+                text_.erase(0, std::size(text_) - (std::size(terminator) - 1));
         }
+    }
 
-        const auto text_result = parser_.match_until('<', rdp::eof_mode::match);
+    [[nodiscard]] auto check(const std::string_view expected) -> bool
+    {
+        if (!reader_.check(expected.front()))
+            return false;
 
-        if (!text_result)
-            return rdp::parse_error{parser_, "Could not parse XML file."};
+        for (const auto c : expected.substr(1))
+        {
+            if (!reader_.check(c))
+                error("Unexpected character.");
+        }
 
-        const auto value = common::string_utils::trimmedsv(text_result.value());
+        return true;
+    }
 
-        if (std::empty(value))
-            return rdp::unmatched{};
+    void skip_whitespace()
+    {
+        reader_.skip_while([](const char c) { return is_whitespace(c); });
+    }
 
-        return rdp::matched{property_tree{common::string{value.as_std_u8string_view()}}};
+    [[noreturn]] void error(const common::string &message) const
+    {
+        throw ptree_xml_deserialize_exception{message + " At offset " + std::to_string(reader_.offset()) + "."};
     }
 
-    rdp::parser parser_;
-    common::string attribute_placeholder_;
+    chunked_stream_reader reader_;
+    xml_sax_handler *handler_;
+    std::vector<common::string> element_stack_;
+    common::string name_;
+    common::string attribute_name_;
+    common::string attribute_value_;
+    common::string text_;
 };
 
 } // namespace internal
 
 void from_xml(streams::idynamic_stream &stream, property_tree &ptree, common::string attribute_placeholder)
 {
-    streams::stream_reader reader{stream};
-    const auto str = reader.read_to_string();
-    internal::xml_parser parser{str, std::move(attribute_placeholder)};
-    parser.parse(ptree);
+    xml_property_tree_builder builder{std::move(attribute_placeholder)};
+    from_xml(stream, builder);
+    ptree = builder.release();
 }
 
 auto from_xml(streams::idynamic_stream &stream, common::string attribute_placeholder) -> property_tree
@@ -271,10 +333,24 @@ auto from_xml(streams::idynamic_stream &stream, common::string attribute_placeho
     return pt;
 }
 
+auto from_xml(streams::idynamic_stream &stream, std::pmr::memory_resource *resource,
+              common::string attribute_placeholder) -> property_tree
+{
+    xml_property_tree_builder builder{std::move(attribute_placeholder), resource};
+    from_xml(stream, builder);
+    return builder.release();
+}
+
 auto from_xml(const common::string &str, common::string attribute_placeholder) -> property_tree
 {
     auto stream = streams::make_dynamic_stream(streams::memory_view_device{str});
     return from_xml(stream, std::move(attribute_placeholder));
 }
 
+void from_xml(streams::idynamic_stream &stream, xml_sax_handler &handler, const std::size_t chunk_size)
+{
+    internal::xml_sax_parser parser{stream, handler, chunk_size};
+    parser.parse();
+}
+
 } // namespace aeon::ptree::serialization
@@ -0,0 +1,103 @@
+// Distributed under the BSD 2-Clause License - Copyright 2012-2023 Robin Degen
+
+#include <aeon/ptree/serialization/xml_sax_handler.h>
+#include <aeon/common/assert.h>
+
+namespace aeon::ptree::serialization
+{
+
+static constexpr auto declaration_name = "?xml";
+
+xml_property_tree_builder::xml_property_tree_builder(common::string attribute_placeholder,
+                                                     std::pmr::memory_resource *resource)
+    : attribute_placeholder_{std::move(attribute_placeholder)}
+    , resource_{resource}
+    , stack_{}
+{
+    stack_.push_back(make_frame({}));
+}
+
+xml_property_tree_builder::~xml_property_tree_builder() = default;
+
+xml_property_tree_builder::xml_property_tree_builder(xml_property_tree_builder &&) noexcept = default;
+
+auto xml_property_tree_builder::operator=(xml_property_tree_builder &&) noexcept
+    -> xml_property_tree_builder & = default;
+
+void xml_property_tree_builder::on_start_declaration()
+{
+    stack_.push_back(make_frame(declaration_name));
+}
+
+void xml_property_tree_builder::on_end_declaration()
+{
+    aeon_assert(std::size(stack_) > 1, "Unexpected end of declaration.");
+    auto declaration = std::move(stack_.back());
+    stack_.pop_back();
+
+    stack_.back().children.push_back(make_object(std::move(declaration.name), std::move(declaration.attributes)));
+}
+
+void xml_property_tree_builder::on_start_element(const common::string_view &name)
+{
+    stack_.push_back(make_frame(name));
+}
+
+void xml_property_tree_builder::on_attribute(const common::string_view &name, const common::string_view &value)
+{
+    aeon_assert(std::size(stack_) > 1, "Attribute given outside of an element.");
+    stack_.back().attributes.emplace(string{name.as_std_string_view(), resource_},
+                                     string{value.as_std_string_view(), resource_});
+}
+
+void xml_property_tree_builder::on_end_element([[maybe_unused]] const common::string_view &name,
+                                               const bool self_closing)
+{
+    aeon_assert(std::size(stack_) > 1, "Unexpected end of element.");
+    auto element = std::move(stack_.back());
+    stack_.pop_back();
+
+    // Self closing elements without attributes are stored as an array holding a single null value.
+    if (self_closing && std::empty(element.attributes))
+        element.children.emplace_back();
+
+    if (!std::empty(element.attributes))
+        element.children.push_back(make_object(string{attribute_placeholder_.as_std_string_view(), resource_},
+                                                          std::move(element.attributes)));
+
+    stack_.back().children.push_back(make_object(std::move(element.name), std::move(element.children)));
+}
+
+void xml_property_tree_builder::on_text(const common::string_view &text)
+{
+    stack_.back().children.push_back(string{text.as_std_string_view(), resource_});
+}
+
+void xml_property_tree_builder::on_cdata(const common::string_view &data)
+{
+    stack_.back().children.push_back(string{data.as_std_string_view(), resource_});
+}
+
+auto xml_property_tree_builder::release() -> property_tree
+{
+    aeon_assert(std::size(stack_) == 1, "Not all elements were closed.");
+
+    auto result = std::move(stack_.front().children);
+    stack_.clear();
+    stack_.push_back(make_frame({}));
+    return result;
+}
+
+auto xml_property_tree_builder::make_frame(const common::string_view &name) const -> frame
+{
+    return frame{string{name.as_std_string_view(), resource_}, array(resource_), object(resource_)};
+}
+
+auto xml_property_tree_builder::make_object(string key, property_tree &&value) const -> object
+{
+    object obj(resource_);
+    obj.emplace(std::move(key), std::move(value));
+    return obj;
+}
+
+} // namespace aeon::ptree::serialization
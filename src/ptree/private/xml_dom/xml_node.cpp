@@ -22,7 +22,7 @@ auto xml_node::has_name() const noexcept -> bool
     return name_ != nullptr;
 }
 
-auto xml_node::name() const -> const common::string &
+auto xml_node::name() const -> common::string_view
 {
     if (!name_)
         throw xml_dom_exception{};
@@ -160,7 +160,7 @@ auto xml_node::attributes() const -> std::map<common::string, variant::convertin
                 if (!value.is_string())
                     throw xml_dom_exception{};
 
-                attributes.emplace(key, value.string_value());
+                attributes.emplace(common::string{common::string_view{key}}, common::string{value.string_value()});
             }
 
             return attributes;
@@ -170,7 +170,7 @@ auto xml_node::attributes() const -> std::map<common::string, variant::convertin
     return {};
 }
 
-auto xml_node::value_impl() const -> const common::string &
+auto xml_node::value_impl() const -> common::string_view
 {
     if (!pt_ || !pt_->is_string())
         throw xml_dom_exception{};
@@ -194,7 +194,7 @@ xml_node::xml_node(const xml_document &document, const property_tree &pt, const
 {
 }
 
-xml_node::xml_node(const xml_document &document, const property_tree &pt, const common::string &name,
+xml_node::xml_node(const xml_document &document, const property_tree &pt, const string &name,
                    const xml_node_type type) noexcept
     : document_{&document}
     , pt_{&pt}
@@ -109,7 +109,7 @@ inline auto config_file::get(const common::string &header, const common::string
         if (!key_object.is_string())
             return std::nullopt;
 
-        return key_object.string_value();
+        return common::string{key_object.string_value()};
     }
     else if constexpr (std::is_same_v<T, common::uuid>)
     {
@@ -158,8 +158,7 @@ inline void config_file::set(const common::string &header, const common::string
     if (!pt_->is_object())
         throw config_file_exception();
 
-    auto &root_object = pt_->object_value();
-    auto &header_pt = root_object[header];
+    auto &header_pt = (*pt_)[header];
 
     if (header_pt.is_null())
         header_pt = object{};
@@ -167,8 +166,7 @@ inline void config_file::set(const common::string &header, const common::string
     if (!header_pt.is_object())
         throw config_file_exception();
 
-    auto &header_object = header_pt.object_value();
-    header_object[key] = val;
+    header_pt[key] = val;
 }
 
 } // namespace aeon::ptree
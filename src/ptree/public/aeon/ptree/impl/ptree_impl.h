@@ -58,21 +58,26 @@ inline property_tree::property_tree(const bool value)
 }
 
 inline property_tree::property_tree(const char *const value)
-    : value_{common::string{value}}
+    : value_{string{value}}
 {
 }
 
 inline property_tree::property_tree(const char8_t *const value)
-    : value_{common::string{value}}
+    : value_{string{reinterpret_cast<const char *>(value)}}
 {
 }
 
 inline property_tree::property_tree(const common::string &value)
+    : value_{string{std::data(value), std::size(value)}}
+{
+}
+
+inline property_tree::property_tree(const string &value)
     : value_{value}
 {
 }
 
-inline property_tree::property_tree(common::string &&value)
+inline property_tree::property_tree(string &&value)
     : value_{std::move(value)}
 {
 }
@@ -97,6 +102,40 @@ inline property_tree::property_tree(blob &&data)
 {
 }
 
+inline property_tree::property_tree([[maybe_unused]] const allocator_type &allocator)
+    : value_{}
+{
+}
+
+inline property_tree::property_tree(const property_tree &other, const allocator_type &allocator)
+    : value_{std::visit([&allocator](const auto &value) { return make_value(value, allocator); }, other.value_)}
+{
+}
+
+inline property_tree::property_tree(property_tree &&other, const allocator_type &allocator)
+    : value_{std::visit([&allocator](auto &&value) { return make_value(std::move(value), allocator); }, other.value_)}
+{
+}
+
+template <typename T>
+    requires(!std::same_as<std::remove_cvref_t<T>, property_tree> && std::constructible_from<property_tree, T>)
+inline property_tree::property_tree(T &&value, const allocator_type &allocator)
+    : property_tree{property_tree{std::forward<T>(value)}, allocator}
+{
+}
+
+template <typename T>
+[[nodiscard]] inline auto property_tree::make_value(T &&value, const allocator_type &allocator) -> variant_type
+{
+    using value_type = std::remove_cvref_t<T>;
+
+    if constexpr (std::is_same_v<value_type, array> || std::is_same_v<value_type, object> ||
+                  std::is_same_v<value_type, blob> || std::is_same_v<value_type, string>)
+        return variant_type{std::in_place_type<value_type>, std::forward<T>(value), allocator};
+    else
+        return variant_type{std::in_place_type<value_type>, std::forward<T>(value)};
+}
+
 template <typename T>
 [[nodiscard]] inline auto property_tree::is_type() const noexcept
 {
@@ -120,7 +159,7 @@ template <typename T>
 
 [[nodiscard]] inline auto property_tree::is_string() const noexcept
 {
-    return is_type<common::string>();
+    return is_type<string>();
 }
 
 [[nodiscard]] inline auto property_tree::is_uuid() const noexcept
@@ -188,10 +227,10 @@ template <typename T>
     return std::get<common::uuid>(value());
 }
 
-[[nodiscard]] inline auto property_tree::string_value() const -> const common::string &
+[[nodiscard]] inline auto property_tree::string_value() const -> common::string_view
 {
     aeon_assert(is_string(), "Value is not a string.");
-    return std::get<common::string>(value());
+    return std::get<string>(value());
 }
 
 [[nodiscard]] inline auto property_tree::integer_value() const -> std::int64_t
@@ -218,33 +257,31 @@ template <typename T>
     return std::get<blob>(value());
 }
 
-[[nodiscard]] inline auto property_tree::at(const object::key_type &key) -> object::value_type &
+[[nodiscard]] inline auto property_tree::at(const common::string_view &key) -> object::value_type &
 {
     return object_value().at(key);
 }
 
-[[nodiscard]] inline auto property_tree::at(const object::key_type &key) const -> const object::value_type &
+[[nodiscard]] inline auto property_tree::at(const common::string_view &key) const -> const object::value_type &
 {
     return object_value().at(key);
 }
 
-[[nodiscard]] inline auto property_tree::operator[](const object::key_type &key) -> object::value_type &
+[[nodiscard]] inline auto property_tree::operator[](const common::string_view &key) -> object::value_type &
 {
     if (is_null())
         value_ = object{};
 
-    return object_value()[key];
-}
+    auto &obj = object_value();
+    const auto itr = obj.find(key);
 
-[[nodiscard]] inline auto property_tree::operator[](object::key_type &&key) -> object::value_type &
-{
-    if (is_null())
-        value_ = object{};
+    if (itr != std::end(obj))
+        return itr->second;
 
-    return object_value()[std::move(key)];
+    return obj.emplace(string{key.as_std_string_view(), obj.get_allocator()}, property_tree{})->second;
 }
 
-[[nodiscard]] inline auto property_tree::contains(const object::key_type &key) const noexcept -> bool
+[[nodiscard]] inline auto property_tree::contains(const common::string_view &key) const noexcept -> bool
 {
     if (!is_object())
         return false;
@@ -302,23 +339,29 @@ inline auto property_tree::operator=(object &&value) -> property_tree &
 
 inline auto property_tree::operator=(const char *const value) -> property_tree &
 {
-    value_ = common::string{value};
+    value_ = string{value};
     return *this;
 }
 
 inline auto property_tree::operator=(const char8_t *const value) -> property_tree &
 {
-    value_ = common::string{value};
+    value_ = string{reinterpret_cast<const char *>(value)};
     return *this;
 }
 
 inline auto property_tree::operator=(const common::string &value) -> property_tree &
+{
+    value_ = string{std::data(value), std::size(value)};
+    return *this;
+}
+
+inline auto property_tree::operator=(const string &value) -> property_tree &
 {
     value_ = value;
     return *this;
 }
 
-inline auto property_tree::operator=(common::string &&value) -> property_tree &
+inline auto property_tree::operator=(string &&value) -> property_tree &
 {
     value_ = std::move(value);
     return *this;
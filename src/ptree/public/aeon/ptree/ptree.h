@@ -2,11 +2,18 @@
 
 #pragma once
 
-#include <aeon/common/unordered_flatmap.h>
+#include <aeon/common/indexed_flatmap.h>
+#include <aeon/common/string_hash.h>
 #include <aeon/common/uuid.h>
 #include <aeon/common/string.h>
+#include <aeon/common/string_view.h>
 #include <variant>
 #include <vector>
+#include <memory_resource>
+#include <string>
+#include <utility>
+#include <concepts>
+#include <type_traits>
 #include <cstddef>
 #include <cstdint>
 
@@ -14,15 +21,33 @@ namespace aeon::ptree
 {
 
 class property_tree;
-using array = std::vector<property_tree>;
-using object = common::unordered_flatmap<common::string, property_tree>;
-using blob = std::vector<std::uint8_t>;
 
+/*!
+ * The string type used for string values and object keys. Unlike common::string it is allocator aware, so strings are
+ * placed in the same memory resource as the rest of the tree. The property_tree api accepts common::string and
+ * common::string_view and returns string values as common::string_view.
+ */
+using string = std::pmr::string;
+
+using array = std::pmr::vector<property_tree>;
+using object = common::indexed_flatmap<string, property_tree, common::string_hash,
+                                       std::pmr::polymorphic_allocator<std::pair<string, property_tree>>>;
+using blob = std::pmr::vector<std::uint8_t>;
+
+/*!
+ * A property tree node. Arrays, objects, blobs, strings and object keys allocate through a std::pmr::memory_resource,
+ * which defaults to std::pmr::get_default_resource(). When a node is inserted into an array or object, it is
+ * (re)created with the memory resource of that array or object, so a whole document can be placed in a single arena
+ * (for example a std::pmr::monotonic_buffer_resource) by creating the root container with that resource.
+ *
+ * Copying a property tree without passing an allocator results in a copy that uses the default memory resource.
+ */
 class property_tree
 {
 public:
     using variant_type =
-        std::variant<std::monostate, array, object, common::uuid, common::string, std::int64_t, double, blob, bool>;
+        std::variant<std::monostate, array, object, common::uuid, string, std::int64_t, double, blob, bool>;
+    using allocator_type = std::pmr::polymorphic_allocator<>;
 
     property_tree();
     property_tree(std::nullptr_t);
@@ -37,12 +62,25 @@ public:
     property_tree(const char *const value);
     property_tree(const char8_t *const value);
     property_tree(const common::string &value);
-    property_tree(common::string &&value);
+    property_tree(const string &value);
+    property_tree(string &&value);
     property_tree(const common::uuid &uuid);
     property_tree(common::uuid &&uuid);
     property_tree(const blob &data);
     property_tree(blob &&data);
 
+    /*!
+     * Allocator extended constructors. Any array, object or blob held by the resulting property tree will use the
+     * given allocator.
+     */
+    explicit property_tree(const allocator_type &allocator);
+    property_tree(const property_tree &other, const allocator_type &allocator);
+    property_tree(property_tree &&other, const allocator_type &allocator);
+
+    template <typename T>
+        requires(!std::same_as<std::remove_cvref_t<T>, property_tree> && std::constructible_from<property_tree, T>)
+    property_tree(T &&value, const allocator_type &allocator);
+
     virtual ~property_tree() noexcept = default;
 
     property_tree(const property_tree &) = default;
@@ -74,19 +112,18 @@ public:
     [[nodiscard]] auto object_value() const -> const object &;
 
     [[nodiscard]] auto uuid_value() const -> const common::uuid &;
-    [[nodiscard]] auto string_value() const -> const common::string &;
+    [[nodiscard]] auto string_value() const -> common::string_view;
     [[nodiscard]] auto integer_value() const -> std::int64_t;
     [[nodiscard]] auto double_value() const -> double;
     [[nodiscard]] auto bool_value() const -> bool;
     [[nodiscard]] auto blob_value() const -> const blob &;
 
-    [[nodiscard]] auto at(const object::key_type &key) -> object::value_type &;
-    [[nodiscard]] auto at(const object::key_type &key) const -> const object::value_type &;
+    [[nodiscard]] auto at(const common::string_view &key) -> object::value_type &;
+    [[nodiscard]] auto at(const common::string_view &key) const -> const object::value_type &;
 
-    [[nodiscard]] auto operator[](const object::key_type &key) -> object::value_type &;
-    [[nodiscard]] auto operator[](object::key_type &&key) -> object::value_type &;
+    [[nodiscard]] auto operator[](const common::string_view &key) -> object::value_type &;
 
-    [[nodiscard]] auto contains(const object::key_type &key) const noexcept -> bool;
+    [[nodiscard]] auto contains(const common::string_view &key) const noexcept -> bool;
 
     auto operator=(const std::nullptr_t) -> property_tree &;
     auto operator=(const int value) -> property_tree &;
@@ -99,7 +136,8 @@ public:
     auto operator=(const char *const value) -> property_tree &;
     auto operator=(const char8_t *const value) -> property_tree &;
     auto operator=(const common::string &value) -> property_tree &;
-    auto operator=(common::string &&value) -> property_tree &;
+    auto operator=(const string &value) -> property_tree &;
+    auto operator=(string &&value) -> property_tree &;
     auto operator=(const common::uuid &value) -> property_tree &;
     auto operator=(common::uuid &&value) -> property_tree &;
     auto operator=(const blob &value) -> property_tree &;
@@ -109,6 +147,9 @@ public:
     auto operator!=(const property_tree &other) const noexcept -> bool;
 
 private:
+    template <typename T>
+    [[nodiscard]] static auto make_value(T &&value, const allocator_type &allocator) -> variant_type;
+
     variant_type value_;
 };
 
@@ -0,0 +1,133 @@
+// Distributed under the BSD 2-Clause License - Copyright 2012-2023 Robin Degen
+
+#pragma once
+
+#include <aeon/ptree/ptree.h>
+#include <aeon/ptree/serialization/serialization_abf.h>
+#include <aeon/ptree/serialization/exception.h>
+#include <aeon/common/string_view.h>
+#include <aeon/common/uuid.h>
+#include <memory_resource>
+#include <optional>
+#include <span>
+#include <cstdint>
+#include <cstddef>
+
+namespace aeon::ptree::serialization
+{
+
+/*!
+ * A read-only view on a single value inside of ABF2 data. No data is copied; strings and blobs are returned as views
+ * into the underlying memory, which must outlive the view.
+ *
+ * Array elements are accessed in O(1) and object keys are found through a binary search.
+ */
+class abf_value_view final
+{
+public:
+    ~abf_value_view() = default;
+
+    abf_value_view(const abf_value_view &) noexcept = default;
+    auto operator=(const abf_value_view &) noexcept -> abf_value_view & = default;
+
+    abf_value_view(abf_value_view &&) noexcept = default;
+    auto operator=(abf_value_view &&) noexcept -> abf_value_view & = default;
+
+    [[nodiscard]] auto is_null() const noexcept -> bool;
+    [[nodiscard]] auto is_array() const noexcept -> bool;
+    [[nodiscard]] auto is_object() const noexcept -> bool;
+    [[nodiscard]] auto is_string() const noexcept -> bool;
+    [[nodiscard]] auto is_uuid() const noexcept -> bool;
+    [[nodiscard]] auto is_integer() const noexcept -> bool;
+    [[nodiscard]] auto is_double() const noexcept -> bool;
+    [[nodiscard]] auto is_bool() const noexcept -> bool;
+    [[nodiscard]] auto is_blob() const noexcept -> bool;
+
+    [[nodiscard]] auto string_value() const -> common::string_view;
+    [[nodiscard]] auto uuid_value() const -> common::uuid;
+    [[nodiscard]] auto integer_value() const -> std::int64_t;
+    [[nodiscard]] auto double_value() const -> double;
+    [[nodiscard]] auto bool_value() const -> bool;
+    [[nodiscard]] auto blob_value() const -> std::span<const std::uint8_t>;
+
+    /*!
+     * The amount of elements in an array or object.
+     */
+    [[nodiscard]] auto size() const -> std::size_t;
+
+    /*!
+     * Get an array element by index.
+     */
+    [[nodiscard]] auto at(const std::size_t index) const -> abf_value_view;
+    [[nodiscard]] auto operator[](const std::size_t index) const -> abf_value_view;
+
+    /*!
+     * Get an object value by key. Throws if the key was not found.
+     */
+    [[nodiscard]] auto at(const common::string_view &key) const -> abf_value_view;
+
+    [[nodiscard]] auto find(const common::string_view &key) const -> std::optional<abf_value_view>;
+    [[nodiscard]] auto contains(const common::string_view &key) const -> bool;
+
+    /*!
+     * Get the key and value of an object entry by index. The index is in insertion order.
+     */
+    [[nodiscard]] auto key_at(const std::size_t index) const -> common::string_view;
+    [[nodiscard]] auto value_at(const std::size_t index) const -> abf_value_view;
+
+    /*!
+     * Decode this value and everything below it into a property tree.
+     */
+    [[nodiscard]] auto to_property_tree(const abf_deserialize_mode mode = abf_deserialize_mode::all,
+                                        std::pmr::memory_resource *resource = std::pmr::get_default_resource()) const
+        -> property_tree;
+
+private:
+    friend class abf_view;
+
+    explicit abf_value_view(const std::span<const std::byte> data, const std::size_t offset);
+
+    [[nodiscard]] auto type() const noexcept -> std::uint8_t;
+    [[nodiscard]] auto checked_type(const std::uint8_t expected) const -> std::size_t;
+    [[nodiscard]] auto entry_key(const std::size_t entries_offset, const std::size_t index) const
+        -> common::string_view;
+
+    [[nodiscard]] auto to_property_tree(const abf_deserialize_mode mode, std::pmr::memory_resource *resource,
+                                        std::size_t &previous_offset) const -> property_tree;
+    [[nodiscard]] auto to_child_property_tree(const abf_deserialize_mode mode, std::pmr::memory_resource *resource,
+                                              std::size_t &previous_offset) const -> property_tree;
+
+    std::span<const std::byte> data_;
+    std::size_t offset_;
+};
+
+/*!
+ * A read-only view on ABF2 data (as written by to_abf with abf_version::v2) in memory. The data is queried in place,
+ * so this can be used directly on a memory mapped file or the contents of a memory_view_device.
+ */
+class abf_view final
+{
+public:
+    explicit abf_view(const std::span<const std::byte> data);
+    explicit abf_view(const std::span<const std::uint8_t> data);
+
+    ~abf_view() = default;
+
+    abf_view(const abf_view &) noexcept = default;
+    auto operator=(const abf_view &) noexcept -> abf_view & = default;
+
+    abf_view(abf_view &&) noexcept = default;
+    auto operator=(abf_view &&) noexcept -> abf_view & = default;
+
+    /*!
+     * Returns true if the given data starts with an ABF2 header.
+     */
+    [[nodiscard]] static auto is_abf2(const std::span<const std::byte> data) noexcept -> bool;
+
+    [[nodiscard]] auto root() const -> abf_value_view;
+
+private:
+    std::span<const std::byte> data_;
+};
+
+} // namespace aeon::ptree::serialization
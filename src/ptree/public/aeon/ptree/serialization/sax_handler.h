@@ -0,0 +1,135 @@
+// Distributed under the BSD 2-Clause License - Copyright 2012-2023 Robin Degen
+
+#pragma once
+
+#include <aeon/ptree/ptree.h>
+#include <aeon/common/string_view.h>
+#include <vector>
+#include <memory_resource>
+#include <cstddef>
+#include <cstdint>
+
+namespace aeon::ptree::serialization
+{
+
+/*!
+ * The default amount of bytes that event driven (SAX) parsers read from a stream at once.
+ */
+static constexpr std::size_t default_sax_chunk_size = 64 * 1024;
+
+/*!
+ * Receives the events of an event driven (SAX) parser like the json parser. All string views passed to the handler
+ * are only valid for the duration of the call.
+ *
+ * Every value inside of an object is preceded by a call to on_key.
+ */
+class sax_handler
+{
+public:
+    sax_handler() noexcept = default;
+    virtual ~sax_handler() = default;
+
+    sax_handler(const sax_handler &) noexcept = default;
+    auto operator=(const sax_handler &) noexcept -> sax_handler & = default;
+
+    sax_handler(sax_handler &&) noexcept = default;
+    auto operator=(sax_handler &&) noexcept -> sax_handler & = default;
+
+    virtual void on_start_object()
+    {
+    }
+
+    virtual void on_end_object()
+    {
+    }
+
+    virtual void on_start_array()
+    {
+    }
+
+    virtual void on_end_array()
+    {
+    }
+
+    virtual void on_key([[maybe_unused]] const common::string_view &key)
+    {
+    }
+
+    virtual void on_null()
+    {
+    }
+
+    virtual void on_bool([[maybe_unused]] const bool value)
+    {
+    }
+
+    virtual void on_integer([[maybe_unused]] const std::int64_t value)
+    {
+    }
+
+    virtual void on_double([[maybe_unused]] const double value)
+    {
+    }
+
+    virtual void on_string([[maybe_unused]] const common::string_view &value)
+    {
+    }
+};
+
+/*!
+ * A sax handler that builds a property tree from the received events. Only the containers that are currently open
+ * are kept on a stack, so besides the resulting tree itself the memory use is proportional to the nesting depth.
+ */
+class property_tree_builder final : public sax_handler
+{
+public:
+    /*!
+     * All arrays and objects of the resulting tree are allocated from the given memory resource. The memory
+     * resource must outlive the resulting tree.
+     */
+    explicit property_tree_builder(std::pmr::memory_resource *resource = std::pmr::get_default_resource());
+    ~property_tree_builder() final;
+
+    property_tree_builder(const property_tree_builder &) = delete;
+    auto operator=(const property_tree_builder &) -> property_tree_builder & = delete;
+
+    property_tree_builder(property_tree_builder &&) noexcept;
+    auto operator=(property_tree_builder &&) noexcept -> property_tree_builder &;
+
+    void on_start_object() final;
+    void on_end_object() final;
+    void on_start_array() final;
+    void on_end_array() final;
+    void on_key(const common::string_view &key) final;
+    void on_null() final;
+    void on_bool(const bool value) final;
+    void on_integer(const std::int64_t value) final;
+    void on_double(const double value) final;
+    void on_string(const common::string_view &value) final;
+
+    /*!
+     * Returns true if a complete value was received and all containers were closed.
+     */
+    [[nodiscard]] auto is_complete() const noexcept -> bool;
+
+    /*!
+     * Move the resulting property tree out of the builder. The builder can be reused afterwards.
+     */
+    [[nodiscard]] auto release() -> property_tree;
+
+private:
+    struct frame final
+    {
+        property_tree value;
+        string key;
+    };
+
+    void add_value(property_tree &&value);
+
+    std::pmr::memory_resource *resource_;
+    std::vector<frame> stack_;
+    property_tree result_;
+    bool complete_;
+};
+
+} // namespace aeon::ptree::serialization
@@ -4,6 +4,9 @@
 
 #include <aeon/ptree/ptree.h>
 #include <aeon/streams/idynamic_stream.h>
+#include <memory_resource>
+#include <vector>
+#include <cstdint>
 
 namespace aeon::ptree::serialization
 {
@@ -14,12 +17,37 @@ enum class abf_deserialize_mode
     skip_blobs
 };
 
-void to_abf(const property_tree &ptree, streams::idynamic_stream &stream);
-[[nodiscard]] auto to_abf(const property_tree &ptree) -> std::vector<std::uint8_t>;
+enum class abf_version
+{
+    /*!
+     * A compact stream of count prefixed values. It can only be read sequentially.
+     */
+    v1,
+
+    /*!
+     * Containers store offset tables and scalars are aligned, so that the data can be queried in place through
+     * abf_view without decoding the whole tree.
+     */
+    v2
+};
 
+void to_abf(const property_tree &ptree, streams::idynamic_stream &stream, const abf_version version = abf_version::v1);
+[[nodiscard]] auto to_abf(const property_tree &ptree, const abf_version version = abf_version::v1)
+    -> std::vector<std::uint8_t>;
+
+/*!
+ * Deserialize ABF data. Both ABF1 and ABF2 data can be read. To query ABF2 data without decoding it, use abf_view.
+ */
 void from_abf(streams::idynamic_stream &stream, property_tree &ptree,
               const abf_deserialize_mode mode = abf_deserialize_mode::all);
 [[nodiscard]] auto from_abf(streams::idynamic_stream &stream,
                             const abf_deserialize_mode mode = abf_deserialize_mode::all) -> property_tree;
 
+/*!
+ * Deserialize into a ptree of which all arrays, objects and blobs are allocated from the given memory resource.
+ * The memory resource must outlive the returned ptree.
+ */
+[[nodiscard]] auto from_abf(streams::idynamic_stream &stream, std::pmr::memory_resource *resource,
+                            const abf_deserialize_mode mode = abf_deserialize_mode::all) -> property_tree;
+
 } // namespace aeon::ptree::serialization
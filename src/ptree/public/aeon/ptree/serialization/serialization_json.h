@@ -3,20 +3,38 @@
 #pragma once
 
 #include <aeon/ptree/ptree.h>
+#include <aeon/ptree/serialization/sax_handler.h>
 #include <aeon/streams/idynamic_stream.h>
+#include <memory_resource>
+#include <cstddef>
 
 namespace aeon::ptree::serialization
 {
 
+enum class json_serialize_mode
+{
+    compact,
+    pretty
+};
+
+/*!
+ * Serialize a ptree to json. Note that a UUID will always serialize into a string due to limitations in JSON
+ */
+void to_json(const property_tree &ptree, streams::idynamic_stream &stream,
+             const json_serialize_mode mode = json_serialize_mode::compact);
+
 /*!
- * Deserialize a ptree to a json string. Note that a UUID will always serialize into a string due to limitations in JSON
+ * Serialize a ptree to json by appending to the given buffer. This allows for reusing the same buffer for multiple
+ * calls. Note that a UUID will always serialize into a string due to limitations in JSON
  */
-void to_json(const property_tree &ptree, streams::idynamic_stream &stream);
+void to_json(const property_tree &ptree, common::string &buffer,
+             const json_serialize_mode mode = json_serialize_mode::compact);
 
 /*!
- * Deserialize a ptree to a json string. Note that a UUID will always serialize into a string due to limitations in JSON
+ * Serialize a ptree to a json string. Note that a UUID will always serialize into a string due to limitations in JSON
  */
-[[nodiscard]] auto to_json(const property_tree &ptree) -> common::string;
+[[nodiscard]] auto to_json(const property_tree &ptree, const json_serialize_mode mode = json_serialize_mode::compact)
+    -> common::string;
 
 /*!
  * Deserialize a string to a ptree. Note that a UUID will always deserialize into a string due to limitations in JSON
@@ -28,6 +46,21 @@ void from_json(streams::idynamic_stream &stream, property_tree &ptree);
  */
 [[nodiscard]] auto from_json(streams::idynamic_stream &stream) -> property_tree;
 
+/*!
+ * Deserialize a stream to a ptree of which all arrays and objects are allocated from the given memory resource. This
+ * allows for parsing into an arena like std::pmr::monotonic_buffer_resource. The memory resource must outlive the
+ * returned ptree.
+ */
+[[nodiscard]] auto from_json(streams::idynamic_stream &stream, std::pmr::memory_resource *resource) -> property_tree;
+
+/*!
+ * Parse json from a stream and report the contents to the given handler as events, without building a ptree.
+ * The stream is read in chunks of the given size, so the memory use is proportional to the nesting depth and
+ * the largest single string or number instead of the size of the document.
+ */
+void from_json(streams::idynamic_stream &stream, sax_handler &handler,
+               const std::size_t chunk_size = default_sax_chunk_size);
+
 /*!
  * Deserialize a string to a ptree. Note that a UUID will always deserialize into a string due to limitations in JSON
  */
@@ -4,8 +4,12 @@
 
 #include <aeon/ptree/ptree.h>
 #include <aeon/ptree/serialization/exception.h>
+#include <aeon/ptree/serialization/sax_handler.h>
+#include <aeon/ptree/serialization/xml_sax_handler.h>
 #include <aeon/ptree/xml_dom/xml_document.h>
 #include <aeon/streams/idynamic_stream.h>
+#include <memory_resource>
+#include <cstddef>
 
 namespace aeon::ptree::serialization
 {
@@ -31,7 +35,23 @@ void from_xml(streams::idynamic_stream &stream, property_tree &ptree,
               common::string attribute_placeholder = xml_dom::attribute_placeholder_name);
 auto from_xml(streams::idynamic_stream &stream,
               common::string attribute_placeholder = xml_dom::attribute_placeholder_name) -> property_tree;
+/*!
+ * Deserialize a stream to a ptree of which all arrays and objects are allocated from the given memory resource. This
+ * allows for parsing into an arena like std::pmr::monotonic_buffer_resource. The memory resource must outlive the
+ * returned ptree.
+ */
+auto from_xml(streams::idynamic_stream &stream, std::pmr::memory_resource *resource,
+              common::string attribute_placeholder = xml_dom::attribute_placeholder_name) -> property_tree;
+
 auto from_xml(const common::string &str, common::string attribute_placeholder = xml_dom::attribute_placeholder_name)
     -> property_tree;
 
+/*!
+ * Parse xml from a stream and report the contents to the given handler as events, without building a ptree.
+ * The stream is read in chunks of the given size, so the memory use is proportional to the nesting depth and
+ * the largest single text node instead of the size of the document.
+ */
+void from_xml(streams::idynamic_stream &stream, xml_sax_handler &handler,
+              const std::size_t chunk_size = default_sax_chunk_size);
+
 } // namespace aeon::ptree::serialization
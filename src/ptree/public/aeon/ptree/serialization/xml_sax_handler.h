@@ -0,0 +1,122 @@
+// Distributed under the BSD 2-Clause License - Copyright 2012-2023 Robin Degen
+
+#pragma once
+
+#include <aeon/ptree/ptree.h>
+#include <aeon/ptree/xml_dom/xml_document.h>
+#include <aeon/common/string_view.h>
+#include <aeon/common/string.h>
+#include <vector>
+#include <memory_resource>
+
+namespace aeon::ptree::serialization
+{
+
+/*!
+ * Receives the events of the event driven (SAX) xml parser. All string views passed to the handler are only valid
+ * for the duration of the call.
+ *
+ * Attributes are reported through on_attribute directly after on_start_element or on_start_declaration. Text is
+ * reported trimmed; whitespace-only text is not reported at all.
+ */
+class xml_sax_handler
+{
+public:
+    xml_sax_handler() noexcept = default;
+    virtual ~xml_sax_handler() = default;
+
+    xml_sax_handler(const xml_sax_handler &) noexcept = default;
+    auto operator=(const xml_sax_handler &) noexcept -> xml_sax_handler & = default;
+
+    xml_sax_handler(xml_sax_handler &&) noexcept = default;
+    auto operator=(xml_sax_handler &&) noexcept -> xml_sax_handler & = default;
+
+    /*!
+     * Called for the <?xml ... ?> declaration. The attributes of the declaration are reported through on_attribute.
+     */
+    virtual void on_start_declaration()
+    {
+    }
+
+    virtual void on_end_declaration()
+    {
+    }
+
+    virtual void on_start_element([[maybe_unused]] const common::string_view &name)
+    {
+    }
+
+    virtual void on_attribute([[maybe_unused]] const common::string_view &name,
+                              [[maybe_unused]] const common::string_view &value)
+    {
+    }
+
+    /*!
+     * Called when an element is closed. Self closing elements (<element/>) are reported with self_closing set to
+     * true and never have child nodes.
+     */
+    virtual void on_end_element([[maybe_unused]] const common::string_view &name,
+                                [[maybe_unused]] const bool self_closing)
+    {
+    }
+
+    virtual void on_text([[maybe_unused]] const common::string_view &text)
+    {
+    }
+
+    virtual void on_cdata([[maybe_unused]] const common::string_view &data)
+    {
+    }
+};
+
+/*!
+ * An xml sax handler that builds a property tree from the received events. The resulting tree has the same layout as
+ * the tree returned by from_xml, and can be used with xml_dom::xml_document.
+ */
+class xml_property_tree_builder final : public xml_sax_handler
+{
+public:
+    /*!
+     * All arrays and objects of the resulting tree are allocated from the given memory resource. The memory
+     * resource must outlive the resulting tree.
+     */
+    explicit xml_property_tree_builder(common::string attribute_placeholder = xml_dom::attribute_placeholder_name,
+                                       std::pmr::memory_resource *resource = std::pmr::get_default_resource());
+    ~xml_property_tree_builder() final;
+
+    xml_property_tree_builder(const xml_property_tree_builder &) = delete;
+    auto operator=(const xml_property_tree_builder &) -> xml_property_tree_builder & = delete;
+
+    xml_property_tree_builder(xml_property_tree_builder &&) noexcept;
+    auto operator=(xml_property_tree_builder &&) noexcept -> xml_property_tree_builder &;
+
+    void on_start_declaration() final;
+    void on_end_declaration() final;
+    void on_start_element(const common::string_view &name) final;
+    void on_attribute(const common::string_view &name, const common::string_view &value) final;
+    void on_end_element(const common::string_view &name, const bool self_closing) final;
+    void on_text(const common::string_view &text) final;
+    void on_cdata(const common::string_view &data) final;
+
+    /*!
+     * Move the resulting property tree out of the builder. The builder can be reused afterwards.
+     */
+    [[nodiscard]] auto release() -> property_tree;
+
+private:
+    struct frame final
+    {
+        string name;
+        array children;
+        object attributes;
+    };
+
+    [[nodiscard]] auto make_frame(const common::string_view &name) const -> frame;
+    [[nodiscard]] auto make_object(string key, property_tree &&value) const -> object;
+
+    common::string attribute_placeholder_;
+    std::pmr::memory_resource *resource_;
+    std::vector<frame> stack_;
+};
+
+} // namespace aeon::ptree::serialization
@@ -40,7 +40,7 @@ public:
 
     [[nodiscard]] auto has_name() const noexcept -> bool;
 
-    [[nodiscard]] auto name() const -> const common::string &;
+    [[nodiscard]] auto name() const -> common::string_view;
 
     [[nodiscard]] auto has_value() const noexcept -> bool;
 
@@ -49,11 +49,11 @@ public:
     {
         if constexpr (std::is_same_v<T, common::string>)
         {
-            return value_impl();
+            return common::string{value_impl()};
         }
         else
         {
-            variant::converting_variant value{value_impl()};
+            variant::converting_variant value{common::string{value_impl()}};
             return value.get_value<T>();
         }
     }
@@ -73,15 +73,15 @@ public:
 protected:
     explicit xml_node(const xml_document &document) noexcept;
     explicit xml_node(const xml_document &document, const property_tree &pt, const xml_node_type type) noexcept;
-    explicit xml_node(const xml_document &document, const property_tree &pt, const common::string &name,
+    explicit xml_node(const xml_document &document, const property_tree &pt, const string &name,
                       const xml_node_type type) noexcept;
 
-    [[nodiscard]] auto value_impl() const -> const common::string &;
+    [[nodiscard]] auto value_impl() const -> common::string_view;
 
 private:
     const xml_document *document_;
     const property_tree *pt_;
-    const common::string *name_;
+    const string *name_;
     xml_node_type type_;
 };
 
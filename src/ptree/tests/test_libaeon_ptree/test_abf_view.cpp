@@ -0,0 +1,147 @@
+// Distributed under the BSD 2-Clause License - Copyright 2012-2023 Robin Degen
+
+#include <aeon/ptree/ptree.h>
+#include <aeon/ptree/serialization/serialization_abf.h>
+#include <aeon/ptree/serialization/abf_view.h>
+#include <aeon/streams/dynamic_stream.h>
+#include <aeon/streams/devices/memory_view_device.h>
+#include <gtest/gtest.h>
+#include <string>
+#include <cstring>
+
+using namespace aeon;
+
+namespace
+{
+
+const ptree::property_tree pt{
+    {{"test", 3},
+     {"test2", 2.0},
+     {"negative", -1234567890123},
+     {"data", ptree::blob{0x01, 0x02, 0x03, 0x04, 0x05}},
+     {"uuid", common::uuid::generate()},
+     {"empty", ptree::object{}},
+     {"test3", ptree::object{{"hello", ptree::array{1, 2, 3, 4}},
+                             {"hello3", ptree::array{ptree::object{{"henk", true}}, nullptr,
+                                                     ptree::object{{"henk2", "string\ttest\nhello"}}}}}}}};
+
+} // namespace
+
+TEST(test_ptree_abf_view, round_trip)
+{
+    const auto abf = ptree::serialization::to_abf(pt, ptree::serialization::abf_version::v2);
+    auto device = streams::make_dynamic_stream(streams::memory_view_device{abf});
+    EXPECT_EQ(pt, ptree::serialization::from_abf(device));
+}
+
+TEST(test_ptree_abf_view, read_abf1)
+{
+    const auto abf = ptree::serialization::to_abf(pt, ptree::serialization::abf_version::v1);
+    EXPECT_FALSE(ptree::serialization::abf_view::is_abf2(std::as_bytes(std::span{abf})));
+
+    auto device = streams::make_dynamic_stream(streams::memory_view_device{abf});
+    EXPECT_EQ(pt, ptree::serialization::from_abf(device));
+}
+
+TEST(test_ptree_abf_view, query_in_place)
+{
+    const auto abf = ptree::serialization::to_abf(pt, ptree::serialization::abf_version::v2);
+    const ptree::serialization::abf_view view{abf};
+    const auto root = view.root();
+
+    ASSERT_TRUE(root.is_object());
+    EXPECT_EQ(std::size(pt.object_value()), root.size());
+    EXPECT_EQ(3, root.at("test").integer_value());
+    EXPECT_EQ(2.0, root.at("test2").double_value());
+    EXPECT_EQ(-1234567890123, root.at("negative").integer_value());
+    EXPECT_EQ(pt.at("uuid").uuid_value(), root.at("uuid").uuid_value());
+    EXPECT_FALSE(root.contains("does_not_exist"));
+    EXPECT_THROW([[maybe_unused]] auto result = root.at("does_not_exist"), std::out_of_range);
+
+    const auto data = root.at("data").blob_value();
+    const auto &expected_data = pt.at("data").blob_value();
+    EXPECT_TRUE(std::equal(std::begin(data), std::end(data), std::begin(expected_data), std::end(expected_data)));
+
+    // Keys are returned in insertion order.
+    EXPECT_EQ("test", root.key_at(0));
+    EXPECT_EQ("test3", root.key_at(root.size() - 1));
+
+    const auto hello = root.at("test3").at("hello");
+    ASSERT_TRUE(hello.is_array());
+    ASSERT_EQ(4u, hello.size());
+    EXPECT_EQ(3, hello[2].integer_value());
+    EXPECT_THROW([[maybe_unused]] auto result = hello.at(4), std::out_of_range);
+
+    const auto hello3 = root.at("test3").at("hello3");
+    EXPECT_TRUE(hello3[0].at("henk").bool_value());
+    EXPECT_TRUE(hello3[1].is_null());
+    EXPECT_EQ("string\ttest\nhello", hello3[2].at("henk2").string_value());
+
+    EXPECT_EQ(0u, root.at("empty").size());
+    EXPECT_EQ(pt.at("test3"), root.at("test3").to_property_tree());
+}
+
+TEST(test_ptree_abf_view, large_object_lookup)
+{
+    ptree::object obj;
+
+    for (auto i = 0; i < 1000; ++i)
+        obj.insert(ptree::string{"key_" + std::to_string(i)}, i);
+
+    const auto abf = ptree::serialization::to_abf(obj, ptree::serialization::abf_version::v2);
+    const auto root = ptree::serialization::abf_view{abf}.root();
+
+    for (auto i = 0; i < 1000; ++i)
+        EXPECT_EQ(i, root.at(common::string{"key_" + std::to_string(i)}).integer_value());
+}
+
+TEST(test_ptree_abf_view, skip_blobs)
+{
+    const auto abf = ptree::serialization::to_abf(pt, ptree::serialization::abf_version::v2);
+    auto device = streams::make_dynamic_stream(streams::memory_view_device{abf});
+    const auto pt2 = ptree::serialization::from_abf(device, ptree::serialization::abf_deserialize_mode::skip_blobs);
+
+    ASSERT_TRUE(pt2.at("data").is_blob());
+    EXPECT_TRUE(std::empty(pt2.at("data").blob_value()));
+}
+
+TEST(test_ptree_abf_view, truncated_data)
+{
+    const auto abf = ptree::serialization::to_abf(pt, ptree::serialization::abf_version::v2);
+
+    for (const auto size : {std::size_t{4}, std::size(abf) / 2, std::size(abf) - 1})
+    {
+        const std::span<const std::uint8_t> truncated{std::data(abf), size};
+
+        EXPECT_THROW(
+            {
+                const ptree::serialization::abf_view view{truncated};
+                [[maybe_unused]] const auto result = view.root().to_property_tree();
+            },
+            ptree::serialization::ptree_serialization_exception);
+    }
+}
+
+TEST(test_ptree_abf_view, shared_nodes_are_rejected)
+{
+    auto abf = ptree::serialization::to_abf(ptree::array{ptree::array{1}, ptree::array{2}},
+                                            ptree::serialization::abf_version::v2);
+
+    const auto read_offset = [&abf](const std::size_t offset)
+    {
+        std::uint64_t value = 0;
+        std::memcpy(&value, std::data(abf) + offset, sizeof(value));
+        return static_cast<std::size_t>(value);
+    };
+
+    // Let the first array point to the element of the second array, so that the same node is referenced twice.
+    const auto root = read_offset(8);
+    const auto first = read_offset(root + 16);
+    const auto second = read_offset(root + 24);
+    std::memcpy(std::data(abf) + first + 16, std::data(abf) + second + 16, sizeof(std::uint64_t));
+
+    const ptree::serialization::abf_view view{abf};
+    EXPECT_EQ(2, view.root()[0][0].integer_value());
+    EXPECT_THROW([[maybe_unused]] const auto result = view.root().to_property_tree(),
+                 ptree::serialization::ptree_serialization_exception);
+}
@@ -0,0 +1,164 @@
+// Distributed under the BSD 2-Clause License - Copyright 2012-2023 Robin Degen
+
+#include <aeon/ptree/ptree.h>
+#include <aeon/ptree/serialization/serialization_abf.h>
+#include <aeon/ptree/serialization/serialization_json.h>
+#include <aeon/ptree/serialization/serialization_xml.h>
+#include <aeon/streams/devices/memory_view_device.h>
+#include <aeon/streams/dynamic_stream.h>
+#include <gtest/gtest.h>
+#include <memory_resource>
+#include <array>
+
+using namespace aeon;
+
+namespace
+{
+
+/*!
+ * Returns true if all arrays, objects, blobs, strings and keys in the given tree use the given memory resource.
+ */
+[[nodiscard]] auto uses_resource(const ptree::property_tree &pt, const std::pmr::memory_resource *resource) -> bool
+{
+    if (pt.is_array())
+    {
+        if (pt.array_value().get_allocator().resource() != resource)
+            return false;
+
+        for (const auto &value : pt.array_value())
+        {
+            if (!uses_resource(value, resource))
+                return false;
+        }
+    }
+    else if (pt.is_object())
+    {
+        if (pt.object_value().get_allocator().resource() != resource)
+            return false;
+
+        for (const auto &[key, value] : pt.object_value())
+        {
+            if (key.get_allocator().resource() != resource)
+                return false;
+
+            if (!uses_resource(value, resource))
+                return false;
+        }
+    }
+    else if (pt.is_blob())
+    {
+        return pt.blob_value().get_allocator().resource() == resource;
+    }
+    else if (pt.is_string())
+    {
+        return std::get<ptree::string>(pt.value()).get_allocator().resource() == resource;
+    }
+
+    return true;
+}
+
+const ptree::property_tree test_data{
+    {{"test", 3},
+     {"test2", 2.0},
+     {"data", ptree::blob{0x01, 0x02, 0x03}},
+     {"test3", ptree::object{{"hello", ptree::array{1, 2, 3, 4}},
+                             {"hello3", ptree::array{ptree::object{{"henk", true}}, nullptr,
+                                                     ptree::object{{"henk2", "string\ttest\nhello"}}}}}}}};
+
+} // namespace
+
+TEST(test_ptree_pmr, default_resource)
+{
+    EXPECT_TRUE(uses_resource(test_data, std::pmr::get_default_resource()));
+}
+
+TEST(test_ptree_pmr, copy_with_allocator)
+{
+    std::array<std::byte, 4096> buffer;
+    std::pmr::monotonic_buffer_resource arena{std::data(buffer), std::size(buffer), std::pmr::null_memory_resource()};
+
+    const ptree::property_tree copy{test_data, &arena};
+    EXPECT_EQ(test_data, copy);
+    EXPECT_TRUE(uses_resource(copy, &arena));
+
+    // A regular copy does not inherit the memory resource.
+    const auto copy2 = copy;
+    EXPECT_EQ(test_data, copy2);
+    EXPECT_TRUE(uses_resource(copy2, std::pmr::get_default_resource()));
+}
+
+TEST(test_ptree_pmr, insert_into_arena_container)
+{
+    std::pmr::monotonic_buffer_resource arena;
+
+    ptree::array arr(&arena);
+    arr.push_back(test_data);
+    arr.emplace_back(ptree::array{1, 2, 3});
+    arr.emplace_back();
+
+    ptree::object obj(&arena);
+    obj.emplace("key", ptree::object{{"a", ptree::array{1}}});
+    obj["arr"] = std::move(arr);
+
+    const ptree::property_tree pt{std::move(obj)};
+    EXPECT_TRUE(uses_resource(pt, &arena));
+    EXPECT_EQ(test_data, pt.at("arr").array_value().at(0));
+}
+
+TEST(test_ptree_pmr, from_json)
+{
+    // Blobs are not supported by json.
+    const auto &expected = test_data.at("test3");
+    const auto json = ptree::serialization::to_json(expected);
+    auto stream = streams::make_dynamic_stream(streams::memory_view_device{json});
+
+    std::pmr::monotonic_buffer_resource arena;
+    const auto pt = ptree::serialization::from_json(stream, &arena);
+
+    EXPECT_EQ(expected, pt);
+    EXPECT_TRUE(uses_resource(pt, &arena));
+}
+
+TEST(test_ptree_pmr, from_abf)
+{
+    const auto abf = ptree::serialization::to_abf(test_data);
+    auto stream = streams::make_dynamic_stream(streams::memory_view_device{abf});
+
+    std::pmr::monotonic_buffer_resource arena;
+    const auto pt = ptree::serialization::from_abf(stream, &arena);
+
+    EXPECT_EQ(test_data, pt);
+    EXPECT_TRUE(uses_resource(pt, &arena));
+}
+
+TEST(test_ptree_pmr, from_xml)
+{
+    const common::string xml = R"(<?xml version="1.0"?><root a="1"><child b="2"/><child>text</child></root>)";
+    auto stream = streams::make_dynamic_stream(streams::memory_view_device{xml});
+
+    std::pmr::monotonic_buffer_resource arena;
+    const auto pt = ptree::serialization::from_xml(stream, &arena);
+
+    EXPECT_EQ(ptree::serialization::from_xml(xml), pt);
+    EXPECT_TRUE(uses_resource(pt, &arena));
+}
+
+TEST(test_ptree_pmr, long_strings_are_allocated_from_the_arena)
+{
+    const ptree::string long_string(256, 'x');
+    const ptree::property_tree expected{
+        ptree::object{{long_string, long_string}, {"values", ptree::array{long_string}}}};
+    const auto json = ptree::serialization::to_json(expected);
+    auto stream = streams::make_dynamic_stream(streams::memory_view_device{json});
+
+    std::pmr::monotonic_buffer_resource arena;
+
+    // Anything in the tree that is not allocated from the arena would now throw.
+    auto *const previous_resource = std::pmr::set_default_resource(std::pmr::null_memory_resource());
+    const auto pt = ptree::serialization::from_json(stream, &arena);
+    std::pmr::set_default_resource(previous_resource);
+
+    EXPECT_EQ(expected, pt);
+    EXPECT_TRUE(uses_resource(pt, &arena));
+    EXPECT_EQ(long_string, pt.at(long_string).string_value());
+}
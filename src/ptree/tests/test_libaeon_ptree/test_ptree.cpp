@@ -39,6 +39,30 @@ TEST(test_ptree, json_serialize_deserialize_complex)
     EXPECT_EQ(str, str2);
 }
 
+TEST(test_ptree, json_serialize_double_round_trip)
+{
+    const ptree::property_tree pt{ptree::array{0.1, 1.0 / 3.0, 2.0, -1.5e300, 123456789.125}};
+    const auto str = ptree::serialization::to_json(pt);
+    EXPECT_EQ(R"([0.1,0.3333333333333333,2.0,-1.5e+300,123456789.125])", str);
+    EXPECT_EQ(pt, ptree::serialization::from_json(str));
+}
+
+TEST(test_ptree, json_serialize_escape)
+{
+    const ptree::property_tree pt{"A long string that is \"quoted\" and has a /path/ and a \x01 control character."};
+    const auto str = ptree::serialization::to_json(pt);
+    EXPECT_EQ(R"("A long string that is \"quoted\" and has a \/path\/ and a \u0001 control character.")", str);
+    EXPECT_EQ(pt, ptree::serialization::from_json(str));
+}
+
+TEST(test_ptree, json_serialize_pretty)
+{
+    const ptree::property_tree pt{{{"a", 1}, {"b", ptree::array{true, ptree::object{}}}, {"c", ptree::array{}}}};
+    const auto str = ptree::serialization::to_json(pt, ptree::serialization::json_serialize_mode::pretty);
+    EXPECT_EQ("{\n    \"a\": 1,\n    \"b\": [\n        true,\n        {}\n    ],\n    \"c\": []\n}", str);
+    EXPECT_EQ(pt, ptree::serialization::from_json(str));
+}
+
 TEST(test_ptree, abf_serialize_deserialize_simple)
 {
     const auto data = ptree::serialization::to_abf(pt_simple);
@@ -0,0 +1,223 @@
+// Distributed under the BSD 2-Clause License - Copyright 2012-2023 Robin Degen
+
+#include <aeon/ptree/ptree.h>
+#include <aeon/ptree/serialization/serialization_json.h>
+#include <aeon/ptree/serialization/serialization_xml.h>
+#include <aeon/ptree/serialization/sax_handler.h>
+#include <aeon/ptree/serialization/xml_sax_handler.h>
+#include <aeon/streams/devices/memory_view_device.h>
+#include <aeon/streams/devices/file_device.h>
+#include <aeon/streams/dynamic_stream.h>
+#include <gtest/gtest.h>
+#include <vector>
+
+#include <ptree_unittest_data.h>
+
+using namespace aeon;
+
+namespace
+{
+
+class json_event_recorder final : public ptree::serialization::sax_handler
+{
+public:
+    void on_start_object() final
+    {
+        events.emplace_back("{");
+    }
+
+    void on_end_object() final
+    {
+        events.emplace_back("}");
+    }
+
+    void on_start_array() final
+    {
+        events.emplace_back("[");
+    }
+
+    void on_end_array() final
+    {
+        events.emplace_back("]");
+    }
+
+    void on_key(const common::string_view &key) final
+    {
+        events.push_back("key:" + common::string{key});
+    }
+
+    void on_null() final
+    {
+        events.emplace_back("null");
+    }
+
+    void on_bool(const bool value) final
+    {
+        events.emplace_back(value ? "true" : "false");
+    }
+
+    void on_integer(const std::int64_t value) final
+    {
+        events.push_back("int:" + common::string{std::to_string(value)});
+    }
+
+    void on_double(const double value) final
+    {
+        events.push_back("double:" + common::string{std::to_string(value)});
+    }
+
+    void on_string(const common::string_view &value) final
+    {
+        events.push_back("string:" + common::string{value});
+    }
+
+    std::vector<common::string> events;
+};
+
+class xml_event_recorder final : public ptree::serialization::xml_sax_handler
+{
+public:
+    void on_start_element(const common::string_view &name) final
+    {
+        events.push_back("<" + common::string{name});
+    }
+
+    void on_attribute(const common::string_view &name, const common::string_view &value) final
+    {
+        events.push_back(common::string{name} + "=" + common::string{value});
+    }
+
+    void on_end_element(const common::string_view &name, const bool self_closing) final
+    {
+        events.push_back((self_closing ? "/>" : "</") + common::string{name});
+    }
+
+    void on_text(const common::string_view &text) final
+    {
+        events.push_back("text:" + common::string{text});
+    }
+
+    void on_cdata(const common::string_view &data) final
+    {
+        events.push_back("cdata:" + common::string{data});
+    }
+
+    std::vector<common::string> events;
+};
+
+} // namespace
+
+TEST(test_ptree_sax, json_events)
+{
+    const common::string json =
+        R"({"name": "he\"llo\u0041", "values": [1, -2, 3.5, 1e2, true, false, null], "empty": {}, "nested": [[]]})";
+    const std::vector<common::string> expected{"{",
+                                               "key:name",
+                                               "string:he\"lloA",
+                                               "key:values",
+                                               "[",
+                                               "int:1",
+                                               "int:-2",
+                                               "double:3.500000",
+                                               "double:100.000000",
+                                               "true",
+                                               "false",
+                                               "null",
+                                               "]",
+                                               "key:empty",
+                                               "{",
+                                               "}",
+                                               "key:nested",
+                                               "[",
+                                               "[",
+                                               "]",
+                                               "]",
+                                               "}"};
+
+    // Small chunk sizes split every token across chunk boundaries.
+    for (const std::size_t chunk_size : {1, 2, 3, 7, 4096})
+    {
+        auto stream = streams::make_dynamic_stream(streams::memory_view_device{json});
+        json_event_recorder recorder;
+        ptree::serialization::from_json(stream, recorder, chunk_size);
+        EXPECT_EQ(expected, recorder.events);
+    }
+}
+
+TEST(test_ptree_sax, json_builder_matches_from_json)
+{
+    const ptree::property_tree pt{
+        {{"test", 3},
+         {"test2", 2.0},
+         {"test3", ptree::object{{"he\\llo", ptree::array{1, 2, 3, 4}},
+                                 {"hello3", ptree::array{ptree::object{{"henk", true}}, nullptr,
+                                                         ptree::object{{"henk2", "string\ttest\nhello"}}}}}}}};
+
+    const auto str = ptree::serialization::to_json(pt);
+
+    for (const std::size_t chunk_size : {1, 5, 4096})
+    {
+        auto stream = streams::make_dynamic_stream(streams::memory_view_device{str});
+        ptree::serialization::property_tree_builder builder;
+        ptree::serialization::from_json(stream, builder, chunk_size);
+        ASSERT_TRUE(builder.is_complete());
+        EXPECT_EQ(pt, builder.release());
+    }
+}
+
+TEST(test_ptree_sax, json_invalid)
+{
+    for (const common::string json : {"", "{", "[1,]", "{\"a\"}", "{\"a\":}", "\"abc", "tru", "[1 2]", "\"\\ud800\""})
+    {
+        auto stream = streams::make_dynamic_stream(streams::memory_view_device{json});
+        json_event_recorder recorder;
+        EXPECT_THROW(ptree::serialization::from_json(stream, recorder, 2),
+                     ptree::serialization::ptree_serialization_exception);
+    }
+}
+
+TEST(test_ptree_sax, xml_events)
+{
+    const common::string xml = R"(<?xml version="1.0"?><root a="1"><!-- comment --><child b='2'/>)"
+                               R"(  some text <data><![CDATA[<raw>]]></data></root>)";
+    const std::vector<common::string> expected{
+        "version=1.0", "<root", "a=1", "<child", "b=2", "/>child", "text:some text", "<data", "cdata:<raw>", "</data",
+        "</root"};
+
+    for (const std::size_t chunk_size : {1, 2, 3, 4096})
+    {
+        auto stream = streams::make_dynamic_stream(streams::memory_view_device{xml});
+        xml_event_recorder recorder;
+        ptree::serialization::from_xml(stream, recorder, chunk_size);
+        EXPECT_EQ(expected, recorder.events);
+    }
+}
+
+TEST(test_ptree_sax, xml_builder_matches_from_xml)
+{
+    const auto result = [](const std::size_t chunk_size)
+    {
+        auto stream =
+            streams::make_dynamic_stream(streams::file_source_device{AEON_PTREE_UNITTEST_DATA_PATH "simple_xml.xml"});
+        ptree::serialization::xml_property_tree_builder builder;
+        ptree::serialization::from_xml(stream, builder, chunk_size);
+        return builder.release();
+    };
+
+    auto stream =
+        streams::make_dynamic_stream(streams::file_source_device{AEON_PTREE_UNITTEST_DATA_PATH "simple_xml.xml"});
+    const auto expected = ptree::serialization::from_xml(stream);
+
+    EXPECT_EQ(expected, result(1));
+    EXPECT_EQ(expected, result(3));
+    EXPECT_EQ(expected, result(ptree::serialization::default_sax_chunk_size));
+}
+
+TEST(test_ptree_sax, xml_mismatched_closing_tag)
+{
+    const common::string xml = "<a><b></a></b>";
+    auto stream = streams::make_dynamic_stream(streams::memory_view_device{xml});
+    xml_event_recorder recorder;
+    EXPECT_THROW(ptree::serialization::from_xml(stream, recorder),
+                 ptree::serialization::ptree_xml_deserialize_exception);
+}
@@ -0,0 +1,145 @@
+// Distributed under the BSD 2-Clause License - Copyright 2012-2023 Robin Degen
+
+#include <benchmark/benchmark.h>
+
+#include <aeon/sockets/length_prefixed_binary_protocol_socket.h>
+#include <asio.hpp>
+#include <algorithm>
+#include <memory>
+#include <vector>
+#include <cstdint>
+
+using namespace aeon;
+
+namespace
+{
+
+template <sockets::length_prefix length_t>
+class zero_copy_socket final : public sockets::length_prefixed_binary_protocol_socket<length_t>
+{
+public:
+    explicit zero_copy_socket(asio::io_context &context)
+        : sockets::length_prefixed_binary_protocol_socket<length_t>{context}
+        , frames{0}
+    {
+    }
+
+    void on_receive_frame(sockets::pooled_buffer frame) override
+    {
+        benchmark::DoNotOptimize(std::data(frame));
+        ++frames;
+    }
+
+    std::size_t frames;
+};
+
+/*!
+ * Uses the on_frame callback, which gets a copy of every frame in a vector.
+ */
+class copying_socket final : public sockets::length_prefixed_binary_protocol_socket<std::uint32_t>
+{
+public:
+    explicit copying_socket(asio::io_context &context)
+        : length_prefixed_binary_protocol_socket{context}
+        , frames{0}
+    {
+    }
+
+    void on_frame(const streams::memory_view_device<std::vector<std::byte>> &frame) override
+    {
+        benchmark::DoNotOptimize(std::data(frame.data()));
+        ++frames;
+    }
+
+    std::size_t frames;
+};
+
+/*!
+ * A read of 64KB that is filled with frames of the given size. The last frame is split over the next read.
+ */
+template <sockets::length_prefix length_t>
+[[nodiscard]] auto make_reads(const std::size_t frame_size, std::size_t &frame_count)
+    -> std::vector<sockets::pooled_buffer>
+{
+    constexpr std::size_t read_size = 64 * 1024;
+
+    std::vector<std::byte> stream;
+    const std::vector payload(frame_size, std::byte{'x'});
+
+    while (std::size(stream) < read_size * 4)
+    {
+        sockets::length_prefixed_binary_frame<length_t> frame{frame_size};
+        frame.vector_write(payload);
+        const auto data = frame.release();
+        stream.insert(std::end(stream), std::begin(data), std::end(data));
+        ++frame_count;
+    }
+
+    std::vector<sockets::pooled_buffer> reads;
+
+    for (std::size_t offset = 0; offset < std::size(stream); offset += read_size)
+    {
+        const auto size = std::min(read_size, std::size(stream) - offset);
+        auto buffer = sockets::get_buffer_pool().acquire(size);
+        std::copy_n(std::data(stream) + offset, size, std::data(buffer));
+        reads.push_back(std::move(buffer));
+    }
+
+    return reads;
+}
+
+template <typename socket_t, sockets::length_prefix length_t>
+void run_decode_benchmark(benchmark::State &state)
+{
+    std::size_t frame_count = 0;
+    const auto reads = make_reads<length_t>(static_cast<std::size_t>(state.range(0)), frame_count);
+
+    asio::io_context context;
+    auto socket = std::make_shared<socket_t>(context);
+
+    for ([[maybe_unused]] auto _ : state)
+    {
+        for (const auto &read : reads)
+            socket->on_receive(read);
+    }
+
+    if (socket->frames != state.iterations() * frame_count)
+        state.SkipWithError("Not all frames were decoded.");
+
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * frame_count));
+}
+
+} // namespace
+
+/*!
+ * Frames passed on as slices of the read buffer.
+ * Arguments: frame size.
+ */
+static void BM_length_prefixed_decode_zero_copy(benchmark::State &state)
+{
+    run_decode_benchmark<zero_copy_socket<std::uint32_t>, std::uint32_t>(state);
+}
+
+BENCHMARK(BM_length_prefixed_decode_zero_copy)->Arg(16)->Arg(64)->Arg(256);
+
+/*!
+ * The same with varint length prefixes.
+ * Arguments: frame size.
+ */
+static void BM_length_prefixed_decode_varint(benchmark::State &state)
+{
+    run_decode_benchmark<zero_copy_socket<sockets::varint_length>, sockets::varint_length>(state);
+}
+
+BENCHMARK(BM_length_prefixed_decode_varint)->Arg(16)->Arg(64)->Arg(256);
+
+/*!
+ * Frames copied into a vector and passed on through on_frame.
+ * Arguments: frame size.
+ */
+static void BM_length_prefixed_decode_copy(benchmark::State &state)
+{
+    run_decode_benchmark<copying_socket, std::uint32_t>(state);
+}
+
+BENCHMARK(BM_length_prefixed_decode_copy)->Arg(16)->Arg(64)->Arg(256);
@@ -0,0 +1,245 @@
+// Distributed under the BSD 2-Clause License - Copyright 2012-2023 Robin Degen
+
+#include <benchmark/benchmark.h>
+
+#include <aeon/sockets/tcp_server.h>
+#include <aeon/sockets/tcp_client.h>
+#include <aeon/sockets/local_server.h>
+#include <aeon/sockets/local_client.h>
+#include <aeon/sockets/shared_memory_ring.h>
+#include <aeon/common/platform.h>
+#include <asio.hpp>
+#include <filesystem>
+#include <thread>
+#include <vector>
+#include <string>
+#include <memory>
+#include <cstring>
+#include <cstdint>
+
+#if (defined(AEON_PLATFORM_OS_LINUX))
+#include <unistd.h>
+#endif
+
+using namespace aeon;
+
+/*
+ * All transports are measured the same way: the client sends a message of the given size and waits for the server to
+ * acknowledge it with a single byte. With small messages this measures the round trip latency of the transport; with
+ * large messages the throughput.
+ */
+
+namespace
+{
+
+constexpr std::uint16_t benchmark_port = 38282;
+
+struct transport_session
+{
+    std::size_t message_size = 0;
+};
+
+/*!
+ * Sends a single byte back for every message that was fully received.
+ */
+class ack_socket final : public sockets::tcp_socket
+{
+public:
+    explicit ack_socket(asio::ip::tcp::socket socket, transport_session &session)
+        : tcp_socket{std::move(socket)}
+        , session_{session}
+        , received_{0}
+    {
+    }
+
+    explicit ack_socket(asio::generic::stream_protocol::socket socket, transport_session &session)
+        : tcp_socket{std::move(socket)}
+        , session_{session}
+        , received_{0}
+    {
+    }
+
+    void on_receive(sockets::pooled_buffer data) override
+    {
+        received_ += std::size(data);
+
+        while (received_ >= session_.message_size)
+        {
+            received_ -= session_.message_size;
+
+            auto ack = sockets::get_buffer_pool().acquire(1);
+            *std::data(ack) = std::byte{1};
+            send(std::move(ack));
+        }
+    }
+
+private:
+    transport_session &session_;
+    std::size_t received_;
+};
+
+class client_socket final : public sockets::tcp_socket
+{
+public:
+    explicit client_socket(asio::io_context &context)
+        : tcp_socket{context}
+        , connected{false}
+        , acks{0}
+    {
+    }
+
+    void on_connected() override
+    {
+        connected = true;
+    }
+
+    void on_receive(sockets::pooled_buffer data) override
+    {
+        acks += std::size(data);
+    }
+
+    bool connected;
+    std::size_t acks;
+};
+
+[[nodiscard]] auto make_message(const std::size_t size) -> sockets::pooled_buffer
+{
+    auto message = sockets::get_buffer_pool().acquire(size);
+    std::memset(std::data(message), 'x', size);
+    return message;
+}
+
+/*!
+ * Runs the benchmark loop for a socket based transport. The server runs on its own thread.
+ */
+template <typename server_t, typename client_t, typename... args_t>
+void run_socket_benchmark(benchmark::State &state, const std::size_t message_size, server_t &server,
+                          asio::io_context &server_context, args_t &&...client_args)
+{
+    server.get_session().message_size = message_size;
+    std::thread server_thread{[&server_context]() { server_context.run(); }};
+
+    {
+        asio::io_context context;
+        client_t client{context, std::forward<args_t>(client_args)...};
+
+        while (!client->connected)
+            context.run_one();
+
+        const auto message = make_message(message_size);
+        std::size_t expected_acks = 0;
+
+        for ([[maybe_unused]] auto _ : state)
+        {
+            client->send(message);
+            ++expected_acks;
+
+            while (client->acks < expected_acks)
+                context.run_one();
+        }
+
+        client->disconnect();
+    }
+
+    server_context.stop();
+    server_thread.join();
+
+    state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * message_size));
+}
+
+} // namespace
+
+/*!
+ * TCP over the loopback interface.
+ * Arguments: message size.
+ */
+static void BM_transport_tcp_loopback(benchmark::State &state)
+{
+    const auto message_size = static_cast<std::size_t>(state.range(0));
+
+    asio::io_context server_context;
+    sockets::tcp_server<ack_socket, transport_session> server{server_context, benchmark_port};
+    run_socket_benchmark<decltype(server), sockets::tcp_client<client_socket>>(
+        state, message_size, server, server_context, common::string{"127.0.0.1"}, benchmark_port);
+}
+
+BENCHMARK(BM_transport_tcp_loopback)->Arg(64)->Arg(64 * 1024)->Arg(1024 * 1024)->UseRealTime();
+
+#if (defined(ASIO_HAS_LOCAL_SOCKETS))
+
+/*!
+ * Unix domain socket.
+ * Arguments: message size.
+ */
+static void BM_transport_unix_domain_socket(benchmark::State &state)
+{
+    const auto message_size = static_cast<std::size_t>(state.range(0));
+    const auto path = std::filesystem::temp_directory_path() / "benchmark_libaeon_sockets.sock";
+
+    asio::io_context server_context;
+    sockets::local_server<ack_socket, transport_session> server{server_context, path};
+    run_socket_benchmark<decltype(server), sockets::local_client<client_socket>>(state, message_size, server,
+                                                                                 server_context, path);
+}
+
+BENCHMARK(BM_transport_unix_domain_socket)->Arg(64)->Arg(64 * 1024)->Arg(1024 * 1024)->UseRealTime();
+
+#endif
+
+#if (defined(AEON_PLATFORM_OS_LINUX))
+
+/*!
+ * Shared memory rings; one for the messages and one for the acknowledgements. Both sides run in the same process
+ * here, but the rings work the same between processes.
+ * Arguments: message size.
+ */
+static void BM_transport_shared_memory_ring(benchmark::State &state)
+{
+    const auto message_size = static_cast<std::size_t>(state.range(0));
+    const auto name = "/benchmark_libaeon_sockets_" + std::to_string(::getpid());
+
+    sockets::shared_memory_ring messages{common::string{name + "_messages"}, 1024 * 1024};
+    sockets::shared_memory_ring acks{common::string{name + "_acks"}, 4096};
+
+    std::thread server_thread{[&name, message_size]()
+                              {
+                                  sockets::shared_memory_ring server_messages{common::string{name + "_messages"}};
+                                  sockets::shared_memory_ring server_acks{common::string{name + "_acks"}};
+
+                                  std::vector<std::byte> buffer(64 * 1024);
+                                  std::size_t received = 0;
+
+                                  while (const auto size = server_messages.read(buffer))
+                                  {
+                                      received += size;
+
+                                      while (received >= message_size)
+                                      {
+                                          received -= message_size;
+
+                                          const std::byte ack{1};
+                                          if (!server_acks.write(std::span{&ack, 1}))
+                                              return;
+                                      }
+                                  }
+                              }};
+
+    const std::vector message(message_size, std::byte{'x'});
+    std::byte ack{};
+
+    for ([[maybe_unused]] auto _ : state)
+    {
+        [[maybe_unused]] const auto written = messages.write(message);
+        [[maybe_unused]] const auto read = acks.read(std::span{&ack, 1});
+    }
+
+    messages.close();
+    acks.close();
+    server_thread.join();
+
+    state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * message_size));
+}
+
+BENCHMARK(BM_transport_shared_memory_ring)->Arg(64)->Arg(64 * 1024)->Arg(1024 * 1024)->UseRealTime();
+
+#endif
@@ -0,0 +1,123 @@
+// Distributed under the BSD 2-Clause License - Copyright 2012-2023 Robin Degen
+
+#include <benchmark/benchmark.h>
+
+#include <aeon/sockets/udp_socket.h>
+#include <asio.hpp>
+#include <array>
+#include <vector>
+#include <memory>
+#include <functional>
+#include <cstdint>
+
+using namespace aeon;
+
+namespace
+{
+
+constexpr std::size_t datagram_size = 64;
+
+class counting_socket final : public sockets::udp_socket
+{
+public:
+    explicit counting_socket(asio::io_context &context)
+        : udp_socket{context, asio::ip::udp::endpoint{asio::ip::address_v4::loopback(), 0}}
+        , received{0}
+    {
+    }
+
+    void on_datagram([[maybe_unused]] const asio::ip::udp::endpoint &sender,
+                     [[maybe_unused]] sockets::pooled_buffer data) override
+    {
+        ++received;
+    }
+
+    std::size_t received;
+};
+
+} // namespace
+
+/*!
+ * Datagrams sent and received with udp_socket, which uses sendmmsg and recvmmsg where supported.
+ * Arguments: datagrams sent per round.
+ */
+static void BM_udp_socket(benchmark::State &state)
+{
+    const auto count = static_cast<std::size_t>(state.range(0));
+
+    asio::io_context context;
+    auto receiver = std::make_shared<counting_socket>(context);
+    receiver->start();
+
+    auto sender = std::make_shared<sockets::udp_socket>(context);
+    const auto endpoint = receiver->local_endpoint();
+    const auto datagram = sockets::get_buffer_pool().acquire(datagram_size);
+
+    std::size_t expected = 0;
+
+    for ([[maybe_unused]] auto _ : state)
+    {
+        for (std::size_t i = 0; i < count; ++i)
+            sender->send_to(endpoint, datagram);
+
+        expected += count;
+
+        while (receiver->received < expected)
+            context.run_one();
+    }
+
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * count));
+}
+
+BENCHMARK(BM_udp_socket)->Arg(1)->Arg(32)->Arg(128)->UseRealTime();
+
+/*!
+ * The same with plain asio, which sends and receives a single datagram per system call.
+ * Arguments: datagrams sent per round.
+ */
+static void BM_udp_asio(benchmark::State &state)
+{
+    const auto count = static_cast<std::size_t>(state.range(0));
+
+    asio::io_context context;
+    asio::ip::udp::socket receiver{context, asio::ip::udp::endpoint{asio::ip::address_v4::loopback(), 0}};
+    asio::ip::udp::socket sender{context, asio::ip::udp::v4()};
+    const auto endpoint = receiver.local_endpoint();
+
+    std::array<std::byte, 2048> receive_buffer{};
+    asio::ip::udp::endpoint receive_endpoint;
+    std::size_t received = 0;
+
+    std::function<void()> receive = [&]()
+    {
+        receiver.async_receive_from(asio::buffer(receive_buffer), receive_endpoint,
+                                    [&](const std::error_code ec, const std::size_t)
+                                    {
+                                        if (ec)
+                                            return;
+
+                                        ++received;
+                                        receive();
+                                    });
+    };
+
+    receive();
+
+    const std::vector<std::byte> datagram(datagram_size);
+    std::size_t expected = 0;
+
+    for ([[maybe_unused]] auto _ : state)
+    {
+        for (std::size_t i = 0; i < count; ++i)
+            sender.async_send_to(asio::buffer(datagram), endpoint, [](const std::error_code, const std::size_t) {});
+
+        expected += count;
+
+        while (received < expected)
+            context.run_one();
+    }
+
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * count));
+}
+
+BENCHMARK(BM_udp_asio)->Arg(1)->Arg(32)->Arg(128)->UseRealTime();
@@ -0,0 +1,261 @@
+// Distributed under the BSD 2-Clause License - Copyright 2012-2023 Robin Degen
+
+#include <aeon/sockets/buffer_pool.h>
+#include <aeon/common/assert.h>
+#include <algorithm>
+#include <bit>
+#include <new>
+#include <limits>
+#include <utility>
+
+namespace aeon::sockets
+{
+
+namespace internal
+{
+
+// The data of a buffer starts on its own cache line, right after the header.
+static constexpr std::size_t block_alignment = 64;
+static constexpr std::size_t block_header_size = 64;
+static_assert(sizeof(detail::buffer_block) <= block_header_size);
+
+static constexpr auto unpooled_size_class = std::numeric_limits<std::uint32_t>::max();
+
+[[nodiscard]] static auto block_data(detail::buffer_block *block) noexcept -> std::byte *
+{
+    return reinterpret_cast<std::byte *>(block) + block_header_size;
+}
+
+[[nodiscard]] static auto allocate_block(buffer_pool *pool, const std::uint32_t size_class,
+                                         const std::size_t capacity) -> detail::buffer_block *
+{
+    auto memory = ::operator new(block_header_size + capacity, std::align_val_t{block_alignment});
+    return new (memory) detail::buffer_block{{1}, size_class, capacity, pool};
+}
+
+static void free_block(detail::buffer_block *block) noexcept
+{
+    block->~buffer_block();
+    ::operator delete(block, std::align_val_t{block_alignment});
+}
+
+} // namespace internal
+
+pooled_buffer::pooled_buffer() noexcept
+    : block_{nullptr}
+    , data_{nullptr}
+    , size_{0}
+{
+}
+
+pooled_buffer::pooled_buffer(detail::buffer_block *block, std::byte *data, const std::size_t size) noexcept
+    : block_{block}
+    , data_{data}
+    , size_{size}
+{
+}
+
+pooled_buffer::~pooled_buffer()
+{
+    release();
+}
+
+pooled_buffer::pooled_buffer(pooled_buffer &&other) noexcept
+    : block_{std::exchange(other.block_, nullptr)}
+    , data_{std::exchange(other.data_, nullptr)}
+    , size_{std::exchange(other.size_, 0)}
+{
+}
+
+auto pooled_buffer::operator=(pooled_buffer &&other) noexcept -> pooled_buffer &
+{
+    if (this == &other) [[unlikely]]
+        return *this;
+
+    release();
+    block_ = std::exchange(other.block_, nullptr);
+    data_ = std::exchange(other.data_, nullptr);
+    size_ = std::exchange(other.size_, 0);
+    return *this;
+}
+
+pooled_buffer::pooled_buffer(const pooled_buffer &other) noexcept
+    : block_{other.block_}
+    , data_{other.data_}
+    , size_{other.size_}
+{
+    if (block_)
+        block_->references.fetch_add(1, std::memory_order_relaxed);
+}
+
+auto pooled_buffer::operator=(const pooled_buffer &other) noexcept -> pooled_buffer &
+{
+    if (this == &other) [[unlikely]]
+        return *this;
+
+    if (other.block_)
+        other.block_->references.fetch_add(1, std::memory_order_relaxed);
+
+    release();
+    block_ = other.block_;
+    data_ = other.data_;
+    size_ = other.size_;
+    return *this;
+}
+
+auto pooled_buffer::data() noexcept -> std::byte *
+{
+    return data_;
+}
+
+auto pooled_buffer::data() const noexcept -> const std::byte *
+{
+    return data_;
+}
+
+auto pooled_buffer::size() const noexcept -> std::size_t
+{
+    return size_;
+}
+
+auto pooled_buffer::empty() const noexcept -> bool
+{
+    return size_ == 0;
+}
+
+auto pooled_buffer::capacity() const noexcept -> std::size_t
+{
+    if (!block_)
+        return 0;
+
+    return block_->capacity - static_cast<std::size_t>(data_ - internal::block_data(block_));
+}
+
+void pooled_buffer::resize(const std::size_t size) noexcept
+{
+    aeon_assert(size <= capacity(), "Size exceeds the capacity of the buffer.");
+    size_ = size;
+}
+
+auto pooled_buffer::slice(const std::size_t offset, const std::size_t size) const noexcept -> pooled_buffer
+{
+    aeon_assert(offset + size <= size_, "Slice is out of range.");
+
+    if (block_)
+        block_->references.fetch_add(1, std::memory_order_relaxed);
+
+    return pooled_buffer{block_, data_ + offset, size};
+}
+
+auto pooled_buffer::unique() const noexcept -> bool
+{
+    return block_ && block_->references.load(std::memory_order_acquire) == 1;
+}
+
+auto pooled_buffer::span() const noexcept -> std::span<const std::byte>
+{
+    return {data_, size_};
+}
+
+pooled_buffer::operator std::span<const std::byte>() const noexcept
+{
+    return span();
+}
+
+void pooled_buffer::release() noexcept
+{
+    if (!block_)
+        return;
+
+    if (block_->references.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        block_->pool->release(block_);
+
+    block_ = nullptr;
+    data_ = nullptr;
+    size_ = 0;
+}
+
+buffer_pool::buffer_pool(const std::size_t max_cached_bytes)
+    : size_classes_{}
+    , cached_bytes_{0}
+    , max_cached_bytes_{max_cached_bytes}
+{
+}
+
+buffer_pool::~buffer_pool()
+{
+    for (auto &size_class : size_classes_)
+    {
+        for (auto *const block : size_class.free_blocks)
+            internal::free_block(block);
+    }
+}
+
+auto buffer_pool::acquire(const std::size_t size) -> pooled_buffer
+{
+    const auto capacity = std::bit_ceil(std::max(size, static_cast<std::size_t>(buffer_pool_min_buffer_size)));
+    const auto index = static_cast<std::size_t>(std::countr_zero(capacity) -
+                                                std::countr_zero(static_cast<unsigned>(buffer_pool_min_buffer_size)));
+
+    if (index >= std::size(size_classes_))
+    {
+        auto *const block = internal::allocate_block(this, internal::unpooled_size_class, size);
+        return pooled_buffer{block, internal::block_data(block), size};
+    }
+
+    auto &size_class = size_classes_[index];
+
+    {
+        const std::scoped_lock lock{size_class.mutex};
+
+        if (!std::empty(size_class.free_blocks))
+        {
+            auto *const block = size_class.free_blocks.back();
+            size_class.free_blocks.pop_back();
+            cached_bytes_.fetch_sub(capacity, std::memory_order_relaxed);
+
+            block->references.store(1, std::memory_order_relaxed);
+            return pooled_buffer{block, internal::block_data(block), size};
+        }
+    }
+
+    auto *const block = internal::allocate_block(this, static_cast<std::uint32_t>(index), capacity);
+    return pooled_buffer{block, internal::block_data(block), size};
+}
+
+auto buffer_pool::cached_bytes() const noexcept -> std::size_t
+{
+    return cached_bytes_.load(std::memory_order_relaxed);
+}
+
+void buffer_pool::release(detail::buffer_block *block) noexcept
+{
+    if (block->size_class == internal::unpooled_size_class ||
+        cached_bytes_.load(std::memory_order_relaxed) + block->capacity > max_cached_bytes_)
+    {
+        internal::free_block(block);
+        return;
+    }
+
+    auto &size_class = size_classes_[block->size_class];
+
+    try
+    {
+        const std::scoped_lock lock{size_class.mutex};
+        size_class.free_blocks.push_back(block);
+        cached_bytes_.fetch_add(block->capacity, std::memory_order_relaxed);
+    }
+    catch (...)
+    {
+        internal::free_block(block);
+    }
+}
+
+auto get_buffer_pool() -> buffer_pool &
+{
+    // Intentionally never destroyed, since sockets (and the buffers they hand out) may outlive static destruction.
+    static auto *const pool = new buffer_pool{};
+    return *pool;
+}
+
+} // namespace aeon::sockets
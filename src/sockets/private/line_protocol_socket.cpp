@@ -1,37 +1,91 @@
 // Distributed under the BSD 2-Clause License - Copyright 2012-2023 Robin Degen
 
 #include <aeon/sockets/line_protocol_socket.h>
-#include <aeon/streams/stream_reader.h>
-#include <aeon/sockets/config.h>
+#include <system_error>
+#include <cstring>
 
 namespace aeon::sockets
 {
 
 line_protocol_socket::line_protocol_socket(asio::io_context &service)
     : tcp_socket(service)
-    , circular_buffer_{streams::circular_buffer_filter{},
-                       streams::memory_device<std::vector<char>>{tcp_socket_circular_buffer_size}}
+    , line_{}
+    , max_line_length_{line_protocol_max_line_length}
 {
 }
 
 line_protocol_socket::line_protocol_socket(asio::ip::tcp::socket socket)
     : tcp_socket(std::move(socket))
-    , circular_buffer_{streams::circular_buffer_filter{},
-                       streams::memory_device<std::vector<char>>{tcp_socket_circular_buffer_size}}
+    , line_{}
+    , max_line_length_{line_protocol_max_line_length}
+{
+}
+
+line_protocol_socket::line_protocol_socket(asio::generic::stream_protocol::socket socket)
+    : tcp_socket(std::move(socket))
+    , line_{}
+    , max_line_length_{line_protocol_max_line_length}
 {
 }
 
 line_protocol_socket::~line_protocol_socket() = default;
 
-void line_protocol_socket::on_data(const std::span<const std::byte> &data)
+void line_protocol_socket::on_receive(pooled_buffer data)
 {
-    circular_buffer_.write(std::data(data), std::size(data));
-    streams::stream_reader reader(circular_buffer_);
+    auto begin = reinterpret_cast<const char *>(std::data(data));
+    const auto end = begin + std::size(data);
 
-    while (circular_buffer_.size() != 0)
+    while (begin != end)
     {
-        on_line(reader.read_line());
+        const auto line_end =
+            static_cast<const char *>(std::memchr(begin, '\n', static_cast<std::size_t>(end - begin)));
+
+        // A trailing '\r' is still part of the line at this point, so one more character is allowed until the line
+        // is complete.
+        const auto length = std::size(line_) + static_cast<std::size_t>((line_end ? line_end : end) - begin);
+
+        if (length > max_line_length_ + 1)
+        {
+            line_too_long();
+            return;
+        }
+
+        // The rest of the line is in the next read.
+        if (!line_end)
+        {
+            line_.str().append(begin, end);
+            return;
+        }
+
+        line_.str().append(begin, line_end);
+
+        if (!line_.empty() && line_.str().back() == '\r')
+            line_.str().pop_back();
+
+        if (std::size(line_) > max_line_length_)
+        {
+            line_too_long();
+            return;
+        }
+
+        on_line(line_);
+
+        // Clearing keeps the capacity, so that the next line does not allocate.
+        line_.clear();
+        begin = line_end + 1;
     }
 }
 
+void line_protocol_socket::set_max_line_length(const std::size_t length) noexcept
+{
+    max_line_length_ = length;
+}
+
+void line_protocol_socket::line_too_long()
+{
+    line_ = common::string{};
+    on_error(std::make_error_code(std::errc::protocol_error));
+    disconnect();
+}
+
 } // namespace aeon::sockets
@@ -0,0 +1,384 @@
+// Distributed under the BSD 2-Clause License - Copyright 2012-2023 Robin Degen
+
+#include <aeon/sockets/shared_memory_ring.h>
+
+#if (defined(AEON_PLATFORM_OS_LINUX))
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <atomic>
+#include <algorithm>
+#include <system_error>
+#include <stdexcept>
+#include <climits>
+#include <cerrno>
+#include <cstring>
+#include <utility>
+#include <bit>
+#include <new>
+
+namespace aeon::sockets
+{
+
+namespace detail
+{
+
+/*!
+ * The header at the start of the shared memory, followed by the data of the ring. Head and tail are the total amount
+ * of bytes that were written and read; they are never wrapped, only the offsets into the data are. Every counter that
+ * is written by a different side is on its own cache line.
+ */
+struct shared_memory_ring_header final
+{
+    std::uint32_t magic;
+    std::uint32_t version;
+    std::uint64_t capacity;
+
+    alignas(64) std::atomic<std::uint64_t> head;
+    alignas(64) std::atomic<std::uint64_t> tail;
+
+    // Incremented by the writer to wake up the reader, if it is waiting.
+    alignas(64) std::atomic<std::uint32_t> data_seq;
+    std::atomic<std::uint32_t> reader_waiting;
+
+    // Incremented by the reader to wake up the writer, if it is waiting.
+    alignas(64) std::atomic<std::uint32_t> space_seq;
+    std::atomic<std::uint32_t> writer_waiting;
+
+    alignas(64) std::atomic<std::uint32_t> closed;
+};
+
+} // namespace detail
+
+namespace internal
+{
+
+static constexpr std::uint32_t ring_magic = 0x474e5241; // 'ARNG'
+static constexpr std::uint32_t ring_version = 1;
+
+// The atomics are shared between processes, so they must not be implemented with a lock.
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free);
+static_assert(std::atomic<std::uint32_t>::is_always_lock_free);
+static_assert(sizeof(std::atomic<std::uint32_t>) == sizeof(std::uint32_t));
+
+[[noreturn]] static void throw_errno(const char *const what)
+{
+    throw std::system_error{errno, std::system_category(), what};
+}
+
+// Not FUTEX_PRIVATE_FLAG, since the other side of the ring is usually in another process.
+static void futex_wait(std::atomic<std::uint32_t> &word, const std::uint32_t expected) noexcept
+{
+    ::syscall(SYS_futex, reinterpret_cast<std::uint32_t *>(&word), FUTEX_WAIT, expected, nullptr, nullptr, 0);
+}
+
+static void futex_wake(std::atomic<std::uint32_t> &word) noexcept
+{
+    ::syscall(SYS_futex, reinterpret_cast<std::uint32_t *>(&word), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+}
+
+/*!
+ * Wake up the other side if it is sleeping. The waiting flag is set by the other side before it checks the condition
+ * one last time, and the counter that was changed before calling this is stored sequentially consistent, so either the
+ * other side sees the change or this sees the flag.
+ */
+static void notify(std::atomic<std::uint32_t> &seq, const std::atomic<std::uint32_t> &waiting) noexcept
+{
+    if (waiting.load(std::memory_order_seq_cst) == 0)
+        return;
+
+    seq.fetch_add(1, std::memory_order_seq_cst);
+    futex_wake(seq);
+}
+
+/*!
+ * Wait until the given condition is true; first by spinning, then by sleeping on the futex. Returns false if the ring
+ * was closed while the condition is still false.
+ */
+template <typename condition_t>
+[[nodiscard]] static auto wait(std::atomic<std::uint32_t> &seq, std::atomic<std::uint32_t> &waiting,
+                               const std::atomic<std::uint32_t> &closed, condition_t &&condition) -> bool
+{
+    for (auto i = 0; i < shared_memory_ring_spin_count; ++i)
+    {
+        if (condition())
+            return true;
+
+        if (closed.load(std::memory_order_acquire) != 0)
+            return condition();
+    }
+
+    while (true)
+    {
+        const auto value = seq.load(std::memory_order_seq_cst);
+        waiting.store(1, std::memory_order_seq_cst);
+
+        const auto ready = condition();
+
+        if (ready || closed.load(std::memory_order_seq_cst) != 0)
+        {
+            waiting.store(0, std::memory_order_relaxed);
+            return ready;
+        }
+
+        futex_wait(seq, value);
+    }
+}
+
+} // namespace internal
+
+shared_memory_ring::shared_memory_ring(const common::string &name, const std::size_t capacity)
+    : name_{name}
+    , header_{nullptr}
+    , data_{nullptr}
+    , mapped_size_{0}
+    , owner_{true}
+{
+    const auto fd = ::shm_open(name_.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+
+    if (fd < 0)
+        internal::throw_errno("shm_open");
+
+    const auto ring_capacity =
+        std::bit_ceil(std::max(capacity, static_cast<std::size_t>(shared_memory_ring_min_capacity)));
+    const auto size = sizeof(detail::shared_memory_ring_header) + ring_capacity;
+
+    if (::ftruncate(fd, static_cast<off_t>(size)) != 0)
+    {
+        const auto error = errno;
+        ::close(fd);
+        ::shm_unlink(name_.c_str());
+        throw std::system_error{error, std::system_category(), "ftruncate"};
+    }
+
+    try
+    {
+        map(fd, size);
+    }
+    catch (...)
+    {
+        ::shm_unlink(name_.c_str());
+        throw;
+    }
+
+    header_ = new (header_) detail::shared_memory_ring_header{};
+    header_->version = internal::ring_version;
+    header_->capacity = ring_capacity;
+
+    // Published last, so that a process that opens the ring never sees a partially initialized header.
+    std::atomic_ref{header_->magic}.store(internal::ring_magic, std::memory_order_release);
+}
+
+shared_memory_ring::shared_memory_ring(const common::string &name)
+    : name_{name}
+    , header_{nullptr}
+    , data_{nullptr}
+    , mapped_size_{0}
+    , owner_{false}
+{
+    const auto fd = ::shm_open(name_.c_str(), O_RDWR, 0);
+
+    if (fd < 0)
+        internal::throw_errno("shm_open");
+
+    struct stat status
+    {
+    };
+
+    if (::fstat(fd, &status) != 0)
+    {
+        const auto error = errno;
+        ::close(fd);
+        throw std::system_error{error, std::system_category(), "fstat"};
+    }
+
+    const auto size = static_cast<std::size_t>(status.st_size);
+
+    if (size <= sizeof(detail::shared_memory_ring_header))
+    {
+        ::close(fd);
+        throw std::invalid_argument{"Shared memory does not contain a ring."};
+    }
+
+    map(fd, size);
+
+    if (std::atomic_ref{header_->magic}.load(std::memory_order_acquire) != internal::ring_magic ||
+        header_->version != internal::ring_version ||
+        header_->capacity != size - sizeof(detail::shared_memory_ring_header))
+    {
+        release();
+        throw std::invalid_argument{"Shared memory does not contain a ring."};
+    }
+}
+
+shared_memory_ring::~shared_memory_ring()
+{
+    release();
+}
+
+shared_memory_ring::shared_memory_ring(shared_memory_ring &&other) noexcept
+    : name_{std::move(other.name_)}
+    , header_{std::exchange(other.header_, nullptr)}
+    , data_{std::exchange(other.data_, nullptr)}
+    , mapped_size_{std::exchange(other.mapped_size_, 0)}
+    , owner_{std::exchange(other.owner_, false)}
+{
+}
+
+auto shared_memory_ring::operator=(shared_memory_ring &&other) noexcept -> shared_memory_ring &
+{
+    if (this == &other) [[unlikely]]
+        return *this;
+
+    release();
+    name_ = std::move(other.name_);
+    header_ = std::exchange(other.header_, nullptr);
+    data_ = std::exchange(other.data_, nullptr);
+    mapped_size_ = std::exchange(other.mapped_size_, 0);
+    owner_ = std::exchange(other.owner_, false);
+    return *this;
+}
+
+auto shared_memory_ring::write(const std::span<const std::byte> data) -> bool
+{
+    auto &header = *header_;
+    const auto capacity = header.capacity;
+    auto head = header.head.load(std::memory_order_relaxed);
+    auto remaining = data;
+
+    while (!std::empty(remaining))
+    {
+        if (header.closed.load(std::memory_order_acquire) != 0)
+            return false;
+
+        auto tail = header.tail.load(std::memory_order_acquire);
+
+        if (head - tail == capacity)
+        {
+            if (!internal::wait(header.space_seq, header.writer_waiting, header.closed,
+                                [&header, &tail, head, capacity]()
+                                {
+                                    tail = header.tail.load(std::memory_order_seq_cst);
+                                    return head - tail != capacity;
+                                }))
+                return false;
+        }
+
+        const auto size = std::min(std::size(remaining), static_cast<std::size_t>(capacity - (head - tail)));
+        const auto offset = static_cast<std::size_t>(head & (capacity - 1));
+        const auto first = std::min(size, static_cast<std::size_t>(capacity) - offset);
+
+        std::memcpy(data_ + offset, std::data(remaining), first);
+        std::memcpy(data_, std::data(remaining) + first, size - first);
+
+        head += size;
+        header.head.store(head, std::memory_order_seq_cst);
+        internal::notify(header.data_seq, header.reader_waiting);
+
+        remaining = remaining.subspan(size);
+    }
+
+    return true;
+}
+
+auto shared_memory_ring::read(const std::span<std::byte> data) -> std::size_t
+{
+    if (std::empty(data))
+        return 0;
+
+    auto &header = *header_;
+    const auto tail = header.tail.load(std::memory_order_relaxed);
+
+    if (header.head.load(std::memory_order_acquire) == tail)
+    {
+        if (!internal::wait(header.data_seq, header.reader_waiting, header.closed,
+                            [&header, tail]() { return header.head.load(std::memory_order_seq_cst) != tail; }))
+            return 0;
+    }
+
+    return try_read(data);
+}
+
+auto shared_memory_ring::try_read(const std::span<std::byte> data) -> std::size_t
+{
+    auto &header = *header_;
+    const auto capacity = header.capacity;
+    const auto tail = header.tail.load(std::memory_order_relaxed);
+    const auto head = header.head.load(std::memory_order_acquire);
+
+    const auto size = std::min(std::size(data), static_cast<std::size_t>(head - tail));
+
+    if (size == 0)
+        return 0;
+
+    const auto offset = static_cast<std::size_t>(tail & (capacity - 1));
+    const auto first = std::min(size, static_cast<std::size_t>(capacity) - offset);
+
+    std::memcpy(std::data(data), data_ + offset, first);
+    std::memcpy(std::data(data) + first, data_, size - first);
+
+    header.tail.store(tail + size, std::memory_order_seq_cst);
+    internal::notify(header.space_seq, header.writer_waiting);
+    return size;
+}
+
+void shared_memory_ring::close() noexcept
+{
+    if (!header_)
+        return;
+
+    header_->closed.store(1, std::memory_order_seq_cst);
+
+    // Wake up both sides unconditionally; a side that is about to sleep sees the closed flag or the changed counter.
+    header_->data_seq.fetch_add(1, std::memory_order_seq_cst);
+    internal::futex_wake(header_->data_seq);
+    header_->space_seq.fetch_add(1, std::memory_order_seq_cst);
+    internal::futex_wake(header_->space_seq);
+}
+
+auto shared_memory_ring::is_closed() const noexcept -> bool
+{
+    return header_->closed.load(std::memory_order_acquire) != 0;
+}
+
+auto shared_memory_ring::capacity() const noexcept -> std::size_t
+{
+    return static_cast<std::size_t>(header_->capacity);
+}
+
+void shared_memory_ring::map(const int fd, const std::size_t size)
+{
+    auto *const memory = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    const auto error = errno;
+
+    // The mapping keeps the shared memory alive; the descriptor is no longer needed.
+    ::close(fd);
+
+    if (memory == MAP_FAILED)
+        throw std::system_error{error, std::system_category(), "mmap"};
+
+    header_ = static_cast<detail::shared_memory_ring_header *>(memory);
+    data_ = static_cast<std::byte *>(memory) + sizeof(detail::shared_memory_ring_header);
+    mapped_size_ = size;
+}
+
+void shared_memory_ring::release() noexcept
+{
+    if (header_)
+        ::munmap(header_, mapped_size_);
+
+    if (owner_)
+        ::shm_unlink(name_.c_str());
+
+    header_ = nullptr;
+    data_ = nullptr;
+    mapped_size_ = 0;
+    owner_ = false;
+}
+
+} // namespace aeon::sockets
+
+#endif
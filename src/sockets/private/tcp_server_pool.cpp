@@ -0,0 +1,39 @@
+// Distributed under the BSD 2-Clause License - Copyright 2012-2023 Robin Degen
+
+#include <aeon/sockets/tcp_server_pool.h>
+#include <aeon/common/platform.h>
+
+#if (defined(AEON_PLATFORM_OS_LINUX))
+#include <pthread.h>
+#include <sched.h>
+#include <sys/socket.h>
+#endif
+
+namespace aeon::sockets::detail
+{
+
+void pin_current_thread([[maybe_unused]] const std::size_t core) noexcept
+{
+#if (defined(AEON_PLATFORM_OS_LINUX))
+    const auto core_count = std::max(std::thread::hardware_concurrency(), 1u);
+
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    CPU_SET(core % core_count, &cpu_set);
+    pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set);
+#endif
+}
+
+auto enable_reuse_port([[maybe_unused]] asio::ip::tcp::acceptor &acceptor) noexcept -> bool
+{
+#if (defined(AEON_PLATFORM_OS_LINUX))
+    // Asio has no public option for SO_REUSEPORT, so it is set on the native handle; the acceptor must be open.
+    const int value = 1;
+    return ::setsockopt(acceptor.native_handle(), SOL_SOCKET, SO_REUSEPORT, &value, sizeof(value)) == 0;
+#else
+    // On Windows and macOS SO_REUSEPORT (or SO_REUSEADDR) does not distribute the connections between the listeners.
+    return false;
+#endif
+}
+
+} // namespace aeon::sockets::detail
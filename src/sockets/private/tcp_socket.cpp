@@ -1,32 +1,183 @@
 // Distributed under the BSD 2-Clause License - Copyright 2012-2023 Robin Degen
 
 #include <aeon/sockets/tcp_socket.h>
-#include <aeon/streams/stream_reader.h>
+#include <aeon/common/platform.h>
 #include <asio/write.hpp>
 #include <asio/connect.hpp>
 #include <asio/bind_executor.hpp>
 
+#if (defined(AEON_PLATFORM_OS_LINUX))
+#include <sys/sendfile.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#else
+#include <fstream>
+#endif
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
 namespace aeon::sockets
 {
 
+namespace internal
+{
+
+/*!
+ * A completion condition for asio::async_write that writes everything (like asio::transfer_all), and counts the write
+ * calls that asio makes to do so.
+ */
+[[nodiscard]] static auto counting_transfer_all(std::atomic<std::uint64_t> &write_calls, const std::size_t size)
+{
+    return [&write_calls, size](const std::error_code &ec, const std::size_t transferred) -> std::size_t
+    {
+        if (ec || transferred >= size)
+            return 0;
+
+        write_calls.fetch_add(1, std::memory_order_relaxed);
+        return size - transferred;
+    };
+}
+
+static void update_max(std::atomic<std::uint64_t> &max, const std::uint64_t value) noexcept
+{
+    auto current = max.load(std::memory_order_relaxed);
+    while (value > current && !max.compare_exchange_weak(current, value, std::memory_order_relaxed))
+    {
+    }
+}
+
+} // namespace internal
+
+#if (defined(AEON_PLATFORM_OS_LINUX))
+class tcp_socket::file_source final
+{
+public:
+    explicit file_source(const std::filesystem::path &path)
+        : descriptor_{::open(path.c_str(), O_RDONLY | O_CLOEXEC)}
+    {
+    }
+
+    ~file_source()
+    {
+        if (descriptor_ >= 0)
+            ::close(descriptor_);
+    }
+
+    file_source(file_source &&) noexcept = delete;
+    auto operator=(file_source &&) noexcept -> file_source & = delete;
+
+    file_source(const file_source &) = delete;
+    auto operator=(const file_source &) -> file_source & = delete;
+
+    [[nodiscard]] auto is_open() const noexcept
+    {
+        return descriptor_ >= 0;
+    }
+
+    [[nodiscard]] auto descriptor() const noexcept
+    {
+        return descriptor_;
+    }
+
+private:
+    int descriptor_;
+};
+#else
+class tcp_socket::file_source final
+{
+public:
+    explicit file_source(const std::filesystem::path &path)
+        : stream_{path, std::ios::binary}
+        , buffer_{}
+    {
+    }
+
+    ~file_source() = default;
+
+    file_source(file_source &&) noexcept = delete;
+    auto operator=(file_source &&) noexcept -> file_source & = delete;
+
+    file_source(const file_source &) = delete;
+    auto operator=(const file_source &) -> file_source & = delete;
+
+    [[nodiscard]] auto is_open() const noexcept
+    {
+        return stream_.is_open();
+    }
+
+    /*!
+     * Read up to size bytes at the given offset. Returns an empty span on error.
+     */
+    [[nodiscard]] auto read(const std::uint64_t offset, const std::size_t size) -> std::span<const std::byte>
+    {
+        buffer_.resize(size);
+        stream_.seekg(static_cast<std::streamoff>(offset));
+        stream_.read(reinterpret_cast<char *>(std::data(buffer_)), static_cast<std::streamsize>(size));
+
+        if (!stream_)
+            return {};
+
+        return buffer_;
+    }
+
+private:
+    std::ifstream stream_;
+    std::vector<std::byte> buffer_;
+};
+#endif
+
 tcp_socket::tcp_socket(asio::io_context &context)
     : context_{context}
     , socket_{context}
-    , data_{}
+    , read_buffer_{}
+    , read_size_{tcp_socket_min_read_size}
+    , small_reads_{0}
+    , read_paused_{false}
+    , read_stopped_{false}
     , send_data_queue_{}
+    , write_buffers_{}
+    , writing_count_{0}
+    , disconnect_after_send_{false}
+    , send_high_watermark_{tcp_socket_send_high_watermark}
+    , send_low_watermark_{tcp_socket_send_low_watermark}
+    , backpressure_{false}
+    , counters_{}
 {
 }
 
 tcp_socket::tcp_socket(asio::ip::tcp::socket socket)
+    : tcp_socket{asio::generic::stream_protocol::socket{std::move(socket)}}
+{
+}
+
+tcp_socket::tcp_socket(asio::generic::stream_protocol::socket socket)
     : context_{static_cast<asio::io_context &>(socket.get_executor().context())}
     , socket_{std::move(socket)}
-    , data_{}
+    , read_buffer_{}
+    , read_size_{tcp_socket_min_read_size}
+    , small_reads_{0}
+    , read_paused_{false}
+    , read_stopped_{false}
     , send_data_queue_{}
+    , write_buffers_{}
+    , writing_count_{0}
+    , disconnect_after_send_{false}
+    , send_high_watermark_{tcp_socket_send_high_watermark}
+    , send_low_watermark_{tcp_socket_send_low_watermark}
+    , backpressure_{false}
+    , counters_{}
 {
 }
 
 tcp_socket::~tcp_socket() = default;
 
+void tcp_socket::on_started()
+{
+}
+
 void tcp_socket::on_connected()
 {
 }
@@ -35,71 +186,234 @@ void tcp_socket::on_disconnected()
 {
 }
 
+void tcp_socket::on_data([[maybe_unused]] const std::span<const std::byte> &data)
+{
+}
+
+void tcp_socket::on_receive(pooled_buffer data)
+{
+    on_data(data.span());
+}
+
 void tcp_socket::on_error([[maybe_unused]] const std::error_code &ec)
 {
 }
 
+void tcp_socket::on_send_complete()
+{
+}
+
+void tcp_socket::on_backpressure()
+{
+}
+
+void tcp_socket::on_writable()
+{
+}
+
 void tcp_socket::send(std::vector<std::byte> data)
 {
     if (std::empty(data))
         return;
 
-    auto self(shared_from_this());
+    send_entry entry;
+    entry.data = std::move(data);
+    entry.view = entry.data;
+    internal_queue(std::move(entry));
+}
 
-    asio::post(context_,
-               [self, data = std::move(data)]() mutable
-               {
-                   const auto write_in_progress = !std::empty(self->send_data_queue_);
+void tcp_socket::send(pooled_buffer data)
+{
+    if (std::empty(data))
+        return;
 
-                   self->send_data_queue_.push(std::move(data));
-                   if (!write_in_progress)
-                       self->internal_handle_write();
-               });
+    send_entry entry;
+    entry.view = data.span();
+    entry.buffer = std::move(data);
+    internal_queue(std::move(entry));
+}
+
+void tcp_socket::send(std::shared_ptr<const std::vector<std::byte>> data, const std::size_t offset,
+                      const std::size_t size)
+{
+    if (!data)
+        throw std::invalid_argument{"Data must not be null."};
+
+    if (offset > std::size(*data) || size > std::size(*data) - offset)
+        throw std::invalid_argument{"Range is outside of the data."};
+
+    if (size == 0)
+        return;
+
+    send_entry entry;
+    entry.view = std::span{*data}.subspan(offset, size);
+    entry.shared_data = std::move(data);
+    internal_queue(std::move(entry));
+}
+
+auto tcp_socket::send_file(const std::filesystem::path &path, const std::uint64_t offset, const std::uint64_t size)
+    -> bool
+{
+    auto file = std::make_shared<file_source>(path);
+
+    if (!file->is_open())
+        return false;
+
+    if (size == 0)
+        return true;
+
+    send_entry entry;
+    entry.file = std::move(file);
+    entry.file_offset = offset;
+    entry.file_remaining = size;
+    internal_queue(std::move(entry));
+    return true;
+}
+
+void tcp_socket::connect(const asio::ip::tcp::resolver::results_type &endpoints)
+{
+    internal_connect(endpoints);
 }
 
+#if (defined(ASIO_HAS_LOCAL_SOCKETS))
+void tcp_socket::connect(const asio::local::stream_protocol::endpoint &endpoint)
+{
+    auto self(shared_from_this());
+
+    socket_.async_connect(endpoint, asio::bind_executor(context_, [self](const std::error_code ec)
+                                                        { self->internal_handle_connect(ec); }));
+}
+#endif
+
 void tcp_socket::disconnect()
 {
     auto self(shared_from_this());
 
+    asio::post(context_, [self]() { self->internal_disconnect(); });
+}
+
+void tcp_socket::disconnect_after_send()
+{
+    auto self(shared_from_this());
+
     asio::post(context_,
                [self]()
                {
-                   if (!self->socket_.is_open())
-                       return;
-
-                   self->socket_.shutdown(asio::ip::tcp::socket::shutdown_both);
-                   self->socket_.close();
-                   self->on_disconnected();
+                   if (std::empty(self->send_data_queue_))
+                       self->internal_disconnect();
+                   else
+                       self->disconnect_after_send_ = true;
                });
 }
 
+void tcp_socket::set_send_watermarks(const std::size_t high, const std::size_t low) noexcept
+{
+    send_high_watermark_ = high;
+    send_low_watermark_ = std::min(low, high);
+}
+
+auto tcp_socket::is_backpressured() const noexcept -> bool
+{
+    return backpressure_.load(std::memory_order_relaxed) || send_queue_size() > send_high_watermark_;
+}
+
+auto tcp_socket::send_queue_size() const noexcept -> std::size_t
+{
+    return static_cast<std::size_t>(counters_.send_queue_size.load(std::memory_order_relaxed));
+}
+
+auto tcp_socket::statistics() const noexcept -> tcp_socket_statistics
+{
+    tcp_socket_statistics statistics;
+    statistics.bytes_queued = counters_.bytes_queued.load(std::memory_order_relaxed);
+    statistics.bytes_sent = counters_.bytes_sent.load(std::memory_order_relaxed);
+    statistics.send_queue_size = counters_.send_queue_size.load(std::memory_order_relaxed);
+    statistics.peak_send_queue_size = counters_.peak_send_queue_size.load(std::memory_order_relaxed);
+    statistics.write_calls = counters_.write_calls.load(std::memory_order_relaxed);
+    statistics.buffers_sent = counters_.buffers_sent.load(std::memory_order_relaxed);
+    statistics.buffers_coalesced = counters_.buffers_coalesced.load(std::memory_order_relaxed);
+    statistics.backpressure_events = counters_.backpressure_events.load(std::memory_order_relaxed);
+    statistics.total_write_latency =
+        std::chrono::nanoseconds{counters_.total_write_latency.load(std::memory_order_relaxed)};
+    statistics.max_write_latency =
+        std::chrono::nanoseconds{counters_.max_write_latency.load(std::memory_order_relaxed)};
+    return statistics;
+}
+
+void tcp_socket::pause_reading() noexcept
+{
+    read_paused_ = true;
+}
+
+void tcp_socket::resume_reading()
+{
+    read_paused_ = false;
+
+    if (!read_stopped_)
+        return;
+
+    read_stopped_ = false;
+
+    if (socket_.is_open())
+        internal_handle_read();
+}
+
+auto tcp_socket::get_io_context() const noexcept -> asio::io_context &
+{
+    return context_;
+}
+
 void tcp_socket::internal_connect(const asio::ip::basic_resolver_results<asio::ip::tcp> &endpoint)
 {
     auto self(shared_from_this());
 
-    asio::async_connect(socket_, endpoint,
-                        asio::bind_executor(context_,
-                                            [self](const std::error_code ec, auto)
-                                            {
-                                                if (ec && ec != asio::error::eof)
-                                                    self->on_error(ec);
+    // The socket is a generic stream socket, so that it can also be used for other kinds of sockets.
+    std::vector<asio::generic::stream_protocol::endpoint> endpoints;
+
+    for (const auto &entry : endpoint)
+        endpoints.emplace_back(entry.endpoint());
+
+    asio::async_connect(socket_, std::move(endpoints),
+                        asio::bind_executor(context_, [self](const std::error_code ec, auto)
+                                            { self->internal_handle_connect(ec); }));
+}
+
+void tcp_socket::internal_handle_connect(const std::error_code &ec)
+{
+    if (ec)
+    {
+        on_error(ec);
+        socket_.close();
+        on_disconnected();
+        return;
+    }
+
+    // Clients typically send small requests and wait for the reply; delaying them to coalesce writes only adds
+    // latency. This fails on sockets that are not tcp, which is fine.
+    asio::error_code option_ec;
+    socket_.set_option(asio::ip::tcp::no_delay{true}, option_ec);
 
-                                                self->internal_handle_read();
-                                                self->on_connected();
-                                            }));
+    internal_handle_read();
+    on_started();
+    on_connected();
 }
 
 void tcp_socket::internal_socket_start()
 {
     internal_handle_read();
+    on_started();
     on_connected();
 }
 
 void tcp_socket::internal_handle_read()
 {
+    // The buffer of the previous read is reused, unless the protocol kept a reference to it or the read size changed.
+    if (!read_buffer_.unique() || read_buffer_.capacity() < read_size_)
+        read_buffer_ = get_buffer_pool().acquire(read_size_);
+
     auto self(shared_from_this());
 
-    socket_.async_read_some(asio::buffer(data_, tcp_socket_max_buff_len),
+    socket_.async_read_some(asio::buffer(read_buffer_.data(), read_size_),
                             asio::bind_executor(context_,
                                                 [self](const std::error_code ec, const std::size_t length)
                                                 {
@@ -108,10 +422,11 @@ void tcp_socket::internal_handle_read()
 
                                                     if (length > 0)
                                                     {
-                                                        self->on_data({self->data_.data(), length});
+                                                        self->internal_adapt_read_size(length);
+                                                        self->on_receive(self->read_buffer_.slice(0, length));
 
                                                         if (!ec && self->socket_.is_open())
-                                                            self->internal_handle_read();
+                                                            self->internal_continue_read();
                                                     }
                                                     else
                                                     {
@@ -121,28 +436,311 @@ void tcp_socket::internal_handle_read()
                                                 }));
 }
 
+void tcp_socket::internal_continue_read()
+{
+    if (read_paused_)
+    {
+        read_stopped_ = true;
+        return;
+    }
+
+    internal_handle_read();
+}
+
+void tcp_socket::internal_adapt_read_size(const std::size_t length) noexcept
+{
+    // A read that fills the whole buffer means that more data is likely waiting; read more at once next time.
+    if (length == read_size_)
+    {
+        small_reads_ = 0;
+        read_size_ = std::min<std::size_t>(read_size_ * 2, tcp_socket_max_read_size);
+        return;
+    }
+
+    // Only shrink after a couple of small reads in a row, so that the size does not go back and forth.
+    if (length < read_size_ / 4 && read_size_ > tcp_socket_min_read_size)
+    {
+        if (++small_reads_ < tcp_socket_read_shrink_count)
+            return;
+
+        small_reads_ = 0;
+        read_size_ /= 2;
+        return;
+    }
+
+    small_reads_ = 0;
+}
+
+void tcp_socket::internal_queue(send_entry entry)
+{
+    auto self(shared_from_this());
+
+    // Counted right away, so that a producer on another thread sees the effect of its sends immediately.
+    const auto size = static_cast<std::uint64_t>(std::size(entry.view));
+    counters_.bytes_queued.fetch_add(size, std::memory_order_relaxed);
+    internal::update_max(counters_.peak_send_queue_size,
+                         counters_.send_queue_size.fetch_add(size, std::memory_order_relaxed) + size);
+
+    entry.queued_at = std::chrono::steady_clock::now();
+
+    asio::post(context_,
+               [self, entry = std::move(entry)]() mutable
+               {
+                   const auto write_in_progress = !std::empty(self->send_data_queue_);
+
+                   if (!write_in_progress || !self->internal_coalesce(entry))
+                       self->send_data_queue_.push_back(std::move(entry));
+
+                   if (!self->backpressure_ && self->send_queue_size() > self->send_high_watermark_)
+                   {
+                       self->backpressure_ = true;
+                       self->counters_.backpressure_events.fetch_add(1, std::memory_order_relaxed);
+                       self->on_backpressure();
+                   }
+
+                   if (!write_in_progress)
+                       self->internal_handle_write();
+               });
+}
+
+auto tcp_socket::internal_coalesce(send_entry &entry) -> bool
+{
+    const auto size = std::size(entry.view);
+
+    if (entry.file || size >= tcp_socket_coalesce_size)
+        return false;
+
+    // Only entries that are not being written can be appended to.
+    const auto &back = send_data_queue_.back();
+
+    if (std::size(send_data_queue_) <= writing_count_ || !back.coalesced ||
+        std::size(back.buffer) + size > back.buffer.capacity())
+    {
+        send_entry coalesced;
+        coalesced.buffer = get_buffer_pool().acquire(tcp_socket_coalesce_buffer_size);
+        coalesced.buffer.resize(0);
+        coalesced.queued_at = entry.queued_at;
+        coalesced.coalesced = true;
+        send_data_queue_.push_back(std::move(coalesced));
+    }
+
+    auto &target = send_data_queue_.back();
+    const auto offset = std::size(target.buffer);
+    target.buffer.resize(offset + size);
+    std::memcpy(std::data(target.buffer) + offset, std::data(entry.view), size);
+    target.view = target.buffer.span();
+
+    counters_.buffers_coalesced.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+void tcp_socket::internal_complete_entries(const std::size_t count)
+{
+    const auto now = std::chrono::steady_clock::now();
+    std::uint64_t size = 0;
+
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        const auto &entry = send_data_queue_[i];
+        size += std::size(entry.view);
+
+        const auto latency = std::chrono::duration_cast<std::chrono::nanoseconds>(now - entry.queued_at).count();
+        counters_.total_write_latency.fetch_add(latency, std::memory_order_relaxed);
+
+        if (latency > counters_.max_write_latency.load(std::memory_order_relaxed))
+            counters_.max_write_latency.store(latency, std::memory_order_relaxed);
+    }
+
+    send_data_queue_.erase(std::begin(send_data_queue_),
+                           std::begin(send_data_queue_) + static_cast<std::ptrdiff_t>(count));
+    writing_count_ = 0;
+
+    counters_.buffers_sent.fetch_add(count, std::memory_order_relaxed);
+    counters_.send_queue_size.fetch_sub(size, std::memory_order_relaxed);
+
+    if (backpressure_ && send_queue_size() <= send_low_watermark_)
+    {
+        backpressure_ = false;
+        on_writable();
+    }
+}
+
 void tcp_socket::internal_handle_write()
 {
+    if (send_data_queue_.front().file)
+    {
+        writing_count_ = 1;
+        internal_handle_send_file();
+        return;
+    }
+
     auto self(shared_from_this());
 
-    const auto &data = send_data_queue_.front();
+    // Everything that was queued in the mean time is sent with a single gathered write, so that many small sends (ie.
+    // pipelined replies) do not each cost a separate system call.
+    write_buffers_.clear();
+    std::size_t size = 0;
+
+    for (const auto &entry : send_data_queue_)
+    {
+        if (entry.file || std::size(write_buffers_) == tcp_socket_max_write_buffers)
+            break;
 
-    asio::async_write(self->socket_, asio::buffer(std::data(*data), std::size(*data)),
-                      [self](const std::error_code ec, const std::size_t /*length*/)
+        write_buffers_.emplace_back(std::data(entry.view), std::size(entry.view));
+        size += std::size(entry.view);
+    }
+
+    writing_count_ = std::size(write_buffers_);
+
+    asio::async_write(self->socket_, write_buffers_, internal::counting_transfer_all(counters_.write_calls, size),
+                      [self](const std::error_code ec, const std::size_t length)
                       {
                           if (ec && ec != asio::error::eof)
                           {
-                              self->on_error(ec);
-                              self->on_disconnected();
-                              self->socket_.close();
+                              self->internal_handle_write_error(ec);
                               return;
                           }
 
-                          self->send_data_queue_.pop();
+                          self->counters_.bytes_sent.fetch_add(length, std::memory_order_relaxed);
+                          self->internal_complete_entries(self->writing_count_);
+                          self->internal_continue_write();
+                      });
+}
+
+#if (defined(AEON_PLATFORM_OS_LINUX))
+void tcp_socket::internal_handle_send_file()
+{
+    auto self(shared_from_this());
+    auto &entry = send_data_queue_.front();
+
+    // sendfile must not block the io context, so it returns EAGAIN when the socket buffer is full. Asio's own
+    // asynchronous operations are not affected by this.
+    if (!socket_.native_non_blocking())
+        socket_.native_non_blocking(true);
+
+    std::uint64_t sent = 0;
+
+    while (entry.file_remaining > 0)
+    {
+        // Give the other sockets a turn once in a while.
+        if (sent >= tcp_socket_file_send_size)
+        {
+            asio::post(context_, [self]() { self->internal_handle_send_file(); });
+            return;
+        }
+
+        auto offset = static_cast<off_t>(entry.file_offset);
+        const auto count = static_cast<std::size_t>(
+            std::min<std::uint64_t>(entry.file_remaining, tcp_socket_file_send_size));
+        const auto result = ::sendfile(socket_.native_handle(), entry.file->descriptor(), &offset, count);
+        counters_.write_calls.fetch_add(1, std::memory_order_relaxed);
+
+        if (result > 0)
+        {
+            counters_.bytes_sent.fetch_add(static_cast<std::uint64_t>(result), std::memory_order_relaxed);
+            entry.file_offset += static_cast<std::uint64_t>(result);
+            entry.file_remaining -= static_cast<std::uint64_t>(result);
+            sent += static_cast<std::uint64_t>(result);
+            continue;
+        }
+
+        if (result < 0 && errno == EINTR)
+            continue;
+
+        if (result < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+        {
+            socket_.async_wait(asio::socket_base::wait_write,
+                               [self](const std::error_code ec)
+                               {
+                                   if (ec)
+                                   {
+                                       self->internal_handle_write_error(ec);
+                                       return;
+                                   }
+
+                                   self->internal_handle_send_file();
+                               });
+            return;
+        }
+
+        // A result of 0 means that the file became smaller than expected.
+        internal_handle_write_error(std::make_error_code(result < 0 ? std::errc{errno} : std::errc::io_error));
+        return;
+    }
+
+    internal_complete_entries(1);
+    internal_continue_write();
+}
+#else
+void tcp_socket::internal_handle_send_file()
+{
+    auto self(shared_from_this());
+    auto &entry = send_data_queue_.front();
 
-                          if (!std::empty(self->send_data_queue_))
-                              self->internal_handle_write();
+    const auto count =
+        static_cast<std::size_t>(std::min<std::uint64_t>(entry.file_remaining, tcp_socket_file_chunk_size));
+    const auto data = entry.file->read(entry.file_offset, count);
+
+    if (std::empty(data))
+    {
+        internal_handle_write_error(std::make_error_code(std::errc::io_error));
+        return;
+    }
+
+    asio::async_write(socket_, asio::buffer(std::data(data), std::size(data)),
+                      internal::counting_transfer_all(counters_.write_calls, std::size(data)),
+                      [self](const std::error_code ec, const std::size_t length)
+                      {
+                          if (ec && ec != asio::error::eof)
+                          {
+                              self->internal_handle_write_error(ec);
+                              return;
+                          }
+
+                          self->counters_.bytes_sent.fetch_add(length, std::memory_order_relaxed);
+
+                          auto &entry = self->send_data_queue_.front();
+                          entry.file_offset += length;
+                          entry.file_remaining -= length;
+
+                          if (entry.file_remaining > 0)
+                          {
+                              self->internal_handle_send_file();
+                              return;
+                          }
+
+                          self->internal_complete_entries(1);
+                          self->internal_continue_write();
                       });
 }
+#endif
+
+void tcp_socket::internal_continue_write()
+{
+    if (!std::empty(send_data_queue_))
+        internal_handle_write();
+    else if (disconnect_after_send_)
+        internal_disconnect();
+    else
+        on_send_complete();
+}
+
+void tcp_socket::internal_handle_write_error(const std::error_code &ec)
+{
+    on_error(ec);
+    on_disconnected();
+    socket_.close();
+}
+
+void tcp_socket::internal_disconnect()
+{
+    if (!socket_.is_open())
+        return;
+
+    asio::error_code ec;
+    socket_.shutdown(asio::socket_base::shutdown_both, ec);
+    socket_.close(ec);
+    on_disconnected();
+}
 
 } // namespace aeon::sockets
@@ -0,0 +1,313 @@
+// Distributed under the BSD 2-Clause License - Copyright 2012-2023 Robin Degen
+
+#include <aeon/sockets/udp_socket.h>
+#include <aeon/common/platform.h>
+#include <asio/bind_executor.hpp>
+#include <asio/post.hpp>
+
+#if (defined(AEON_PLATFORM_OS_LINUX))
+#include <sys/socket.h>
+#include <cerrno>
+#include <array>
+#endif
+
+#include <algorithm>
+#include <cstring>
+
+namespace aeon::sockets
+{
+
+namespace internal
+{
+
+static constexpr std::size_t arena_size =
+    static_cast<std::size_t>(udp_socket_batch_size) * static_cast<std::size_t>(udp_socket_max_datagram_size);
+
+} // namespace internal
+
+udp_socket::udp_socket(asio::io_context &context, const asio::ip::udp::endpoint &endpoint)
+    : context_{context}
+    , socket_{context, endpoint}
+    , arena_{}
+    , sender_{}
+    , send_queue_{}
+{
+}
+
+udp_socket::udp_socket(asio::io_context &context, const asio::ip::udp &protocol)
+    : context_{context}
+    , socket_{context, protocol}
+    , arena_{}
+    , sender_{}
+    , send_queue_{}
+{
+}
+
+udp_socket::~udp_socket() = default;
+
+void udp_socket::on_datagram([[maybe_unused]] const asio::ip::udp::endpoint &sender,
+                             [[maybe_unused]] pooled_buffer data)
+{
+}
+
+void udp_socket::on_error([[maybe_unused]] const std::error_code &ec)
+{
+}
+
+void udp_socket::on_send_complete()
+{
+}
+
+void udp_socket::start()
+{
+    auto self(shared_from_this());
+
+    asio::post(context_, [self]() { self->internal_receive(); });
+}
+
+void udp_socket::send_to(const asio::ip::udp::endpoint &endpoint, pooled_buffer data)
+{
+    internal_queue(send_entry{endpoint, std::move(data)});
+}
+
+void udp_socket::send_to(const asio::ip::udp::endpoint &endpoint, const std::span<const std::byte> data)
+{
+    auto buffer = get_buffer_pool().acquire(std::size(data));
+    std::memcpy(std::data(buffer), std::data(data), std::size(data));
+    internal_queue(send_entry{endpoint, std::move(buffer)});
+}
+
+void udp_socket::close()
+{
+    auto self(shared_from_this());
+
+    asio::post(context_,
+               [self]()
+               {
+                   asio::error_code ec;
+                   self->socket_.close(ec);
+               });
+}
+
+auto udp_socket::local_endpoint() const -> asio::ip::udp::endpoint
+{
+    return socket_.local_endpoint();
+}
+
+auto udp_socket::get_io_context() const noexcept -> asio::io_context &
+{
+    return context_;
+}
+
+void udp_socket::internal_prepare_arena()
+{
+    // The arena of the previous batch is reused, unless the handler kept a slice of it.
+    if (!arena_.unique() || arena_.capacity() < internal::arena_size)
+        arena_ = get_buffer_pool().acquire(internal::arena_size);
+}
+
+#if (defined(AEON_PLATFORM_OS_LINUX))
+void udp_socket::internal_receive()
+{
+    if (!socket_.is_open())
+        return;
+
+    auto self(shared_from_this());
+
+    socket_.async_wait(asio::socket_base::wait_read,
+                       asio::bind_executor(context_,
+                                           [self](const std::error_code ec)
+                                           {
+                                               if (ec)
+                                               {
+                                                   if (ec != asio::error::operation_aborted)
+                                                       self->on_error(ec);
+
+                                                   return;
+                                               }
+
+                                               self->internal_handle_receive();
+                                           }));
+}
+
+void udp_socket::internal_handle_receive()
+{
+    internal_prepare_arena();
+
+    std::array<mmsghdr, udp_socket_batch_size> messages{};
+    std::array<iovec, udp_socket_batch_size> buffers{};
+    std::array<sockaddr_storage, udp_socket_batch_size> addresses{};
+
+    for (std::size_t i = 0; i < std::size(messages); ++i)
+    {
+        buffers[i].iov_base = std::data(arena_) + i * udp_socket_max_datagram_size;
+        buffers[i].iov_len = udp_socket_max_datagram_size;
+        messages[i].msg_hdr.msg_name = &addresses[i];
+        messages[i].msg_hdr.msg_namelen = sizeof(sockaddr_storage);
+        messages[i].msg_hdr.msg_iov = &buffers[i];
+        messages[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    const auto count = ::recvmmsg(socket_.native_handle(), std::data(messages),
+                                  static_cast<unsigned int>(std::size(messages)), MSG_DONTWAIT, nullptr);
+
+    if (count < 0)
+    {
+        // Errors are not fatal for a udp socket; ie. ECONNREFUSED only means that an earlier datagram was not received.
+        if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+            on_error(std::make_error_code(std::errc{errno}));
+
+        internal_receive();
+        return;
+    }
+
+    for (std::size_t i = 0; i < static_cast<std::size_t>(count); ++i)
+    {
+        const auto &header = messages[i].msg_hdr;
+
+        if ((header.msg_flags & MSG_TRUNC) != 0)
+        {
+            on_error(std::make_error_code(std::errc::message_size));
+            continue;
+        }
+
+        asio::ip::udp::endpoint sender;
+        std::memcpy(sender.data(), &addresses[i], std::min<std::size_t>(header.msg_namelen, sender.capacity()));
+        sender.resize(header.msg_namelen);
+
+        on_datagram(sender, arena_.slice(i * udp_socket_max_datagram_size, messages[i].msg_len));
+    }
+
+    internal_receive();
+}
+
+void udp_socket::internal_handle_send()
+{
+    std::array<mmsghdr, udp_socket_batch_size> messages{};
+    std::array<iovec, udp_socket_batch_size> buffers{};
+
+    while (!std::empty(send_queue_))
+    {
+        const auto count = std::min(std::size(send_queue_), std::size(messages));
+
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            auto &entry = send_queue_[i];
+            buffers[i].iov_base = std::data(entry.buffer);
+            buffers[i].iov_len = std::size(entry.buffer);
+            messages[i].msg_hdr.msg_name = entry.endpoint.data();
+            messages[i].msg_hdr.msg_namelen = static_cast<socklen_t>(entry.endpoint.size());
+            messages[i].msg_hdr.msg_iov = &buffers[i];
+            messages[i].msg_hdr.msg_iovlen = 1;
+        }
+
+        const auto sent = ::sendmmsg(socket_.native_handle(), std::data(messages), static_cast<unsigned int>(count),
+                                     MSG_DONTWAIT);
+
+        if (sent < 0)
+        {
+            if (errno == EINTR)
+                continue;
+
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+            {
+                internal_wait_send();
+                return;
+            }
+
+            // The first datagram could not be sent (ie. it is too large); drop it and continue with the others.
+            on_error(std::make_error_code(std::errc{errno}));
+            send_queue_.pop_front();
+            continue;
+        }
+
+        send_queue_.erase(std::begin(send_queue_), std::begin(send_queue_) + sent);
+    }
+
+    on_send_complete();
+}
+
+void udp_socket::internal_wait_send()
+{
+    auto self(shared_from_this());
+
+    socket_.async_wait(asio::socket_base::wait_write,
+                       asio::bind_executor(context_,
+                                           [self](const std::error_code ec)
+                                           {
+                                               if (ec)
+                                               {
+                                                   self->on_error(ec);
+                                                   self->send_queue_.clear();
+                                                   return;
+                                               }
+
+                                               self->internal_handle_send();
+                                           }));
+}
+#else
+void udp_socket::internal_receive()
+{
+    if (!socket_.is_open())
+        return;
+
+    internal_prepare_arena();
+
+    auto self(shared_from_this());
+
+    socket_.async_receive_from(asio::buffer(std::data(arena_), udp_socket_max_datagram_size), sender_,
+                               asio::bind_executor(context_,
+                                                   [self](const std::error_code ec, const std::size_t length)
+                                                   {
+                                                       if (ec == asio::error::operation_aborted)
+                                                           return;
+
+                                                       if (ec)
+                                                           self->on_error(ec);
+                                                       else
+                                                           self->on_datagram(self->sender_,
+                                                                             self->arena_.slice(0, length));
+
+                                                       self->internal_receive();
+                                                   }));
+}
+
+void udp_socket::internal_handle_send()
+{
+    auto self(shared_from_this());
+    auto &entry = send_queue_.front();
+
+    socket_.async_send_to(asio::buffer(std::data(entry.buffer), std::size(entry.buffer)), entry.endpoint,
+                          asio::bind_executor(context_,
+                                              [self](const std::error_code ec, const std::size_t /*length*/)
+                                              {
+                                                  if (ec)
+                                                      self->on_error(ec);
+
+                                                  self->send_queue_.pop_front();
+
+                                                  if (!std::empty(self->send_queue_))
+                                                      self->internal_handle_send();
+                                                  else
+                                                      self->on_send_complete();
+                                              }));
+}
+#endif
+
+void udp_socket::internal_queue(send_entry entry)
+{
+    auto self(shared_from_this());
+
+    asio::post(context_,
+               [self, entry = std::move(entry)]() mutable
+               {
+                   const auto send_in_progress = !std::empty(self->send_queue_);
+                   self->send_queue_.push_back(std::move(entry));
+
+                   // Sending is posted, so that all datagrams that are queued in the mean time are sent together.
+                   if (!send_in_progress)
+                       asio::post(self->context_, [self]() { self->internal_handle_send(); });
+               });
+}
+
+} // namespace aeon::sockets
@@ -0,0 +1,145 @@
+// Distributed under the BSD 2-Clause License - Copyright 2012-2023 Robin Degen
+
+#pragma once
+
+#include <aeon/sockets/config.h>
+#include <span>
+#include <array>
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace aeon::sockets
+{
+
+class buffer_pool;
+
+namespace detail
+{
+
+/*!
+ * The header in front of the data of every buffer that is handed out by a buffer_pool.
+ */
+struct buffer_block final
+{
+    std::atomic<std::uint32_t> references;
+    std::uint32_t size_class;
+    std::size_t capacity;
+    buffer_pool *pool;
+};
+
+} // namespace detail
+
+/*!
+ * A reference counted view into a buffer from a buffer_pool. Copies refer to the same memory; the buffer is returned
+ * to the pool once the last copy is destroyed. This allows received data to be kept (ie. a frame that is handled
+ * later, or on another thread) without copying it.
+ *
+ * The reference count is thread safe, the contents are not. A buffer should only be written to while it is unique.
+ */
+class pooled_buffer final
+{
+    friend class buffer_pool;
+
+public:
+    pooled_buffer() noexcept;
+    ~pooled_buffer();
+
+    pooled_buffer(pooled_buffer &&other) noexcept;
+    auto operator=(pooled_buffer &&other) noexcept -> pooled_buffer &;
+
+    pooled_buffer(const pooled_buffer &other) noexcept;
+    auto operator=(const pooled_buffer &other) noexcept -> pooled_buffer &;
+
+    [[nodiscard]] auto data() noexcept -> std::byte *;
+    [[nodiscard]] auto data() const noexcept -> const std::byte *;
+
+    [[nodiscard]] auto size() const noexcept -> std::size_t;
+    [[nodiscard]] auto empty() const noexcept -> bool;
+
+    /*!
+     * The amount of bytes from data() until the end of the underlying buffer.
+     */
+    [[nodiscard]] auto capacity() const noexcept -> std::size_t;
+
+    /*!
+     * Change the size of the view. The size must not exceed capacity().
+     */
+    void resize(const std::size_t size) noexcept;
+
+    /*!
+     * A view of a part of this buffer that shares the same memory.
+     */
+    [[nodiscard]] auto slice(const std::size_t offset, const std::size_t size) const noexcept -> pooled_buffer;
+
+    /*!
+     * Returns true if this is the only reference to the underlying buffer.
+     */
+    [[nodiscard]] auto unique() const noexcept -> bool;
+
+    [[nodiscard]] auto span() const noexcept -> std::span<const std::byte>;
+
+    operator std::span<const std::byte>() const noexcept;
+
+private:
+    explicit pooled_buffer(detail::buffer_block *block, std::byte *data, const std::size_t size) noexcept;
+
+    void release() noexcept;
+
+    detail::buffer_block *block_;
+    std::byte *data_;
+    std::size_t size_;
+};
+
+/*!
+ * A pool of buffers in power of 2 size classes, so that sockets do not allocate memory for every message they send or
+ * receive. Buffers larger than the largest size class are allocated and freed as usual. Thread safe; a pool may be
+ * shared by sockets that run on different threads.
+ */
+class buffer_pool final
+{
+    friend class pooled_buffer;
+
+public:
+    explicit buffer_pool(const std::size_t max_cached_bytes = buffer_pool_max_cached_bytes);
+    ~buffer_pool();
+
+    buffer_pool(buffer_pool &&) noexcept = delete;
+    auto operator=(buffer_pool &&) noexcept -> buffer_pool & = delete;
+
+    buffer_pool(const buffer_pool &) = delete;
+    auto operator=(const buffer_pool &) -> buffer_pool & = delete;
+
+    /*!
+     * Get a buffer of (at least) the given size. The size of the returned buffer is the given size; the capacity is
+     * rounded up to the size class.
+     */
+    [[nodiscard]] auto acquire(const std::size_t size) -> pooled_buffer;
+
+    /*!
+     * The amount of memory that is held by unused buffers.
+     */
+    [[nodiscard]] auto cached_bytes() const noexcept -> std::size_t;
+
+private:
+    struct size_class final
+    {
+        std::mutex mutex;
+        std::vector<detail::buffer_block *> free_blocks;
+    };
+
+    void release(detail::buffer_block *block) noexcept;
+
+    std::array<size_class, buffer_pool_size_classes> size_classes_;
+    std::atomic<std::size_t> cached_bytes_;
+    std::size_t max_cached_bytes_;
+};
+
+/*!
+ * The pool that is used by all sockets. Created on first use.
+ */
+[[nodiscard]] auto get_buffer_pool() -> buffer_pool &;
+
+} // namespace aeon::sockets
@@ -5,7 +5,61 @@
 namespace aeon::sockets
 {
 
-static inline constexpr auto tcp_socket_max_buff_len = 2048;
+// The size of the first read on a socket. Reads grow up to the max size as long as they fill up the whole buffer, and
+// shrink again when they mostly don't.
+static inline constexpr auto tcp_socket_min_read_size = 2048;
+static inline constexpr auto tcp_socket_max_read_size = 64 * 1024;
+
+// The amount of reads in a row that use less than a quarter of the buffer before the read size is halved.
+static inline constexpr auto tcp_socket_read_shrink_count = 8;
+
 static inline constexpr auto tcp_socket_circular_buffer_size = 1024 * 1024;
 
+// The largest frame that a length prefixed binary protocol socket accepts by default.
+static inline constexpr auto length_prefixed_max_frame_size = 64 * 1024 * 1024;
+
+// The longest line that a line protocol socket accepts by default.
+static inline constexpr auto line_protocol_max_line_length = 1024 * 1024;
+
+// The maximum amount of queued buffers that are sent with a single (gathered) write.
+static inline constexpr auto tcp_socket_max_write_buffers = 64;
+
+// The default amount of queued bytes at which a socket reports backpressure, and at which it reports being writable
+// again.
+static inline constexpr auto tcp_socket_send_high_watermark = 4 * 1024 * 1024;
+static inline constexpr auto tcp_socket_send_low_watermark = 1024 * 1024;
+
+// Buffers smaller than this that are sent while a write is in progress are copied together into a single buffer.
+static inline constexpr auto tcp_socket_coalesce_size = 512;
+
+// The size of the buffers that small buffers are copied into.
+static inline constexpr auto tcp_socket_coalesce_buffer_size = 16 * 1024;
+
+// The amount of file data that is sent before giving other sockets a turn.
+static inline constexpr auto tcp_socket_file_send_size = 1024 * 1024;
+
+// The size of the chunks in which a file is read on platforms without sendfile.
+static inline constexpr auto tcp_socket_file_chunk_size = 64 * 1024;
+
+// The buffer pool hands out buffers in power of 2 size classes, starting at this size.
+static inline constexpr auto buffer_pool_min_buffer_size = 512;
+
+// The amount of size classes; 512 bytes up to and including 64KB. Larger buffers are not pooled.
+static inline constexpr auto buffer_pool_size_classes = 8;
+
+// The maximum amount of memory that is kept in unused buffers, for all size classes combined.
+static inline constexpr auto buffer_pool_max_cached_bytes = 16 * 1024 * 1024;
+
+// The largest datagram that a udp socket can receive. Every datagram of a batch gets a slot of this size in the arena.
+static inline constexpr auto udp_socket_max_datagram_size = 2048;
+
+// The maximum amount of datagrams that a udp socket receives or sends with a single system call.
+static inline constexpr auto udp_socket_batch_size = 32;
+
+// The amount of times a shared memory ring checks for data (or room) before it sleeps on a futex.
+static inline constexpr auto shared_memory_ring_spin_count = 2000;
+
+// The smallest capacity of a shared memory ring.
+static inline constexpr auto shared_memory_ring_min_capacity = 4096;
+
 } // namespace aeon::sockets
@@ -4,16 +4,58 @@
 
 #include <aeon/sockets/tcp_socket.h>
 #include <aeon/streams/devices/memory_device.h>
-#include <aeon/streams/filters/circular_buffer_filter.h>
-#include <aeon/streams/stream.h>
-#include <aeon/streams/stream_reader.h>
+#include <aeon/streams/devices/memory_view_device.h>
 #include <aeon/streams/stream_writer.h>
 #include <concepts>
+#include <utility>
+#include <memory>
+#include <array>
+#include <cstring>
 
 namespace aeon::sockets
 {
 
-template <std::unsigned_integral length_t>
+/*!
+ * Use as length_t to prefix frames with their length as a varint (LEB128); 7 bits per byte, where the high bit means
+ * that more bytes follow. Small frames then only need a single byte for their length.
+ */
+struct varint_length
+{
+};
+
+template <typename T>
+concept length_prefix = std::unsigned_integral<T> || std::same_as<T, varint_length>;
+
+namespace detail
+{
+
+// A varint of a 64-bit length takes up to 10 bytes.
+static inline constexpr std::size_t max_varint_size = 10;
+
+template <length_prefix length_t>
+static inline constexpr std::size_t max_length_prefix_size =
+    std::same_as<length_t, varint_length> ? max_varint_size : sizeof(length_t);
+
+/*!
+ * Encode a length as varint. Returns the amount of bytes that were written.
+ */
+[[nodiscard]] inline auto encode_varint(std::uint64_t value, std::byte *data) noexcept -> std::size_t
+{
+    std::size_t size = 0;
+
+    while (value >= 0x80)
+    {
+        data[size++] = static_cast<std::byte>((value & 0x7f) | 0x80);
+        value >>= 7;
+    }
+
+    data[size++] = static_cast<std::byte>(value);
+    return size;
+}
+
+} // namespace detail
+
+template <length_prefix length_t>
 class length_prefixed_binary_frame : public streams::stream_writer<streams::memory_device<std::vector<std::byte>>>
 {
 public:
@@ -21,10 +63,12 @@ public:
         : stream_writer<streams::memory_device<std::vector<std::byte>>>{device_}
     {
         if (reserve_size > 0)
-            device_.reserve(reserve_size + sizeof(length_t));
+            device_.reserve(reserve_size + prefix_size);
 
-        // Write placeholder length at the start to avoid reallocation later
-        *this << length_t();
+        // Reserve room for the length at the start, so that the data does not have to be moved later. The size of a
+        // varint is not known up front; it is written at the end of the reserved room.
+        const std::array<std::byte, prefix_size> placeholder{};
+        device_.write(std::data(placeholder), static_cast<std::streamsize>(prefix_size));
     }
 
     ~length_prefixed_binary_frame() = default;
@@ -50,23 +94,60 @@ public:
     length_prefixed_binary_frame(const length_prefixed_binary_frame &) = delete;
     auto operator=(const length_prefixed_binary_frame &) -> length_prefixed_binary_frame & = delete;
 
+    /*!
+     * Release the frame, including its length prefix.
+     */
     [[nodiscard]] auto release() noexcept
     {
-        device_.seekp(0, streams::seek_direction::begin);
-        *this << length_t(device_.size() - sizeof(length_t));
+        auto [data, offset] = release_prefixed();
 
-        return std::move(device_.release());
+        if (offset > 0)
+            data.erase(std::begin(data), std::begin(data) + static_cast<std::ptrdiff_t>(offset));
+
+        return std::move(data);
+    }
+
+    /*!
+     * Release the frame without moving its data. The frame (including its length prefix) starts at the returned
+     * offset; this is always 0 for a fixed size length prefix.
+     */
+    [[nodiscard]] auto release_prefixed() noexcept -> std::pair<std::vector<std::byte>, std::size_t>
+    {
+        auto data = std::move(device_.release());
+        const auto length = std::size(data) - prefix_size;
+
+        if constexpr (std::same_as<length_t, varint_length>)
+        {
+            std::array<std::byte, detail::max_varint_size> varint{};
+            const auto size = detail::encode_varint(length, std::data(varint));
+            const auto offset = prefix_size - size;
+            std::memcpy(std::data(data) + offset, std::data(varint), size);
+            return {std::move(data), offset};
+        }
+        else
+        {
+            const auto value = static_cast<length_t>(length);
+            std::memcpy(std::data(data), &value, sizeof(length_t));
+            return {std::move(data), 0};
+        }
     }
 
 private:
+    static constexpr auto prefix_size = detail::max_length_prefix_size<length_t>;
+
     streams::memory_device<std::vector<std::byte>> device_;
 };
 
 /*!
  * Protocol implementation for a binary protocol that has its frames prefixed by a length
  * This is very common for binary protocol implementations over TCP
+ *
+ * Frames are decoded straight from the buffer that the socket received into. Every complete frame in a read is passed
+ * to on_receive_frame as a slice of that buffer, without copying it; only frames that are split over multiple reads
+ * are copied together. Frames that are larger than the max frame size are a protocol error; the socket is then
+ * disconnected.
  */
-template <std::unsigned_integral length_t>
+template <length_prefix length_t>
 class length_prefixed_binary_protocol_socket : public tcp_socket
 {
 public:
@@ -80,6 +161,11 @@ public:
      */
     explicit length_prefixed_binary_protocol_socket(asio::ip::tcp::socket socket);
 
+    /*!
+     * Server socket ctor for other kinds of stream sockets, like unix domain sockets
+     */
+    explicit length_prefixed_binary_protocol_socket(asio::generic::stream_protocol::socket socket);
+
     ~length_prefixed_binary_protocol_socket() override = default;
 
     length_prefixed_binary_protocol_socket(length_prefixed_binary_protocol_socket &&) = delete;
@@ -88,70 +174,270 @@ public:
     length_prefixed_binary_protocol_socket(const length_prefixed_binary_protocol_socket &) = delete;
     auto operator=(const length_prefixed_binary_protocol_socket &) -> length_prefixed_binary_protocol_socket & = delete;
 
-    virtual void on_frame(const streams::memory_view_device<std::vector<std::byte>> &frame) = 0;
+    /*!
+     * Called for every received frame, without its length prefix. The frame may be kept to use it later without
+     * copying it. By default this copies the frame and calls on_frame.
+     */
+    virtual void on_receive_frame(pooled_buffer frame);
+
+    virtual void on_frame(const streams::memory_view_device<std::vector<std::byte>> &frame);
 
     void send_frame(length_prefixed_binary_frame<length_t> frame);
 
+    /*!
+     * Send the given data as a frame. The length prefix and the data are copied into a single buffer from the pool.
+     */
+    void send_frame(const std::span<const std::byte> data);
+
+    /*!
+     * Set the largest frame that may be received. The default is length_prefixed_max_frame_size.
+     */
+    void set_max_frame_size(const std::size_t size) noexcept;
+
+    void on_receive(pooled_buffer data) override;
+
 private:
-    void on_data(const std::span<const std::byte> &data) override;
+    /*!
+     * Decode (the rest of) a length prefix from the given data. Returns the amount of bytes that were used, or 0 if
+     * the prefix is invalid.
+     */
+    [[nodiscard]] auto decode_length(const std::span<const std::byte> data) noexcept -> std::size_t;
+
+    void reset_length() noexcept;
+    void protocol_error();
+
+    // The length prefix that is being decoded. A fixed size prefix that is split over multiple reads is collected in
+    // length_bytes_; a varint is decoded as the bytes come in.
+    std::array<std::byte, detail::max_length_prefix_size<length_t>> length_bytes_;
+    std::size_t length_bytes_size_;
+    std::uint64_t length_;
+    bool has_length_;
 
-    streams::aggregate_device<streams::circular_buffer_filter, streams::memory_device<std::vector<std::byte>>>
-        circular_buffer_;
+    // A frame that is split over multiple reads.
+    pooled_buffer partial_frame_;
+    std::size_t partial_frame_size_;
 
-    length_t expected_length_;
+    std::size_t max_frame_size_;
     std::vector<std::byte> frame_buffer_;
 };
 
-template <std::unsigned_integral length_t>
+template <length_prefix length_t>
 inline length_prefixed_binary_protocol_socket<length_t>::length_prefixed_binary_protocol_socket(
     asio::io_context &service)
     : tcp_socket(service)
-    , circular_buffer_{streams::circular_buffer_filter{},
-                       streams::memory_device<std::vector<std::byte>>{tcp_socket_circular_buffer_size}}
-    , expected_length_{0}
+    , length_bytes_{}
+    , length_bytes_size_{0}
+    , length_{0}
+    , has_length_{false}
+    , partial_frame_{}
+    , partial_frame_size_{0}
+    , max_frame_size_{length_prefixed_max_frame_size}
+    , frame_buffer_{}
 {
 }
 
-template <std::unsigned_integral length_t>
+template <length_prefix length_t>
 inline length_prefixed_binary_protocol_socket<length_t>::length_prefixed_binary_protocol_socket(
     asio::ip::tcp::socket socket)
+    : length_prefixed_binary_protocol_socket{asio::generic::stream_protocol::socket{std::move(socket)}}
+{
+}
+
+template <length_prefix length_t>
+inline length_prefixed_binary_protocol_socket<length_t>::length_prefixed_binary_protocol_socket(
+    asio::generic::stream_protocol::socket socket)
     : tcp_socket(std::move(socket))
-    , circular_buffer_{streams::circular_buffer_filter{},
-                       streams::memory_device<std::vector<std::byte>>{tcp_socket_circular_buffer_size}}
-    , expected_length_{0}
+    , length_bytes_{}
+    , length_bytes_size_{0}
+    , length_{0}
+    , has_length_{false}
+    , partial_frame_{}
+    , partial_frame_size_{0}
+    , max_frame_size_{length_prefixed_max_frame_size}
+    , frame_buffer_{}
 {
 }
 
-template <std::unsigned_integral length_t>
-void length_prefixed_binary_protocol_socket<length_t>::send_frame(length_prefixed_binary_frame<length_t> frame)
+template <length_prefix length_t>
+inline void length_prefixed_binary_protocol_socket<length_t>::on_receive_frame(pooled_buffer frame)
 {
-    send(frame.release());
+    frame_buffer_.assign(std::data(frame), std::data(frame) + std::size(frame));
+    const streams::memory_view_device device{frame_buffer_};
+    on_frame(device);
 }
 
-template <std::unsigned_integral length_t>
-inline void length_prefixed_binary_protocol_socket<length_t>::on_data(const std::span<const std::byte> &data)
+template <length_prefix length_t>
+inline void length_prefixed_binary_protocol_socket<length_t>::on_frame(
+    [[maybe_unused]] const streams::memory_view_device<std::vector<std::byte>> &frame)
 {
-    circular_buffer_.write(std::data(data), std::size(data));
-    streams::stream_reader reader{circular_buffer_};
+}
 
-    while (true)
+template <length_prefix length_t>
+inline void length_prefixed_binary_protocol_socket<length_t>::send_frame(length_prefixed_binary_frame<length_t> frame)
+{
+    auto [data, offset] = frame.release_prefixed();
+
+    if (offset == 0)
     {
-        if (expected_length_ == 0 && circular_buffer_.size() >= sizeof(length_t))
-            reader >> expected_length_;
+        send(std::move(data));
+        return;
+    }
 
-        if (expected_length_ == 0)
-            break;
+    // Send the frame from where the varint starts, instead of moving the data to the front.
+    const auto size = std::size(data) - offset;
+    send(std::make_shared<const std::vector<std::byte>>(std::move(data)), offset, size);
+}
 
-        if (circular_buffer_.size() < expected_length_)
-            break;
+template <length_prefix length_t>
+inline void length_prefixed_binary_protocol_socket<length_t>::send_frame(const std::span<const std::byte> data)
+{
+    std::array<std::byte, detail::max_length_prefix_size<length_t>> prefix{};
+    std::size_t prefix_size = 0;
 
-        reader.read_to_vector<std::byte>(frame_buffer_, static_cast<std::streamoff>(expected_length_));
-        streams::memory_view_device device{frame_buffer_};
-        on_frame(device);
-        frame_buffer_.clear();
+    if constexpr (std::same_as<length_t, varint_length>)
+    {
+        prefix_size = detail::encode_varint(std::size(data), std::data(prefix));
+    }
+    else
+    {
+        const auto length = static_cast<length_t>(std::size(data));
+        std::memcpy(std::data(prefix), &length, sizeof(length_t));
+        prefix_size = sizeof(length_t);
+    }
+
+    auto buffer = get_buffer_pool().acquire(prefix_size + std::size(data));
+    std::memcpy(std::data(buffer), std::data(prefix), prefix_size);
+    std::memcpy(std::data(buffer) + prefix_size, std::data(data), std::size(data));
+    send(std::move(buffer));
+}
+
+template <length_prefix length_t>
+inline void length_prefixed_binary_protocol_socket<length_t>::set_max_frame_size(const std::size_t size) noexcept
+{
+    max_frame_size_ = size;
+}
 
-        expected_length_ = 0;
+template <length_prefix length_t>
+inline void length_prefixed_binary_protocol_socket<length_t>::on_receive(pooled_buffer data)
+{
+    std::size_t offset = 0;
+    const auto size = std::size(data);
+
+    while (offset < size)
+    {
+        // Continue a frame that was split over multiple reads.
+        if (has_length_)
+        {
+            const auto count = std::min(size - offset, static_cast<std::size_t>(length_) - partial_frame_size_);
+            std::memcpy(std::data(partial_frame_) + partial_frame_size_, std::data(data) + offset, count);
+            partial_frame_size_ += count;
+            offset += count;
+
+            if (partial_frame_size_ < length_)
+                return;
+
+            reset_length();
+            on_receive_frame(std::move(partial_frame_));
+            continue;
+        }
+
+        const auto used = decode_length(data.span().subspan(offset));
+
+        if (used == 0)
+        {
+            protocol_error();
+            return;
+        }
+
+        offset += used;
+
+        if (!has_length_)
+            return;
+
+        if (length_ > max_frame_size_)
+        {
+            protocol_error();
+            return;
+        }
+
+        const auto length = static_cast<std::size_t>(length_);
+
+        // The common case: the whole frame is in this read. It is passed on without copying it.
+        if (size - offset >= length)
+        {
+            reset_length();
+            on_receive_frame(data.slice(offset, length));
+            offset += length;
+            continue;
+        }
+
+        partial_frame_ = get_buffer_pool().acquire(length);
+        partial_frame_size_ = 0;
     }
 }
 
+template <length_prefix length_t>
+inline auto length_prefixed_binary_protocol_socket<length_t>::decode_length(
+    const std::span<const std::byte> data) noexcept -> std::size_t
+{
+    if constexpr (std::same_as<length_t, varint_length>)
+    {
+        for (std::size_t i = 0; i < std::size(data); ++i)
+        {
+            if (length_bytes_size_ == detail::max_varint_size)
+                return 0;
+
+            const auto value = static_cast<std::uint64_t>(data[i]);
+
+            // The 10th byte only holds the highest bit of a 64-bit length, and must be the last one.
+            if (length_bytes_size_ == detail::max_varint_size - 1 && value > 1)
+                return 0;
+
+            length_ |= (value & 0x7f) << (7 * length_bytes_size_++);
+
+            if ((value & 0x80) == 0)
+            {
+                has_length_ = true;
+                return i + 1;
+            }
+        }
+
+        return std::size(data);
+    }
+    else
+    {
+        const auto count = std::min(std::size(data), sizeof(length_t) - length_bytes_size_);
+        std::memcpy(std::data(length_bytes_) + length_bytes_size_, std::data(data), count);
+        length_bytes_size_ += count;
+
+        if (length_bytes_size_ == sizeof(length_t))
+        {
+            length_t value{};
+            std::memcpy(&value, std::data(length_bytes_), sizeof(length_t));
+            length_ = value;
+            has_length_ = true;
+        }
+
+        return count;
+    }
+}
+
+template <length_prefix length_t>
+inline void length_prefixed_binary_protocol_socket<length_t>::reset_length() noexcept
+{
+    length_bytes_size_ = 0;
+    length_ = 0;
+    has_length_ = false;
+    partial_frame_size_ = 0;
+}
+
+template <length_prefix length_t>
+inline void length_prefixed_binary_protocol_socket<length_t>::protocol_error()
+{
+    reset_length();
+    partial_frame_ = pooled_buffer{};
+    on_error(std::make_error_code(std::errc::protocol_error));
+    disconnect();
+}
+
 } // namespace aeon::sockets
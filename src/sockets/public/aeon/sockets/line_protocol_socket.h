@@ -3,9 +3,8 @@
 #pragma once
 
 #include <aeon/sockets/tcp_socket.h>
-#include <aeon/streams/devices/memory_device.h>
-#include <aeon/streams/filters/circular_buffer_filter.h>
-#include <aeon/streams/stream.h>
+#include <aeon/sockets/config.h>
+#include <aeon/common/string.h>
 
 namespace aeon::sockets
 {
@@ -30,6 +29,11 @@ public:
      */
     explicit line_protocol_socket(asio::ip::tcp::socket socket);
 
+    /*!
+     * Server socket ctor for other kinds of stream sockets, like unix domain sockets
+     */
+    explicit line_protocol_socket(asio::generic::stream_protocol::socket socket);
+
     line_protocol_socket(line_protocol_socket &&) = delete;
     auto operator=(line_protocol_socket &&) -> line_protocol_socket & = delete;
 
@@ -41,11 +45,21 @@ public:
 protected:
     virtual void on_line(const common::string &line) = 0;
 
+    /*!
+     * Set the longest line that may be received, not counting the line ending. A longer line is reported to on_error
+     * as a protocol error, after which the socket is disconnected. The default is line_protocol_max_line_length.
+     */
+    void set_max_line_length(const std::size_t length) noexcept;
+
 private:
-    void on_data(const std::span<const std::byte> &data) override;
+    void on_receive(pooled_buffer data) override;
+
+    void line_too_long();
 
-    streams::aggregate_device<streams::circular_buffer_filter, streams::memory_device<std::vector<char>>>
-        circular_buffer_;
+    // Line endings are searched for in the received data directly. Every line is copied into this string once before
+    // it is passed to on_line; it keeps its capacity between lines.
+    common::string line_;
+    std::size_t max_line_length_;
 };
 
 } // namespace aeon::sockets
@@ -0,0 +1,71 @@
+// Distributed under the BSD 2-Clause License - Copyright 2012-2023 Robin Degen
+
+#pragma once
+
+#include <aeon/sockets/tcp_socket.h>
+#include <asio/io_context.hpp>
+
+#if (defined(ASIO_HAS_LOCAL_SOCKETS))
+#include <asio/local/stream_protocol.hpp>
+#include <filesystem>
+#include <memory>
+
+namespace aeon::sockets
+{
+
+/*!
+ * Unix domain socket client class; the counterpart of local_server. socket_handler_t must be given some
+ * implementation of tcp_socket, the same as for tcp_client.
+ */
+template <typename socket_handler_t>
+class local_client
+{
+public:
+    explicit local_client(asio::io_context &io_context);
+    explicit local_client(asio::io_context &io_context, const std::filesystem::path &path);
+    ~local_client() = default;
+
+    local_client(local_client &&) = delete;
+    auto operator=(local_client &&) -> local_client & = delete;
+
+    local_client(const local_client &) = delete;
+    auto operator=(const local_client &) -> local_client & = delete;
+
+    void connect(const std::filesystem::path &path);
+
+    auto operator->() const -> socket_handler_t *;
+
+protected:
+    std::shared_ptr<socket_handler_t> socket_;
+    asio::io_context &io_context_;
+};
+
+template <typename socket_handler_t>
+inline local_client<socket_handler_t>::local_client(asio::io_context &io_context)
+    : socket_{std::make_shared<socket_handler_t>(io_context)}
+    , io_context_{io_context}
+{
+}
+
+template <typename socket_handler_t>
+inline local_client<socket_handler_t>::local_client(asio::io_context &io_context, const std::filesystem::path &path)
+    : local_client{io_context}
+{
+    connect(path);
+}
+
+template <typename socket_handler_t>
+inline void local_client<socket_handler_t>::connect(const std::filesystem::path &path)
+{
+    socket_->connect(asio::local::stream_protocol::endpoint{path.string()});
+}
+
+template <typename socket_handler_t>
+inline auto local_client<socket_handler_t>::operator->() const -> socket_handler_t *
+{
+    return socket_.get();
+}
+
+} // namespace aeon::sockets
+
+#endif
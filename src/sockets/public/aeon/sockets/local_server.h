@@ -0,0 +1,131 @@
+// Distributed under the BSD 2-Clause License - Copyright 2012-2023 Robin Degen
+
+#pragma once
+
+#include <aeon/sockets/tcp_server.h>
+#include <aeon/sockets/tcp_socket.h>
+#include <asio/io_context.hpp>
+
+#if (defined(ASIO_HAS_LOCAL_SOCKETS))
+#include <asio/local/stream_protocol.hpp>
+#include <filesystem>
+#include <memory>
+#include <system_error>
+#include <type_traits>
+
+namespace aeon::sockets
+{
+
+/*!
+ * Unix domain socket server class, for processes that communicate on the same host. This avoids the overhead of the
+ * TCP stack that a connection over the loopback interface would have.
+ *
+ * socket_t must be given some implementation of tcp_socket that can be constructed from a
+ * asio::generic::stream_protocol::socket. The protocols (line_protocol_socket,
+ * length_prefixed_binary_protocol_socket, etc.) can be used as they are.
+ *
+ * session_t works the same as for tcp_server.
+ *
+ * A stale socket file at the given path (ie. from a process that was killed) is removed before binding; the socket file
+ * is removed again when the server is destroyed.
+ */
+template <typename socket_t, typename session_t = default_session>
+class local_server
+{
+public:
+    explicit local_server(asio::io_context &io_context, const std::filesystem::path &path);
+    explicit local_server(asio::io_context &io_context, std::unique_ptr<session_t> session_handler,
+                          const std::filesystem::path &path);
+    ~local_server();
+
+    local_server(local_server &&) = delete;
+    auto operator=(local_server &&) -> local_server & = delete;
+
+    local_server(const local_server &) = delete;
+    auto operator=(const local_server &) -> local_server & = delete;
+
+    auto get_session() const -> session_t &;
+
+protected:
+    void start_async_accept();
+
+    std::filesystem::path path_;
+    asio::local::stream_protocol::acceptor acceptor_;
+    asio::local::stream_protocol::socket socket_;
+    asio::io_context &io_context_;
+    std::unique_ptr<session_t> session_handler_;
+};
+
+template <typename socket_t, typename session_t>
+inline local_server<socket_t, session_t>::local_server(asio::io_context &io_context, const std::filesystem::path &path)
+    : local_server{io_context, std::make_unique<session_t>(), path}
+{
+}
+
+template <typename socket_t, typename session_t>
+inline local_server<socket_t, session_t>::local_server(asio::io_context &io_context,
+                                                       std::unique_ptr<session_t> session_handler,
+                                                       const std::filesystem::path &path)
+    : path_{path}
+    , acceptor_{io_context}
+    , socket_{io_context}
+    , io_context_{io_context}
+    , session_handler_{std::move(session_handler)}
+{
+    std::error_code ec;
+    std::filesystem::remove(path_, ec);
+
+    const asio::local::stream_protocol::endpoint endpoint{path_.string()};
+    acceptor_.open(endpoint.protocol());
+    acceptor_.bind(endpoint);
+    acceptor_.listen();
+
+    start_async_accept();
+}
+
+template <typename socket_t, typename session_t>
+inline local_server<socket_t, session_t>::~local_server()
+{
+    asio::error_code ec;
+    acceptor_.close(ec);
+
+    std::error_code remove_ec;
+    std::filesystem::remove(path_, remove_ec);
+}
+
+template <typename socket_t, typename session_t>
+inline void local_server<socket_t, session_t>::start_async_accept()
+{
+    acceptor_.async_accept(
+        socket_,
+        [this](std::error_code ec)
+        {
+            if (ec == asio::error::operation_aborted)
+                return;
+
+            if (!ec)
+            {
+                asio::generic::stream_protocol::socket socket{std::move(socket_)};
+
+                if constexpr (std::is_same<session_t, default_session>::value)
+                {
+                    std::make_shared<socket_t>(std::move(socket))->internal_socket_start();
+                }
+                else
+                {
+                    std::make_shared<socket_t>(std::move(socket), *session_handler_)->internal_socket_start();
+                }
+            }
+            start_async_accept();
+        });
+}
+
+template <typename socket_t, typename session_t>
+inline auto local_server<socket_t, session_t>::get_session() const -> session_t &
+{
+    return *session_handler_;
+}
+
+} // namespace aeon::sockets
+
+#endif
@@ -0,0 +1,103 @@
+// Distributed under the BSD 2-Clause License - Copyright 2012-2023 Robin Degen
+
+#pragma once
+
+#include <aeon/sockets/config.h>
+#include <aeon/common/platform.h>
+
+#if (defined(AEON_PLATFORM_OS_LINUX))
+#include <aeon/common/string.h>
+#include <span>
+#include <cstddef>
+#include <cstdint>
+
+namespace aeon::sockets
+{
+
+namespace detail
+{
+
+struct shared_memory_ring_header;
+
+} // namespace detail
+
+/*!
+ * A ring buffer in shared memory for bulk transfers between two processes on the same host. Data is copied into and
+ * out of the ring exactly once, without any system calls as long as neither side has to wait. A side that has to wait
+ * spins for a short while and then sleeps on a futex in the shared memory, which the other side only wakes up if it is
+ * actually sleeping.
+ *
+ * One process creates the ring under a name; the other opens it by that name. The ring is a byte stream with a single
+ * writer and a single reader; it does not preserve message boundaries, so a protocol on top of it must frame its
+ * messages (ie. by prefixing them with their length). For bidirectional communication use two rings.
+ *
+ * All calls block. They are meant to be used from a dedicated thread, not from an io_context.
+ */
+class shared_memory_ring final
+{
+public:
+    /*!
+     * Create a new ring with the given name. The capacity is rounded up to a power of 2. The name is removed again when
+     * the ring that created it is destroyed; processes that opened it can keep using it until they close it.
+     * Throws std::system_error on failure.
+     */
+    explicit shared_memory_ring(const common::string &name, const std::size_t capacity);
+
+    /*!
+     * Open an existing ring that was created by another process (or in the same process).
+     * Throws std::system_error on failure, or std::invalid_argument if the shared memory does not contain a ring.
+     */
+    explicit shared_memory_ring(const common::string &name);
+
+    ~shared_memory_ring();
+
+    shared_memory_ring(shared_memory_ring &&other) noexcept;
+    auto operator=(shared_memory_ring &&other) noexcept -> shared_memory_ring &;
+
+    shared_memory_ring(const shared_memory_ring &) = delete;
+    auto operator=(const shared_memory_ring &) -> shared_memory_ring & = delete;
+
+    /*!
+     * Write all of the given data, waiting for the reader to make room if needed. Data larger than the capacity of the
+     * ring is written in parts. Returns false if the ring was closed before all data could be written.
+     */
+    [[nodiscard]] auto write(const std::span<const std::byte> data) -> bool;
+
+    /*!
+     * Read at least 1 and up to the size of the given buffer, waiting for data if the ring is empty. Returns the amount
+     * of bytes that were read; 0 once the ring was closed and all data that was written before was read.
+     */
+    [[nodiscard]] auto read(const std::span<std::byte> data) -> std::size_t;
+
+    /*!
+     * Read whatever is available without waiting. Returns the amount of bytes that were read, which may be 0.
+     */
+    [[nodiscard]] auto try_read(const std::span<std::byte> data) -> std::size_t;
+
+    /*!
+     * Close the ring. A reader that waits for data and a writer that waits for room are woken up. Data that was
+     * already written can still be read.
+     */
+    void close() noexcept;
+
+    [[nodiscard]] auto is_closed() const noexcept -> bool;
+
+    /*!
+     * The amount of bytes that the ring can hold.
+     */
+    [[nodiscard]] auto capacity() const noexcept -> std::size_t;
+
+private:
+    void map(const int fd, const std::size_t size);
+    void release() noexcept;
+
+    common::string name_;
+    detail::shared_memory_ring_header *header_;
+    std::byte *data_;
+    std::size_t mapped_size_;
+    bool owner_;
+};
+
+} // namespace aeon::sockets
+
+#endif
@@ -57,7 +57,6 @@ template <typename socket_t, typename session_t>
 inline tcp_server<socket_t, session_t>::tcp_server(asio::io_context &io_context, const std::uint16_t port)
     : tcp_server{io_context, std::make_unique<session_t>(), port}
 {
-    start_async_accept();
 }
 
 template <typename socket_t, typename session_t>
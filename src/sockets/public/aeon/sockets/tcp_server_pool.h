@@ -0,0 +1,279 @@
+// Distributed under the BSD 2-Clause License - Copyright 2012-2023 Robin Degen
+
+#pragma once
+
+#include <aeon/sockets/tcp_server.h>
+#include <aeon/sockets/tcp_socket.h>
+#include <asio/io_context.hpp>
+#include <asio/ip/tcp.hpp>
+#include <asio/post.hpp>
+#include <algorithm>
+#include <memory>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <type_traits>
+#include <cstdint>
+#include <cstddef>
+
+namespace aeon::sockets
+{
+
+enum class connection_distribution
+{
+    // A single listener that hands out connections to the threads in turn.
+    round_robin,
+
+    // A listener per thread on the same port (SO_REUSEPORT), so that the kernel distributes the connections. This also
+    // spreads out the accepting itself. Falls back to round_robin on platforms that don't support it.
+    reuse_port
+};
+
+namespace detail
+{
+
+/*!
+ * Pin the calling thread to the given cpu core. Does nothing on platforms where this is not supported.
+ */
+void pin_current_thread(const std::size_t core) noexcept;
+
+/*!
+ * Enable SO_REUSEPORT on the given acceptor. Returns false if this is not supported.
+ */
+[[nodiscard]] auto enable_reuse_port(asio::ip::tcp::acceptor &acceptor) noexcept -> bool;
+
+} // namespace detail
+
+/*!
+ * A TCP server that owns a thread per core, each with its own io_context.
+ *
+ * A connection stays on the thread that it was given to, so a socket is never accessed from multiple threads at the
+ * same time and sockets need no locking. The session however is shared between all threads; it must be safe to use
+ * concurrently.
+ *
+ * See tcp_server for the requirements of socket_t and session_t.
+ */
+template <typename socket_t, typename session_t = default_session>
+class tcp_server_pool
+{
+    struct worker
+    {
+        explicit worker(const std::uint16_t port, const bool listen, const bool reuse_port);
+
+        asio::io_context context;
+        asio::executor_work_guard<asio::io_context::executor_type> work_guard;
+        std::unique_ptr<asio::ip::tcp::acceptor> acceptor;
+        std::thread thread;
+    };
+
+public:
+    /*!
+     * Create a server with the given amount of threads. A thread count of 0 uses a thread per core. The threads are
+     * only started when calling start(), so that the session can be configured first.
+     */
+    explicit tcp_server_pool(const std::uint16_t port, const std::size_t thread_count = 0,
+                             const connection_distribution distribution = connection_distribution::reuse_port);
+    explicit tcp_server_pool(std::unique_ptr<session_t> session_handler, const std::uint16_t port,
+                             const std::size_t thread_count = 0,
+                             const connection_distribution distribution = connection_distribution::reuse_port);
+
+    /*!
+     * Stops the server and waits for all threads to finish.
+     */
+    ~tcp_server_pool();
+
+    tcp_server_pool(tcp_server_pool &&) = delete;
+    auto operator=(tcp_server_pool &&) -> tcp_server_pool & = delete;
+
+    tcp_server_pool(const tcp_server_pool &) = delete;
+    auto operator=(const tcp_server_pool &) -> tcp_server_pool & = delete;
+
+    /*!
+     * Start the threads. If pin_threads is set, each thread is pinned to a core.
+     */
+    void start(const bool pin_threads = false);
+
+    /*!
+     * Stop all threads and wait for them to finish. Open connections are dropped.
+     */
+    void stop();
+
+    [[nodiscard]] auto get_session() const -> session_t &;
+
+    [[nodiscard]] auto thread_count() const noexcept -> std::size_t;
+
+    [[nodiscard]] auto get_distribution() const noexcept -> connection_distribution;
+
+private:
+    void start_async_accept(worker &w);
+    void start_socket(asio::ip::tcp::socket socket);
+
+    std::unique_ptr<session_t> session_handler_;
+    std::vector<std::unique_ptr<worker>> workers_;
+    connection_distribution distribution_;
+    std::atomic<std::size_t> next_worker_;
+};
+
+template <typename socket_t, typename session_t>
+inline tcp_server_pool<socket_t, session_t>::worker::worker(const std::uint16_t port, const bool listen,
+                                                             const bool reuse_port)
+    : context{1}
+    , work_guard{asio::make_work_guard(context)}
+    , acceptor{}
+    , thread{}
+{
+    if (!listen)
+        return;
+
+    const asio::ip::tcp::endpoint endpoint{asio::ip::tcp::v4(), port};
+    acceptor = std::make_unique<asio::ip::tcp::acceptor>(context);
+    acceptor->open(endpoint.protocol());
+    acceptor->set_option(asio::ip::tcp::acceptor::reuse_address{true});
+
+    if (reuse_port)
+    {
+        [[maybe_unused]] const auto result = detail::enable_reuse_port(*acceptor);
+    }
+
+    acceptor->bind(endpoint);
+    acceptor->listen();
+}
+
+template <typename socket_t, typename session_t>
+inline tcp_server_pool<socket_t, session_t>::tcp_server_pool(const std::uint16_t port, const std::size_t thread_count,
+                                                             const connection_distribution distribution)
+    : tcp_server_pool{std::make_unique<session_t>(), port, thread_count, distribution}
+{
+}
+
+template <typename socket_t, typename session_t>
+inline tcp_server_pool<socket_t, session_t>::tcp_server_pool(std::unique_ptr<session_t> session_handler,
+                                                             const std::uint16_t port, const std::size_t thread_count,
+                                                             const connection_distribution distribution)
+    : session_handler_{std::move(session_handler)}
+    , workers_{}
+    , distribution_{distribution}
+    , next_worker_{0}
+{
+    auto count = thread_count;
+
+    if (count == 0)
+        count = std::max(std::thread::hardware_concurrency(), 1u);
+
+    // Check if the platform supports SO_REUSEPORT before creating the other listeners.
+    if (distribution_ == connection_distribution::reuse_port)
+    {
+        asio::io_context context;
+        asio::ip::tcp::acceptor acceptor{context, asio::ip::tcp::v4()};
+
+        if (!detail::enable_reuse_port(acceptor))
+            distribution_ = connection_distribution::round_robin;
+    }
+
+    const auto reuse_port = (distribution_ == connection_distribution::reuse_port);
+    workers_.reserve(count);
+
+    for (std::size_t i = 0; i < count; ++i)
+        workers_.push_back(std::make_unique<worker>(port, reuse_port || i == 0, reuse_port));
+
+    for (auto &w : workers_)
+    {
+        if (w->acceptor)
+            start_async_accept(*w);
+    }
+}
+
+template <typename socket_t, typename session_t>
+inline tcp_server_pool<socket_t, session_t>::~tcp_server_pool()
+{
+    stop();
+}
+
+template <typename socket_t, typename session_t>
+inline void tcp_server_pool<socket_t, session_t>::start(const bool pin_threads)
+{
+    for (std::size_t i = 0; i < std::size(workers_); ++i)
+    {
+        auto &w = *workers_[i];
+
+        if (w.thread.joinable())
+            continue;
+
+        w.thread = std::thread{[&w, i, pin_threads]()
+                               {
+                                   if (pin_threads)
+                                       detail::pin_current_thread(i);
+
+                                   w.context.run();
+                               }};
+    }
+}
+
+template <typename socket_t, typename session_t>
+inline void tcp_server_pool<socket_t, session_t>::stop()
+{
+    for (auto &w : workers_)
+        w->context.stop();
+
+    for (auto &w : workers_)
+    {
+        if (w->thread.joinable())
+            w->thread.join();
+    }
+}
+
+template <typename socket_t, typename session_t>
+inline auto tcp_server_pool<socket_t, session_t>::get_session() const -> session_t &
+{
+    return *session_handler_;
+}
+
+template <typename socket_t, typename session_t>
+inline auto tcp_server_pool<socket_t, session_t>::thread_count() const noexcept -> std::size_t
+{
+    return std::size(workers_);
+}
+
+template <typename socket_t, typename session_t>
+inline auto tcp_server_pool<socket_t, session_t>::get_distribution() const noexcept -> connection_distribution
+{
+    return distribution_;
+}
+
+template <typename socket_t, typename session_t>
+inline void tcp_server_pool<socket_t, session_t>::start_async_accept(worker &w)
+{
+    // With a single listener, the new socket is directly created on the io_context of the next worker.
+    auto &target = (distribution_ == connection_distribution::reuse_port)
+                       ? w.context
+                       : workers_[next_worker_.fetch_add(1, std::memory_order_relaxed) % std::size(workers_)]->context;
+
+    w.acceptor->async_accept(target,
+                             [this, &w](const std::error_code ec, asio::ip::tcp::socket socket)
+                             {
+                                 if (ec == asio::error::operation_aborted)
+                                     return;
+
+                                 if (!ec)
+                                     start_socket(std::move(socket));
+
+                                 start_async_accept(w);
+                             });
+}
+
+template <typename socket_t, typename session_t>
+inline void tcp_server_pool<socket_t, session_t>::start_socket(asio::ip::tcp::socket socket)
+{
+    std::shared_ptr<socket_t> s;
+
+    if constexpr (std::is_same<session_t, default_session>::value)
+        s = std::make_shared<socket_t>(std::move(socket));
+    else
+        s = std::make_shared<socket_t>(std::move(socket), *session_handler_);
+
+    // The socket may belong to another thread; it must only be used from there.
+    auto executor = s->get_io_context().get_executor();
+    asio::post(executor, [s = std::move(s)]() { s->internal_socket_start(); });
+}
+
+} // namespace aeon::sockets
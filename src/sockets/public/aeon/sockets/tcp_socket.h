@@ -3,25 +3,71 @@
 #pragma once
 
 #include <aeon/sockets/config.h>
-#include <aeon/common/unique_obj.h>
+#include <aeon/sockets/buffer_pool.h>
 #include <asio/io_context.hpp>
 #include <asio/ip/tcp.hpp>
-#include <queue>
-#include <array>
+#include <asio/generic/stream_protocol.hpp>
+
+#if (defined(ASIO_HAS_LOCAL_SOCKETS))
+#include <asio/local/stream_protocol.hpp>
+#endif
+
+#include <filesystem>
+#include <chrono>
+#include <atomic>
+#include <deque>
+#include <vector>
 #include <memory>
 #include <span>
+#include <cstdint>
 
 namespace aeon::sockets
 {
 
+/*!
+ * Counters of a tcp socket for monitoring; see tcp_socket::statistics().
+ */
+struct tcp_socket_statistics
+{
+    // The total amount of bytes that were passed to send(); files are not included.
+    std::uint64_t bytes_queued = 0;
+
+    // The total amount of bytes that were written to the socket, including files.
+    std::uint64_t bytes_sent = 0;
+
+    // The amount of bytes that are currently in the send queue, and the most that it ever was.
+    std::uint64_t send_queue_size = 0;
+    std::uint64_t peak_send_queue_size = 0;
+
+    // The amount of write system calls (writev, sendfile) that were done.
+    std::uint64_t write_calls = 0;
+
+    // The amount of buffers that were written, and the amount of small buffers that were copied together into them.
+    std::uint64_t buffers_sent = 0;
+    std::uint64_t buffers_coalesced = 0;
+
+    // The amount of times the send queue went over the high watermark.
+    std::uint64_t backpressure_events = 0;
+
+    // The time between send() and the moment the data was written, summed up over all buffers, and the longest.
+    std::chrono::nanoseconds total_write_latency{};
+    std::chrono::nanoseconds max_write_latency{};
+};
+
 class tcp_socket : public std::enable_shared_from_this<tcp_socket>
 {
     template <typename socket_handler_t, typename session_handler_t>
     friend class tcp_server;
 
+    template <typename socket_handler_t, typename session_handler_t>
+    friend class tcp_server_pool;
+
     template <typename socket_handler_t>
     friend class tcp_client;
 
+    template <typename socket_handler_t, typename session_handler_t>
+    friend class local_server;
+
 public:
     /*!
      * Client socket ctor
@@ -33,6 +79,12 @@ public:
      */
     explicit tcp_socket(asio::ip::tcp::socket socket);
 
+    /*!
+     * Server socket ctor for any kind of stream socket, like a unix domain socket. This allows protocols that are
+     * built on tcp_socket to be used on those as well.
+     */
+    explicit tcp_socket(asio::generic::stream_protocol::socket socket);
+
     virtual ~tcp_socket();
 
     tcp_socket(tcp_socket &&) = delete;
@@ -43,23 +95,193 @@ public:
 
     virtual void on_connected();
     virtual void on_disconnected();
-    virtual void on_data(const std::span<const std::byte> &data) = 0;
+    virtual void on_data(const std::span<const std::byte> &data);
+
+    /*!
+     * Called with the data that was received, in a buffer from the buffer pool. A protocol may keep (a slice of) the
+     * buffer to use the data later without copying it; the socket then reads into a new buffer. By default this calls
+     * on_data.
+     */
+    virtual void on_receive(pooled_buffer data);
+
     virtual void on_error(const std::error_code &ec);
 
+    /*!
+     * Called when all data that was queued through send() has been written. This can be used to produce more data
+     * only as fast as the peer receives it, instead of queueing everything at once.
+     */
+    virtual void on_send_complete();
+
+    /*!
+     * Called when the amount of queued data goes over the high watermark. A protocol that produces data should stop
+     * doing so until on_writable is called, so that a slow peer can not make the send queue grow indefinitely.
+     */
+    virtual void on_backpressure();
+
+    /*!
+     * Called when the amount of queued data has dropped to the low watermark after on_backpressure was called.
+     */
+    virtual void on_writable();
+
     void send(std::vector<std::byte> data);
 
+    /*!
+     * Send a buffer from the buffer pool. The buffer is not copied; it is kept alive until it was written.
+     */
+    void send(pooled_buffer data);
+
+    /*!
+     * Send a part of a buffer that may be shared with other sockets. The buffer is not copied; it is kept alive
+     * until it was written. Throws std::invalid_argument if data is null or the range is outside of it.
+     */
+    void send(std::shared_ptr<const std::vector<std::byte>> data, const std::size_t offset,
+              const std::size_t size);
+
+    /*!
+     * Send a range of a file. Where supported (Linux) the file is sent with sendfile, so that its contents are never
+     * copied into user space. Returns false if the file could not be opened.
+     */
+    [[nodiscard]] auto send_file(const std::filesystem::path &path, const std::uint64_t offset,
+                                 const std::uint64_t size) -> bool;
+
+    /*!
+     * Connect a client socket to the first of the given endpoints that accepts the connection. Once connected,
+     * on_connected is called. If none of the endpoints could be connected to, on_error and on_disconnected are called
+     * instead.
+     */
+    void connect(const asio::ip::tcp::resolver::results_type &endpoints);
+
+#if (defined(ASIO_HAS_LOCAL_SOCKETS))
+    /*!
+     * Connect a client socket to a unix domain socket. Once connected, on_connected is called. If the connection
+     * failed, on_error and on_disconnected are called instead.
+     */
+    void connect(const asio::local::stream_protocol::endpoint &endpoint);
+#endif
+
     void disconnect();
 
+    /*!
+     * Set the amount of queued bytes at which on_backpressure and on_writable are called. This should be done before
+     * anything is sent, ie. from the constructor or on_connected.
+     */
+    void set_send_watermarks(const std::size_t high, const std::size_t low) noexcept;
+
+    /*!
+     * Returns true if the send queue went over the high watermark, and has not yet dropped to the low watermark. This
+     * takes effect immediately, so a loop that sends until this returns true does not overshoot the high watermark by
+     * much; on_backpressure is called afterwards from the io context. Thread safe.
+     */
+    [[nodiscard]] auto is_backpressured() const noexcept -> bool;
+
+    /*!
+     * The amount of bytes that were passed to send() and have not been written yet. Thread safe.
+     */
+    [[nodiscard]] auto send_queue_size() const noexcept -> std::size_t;
+
+    /*!
+     * A snapshot of the counters of this socket. Thread safe; the counters are updated independently of each other.
+     */
+    [[nodiscard]] auto statistics() const noexcept -> tcp_socket_statistics;
+
+    /*!
+     * Disconnect once all data that was queued through send() has been written.
+     */
+    void disconnect_after_send();
+
+protected:
+    /*!
+     * Called when the socket starts reading, right before on_connected. This is meant for protocols that are built on
+     * tcp_socket to set up their own state, so that users of such a protocol can override on_connected freely.
+     */
+    virtual void on_started();
+
+    /*!
+     * Stop reading from the socket until resume_reading is called. A read that is already in progress still completes,
+     * so on_receive may be called once more. Must be called from the thread of the socket.
+     */
+    void pause_reading() noexcept;
+
+    /*!
+     * Continue reading after pause_reading. Must be called from the thread of the socket.
+     */
+    void resume_reading();
+
+    [[nodiscard]] auto get_io_context() const noexcept -> asio::io_context &;
+
 private:
+    class file_source;
+
+    /*!
+     * An entry in the send queue; either a buffer (owned or shared) or a range of a file.
+     */
+    struct send_entry
+    {
+        std::vector<std::byte> data;
+        std::shared_ptr<const std::vector<std::byte>> shared_data;
+        pooled_buffer buffer;
+        std::span<const std::byte> view;
+        std::shared_ptr<file_source> file;
+        std::uint64_t file_offset = 0;
+        std::uint64_t file_remaining = 0;
+        std::chrono::steady_clock::time_point queued_at;
+
+        // Small buffers that were copied together into a single buffer, which more may be appended to.
+        bool coalesced = false;
+    };
+
+    /*!
+     * The counters of tcp_socket_statistics; atomic since they may be read from any thread.
+     */
+    struct counters
+    {
+        std::atomic<std::uint64_t> bytes_queued{0};
+        std::atomic<std::uint64_t> bytes_sent{0};
+        std::atomic<std::uint64_t> send_queue_size{0};
+        std::atomic<std::uint64_t> peak_send_queue_size{0};
+        std::atomic<std::uint64_t> write_calls{0};
+        std::atomic<std::uint64_t> buffers_sent{0};
+        std::atomic<std::uint64_t> buffers_coalesced{0};
+        std::atomic<std::uint64_t> backpressure_events{0};
+        std::atomic<std::int64_t> total_write_latency{0};
+        std::atomic<std::int64_t> max_write_latency{0};
+    };
+
     void internal_connect(const asio::ip::basic_resolver_results<asio::ip::tcp> &endpoint);
+    void internal_handle_connect(const std::error_code &ec);
     void internal_socket_start();
     void internal_handle_read();
+    void internal_continue_read();
+    void internal_adapt_read_size(const std::size_t length) noexcept;
+    void internal_queue(send_entry entry);
+    [[nodiscard]] auto internal_coalesce(send_entry &entry) -> bool;
+    void internal_complete_entries(const std::size_t count);
     void internal_handle_write();
+    void internal_handle_send_file();
+    void internal_continue_write();
+    void internal_handle_write_error(const std::error_code &ec);
+    void internal_disconnect();
 
     asio::io_context &context_;
-    asio::ip::tcp::socket socket_;
-    std::array<std::byte, tcp_socket_max_buff_len> data_;
-    std::queue<common::unique_obj<std::vector<std::byte>>> send_data_queue_;
+    asio::generic::stream_protocol::socket socket_;
+    pooled_buffer read_buffer_;
+    std::size_t read_size_;
+    std::size_t small_reads_;
+
+    // Reading was paused, and whether the next read was held back because of it.
+    bool read_paused_;
+    bool read_stopped_;
+    std::deque<send_entry> send_data_queue_;
+    std::vector<asio::const_buffer> write_buffers_;
+
+    // The amount of entries at the front of the send queue that are being written; these must not be changed.
+    std::size_t writing_count_;
+    bool disconnect_after_send_;
+
+    std::size_t send_high_watermark_;
+    std::size_t send_low_watermark_;
+    std::atomic<bool> backpressure_;
+    counters counters_;
 };
 
 } // namespace aeon::sockets
@@ -0,0 +1,114 @@
+// Distributed under the BSD 2-Clause License - Copyright 2012-2023 Robin Degen
+
+#pragma once
+
+#include <aeon/sockets/config.h>
+#include <aeon/sockets/buffer_pool.h>
+#include <aeon/common/platform.h>
+#include <asio/io_context.hpp>
+#include <asio/ip/udp.hpp>
+#include <deque>
+#include <vector>
+#include <memory>
+#include <span>
+#include <cstdint>
+
+namespace aeon::sockets
+{
+
+/*!
+ * UDP socket class.
+ *
+ * Received datagrams are passed to on_datagram in slices of a single buffer from the buffer pool (the arena), which
+ * holds a whole batch of datagrams. Where supported (Linux) a batch is received with a single recvmmsg call, and all
+ * datagrams that were queued for sending in the mean time are sent with a single sendmmsg call.
+ *
+ * Datagrams that are larger than udp_socket_max_datagram_size can not be received; they are dropped and on_error is
+ * called with std::errc::message_size instead.
+ *
+ * Like tcp_socket this must be owned by a std::shared_ptr. All callbacks are called from the io context.
+ */
+class udp_socket : public std::enable_shared_from_this<udp_socket>
+{
+public:
+    /*!
+     * Create a socket that is bound to the given local endpoint. Use port 0 to let the operating system pick a free
+     * port. Throws asio::system_error if the socket could not be bound.
+     */
+    explicit udp_socket(asio::io_context &context, const asio::ip::udp::endpoint &endpoint);
+
+    /*!
+     * Create a socket that is only used for sending. It is bound to a free port by the operating system.
+     */
+    explicit udp_socket(asio::io_context &context, const asio::ip::udp &protocol = asio::ip::udp::v4());
+
+    virtual ~udp_socket();
+
+    udp_socket(udp_socket &&) = delete;
+    auto operator=(udp_socket &&) -> udp_socket & = delete;
+
+    udp_socket(const udp_socket &) = delete;
+    auto operator=(const udp_socket &) -> udp_socket & = delete;
+
+    /*!
+     * Called for every received datagram. The data is a slice of the arena of the batch; it may be kept to use it
+     * later without copying it, in which case the socket receives the next batch into a new arena.
+     */
+    virtual void on_datagram(const asio::ip::udp::endpoint &sender, pooled_buffer data);
+
+    virtual void on_error(const std::error_code &ec);
+
+    /*!
+     * Called when all datagrams that were queued through send_to() have been sent.
+     */
+    virtual void on_send_complete();
+
+    /*!
+     * Start receiving datagrams.
+     */
+    void start();
+
+    /*!
+     * Send a datagram. The buffer is not copied; it is kept alive until it was sent.
+     */
+    void send_to(const asio::ip::udp::endpoint &endpoint, pooled_buffer data);
+
+    /*!
+     * Send a copy of the given data as a datagram.
+     */
+    void send_to(const asio::ip::udp::endpoint &endpoint, const std::span<const std::byte> data);
+
+    void close();
+
+    [[nodiscard]] auto local_endpoint() const -> asio::ip::udp::endpoint;
+
+protected:
+    [[nodiscard]] auto get_io_context() const noexcept -> asio::io_context &;
+
+private:
+    struct send_entry
+    {
+        asio::ip::udp::endpoint endpoint;
+        pooled_buffer buffer;
+    };
+
+    void internal_receive();
+    void internal_prepare_arena();
+    void internal_queue(send_entry entry);
+    void internal_handle_send();
+
+#if (defined(AEON_PLATFORM_OS_LINUX))
+    void internal_handle_receive();
+    void internal_wait_send();
+#endif
+
+    asio::io_context &context_;
+    asio::ip::udp::socket socket_;
+    pooled_buffer arena_;
+
+    // The sender of the datagram that is being received, on platforms that receive a single datagram at a time.
+    asio::ip::udp::endpoint sender_;
+    std::deque<send_entry> send_queue_;
+};
+
+} // namespace aeon::sockets
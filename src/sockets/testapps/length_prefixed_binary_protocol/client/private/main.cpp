@@ -3,6 +3,7 @@
 #include <aeon/sockets/length_prefixed_binary_protocol_socket.h>
 #include <aeon/sockets/tcp_client.h>
 #include <aeon/common/hexdump.h>
+#include <iostream>
 
 using namespace aeon;
 
@@ -0,0 +1,116 @@
+// Distributed under the BSD 2-Clause License - Copyright 2012-2023 Robin Degen
+
+#include <aeon/sockets/buffer_pool.h>
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+
+using namespace aeon;
+
+TEST(test_buffer_pool, acquire_rounds_up_to_size_class)
+{
+    sockets::buffer_pool pool;
+
+    const auto small = pool.acquire(1);
+    EXPECT_EQ(1u, std::size(small));
+    EXPECT_EQ(512u, small.capacity());
+
+    const auto medium = pool.acquire(3000);
+    EXPECT_EQ(3000u, std::size(medium));
+    EXPECT_EQ(4096u, medium.capacity());
+
+    // Larger than the largest size class; allocated as is.
+    const auto large = pool.acquire(100000);
+    EXPECT_EQ(100000u, large.capacity());
+}
+
+TEST(test_buffer_pool, buffers_are_reused)
+{
+    sockets::buffer_pool pool;
+
+    const std::byte *data = nullptr;
+
+    {
+        const auto buffer = pool.acquire(2048);
+        data = std::data(buffer);
+    }
+
+    EXPECT_EQ(2048u, pool.cached_bytes());
+
+    const auto buffer = pool.acquire(1500);
+    EXPECT_EQ(data, std::data(buffer));
+    EXPECT_EQ(0u, pool.cached_bytes());
+
+    // Large buffers are never cached.
+    {
+        [[maybe_unused]] const auto large = pool.acquire(1024 * 1024);
+    }
+
+    EXPECT_EQ(0u, pool.cached_bytes());
+}
+
+TEST(test_buffer_pool, max_cached_bytes)
+{
+    sockets::buffer_pool pool{4096};
+
+    {
+        const auto a = pool.acquire(4096);
+        const auto b = pool.acquire(4096);
+    }
+
+    EXPECT_EQ(4096u, pool.cached_bytes());
+}
+
+TEST(test_buffer_pool, references_and_slices)
+{
+    sockets::buffer_pool pool;
+
+    auto buffer = pool.acquire(16);
+    EXPECT_TRUE(buffer.unique());
+
+    for (std::size_t i = 0; i < std::size(buffer); ++i)
+        std::data(buffer)[i] = static_cast<std::byte>(i);
+
+    auto slice = buffer.slice(4, 8);
+    EXPECT_FALSE(buffer.unique());
+    EXPECT_EQ(8u, std::size(slice));
+    EXPECT_EQ(std::byte{4}, std::data(slice)[0]);
+    EXPECT_EQ(508u, slice.capacity());
+
+    // The slice keeps the buffer alive.
+    buffer = sockets::pooled_buffer{};
+    EXPECT_TRUE(slice.unique());
+    EXPECT_EQ(0u, pool.cached_bytes());
+
+    const auto copy = slice;
+    EXPECT_FALSE(slice.unique());
+    EXPECT_EQ(std::data(slice), std::data(copy));
+
+    slice = sockets::pooled_buffer{};
+    EXPECT_TRUE(copy.unique());
+    EXPECT_TRUE(std::empty(slice));
+}
+
+TEST(test_buffer_pool, release_from_other_threads)
+{
+    sockets::buffer_pool pool;
+    std::vector<std::thread> threads;
+
+    for (auto i = 0; i < 4; ++i)
+    {
+        threads.emplace_back(
+            [&pool]()
+            {
+                for (auto j = 0; j < 1000; ++j)
+                {
+                    auto buffer = pool.acquire(1024);
+                    std::thread{[buffer = std::move(buffer)]() {}}.join();
+                }
+            });
+    }
+
+    for (auto &thread : threads)
+        thread.join();
+
+    EXPECT_LE(pool.cached_bytes(), 4u * 1024u);
+}
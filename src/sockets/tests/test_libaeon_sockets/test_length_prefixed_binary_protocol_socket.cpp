@@ -0,0 +1,189 @@
+// Distributed under the BSD 2-Clause License - Copyright 2012-2023 Robin Degen
+
+#include <aeon/sockets/length_prefixed_binary_protocol_socket.h>
+#include <gtest/gtest.h>
+#include <asio.hpp>
+#include <system_error>
+#include <algorithm>
+#include <memory>
+#include <vector>
+#include <string>
+
+using namespace aeon;
+
+namespace
+{
+
+template <sockets::length_prefix length_t>
+class frame_socket final : public sockets::length_prefixed_binary_protocol_socket<length_t>
+{
+public:
+    explicit frame_socket(asio::io_context &context)
+        : sockets::length_prefixed_binary_protocol_socket<length_t>{context}
+        , frames{}
+        , errors{}
+    {
+    }
+
+    void on_receive_frame(sockets::pooled_buffer frame) override
+    {
+        frames.push_back(std::move(frame));
+    }
+
+    void on_error(const std::error_code &ec) override
+    {
+        errors.push_back(ec);
+    }
+
+    [[nodiscard]] auto frame_string(const std::size_t index) const -> std::string
+    {
+        const auto &frame = frames.at(index);
+        return std::string{reinterpret_cast<const char *>(std::data(frame)), std::size(frame)};
+    }
+
+    std::vector<sockets::pooled_buffer> frames;
+    std::vector<std::error_code> errors;
+};
+
+template <sockets::length_prefix length_t>
+[[nodiscard]] auto encode(const std::vector<std::string> &frames) -> std::vector<std::byte>
+{
+    std::vector<std::byte> data;
+
+    for (const auto &str : frames)
+    {
+        sockets::length_prefixed_binary_frame<length_t> frame;
+        frame << common::string_view{str};
+        const auto encoded = frame.release();
+        data.insert(std::end(data), std::begin(encoded), std::end(encoded));
+    }
+
+    return data;
+}
+
+[[nodiscard]] auto to_buffer(const std::span<const std::byte> data) -> sockets::pooled_buffer
+{
+    auto buffer = sockets::get_buffer_pool().acquire(std::size(data));
+    std::copy(std::begin(data), std::end(data), std::data(buffer));
+    return buffer;
+}
+
+template <sockets::length_prefix length_t>
+void check_split_reads()
+{
+    const std::vector<std::string> expected{"hello", "", std::string(300, 'x'), "world"};
+    const auto data = encode<length_t>(expected);
+
+    // Every possible split of the data over two reads.
+    for (std::size_t split = 0; split <= std::size(data); ++split)
+    {
+        asio::io_context context;
+        auto socket = std::make_shared<frame_socket<length_t>>(context);
+        socket->on_receive(to_buffer(std::span{data}.first(split)));
+        socket->on_receive(to_buffer(std::span{data}.subspan(split)));
+
+        ASSERT_EQ(std::size(expected), std::size(socket->frames)) << "split at " << split;
+
+        for (std::size_t i = 0; i < std::size(expected); ++i)
+            EXPECT_EQ(expected[i], socket->frame_string(i)) << "split at " << split;
+    }
+}
+
+} // namespace
+
+TEST(test_length_prefixed_binary_protocol_socket, frames_are_sliced_from_the_read)
+{
+    const auto data = encode<std::uint32_t>({"one", "two", "three"});
+    const auto buffer = to_buffer(data);
+
+    asio::io_context context;
+    auto socket = std::make_shared<frame_socket<std::uint32_t>>(context);
+    socket->on_receive(buffer);
+
+    ASSERT_EQ(3u, std::size(socket->frames));
+    EXPECT_EQ("one", socket->frame_string(0));
+    EXPECT_EQ("two", socket->frame_string(1));
+    EXPECT_EQ("three", socket->frame_string(2));
+
+    // All frames point into the buffer that was received.
+    EXPECT_EQ(std::data(buffer) + 4, std::data(socket->frames[0]));
+    EXPECT_EQ(std::data(buffer) + 11, std::data(socket->frames[1]));
+    EXPECT_EQ(std::data(buffer) + 18, std::data(socket->frames[2]));
+}
+
+TEST(test_length_prefixed_binary_protocol_socket, split_reads)
+{
+    check_split_reads<std::uint16_t>();
+    check_split_reads<std::uint32_t>();
+    check_split_reads<sockets::varint_length>();
+}
+
+TEST(test_length_prefixed_binary_protocol_socket, varint_prefix)
+{
+    // 5 fits in a single byte; 300 is 0b10'0101100, which takes 2.
+    const auto data = encode<sockets::varint_length>({"12345", std::string(300, 'x')});
+    ASSERT_EQ(1u + 5u + 2u + 300u, std::size(data));
+    EXPECT_EQ(std::byte{5}, data[0]);
+    EXPECT_EQ(std::byte{0xac}, data[6]);
+    EXPECT_EQ(std::byte{0x02}, data[7]);
+}
+
+TEST(test_length_prefixed_binary_protocol_socket, byte_by_byte)
+{
+    const std::vector<std::string> expected{"a", std::string(200, 'b'), "c"};
+    const auto data = encode<sockets::varint_length>(expected);
+
+    asio::io_context context;
+    auto socket = std::make_shared<frame_socket<sockets::varint_length>>(context);
+
+    for (const auto byte : data)
+        socket->on_receive(to_buffer(std::span{&byte, 1}));
+
+    ASSERT_EQ(std::size(expected), std::size(socket->frames));
+
+    for (std::size_t i = 0; i < std::size(expected); ++i)
+        EXPECT_EQ(expected[i], socket->frame_string(i));
+}
+
+TEST(test_length_prefixed_binary_protocol_socket, frame_too_large)
+{
+    const auto data = encode<std::uint32_t>({"small", std::string(2000, 'x'), "never"});
+
+    asio::io_context context;
+    auto socket = std::make_shared<frame_socket<std::uint32_t>>(context);
+    socket->set_max_frame_size(1000);
+    socket->on_receive(to_buffer(data));
+
+    ASSERT_EQ(1u, std::size(socket->frames));
+    EXPECT_EQ("small", socket->frame_string(0));
+    ASSERT_EQ(1u, std::size(socket->errors));
+    EXPECT_EQ(std::make_error_code(std::errc::protocol_error), socket->errors[0]);
+}
+
+TEST(test_length_prefixed_binary_protocol_socket, invalid_varint)
+{
+    const std::vector data(11, std::byte{0xff});
+
+    asio::io_context context;
+    auto socket = std::make_shared<frame_socket<sockets::varint_length>>(context);
+    socket->on_receive(to_buffer(data));
+
+    EXPECT_TRUE(std::empty(socket->frames));
+    ASSERT_EQ(1u, std::size(socket->errors));
+    EXPECT_EQ(std::make_error_code(std::errc::protocol_error), socket->errors[0]);
+}
+
+TEST(test_length_prefixed_binary_protocol_socket, varint_overflow)
+{
+    // A length of 2^64; it does not fit in 64 bits and would otherwise wrap around to 0.
+    std::vector data(9, std::byte{0x80});
+    data.push_back(std::byte{0x02});
+
+    asio::io_context context;
+    auto socket = std::make_shared<frame_socket<sockets::varint_length>>(context);
+    socket->on_receive(to_buffer(data));
+
+    EXPECT_TRUE(std::empty(socket->frames));
+    ASSERT_EQ(1u, std::size(socket->errors));
+    EXPECT_EQ(std::make_error_code(std::errc::protocol_error), socket->errors[0]);
+}
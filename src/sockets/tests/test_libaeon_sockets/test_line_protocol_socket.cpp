@@ -0,0 +1,161 @@
+// Distributed under the BSD 2-Clause License - Copyright 2012-2023 Robin Degen
+
+#include <aeon/sockets/line_protocol_socket.h>
+#include <aeon/sockets/tcp_server.h>
+#include <aeon/sockets/tcp_client.h>
+#include <gtest/gtest.h>
+#include <asio.hpp>
+#include <string_view>
+#include <cstring>
+#include <cctype>
+#include <vector>
+#include <string>
+
+using namespace aeon;
+
+namespace
+{
+
+constexpr std::uint16_t test_port = 38281;
+
+void send_string(sockets::tcp_socket &socket, const std::string_view str)
+{
+    auto buffer = sockets::get_buffer_pool().acquire(std::size(str));
+    std::memcpy(std::data(buffer), std::data(str), std::size(str));
+    socket.send(std::move(buffer));
+}
+
+/*!
+ * Replies to every line with the line in upper case.
+ */
+class upper_case_socket final : public sockets::line_protocol_socket
+{
+public:
+    explicit upper_case_socket(asio::ip::tcp::socket socket)
+        : line_protocol_socket{std::move(socket)}
+    {
+    }
+
+    void on_line(const common::string &line) override
+    {
+        auto reply = line.str();
+
+        for (auto &c : reply)
+            c = static_cast<char>(std::toupper(c));
+
+        send_string(*this, reply + "\r\n");
+    }
+};
+
+std::vector<std::string> received_lines;
+
+class client_socket final : public sockets::line_protocol_socket
+{
+public:
+    explicit client_socket(asio::io_context &context)
+        : line_protocol_socket{context}
+    {
+    }
+
+    void on_connected() override
+    {
+        // A line that is split over multiple sends, and one that is large enough to span multiple reads.
+        send_string(*this, "hello\r\nwor");
+        send_string(*this, "ld\n");
+        send_string(*this, std::string(100000, 'x') + "\n");
+        send_string(*this, "bye\n");
+    }
+
+    void on_line(const common::string &line) override
+    {
+        received_lines.push_back(line.str());
+
+        if (line == "BYE")
+            get_io_context().stop();
+    }
+};
+
+std::vector<std::error_code> received_errors;
+
+/*!
+ * Accepts lines of at most 1000 characters.
+ */
+class limited_socket final : public sockets::line_protocol_socket
+{
+public:
+    explicit limited_socket(asio::ip::tcp::socket socket)
+        : line_protocol_socket{std::move(socket)}
+    {
+        set_max_line_length(1000);
+    }
+
+    void on_line(const common::string &line) override
+    {
+        received_lines.push_back(line.str());
+    }
+
+    void on_error(const std::error_code &ec) override
+    {
+        received_errors.push_back(ec);
+    }
+};
+
+class long_line_client_socket final : public sockets::line_protocol_socket
+{
+public:
+    explicit long_line_client_socket(asio::io_context &context)
+        : line_protocol_socket{context}
+    {
+    }
+
+    void on_connected() override
+    {
+        send_string(*this, std::string(1000, 'a') + "\r\n");
+        send_string(*this, std::string(500, 'b'));
+        send_string(*this, std::string(501, 'b') + "\n");
+    }
+
+    void on_line([[maybe_unused]] const common::string &line) override
+    {
+    }
+
+    void on_disconnected() override
+    {
+        get_io_context().stop();
+    }
+};
+
+} // namespace
+
+TEST(test_line_protocol_socket, lines_are_split_and_joined)
+{
+    received_lines.clear();
+
+    asio::io_context context;
+    sockets::tcp_server<upper_case_socket> server{context, test_port};
+    sockets::tcp_client<client_socket> client{context, "127.0.0.1", test_port};
+    context.run();
+
+    ASSERT_EQ(4u, std::size(received_lines));
+    EXPECT_EQ("HELLO", received_lines[0]);
+    EXPECT_EQ("WORLD", received_lines[1]);
+    EXPECT_EQ(std::string(100000, 'X'), received_lines[2]);
+    EXPECT_EQ("BYE", received_lines[3]);
+}
+
+TEST(test_line_protocol_socket, long_lines_are_rejected)
+{
+    received_lines.clear();
+    received_errors.clear();
+
+    asio::io_context context;
+    sockets::tcp_server<limited_socket> server{context, test_port};
+    sockets::tcp_client<long_line_client_socket> client{context, "127.0.0.1", test_port};
+    context.run_for(std::chrono::seconds{5});
+
+    ASSERT_EQ(1u, std::size(received_lines));
+    EXPECT_EQ(std::string(1000, 'a'), received_lines[0]);
+
+    ASSERT_EQ(1u, std::size(received_errors));
+    EXPECT_EQ(std::make_error_code(std::errc::protocol_error), received_errors[0]);
+}
@@ -0,0 +1,187 @@
+// Distributed under the BSD 2-Clause License - Copyright 2012-2023 Robin Degen
+
+#include <aeon/sockets/line_protocol_socket.h>
+#include <aeon/sockets/length_prefixed_binary_protocol_socket.h>
+#include <aeon/sockets/local_server.h>
+#include <aeon/sockets/local_client.h>
+#include <gtest/gtest.h>
+#include <asio.hpp>
+#include <filesystem>
+#include <string_view>
+#include <cstring>
+#include <vector>
+#include <string>
+
+#if (defined(ASIO_HAS_LOCAL_SOCKETS))
+
+using namespace aeon;
+
+namespace
+{
+
+[[nodiscard]] auto test_socket_path() -> std::filesystem::path
+{
+    return std::filesystem::temp_directory_path() / "test_libaeon_sockets_local.sock";
+}
+
+void send_string(sockets::tcp_socket &socket, const std::string_view str)
+{
+    auto buffer = sockets::get_buffer_pool().acquire(std::size(str));
+    std::memcpy(std::data(buffer), std::data(str), std::size(str));
+    socket.send(std::move(buffer));
+}
+
+class echo_line_socket final : public sockets::line_protocol_socket
+{
+public:
+    explicit echo_line_socket(asio::generic::stream_protocol::socket socket)
+        : line_protocol_socket{std::move(socket)}
+    {
+    }
+
+    void on_line(const common::string &line) override
+    {
+        send_string(*this, line.str() + "!\n");
+    }
+};
+
+std::vector<std::string> received_lines;
+
+class line_client_socket final : public sockets::line_protocol_socket
+{
+public:
+    explicit line_client_socket(asio::io_context &context)
+        : line_protocol_socket{context}
+    {
+    }
+
+    void on_connected() override
+    {
+        send_string(*this, "hello\nworld\n");
+    }
+
+    void on_line(const common::string &line) override
+    {
+        received_lines.push_back(line.str());
+
+        if (std::size(received_lines) == 2)
+            get_io_context().stop();
+    }
+};
+
+class echo_frame_socket final : public sockets::length_prefixed_binary_protocol_socket<std::uint32_t>
+{
+public:
+    explicit echo_frame_socket(asio::generic::stream_protocol::socket socket)
+        : length_prefixed_binary_protocol_socket{std::move(socket)}
+    {
+    }
+
+    void on_frame(const streams::memory_view_device<std::vector<std::byte>> &frame) override
+    {
+        sockets::length_prefixed_binary_frame<std::uint32_t> reply;
+        reply.vector_write(frame.data());
+        send_frame(std::move(reply));
+    }
+};
+
+std::vector<std::byte> received_frame;
+
+class frame_client_socket final : public sockets::length_prefixed_binary_protocol_socket<std::uint32_t>
+{
+public:
+    explicit frame_client_socket(asio::io_context &context)
+        : length_prefixed_binary_protocol_socket{context}
+    {
+    }
+
+    void on_connected() override
+    {
+        std::vector<std::byte> data(100000);
+
+        for (std::size_t i = 0; i < std::size(data); ++i)
+            data[i] = static_cast<std::byte>(i);
+
+        sockets::length_prefixed_binary_frame<std::uint32_t> frame;
+        frame.vector_write(data);
+        send_frame(std::move(frame));
+    }
+
+    void on_frame(const streams::memory_view_device<std::vector<std::byte>> &frame) override
+    {
+        received_frame = frame.data();
+        get_io_context().stop();
+    }
+};
+
+bool connect_failed = false;
+
+class failing_client_socket final : public sockets::line_protocol_socket
+{
+public:
+    explicit failing_client_socket(asio::io_context &context)
+        : line_protocol_socket{context}
+    {
+    }
+
+    void on_line([[maybe_unused]] const common::string &line) override
+    {
+    }
+
+    void on_error([[maybe_unused]] const std::error_code &ec) override
+    {
+        connect_failed = true;
+    }
+};
+
+} // namespace
+
+TEST(test_local_socket, line_protocol)
+{
+    received_lines.clear();
+
+    asio::io_context context;
+    sockets::local_server<echo_line_socket> server{context, test_socket_path()};
+    EXPECT_TRUE(std::filesystem::exists(test_socket_path()));
+
+    sockets::local_client<line_client_socket> client{context, test_socket_path()};
+    context.run();
+
+    ASSERT_EQ(2u, std::size(received_lines));
+    EXPECT_EQ("hello!", received_lines[0]);
+    EXPECT_EQ("world!", received_lines[1]);
+}
+
+TEST(test_local_socket, length_prefixed_binary_protocol)
+{
+    received_frame.clear();
+
+    asio::io_context context;
+    sockets::local_server<echo_frame_socket> server{context, test_socket_path()};
+    sockets::local_client<frame_client_socket> client{context, test_socket_path()};
+    context.run();
+
+    ASSERT_EQ(100000u, std::size(received_frame));
+
+    for (std::size_t i = 0; i < std::size(received_frame); ++i)
+        ASSERT_EQ(static_cast<std::byte>(i), received_frame[i]);
+}
+
+TEST(test_local_socket, socket_file_is_removed)
+{
+    {
+        asio::io_context context;
+        sockets::local_server<echo_line_socket> server{context, test_socket_path()};
+        EXPECT_TRUE(std::filesystem::exists(test_socket_path()));
+    }
+
+    EXPECT_FALSE(std::filesystem::exists(test_socket_path()));
+
+    connect_failed = false;
+    asio::io_context context;
+    sockets::local_client<failing_client_socket> client{context, test_socket_path()};
+    context.run();
+    EXPECT_TRUE(connect_failed);
+}
+
+#endif
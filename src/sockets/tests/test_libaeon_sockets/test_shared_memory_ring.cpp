@@ -0,0 +1,112 @@
+// Distributed under the BSD 2-Clause License - Copyright 2012-2023 Robin Degen
+
+#include <aeon/sockets/shared_memory_ring.h>
+#include <gtest/gtest.h>
+
+#if (defined(AEON_PLATFORM_OS_LINUX))
+#include <unistd.h>
+#include <thread>
+#include <vector>
+#include <string>
+#include <stdexcept>
+#include <system_error>
+#include <cstddef>
+
+using namespace aeon;
+
+namespace
+{
+
+[[nodiscard]] auto test_ring_name() -> common::string
+{
+    return common::string{"/test_libaeon_sockets_ring_" + std::to_string(::getpid())};
+}
+
+} // namespace
+
+TEST(test_shared_memory_ring, create_and_open)
+{
+    sockets::shared_memory_ring ring{test_ring_name(), 5000};
+    EXPECT_EQ(8192u, ring.capacity());
+
+    sockets::shared_memory_ring other{test_ring_name()};
+    EXPECT_EQ(8192u, other.capacity());
+
+    EXPECT_THROW(sockets::shared_memory_ring(test_ring_name(), 4096), std::system_error);
+}
+
+TEST(test_shared_memory_ring, name_is_removed_by_owner)
+{
+    {
+        sockets::shared_memory_ring ring{test_ring_name(), 4096};
+    }
+
+    EXPECT_THROW(sockets::shared_memory_ring{test_ring_name()}, std::system_error);
+}
+
+TEST(test_shared_memory_ring, write_and_read_wraps_around)
+{
+    sockets::shared_memory_ring writer{test_ring_name(), 4096};
+    sockets::shared_memory_ring reader{test_ring_name()};
+
+    std::vector<std::byte> buffer(3000);
+
+    for (auto i = 0; i < 10; ++i)
+    {
+        const std::vector data(3000, static_cast<std::byte>(i));
+        ASSERT_TRUE(writer.write(data));
+        EXPECT_EQ(3000u, reader.read(buffer));
+        EXPECT_EQ(data, buffer);
+    }
+
+    EXPECT_EQ(0u, reader.try_read(buffer));
+}
+
+TEST(test_shared_memory_ring, bulk_transfer_between_threads)
+{
+    sockets::shared_memory_ring writer{test_ring_name(), 4096};
+    sockets::shared_memory_ring reader{test_ring_name()};
+
+    constexpr std::size_t total_size = 4 * 1024 * 1024;
+
+    // Writes that are larger than the ring, so that both sides have to wait for each other.
+    std::thread writer_thread{[&writer]()
+                              {
+                                  std::vector<std::byte> data(10000);
+                                  std::size_t written = 0;
+
+                                  while (written < total_size)
+                                  {
+                                      const auto size = std::min(std::size(data), total_size - written);
+
+                                      for (std::size_t i = 0; i < size; ++i)
+                                          data[i] = static_cast<std::byte>((written + i) % 251);
+
+                                      EXPECT_TRUE(writer.write(std::span{std::data(data), size}));
+                                      written += size;
+                                  }
+
+                                  writer.close();
+                              }};
+
+    std::vector<std::byte> buffer(1500);
+    std::size_t received = 0;
+    auto valid = true;
+
+    while (const auto size = reader.read(buffer))
+    {
+        for (std::size_t i = 0; i < size; ++i)
+            valid &= buffer[i] == static_cast<std::byte>((received + i) % 251);
+
+        received += size;
+    }
+
+    writer_thread.join();
+
+    EXPECT_EQ(total_size, received);
+    EXPECT_TRUE(valid);
+    EXPECT_TRUE(reader.is_closed());
+    EXPECT_FALSE(writer.write(buffer));
+}
+
+#endif
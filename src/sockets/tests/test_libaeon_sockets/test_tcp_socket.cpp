@@ -0,0 +1,222 @@
+// Distributed under the BSD 2-Clause License - Copyright 2012-2023 Robin Degen
+
+#include <aeon/sockets/tcp_socket.h>
+#include <aeon/sockets/tcp_server.h>
+#include <aeon/sockets/tcp_client.h>
+#include <gtest/gtest.h>
+#include <asio.hpp>
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <cstring>
+
+using namespace aeon;
+
+namespace
+{
+
+constexpr std::uint16_t test_port = 38283;
+constexpr std::size_t high_watermark = 256 * 1024;
+constexpr std::size_t low_watermark = 64 * 1024;
+constexpr std::size_t chunk_size = 64 * 1024;
+constexpr std::size_t total_size = 16 * 1024 * 1024;
+
+/*!
+ * Produces data only as fast as the peer receives it.
+ */
+class producer_socket final : public sockets::tcp_socket
+{
+public:
+    explicit producer_socket(asio::ip::tcp::socket socket)
+        : tcp_socket{std::move(socket)}
+        , produced{0}
+        , backpressure_events{0}
+        , writable_events{0}
+        , max_queue_size{0}
+    {
+        set_send_watermarks(high_watermark, low_watermark);
+    }
+
+    void on_connected() override
+    {
+        instance = std::static_pointer_cast<producer_socket>(shared_from_this());
+        produce();
+    }
+
+    void on_backpressure() override
+    {
+        ++backpressure_events;
+        max_queue_size = std::max(max_queue_size, send_queue_size());
+    }
+
+    void on_writable() override
+    {
+        ++writable_events;
+        EXPECT_LE(send_queue_size(), low_watermark);
+        produce();
+    }
+
+    void produce()
+    {
+        while (!is_backpressured() && produced < total_size)
+        {
+            auto buffer = sockets::get_buffer_pool().acquire(chunk_size);
+            std::memset(std::data(buffer), static_cast<int>(produced / chunk_size), chunk_size);
+            send(std::move(buffer));
+            produced += chunk_size;
+        }
+
+        if (produced == total_size)
+            disconnect_after_send();
+    }
+
+    static inline std::shared_ptr<producer_socket> instance;
+
+    std::size_t produced;
+    int backpressure_events;
+    int writable_events;
+    std::size_t max_queue_size;
+};
+
+class small_writes_socket final : public sockets::tcp_socket
+{
+public:
+    explicit small_writes_socket(asio::io_context &context)
+        : tcp_socket{context}
+    {
+    }
+
+    void on_connected() override
+    {
+        for (auto i = 0; i < 1000; ++i)
+        {
+            const auto str = std::to_string(i) + "\n";
+            send(std::vector<std::byte>{reinterpret_cast<const std::byte *>(std::data(str)),
+                                        reinterpret_cast<const std::byte *>(std::data(str) + std::size(str))});
+        }
+
+        disconnect_after_send();
+    }
+};
+
+std::string received_data;
+
+class receiving_socket final : public sockets::tcp_socket
+{
+public:
+    explicit receiving_socket(asio::ip::tcp::socket socket)
+        : tcp_socket{std::move(socket)}
+    {
+    }
+
+    void on_data(const std::span<const std::byte> &data) override
+    {
+        received_data.append(reinterpret_cast<const char *>(std::data(data)), std::size(data));
+    }
+
+    void on_disconnected() override
+    {
+        get_io_context().stop();
+    }
+};
+
+} // namespace
+
+TEST(test_tcp_socket, backpressure)
+{
+    asio::io_context context;
+    sockets::tcp_server<producer_socket> server{context, test_port};
+
+    // A client that does not read anything until the producer reported backpressure.
+    asio::ip::tcp::socket client{context};
+    client.connect(asio::ip::tcp::endpoint{asio::ip::address_v4::loopback(), test_port});
+
+    while (!producer_socket::instance || producer_socket::instance->backpressure_events == 0)
+        context.run_one();
+
+    const auto producer = producer_socket::instance;
+    producer_socket::instance.reset();
+
+    EXPECT_TRUE(producer->is_backpressured());
+    EXPECT_GT(producer->max_queue_size, high_watermark);
+    EXPECT_LT(producer->produced, total_size);
+
+    std::vector<std::byte> buffer(256 * 1024);
+    std::size_t received = 0;
+    auto valid = true;
+
+    while (true)
+    {
+        asio::error_code ec;
+        const auto length = client.read_some(asio::buffer(buffer), ec);
+
+        for (std::size_t i = 0; i < length; ++i)
+            valid &= buffer[i] == static_cast<std::byte>((received + i) / chunk_size);
+
+        received += length;
+
+        if (ec)
+            break;
+
+        context.poll();
+    }
+
+    EXPECT_EQ(total_size, received);
+    EXPECT_TRUE(valid);
+    EXPECT_GT(producer->backpressure_events, 1);
+    EXPECT_EQ(producer->backpressure_events, producer->writable_events);
+
+    const auto statistics = producer->statistics();
+    EXPECT_EQ(total_size, statistics.bytes_queued);
+    EXPECT_EQ(total_size, statistics.bytes_sent);
+    EXPECT_EQ(0u, statistics.send_queue_size);
+    EXPECT_EQ(producer->max_queue_size, statistics.peak_send_queue_size);
+    EXPECT_EQ(total_size / chunk_size, statistics.buffers_sent);
+    EXPECT_EQ(0u, statistics.buffers_coalesced);
+    EXPECT_EQ(static_cast<std::uint64_t>(producer->backpressure_events), statistics.backpressure_events);
+    EXPECT_GT(statistics.write_calls, 0u);
+    EXPECT_GT(statistics.max_write_latency.count(), 0);
+    EXPECT_GE(statistics.total_write_latency, statistics.max_write_latency);
+}
+
+TEST(test_tcp_socket, small_buffers_are_coalesced)
+{
+    received_data.clear();
+
+    asio::io_context context;
+    sockets::tcp_server<receiving_socket> server{context, test_port};
+    sockets::tcp_client<small_writes_socket> client{context, "127.0.0.1", test_port};
+    context.run();
+
+    std::string expected;
+
+    for (auto i = 0; i < 1000; ++i)
+        expected += std::to_string(i) + "\n";
+
+    EXPECT_EQ(expected, received_data);
+
+    // Only the first buffer is written on its own; the others were queued while it was being written.
+    const auto statistics = client->statistics();
+    EXPECT_EQ(std::size(expected), statistics.bytes_queued);
+    EXPECT_EQ(std::size(expected), statistics.bytes_sent);
+    EXPECT_EQ(999u, statistics.buffers_coalesced);
+    EXPECT_LT(statistics.buffers_sent, 10u);
+}
+
+TEST(test_tcp_socket, shared_send_rejects_invalid_ranges)
+{
+    asio::io_context context;
+    const auto socket = std::make_shared<sockets::tcp_socket>(context);
+    const auto data = std::make_shared<const std::vector<std::byte>>(16);
+
+    EXPECT_THROW(socket->send(std::shared_ptr<const std::vector<std::byte>>{}, 0, 0), std::invalid_argument);
+    EXPECT_THROW(socket->send(data, 8, 9), std::invalid_argument);
+    EXPECT_THROW(socket->send(data, 17, 0), std::invalid_argument);
+    EXPECT_THROW(socket->send(data, 1, std::numeric_limits<std::size_t>::max()), std::invalid_argument);
+
+    EXPECT_NO_THROW(socket->send(data, 16, 0));
+    EXPECT_EQ(0u, socket->send_queue_size());
+}
@@ -0,0 +1,131 @@
+// Distributed under the BSD 2-Clause License - Copyright 2012-2023 Robin Degen
+
+#include <aeon/sockets/udp_socket.h>
+#include <gtest/gtest.h>
+#include <asio.hpp>
+#include <system_error>
+#include <algorithm>
+#include <chrono>
+#include <string_view>
+#include <vector>
+#include <string>
+
+using namespace aeon;
+
+namespace
+{
+
+[[nodiscard]] auto to_bytes(const std::string_view str) -> std::span<const std::byte>
+{
+    return {reinterpret_cast<const std::byte *>(std::data(str)), std::size(str)};
+}
+
+/*!
+ * Keeps all received datagrams, and replies to each of them with the datagram in reverse.
+ */
+class reverse_socket final : public sockets::udp_socket
+{
+public:
+    explicit reverse_socket(asio::io_context &context)
+        : udp_socket{context, asio::ip::udp::endpoint{asio::ip::address_v4::loopback(), 0}}
+        , errors{}
+    {
+    }
+
+    void on_datagram(const asio::ip::udp::endpoint &sender, sockets::pooled_buffer data) override
+    {
+        std::vector<std::byte> reply{std::begin(data.span()), std::end(data.span())};
+        std::reverse(std::begin(reply), std::end(reply));
+        send_to(sender, reply);
+    }
+
+    void on_error(const std::error_code &ec) override
+    {
+        errors.push_back(ec);
+    }
+
+    std::vector<std::error_code> errors;
+};
+
+class client_socket final : public sockets::udp_socket
+{
+public:
+    explicit client_socket(asio::io_context &context, const std::size_t expected)
+        : udp_socket{context, asio::ip::udp::endpoint{asio::ip::address_v4::loopback(), 0}}
+        , expected_{expected}
+        , received{}
+    {
+    }
+
+    void on_datagram([[maybe_unused]] const asio::ip::udp::endpoint &sender, sockets::pooled_buffer data) override
+    {
+        // The buffers are kept, which must not affect the datagrams that are received after them.
+        received.push_back(std::move(data));
+
+        if (std::size(received) == expected_)
+            get_io_context().stop();
+    }
+
+    std::size_t expected_;
+    std::vector<sockets::pooled_buffer> received;
+};
+
+[[nodiscard]] auto to_string(const sockets::pooled_buffer &buffer) -> std::string
+{
+    return std::string{reinterpret_cast<const char *>(std::data(buffer)), std::size(buffer)};
+}
+
+} // namespace
+
+TEST(test_udp_socket, send_and_receive)
+{
+    asio::io_context context;
+
+    auto server = std::make_shared<reverse_socket>(context);
+    server->start();
+
+    // More datagrams than fit in a single batch.
+    constexpr std::size_t count = sockets::udp_socket_batch_size * 3;
+    auto client = std::make_shared<client_socket>(context, count);
+    client->start();
+
+    for (std::size_t i = 0; i < count; ++i)
+        client->send_to(server->local_endpoint(), to_bytes("datagram " + std::to_string(i)));
+
+    context.run_for(std::chrono::seconds{5});
+
+    ASSERT_EQ(count, std::size(client->received));
+
+    // Udp does not guarantee the order, but over loopback it is kept.
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        auto expected = "datagram " + std::to_string(i);
+        std::reverse(std::begin(expected), std::end(expected));
+        EXPECT_EQ(expected, to_string(client->received[i]));
+    }
+
+    EXPECT_TRUE(std::empty(server->errors));
+}
+
+TEST(test_udp_socket, oversized_datagram_is_dropped)
+{
+    asio::io_context context;
+
+    auto server = std::make_shared<reverse_socket>(context);
+    server->start();
+
+    auto client = std::make_shared<client_socket>(context, 1);
+    client->start();
+
+    const std::string oversized(sockets::udp_socket_max_datagram_size + 1, 'x');
+    client->send_to(server->local_endpoint(), to_bytes(oversized));
+    client->send_to(server->local_endpoint(), to_bytes("abc"));
+
+    context.run_for(std::chrono::seconds{5});
+
+    ASSERT_EQ(1u, std::size(client->received));
+    EXPECT_EQ("cba", to_string(client->received[0]));
+
+    ASSERT_EQ(1u, std::size(server->errors));
+    EXPECT_EQ(std::make_error_code(std::errc::message_size), server->errors[0]);
+}
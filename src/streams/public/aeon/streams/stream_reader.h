@@ -42,14 +42,14 @@ public:
 
     [[nodiscard]] auto read_line() const -> common::string;
 
-    template <typename T>
-    void read_to_vector(std::vector<T> &vec) const;
+    template <typename T, typename allocator_t>
+    void read_to_vector(std::vector<T, allocator_t> &vec) const;
 
     template <typename T>
     [[nodiscard]] auto read_to_vector() const -> std::vector<T>;
 
-    template <typename T>
-    void read_to_vector(std::vector<T> &vec, const std::streamoff size) const;
+    template <typename T, typename allocator_t>
+    void read_to_vector(std::vector<T, allocator_t> &vec, const std::streamoff size) const;
 
     template <typename T>
     [[nodiscard]] auto read_to_vector(const std::streamoff size) const -> std::vector<T>;
@@ -140,8 +140,8 @@ template <stream_readable device_t>
 }
 
 template <stream_readable device_t>
-template <typename T>
-inline void stream_reader<device_t>::read_to_vector(std::vector<T> &vec) const
+template <typename T, typename allocator_t>
+inline void stream_reader<device_t>::read_to_vector(std::vector<T, allocator_t> &vec) const
 {
     if constexpr (std::is_same_v<device_t, idynamic_stream>)
         aeon_assert(device_->has_size(), "read_to_vector requires a device with known size.");
@@ -161,8 +161,8 @@ template <typename T>
 }
 
 template <stream_readable device_t>
-template <typename T>
-inline void stream_reader<device_t>::read_to_vector(std::vector<T> &vec, const std::streamoff size) const
+template <typename T, typename allocator_t>
+inline void stream_reader<device_t>::read_to_vector(std::vector<T, allocator_t> &vec, const std::streamoff size) const
 {
     static_assert(sizeof(T) == 1, "Given template argument size must be 1 byte.");
     aeon_assert(std::empty(vec), "Expected given vector to be empty.");
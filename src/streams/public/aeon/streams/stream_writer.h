@@ -35,8 +35,8 @@ public:
     void device(device_t &device) noexcept;
     [[nodiscard]] auto device() const noexcept -> device_t &;
 
-    template <typename T>
-    void vector_write(const std::vector<T> &vec) const;
+    template <typename T, typename allocator_t>
+    void vector_write(const std::vector<T, allocator_t> &vec) const;
 
     template <typename T, std::size_t size>
     void array_write(const std::array<T, size> &arr) const;
@@ -72,8 +72,8 @@ template <stream_writable device_t>
 }
 
 template <stream_writable device_t>
-template <typename T>
-inline void stream_writer<device_t>::vector_write(const std::vector<T> &vec) const
+template <typename T, typename allocator_t>
+inline void stream_writer<device_t>::vector_write(const std::vector<T, allocator_t> &vec) const
 {
     static_assert(sizeof(T) == 1, "Given template argument size must be 1 byte.");
 
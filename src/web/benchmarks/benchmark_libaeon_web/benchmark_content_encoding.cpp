@@ -0,0 +1,62 @@
+// Distributed under the BSD 2-Clause License - Copyright 2012-2023 Robin Degen
+
+#include <benchmark/benchmark.h>
+
+#include <aeon/web/http/content_encoding.h>
+#include <string>
+#include <span>
+
+using namespace aeon;
+
+namespace
+{
+
+/*!
+ * A JSON-RPC batch reply of roughly the given size; typical for what the server sends out.
+ */
+[[nodiscard]] auto make_json_reply(const std::size_t size) -> std::string
+{
+    std::string reply = "[";
+
+    for (auto i = 0; std::size(reply) < size; ++i)
+    {
+        reply += R"({"jsonrpc": "2.0", "result": {"name": "item)" + std::to_string(i) + R"(", "value": )" +
+                 std::to_string(i * 7919 % 10007) + R"(, "enabled": true}, "id": )" + std::to_string(i) + "},";
+    }
+
+    reply.back() = ']';
+    return reply;
+}
+
+} // namespace
+
+/*!
+ * Bandwidth saved against cpu time spent. The bytes_per_second counter is the compression throughput of a single
+ * core; saved_ratio is the part of the bandwidth that is saved.
+ */
+static void BM_compress_reply(benchmark::State &state)
+{
+    const auto reply = make_json_reply(static_cast<std::size_t>(state.range(0)));
+    const auto data = std::as_bytes(std::span{std::data(reply), std::size(reply)});
+    const auto mode = static_cast<compression::zlib_compression_mode>(state.range(1));
+
+    std::size_t compressed_size = 0;
+
+    for ([[maybe_unused]] auto _ : state)
+    {
+        const auto compressed = web::http::compress_content(data, web::http::content_encoding::gzip, mode);
+        compressed_size = std::size(compressed);
+        benchmark::DoNotOptimize(compressed);
+    }
+
+    state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * std::size(reply)));
+    state.counters["saved_ratio"] =
+        1.0 - static_cast<double>(compressed_size) / static_cast<double>(std::size(reply));
+    state.counters["saved_bytes"] = static_cast<double>(std::size(reply) - compressed_size);
+}
+
+BENCHMARK(BM_compress_reply)
+    ->ArgsProduct({{1024, 16 * 1024, 256 * 1024},
+                   {static_cast<int>(compression::zlib_compression_mode::fastest),
+                    static_cast<int>(compression::zlib_compression_mode::balanced),
+                    static_cast<int>(compression::zlib_compression_mode::best)}});
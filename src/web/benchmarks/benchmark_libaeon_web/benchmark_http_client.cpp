@@ -0,0 +1,164 @@
+// Distributed under the BSD 2-Clause License - Copyright 2012-2023 Robin Degen
+
+#include <benchmark/benchmark.h>
+
+#include <aeon/web/http/http_client.h>
+#include <aeon/web/http/http_client_socket.h>
+#include <aeon/web/http/http_server.h>
+#include <aeon/sockets/tcp_client.h>
+#include <asio.hpp>
+#include <thread>
+#include <memory>
+#include <vector>
+
+using namespace aeon;
+
+namespace
+{
+
+constexpr std::uint16_t benchmark_port = 38279;
+
+class hello_server_socket final : public web::http::http_server_socket
+{
+public:
+    explicit hello_server_socket(asio::ip::tcp::socket socket, [[maybe_unused]] web::http::http_server_session &session)
+        : http_server_socket{std::move(socket)}
+    {
+        set_max_keep_alive_requests(0);
+    }
+
+    void on_http_request([[maybe_unused]] const web::http::request &request) override
+    {
+        respond("text/plain", "Hello!");
+    }
+};
+
+/*!
+ * Runs the server on a separate thread for the duration of a benchmark.
+ */
+class server_thread final
+{
+public:
+    server_thread()
+        : context_{}
+        , server_{context_, benchmark_port}
+        , thread_{[this]() { context_.run(); }}
+    {
+    }
+
+    ~server_thread()
+    {
+        context_.stop();
+        thread_.join();
+    }
+
+    server_thread(server_thread &&) = delete;
+    auto operator=(server_thread &&) -> server_thread & = delete;
+
+    server_thread(const server_thread &) = delete;
+    auto operator=(const server_thread &) -> server_thread & = delete;
+
+private:
+    asio::io_context context_;
+    web::http::http_server<hello_server_socket> server_;
+    std::thread thread_;
+};
+
+/*!
+ * The single request per connection client, for comparison.
+ */
+class benchmark_client_socket final : public web::http::http_client_socket
+{
+public:
+    explicit benchmark_client_socket(asio::io_context &context)
+        : http_client_socket{context}
+    {
+    }
+
+    void on_connected() override
+    {
+        request_async("127.0.0.1", "/benchmark");
+    }
+
+    void on_http_reply([[maybe_unused]] web::http::reply &reply) override
+    {
+    }
+};
+
+} // namespace
+
+/*!
+ * The existing client; a new connection for every request.
+ * Arguments: concurrent requests per iteration.
+ */
+static void BM_http_client_socket(benchmark::State &state)
+{
+    const server_thread server;
+    const auto concurrency = static_cast<std::size_t>(state.range(0));
+
+    asio::io_context context;
+    std::vector<std::unique_ptr<sockets::tcp_client<benchmark_client_socket>>> clients;
+    clients.reserve(concurrency);
+
+    for ([[maybe_unused]] auto _ : state)
+    {
+        for (std::size_t i = 0; i < concurrency; ++i)
+            clients.push_back(
+                std::make_unique<sockets::tcp_client<benchmark_client_socket>>(context, "127.0.0.1", benchmark_port));
+
+        context.run();
+        context.restart();
+        clients.clear();
+    }
+
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * concurrency));
+}
+
+BENCHMARK(BM_http_client_socket)->Arg(1)->Arg(16)->Arg(64)->UseRealTime()->Unit(benchmark::kMicrosecond);
+
+/*!
+ * The pooled client, with keep-alive connections and pipelining.
+ * Arguments: concurrent requests per iteration, max connections.
+ */
+static void BM_http_client(benchmark::State &state)
+{
+    const server_thread server;
+    const auto concurrency = static_cast<std::size_t>(state.range(0));
+
+    web::http::http_client_settings settings;
+    settings.max_connections_per_host = static_cast<std::size_t>(state.range(1));
+
+    asio::io_context context;
+    web::http::http_client client{context, settings};
+
+    for ([[maybe_unused]] auto _ : state)
+    {
+        std::size_t remaining = concurrency;
+
+        for (std::size_t i = 0; i < concurrency; ++i)
+        {
+            client.request_async("127.0.0.1", benchmark_port, web::http::client_request{},
+                                 [&remaining](const std::error_code &ec, const web::http::client_reply_view &reply)
+                                 {
+                                     if (ec || reply.get_content_string() != "Hello!")
+                                         std::abort();
+
+                                     --remaining;
+                                 });
+        }
+
+        // The idle timers of the connections keep the context from running out of work.
+        while (remaining > 0)
+            context.run_one();
+    }
+
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * concurrency));
+}
+
+BENCHMARK(BM_http_client)
+    ->Args({1, 8})
+    ->Args({16, 8})
+    ->Args({64, 8})
+    ->Args({64, 1})
+    ->UseRealTime()
+    ->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,243 @@
+// Distributed under the BSD 2-Clause License - Copyright 2012-2023 Robin Degen
+
+#include <benchmark/benchmark.h>
+
+#include <aeon/web/http/http_server.h>
+#include <asio.hpp>
+#include <thread>
+#include <memory>
+#include <vector>
+#include <string>
+
+using namespace aeon;
+
+namespace
+{
+
+constexpr std::uint16_t benchmark_port = 38272;
+constexpr std::uint16_t benchmark_pool_port = 38275;
+
+const std::string benchmark_request = "GET /benchmark HTTP/1.1\r\nHost: localhost\r\nUser-Agent: benchmark\r\n\r\n";
+
+class hello_server_socket final : public web::http::http_server_socket
+{
+public:
+    explicit hello_server_socket(asio::ip::tcp::socket socket, [[maybe_unused]] web::http::http_server_session &session)
+        : http_server_socket{std::move(socket)}
+    {
+        set_max_keep_alive_requests(0);
+    }
+
+    void on_http_request([[maybe_unused]] const web::http::request &request) override
+    {
+        respond("text/plain", "Hello!");
+    }
+};
+
+/*!
+ * Runs the server on a separate thread for the duration of a benchmark.
+ */
+class server_thread final
+{
+public:
+    server_thread()
+        : context_{}
+        , server_{context_, benchmark_port}
+        , thread_{[this]() { context_.run(); }}
+    {
+    }
+
+    ~server_thread()
+    {
+        context_.stop();
+        thread_.join();
+    }
+
+    server_thread(server_thread &&) = delete;
+    auto operator=(server_thread &&) -> server_thread & = delete;
+
+    server_thread(const server_thread &) = delete;
+    auto operator=(const server_thread &) -> server_thread & = delete;
+
+private:
+    asio::io_context context_;
+    web::http::http_server<hello_server_socket> server_;
+    std::thread thread_;
+};
+
+[[nodiscard]] auto connect(asio::io_context &context, const std::uint16_t port = benchmark_port)
+    -> asio::ip::tcp::socket
+{
+    asio::ip::tcp::socket socket{context};
+    socket.connect(asio::ip::tcp::endpoint{asio::ip::address_v4::loopback(), port});
+    socket.set_option(asio::ip::tcp::no_delay{true});
+    return socket;
+}
+
+/*!
+ * The server always gives the same reply, so its size only needs to be determined once.
+ */
+[[nodiscard]] auto measure_response_size(asio::io_context &context) -> std::size_t
+{
+    auto socket = connect(context);
+    asio::write(socket, asio::buffer(benchmark_request));
+
+    std::string response;
+    return asio::read_until(socket, asio::dynamic_buffer(response), "Hello!");
+}
+
+struct client_connection
+{
+    asio::ip::tcp::socket socket;
+    std::vector<char> response;
+};
+
+void send_requests(client_connection &connection, const std::string &requests)
+{
+    asio::async_write(connection.socket, asio::buffer(requests),
+                      [&connection](const std::error_code ec, const std::size_t)
+                      {
+                          if (ec)
+                              return;
+
+                          asio::async_read(connection.socket, asio::buffer(connection.response),
+                                           [](const std::error_code, const std::size_t) {});
+                      });
+}
+
+/*!
+ * A client thread with its own connections, so that the client side scales along with the server.
+ */
+struct client_thread
+{
+    asio::io_context context;
+    std::vector<client_connection> connections;
+};
+
+} // namespace
+
+/*!
+ * Many keep-alive connections that each send a batch of pipelined requests per iteration.
+ * Arguments: connection count, requests per connection per iteration.
+ */
+static void BM_http_server_keep_alive(benchmark::State &state)
+{
+    const server_thread server;
+
+    const auto connection_count = static_cast<std::size_t>(state.range(0));
+    const auto pipeline_depth = static_cast<std::size_t>(state.range(1));
+
+    asio::io_context context;
+    const auto response_size = measure_response_size(context);
+
+    std::string requests;
+
+    for (std::size_t i = 0; i < pipeline_depth; ++i)
+        requests += benchmark_request;
+
+    std::vector<client_connection> connections;
+    connections.reserve(connection_count);
+
+    for (std::size_t i = 0; i < connection_count; ++i)
+        connections.push_back(client_connection{connect(context), std::vector<char>(response_size * pipeline_depth)});
+
+    for ([[maybe_unused]] auto _ : state)
+    {
+        for (auto &connection : connections)
+            send_requests(connection, requests);
+
+        context.run();
+        context.restart();
+    }
+
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * connection_count * pipeline_depth));
+}
+
+BENCHMARK(BM_http_server_keep_alive)
+    ->Args({1, 1})
+    ->Args({16, 1})
+    ->Args({64, 1})
+    ->Args({16, 16})
+    ->Args({64, 16})
+    ->UseRealTime()
+    ->Unit(benchmark::kMicrosecond);
+
+/*!
+ * Like BM_http_server_keep_alive, but with a server thread per core. The requests per second per server thread are
+ * reported as well.
+ * Arguments: server thread count, connection count. Every connection sends 16 pipelined requests per iteration.
+ */
+static void BM_http_server_pool(benchmark::State &state)
+{
+    const auto thread_count = static_cast<std::size_t>(state.range(0));
+    const auto connection_count = static_cast<std::size_t>(state.range(1));
+    constexpr std::size_t pipeline_depth = 16;
+
+    web::http::http_server_pool<hello_server_socket> server{benchmark_pool_port, thread_count};
+    server.start(true);
+
+    std::size_t response_size = 0;
+
+    {
+        asio::io_context context;
+        auto socket = connect(context, benchmark_pool_port);
+        asio::write(socket, asio::buffer(benchmark_request));
+
+        std::string response;
+        response_size = asio::read_until(socket, asio::dynamic_buffer(response), "Hello!");
+    }
+
+    std::string requests;
+
+    for (std::size_t i = 0; i < pipeline_depth; ++i)
+        requests += benchmark_request;
+
+    std::vector<std::unique_ptr<client_thread>> clients;
+
+    for (std::size_t i = 0; i < thread_count; ++i)
+        clients.push_back(std::make_unique<client_thread>());
+
+    for (std::size_t i = 0; i < connection_count; ++i)
+    {
+        auto &client = *clients[i % thread_count];
+        client.connections.push_back(client_connection{connect(client.context, benchmark_pool_port),
+                                                       std::vector<char>(response_size * pipeline_depth)});
+    }
+
+    std::vector<std::thread> threads;
+    threads.reserve(thread_count);
+
+    for ([[maybe_unused]] auto _ : state)
+    {
+        for (auto &client : clients)
+        {
+            threads.emplace_back(
+                [&client, &requests]()
+                {
+                    for (auto &connection : client->connections)
+                        send_requests(connection, requests);
+
+                    client->context.run();
+                    client->context.restart();
+                });
+        }
+
+        for (auto &thread : threads)
+            thread.join();
+
+        threads.clear();
+    }
+
+    const auto requests_processed = static_cast<double>(state.iterations() * connection_count * pipeline_depth);
+    state.SetItemsProcessed(static_cast<std::int64_t>(requests_processed));
+    state.counters["requests_per_core"] =
+        benchmark::Counter{requests_processed / static_cast<double>(thread_count), benchmark::Counter::kIsRate};
+}
+
+BENCHMARK(BM_http_server_pool)
+    ->Args({1, 64})
+    ->Args({2, 64})
+    ->Args({4, 64})
+    ->Args({8, 64})
+    ->UseRealTime()
+    ->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,102 @@
+// Distributed under the BSD 2-Clause License - Copyright 2012-2023 Robin Degen
+
+#include <benchmark/benchmark.h>
+
+#include <aeon/web/jsonrpc/server.h>
+#include <aeon/ptree/serialization/serialization_json.h>
+#include <aeon/common/string.h>
+#include <string>
+#include <cstdint>
+
+using namespace aeon;
+
+namespace
+{
+
+/*!
+ * A method that does a bit of work per call: the sum of the squares of the values in the params array.
+ */
+[[nodiscard]] auto make_server(const bool parallel) -> web::jsonrpc::server
+{
+    web::jsonrpc::server server;
+    server.set_batch_settings(web::jsonrpc::batch_settings{parallel, 4});
+    server.register_method({"sum_squares", [](const ptree::property_tree &params)
+                            {
+                                std::int64_t sum = 0;
+
+                                for (const auto &value : params.array_value())
+                                    sum += value.integer_value() * value.integer_value();
+
+                                return web::jsonrpc::result{ptree::property_tree{sum}};
+                            }});
+    return server;
+}
+
+[[nodiscard]] auto make_batch(const std::size_t size) -> common::string
+{
+    std::string params = "[";
+
+    for (auto i = 0; i < 16; ++i)
+        params += (i == 0 ? "" : ",") + std::to_string(i);
+
+    params += "]";
+
+    std::string batch = "[";
+
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        batch += (i == 0 ? "" : ",") + std::string{R"({"jsonrpc":"2.0","method":"sum_squares","params":)"} + params +
+                 R"(,"id":)" + std::to_string(i) + "}";
+    }
+
+    batch += "]";
+    return common::string{batch};
+}
+
+} // namespace
+
+/*!
+ * Responses built as a property tree and serialized to a string afterwards, as it was done before.
+ * Arguments: batch size.
+ */
+static void BM_jsonrpc_batch_property_tree(benchmark::State &state)
+{
+    const auto server = make_server(false);
+    const auto batch = make_batch(static_cast<std::size_t>(state.range(0)));
+
+    for ([[maybe_unused]] auto _ : state)
+    {
+        auto response = ptree::serialization::to_json(server.request(ptree::serialization::from_json(batch)));
+        benchmark::DoNotOptimize(response);
+    }
+
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * state.range(0)));
+}
+
+BENCHMARK(BM_jsonrpc_batch_property_tree)->Arg(1)->Arg(16)->Arg(128);
+
+/*!
+ * Responses serialized directly into the buffer that would be sent.
+ * Arguments: batch size, parallel.
+ */
+static void BM_jsonrpc_batch(benchmark::State &state)
+{
+    const auto server = make_server(state.range(1) != 0);
+    const auto batch = make_batch(static_cast<std::size_t>(state.range(0)));
+
+    for ([[maybe_unused]] auto _ : state)
+    {
+        auto response = server.request(batch);
+        benchmark::DoNotOptimize(response);
+    }
+
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * state.range(0)));
+}
+
+BENCHMARK(BM_jsonrpc_batch)
+    ->Args({1, 0})
+    ->Args({16, 0})
+    ->Args({128, 0})
+    ->Args({16, 1})
+    ->Args({128, 1})
+    ->UseRealTime();
@@ -0,0 +1,169 @@
+// Distributed under the BSD 2-Clause License - Copyright 2012-2023 Robin Degen
+
+#include <benchmark/benchmark.h>
+
+#include <aeon/web/http/router.h>
+#include <aeon/web/http/route.h>
+#include <aeon/common/string.h>
+#include <memory>
+#include <vector>
+#include <string>
+#include <map>
+
+using namespace aeon;
+
+namespace
+{
+
+class dummy_route final : public web::http::route
+{
+public:
+    using route::route;
+
+    void on_http_request([[maybe_unused]] web::http::http_server_socket &source,
+                         [[maybe_unused]] web::http::routable_http_server_session &session,
+                         [[maybe_unused]] const web::http::request &request) override
+    {
+    }
+};
+
+/*!
+ * A route table that looks like a typical REST api: a few services, each with a couple of resources.
+ */
+[[nodiscard]] auto make_mount_points(const std::size_t count) -> std::vector<std::string>
+{
+    std::vector<std::string> mount_points;
+    mount_points.reserve(count);
+
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        const auto service = "/api/service" + std::to_string(i / 8);
+
+        switch (i % 4)
+        {
+            case 0:
+                mount_points.push_back(service + "/items" + std::to_string(i));
+                break;
+            case 1:
+                mount_points.push_back(service + "/items" + std::to_string(i) + "/:id");
+                break;
+            case 2:
+                mount_points.push_back(service + "/users" + std::to_string(i) + "/:id/settings");
+                break;
+            default:
+                mount_points.push_back(service + "/status" + std::to_string(i));
+                break;
+        }
+    }
+
+    return mount_points;
+}
+
+[[nodiscard]] auto make_paths(const std::vector<std::string> &mount_points) -> std::vector<std::string>
+{
+    std::vector<std::string> paths;
+    paths.reserve(std::size(mount_points));
+
+    for (const auto &mount_point : mount_points)
+    {
+        auto path = mount_point;
+
+        for (auto offset = path.find(':'); offset != std::string::npos; offset = path.find(':'))
+            path.replace(offset, path.find('/', offset) - offset, "12345");
+
+        paths.push_back(path + "/details");
+    }
+
+    return paths;
+}
+
+/*!
+ * The route lookup as it was done before the radix tree, for comparison. This can't handle path parameters, so they are
+ * matched as plain text.
+ */
+[[nodiscard]] auto find_linear(const std::map<common::string, std::unique_ptr<dummy_route>> &routes,
+                               const common::string &path, common::string &route_path) -> web::http::route *
+{
+    auto actual_path = path;
+
+    if (path[0] != '/')
+        actual_path = "/" + path;
+
+    std::size_t best_match_length = 0;
+    web::http::route *best_match_route = nullptr;
+
+    for (auto &[route, route_ptr] : routes)
+    {
+        const auto route_path_length = route.size();
+
+        if (route_path_length > best_match_length)
+        {
+            if (actual_path.compare(0, route_path_length, route) == 0)
+            {
+                best_match_length = route_path_length;
+                best_match_route = route_ptr.get();
+            }
+        }
+    }
+
+    if (best_match_route)
+        route_path = actual_path.substr(best_match_length);
+
+    return best_match_route;
+}
+
+} // namespace
+
+static void BM_router_find(benchmark::State &state)
+{
+    const auto mount_points = make_mount_points(static_cast<std::size_t>(state.range(0)));
+    const auto paths = make_paths(mount_points);
+
+    std::vector<std::unique_ptr<dummy_route>> routes;
+    web::http::router router;
+
+    for (const auto &mount_point : mount_points)
+    {
+        routes.push_back(std::make_unique<dummy_route>(mount_point));
+        [[maybe_unused]] const auto result = router.insert(mount_point, std::nullopt, routes.back().get());
+    }
+
+    web::http::route_match match;
+    std::size_t index = 0;
+
+    for ([[maybe_unused]] auto _ : state)
+    {
+        benchmark::DoNotOptimize(router.find(paths[index], web::http::http_method::get, match));
+        benchmark::DoNotOptimize(match);
+
+        if (++index == std::size(paths))
+            index = 0;
+    }
+}
+
+BENCHMARK(BM_router_find)->RangeMultiplier(8)->Range(8, 4096);
+
+static void BM_router_find_linear(benchmark::State &state)
+{
+    const auto mount_points = make_mount_points(static_cast<std::size_t>(state.range(0)));
+    const auto paths = make_paths(mount_points);
+
+    std::map<common::string, std::unique_ptr<dummy_route>> routes;
+
+    for (const auto &mount_point : mount_points)
+        routes.emplace(mount_point, std::make_unique<dummy_route>(mount_point));
+
+    std::vector<common::string> path_strings{std::begin(paths), std::end(paths)};
+    common::string route_path;
+    std::size_t index = 0;
+
+    for ([[maybe_unused]] auto _ : state)
+    {
+        benchmark::DoNotOptimize(find_linear(routes, path_strings[index], route_path));
+
+        if (++index == std::size(path_strings))
+            index = 0;
+    }
+}
+
+BENCHMARK(BM_router_find_linear)->RangeMultiplier(8)->Range(8, 4096);
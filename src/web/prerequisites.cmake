@@ -1,6 +1,7 @@
 # Distributed under the BSD 2-Clause License - Copyright 2012-2023 Robin Degen
 
 depend_on(common)
+depend_on(compression)
 depend_on(ptree)
 depend_on(streams)
 depend_on(sockets)
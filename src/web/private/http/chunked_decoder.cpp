@@ -0,0 +1,158 @@
+// Distributed under the BSD 2-Clause License - Copyright 2012-2023 Robin Degen
+
+#include <aeon/web/http/chunked_decoder.h>
+#include "parser_utils.h"
+#include <algorithm>
+#include <charconv>
+
+namespace aeon::web::http::detail
+{
+
+chunked_decoder::chunked_decoder() noexcept
+    : max_header_size_{0}
+    , max_content_length_{0}
+    , state_{chunk_state::size}
+    , remaining_{0}
+    , received_{0}
+    , trailer_size_{0}
+    , line_{}
+    , error_{status_code::ok}
+{
+}
+
+void chunked_decoder::reset(const std::size_t max_header_size, const std::size_t max_content_length) noexcept
+{
+    max_header_size_ = max_header_size;
+    max_content_length_ = max_content_length;
+    state_ = chunk_state::size;
+    remaining_ = 0;
+    received_ = 0;
+    trailer_size_ = 0;
+    line_.clear();
+    error_ = status_code::ok;
+}
+
+auto chunked_decoder::decode(const std::span<const std::byte> data, std::size_t &used,
+                             std::span<const std::byte> &piece) -> chunked_decoder_result
+{
+    used = 0;
+    piece = {};
+
+    if (std::empty(data))
+        return chunked_decoder_result::incomplete;
+
+    if (state_ == chunk_state::data)
+    {
+        used = std::min(remaining_, std::size(data));
+        piece = data.first(used);
+        remaining_ -= used;
+
+        if (remaining_ == 0)
+            state_ = chunk_state::data_end;
+
+        return chunked_decoder_result::progress;
+    }
+
+    // All other parts of chunked content are single lines.
+    const std::string_view text{reinterpret_cast<const char *>(std::data(data)), std::size(data)};
+    const auto line_end = text.find('\n');
+
+    if (line_end == std::string_view::npos)
+    {
+        if (state_ == chunk_state::trailer && trailer_size_ + std::size(line_) + std::size(text) > max_header_size_)
+            return fail(status_code::request_header_fields_too_large);
+
+        if (std::size(line_) + std::size(text) > max_header_size_)
+            return fail(status_code::bad_request);
+
+        line_.append(text);
+        used = std::size(text);
+        return chunked_decoder_result::incomplete;
+    }
+
+    used = line_end + 1;
+
+    // Trailer fields are ignored, but like the header fields their total size is limited.
+    if (state_ == chunk_state::trailer)
+    {
+        trailer_size_ += std::size(line_) + used;
+
+        if (trailer_size_ > max_header_size_)
+            return fail(status_code::request_header_fields_too_large);
+    }
+
+    auto line = text.substr(0, line_end);
+
+    // The line was split over multiple calls.
+    if (!std::empty(line_))
+    {
+        line_.append(line);
+        line = line_;
+    }
+
+    if (!std::empty(line) && line.back() == '\r')
+        line.remove_suffix(1);
+
+    const auto result = decode_line(line);
+    line_.clear();
+    return result;
+}
+
+auto chunked_decoder::get_error() const noexcept -> status_code
+{
+    return error_;
+}
+
+auto chunked_decoder::decode_line(const std::string_view line) -> chunked_decoder_result
+{
+    switch (state_)
+    {
+        case chunk_state::size:
+        {
+            // Chunk extensions are ignored; see RFC 7230 section 4.1.1.
+            const auto size_str = trim_whitespace(line.substr(0, line.find(';')));
+
+            std::size_t size = 0;
+            const auto [end, ec] =
+                std::from_chars(std::data(size_str), std::data(size_str) + std::size(size_str), size, 16);
+
+            if (std::empty(size_str) || ec != std::errc{} || end != std::data(size_str) + std::size(size_str))
+                return fail(status_code::bad_request);
+
+            if (size > max_content_length_ - received_)
+                return fail(status_code::payload_too_large);
+
+            received_ += size;
+            remaining_ = size;
+            state_ = (size == 0) ? chunk_state::trailer : chunk_state::data;
+            return chunked_decoder_result::progress;
+        }
+        case chunk_state::data_end:
+        {
+            if (!std::empty(line))
+                return fail(status_code::bad_request);
+
+            state_ = chunk_state::size;
+            return chunked_decoder_result::progress;
+        }
+        case chunk_state::trailer:
+        {
+            // Trailer fields are ignored.
+            if (std::empty(line))
+                return chunked_decoder_result::complete;
+
+            return chunked_decoder_result::progress;
+        }
+        case chunk_state::data:
+        default:
+            return fail(status_code::bad_request);
+    }
+}
+
+auto chunked_decoder::fail(const status_code code) noexcept -> chunked_decoder_result
+{
+    error_ = code;
+    return chunked_decoder_result::error;
+}
+
+} // namespace aeon::web::http::detail
@@ -0,0 +1,16 @@
+// Distributed under the BSD 2-Clause License - Copyright 2012-2023 Robin Degen
+
+#pragma once
+
+#include <asio/thread_pool.hpp>
+
+namespace aeon::web::http::detail
+{
+
+/*!
+ * The threads that replies are compressed on, so that compression never blocks the threads that handle the sockets.
+ * Shared by all servers; the threads are started on first use.
+ */
+[[nodiscard]] auto get_compression_pool() -> asio::thread_pool &;
+
+} // namespace aeon::web::http::detail
@@ -0,0 +1,177 @@
+// Distributed under the BSD 2-Clause License - Copyright 2012-2023 Robin Degen
+
+#include <aeon/web/http/content_encoding.h>
+#include <aeon/common/string_utils.h>
+#include "compression_pool.h"
+#include <algorithm>
+#include <charconv>
+#include <thread>
+#include <array>
+
+namespace aeon::web::http
+{
+
+namespace internal
+{
+
+// The size of the buffer that zlib writes its output to.
+static constexpr int compress_buffer_size = 16 * 1024;
+
+[[nodiscard]] static auto trim(std::string_view str) noexcept -> std::string_view
+{
+    while (!std::empty(str) && (str.front() == ' ' || str.front() == '\t'))
+        str.remove_prefix(1);
+
+    while (!std::empty(str) && (str.back() == ' ' || str.back() == '\t'))
+        str.remove_suffix(1);
+
+    return str;
+}
+
+/*!
+ * The quality value of a single coding in an Accept-Encoding header (ie. "gzip;q=0.5"); 1 if none is given.
+ */
+[[nodiscard]] static auto parse_quality(const std::string_view parameters) noexcept -> float
+{
+    const auto value = trim(parameters);
+
+    if (!value.starts_with("q=") && !value.starts_with("Q="))
+        return 1.0f;
+
+    float quality = 0.0f;
+    const auto result = std::from_chars(std::data(value) + 2, std::data(value) + std::size(value), quality);
+
+    if (result.ec != std::errc{})
+        return 0.0f;
+
+    return quality;
+}
+
+/*!
+ * The quality with which the given coding is accepted; or a negative value if it is not mentioned at all.
+ */
+[[nodiscard]] static auto find_quality(const common::string_view &accept_encoding,
+                                       const common::string_view &coding) noexcept -> float
+{
+    std::string_view value{std::data(accept_encoding), std::size(accept_encoding)};
+    auto wildcard_quality = -1.0f;
+
+    while (!std::empty(value))
+    {
+        const auto separator = value.find(',');
+        const auto entry = value.substr(0, separator);
+        value = (separator == std::string_view::npos) ? std::string_view{} : value.substr(separator + 1);
+
+        const auto parameters = entry.find(';');
+        const auto name = trim(entry.substr(0, parameters));
+        const auto quality =
+            (parameters == std::string_view::npos) ? 1.0f : parse_quality(entry.substr(parameters + 1));
+
+        if (common::string_utils::iequals(name, coding))
+            return quality;
+
+        if (name == "*")
+            wildcard_quality = quality;
+    }
+
+    return wildcard_quality;
+}
+
+} // namespace internal
+
+auto accepts_content_encoding(const common::string_view &accept_encoding, const content_encoding encoding) noexcept
+    -> bool
+{
+    if (encoding == content_encoding::identity)
+        return true;
+
+    return internal::find_quality(accept_encoding, content_encoding_to_string(encoding)) > 0.0f;
+}
+
+auto negotiate_content_encoding(const common::string_view &accept_encoding) noexcept -> content_encoding
+{
+    const auto gzip_quality = internal::find_quality(accept_encoding, "gzip");
+    const auto deflate_quality = internal::find_quality(accept_encoding, "deflate");
+
+    if (gzip_quality > 0.0f && gzip_quality >= deflate_quality)
+        return content_encoding::gzip;
+
+    if (deflate_quality > 0.0f)
+        return content_encoding::deflate;
+
+    return content_encoding::identity;
+}
+
+auto content_encoding_to_string(const content_encoding encoding) noexcept -> common::string_view
+{
+    switch (encoding)
+    {
+        case content_encoding::gzip:
+            return "gzip";
+        case content_encoding::deflate:
+            return "deflate";
+        case content_encoding::identity:
+        default:
+            return "identity";
+    }
+}
+
+auto is_compressible_content_type(const common::string_view &content_type) noexcept -> bool
+{
+    static constexpr std::array<std::string_view, 6> compressible_types{
+        "application/json", "application/javascript", "application/x-javascript",
+        "application/xml",  "application/wasm",       "image/svg+xml"};
+
+    std::string_view value{std::data(content_type), std::size(content_type)};
+    value = internal::trim(value.substr(0, value.find(';')));
+
+    if (std::size(value) >= 5 && common::string_utils::iequals(value.substr(0, 5), "text/"))
+        return true;
+
+    // Structured syntax suffixes, like application/ld+json
+    if (value.ends_with("+json") || value.ends_with("+xml"))
+        return true;
+
+    return std::any_of(std::begin(compressible_types), std::end(compressible_types),
+                       [value](const auto type) { return common::string_utils::iequals(value, type); });
+}
+
+auto compress_content(const std::span<const std::byte> content, const content_encoding encoding,
+                      const compression::zlib_compression_mode mode) -> std::vector<std::byte>
+{
+    if (encoding == content_encoding::identity)
+        return {};
+
+    std::vector<std::byte> result;
+    result.reserve(std::size(content) / 2);
+
+    const auto append = [&result](const std::byte *data, const std::streamsize size)
+    {
+        result.insert(std::end(result), data, data + size);
+        return size;
+    };
+
+    try
+    {
+        const auto format =
+            (encoding == content_encoding::gzip) ? compression::zlib_format::gzip : compression::zlib_format::zlib;
+        compression::zlib_compress compress{mode, internal::compress_buffer_size, format};
+        compress.write(std::data(content), static_cast<std::streamsize>(std::size(content)), append);
+        compress.finish(append);
+    }
+    catch (const std::exception &)
+    {
+        return {};
+    }
+
+    return result;
+}
+
+auto detail::get_compression_pool() -> asio::thread_pool &
+{
+    // Half of the cores, so that there is always room left for the threads that handle the sockets.
+    static asio::thread_pool pool{std::max(std::thread::hardware_concurrency() / 2, 1u)};
+    return pool;
+}
+
+} // namespace aeon::web::http
@@ -0,0 +1,177 @@
+// Distributed under the BSD 2-Clause License - Copyright 2012-2023 Robin Degen
+
+#include <aeon/web/http/http_client.h>
+#include <aeon/web/http/reply_parser.h>
+#include "http_client_pool.h"
+#include <asio/post.hpp>
+#include <cstring>
+
+namespace aeon::web::http
+{
+
+client_reply_view::client_reply_view() noexcept
+    : status_code_{status_code::ok}
+    , headers_{}
+    , content_{}
+{
+}
+
+client_reply_view::client_reply_view(const reply_parser &parser) noexcept
+    : status_code_{parser.get_status_code()}
+    , headers_{parser.get_headers()}
+    , content_{parser.get_content()}
+{
+}
+
+auto client_reply_view::get_status_code() const noexcept -> status_code
+{
+    return status_code_;
+}
+
+auto client_reply_view::get_headers() const noexcept -> std::span<const http_header>
+{
+    return headers_;
+}
+
+auto client_reply_view::find_header(const common::string_view &name) const noexcept
+    -> std::optional<common::string_view>
+{
+    return find_http_header(headers_, name);
+}
+
+auto client_reply_view::get_content() const noexcept -> std::span<const std::byte>
+{
+    return content_;
+}
+
+auto client_reply_view::get_content_string() const noexcept -> common::string_view
+{
+    return common::string_view{reinterpret_cast<const char *>(std::data(content_)), std::size(content_)};
+}
+
+auto client_reply_view::copy() const -> client_reply
+{
+    return client_reply{*this};
+}
+
+client_reply::client_reply() noexcept
+    : status_code_{status_code::ok}
+    , data_{}
+    , headers_{}
+    , content_{}
+{
+}
+
+client_reply::client_reply(const client_reply_view &reply)
+    : status_code_{reply.get_status_code()}
+    , data_{}
+    , headers_{}
+    , content_{}
+{
+    const auto headers = reply.get_headers();
+    const auto content = reply.get_content();
+
+    auto size = std::size(content);
+
+    for (const auto &header : headers)
+        size += std::size(header.name) + std::size(header.value);
+
+    // The headers and content are copied out of the data of the connection in a single allocation.
+    data_.resize(size);
+    auto output = std::data(data_);
+
+    if (!std::empty(content))
+        std::memcpy(output, std::data(content), std::size(content));
+
+    content_ = std::span{output, std::size(content)};
+    output += std::size(content);
+
+    const auto copy_text = [&output](const common::string_view &text)
+    {
+        const auto result = common::string_view{reinterpret_cast<const char *>(output), std::size(text)};
+
+        if (!std::empty(text))
+            std::memcpy(output, std::data(text), std::size(text));
+
+        output += std::size(text);
+        return result;
+    };
+
+    headers_.reserve(std::size(headers));
+
+    for (const auto &header : headers)
+    {
+        const auto name = copy_text(header.name);
+        headers_.push_back(http_header{name, copy_text(header.value)});
+    }
+}
+
+auto client_reply::get_status_code() const noexcept -> status_code
+{
+    return status_code_;
+}
+
+auto client_reply::get_headers() const noexcept -> std::span<const http_header>
+{
+    return headers_;
+}
+
+auto client_reply::find_header(const common::string_view &name) const noexcept -> std::optional<common::string_view>
+{
+    return find_http_header(headers_, name);
+}
+
+auto client_reply::get_content() const noexcept -> std::span<const std::byte>
+{
+    return content_;
+}
+
+auto client_reply::get_content_string() const noexcept -> common::string_view
+{
+    return common::string_view{reinterpret_cast<const char *>(std::data(content_)), std::size(content_)};
+}
+
+http_client::http_client(asio::io_context &context, const http_client_settings &settings)
+    : context_{context}
+    , pool_{std::make_shared<detail::http_client_pool>(context, settings)}
+{
+}
+
+http_client::~http_client()
+{
+    close();
+}
+
+void http_client::request_async(const common::string &host, const std::uint16_t port, client_request request,
+                                client_reply_handler handler)
+{
+    // The connections are only ever used from the io_context, so no locking is needed.
+    asio::post(context_,
+               [pool = pool_, host, port, request = std::move(request), handler = std::move(handler)]() mutable
+               { pool->request(host, port, request, std::move(handler)); });
+}
+
+auto http_client::request(const common::string &host, const std::uint16_t port, client_request request)
+    -> std::future<client_reply>
+{
+    auto promise = std::make_shared<std::promise<client_reply>>();
+    auto future = promise->get_future();
+
+    request_async(host, port, std::move(request),
+                  [promise](const std::error_code &ec, const client_reply_view &reply)
+                  {
+                      if (ec)
+                          promise->set_exception(std::make_exception_ptr(std::system_error{ec}));
+                      else
+                          promise->set_value(reply.copy());
+                  });
+
+    return future;
+}
+
+void http_client::close()
+{
+    asio::post(context_, [pool = pool_]() { pool->close(); });
+}
+
+} // namespace aeon::web::http
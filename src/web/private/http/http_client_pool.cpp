@@ -0,0 +1,524 @@
+// Distributed under the BSD 2-Clause License - Copyright 2012-2023 Robin Degen
+
+#include "http_client_pool.h"
+#include <algorithm>
+#include <iterator>
+#include <string>
+
+namespace aeon::web::http::detail
+{
+
+namespace internal
+{
+
+static constexpr std::uint16_t default_http_port = 80;
+
+[[nodiscard]] static auto make_host_header(const common::string &host, const std::uint16_t port) -> common::string
+{
+    auto header = host.str();
+
+    if (port != default_http_port)
+    {
+        header += ':';
+        header += std::to_string(port);
+    }
+
+    return common::string{header};
+}
+
+[[nodiscard]] static auto has_content(const client_request &request) noexcept -> bool
+{
+    // Servers require a length for these, even if there is no content.
+    return !std::empty(request.content) || request.method == http_method::post ||
+           request.method == http_method::put || request.method == http_method::patch;
+}
+
+/*!
+ * Serialize the request line, headers and content into a single buffer, so that it is sent with a single write.
+ */
+[[nodiscard]] static auto serialize_request(const client_request &request, const common::string &host_header)
+    -> std::shared_ptr<const std::vector<std::byte>>
+{
+    std::string header;
+    header.reserve(128 + std::size(request.uri) + std::size(request.headers));
+
+    header += method_to_string(request.method).as_std_string_view();
+    header += ' ';
+    header += request.uri.as_std_string_view();
+    header += " HTTP/1.1\r\nHost: ";
+    header += host_header.as_std_string_view();
+    header += "\r\n";
+
+    if (!std::empty(request.content_type))
+    {
+        header += "Content-Type: ";
+        header += request.content_type.as_std_string_view();
+        header += "\r\n";
+    }
+
+    if (has_content(request))
+    {
+        header += "Content-Length: ";
+        header += std::to_string(std::size(request.content));
+        header += "\r\n";
+    }
+
+    header += request.headers.as_std_string_view();
+    header += "\r\n";
+
+    auto data = std::make_shared<std::vector<std::byte>>();
+    data->reserve(std::size(header) + std::size(request.content));
+
+    const auto header_data = reinterpret_cast<const std::byte *>(std::data(header));
+    data->insert(std::end(*data), header_data, header_data + std::size(header));
+    data->insert(std::end(*data), std::begin(request.content), std::end(request.content));
+    return data;
+}
+
+[[nodiscard]] static auto is_retryable(const http_client_pending_request &request, const std::error_code &ec) noexcept
+    -> bool
+{
+    // Timeouts and protocol errors would most likely happen again; and aborted requests must not be sent at all.
+    if (ec == asio::error::timed_out || ec == asio::error::operation_aborted ||
+        ec == std::make_error_code(std::errc::bad_message))
+        return false;
+
+    return !request.retried && is_idempotent_method(request.method);
+}
+
+} // namespace internal
+
+http_client_connection::http_client_connection(asio::io_context &context, std::weak_ptr<http_client_host> host,
+                                               const http_client_settings &settings)
+    : tcp_socket{context}
+    , host_{std::move(host)}
+    , settings_{settings}
+    , timer_{context}
+    , parser_{}
+    , pending_{}
+    , state_{connection_state::connecting}
+    , error_{}
+    , closing_{false}
+    , reused_{false}
+{
+}
+
+http_client_connection::~http_client_connection() = default;
+
+void http_client_connection::start(const asio::ip::tcp::resolver::results_type &endpoints)
+{
+    restart_timer();
+    connect(endpoints);
+}
+
+auto http_client_connection::can_send(const http_client_pending_request &request) const noexcept -> bool
+{
+    if (state_ != connection_state::connected || closing_)
+        return false;
+
+    if (std::empty(pending_))
+        return true;
+
+    // A request that is not idempotent can't be retried when the connection is closed before it was answered; so it
+    // is never sent behind or in front of another request.
+    if (std::size(pending_) >= settings_.max_pipelined_requests || !is_idempotent_method(request.method))
+        return false;
+
+    return is_idempotent_method(pending_.back().method);
+}
+
+auto http_client_connection::is_connecting() const noexcept -> bool
+{
+    return state_ == connection_state::connecting;
+}
+
+auto http_client_connection::get_pending_count() const noexcept -> std::size_t
+{
+    return std::size(pending_);
+}
+
+void http_client_connection::send_request(http_client_pending_request request)
+{
+    const auto data = request.data;
+    pending_.push_back(std::move(request));
+
+    if (std::size(pending_) == 1)
+    {
+        begin_reply();
+        restart_timer();
+    }
+
+    send(data, 0, std::size(*data));
+}
+
+void http_client_connection::close(const std::error_code &ec)
+{
+    if (state_ == connection_state::closed)
+        return;
+
+    error_ = ec;
+    on_closed();
+    disconnect();
+}
+
+void http_client_connection::on_connected()
+{
+    state_ = connection_state::connected;
+    restart_timer();
+
+    if (const auto host = host_.lock())
+        host->on_connection_ready();
+}
+
+void http_client_connection::on_disconnected()
+{
+    if (state_ == connection_state::closed)
+        return;
+
+    // Closing the connection is how the end of a reply without a length is signaled.
+    if (!std::empty(pending_) && parser_.finish() == reply_parser_result::complete)
+    {
+        complete_reply();
+
+        if (state_ == connection_state::closed)
+            return;
+    }
+
+    on_closed();
+}
+
+void http_client_connection::on_data(const std::span<const std::byte> &data)
+{
+    auto remaining = data;
+
+    while (!std::empty(remaining) && state_ == connection_state::connected)
+    {
+        // The server sent something that was not asked for.
+        if (std::empty(pending_))
+        {
+            close(std::make_error_code(std::errc::bad_message));
+            return;
+        }
+
+        const auto result = parser_.parse(remaining);
+
+        if (result == reply_parser_result::error)
+        {
+            close(std::make_error_code(std::errc::bad_message));
+            return;
+        }
+
+        if (result == reply_parser_result::incomplete)
+        {
+            restart_timer();
+            return;
+        }
+
+        remaining = remaining.subspan(parser_.consumed());
+        complete_reply();
+    }
+}
+
+void http_client_connection::on_error(const std::error_code &ec)
+{
+    // The first error is the most descriptive one; closing the socket causes aborted operations afterwards.
+    if (!error_ && ec != asio::error::operation_aborted)
+        error_ = ec;
+}
+
+void http_client_connection::begin_reply() noexcept
+{
+    parser_.reset();
+    parser_.set_head_request(pending_.front().method == http_method::head);
+}
+
+void http_client_connection::complete_reply()
+{
+    auto request = std::move(pending_.front());
+    pending_.pop_front();
+
+    closing_ = closing_ || !parser_.is_keep_alive();
+    reused_ = true;
+
+    // The reply is a view into the parser and the received data, so the parser may only be reset afterwards.
+    request.handler({}, client_reply_view{parser_});
+
+    if (std::empty(pending_))
+        parser_.reset();
+    else
+        begin_reply();
+
+    restart_timer();
+
+    const auto host = host_.lock();
+
+    if (closing_)
+    {
+        // The server announced that it closes the connection, so the requests that were pipelined behind this one
+        // were never processed. They can safely be sent again on another connection.
+        if (host)
+        {
+            auto unprocessed = std::move(pending_);
+            pending_.clear();
+            host->requeue(std::move(unprocessed));
+        }
+
+        close(asio::error::eof);
+        return;
+    }
+
+    if (host)
+        host->on_connection_ready();
+}
+
+void http_client_connection::restart_timer()
+{
+    if (state_ == connection_state::closed)
+        return;
+
+    auto timeout = settings_.request_timeout;
+
+    if (state_ == connection_state::connecting)
+        timeout = settings_.connect_timeout;
+    else if (std::empty(pending_))
+        timeout = settings_.idle_timeout;
+
+    timer_.expires_after(timeout);
+    timer_.async_wait(
+        [self = std::static_pointer_cast<http_client_connection>(shared_from_this())](const std::error_code ec)
+        {
+            // The timer may have been restarted after it expired, but before this handler was called.
+            if (ec == asio::error::operation_aborted || self->timer_.expiry() > std::chrono::steady_clock::now())
+                return;
+
+            self->close(asio::error::timed_out);
+        });
+}
+
+void http_client_connection::on_closed()
+{
+    const auto connected = (state_ == connection_state::connected);
+    state_ = connection_state::closed;
+    timer_.cancel();
+
+    const std::error_code ec = error_ ? error_ : std::error_code{asio::error::eof};
+    auto unanswered = std::move(pending_);
+    pending_.clear();
+
+    if (const auto host = host_.lock())
+    {
+        host->on_connection_closed(*this, ec, connected, reused_, std::move(unanswered));
+        return;
+    }
+
+    for (auto &request : unanswered)
+        request.handler(asio::error::operation_aborted, client_reply_view{});
+}
+
+http_client_host::http_client_host(asio::io_context &context, common::string host, const std::uint16_t port,
+                                   const http_client_settings &settings)
+    : context_{context}
+    , host_{std::move(host)}
+    , port_{port}
+    , host_header_{internal::make_host_header(host_, port)}
+    , settings_{settings}
+    , resolver_{context}
+    , endpoints_{}
+    , resolving_{false}
+    , connections_{}
+    , queue_{}
+{
+}
+
+http_client_host::~http_client_host() = default;
+
+auto http_client_host::get_host_header() const noexcept -> const common::string &
+{
+    return host_header_;
+}
+
+void http_client_host::request(http_client_pending_request request)
+{
+    queue_.push_back(std::move(request));
+    dispatch();
+}
+
+void http_client_host::close()
+{
+    resolver_.cancel();
+    fail_queued(asio::error::operation_aborted);
+
+    const auto connections = std::move(connections_);
+    connections_.clear();
+
+    for (const auto &connection : connections)
+        connection->close(asio::error::operation_aborted);
+}
+
+void http_client_host::requeue(std::deque<http_client_pending_request> requests)
+{
+    queue_.insert(std::begin(queue_), std::make_move_iterator(std::begin(requests)),
+                  std::make_move_iterator(std::end(requests)));
+}
+
+void http_client_host::on_connection_ready()
+{
+    dispatch();
+}
+
+void http_client_host::on_connection_closed(const http_client_connection &connection, const std::error_code &ec,
+                                            const bool connected, const bool reused,
+                                            std::deque<http_client_pending_request> unanswered)
+{
+    std::erase_if(connections_, [&connection](const auto &c) { return c.get() == &connection; });
+
+    // A reused connection may have been closed by the server (ie. because of its keep-alive timeout) while the
+    // requests were underway. These are sent again, in their original order and before any queued requests.
+    std::deque<http_client_pending_request> retries;
+
+    for (auto &request : unanswered)
+    {
+        if (reused && internal::is_retryable(request, ec))
+        {
+            request.retried = true;
+            retries.push_back(std::move(request));
+        }
+        else
+        {
+            request.handler(ec, client_reply_view{});
+        }
+    }
+
+    queue_.insert(std::begin(queue_), std::make_move_iterator(std::begin(retries)),
+                  std::make_move_iterator(std::end(retries)));
+
+    if (!connected && ec != asio::error::operation_aborted)
+    {
+        // Resolve again for the next attempt; the address of the host may have changed.
+        endpoints_ = {};
+
+        // Without any other connections, the queued requests would wait forever.
+        if (std::empty(connections_))
+        {
+            fail_queued(ec);
+            return;
+        }
+    }
+
+    dispatch();
+}
+
+void http_client_host::resolve()
+{
+    if (resolving_)
+        return;
+
+    resolving_ = true;
+    resolver_.async_resolve(host_.as_std_string_view(), std::to_string(port_),
+                            [self = shared_from_this()](const std::error_code ec,
+                                                        asio::ip::tcp::resolver::results_type results)
+                            {
+                                self->resolving_ = false;
+
+                                if (ec || std::empty(results))
+                                {
+                                    self->fail_queued(ec ? ec : std::error_code{asio::error::host_not_found});
+                                    return;
+                                }
+
+                                self->endpoints_ = std::move(results);
+                                self->dispatch();
+                            });
+}
+
+void http_client_host::dispatch()
+{
+    const auto max_connections = std::max(settings_.max_connections_per_host, std::size_t{1});
+
+    while (!std::empty(queue_))
+    {
+        http_client_connection *best = nullptr;
+
+        for (const auto &connection : connections_)
+        {
+            if (connection->can_send(queue_.front()) &&
+                (!best || connection->get_pending_count() < best->get_pending_count()))
+                best = connection.get();
+        }
+
+        const auto connecting_count = get_connecting_count();
+
+        // Only open as many connections as there are requests waiting for one.
+        const auto can_open = std::size(connections_) < max_connections && connecting_count < std::size(queue_);
+
+        // Pipelining is only used once no more connections can be opened, since a request behind another one has to
+        // wait for it to complete.
+        if (best && (best->get_pending_count() == 0 || (!can_open && connecting_count < std::size(queue_))))
+        {
+            auto request = std::move(queue_.front());
+            queue_.pop_front();
+            best->send_request(std::move(request));
+            continue;
+        }
+
+        if (!can_open)
+            return;
+
+        if (std::empty(endpoints_))
+        {
+            resolve();
+            return;
+        }
+
+        auto connection = std::make_shared<http_client_connection>(context_, weak_from_this(), settings_);
+        connections_.push_back(connection);
+        connection->start(endpoints_);
+    }
+}
+
+auto http_client_host::get_connecting_count() const noexcept -> std::size_t
+{
+    return static_cast<std::size_t>(std::count_if(std::begin(connections_), std::end(connections_),
+                                                  [](const auto &connection) { return connection->is_connecting(); }));
+}
+
+void http_client_host::fail_queued(const std::error_code &ec)
+{
+    const auto queue = std::move(queue_);
+    queue_.clear();
+
+    for (const auto &request : queue)
+        request.handler(ec, client_reply_view{});
+}
+
+http_client_pool::http_client_pool(asio::io_context &context, const http_client_settings &settings)
+    : context_{context}
+    , settings_{settings}
+    , hosts_{}
+{
+}
+
+http_client_pool::~http_client_pool() = default;
+
+void http_client_pool::request(const common::string &host, const std::uint16_t port, const client_request &request,
+                               client_reply_handler handler)
+{
+    auto &entry = hosts_[host.str() + ':' + std::to_string(port)];
+
+    if (!entry)
+        entry = std::make_shared<http_client_host>(context_, host, port, settings_);
+
+    entry->request(http_client_pending_request{
+        request.method, internal::serialize_request(request, entry->get_host_header()), std::move(handler), false});
+}
+
+void http_client_pool::close()
+{
+    const auto hosts = std::move(hosts_);
+    hosts_.clear();
+
+    for (const auto &[key, host] : hosts)
+        host->close();
+}
+
+} // namespace aeon::web::http::detail
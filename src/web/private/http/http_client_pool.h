@@ -0,0 +1,196 @@
+// Distributed under the BSD 2-Clause License - Copyright 2012-2023 Robin Degen
+
+#pragma once
+
+#include <aeon/web/http/http_client.h>
+#include <aeon/web/http/reply_parser.h>
+#include <aeon/sockets/tcp_socket.h>
+#include <aeon/common/string.h>
+#include <asio/io_context.hpp>
+#include <asio/ip/tcp.hpp>
+#include <asio/steady_timer.hpp>
+#include <unordered_map>
+#include <system_error>
+#include <memory>
+#include <vector>
+#include <deque>
+#include <string>
+#include <cstdint>
+
+namespace aeon::web::http::detail
+{
+
+class http_client_host;
+
+/*!
+ * A request that was not answered yet. The serialized request is shared, so that it can be sent again without copying
+ * when it has to be retried on another connection.
+ */
+struct http_client_pending_request
+{
+    http_method method = http_method::invalid;
+    std::shared_ptr<const std::vector<std::byte>> data;
+    client_reply_handler handler;
+    bool retried = false;
+};
+
+/*!
+ * A single keep-alive connection to a host. Requests are pipelined: they are sent without waiting for the reply to
+ * the previous one. Since replies arrive in the same order, a single parser suffices.
+ *
+ * Only used from the thread that runs the io_context.
+ */
+class http_client_connection final : public sockets::tcp_socket
+{
+    enum class connection_state
+    {
+        connecting,
+        connected,
+        closed
+    };
+
+public:
+    explicit http_client_connection(asio::io_context &context, std::weak_ptr<http_client_host> host,
+                                    const http_client_settings &settings);
+    ~http_client_connection() override;
+
+    http_client_connection(http_client_connection &&) = delete;
+    auto operator=(http_client_connection &&) -> http_client_connection & = delete;
+
+    http_client_connection(const http_client_connection &) = delete;
+    auto operator=(const http_client_connection &) -> http_client_connection & = delete;
+
+    void start(const asio::ip::tcp::resolver::results_type &endpoints);
+
+    /*!
+     * Returns true if the given request can be sent over this connection right away.
+     */
+    [[nodiscard]] auto can_send(const http_client_pending_request &request) const noexcept -> bool;
+
+    [[nodiscard]] auto is_connecting() const noexcept -> bool;
+
+    [[nodiscard]] auto get_pending_count() const noexcept -> std::size_t;
+
+    void send_request(http_client_pending_request request);
+
+    /*!
+     * Close the connection. Requests that were not answered yet are handed back to the host.
+     */
+    void close(const std::error_code &ec);
+
+private:
+    void on_connected() override;
+    void on_disconnected() override;
+    void on_data(const std::span<const std::byte> &data) override;
+    void on_error(const std::error_code &ec) override;
+
+    void begin_reply() noexcept;
+    void complete_reply();
+    void restart_timer();
+    void on_closed();
+
+    std::weak_ptr<http_client_host> host_;
+    http_client_settings settings_;
+    asio::steady_timer timer_;
+    reply_parser parser_;
+    std::deque<http_client_pending_request> pending_;
+    connection_state state_;
+    std::error_code error_;
+
+    // Set once the server said it will close the connection after the current reply.
+    bool closing_;
+    bool reused_;
+};
+
+/*!
+ * The connections to a single host and the requests that are waiting for one of them.
+ *
+ * Only used from the thread that runs the io_context.
+ */
+class http_client_host final : public std::enable_shared_from_this<http_client_host>
+{
+public:
+    explicit http_client_host(asio::io_context &context, common::string host, const std::uint16_t port,
+                              const http_client_settings &settings);
+    ~http_client_host();
+
+    http_client_host(http_client_host &&) = delete;
+    auto operator=(http_client_host &&) -> http_client_host & = delete;
+
+    http_client_host(const http_client_host &) = delete;
+    auto operator=(const http_client_host &) -> http_client_host & = delete;
+
+    [[nodiscard]] auto get_host_header() const noexcept -> const common::string &;
+
+    void request(http_client_pending_request request);
+
+    /*!
+     * Close all connections. All pending requests fail with operation_aborted.
+     */
+    void close();
+
+    /*!
+     * Put requests that were never processed by the server back in front of the queue. They are sent once a
+     * connection becomes available.
+     */
+    void requeue(std::deque<http_client_pending_request> requests);
+
+    /*!
+     * Called by a connection when it is able to send (more) requests.
+     */
+    void on_connection_ready();
+
+    /*!
+     * Called by a connection once it was closed, along with the requests that it did not receive a reply for.
+     * connected is false if the connection could not be established; reused is true if at least one reply was
+     * received over it.
+     */
+    void on_connection_closed(const http_client_connection &connection, const std::error_code &ec,
+                              const bool connected, const bool reused,
+                              std::deque<http_client_pending_request> unanswered);
+
+private:
+    void resolve();
+    void dispatch();
+    [[nodiscard]] auto get_connecting_count() const noexcept -> std::size_t;
+    void fail_queued(const std::error_code &ec);
+
+    asio::io_context &context_;
+    common::string host_;
+    std::uint16_t port_;
+    common::string host_header_;
+    http_client_settings settings_;
+    asio::ip::tcp::resolver resolver_;
+    asio::ip::tcp::resolver::results_type endpoints_;
+    bool resolving_;
+    std::vector<std::shared_ptr<http_client_connection>> connections_;
+    std::deque<http_client_pending_request> queue_;
+};
+
+/*!
+ * The hosts that an http_client has connections to.
+ */
+class http_client_pool final
+{
+public:
+    explicit http_client_pool(asio::io_context &context, const http_client_settings &settings);
+    ~http_client_pool();
+
+    http_client_pool(http_client_pool &&) = delete;
+    auto operator=(http_client_pool &&) -> http_client_pool & = delete;
+
+    http_client_pool(const http_client_pool &) = delete;
+    auto operator=(const http_client_pool &) -> http_client_pool & = delete;
+
+    void request(const common::string &host, const std::uint16_t port, const client_request &request,
+                 client_reply_handler handler);
+
+    void close();
+
+private:
+    asio::io_context &context_;
+    http_client_settings settings_;
+    std::unordered_map<std::string, std::shared_ptr<http_client_host>> hosts_;
+};
+
+} // namespace aeon::web::http::detail
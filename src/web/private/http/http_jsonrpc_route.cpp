@@ -4,8 +4,7 @@
 #include <aeon/web/jsonrpc/result.h>
 #include <aeon/web/http/request.h>
 #include <aeon/web/http/http_server_socket.h>
-#include <aeon/ptree/ptree.h>
-#include <aeon/ptree/serialization/serialization_json.h>
+#include <vector>
 
 namespace aeon::web::http
 {
@@ -39,31 +38,42 @@ void http_jsonrpc_route::register_method(const jsonrpc::method &method) const
     rpc_server_ref_.register_method(method);
 }
 
+void http_jsonrpc_route::set_batch_settings(const jsonrpc::batch_settings &settings) const
+{
+    rpc_server_ref_.set_batch_settings(settings);
+}
+
 void http_jsonrpc_route::on_http_request(http_server_socket &source,
                                          [[maybe_unused]] routable_http_server_session &session, const request &request)
 {
     if (!validate_request(source, request))
         return;
 
-    const auto result = rpc_server_ref_.request(request.get_content_string());
-    source.respond(json_rpc_content_type, result);
+    // The response may be given later (from any thread) if the request calls async methods or is a batch that is
+    // executed in parallel. Requests that are pipelined behind it are held back until then.
+    rpc_server_ref_.request_async(
+        request.get_content_string(),
+        [socket = std::static_pointer_cast<http_server_socket>(source.shared_from_this())](
+            std::vector<std::byte> response) { socket->post_respond(json_rpc_content_type, std::move(response)); });
 }
 
 auto http_jsonrpc_route::validate_request(http_server_socket &source, const request &request) const -> bool
 {
     if (!request.has_content())
     {
-        const auto response = ptree::serialization::to_json(
-            jsonrpc::respond(jsonrpc::result{jsonrpc::json_rpc_error::parse_error, "No content"}));
-        source.respond(json_rpc_content_type, response);
+        std::vector<std::byte> response;
+        jsonrpc::respond(jsonrpc::result{jsonrpc::json_rpc_error::parse_error, "No content"}, response);
+        source.respond(json_rpc_content_type, std::move(response));
         return false;
     }
 
     if (request.get_content_type() != json_rpc_content_type)
     {
-        const auto response = ptree::serialization::to_json(jsonrpc::respond(
-            jsonrpc::result{jsonrpc::json_rpc_error::parse_error, "Invalid content type. Expected application/json."}));
-        source.respond(json_rpc_content_type, response);
+        std::vector<std::byte> response;
+        jsonrpc::respond(
+            jsonrpc::result{jsonrpc::json_rpc_error::parse_error, "Invalid content type. Expected application/json."},
+            response);
+        source.respond(json_rpc_content_type, std::move(response));
         return false;
     }
 
@@ -3,22 +3,48 @@
 #include <aeon/web/http/http_server_socket.h>
 #include <aeon/web/http/constants.h>
 #include <aeon/web/http/url_encoding.h>
-#include <aeon/sockets/config.h>
-#include <aeon/streams/stream_reader.h>
 #include <aeon/streams/string_stream.h>
-#include <aeon/streams/dynamic_stream.h>
 #include <aeon/common/string_utils.h>
+#include "compression_pool.h"
+#include <asio/post.hpp>
+#include <string_view>
+#include <array>
+#include <cstdio>
 
 namespace aeon::web::http
 {
 
+namespace internal
+{
+
+[[nodiscard]] static auto disable_nagle(asio::ip::tcp::socket socket) -> asio::ip::tcp::socket
+{
+    // Replies are written as soon as they are ready; waiting for more data only adds latency, especially when the
+    // client pipelines requests.
+    asio::error_code ec;
+    socket.set_option(asio::ip::tcp::no_delay{true}, ec);
+    return socket;
+}
+
+} // namespace internal
+
 http_server_socket::http_server_socket(asio::ip::tcp::socket socket)
-    : tcp_socket{std::move(socket)}
-    , state_{http_state::server_read_method}
+    : tcp_socket{internal::disable_nagle(std::move(socket))}
+    , state_{http_state::server_read_request}
     , request_{http_method::invalid}
-    , circular_buffer_{streams::circular_buffer_filter{},
-                       streams::memory_device<std::vector<char>>{sockets::tcp_socket_circular_buffer_size}}
-    , expected_content_length_{0}
+    , parser_{}
+    , pending_data_{}
+    , dispatching_{false}
+    , close_after_reply_{false}
+    , receiving_content_{false}
+    , chunk_producer_{}
+    , chunk_pending_{false}
+    , compression_{}
+    , accepted_encoding_{content_encoding::identity}
+    , keep_alive_timer_{get_io_context()}
+    , keep_alive_timeout_{detail::default_keep_alive_timeout}
+    , max_keep_alive_requests_{detail::default_max_keep_alive_requests}
+    , request_count_{0}
 {
 }
 
@@ -34,174 +60,504 @@ void http_server_socket::respond(const common::string &content_type, const commo
 void http_server_socket::respond(const common::string &content_type, std::vector<std::byte> data,
                                  const status_code code)
 {
-    streams::string_stream<std::vector<std::byte>> sstream{64};
-    sstream << detail::http_version_string;
-    sstream << ' ';
-    sstream << std::to_string(static_cast<int>(code));
-    sstream << ' ';
-    sstream << status_code_to_string(code);
-    sstream << "\r\n";
-    sstream << "Connection: keep-alive\r\n";
-    sstream << "Content-type: ";
-    sstream << content_type;
-    sstream << "\r\n";
-    sstream << "Content-Length: ";
-    sstream << std::to_string(std::size(data));
-    sstream << "\r\n\r\n";
+    if (state_ == http_state::server_closing)
+        return;
 
-    send(sstream.release());
-    send(std::move(data));
-    __reset_state();
+    common::string headers = "Content-type: ";
+    headers += content_type;
+    headers += "\r\n";
+
+    if (compression_.enabled && std::size(data) >= compression_.min_size &&
+        is_compressible_content_type(content_type))
+    {
+        // The reply depends on the Accept-Encoding header, so caches must take it into account.
+        headers += "Vary: Accept-Encoding\r\n";
+
+        if (accepted_encoding_ != content_encoding::identity)
+        {
+            __send_compressed_reply(code, std::move(headers), std::move(data));
+            return;
+        }
+    }
+
+    __send_reply(code, headers, std::move(data));
+    __finish_reply();
+}
+
+void http_server_socket::post_respond(const common::string &content_type, std::vector<std::byte> data,
+                                      const status_code code)
+{
+    auto &context = get_io_context();
+
+    if (context.get_executor().running_in_this_thread())
+    {
+        respond(content_type, std::move(data), code);
+        return;
+    }
+
+    asio::post(context,
+               [self = std::static_pointer_cast<http_server_socket>(shared_from_this()), content_type,
+                data = std::move(data), code]() mutable { self->respond(content_type, std::move(data), code); });
+}
+
+void http_server_socket::respond(const status_code code, const common::string &headers,
+                                 std::shared_ptr<const std::vector<std::byte>> content, const std::size_t offset,
+                                 const std::size_t size)
+{
+    if (state_ == http_state::server_closing)
+        return;
+
+    // The headers and content are still written together, since queued buffers are sent with a single gathered write.
+    send(__format_reply_header(code, headers, size));
+    send(std::move(content), offset, size);
+    __finish_reply();
+}
+
+void http_server_socket::respond_file(const status_code code, const common::string &headers,
+                                      const std::filesystem::path &path, const std::uint64_t offset,
+                                      const std::uint64_t size)
+{
+    if (state_ == http_state::server_closing)
+        return;
+
+    send(__format_reply_header(code, headers, size));
+
+    // The headers were already sent, so there is no way to report an error to the client at this point.
+    if (!send_file(path, offset, size))
+        close_after_reply_ = true;
+
+    __finish_reply();
+}
+
+void http_server_socket::respond_headers(const status_code code, const common::string &headers,
+                                         const std::uint64_t content_length)
+{
+    if (state_ == http_state::server_closing)
+        return;
+
+    send(__format_reply_header(code, headers, content_length));
+    __finish_reply();
+}
+
+void http_server_socket::respond_chunked(const status_code code, const common::string &headers,
+                                         chunk_producer producer)
+{
+    if (state_ == http_state::server_closing)
+        return;
+
+    send(__format_reply_header(code, headers, std::nullopt));
+    chunk_producer_ = std::move(producer);
+
+    // The first chunk is produced right away, so that it is written together with the headers.
+    __produce_chunk();
+}
+
+void http_server_socket::resume_chunked_response()
+{
+    if (!chunk_producer_ || !chunk_pending_)
+        return;
+
+    chunk_pending_ = false;
+    __produce_chunk();
+}
+
+void http_server_socket::respond_default(const status_code code)
+{
+    respond(detail::default_response_content_type, status_code_to_string(code), code);
+}
+
+void http_server_socket::set_keep_alive_timeout(const std::chrono::steady_clock::duration timeout)
+{
+    keep_alive_timeout_ = timeout;
+
+    if (state_ == http_state::server_read_request && !receiving_content_)
+        __start_keep_alive_timer();
+}
+
+void http_server_socket::set_max_keep_alive_requests(const std::size_t max_requests) noexcept
+{
+    max_keep_alive_requests_ = max_requests;
+}
+
+void http_server_socket::set_reply_compression(const reply_compression_settings &settings) noexcept
+{
+    compression_ = settings;
+}
+
+void http_server_socket::on_http_request_content([[maybe_unused]] const std::span<const std::byte> content,
+                                                 [[maybe_unused]] const bool last)
+{
+}
+
+void http_server_socket::set_stream_request_content(const bool stream) noexcept
+{
+    parser_.set_stream_content(stream);
+}
+
+void http_server_socket::set_max_streamed_request_content_length(const std::size_t max_content_length) noexcept
+{
+    parser_.set_max_streamed_content_length(max_content_length);
+}
+
+void http_server_socket::on_started()
+{
+    __start_keep_alive_timer();
 }
 
 void http_server_socket::on_data(const std::span<const std::byte> &data)
 {
-    circular_buffer_.write(std::data(data), std::size(data));
-    streams::stream_reader reader(circular_buffer_);
+    __process(data);
+}
+
+void http_server_socket::on_send_complete()
+{
+    // The previous chunk was written; only now produce the next one.
+    if (chunk_producer_ && !chunk_pending_)
+        __produce_chunk();
+}
 
-    while (circular_buffer_.size() != 0)
+void http_server_socket::__process(const std::span<const std::byte> data)
+{
+    auto remaining = data;
+
+    while (!std::empty(remaining))
     {
-        if (state_ == http_state::server_read_body)
+        if (state_ == http_state::server_closing)
+            return;
+
+        // The content of a streamed request is passed on as it is received; also after a reply was given.
+        if (receiving_content_)
         {
-            std::vector<std::byte> vec;
-            reader.read_to_vector(vec);
-            request_.append_raw_content_data(vec);
+            remaining = remaining.subspan(__process_content(remaining));
+            continue;
+        }
+
+        // Still waiting for the reply to the previous request; keep the data until respond() is called. No reply can
+        // be sent before that one, so once enough data is kept, reading simply stops until the reply was given.
+        if (state_ == http_state::server_reply)
+        {
+            if (std::size(pending_data_) + std::size(remaining) >
+                detail::max_request_header_size + detail::max_request_content_length)
+                pause_reading();
 
-            if (request_.get_content_length() >= expected_content_length_)
-                __enter_reply_state();
+            pending_data_.insert(std::end(pending_data_), std::begin(remaining), std::end(remaining));
+            return;
         }
-        else
+
+        const auto result = parser_.parse(remaining);
+
+        if (result == request_parser_result::incomplete)
+            return;
+
+        if (result == request_parser_result::error)
         {
-            const auto result = __on_line(reader.read_line());
-            if (result != status_code::ok)
-            {
-                respond_default(result);
-                disconnect();
-                return;
-            }
+            __fail(parser_.get_error());
+            return;
         }
+
+        remaining = remaining.subspan(parser_.consumed());
+
+        // The parser is only reset once all content was received.
+        if (result == request_parser_result::headers_complete)
+        {
+            receiving_content_ = true;
+            __dispatch_request();
+            continue;
+        }
+
+        __dispatch_request();
+
+        // The request only refers to the parser's data during on_http_request.
+        parser_.reset();
     }
 }
 
-auto http_server_socket::__on_line(const common::string &line) -> status_code
+auto http_server_socket::__process_content(const std::span<const std::byte> data) -> std::size_t
 {
-    switch (state_)
+    const auto result = parser_.parse(data);
+
+    if (result == request_parser_result::incomplete)
+        return std::size(data);
+
+    if (result == request_parser_result::error)
+    {
+        receiving_content_ = false;
+
+        // If a reply was already given (or is being given), there is no way to report the error to the client.
+        if (state_ == http_state::server_reply && !chunk_producer_)
+        {
+            __fail(parser_.get_error());
+        }
+        else
+        {
+            state_ = http_state::server_closing;
+            pending_data_.clear();
+            keep_alive_timer_.cancel();
+            disconnect_after_send();
+        }
+
+        return std::size(data);
+    }
+
+    const auto last = (result == request_parser_result::complete);
+    const auto consumed = parser_.consumed();
+
+    if (last)
+        receiving_content_ = false;
+
+    on_http_request_content(parser_.get_content(), last);
+
+    if (last)
     {
-        case http_state::server_read_method:
-            return __handle_read_method_state(line);
-        case http_state::server_read_headers:
-            return __handle_read_headers_state(line);
-
-        // Unexpected read body state. Body must be read binary.
-        // If this happens, there is a bug.
-        case http_state::server_read_body:
-            return status_code::internal_server_error;
-
-        // Did not expect to receive more data in reply state.
-        case http_state::server_reply:
-            return status_code::bad_request;
-        // If default happens, there is a bug.
-        default:
-            return status_code::internal_server_error;
+        parser_.reset();
+
+        // If the reply was already given, the connection is only idle from here on.
+        if (state_ == http_state::server_read_request)
+            __start_keep_alive_timer();
     }
+
+    return consumed;
 }
 
-void http_server_socket::respond_default(const status_code code)
+void http_server_socket::__resume()
 {
-    respond(detail::default_response_content_type, status_code_to_string(code), code);
+    const auto data = std::move(pending_data_);
+    pending_data_.clear();
+    __process(data);
 }
 
-auto http_server_socket::__parse_expected_content_length_and_type() -> status_code
+void http_server_socket::__dispatch_request()
 {
-    const auto http_headers = parse_raw_http_headers(request_.get_raw_headers());
+    keep_alive_timer_.cancel();
+    ++request_count_;
+
+    const auto headers = parser_.get_headers();
+
+    if (parser_.get_method() == http_method::post)
+    {
+        if (!find_http_header(headers, detail::content_length_key) && !parser_.is_chunked())
+        {
+            __fail(status_code::length_required);
+            return;
+        }
+
+        if (!find_http_header(headers, detail::content_type_key))
+        {
+            __fail(status_code::bad_request);
+            return;
+        }
+    }
 
-    const auto content_length_result = http_headers.find(detail::content_length_key);
+    const auto connection = find_http_header(headers, detail::connection_key);
+    close_after_reply_ = (max_keep_alive_requests_ != 0 && request_count_ >= max_keep_alive_requests_) ||
+                         (connection && common::string_utils::iequals(*connection, "close"));
 
-    if (content_length_result == http_headers.end())
-        return status_code::length_required;
+    const auto accept_encoding = find_http_header(headers, detail::accept_encoding_key);
+    accepted_encoding_ = (compression_.enabled && accept_encoding) ? negotiate_content_encoding(*accept_encoding)
+                                                                    : content_encoding::identity;
 
-    const auto content_type_result = http_headers.find(detail::content_type_key);
+    request_ = request{parser_.get_method(), url_decode(common::string{parser_.get_target()})};
+    request_.set_headers(headers);
+    request_.set_content(parser_.get_content());
 
-    if (content_type_result == http_headers.end())
-        return status_code::bad_request;
+    state_ = http_state::server_reply;
 
-    expected_content_length_ = std::stoll(content_length_result->second.str());
-    request_.set_content_type(content_type_result->second);
-    return status_code::ok;
+    dispatching_ = true;
+    on_http_request(request_);
+    dispatching_ = false;
 }
 
-auto http_server_socket::__enter_parse_body_state() -> status_code
+void http_server_socket::__fail(const status_code code)
 {
-    const auto result = __parse_expected_content_length_and_type();
+    state_ = http_state::server_reply;
+    close_after_reply_ = true;
+    respond_default(code);
+}
 
-    // If there was a parse error for the content length
-    if (result != status_code::ok)
-        return result;
+auto http_server_socket::__format_reply_header(const status_code code, const common::string &headers,
+                                               const std::optional<std::uint64_t> content_length) const
+    -> std::vector<std::byte>
+{
+    streams::string_stream<std::vector<std::byte>> sstream{64 + std::size(headers)};
+    sstream << detail::http_version_string;
+    sstream << ' ';
+    sstream << std::to_string(static_cast<int>(code));
+    sstream << ' ';
+    sstream << status_code_to_string(code);
+    sstream << "\r\n";
+    sstream << (close_after_reply_ ? "Connection: close\r\n" : "Connection: keep-alive\r\n");
+    sstream << headers;
 
-    // If content length is simply 0.
-    if (expected_content_length_ == 0)
+    if (content_length)
     {
-        __enter_reply_state();
-        return status_code::ok;
+        sstream << "Content-Length: ";
+        sstream << std::to_string(*content_length);
+        sstream << "\r\n\r\n";
+    }
+    else
+    {
+        sstream << "Transfer-Encoding: chunked\r\n\r\n";
     }
 
-    state_ = http_state::server_read_body;
-    return status_code::ok;
+    return sstream.release();
 }
 
-void http_server_socket::__enter_reply_state()
+void http_server_socket::__send_reply(const status_code code, const common::string &headers,
+                                      std::vector<std::byte> data)
 {
-    state_ = http_state::server_reply;
-    on_http_request(request_);
+    auto reply = __format_reply_header(code, headers, std::size(data));
+
+    // Small replies are sent as a single buffer, so that the headers and content end up in the same packet.
+    if (std::size(data) <= detail::max_single_buffer_reply_size)
+    {
+        reply.insert(std::end(reply), std::begin(data), std::end(data));
+        send(std::move(reply));
+    }
+    else
+    {
+        send(std::move(reply));
+        send(std::move(data));
+    }
+}
+
+void http_server_socket::__send_compressed_reply(const status_code code, common::string headers,
+                                                 std::vector<std::byte> data)
+{
+    // The reply is finished once the content is compressed; any pipelined requests are held back until then, just
+    // like with any other reply that is given asynchronously.
+    asio::post(detail::get_compression_pool(),
+               [self = std::static_pointer_cast<http_server_socket>(shared_from_this()), code,
+                headers = std::move(headers), data = std::move(data), encoding = accepted_encoding_,
+                mode = compression_.mode]() mutable
+               {
+                   auto compressed = compress_content(data, encoding, mode);
+
+                   // Content that does not compress well (or failed to compress) is sent as is.
+                   if (!std::empty(compressed) && std::size(compressed) < std::size(data))
+                   {
+                       headers += "Content-Encoding: ";
+                       headers += content_encoding_to_string(encoding);
+                       headers += "\r\n";
+                       data = std::move(compressed);
+                   }
+
+                   auto &context = self->get_io_context();
+                   asio::post(context,
+                              [self = std::move(self), code, headers = std::move(headers),
+                               data = std::move(data)]() mutable
+                              {
+                                  if (self->state_ == http_state::server_closing)
+                                      return;
+
+                                  self->__send_reply(code, headers, std::move(data));
+                                  self->__finish_reply();
+                              });
+               });
 }
 
-auto http_server_socket::__handle_read_method_state(const common::string &line) -> status_code
+void http_server_socket::__finish_reply()
 {
-    auto method_line_split = common::string_utils::split(line, ' ');
+    if (close_after_reply_)
+    {
+        state_ = http_state::server_closing;
+        pending_data_.clear();
+        keep_alive_timer_.cancel();
+        disconnect_after_send();
+        return;
+    }
 
-    if (method_line_split.size() != 3)
-        return status_code::bad_request;
+    __reset_state();
 
-    const auto method = method_line_split[0];
-    const auto request_uri = method_line_split[1];
-    const auto version_string = method_line_split[2];
+    // While the content of the request is still coming in, the connection is not idle. The timer is started once all
+    // content was received instead.
+    if (receiving_content_)
+        keep_alive_timer_.cancel();
+    else
+        __start_keep_alive_timer();
 
-    if (!detail::validate_http_version_string(common::string{version_string.as_std_u8string_view()}))
-        return status_code::http_version_not_supported;
+    resume_reading();
 
-    if (!detail::validate_uri(common::string{request_uri.as_std_u8string_view()}))
-        return status_code::bad_request;
+    // If the reply was given asynchronously, continue with any requests that were pipelined in the mean time.
+    if (!dispatching_ && !receiving_content_ && !std::empty(pending_data_))
+        __resume();
+}
 
-    const request request(method, url_decode(request_uri));
+void http_server_socket::__produce_chunk()
+{
+    std::vector<std::byte> chunk;
+    const auto result = chunk_producer_(chunk);
+    const auto has_data = !std::empty(chunk);
 
-    if (request.get_method() == http_method::invalid)
-        return status_code::method_not_allowed;
+    if (has_data)
+    {
+        std::array<char, 24> size_line{};
+        const auto length = std::snprintf(std::data(size_line), std::size(size_line), "%zx\r\n", std::size(chunk));
+        const auto size_bytes = reinterpret_cast<const std::byte *>(std::data(size_line));
+
+        // The size line is sent as a separate buffer, so that the chunk itself is never copied.
+        send(std::vector<std::byte>{size_bytes, size_bytes + length});
+        chunk.push_back(std::byte{'\r'});
+        chunk.push_back(std::byte{'\n'});
+        send(std::move(chunk));
+    }
 
-    request_ = request;
-    state_ = http_state::server_read_headers;
+    if (result == chunk_result::done)
+    {
+        static constexpr std::string_view last_chunk = "0\r\n\r\n";
+        const auto last_chunk_bytes = reinterpret_cast<const std::byte *>(std::data(last_chunk));
+        send(std::vector<std::byte>{last_chunk_bytes, last_chunk_bytes + std::size(last_chunk)});
+
+        chunk_producer_ = nullptr;
+        chunk_pending_ = false;
+        __finish_reply();
+        return;
+    }
 
-    return status_code::ok;
+    // An empty chunk would end the response, so it is treated as if no data is available yet.
+    if (result == chunk_result::pending || !has_data)
+        chunk_pending_ = true;
 }
 
-auto http_server_socket::__handle_read_headers_state(const common::string &line) -> status_code
+void http_server_socket::__start_keep_alive_timer()
 {
-    if (line.empty())
+    if (keep_alive_timeout_ == std::chrono::steady_clock::duration::zero())
     {
-        if (request_.get_method() == http_method::post)
-            return __enter_parse_body_state();
+        keep_alive_timer_.cancel();
+        return;
+    }
+
+    keep_alive_timer_.expires_after(keep_alive_timeout_);
+    keep_alive_timer_.async_wait(
+        [self = weak_from_this()](const std::error_code ec)
+        {
+            if (ec)
+                return;
+
+            if (const auto socket = std::static_pointer_cast<http_server_socket>(self.lock()))
+                socket->__on_keep_alive_timeout();
+        });
+}
+
+void http_server_socket::__on_keep_alive_timeout()
+{
+    if (state_ != http_state::server_read_request || receiving_content_)
+        return;
 
-        __enter_reply_state();
-        return status_code::ok;
+    // An idle connection is simply closed. A client that did not finish sending its request in time gets a reply.
+    if (parser_.is_idle())
+    {
+        state_ = http_state::server_closing;
+        disconnect();
+        return;
     }
 
-    request_.append_raw_http_header_line(line);
-    return status_code::ok;
+    __fail(status_code::request_timeout);
 }
 
 void http_server_socket::__reset_state()
 {
-    state_ = http_state::server_read_method;
+    state_ = http_state::server_read_request;
     request_ = request{http_method::invalid};
-    expected_content_length_ = 0;
 }
+
 } // namespace aeon::web::http
@@ -0,0 +1,159 @@
+// Distributed under the BSD 2-Clause License - Copyright 2012-2023 Robin Degen
+
+#pragma once
+
+#if (!defined(AEON_DISABLE_SSE))
+#include <emmintrin.h>
+#endif
+
+#include <algorithm>
+#include <string_view>
+#include <array>
+#include <bit>
+#include <cstddef>
+
+namespace aeon::web::http::detail
+{
+
+enum class line_end_result
+{
+    found,
+    incomplete,
+    invalid
+};
+
+[[nodiscard]] constexpr auto make_token_table() noexcept
+{
+    std::array<bool, 256> table{};
+
+    for (auto c = '0'; c <= '9'; ++c)
+        table[static_cast<unsigned char>(c)] = true;
+
+    for (auto c = 'a'; c <= 'z'; ++c)
+        table[static_cast<unsigned char>(c)] = true;
+
+    for (auto c = 'A'; c <= 'Z'; ++c)
+        table[static_cast<unsigned char>(c)] = true;
+
+    for (const auto c : std::string_view{"!#$%&'*+-.^_`|~"})
+        table[static_cast<unsigned char>(c)] = true;
+
+    return table;
+}
+
+// Characters that are allowed in a token (methods and header names); see RFC 7230 section 3.2.6.
+inline constexpr auto token_table = make_token_table();
+
+[[nodiscard]] inline auto is_token(const std::string_view str) noexcept -> bool
+{
+    return !std::empty(str) &&
+           std::all_of(std::begin(str), std::end(str),
+                       [](const char c) { return token_table[static_cast<unsigned char>(c)]; });
+}
+
+[[nodiscard]] inline auto is_control_character(const char c) noexcept -> bool
+{
+    const auto value = static_cast<unsigned char>(c);
+    return value < 0x20 || value == 0x7F;
+}
+
+[[nodiscard]] inline auto is_whitespace(const char c) noexcept -> bool
+{
+    return c == ' ' || c == '\t';
+}
+
+/*!
+ * Find the offset of the first control character (including CR, LF and tab) from the given offset, or the size of the
+ * string if there is none. This both finds the end of a line and validates it. With SSE enabled, 16 characters are
+ * checked at once.
+ */
+[[nodiscard]] inline auto find_control_character(const std::string_view str, std::size_t offset) noexcept
+    -> std::size_t
+{
+    const auto size = std::size(str);
+
+#if (!defined(AEON_DISABLE_SSE))
+    const auto control_max = _mm_set1_epi8(0x1F);
+    const auto del = _mm_set1_epi8(0x7F);
+
+    for (; offset + 16 <= size; offset += 16)
+    {
+        const auto chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(std::data(str) + offset));
+
+        // Unsigned chunk <= 0x1F
+        const auto control = _mm_cmpeq_epi8(_mm_min_epu8(chunk, control_max), chunk);
+        const auto special = _mm_or_si128(control, _mm_cmpeq_epi8(chunk, del));
+        const auto mask = static_cast<unsigned int>(_mm_movemask_epi8(special));
+
+        if (mask != 0)
+            return offset + static_cast<std::size_t>(std::countr_zero(mask));
+    }
+#endif
+
+    for (; offset < size; ++offset)
+    {
+        if (is_control_character(str[offset]))
+            return offset;
+    }
+
+    return size;
+}
+
+/*!
+ * Find the end of the line that contains the given scan offset. The scan offset is updated, so that scanning can
+ * resume there when more data is received. Tabs are only allowed within the line if allow_tab is set; any other control
+ * character makes the line invalid.
+ */
+[[nodiscard]] inline auto find_line_end(const std::string_view text, std::size_t &scan_offset, const bool allow_tab,
+                                        std::size_t &line_end, std::size_t &next_line) noexcept -> line_end_result
+{
+    while (true)
+    {
+        scan_offset = find_control_character(text, scan_offset);
+
+        if (scan_offset == std::size(text))
+            return line_end_result::incomplete;
+
+        const auto c = text[scan_offset];
+
+        if (c == '\t' && allow_tab)
+        {
+            ++scan_offset;
+            continue;
+        }
+
+        // A bare LF is accepted as line terminator as well; see RFC 7230 section 3.5.
+        if (c == '\n')
+        {
+            line_end = scan_offset;
+            next_line = scan_offset + 1;
+            return line_end_result::found;
+        }
+
+        if (c != '\r')
+            return line_end_result::invalid;
+
+        if (scan_offset + 1 == std::size(text))
+            return line_end_result::incomplete;
+
+        if (text[scan_offset + 1] != '\n')
+            return line_end_result::invalid;
+
+        line_end = scan_offset;
+        next_line = scan_offset + 2;
+        return line_end_result::found;
+    }
+}
+
+[[nodiscard]] inline auto trim_whitespace(std::string_view str) noexcept -> std::string_view
+{
+    while (!std::empty(str) && is_whitespace(str.front()))
+        str.remove_prefix(1);
+
+    while (!std::empty(str) && is_whitespace(str.back()))
+        str.remove_suffix(1);
+
+    return str;
+}
+
+} // namespace aeon::web::http::detail
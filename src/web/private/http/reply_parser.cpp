@@ -0,0 +1,508 @@
+// Distributed under the BSD 2-Clause License - Copyright 2012-2023 Robin Degen
+
+#include <aeon/web/http/reply_parser.h>
+#include <aeon/common/string_utils.h>
+#include "parser_utils.h"
+#include <charconv>
+
+namespace aeon::web::http
+{
+
+namespace internal
+{
+
+static constexpr std::string_view http_1_0_version_string = "HTTP/1.0";
+static constexpr std::string_view http_1_1_version_string = "HTTP/1.1";
+
+/*!
+ * Call the given function for every element of a comma separated header value (ie. "keep-alive, Upgrade").
+ */
+template <typename function_t>
+static void for_each_list_element(std::string_view value, function_t &&function)
+{
+    while (!std::empty(value))
+    {
+        const auto end = value.find(',');
+        const auto element = detail::trim_whitespace(value.substr(0, end));
+
+        if (!std::empty(element))
+            function(element);
+
+        if (end == std::string_view::npos)
+            break;
+
+        value.remove_prefix(end + 1);
+    }
+}
+
+} // namespace internal
+
+reply_parser::reply_parser(const std::size_t max_header_size, const std::size_t max_content_length)
+    : max_header_size_{max_header_size}
+    , max_content_length_{max_content_length}
+    , head_request_{false}
+    , state_{parser_state::status_line}
+    , buffer_{}
+    , consumed_{0}
+    , scan_offset_{0}
+    , line_start_{0}
+    , content_offset_{0}
+    , content_length_{}
+    , http_1_0_{false}
+    , connection_close_{false}
+    , connection_keep_alive_{false}
+    , chunked_{false}
+    , until_close_{false}
+    , chunked_decoder_{}
+    , content_buffer_{}
+    , status_code_{status_code::ok}
+    , reason_span_{}
+    , header_spans_{}
+    , header_count_{0}
+    , base_{nullptr}
+    , headers_{}
+    , content_{}
+{
+}
+
+auto reply_parser::parse(const std::span<const std::byte> data) -> reply_parser_result
+{
+    consumed_ = 0;
+
+    if (state_ == parser_state::error)
+        return reply_parser_result::error;
+
+    if (state_ == parser_state::complete)
+        return reply_parser_result::complete;
+
+    // The headers were already parsed in a previous call; only content remains.
+    if (state_ == parser_state::content && is_decoding_content())
+        return parse_content(data);
+
+    const auto previous_size = std::size(buffer_);
+
+    // Fast path: nothing was buffered yet, so parse the given data in place.
+    if (previous_size != 0)
+        buffer_.insert(std::end(buffer_), std::begin(data), std::end(data));
+
+    const auto text = (previous_size == 0)
+                          ? std::string_view{reinterpret_cast<const char *>(std::data(data)), std::size(data)}
+                          : std::string_view{reinterpret_cast<const char *>(std::data(buffer_)), std::size(buffer_)};
+
+    const auto result = parse_window(text);
+
+    if (result == reply_parser_result::error)
+        return result;
+
+    if (state_ == parser_state::content && is_decoding_content())
+    {
+        const auto header_size = content_offset_ - previous_size;
+
+        // Only the headers are kept in the buffer; the content is decoded into its own buffer.
+        if (previous_size == 0)
+            buffer_.assign(std::begin(data), std::begin(data) + static_cast<std::ptrdiff_t>(header_size));
+        else
+            buffer_.resize(content_offset_);
+
+        finalize_headers(std::string_view{reinterpret_cast<const char *>(std::data(buffer_)), std::size(buffer_)});
+
+        const auto content_result = parse_content(data.subspan(header_size));
+        consumed_ += header_size;
+        return content_result;
+    }
+
+    if (result == reply_parser_result::incomplete)
+    {
+        // Once the headers are parsed, the size of the reply is known. Reserve it at once, so that the content does
+        // not get copied around while it is being received in parts.
+        if (state_ == parser_state::content)
+            buffer_.reserve(content_offset_ + content_length_.value_or(0));
+
+        if (previous_size == 0)
+            buffer_.insert(std::end(buffer_), std::begin(data), std::end(data));
+    }
+    else
+    {
+        consumed_ = content_offset_ + content_length_.value_or(0) - previous_size;
+    }
+
+    return result;
+}
+
+auto reply_parser::finish() -> reply_parser_result
+{
+    if (state_ == parser_state::complete)
+        return reply_parser_result::complete;
+
+    if (state_ == parser_state::content && until_close_)
+    {
+        state_ = parser_state::complete;
+        content_ = content_buffer_;
+        return reply_parser_result::complete;
+    }
+
+    if (is_idle())
+        return reply_parser_result::incomplete;
+
+    return fail();
+}
+
+void reply_parser::reset() noexcept
+{
+    head_request_ = false;
+    state_ = parser_state::status_line;
+    buffer_.clear();
+    consumed_ = 0;
+    scan_offset_ = 0;
+    line_start_ = 0;
+    content_offset_ = 0;
+    content_length_.reset();
+    http_1_0_ = false;
+    connection_close_ = false;
+    connection_keep_alive_ = false;
+    chunked_ = false;
+    until_close_ = false;
+    content_buffer_.clear();
+    status_code_ = status_code::ok;
+    reason_span_ = {};
+    header_count_ = 0;
+    base_ = nullptr;
+    content_ = {};
+}
+
+void reply_parser::set_head_request(const bool head_request) noexcept
+{
+    head_request_ = head_request;
+}
+
+auto reply_parser::is_idle() const noexcept -> bool
+{
+    return state_ == parser_state::status_line && std::empty(buffer_);
+}
+
+auto reply_parser::consumed() const noexcept -> std::size_t
+{
+    return consumed_;
+}
+
+auto reply_parser::is_keep_alive() const noexcept -> bool
+{
+    if (until_close_ || connection_close_)
+        return false;
+
+    // HTTP/1.0 connections are only kept open when explicitly asked for; see RFC 7230 section 6.3.
+    return !http_1_0_ || connection_keep_alive_;
+}
+
+auto reply_parser::get_status_code() const noexcept -> status_code
+{
+    return status_code_;
+}
+
+auto reply_parser::get_reason() const noexcept -> common::string_view
+{
+    return to_string_view(reason_span_);
+}
+
+auto reply_parser::get_headers() const noexcept -> std::span<const http_header>
+{
+    if (!base_)
+        return {};
+
+    return std::span{std::data(headers_), header_count_};
+}
+
+auto reply_parser::get_content() const noexcept -> std::span<const std::byte>
+{
+    return content_;
+}
+
+auto reply_parser::parse_window(const std::string_view text) -> reply_parser_result
+{
+    // Never scan beyond the maximum header size, even if more data is available.
+    const auto header_text = text.substr(0, max_header_size_);
+
+    while (state_ == parser_state::status_line || state_ == parser_state::headers)
+    {
+        std::size_t line_end = 0;
+        std::size_t next_line = 0;
+
+        const auto result = detail::find_line_end(header_text, scan_offset_, state_ == parser_state::headers,
+                                                  line_end, next_line);
+
+        if (result == detail::line_end_result::invalid)
+            return fail();
+
+        if (result == detail::line_end_result::incomplete)
+        {
+            if (std::size(text) >= max_header_size_)
+                return fail();
+
+            return reply_parser_result::incomplete;
+        }
+
+        const auto line = text.substr(line_start_, line_end - line_start_);
+        line_start_ = next_line;
+        scan_offset_ = next_line;
+
+        if (state_ == parser_state::status_line)
+        {
+            if (parse_status_line(text, line) == reply_parser_result::error)
+                return reply_parser_result::error;
+
+            state_ = parser_state::headers;
+        }
+        else if (std::empty(line))
+        {
+            if (is_interim())
+                discard_interim();
+            else
+                begin_content(next_line);
+        }
+        else
+        {
+            if (parse_header_line(text, line) == reply_parser_result::error)
+                return reply_parser_result::error;
+        }
+    }
+
+    // Handled by parse()
+    if (is_decoding_content())
+        return reply_parser_result::incomplete;
+
+    if (std::size(text) - content_offset_ < content_length_.value_or(0))
+        return reply_parser_result::incomplete;
+
+    finalize(text);
+    return reply_parser_result::complete;
+}
+
+auto reply_parser::parse_content(const std::span<const std::byte> data) -> reply_parser_result
+{
+    if (until_close_)
+    {
+        if (std::size(data) > max_content_length_ - std::size(content_buffer_))
+            return fail();
+
+        content_buffer_.insert(std::end(content_buffer_), std::begin(data), std::end(data));
+        consumed_ = std::size(data);
+        return reply_parser_result::incomplete;
+    }
+
+    std::size_t offset = 0;
+
+    while (true)
+    {
+        std::size_t used = 0;
+        std::span<const std::byte> piece;
+        const auto result = chunked_decoder_.decode(data.subspan(offset), used, piece);
+        offset += used;
+
+        if (result == detail::chunked_decoder_result::error)
+            return fail();
+
+        content_buffer_.insert(std::end(content_buffer_), std::begin(piece), std::end(piece));
+        consumed_ = offset;
+
+        if (result == detail::chunked_decoder_result::complete)
+        {
+            state_ = parser_state::complete;
+            content_ = content_buffer_;
+            return reply_parser_result::complete;
+        }
+
+        if (result == detail::chunked_decoder_result::incomplete)
+            return reply_parser_result::incomplete;
+    }
+}
+
+auto reply_parser::is_decoding_content() const noexcept -> bool
+{
+    return chunked_ || until_close_;
+}
+
+auto reply_parser::parse_status_line(const std::string_view text, const std::string_view line)
+    -> reply_parser_result
+{
+    // The status line looks like this: "HTTP/1.1 200 OK". The reason phrase may be empty.
+    static constexpr std::size_t code_offset = 9;
+    static constexpr std::size_t code_size = 3;
+
+    if (std::size(line) < code_offset + code_size || line[code_offset - 1] != ' ')
+        return fail();
+
+    const auto version = line.substr(0, code_offset - 1);
+
+    if (version == internal::http_1_0_version_string)
+        http_1_0_ = true;
+    else if (version != internal::http_1_1_version_string)
+        return fail();
+
+    const auto code_str = line.substr(code_offset, code_size);
+
+    unsigned int code = 0;
+    const auto [end, ec] = std::from_chars(std::data(code_str), std::data(code_str) + std::size(code_str), code);
+
+    if (ec != std::errc{} || end != std::data(code_str) + std::size(code_str) || code < 100 || code > 599)
+        return fail();
+
+    // The client never asks to switch protocols.
+    if (code == 101)
+        return fail();
+
+    status_code_ = static_cast<status_code>(code);
+
+    if (std::size(line) > code_offset + code_size)
+    {
+        if (line[code_offset + code_size] != ' ')
+            return fail();
+
+        const auto reason = line.substr(code_offset + code_size + 1);
+        reason_span_ = {static_cast<std::uint32_t>(std::data(reason) - std::data(text)),
+                        static_cast<std::uint32_t>(std::size(reason))};
+    }
+
+    return reply_parser_result::complete;
+}
+
+auto reply_parser::parse_header_line(const std::string_view text, const std::string_view line)
+    -> reply_parser_result
+{
+    // Obsolete line folding is not supported; see RFC 7230 section 3.2.4.
+    if (detail::is_whitespace(line.front()))
+        return fail();
+
+    const auto colon = line.find(':');
+
+    if (colon == std::string_view::npos)
+        return fail();
+
+    const auto name = line.substr(0, colon);
+    const auto value = detail::trim_whitespace(line.substr(colon + 1));
+
+    if (!detail::is_token(name) || header_count_ == std::size(header_spans_))
+        return fail();
+
+    if (common::string_utils::iequals(name, detail::content_length_key))
+    {
+        std::size_t length = 0;
+        const auto [end, ec] = std::from_chars(std::data(value), std::data(value) + std::size(value), length);
+
+        if (std::empty(value) || ec != std::errc{} || end != std::data(value) + std::size(value))
+            return fail();
+
+        if ((content_length_ && *content_length_ != length) || length > max_content_length_)
+            return fail();
+
+        content_length_ = length;
+    }
+    else if (common::string_utils::iequals(name, detail::transfer_encoding_key))
+    {
+        // Only chunked is supported; the client never asks for any other transfer coding.
+        if (chunked_ || !common::string_utils::iequals(value, "chunked"))
+            return fail();
+
+        chunked_ = true;
+    }
+    else if (common::string_utils::iequals(name, detail::connection_key))
+    {
+        internal::for_each_list_element(value,
+                                        [this](const std::string_view option)
+                                        {
+                                            if (common::string_utils::iequals(option, "close"))
+                                                connection_close_ = true;
+                                            else if (common::string_utils::iequals(option, "keep-alive"))
+                                                connection_keep_alive_ = true;
+                                        });
+    }
+
+    header_spans_[header_count_++] = {
+        {static_cast<std::uint32_t>(std::data(name) - std::data(text)), static_cast<std::uint32_t>(std::size(name))},
+        {static_cast<std::uint32_t>(std::data(value) - std::data(text)), static_cast<std::uint32_t>(std::size(value))}};
+
+    return reply_parser_result::complete;
+}
+
+auto reply_parser::is_interim() const noexcept -> bool
+{
+    return static_cast<int>(status_code_) < 200;
+}
+
+void reply_parser::discard_interim()
+{
+    // Interim replies have no content and only precede the final reply; see RFC 7231 section 6.2. They are left in
+    // front of the final reply, so all offsets stay relative to the start of the parsed data.
+    state_ = parser_state::status_line;
+    content_length_.reset();
+    http_1_0_ = false;
+    connection_close_ = false;
+    connection_keep_alive_ = false;
+    chunked_ = false;
+    status_code_ = status_code::ok;
+    reason_span_ = {};
+    header_count_ = 0;
+}
+
+void reply_parser::begin_content(const std::size_t content_offset)
+{
+    content_offset_ = content_offset;
+    state_ = parser_state::content;
+
+    const auto code = static_cast<int>(status_code_);
+
+    // These never have content, regardless of the headers; see RFC 7230 section 3.3.3.
+    if (head_request_ || code == 204 || code == 304)
+    {
+        content_length_ = 0;
+        chunked_ = false;
+        return;
+    }
+
+    if (chunked_)
+    {
+        // Chunked encoding overrides the length, but a server that sends both can't be trusted to keep the
+        // connection in a consistent state.
+        if (content_length_)
+        {
+            content_length_.reset();
+            connection_close_ = true;
+        }
+
+        chunked_decoder_.reset(max_header_size_, max_content_length_);
+        return;
+    }
+
+    if (!content_length_)
+        until_close_ = true;
+}
+
+auto reply_parser::fail() noexcept -> reply_parser_result
+{
+    state_ = parser_state::error;
+    return reply_parser_result::error;
+}
+
+auto reply_parser::to_string_view(const text_span &span) const noexcept -> common::string_view
+{
+    if (!base_)
+        return {};
+
+    return common::string_view{reinterpret_cast<const char *>(base_) + span.offset, span.size};
+}
+
+void reply_parser::finalize_headers(const std::string_view text) noexcept
+{
+    base_ = reinterpret_cast<const std::byte *>(std::data(text));
+
+    for (std::size_t i = 0; i < header_count_; ++i)
+        headers_[i] = http_header{to_string_view(header_spans_[i].name), to_string_view(header_spans_[i].value)};
+}
+
+void reply_parser::finalize(const std::string_view text) noexcept
+{
+    finalize_headers(text);
+    state_ = parser_state::complete;
+    content_ = std::span{base_ + content_offset_, content_length_.value_or(0)};
+}
+
+} // namespace aeon::web::http
@@ -1,7 +1,7 @@
 // Distributed under the BSD 2-Clause License - Copyright 2012-2023 Robin Degen
 
 #include <aeon/web/http/request.h>
-#include <aeon/streams/stream_reader.h>
+#include <aeon/web/http/constants.h>
 #include <aeon/common/string_utils.h>
 
 namespace aeon::web::http
@@ -10,59 +10,91 @@ namespace aeon::web::http
 request::request(const http_method method)
     : method_{method}
     , uri_{}
-    , raw_headers_{}
-    , content_type_{}
+    , headers_{}
     , content_{}
+    , path_parameters_{}
+{
+}
+
+request::request(const http_method method, common::string uri)
+    : method_{method}
+    , uri_{std::move(uri)}
+    , headers_{}
+    , content_{}
+    , path_parameters_{}
 {
 }
 
 request::request(const common::string &method, common::string uri)
     : method_{string_to_method(method)}
     , uri_{std::move(uri)}
-    , raw_headers_{}
-    , content_type_{}
+    , headers_{}
     , content_{}
+    , path_parameters_{}
 {
 }
 
 auto request::get_content() const -> std::vector<std::uint8_t>
 {
-    streams::stream_reader reader{content_};
-    std::vector<std::uint8_t> vec;
-    reader.read_to_vector(vec);
-    return vec;
+    const auto data = reinterpret_cast<const std::uint8_t *>(std::data(content_));
+    return std::vector<std::uint8_t>{data, data + std::size(content_)};
 }
 
 auto request::get_content_string() const -> common::string
 {
-    streams::stream_reader reader{content_};
-    const auto data = reader.read_to_string();
-    return data;
+    const auto data = reinterpret_cast<const char *>(std::data(content_));
+    return common::string{data, data + std::size(content_)};
 }
 
-auto request::get_content_type() const -> common::string
+auto request::get_content_view() const noexcept -> std::span<const std::byte>
 {
-    return content_type_;
+    return content_;
 }
 
-auto request::get_raw_headers() const -> const std::vector<common::string> &
+auto request::get_content_type() const noexcept -> common::string_view
 {
-    return raw_headers_;
+    return find_header(detail::content_type_key).value_or(common::string_view{});
+}
+
+auto request::get_headers() const noexcept -> std::span<const http_header>
+{
+    return headers_;
+}
+
+auto request::find_header(const common::string_view &name) const noexcept -> std::optional<common::string_view>
+{
+    return find_http_header(headers_, name);
+}
+
+auto request::get_path_parameters() const noexcept -> std::span<const path_parameter>
+{
+    return path_parameters_;
+}
+
+auto request::find_path_parameter(const common::string_view &name) const noexcept -> std::optional<common::string_view>
+{
+    for (const auto &parameter : path_parameters_)
+    {
+        if (parameter.name == name)
+            return parameter.value;
+    }
+
+    return std::nullopt;
 }
 
-void request::append_raw_http_header_line(const common::string &header_line)
+void request::set_path_parameters(const std::span<const path_parameter> parameters) noexcept
 {
-    raw_headers_.push_back(header_line);
+    path_parameters_ = parameters;
 }
 
-void request::append_raw_content_data(const std::vector<std::byte> &data) const
+void request::set_headers(const std::span<const http_header> headers) noexcept
 {
-    content_.write(std::data(data), std::size(data));
+    headers_ = headers;
 }
 
-void request::set_content_type(const common::string &content_type)
+void request::set_content(const std::span<const std::byte> content) noexcept
 {
-    content_type_ = content_type;
+    content_ = content;
 }
 
 auto parse_raw_http_headers(const std::vector<common::string> &raw_headers) -> std::map<common::string, common::string>
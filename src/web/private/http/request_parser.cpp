@@ -0,0 +1,511 @@
+// Distributed under the BSD 2-Clause License - Copyright 2012-2023 Robin Degen
+
+#include <aeon/web/http/request_parser.h>
+#include <aeon/web/http/validators.h>
+#include <aeon/common/string_utils.h>
+#include "parser_utils.h"
+#include <algorithm>
+#include <charconv>
+
+namespace aeon::web::http
+{
+
+auto find_http_header(const std::span<const http_header> headers, const common::string_view &name) noexcept
+    -> std::optional<common::string_view>
+{
+    for (const auto &header : headers)
+    {
+        if (common::string_utils::iequals(header.name, name))
+            return header.value;
+    }
+
+    return std::nullopt;
+}
+
+request_parser::request_parser(const std::size_t max_header_size, const std::size_t max_content_length)
+    : max_header_size_{max_header_size}
+    , max_content_length_{max_content_length}
+    , max_streamed_content_length_{detail::max_streamed_request_content_length}
+    , stream_content_{false}
+    , next_stream_content_{false}
+    , state_{parser_state::request_line}
+    , error_{status_code::ok}
+    , buffer_{}
+    , consumed_{0}
+    , scan_offset_{0}
+    , line_start_{0}
+    , content_offset_{0}
+    , content_length_{}
+    , chunked_{false}
+    , chunked_decoder_{}
+    , content_remaining_{0}
+    , content_buffer_{}
+    , method_{http_method::invalid}
+    , method_span_{}
+    , target_span_{}
+    , header_spans_{}
+    , header_count_{0}
+    , base_{nullptr}
+    , headers_{}
+    , content_{}
+{
+}
+
+auto request_parser::parse(const std::span<const std::byte> data) -> request_parser_result
+{
+    consumed_ = 0;
+
+    if (state_ == parser_state::error)
+        return request_parser_result::error;
+
+    if (state_ == parser_state::complete)
+        return request_parser_result::complete;
+
+    // The headers were already parsed in a previous call; only content remains.
+    if (state_ == parser_state::content && is_decoding_content())
+        return parse_content(data);
+
+    const auto previous_size = std::size(buffer_);
+
+    // Fast path: nothing was buffered yet, so parse the given data in place.
+    if (previous_size != 0)
+        buffer_.insert(std::end(buffer_), std::begin(data), std::end(data));
+
+    const auto text = (previous_size == 0)
+                          ? std::string_view{reinterpret_cast<const char *>(std::data(data)), std::size(data)}
+                          : std::string_view{reinterpret_cast<const char *>(std::data(buffer_)), std::size(buffer_)};
+
+    const auto result = parse_window(text);
+
+    if (result == request_parser_result::error)
+        return result;
+
+    if (state_ == parser_state::content && is_decoding_content())
+    {
+        const auto header_size = content_offset_ - previous_size;
+
+        // The content is decoded over multiple calls, so the headers are kept in the buffer until the request is
+        // complete. Only the headers though; the content is decoded into its own buffer or not buffered at all.
+        if (previous_size == 0)
+            buffer_.assign(std::begin(data), std::begin(data) + static_cast<std::ptrdiff_t>(header_size));
+        else
+            buffer_.resize(content_offset_);
+
+        finalize_headers(std::string_view{reinterpret_cast<const char *>(std::data(buffer_)), std::size(buffer_)});
+
+        if (stream_content_)
+        {
+            consumed_ = header_size;
+
+            if (!chunked_ && content_remaining_ == 0)
+            {
+                state_ = parser_state::complete;
+                return request_parser_result::complete;
+            }
+
+            return request_parser_result::headers_complete;
+        }
+
+        const auto content_result = parse_content(data.subspan(header_size));
+        consumed_ += header_size;
+        return content_result;
+    }
+
+    if (result == request_parser_result::incomplete)
+    {
+        reserve_content();
+
+        if (previous_size == 0)
+            buffer_.insert(std::end(buffer_), std::begin(data), std::end(data));
+    }
+    else
+    {
+        consumed_ = content_offset_ + content_length_.value_or(0) - previous_size;
+    }
+
+    return result;
+}
+
+void request_parser::reset() noexcept
+{
+    state_ = parser_state::request_line;
+    error_ = status_code::ok;
+    buffer_.clear();
+    consumed_ = 0;
+    scan_offset_ = 0;
+    line_start_ = 0;
+    content_offset_ = 0;
+    content_length_.reset();
+    stream_content_ = next_stream_content_;
+    chunked_ = false;
+    content_remaining_ = 0;
+    content_buffer_.clear();
+    method_ = http_method::invalid;
+    method_span_ = {};
+    target_span_ = {};
+    header_count_ = 0;
+    base_ = nullptr;
+    content_ = {};
+}
+
+void request_parser::set_stream_content(const bool stream) noexcept
+{
+    next_stream_content_ = stream;
+
+    if (is_idle())
+        stream_content_ = stream;
+}
+
+void request_parser::set_max_streamed_content_length(const std::size_t max_content_length) noexcept
+{
+    max_streamed_content_length_ = max_content_length;
+}
+
+auto request_parser::is_chunked() const noexcept -> bool
+{
+    return chunked_;
+}
+
+auto request_parser::is_idle() const noexcept -> bool
+{
+    return state_ == parser_state::request_line && std::empty(buffer_);
+}
+
+auto request_parser::consumed() const noexcept -> std::size_t
+{
+    return consumed_;
+}
+
+auto request_parser::get_error() const noexcept -> status_code
+{
+    return error_;
+}
+
+auto request_parser::get_method() const noexcept -> http_method
+{
+    return method_;
+}
+
+auto request_parser::get_method_string() const noexcept -> common::string_view
+{
+    return to_string_view(method_span_);
+}
+
+auto request_parser::get_target() const noexcept -> common::string_view
+{
+    return to_string_view(target_span_);
+}
+
+auto request_parser::get_headers() const noexcept -> std::span<const http_header>
+{
+    if (!base_)
+        return {};
+
+    return std::span{std::data(headers_), header_count_};
+}
+
+auto request_parser::get_content() const noexcept -> std::span<const std::byte>
+{
+    return content_;
+}
+
+auto request_parser::parse_window(const std::string_view text) -> request_parser_result
+{
+    while (state_ == parser_state::request_line || state_ == parser_state::headers)
+    {
+        std::size_t line_end = 0;
+        std::size_t next_line = 0;
+
+        if (const auto result = find_line_end(text, line_end, next_line); result != request_parser_result::complete)
+            return result;
+
+        const auto line = text.substr(line_start_, line_end - line_start_);
+        line_start_ = next_line;
+        scan_offset_ = next_line;
+
+        if (state_ == parser_state::request_line)
+        {
+            // Empty lines before the request line must be ignored; see RFC 7230 section 3.5.
+            if (std::empty(line))
+                continue;
+
+            if (parse_request_line(text, line) == request_parser_result::error)
+                return request_parser_result::error;
+
+            state_ = parser_state::headers;
+        }
+        else if (std::empty(line))
+        {
+            // A request with both could be an attempt at request smuggling; see RFC 7230 section 3.3.3.
+            if (chunked_ && content_length_)
+                return fail(status_code::bad_request);
+
+            content_offset_ = next_line;
+            content_remaining_ = content_length_.value_or(0);
+            state_ = parser_state::content;
+
+            if (chunked_)
+                chunked_decoder_.reset(max_header_size_, get_max_content_length());
+        }
+        else
+        {
+            if (parse_header_line(text, line) == request_parser_result::error)
+                return request_parser_result::error;
+        }
+    }
+
+    // Handled by parse()
+    if (is_decoding_content())
+        return request_parser_result::incomplete;
+
+    if (std::size(text) - content_offset_ < content_length_.value_or(0))
+        return request_parser_result::incomplete;
+
+    finalize(text);
+    return request_parser_result::complete;
+}
+
+auto request_parser::parse_content(const std::span<const std::byte> data) -> request_parser_result
+{
+    std::size_t offset = 0;
+
+    while (true)
+    {
+        std::size_t used = 0;
+        std::span<const std::byte> piece;
+        const auto result = decode_content(data.subspan(offset), used, piece);
+        offset += used;
+
+        if (result == detail::chunked_decoder_result::error)
+            return request_parser_result::error;
+
+        if (!stream_content_)
+            content_buffer_.insert(std::end(content_buffer_), std::begin(piece), std::end(piece));
+
+        consumed_ = offset;
+
+        if (result == detail::chunked_decoder_result::complete)
+        {
+            state_ = parser_state::complete;
+            content_ = stream_content_ ? piece : std::span<const std::byte>{content_buffer_};
+            return request_parser_result::complete;
+        }
+
+        if (result == detail::chunked_decoder_result::incomplete)
+        {
+            content_ = {};
+            return request_parser_result::incomplete;
+        }
+
+        if (stream_content_ && !std::empty(piece))
+        {
+            content_ = piece;
+            return request_parser_result::content;
+        }
+    }
+}
+
+auto request_parser::decode_content(const std::span<const std::byte> data, std::size_t &used,
+                                    std::span<const std::byte> &piece) -> detail::chunked_decoder_result
+{
+    if (chunked_)
+    {
+        const auto result = chunked_decoder_.decode(data, used, piece);
+
+        if (result == detail::chunked_decoder_result::error)
+        {
+            state_ = parser_state::error;
+            error_ = chunked_decoder_.get_error();
+        }
+
+        return result;
+    }
+
+    used = 0;
+    piece = {};
+
+    if (content_remaining_ == 0)
+        return detail::chunked_decoder_result::complete;
+
+    if (std::empty(data))
+        return detail::chunked_decoder_result::incomplete;
+
+    used = std::min(content_remaining_, std::size(data));
+    piece = data.first(used);
+    content_remaining_ -= used;
+
+    if (content_remaining_ != 0)
+        return detail::chunked_decoder_result::progress;
+
+    return detail::chunked_decoder_result::complete;
+}
+
+auto request_parser::is_decoding_content() const noexcept -> bool
+{
+    return chunked_ || stream_content_;
+}
+
+auto request_parser::get_max_content_length() const noexcept -> std::size_t
+{
+    return stream_content_ ? max_streamed_content_length_ : max_content_length_;
+}
+
+auto request_parser::find_line_end(const std::string_view text, std::size_t &line_end, std::size_t &next_line)
+    -> request_parser_result
+{
+    // Never scan beyond the maximum header size, even if more data is available.
+    const auto header_text = text.substr(0, max_header_size_);
+    const auto result = detail::find_line_end(header_text, scan_offset_, state_ == parser_state::headers, line_end,
+                                              next_line);
+
+    if (result == detail::line_end_result::found)
+        return request_parser_result::complete;
+
+    if (result == detail::line_end_result::invalid)
+        return fail(status_code::bad_request);
+
+    if (std::size(text) >= max_header_size_)
+    {
+        if (state_ == parser_state::request_line)
+            return fail(status_code::uri_too_long);
+
+        return fail(status_code::request_header_fields_too_large);
+    }
+
+    return request_parser_result::incomplete;
+}
+
+auto request_parser::parse_request_line(const std::string_view text, const std::string_view line)
+    -> request_parser_result
+{
+    // The request line looks like this: "GET /index.html HTTP/1.1"
+    const auto method_end = line.find(' ');
+
+    if (method_end == std::string_view::npos)
+        return fail(status_code::bad_request);
+
+    const auto target_end = line.find(' ', method_end + 1);
+
+    if (target_end == std::string_view::npos)
+        return fail(status_code::bad_request);
+
+    const auto method = line.substr(0, method_end);
+    const auto target = line.substr(method_end + 1, target_end - method_end - 1);
+    const auto version = line.substr(target_end + 1);
+
+    if (!detail::is_token(method) || version.find(' ') != std::string_view::npos)
+        return fail(status_code::bad_request);
+
+    if (!detail::validate_http_version_string(version))
+        return fail(status_code::http_version_not_supported);
+
+    if (std::empty(target) || !detail::validate_uri(target))
+        return fail(status_code::bad_request);
+
+    method_ = string_to_method(method);
+
+    if (method_ == http_method::invalid)
+        return fail(status_code::method_not_allowed);
+
+    method_span_ = {static_cast<std::uint32_t>(std::data(method) - std::data(text)),
+                    static_cast<std::uint32_t>(std::size(method))};
+    target_span_ = {static_cast<std::uint32_t>(std::data(target) - std::data(text)),
+                    static_cast<std::uint32_t>(std::size(target))};
+
+    return request_parser_result::complete;
+}
+
+auto request_parser::parse_header_line(const std::string_view text, const std::string_view line)
+    -> request_parser_result
+{
+    // Obsolete line folding is not supported; see RFC 7230 section 3.2.4.
+    if (detail::is_whitespace(line.front()))
+        return fail(status_code::bad_request);
+
+    const auto colon = line.find(':');
+
+    if (colon == std::string_view::npos)
+        return fail(status_code::bad_request);
+
+    // No whitespace is allowed between the name and the colon, which is covered by the token check.
+    const auto name = line.substr(0, colon);
+    const auto value = detail::trim_whitespace(line.substr(colon + 1));
+
+    if (!detail::is_token(name))
+        return fail(status_code::bad_request);
+
+    if (header_count_ == std::size(header_spans_))
+        return fail(status_code::request_header_fields_too_large);
+
+    if (common::string_utils::iequals(name, detail::content_length_key))
+    {
+        std::size_t length = 0;
+        const auto [end, ec] = std::from_chars(std::data(value), std::data(value) + std::size(value), length);
+
+        if (std::empty(value) || ec != std::errc{} || end != std::data(value) + std::size(value))
+            return fail(status_code::bad_request);
+
+        // Multiple content lengths are only allowed if they are all the same.
+        if (content_length_ && *content_length_ != length)
+            return fail(status_code::bad_request);
+
+        if (length > get_max_content_length())
+            return fail(status_code::payload_too_large);
+
+        content_length_ = length;
+    }
+    else if (common::string_utils::iequals(name, detail::transfer_encoding_key))
+    {
+        // Only chunked is supported; not any other transfer coding (ie. "gzip, chunked").
+        if (chunked_ || !common::string_utils::iequals(value, "chunked"))
+            return fail(status_code::not_implemented);
+
+        chunked_ = true;
+    }
+
+    header_spans_[header_count_++] = {
+        {static_cast<std::uint32_t>(std::data(name) - std::data(text)), static_cast<std::uint32_t>(std::size(name))},
+        {static_cast<std::uint32_t>(std::data(value) - std::data(text)), static_cast<std::uint32_t>(std::size(value))}};
+
+    return request_parser_result::complete;
+}
+
+void request_parser::reserve_content()
+{
+    // Once the headers are parsed, the size of the request is known. Reserve it at once, so that the content does not
+    // get copied around while it is being received in parts.
+    if (state_ == parser_state::content)
+        buffer_.reserve(content_offset_ + content_length_.value_or(0));
+}
+
+auto request_parser::fail(const status_code code) noexcept -> request_parser_result
+{
+    state_ = parser_state::error;
+    error_ = code;
+    return request_parser_result::error;
+}
+
+auto request_parser::to_string_view(const text_span &span) const noexcept -> common::string_view
+{
+    if (!base_)
+        return {};
+
+    return common::string_view{reinterpret_cast<const char *>(base_) + span.offset, span.size};
+}
+
+void request_parser::finalize_headers(const std::string_view text) noexcept
+{
+    base_ = reinterpret_cast<const std::byte *>(std::data(text));
+
+    for (std::size_t i = 0; i < header_count_; ++i)
+        headers_[i] = http_header{to_string_view(header_spans_[i].name), to_string_view(header_spans_[i].value)};
+}
+
+void request_parser::finalize(const std::string_view text) noexcept
+{
+    finalize_headers(text);
+    state_ = parser_state::complete;
+    content_ = std::span{base_ + content_offset_, content_length_.value_or(0)};
+}
+
+} // namespace aeon::web::http
@@ -1,63 +1,161 @@
 // Distributed under the BSD 2-Clause License - Copyright 2012-2023 Robin Degen
 
 #include <aeon/web/http/routable_http_server_session.h>
-#include <aeon/common/literals.h>
+#include <algorithm>
 
 namespace aeon::web::http
 {
 
+namespace internal
+{
+
+// Threads keep the tables of at most this many sessions. The table of a session that was destroyed is released once
+// it is pushed out, or when the thread exits.
+static constexpr std::size_t max_cached_route_tables = 8;
+
+static std::atomic<std::uint64_t> next_route_table_version{1};
+
+} // namespace internal
+
 routable_http_server_session::routable_http_server_session()
     : http_server_session{}
+    , mutex_{}
     , routes_{}
+    , table_{std::make_shared<const route_table>()}
+    , version_{internal::next_route_table_version.fetch_add(1, std::memory_order_relaxed)}
+{
+}
+
+routable_http_server_session::~routable_http_server_session()
 {
+    std::erase_if(get_thread_cache(), [this](const auto &cached) { return cached.session == this; });
 }
 
-routable_http_server_session::~routable_http_server_session() = default;
+auto routable_http_server_session::add_route(std::unique_ptr<route> route) -> bool
+{
+    return insert_route(std::nullopt, std::move(route));
+}
 
-void routable_http_server_session::add_route(std::unique_ptr<route> route)
+auto routable_http_server_session::add_route(const http_method method, std::unique_ptr<route> route) -> bool
 {
-    const auto mountpoint = route->mount_point();
-    routes_.insert({mountpoint, std::move(route)});
+    return insert_route(method, std::move(route));
 }
 
 void routable_http_server_session::remove_route(const common::string &mountpoint)
 {
-    routes_.erase(mountpoint);
+    const std::scoped_lock lock{mutex_};
+
+    const auto result = std::partition(std::begin(routes_), std::end(routes_), [&mountpoint](const auto &entry)
+                                       { return entry.value->mount_point() != mountpoint; });
+
+    if (result == std::end(routes_))
+        return;
+
+    routes_.erase(result, std::end(routes_));
+
+    // Removing routes can't cause conflicts.
+    publish_table(build_table(nullptr));
+}
+
+auto routable_http_server_session::find_route(const std::string_view path, const http_method method,
+                                              route_match &match) const -> bool
+{
+    const auto &table = get_cached_table();
+    const auto result = table->value.find(path, method, match);
+    match.routes = table;
+    return result;
 }
 
 auto routable_http_server_session::find_best_match_route(const common::string &path, common::string &route_path) const
-    -> route *
+    -> std::shared_ptr<route>
+{
+    route_match match;
+
+    if (!find_route(path.str(), http_method::invalid, match))
+        return nullptr;
+
+    route_path = common::string{match.remaining_path};
+    return std::shared_ptr<route>{std::move(match.routes), match.matched_route};
+}
+
+auto routable_http_server_session::insert_route(const std::optional<http_method> method,
+                                                std::unique_ptr<route> route) -> bool
 {
-    auto actual_path = path;
+    const std::scoped_lock lock{mutex_};
 
-    if (path[0] != '/')
-        actual_path = "/" + path;
+    route_entry entry{std::move(route), method};
+    auto table = build_table(&entry);
 
-    auto best_match_length = 0_size_t;
-    route *best_match_route = nullptr;
+    if (!table)
+        return false;
 
-    for (auto &[route, route_ptr] : routes_)
+    routes_.push_back(std::move(entry));
+    publish_table(std::move(table));
+    return true;
+}
+
+auto routable_http_server_session::build_table(const route_entry *additional_entry) const
+    -> std::shared_ptr<route_table>
+{
+    auto result = std::make_shared<route_table>();
+    result->routes.reserve(std::size(routes_) + 1);
+
+    for (const auto &entry : routes_)
     {
-        const auto route_path_length = route.size();
-
-        // Due to possible mountpoints being inside other mountpoints, the best match provider is the one that
-        // has the most in common with the path
-        if (route_path_length > best_match_length)
-        {
-            if (actual_path.compare(0, route_path_length, route) == 0)
-            {
-                best_match_length = route_path_length;
-                best_match_route = route_ptr.get();
-            }
-        }
+        [[maybe_unused]] const auto inserted =
+            result->value.insert(entry.value->mount_point().str(), entry.method, entry.value.get());
+        result->routes.push_back(entry.value);
     }
 
-    if (!best_match_route)
-        return nullptr;
+    if (additional_entry)
+    {
+        if (!result->value.insert(additional_entry->value->mount_point().str(), additional_entry->method,
+                                  additional_entry->value.get()))
+            return nullptr;
 
-    route_path = actual_path.substr(best_match_length);
+        result->routes.push_back(additional_entry->value);
+    }
+
+    return result;
+}
+
+void routable_http_server_session::publish_table(std::shared_ptr<const route_table> table)
+{
+    table_ = std::move(table);
+    version_.store(internal::next_route_table_version.fetch_add(1, std::memory_order_relaxed),
+                   std::memory_order_release);
+}
 
-    return best_match_route;
+auto routable_http_server_session::get_cached_table() const -> const std::shared_ptr<const route_table> &
+{
+    auto &cache = get_thread_cache();
+    const auto version = version_.load(std::memory_order_acquire);
+    auto result = std::ranges::find(cache, this, &cached_table::session);
+
+    if (result != std::end(cache) && result->version == version)
+        return result->table;
+
+    if (result == std::end(cache))
+    {
+        if (std::size(cache) == internal::max_cached_route_tables)
+            cache.erase(std::begin(cache));
+
+        result = cache.insert(std::end(cache), cached_table{this, 0, nullptr});
+    }
+
+    const std::scoped_lock lock{mutex_};
+
+    // Give this thread its own reference count by wrapping the shared table in a new control block.
+    auto owner = std::make_shared<const std::shared_ptr<const route_table>>(table_);
+    result->table = std::shared_ptr<const route_table>{owner, owner->get()};
+    result->version = version_.load(std::memory_order_relaxed);
+    return result->table;
+}
+
+auto routable_http_server_session::get_thread_cache() -> std::vector<cached_table> &
+{
+    thread_local std::vector<cached_table> cache;
+    return cache;
 }
 
 } // namespace aeon::web::http
@@ -17,21 +17,21 @@ routable_http_server_socket::~routable_http_server_socket() = default;
 
 void routable_http_server_socket::on_http_request(const request &request)
 {
-    common::string route_path;
-    const auto route = session_.find_best_match_route(request.get_uri(), route_path);
+    route_match match;
 
-    if (!route)
+    if (!session_.find_route(request.get_uri().str(), request.get_method(), match))
     {
-        respond_default(status_code::not_found);
+        respond_default(match.method_not_allowed ? status_code::method_not_allowed : status_code::not_found);
         return;
     }
 
     // Change the request so actually use the new route_path. This way, a route doesn't need to know
     // what the full path is it's mounted on.
     auto new_request = request;
-    new_request.set_uri(route_path);
+    new_request.set_uri(common::string{match.remaining_path});
+    new_request.set_path_parameters(match.get_parameters());
 
-    route->on_http_request(*this, session_, new_request);
+    match.matched_route->on_http_request(*this, session_, new_request);
 }
 
 } // namespace aeon::web::http
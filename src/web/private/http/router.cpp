@@ -0,0 +1,278 @@
+// Distributed under the BSD 2-Clause License - Copyright 2012-2023 Robin Degen
+
+#include <aeon/web/http/router.h>
+#include <aeon/web/http/route.h>
+#include <string>
+#include <vector>
+
+namespace aeon::web::http
+{
+
+namespace internal
+{
+
+static constexpr std::size_t method_count = static_cast<std::size_t>(http_method::patch) + 1;
+
+[[nodiscard]] static auto common_prefix_length(const std::string_view a, const std::string_view b) noexcept
+{
+    std::size_t length = 0;
+
+    while (length < std::size(a) && length < std::size(b) && a[length] == b[length])
+        ++length;
+
+    return length;
+}
+
+/*!
+ * Mount points are stored without a leading '/', so that paths with and without one are matched the same way.
+ */
+[[nodiscard]] static auto strip_leading_slash(std::string_view path) noexcept
+{
+    if (!std::empty(path) && path.front() == '/')
+        path.remove_prefix(1);
+
+    return path;
+}
+
+/*!
+ * The length of the static part at the start of a mount point; up to the first parameter segment.
+ */
+[[nodiscard]] static auto static_prefix_length(const std::string_view mount_point) noexcept
+{
+    for (std::size_t i = 0; i < std::size(mount_point); ++i)
+    {
+        if (mount_point[i] == ':' && (i == 0 || mount_point[i - 1] == '/'))
+            return i;
+    }
+
+    return std::size(mount_point);
+}
+
+} // namespace internal
+
+struct router::node
+{
+    // The static part of the mount point that this node represents, relative to its parent.
+    std::string prefix;
+
+    // Static children and the first character of their prefix, in the same order. Keeping the first characters in a
+    // separate string keeps the lookup of the next child within a single cache line for most nodes.
+    std::string indices;
+    std::vector<std::unique_ptr<node>> children;
+
+    // A child that matches a single path segment as a parameter.
+    std::unique_ptr<node> parameter_child;
+    std::string parameter_name;
+
+    std::array<route *, internal::method_count> method_routes{};
+    route *any_route = nullptr;
+
+    [[nodiscard]] auto has_routes() const noexcept -> bool
+    {
+        if (any_route)
+            return true;
+
+        for (const auto value : method_routes)
+        {
+            if (value)
+                return true;
+        }
+
+        return false;
+    }
+
+    [[nodiscard]] auto route_for(const std::size_t method) const noexcept -> route *
+    {
+        if (method < std::size(method_routes) && method_routes[method])
+            return method_routes[method];
+
+        return any_route;
+    }
+
+    [[nodiscard]] auto find_child(const char c) const noexcept -> node *
+    {
+        const auto index = indices.find(c);
+
+        if (index == std::string::npos)
+            return nullptr;
+
+        return children[index].get();
+    }
+
+    /*!
+     * Find the deepest node that matches the start of the path and has a route for the method. If a deeper node only
+     * has routes for other methods, a shorter mount point that does accept the method is used instead.
+     */
+    [[nodiscard]] auto search(const std::string_view path, const std::size_t method, route_match &match) const noexcept
+        -> route *
+    {
+        // Static children first, so that "/users/new" takes precedence over "/users/:id".
+        if (!std::empty(path))
+        {
+            if (const auto child = find_child(path.front()); child && path.starts_with(child->prefix))
+            {
+                if (const auto result = child->search(path.substr(std::size(child->prefix)), method, match))
+                    return result;
+            }
+        }
+
+        if (parameter_child && !std::empty(path) && path.front() != '/' &&
+            match.parameter_count < std::size(match.parameters))
+        {
+            const auto value = path.substr(0, path.find('/'));
+            match.parameters[match.parameter_count++] = path_parameter{parameter_name, value};
+
+            if (const auto result = parameter_child->search(path.substr(std::size(value)), method, match))
+                return result;
+
+            --match.parameter_count;
+        }
+
+        const auto result = route_for(method);
+
+        if (!result)
+        {
+            if (has_routes())
+                match.method_not_allowed = true;
+
+            return nullptr;
+        }
+
+        match.remaining_path = path;
+        return result;
+    }
+};
+
+router::router()
+    : root_{std::make_unique<node>()}
+{
+}
+
+router::~router() = default;
+
+router::router(router &&) noexcept = default;
+
+auto router::operator=(router &&) noexcept -> router & = default;
+
+auto router::insert(const std::string_view mount_point, const std::optional<http_method> method, route *value) -> bool
+{
+    auto current = root_.get();
+    auto remaining = internal::strip_leading_slash(mount_point);
+
+    while (!std::empty(remaining))
+    {
+        // Parameter segment
+        if (remaining.front() == ':')
+        {
+            const auto name = remaining.substr(1, remaining.find('/') - 1);
+
+            if (!current->parameter_child)
+            {
+                current->parameter_child = std::make_unique<node>();
+                current->parameter_name = name;
+            }
+            else if (current->parameter_name != name)
+            {
+                return false;
+            }
+
+            current = current->parameter_child.get();
+            remaining.remove_prefix(std::size(name) + 1);
+            continue;
+        }
+
+        const auto static_part = remaining.substr(0, internal::static_prefix_length(remaining));
+        const auto index = current->indices.find(static_part.front());
+
+        if (index == std::string::npos)
+        {
+            auto child = std::make_unique<node>();
+            child->prefix = static_part;
+
+            current->indices += static_part.front();
+            current->children.push_back(std::move(child));
+            current = current->children.back().get();
+            remaining.remove_prefix(std::size(static_part));
+            continue;
+        }
+
+        auto &child = current->children[index];
+        const auto length = internal::common_prefix_length(child->prefix, static_part);
+
+        // Split the child, so that the common part becomes a node of its own.
+        if (length < std::size(child->prefix))
+        {
+            auto split = std::make_unique<node>();
+            split->prefix = child->prefix.substr(0, length);
+
+            child->prefix.erase(0, length);
+            split->indices += child->prefix.front();
+            split->children.push_back(std::move(child));
+            child = std::move(split);
+        }
+
+        current = child.get();
+        remaining.remove_prefix(length);
+    }
+
+    auto &target = method ? current->method_routes[static_cast<std::size_t>(*method)] : current->any_route;
+
+    if (target)
+        return false;
+
+    target = value;
+    return true;
+}
+
+void router::erase(const std::string_view mount_point) noexcept
+{
+    // Nodes are not merged again; the tree only ever grows by the amount of distinct mount points.
+    if (const auto result = find_node(mount_point))
+    {
+        result->method_routes.fill(nullptr);
+        result->any_route = nullptr;
+    }
+}
+
+auto router::find(const std::string_view path, const http_method method, route_match &match) const noexcept -> bool
+{
+    match.matched_route = nullptr;
+    match.method_not_allowed = false;
+    match.parameter_count = 0;
+
+    match.matched_route = root_->search(internal::strip_leading_slash(path), static_cast<std::size_t>(method), match);
+
+    if (!match.matched_route)
+        return false;
+
+    match.method_not_allowed = false;
+    return true;
+}
+
+auto router::find_node(const std::string_view mount_point) const noexcept -> node *
+{
+    auto current = root_.get();
+    auto remaining = internal::strip_leading_slash(mount_point);
+
+    while (current && !std::empty(remaining))
+    {
+        if (remaining.front() == ':')
+        {
+            current = current->parameter_child.get();
+            remaining.remove_prefix(std::min(remaining.find('/'), std::size(remaining)));
+            continue;
+        }
+
+        const auto child = current->find_child(remaining.front());
+
+        if (!child || !remaining.starts_with(child->prefix))
+            return nullptr;
+
+        current = child;
+        remaining.remove_prefix(std::size(child->prefix));
+    }
+
+    return current;
+}
+
+} // namespace aeon::web::http
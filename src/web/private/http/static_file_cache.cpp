@@ -0,0 +1,353 @@
+// Distributed under the BSD 2-Clause License - Copyright 2012-2023 Robin Degen
+
+#include "static_file_cache.h"
+#include "compression_pool.h"
+#include <asio/post.hpp>
+#include <aeon/streams/devices/file_device.h>
+#include <aeon/streams/dynamic_stream.h>
+#include <aeon/streams/stream_reader.h>
+#include <array>
+#include <cstdio>
+
+namespace aeon::web::http::detail
+{
+
+namespace internal
+{
+
+// Every cache entry is accounted for with at least this size, so that metadata of large files is evicted as well.
+static constexpr std::size_t cache_entry_overhead = 512;
+
+static const auto precompressed_extension = ".gz";
+
+[[nodiscard]] static auto make_etag(const static_file_variant &variant) -> common::string
+{
+    // A strong validator based on the modification time and size, similar to what most web servers use.
+    const auto modified = variant.last_write_time.time_since_epoch().count();
+
+    std::array<char, 64> buffer{};
+    const auto length = std::snprintf(std::data(buffer), std::size(buffer), "\"%llx-%llx\"",
+                                      static_cast<unsigned long long>(modified),
+                                      static_cast<unsigned long long>(variant.size));
+    return common::string{std::data(buffer), std::data(buffer) + length};
+}
+
+/*!
+ * Each variant needs its own strong validator, since their contents differ.
+ */
+[[nodiscard]] static auto make_compressed_etag(const common::string &etag) -> common::string
+{
+    auto result = etag.str();
+    result.insert(std::size(result) - 1, "-gzip");
+    return common::string{result};
+}
+
+[[nodiscard]] static auto get_cost(const static_file &file) noexcept -> std::size_t
+{
+    auto cost = cache_entry_overhead;
+
+    if (file.identity.content)
+        cost += std::size(*file.identity.content);
+
+    if (file.gzip && file.gzip->content)
+        cost += std::size(*file.gzip->content);
+
+    return cost;
+}
+
+static void set_headers(static_file_variant &variant, const common::string &mime_type,
+                        const common::string &extra_headers)
+{
+    variant.validator_headers = "ETag: ";
+    variant.validator_headers += variant.etag;
+    variant.validator_headers += "\r\nLast-Modified: ";
+    variant.validator_headers += variant.last_modified;
+    variant.validator_headers += "\r\n";
+    variant.validator_headers += extra_headers;
+
+    variant.headers = "Content-Type: ";
+    variant.headers += mime_type;
+    variant.headers += "\r\nAccept-Ranges: bytes\r\n";
+    variant.headers += variant.validator_headers;
+}
+
+[[nodiscard]] static auto stat_file(const std::filesystem::path &path, std::uint64_t &size,
+                                    std::filesystem::file_time_type &last_write_time) -> bool
+{
+    std::error_code ec;
+
+    if (!std::filesystem::is_regular_file(path, ec))
+        return false;
+
+    size = std::filesystem::file_size(path, ec);
+
+    if (ec)
+        return false;
+
+    last_write_time = std::filesystem::last_write_time(path, ec);
+    return !ec;
+}
+
+} // namespace internal
+
+static_file_cache::static_file_cache(const std::size_t capacity, const std::size_t max_file_size,
+                                     const std::chrono::steady_clock::duration revalidate_interval,
+                                     const bool enable_precompressed,
+                                     const reply_compression_settings &compression)
+    : capacity_{capacity}
+    , max_file_size_{max_file_size}
+    , revalidate_interval_{revalidate_interval}
+    , enable_precompressed_{enable_precompressed}
+    , compression_{compression}
+    , mutex_{}
+    , entries_{}
+    , lru_{}
+    , size_{0}
+{
+}
+
+auto static_file_cache::find(const common::string &uri) -> std::shared_ptr<const static_file>
+{
+    std::shared_ptr<const static_file> file;
+
+    {
+        const std::scoped_lock lock{mutex_};
+        const auto result = entries_.find(uri.str());
+
+        if (result == std::end(entries_))
+            return nullptr;
+
+        auto &entry = result->second;
+        lru_.splice(std::begin(lru_), lru_, entry.lru_position);
+
+        const auto now = std::chrono::steady_clock::now();
+
+        if (now - entry.validated < revalidate_interval_)
+            return entry.file;
+
+        // Only one thread revalidates an entry. Others keep using it until the check is done.
+        entry.validated = now;
+        file = entry.file;
+    }
+
+    // Revalidating requires file system calls, which must not block other threads that use the cache.
+    if (is_unchanged(*file))
+        return file;
+
+    const std::scoped_lock lock{mutex_};
+    const auto result = entries_.find(uri.str());
+
+    if (result == std::end(entries_))
+        return nullptr;
+
+    // The entry may have been replaced in the mean time. A replacement of the same version of the file, like the one
+    // that adds the compressed variant, is just as outdated.
+    const auto &identity = result->second.file->identity;
+
+    if (identity.size == file->identity.size && identity.last_write_time == file->identity.last_write_time)
+        erase(uri.str());
+
+    return nullptr;
+}
+
+auto static_file_cache::load(const common::string &uri, const std::filesystem::path &path,
+                             const common::string &mime_type) -> std::shared_ptr<const static_file>
+{
+    auto file = std::make_shared<static_file>();
+
+    if (enable_precompressed_)
+    {
+        auto gzip_path = path;
+        gzip_path += internal::precompressed_extension;
+
+        // The gzip variant is only used when the original exists as well, so that the normal file lookup (and thus
+        // directory listing, hidden files etc.) still applies.
+        file->gzip = load_variant(gzip_path, mime_type, "Content-Encoding: gzip\r\nVary: Accept-Encoding\r\n");
+    }
+
+    auto identity = load_variant(path, mime_type, file->gzip ? "Vary: Accept-Encoding\r\n" : "");
+
+    if (!identity)
+        return nullptr;
+
+    file->identity = std::move(*identity);
+
+    // Compressing is only worth it for files that are kept in memory; others are sent with sendfile.
+    const auto compress = !file->gzip && compression_.enabled && file->identity.content &&
+                          file->identity.size >= compression_.min_size && is_compressible_content_type(mime_type);
+
+    if (compress)
+        internal::set_headers(file->identity, mime_type, "Vary: Accept-Encoding\r\n");
+
+    const auto cost = internal::get_cost(*file);
+
+    const std::scoped_lock lock{mutex_};
+    erase(uri.str());
+
+    // Files that would evict (nearly) the entire cache are not worth caching.
+    if (cost > capacity_)
+        return file;
+
+    lru_.push_front(uri.str());
+    entries_.emplace(uri.str(), cache_entry{file, std::chrono::steady_clock::now(), cost, std::begin(lru_)});
+    size_ += cost;
+
+    evict();
+
+    if (compress)
+        compress_async(uri.str(), file, mime_type);
+
+    return file;
+}
+
+auto static_file_cache::load_variant(const std::filesystem::path &path, const common::string &mime_type,
+                                     const common::string &extra_headers) const -> std::optional<static_file_variant>
+{
+    static_file_variant variant;
+    variant.path = path;
+
+    if (!internal::stat_file(path, variant.size, variant.last_write_time))
+        return std::nullopt;
+
+    if (variant.size <= max_file_size_)
+    {
+        try
+        {
+            auto file_stream = streams::make_dynamic_stream(streams::file_source_device{path});
+            const streams::stream_reader reader{file_stream};
+            auto content = reader.read_to_vector<std::byte>();
+
+            // The file was changed while it was being read; the next request will try again.
+            if (std::size(content) != variant.size)
+                return std::nullopt;
+
+            variant.content = std::make_shared<const std::vector<std::byte>>(std::move(content));
+        }
+        catch (const std::exception &)
+        {
+            return std::nullopt;
+        }
+    }
+
+    variant.etag = internal::make_etag(variant);
+    variant.last_modified = format_http_date(
+        std::chrono::time_point_cast<std::chrono::system_clock::duration>(
+            std::chrono::file_clock::to_sys(variant.last_write_time)));
+
+    internal::set_headers(variant, mime_type, extra_headers);
+    return variant;
+}
+
+auto static_file_cache::is_unchanged(const static_file &file) const -> bool
+{
+    std::uint64_t size = 0;
+    std::filesystem::file_time_type last_write_time;
+
+    if (!internal::stat_file(file.identity.path, size, last_write_time) || size != file.identity.size ||
+        last_write_time != file.identity.last_write_time)
+        return false;
+
+    if (!enable_precompressed_)
+        return true;
+
+    auto gzip_path = file.identity.path;
+    gzip_path += internal::precompressed_extension;
+
+    const auto gzip_exists = internal::stat_file(gzip_path, size, last_write_time);
+
+    if (!file.gzip || std::empty(file.gzip->path))
+        return !gzip_exists;
+
+    return gzip_exists && size == file.gzip->size && last_write_time == file.gzip->last_write_time;
+}
+
+void static_file_cache::compress_async(std::string uri, std::shared_ptr<const static_file> file,
+                                       common::string mime_type)
+{
+    asio::post(get_compression_pool(),
+               [self = weak_from_this(), uri = std::move(uri), file = std::move(file),
+                mime_type = std::move(mime_type), mode = compression_.mode]()
+               {
+                   const auto &identity = file->identity;
+                   auto content = compress_content(*identity.content, content_encoding::gzip, mode);
+
+                   // Files that do not compress well are served as is.
+                   if (std::empty(content) || std::size(content) >= std::size(*identity.content))
+                       return;
+
+                   const auto cache = self.lock();
+
+                   if (!cache)
+                       return;
+
+                   auto compressed = std::make_shared<static_file>(*file);
+                   auto &gzip = compressed->gzip.emplace();
+                   gzip.size = std::size(content);
+                   gzip.last_write_time = identity.last_write_time;
+                   gzip.etag = internal::make_compressed_etag(identity.etag);
+                   gzip.last_modified = identity.last_modified;
+                   gzip.content = std::make_shared<const std::vector<std::byte>>(std::move(content));
+                   internal::set_headers(gzip, mime_type, "Content-Encoding: gzip\r\nVary: Accept-Encoding\r\n");
+
+                   cache->replace(uri, file, std::move(compressed));
+               });
+}
+
+void static_file_cache::replace(const std::string &uri, const std::shared_ptr<const static_file> &file,
+                                std::shared_ptr<const static_file> replacement)
+{
+    const std::scoped_lock lock{mutex_};
+    const auto result = entries_.find(uri);
+
+    // The file was changed or evicted in the mean time.
+    if (result == std::end(entries_) || result->second.file != file)
+        return;
+
+    const auto cost = internal::get_cost(*replacement);
+    size_ = size_ - result->second.cost + cost;
+    result->second.cost = cost;
+    result->second.file = std::move(replacement);
+
+    evict();
+}
+
+void static_file_cache::erase(const std::string &uri)
+{
+    const auto result = entries_.find(uri);
+
+    if (result == std::end(entries_))
+        return;
+
+    size_ -= result->second.cost;
+    lru_.erase(result->second.lru_position);
+    entries_.erase(result);
+}
+
+void static_file_cache::evict()
+{
+    while (size_ > capacity_ && !std::empty(lru_))
+        erase(lru_.back());
+}
+
+auto format_http_date(const std::chrono::system_clock::time_point time) -> common::string
+{
+    static constexpr std::array<const char *, 7> weekdays{"Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat"};
+    static constexpr std::array<const char *, 12> months{"Jan", "Feb", "Mar", "Apr", "May", "Jun",
+                                                         "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"};
+
+    const auto days = std::chrono::floor<std::chrono::days>(time);
+    const std::chrono::year_month_day date{days};
+    const std::chrono::weekday weekday{days};
+    const std::chrono::hh_mm_ss time_of_day{std::chrono::floor<std::chrono::seconds>(time - days)};
+
+    std::array<char, 32> buffer{};
+    const auto length =
+        std::snprintf(std::data(buffer), std::size(buffer), "%s, %02u %s %04d %02d:%02d:%02d GMT",
+                      weekdays[weekday.c_encoding()], static_cast<unsigned>(date.day()),
+                      months[static_cast<unsigned>(date.month()) - 1], static_cast<int>(date.year()),
+                      static_cast<int>(time_of_day.hours().count()), static_cast<int>(time_of_day.minutes().count()),
+                      static_cast<int>(time_of_day.seconds().count()));
+    return common::string{std::data(buffer), std::data(buffer) + length};
+}
+
+} // namespace aeon::web::http::detail
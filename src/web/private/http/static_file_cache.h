@@ -0,0 +1,126 @@
+// Distributed under the BSD 2-Clause License - Copyright 2012-2023 Robin Degen
+
+#pragma once
+
+#include <aeon/web/http/content_encoding.h>
+#include <aeon/common/string.h>
+#include <filesystem>
+#include <unordered_map>
+#include <optional>
+#include <chrono>
+#include <memory>
+#include <vector>
+#include <list>
+#include <mutex>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+namespace aeon::web::http::detail
+{
+
+/*!
+ * A single representation of a static file; either the file itself or its gzip variant. The gzip variant is either
+ * precompressed on disk, or compressed in memory by the cache.
+ */
+struct static_file_variant final
+{
+    // Empty for a variant that was compressed by the cache.
+    std::filesystem::path path;
+    std::uint64_t size = 0;
+    std::filesystem::file_time_type last_write_time;
+
+    common::string etag;
+    common::string last_modified;
+
+    // Content-Type, ETag, Last-Modified etc; each terminated with "\r\n".
+    common::string headers;
+
+    // The headers that are sent with a 304 Not Modified or 416 Range Not Satisfiable reply.
+    common::string validator_headers;
+
+    // The contents of the file. Empty if the file is too large to be kept in memory.
+    std::shared_ptr<const std::vector<std::byte>> content;
+};
+
+struct static_file final
+{
+    static_file_variant identity;
+    std::optional<static_file_variant> gzip;
+};
+
+/*!
+ * An LRU cache of static files by uri. Small files are kept in memory, so that they can be sent without touching the
+ * disk. For large files only the metadata is kept.
+ *
+ * Compressible files that are kept in memory and have no precompressed variant are compressed on the compression
+ * thread pool after they are loaded. Until that is done, the file is served uncompressed.
+ *
+ * The cache may be used from multiple threads. Files are read from disk and revalidated without holding the lock.
+ */
+class static_file_cache final : public std::enable_shared_from_this<static_file_cache>
+{
+    struct cache_entry
+    {
+        std::shared_ptr<const static_file> file;
+        std::chrono::steady_clock::time_point validated;
+        std::size_t cost = 0;
+        std::list<std::string>::iterator lru_position;
+    };
+
+public:
+    explicit static_file_cache(const std::size_t capacity, const std::size_t max_file_size,
+                               const std::chrono::steady_clock::duration revalidate_interval,
+                               const bool enable_precompressed, const reply_compression_settings &compression);
+
+    ~static_file_cache() = default;
+
+    static_file_cache(static_file_cache &&) = delete;
+    auto operator=(static_file_cache &&) -> static_file_cache & = delete;
+
+    static_file_cache(const static_file_cache &) = delete;
+    auto operator=(const static_file_cache &) -> static_file_cache & = delete;
+
+    /*!
+     * Find a file by uri. Returns null if the file is not cached or it was changed on disk.
+     */
+    [[nodiscard]] auto find(const common::string &uri) -> std::shared_ptr<const static_file>;
+
+    /*!
+     * Load a file and add it to the cache. Returns null if the file could not be read.
+     */
+    [[nodiscard]] auto load(const common::string &uri, const std::filesystem::path &path,
+                            const common::string &mime_type) -> std::shared_ptr<const static_file>;
+
+private:
+    [[nodiscard]] auto load_variant(const std::filesystem::path &path, const common::string &mime_type,
+                                    const common::string &extra_headers) const -> std::optional<static_file_variant>;
+    [[nodiscard]] auto is_unchanged(const static_file &file) const -> bool;
+
+    void compress_async(std::string uri, std::shared_ptr<const static_file> file, common::string mime_type);
+    void replace(const std::string &uri, const std::shared_ptr<const static_file> &file,
+                 std::shared_ptr<const static_file> replacement);
+
+    void erase(const std::string &uri);
+    void evict();
+
+    std::size_t capacity_;
+    std::size_t max_file_size_;
+    std::chrono::steady_clock::duration revalidate_interval_;
+    bool enable_precompressed_;
+    reply_compression_settings compression_;
+
+    std::mutex mutex_;
+    std::unordered_map<std::string, cache_entry> entries_;
+
+    // Most recently used first.
+    std::list<std::string> lru_;
+    std::size_t size_;
+};
+
+/*!
+ * Format a time as an HTTP-date (RFC 7231 section 7.1.1.1); ie. "Sun, 06 Nov 1994 08:49:37 GMT"
+ */
+[[nodiscard]] auto format_http_date(const std::chrono::system_clock::time_point time) -> common::string;
+
+} // namespace aeon::web::http::detail
@@ -6,15 +6,119 @@
 #include <aeon/web/http/url_encoding.h>
 #include <aeon/web/http/request.h>
 #include <aeon/web/http/constants.h>
-#include <aeon/streams/devices/file_device.h>
-#include <aeon/streams/dynamic_stream.h>
-#include <aeon/streams/stream_reader.h>
 #include <aeon/common/string_utils.h>
+#include "static_file_cache.h"
+#include <charconv>
 #include <cassert>
 
 namespace aeon::web::http
 {
 
+namespace internal
+{
+
+struct byte_range
+{
+    std::uint64_t offset = 0;
+    std::uint64_t size = 0;
+};
+
+enum class range_result
+{
+    none,
+    satisfiable,
+    not_satisfiable
+};
+
+[[nodiscard]] static auto parse_uint(const std::string_view str, std::uint64_t &value) noexcept -> bool
+{
+    if (std::empty(str))
+        return false;
+
+    const auto result = std::from_chars(std::data(str), std::data(str) + std::size(str), value);
+    return result.ec == std::errc{} && result.ptr == std::data(str) + std::size(str);
+}
+
+/*!
+ * Parse a Range header (RFC 7233). Only a single range is supported; for anything else the entire file is sent, which
+ * is allowed by the RFC.
+ */
+[[nodiscard]] static auto parse_range(const common::string_view &header, const std::uint64_t size, byte_range &range)
+    -> range_result
+{
+    static constexpr std::string_view unit = "bytes=";
+
+    const std::string_view value{std::data(header), std::size(header)};
+
+    if (!value.starts_with(unit) || value.find(',') != std::string_view::npos)
+        return range_result::none;
+
+    const auto spec = value.substr(std::size(unit));
+    const auto dash = spec.find('-');
+
+    if (dash == std::string_view::npos)
+        return range_result::none;
+
+    const auto first_str = spec.substr(0, dash);
+    const auto last_str = spec.substr(dash + 1);
+
+    std::uint64_t first = 0;
+    std::uint64_t last = 0;
+
+    // A suffix range: the last n bytes.
+    if (std::empty(first_str))
+    {
+        if (!parse_uint(last_str, last))
+            return range_result::none;
+
+        if (last == 0 || size == 0)
+            return range_result::not_satisfiable;
+
+        range.size = std::min(last, size);
+        range.offset = size - range.size;
+        return range_result::satisfiable;
+    }
+
+    if (!parse_uint(first_str, first))
+        return range_result::none;
+
+    if (std::empty(last_str))
+        last = size - 1;
+    else if (!parse_uint(last_str, last) || last < first)
+        return range_result::none;
+
+    if (first >= size)
+        return range_result::not_satisfiable;
+
+    range.offset = first;
+    range.size = std::min(last, size - 1) - first + 1;
+    return range_result::satisfiable;
+}
+
+/*!
+ * Returns true if the If-None-Match header contains the given entity tag, or "*".
+ */
+[[nodiscard]] static auto matches_etag(const common::string_view &header, const common::string &etag) -> bool
+{
+    const std::string_view value{std::data(header), std::size(header)};
+    return value == "*" || value.find(std::string_view{etag.str()}) != std::string_view::npos;
+}
+
+[[nodiscard]] static auto is_not_modified(const request &request, const detail::static_file_variant &variant) -> bool
+{
+    // If-None-Match takes precedence over If-Modified-Since (RFC 7232 section 6).
+    if (const auto if_none_match = request.find_header(detail::if_none_match_key))
+        return matches_etag(*if_none_match, variant.etag);
+
+    // Only an exact match is supported. Clients send back the value that was given to them.
+    if (const auto if_modified_since = request.find_header(detail::if_modified_since_key))
+        return *if_modified_since == common::string_view{variant.last_modified};
+
+    return false;
+}
+
+} // namespace internal
+
 auto detail::to_url_path(const common::string &path) -> common::string
 {
     return common::string{common::string_utils::replace_copy(path, "\\", "/").as_std_u8string_view()};
@@ -37,6 +141,9 @@ static_route::static_route(common::string mount_point, const std::filesystem::pa
     : route{std::move(mount_point)}
     , base_path_{std::filesystem::canonical(base_path)}
     , settings_{std::move(settings)}
+    , cache_{std::make_shared<detail::static_file_cache>(settings_.cache_size, settings_.max_cached_file_size,
+                                                         settings_.cache_revalidate_interval,
+                                                         settings_.enable_precompressed, settings_.compression)}
 {
     assert(std::filesystem::is_directory(base_path));
 }
@@ -46,6 +153,13 @@ static_route::~static_route() = default;
 void static_route::on_http_request(http_server_socket &source, routable_http_server_session &session,
                                    const request &request)
 {
+    // A cached file can be sent without touching the filesystem, apart from an occasional check for changes.
+    if (const auto file = cache_->find(request.get_uri()))
+    {
+        reply_file(source, request, *file);
+        return;
+    }
+
     std::filesystem::path uri_path(request.get_uri().str());
 
     // If a directory was given, check the default files.
@@ -71,7 +185,20 @@ void static_route::on_http_request(http_server_socket &source, routable_http_ser
 
     if (std::filesystem::is_regular_file(full_path))
     {
-        reply_file(source, session, full_path);
+        auto extension = full_path.extension().u8string();
+
+        if (extension.empty())
+            extension = full_path.stem().u8string();
+
+        const auto file = cache_->load(request.get_uri(), full_path, session.find_mime_type_by_extension(extension));
+
+        if (!file)
+        {
+            source.respond_default(status_code::internal_server_error);
+            return;
+        }
+
+        reply_file(source, request, *file);
     }
     else
     {
@@ -106,19 +233,80 @@ auto static_route::get_path_for_default_files(const std::filesystem::path &path)
     return uri_path;
 }
 
-void static_route::reply_file(http_server_socket &source, routable_http_server_session &session,
-                              const std::filesystem::path &file) const
+void static_route::reply_file(http_server_socket &source, const request &request,
+                              const detail::static_file &file) const
 {
-    auto extension = file.extension().u8string();
+    const auto accept_encoding = request.find_header(detail::accept_encoding_key);
+
+    if (file.gzip && accept_encoding && accepts_content_encoding(*accept_encoding, content_encoding::gzip))
+        reply_variant(source, request, *file.gzip);
+    else
+        reply_variant(source, request, file.identity);
+}
+
+void static_route::reply_variant(http_server_socket &source, const request &request,
+                                 const detail::static_file_variant &variant) const
+{
+    if (internal::is_not_modified(request, variant))
+    {
+        source.respond_headers(status_code::not_modified, variant.validator_headers, 0);
+        return;
+    }
 
-    if (extension.empty())
-        extension = file.stem().u8string();
+    auto code = status_code::ok;
+    const common::string *headers = &variant.headers;
+    common::string range_headers;
+    internal::byte_range range{0, variant.size};
 
-    const auto mime_type = session.find_mime_type_by_extension(extension);
+    const auto range_header = request.find_header(detail::range_key);
+    const auto if_range = request.find_header(detail::if_range_key);
 
-    auto file_stream = streams::make_dynamic_stream(streams::file_source_device{file});
-    const streams::stream_reader reader{file_stream};
-    source.respond(mime_type, reader.read_to_vector<std::byte>());
+    // If-Range: only send the requested range if the file was not changed since the client received the first part.
+    if (range_header && (!if_range || *if_range == common::string_view{variant.etag} ||
+                         *if_range == common::string_view{variant.last_modified}))
+    {
+        const auto result = internal::parse_range(*range_header, variant.size, range);
+
+        if (result == internal::range_result::not_satisfiable)
+        {
+            range_headers = variant.validator_headers;
+            range_headers += "Content-Range: bytes */";
+            range_headers += std::to_string(variant.size);
+            range_headers += "\r\n";
+            source.respond_headers(status_code::range_not_satisfiable, range_headers, 0);
+            return;
+        }
+
+        if (result == internal::range_result::satisfiable)
+        {
+            code = status_code::partial_content;
+            range_headers = variant.headers;
+            range_headers += "Content-Range: bytes ";
+            range_headers += std::to_string(range.offset);
+            range_headers += '-';
+            range_headers += std::to_string(range.offset + range.size - 1);
+            range_headers += '/';
+            range_headers += std::to_string(variant.size);
+            range_headers += "\r\n";
+            headers = &range_headers;
+        }
+    }
+
+    if (request.get_method() == http_method::head)
+    {
+        source.respond_headers(code, *headers, range.size);
+        return;
+    }
+
+    if (variant.content)
+    {
+        source.respond(code, *headers, variant.content, static_cast<std::size_t>(range.offset),
+                       static_cast<std::size_t>(range.size));
+    }
+    else
+    {
+        source.respond_file(code, *headers, variant.path, range.offset, range.size);
+    }
 }
 
 void static_route::reply_folder(http_server_socket &source, [[maybe_unused]] routable_http_server_session &session,
@@ -8,6 +8,14 @@ namespace aeon::web::jsonrpc
 method::method(common::string name, signature func)
     : name_{std::move(name)}
     , func_{std::move(func)}
+    , async_func_{}
+{
+}
+
+method::method(common::string name, async_signature func)
+    : name_{std::move(name)}
+    , func_{}
+    , async_func_{std::move(func)}
 {
 }
 
@@ -16,9 +24,22 @@ auto method::name() const noexcept -> const common::string &
     return name_;
 }
 
+auto method::is_async() const noexcept -> bool
+{
+    return static_cast<bool>(async_func_);
+}
+
 auto method::operator()(const ptree::property_tree &params) const -> result
 {
     return func_(params);
 }
 
+void method::operator()(const ptree::property_tree &params, result_handler handler) const
+{
+    if (async_func_)
+        async_func_(params, std::move(handler));
+    else
+        handler(func_(params));
+}
+
 } // namespace aeon::web::jsonrpc
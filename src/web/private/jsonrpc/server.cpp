@@ -2,6 +2,17 @@
 
 #include <aeon/web/jsonrpc/server.h>
 #include <aeon/ptree/serialization/serialization_json.h>
+#include <aeon/ptree/serialization/exception.h>
+#include <asio/thread_pool.hpp>
+#include <asio/post.hpp>
+#include <string_view>
+#include <optional>
+#include <charconv>
+#include <future>
+#include <atomic>
+#include <thread>
+#include <array>
+#include <exception>
 
 static const auto json_rpc_version_string = "2.0";
 
@@ -36,6 +47,125 @@ auto respond_error(const result &result) -> ptree::property_tree
 
 } // namespace detail
 
+namespace internal
+{
+
+/*!
+ * The threads that the requests of batches are executed on when parallel execution is enabled. Shared by all
+ * servers; the threads are started on first use.
+ */
+[[nodiscard]] static auto get_batch_pool() -> asio::thread_pool &
+{
+    static asio::thread_pool pool{std::max(std::thread::hardware_concurrency(), 1u)};
+    return pool;
+}
+
+/*!
+ * Writes responses as json directly into the buffer that is sent, instead of building a property tree for every
+ * response and serializing that to a string. Only the results themselves are serialized through a scratch string,
+ * which is reused for all responses written by the same writer.
+ */
+class response_writer final
+{
+public:
+    explicit response_writer(std::vector<std::byte> &buffer)
+        : buffer_{&buffer}
+        , scratch_{}
+    {
+    }
+
+    void write(const result &result)
+    {
+        append(R"({"jsonrpc":")");
+        append(json_rpc_version_string);
+
+        if (result.type() == rpc_result_type::result)
+        {
+            append(R"(","result":)");
+            write_json(result.result_type());
+        }
+        else
+        {
+            append(R"(","error":{"code":)");
+            write_integer(result.error_code());
+            append(R"(,"message":)");
+            write_json(ptree::property_tree{result.error_description()});
+            append("}");
+        }
+
+        append(R"(,"id":)");
+
+        if (result.has_id())
+            write_integer(result.id().value());
+        else
+            append("null");
+
+        append("}");
+    }
+
+    void append(const std::string_view str)
+    {
+        const auto bytes = reinterpret_cast<const std::byte *>(std::data(str));
+        buffer_->insert(std::end(*buffer_), bytes, bytes + std::size(str));
+    }
+
+private:
+    void write_json(const ptree::property_tree &value)
+    {
+        scratch_.clear();
+        ptree::serialization::to_json(value, scratch_);
+        append(scratch_.as_std_string_view());
+    }
+
+    void write_integer(const int value)
+    {
+        std::array<char, 16> str{};
+        const auto [end, ec] = std::to_chars(std::data(str), std::data(str) + std::size(str), value);
+        append(std::string_view{std::data(str), static_cast<std::size_t>(end - std::data(str))});
+    }
+
+    std::vector<std::byte> *buffer_;
+    common::string scratch_;
+};
+
+/*!
+ * The results of a batch, which are filled in from any thread as the requests complete.
+ */
+struct batch_state final
+{
+    explicit batch_state(std::shared_ptr<const ptree::property_tree> request,
+                         std::function<void(std::vector<result>, bool)> handler)
+        : request{std::move(request)}
+        , results(std::size(this->request->array_value()))
+        , remaining{std::size(results)}
+        , handler{std::move(handler)}
+    {
+    }
+
+    void complete(const std::size_t index, result result)
+    {
+        results[index].emplace(std::move(result));
+
+        if (remaining.fetch_sub(1, std::memory_order_acq_rel) != 1)
+            return;
+
+        std::vector<jsonrpc::result> batch_results;
+        batch_results.reserve(std::size(results));
+
+        for (auto &r : results)
+            batch_results.emplace_back(std::move(*r));
+
+        handler(std::move(batch_results), true);
+    }
+
+    std::shared_ptr<const ptree::property_tree> request;
+    std::vector<std::optional<result>> results;
+    std::atomic<std::size_t> remaining;
+    std::function<void(std::vector<result>, bool)> handler;
+};
+
+} // namespace internal
+
 auto respond(const result &result) -> ptree::property_tree
 {
     switch (result.type())
@@ -48,32 +178,100 @@ auto respond(const result &result) -> ptree::property_tree
     }
 }
 
+void respond(const result &result, std::vector<std::byte> &buffer)
+{
+    internal::response_writer writer{buffer};
+    writer.write(result);
+}
+
 void server::register_method(const method &method)
 {
     const auto &name = method.name();
     methods_.insert({name, method});
 }
 
-auto server::request(const common::string &str) const -> common::string
+void server::set_batch_settings(const batch_settings &settings) noexcept
+{
+    batch_settings_ = settings;
+}
+
+void server::request_async(const common::string &str, response_handler handler) const
 {
+    const auto respond_error = [&handler](const int error_code, const char *const description)
+    {
+        std::vector<std::byte> response;
+        respond(result{error_code, description}, response);
+        handler(std::move(response));
+    };
+
     if (str.empty())
-        return ptree::serialization::to_json(detail::respond_error(result{json_rpc_error::parse_error, "No content"}));
+    {
+        respond_error(json_rpc_error::parse_error, "No content");
+        return;
+    }
+
+    std::shared_ptr<const ptree::property_tree> json;
+
+    try
+    {
+        json = std::make_shared<const ptree::property_tree>(ptree::serialization::from_json(str));
+    }
+    catch (const ptree::serialization::ptree_serialization_exception &)
+    {
+        respond_error(json_rpc_error::parse_error, "Json parse error.");
+        return;
+    }
+
+    handle_requests(std::move(json),
+                    [handler = std::move(handler)](const std::vector<result> results, const bool batch)
+                    {
+                        std::vector<std::byte> response;
+                        internal::response_writer writer{response};
 
-    const auto json = ptree::serialization::from_json(str);
+                        if (!batch)
+                        {
+                            writer.write(results.at(0));
+                            handler(std::move(response));
+                            return;
+                        }
 
-    if (json.is_null())
-        return ptree::serialization::to_json(
-            detail::respond_error(result{json_rpc_error::parse_error, "Json parse error."}));
+                        writer.append("[");
 
-    return ptree::serialization::to_json(request(json));
+                        for (std::size_t i = 0; i < std::size(results); ++i)
+                        {
+                            if (i != 0)
+                                writer.append(",");
+
+                            writer.write(results[i]);
+                        }
+
+                        writer.append("]");
+                        handler(std::move(response));
+                    });
+}
+
+auto server::request(const common::string &str) const -> common::string
+{
+    std::promise<std::vector<std::byte>> promise;
+    auto future = promise.get_future();
+    request_async(str, [&promise](std::vector<std::byte> response) { promise.set_value(std::move(response)); });
+
+    const auto response = future.get();
+    const auto data = reinterpret_cast<const char *>(std::data(response));
+    return common::string{data, data + std::size(response)};
 }
 
 auto server::request(const ptree::property_tree &request) const -> ptree::property_tree
 {
-    auto request_result = handle_requests(request);
+    std::promise<std::vector<result>> promise;
+    auto future = promise.get_future();
+    handle_requests(std::make_shared<const ptree::property_tree>(request),
+                    [&promise](std::vector<result> results, [[maybe_unused]] const bool batch)
+                    { promise.set_value(std::move(results)); });
+
+    const auto request_result = future.get();
 
-    // Batch request?
-    if (request_result.size() > 1)
+    if (request.is_array())
     {
         ptree::array response_array;
         for (const auto &r : request_result)
@@ -84,85 +282,155 @@ auto server::request(const ptree::property_tree &request) const -> ptree::proper
         return response_array;
     }
 
-    if (request_result.size() == 1)
-        return respond(request_result.at(0));
-
-    return detail::respond_error(result{json_rpc_error::invalid_request, "No content"});
+    return respond(request_result.at(0));
 }
 
-auto server::handle_requests(const ptree::property_tree &request) const -> std::vector<result>
+void server::handle_requests(std::shared_ptr<const ptree::property_tree> request, results_handler handler) const
 {
-    if (request.is_null())
-        return {result{json_rpc_error::parse_error, "Json parse error."}};
+    if (request->is_null())
+    {
+        handler({result{json_rpc_error::parse_error, "Json parse error."}}, false);
+        return;
+    }
 
-    // Is this a batch request?
-    if (request.is_array())
+    if (!request->is_array())
     {
-        std::vector<result> results;
-        for (const auto &r : request.array_value())
-        {
-            results.emplace_back(handle_single_rpc_request(r));
-        }
+        handle_single_rpc_request(*request, [handler = std::move(handler)](result result)
+                                  { handler({std::move(result)}, false); });
+        return;
+    }
+
+    const auto &requests = request->array_value();
 
-        return results;
+    if (std::empty(requests))
+    {
+        handler({result{json_rpc_error::invalid_request, "No content"}}, false);
+        return;
     }
 
-    return {handle_single_rpc_request(request)};
+    const auto parallel = batch_settings_.parallel && std::size(requests) >= batch_settings_.min_parallel_size;
+    auto state = std::make_shared<internal::batch_state>(std::move(request), std::move(handler));
+
+    for (std::size_t i = 0; i < std::size(requests); ++i)
+    {
+        if (parallel)
+        {
+            asio::post(internal::get_batch_pool(),
+                       [this, state, i]()
+                       {
+                           handle_single_rpc_request(state->request->array_value()[i], [state, i](result result)
+                                                     { state->complete(i, std::move(result)); });
+                       });
+        }
+        else
+        {
+            handle_single_rpc_request(requests[i],
+                                      [state, i](result result) { state->complete(i, std::move(result)); });
+        }
+    }
 }
 
-auto server::handle_single_rpc_request(const ptree::property_tree &request) const -> result
+void server::handle_single_rpc_request(const ptree::property_tree &request, method::result_handler handler) const
 {
     if (!request.is_object())
-        return result{json_rpc_error::invalid_request, "Invalid request format."};
+    {
+        handler(result{json_rpc_error::invalid_request, "Invalid request format."});
+        return;
+    }
 
     if (!request.contains("jsonrpc"))
-        return result{json_rpc_error::invalid_request, "Missing 'jsonrpc' field."};
+    {
+        handler(result{json_rpc_error::invalid_request, "Missing 'jsonrpc' field."});
+        return;
+    }
 
     if (!request.contains("id"))
-        return result{json_rpc_error::invalid_request, "Missing 'id' field."};
+    {
+        handler(result{json_rpc_error::invalid_request, "Missing 'id' field."});
+        return;
+    }
 
-    auto id_value = request.at("id");
-    auto jsonrpc_value = request.at("jsonrpc");
+    const auto &id_value = request.at("id");
+    const auto &jsonrpc_value = request.at("jsonrpc");
 
     if (!id_value.is_integer())
-        return result{json_rpc_error::invalid_request, "'Id' field must contain a number."};
+    {
+        handler(result{json_rpc_error::invalid_request, "'Id' field must contain a number."});
+        return;
+    }
 
     // TODO: Check if ID is out of bounds
     const auto id = static_cast<int>(id_value.integer_value());
 
     if (jsonrpc_value.is_null())
-        return result{json_rpc_error::invalid_request, "Missing 'jsonrpc' version field.", id};
+    {
+        handler(result{json_rpc_error::invalid_request, "Missing 'jsonrpc' version field.", id});
+        return;
+    }
 
     if (!jsonrpc_value.is_string())
-        return result{json_rpc_error::invalid_request, "Invalid 'jsonrpc' version field.", id};
+    {
+        handler(result{json_rpc_error::invalid_request, "Invalid 'jsonrpc' version field.", id});
+        return;
+    }
 
     if (jsonrpc_value.string_value() != json_rpc_version_string)
-        return result{json_rpc_error::invalid_request, "Invalid rpc version. Required: '2.0'.", id};
+    {
+        handler(result{json_rpc_error::invalid_request, "Invalid rpc version. Required: '2.0'.", id});
+        return;
+    }
 
-    if (request.contains("method"))
-        return result{json_rpc_error::invalid_request, "Missing 'method' field.", id};
+    if (!request.contains("method"))
+    {
+        handler(result{json_rpc_error::invalid_request, "Missing 'method' field.", id});
+        return;
+    }
 
-    auto method_value = request.at("method");
+    const auto &method_value = request.at("method");
 
     if (!method_value.is_string())
-        return result{json_rpc_error::invalid_request, "'method' field must contain a string.", id};
-
-    const auto &method = method_value.string_value();
+    {
+        handler(result{json_rpc_error::invalid_request, "'method' field must contain a string.", id});
+        return;
+    }
 
-    const auto itr = methods_.find(method);
+    const auto itr = methods_.find(method_value.string_value());
 
     if (itr == methods_.end())
-        return result{json_rpc_error::method_not_found, "Method not found.", id};
+    {
+        handler(result{json_rpc_error::method_not_found, "Method not found.", id});
+        return;
+    }
 
-    auto params = ptree::property_tree{};
+    static const ptree::property_tree no_params;
+    const auto &params = request.contains("params") ? request.at("params") : no_params;
+    const auto &method = itr->second;
 
-    if (request.contains("params"))
-        params = request.at("params");
+    if (method.is_async())
+    {
+        method(params,
+               [id, handler = std::move(handler)](result method_result)
+               {
+                   method_result.set_id(id);
+                   handler(std::move(method_result));
+               });
+        return;
+    }
 
-    auto method_result = itr->second(params);
-    method_result.set_id(id);
+    // Methods may run on the batch thread pool, where an exception can not be propagated to the caller.
+    std::optional<result> method_result;
+
+    try
+    {
+        method_result.emplace(method(params));
+    }
+    catch (const std::exception &)
+    {
+        method_result.emplace(json_rpc_error::internal_error, "Internal error.");
+    }
 
-    return method_result;
+    method_result->set_id(id);
+    handler(std::move(*method_result));
 }
 
 } // namespace aeon::web::jsonrpc
@@ -0,0 +1,77 @@
+// Distributed under the BSD 2-Clause License - Copyright 2012-2023 Robin Degen
+
+#pragma once
+
+#include <aeon/web/http/status_code.h>
+#include <string_view>
+#include <string>
+#include <span>
+#include <cstddef>
+
+namespace aeon::web::http::detail
+{
+
+enum class chunked_decoder_result
+{
+    // A part of the data was decoded; call decode() again with the remaining data.
+    progress,
+
+    // All given data was used; more is needed.
+    incomplete,
+
+    // The last chunk and the trailer were decoded.
+    complete,
+
+    error
+};
+
+/*!
+ * An incremental decoder for content with chunked transfer encoding; see RFC 7230 section 4.1. Shared between the
+ * request and reply parsers. Chunk extensions and trailer fields are ignored.
+ */
+class chunked_decoder final
+{
+    enum class chunk_state
+    {
+        size,
+        data,
+        data_end,
+        trailer
+    };
+
+public:
+    chunked_decoder() noexcept;
+
+    /*!
+     * Prepare the decoder for new content. Chunk size lines and the trailer as a whole may not exceed max_header_size;
+     * the total size of the decoded content may not exceed max_content_length.
+     */
+    void reset(const std::size_t max_header_size, const std::size_t max_content_length) noexcept;
+
+    /*!
+     * Decode the next part of the given data. used is set to the amount of bytes of the data that were used. If the
+     * used data was (a part of) a chunk, piece is set to it; a view into the given data.
+     */
+    [[nodiscard]] auto decode(const std::span<const std::byte> data, std::size_t &used,
+                              std::span<const std::byte> &piece) -> chunked_decoder_result;
+
+    /*!
+     * The reason decoding failed; either bad_request, payload_too_large or request_header_fields_too_large.
+     */
+    [[nodiscard]] auto get_error() const noexcept -> status_code;
+
+private:
+    [[nodiscard]] auto decode_line(const std::string_view line) -> chunked_decoder_result;
+    [[nodiscard]] auto fail(const status_code code) noexcept -> chunked_decoder_result;
+
+    std::size_t max_header_size_;
+    std::size_t max_content_length_;
+    chunk_state state_;
+    std::size_t remaining_;
+    std::size_t received_;
+    std::size_t trailer_size_;
+    std::string line_;
+    status_code error_;
+};
+
+} // namespace aeon::web::http::detail
@@ -4,17 +4,85 @@
 
 #include <aeon/common/string.h>
 #include <vector>
+#include <chrono>
+#include <cstddef>
 
 namespace aeon::web::http::detail
 {
 
 static const auto content_length_key = "content-length";
 static const auto content_type_key = "content-type";
+static const auto transfer_encoding_key = "transfer-encoding";
+static const auto connection_key = "connection";
+static const auto accept_encoding_key = "accept-encoding";
+static const auto if_none_match_key = "if-none-match";
+static const auto if_modified_since_key = "if-modified-since";
+static const auto if_range_key = "if-range";
+static const auto range_key = "range";
 
 static const auto default_response_content_type = "text/plain";
 
 static const auto http_version_string = common::string{"HTTP/1.1"};
 
+// The maximum size of the request line and all headers of a single request combined.
+static constexpr std::size_t max_request_header_size = 8 * 1024;
+
+// The maximum amount of headers in a single request.
+static constexpr std::size_t max_request_headers = 64;
+
+// The maximum size of the content (body) of a single request.
+static constexpr std::size_t max_request_content_length = 1024 * 1024;
+
+// The maximum size of the content of a single request when it is streamed instead of buffered.
+static constexpr std::size_t max_streamed_request_content_length = 1024 * 1024 * 1024;
+
+// The maximum size of the status line and all headers of a single reply combined.
+static constexpr std::size_t max_reply_header_size = 64 * 1024;
+
+// The maximum amount of headers in a single reply.
+static constexpr std::size_t max_reply_headers = 64;
+
+// The maximum size of the content (body) of a single reply.
+static constexpr std::size_t max_reply_content_length = 64 * 1024 * 1024;
+
+// The maximum amount of path parameters (ie. "/users/:id") in a single route.
+static constexpr std::size_t max_path_parameters = 8;
+
+// The time a connection may stay idle between requests before it is closed.
+static constexpr std::chrono::steady_clock::duration default_keep_alive_timeout = std::chrono::seconds{5};
+
+// The amount of requests after which a keep-alive connection is closed.
+static constexpr std::size_t default_max_keep_alive_requests = 1000;
+
+// Replies with content up to this size are copied into the same buffer as the headers.
+static constexpr std::size_t max_single_buffer_reply_size = 16 * 1024;
+
+// Replies smaller than this are not compressed; the savings would not outweigh the cost.
+static constexpr std::size_t default_min_compressed_reply_size = 1024;
+
+// The maximum total size of the files that a static route keeps in memory.
+static constexpr std::size_t default_static_cache_size = 32 * 1024 * 1024;
+
+// Files larger than this are not kept in memory by a static route, but sent straight from disk.
+static constexpr std::size_t default_max_static_cached_file_size = 256 * 1024;
+
+// The interval after which a static route checks whether a cached file was changed on disk.
+static constexpr std::chrono::steady_clock::duration default_static_cache_revalidate_interval = std::chrono::seconds{1};
+
+// The maximum amount of connections that an http client keeps open to a single host.
+static constexpr std::size_t default_client_max_connections_per_host = 8;
+
+// The maximum amount of requests that an http client sends over a single connection before the replies are received.
+static constexpr std::size_t default_client_max_pipelined_requests = 8;
+
+static constexpr std::chrono::steady_clock::duration default_client_connect_timeout = std::chrono::seconds{5};
+
+static constexpr std::chrono::steady_clock::duration default_client_request_timeout = std::chrono::seconds{30};
+
+// Shorter than the keep-alive timeout of most servers (including ours), so that the client closes an idle connection
+// before the server does. Otherwise a request could be sent over a connection that is being closed.
+static constexpr std::chrono::steady_clock::duration default_client_idle_timeout = std::chrono::seconds{4};
+
 static const auto default_file_mime_type = common::string{"application/octet-stream"};
 
 static const auto default_files = std::vector<common::string>{"index.html", "index.htm"};
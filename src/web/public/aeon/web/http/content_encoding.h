@@ -0,0 +1,65 @@
+// Distributed under the BSD 2-Clause License - Copyright 2012-2023 Robin Degen
+
+#pragma once
+
+#include <aeon/web/http/constants.h>
+#include <aeon/compression/zlib.h>
+#include <aeon/common/string_view.h>
+#include <vector>
+#include <span>
+#include <cstddef>
+
+namespace aeon::web::http
+{
+
+enum class content_encoding
+{
+    identity,
+    gzip,
+    deflate
+};
+
+struct reply_compression_settings final
+{
+    // Compress replies for clients that accept it. Disabled unless explicitly enabled, since compressed replies are
+    // sent asynchronously and change the headers that are sent.
+    bool enabled = false;
+
+    // Replies smaller than this are sent uncompressed.
+    std::size_t min_size = detail::default_min_compressed_reply_size;
+
+    compression::zlib_compression_mode mode = compression::zlib_compression_mode::balanced;
+};
+
+/*!
+ * Returns true if the given Accept-Encoding header accepts the given encoding; either explicitly or through "*", and
+ * not with q=0.
+ */
+[[nodiscard]] auto accepts_content_encoding(const common::string_view &accept_encoding,
+                                            const content_encoding encoding) noexcept -> bool;
+
+/*!
+ * Select the encoding to compress a reply with, based on the Accept-Encoding header of the request. gzip is preferred
+ * over deflate when both are accepted with the same quality.
+ */
+[[nodiscard]] auto negotiate_content_encoding(const common::string_view &accept_encoding) noexcept
+    -> content_encoding;
+
+/*!
+ * The value of the Content-Encoding header for the given encoding.
+ */
+[[nodiscard]] auto content_encoding_to_string(const content_encoding encoding) noexcept -> common::string_view;
+
+/*!
+ * Returns true for content types that are worth compressing, like text, json and xml. Already compressed formats
+ * like images are not.
+ */
+[[nodiscard]] auto is_compressible_content_type(const common::string_view &content_type) noexcept -> bool;
+
+/*!
+ * Compress content with the given encoding. Returns an empty vector if compression failed.
+ */
+[[nodiscard]] auto compress_content(const std::span<const std::byte> content, const content_encoding encoding,
+                                    const compression::zlib_compression_mode mode) -> std::vector<std::byte>;
+
+} // namespace aeon::web::http
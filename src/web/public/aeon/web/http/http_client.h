@@ -0,0 +1,214 @@
+// Distributed under the BSD 2-Clause License - Copyright 2012-2023 Robin Degen
+
+#pragma once
+
+#include <aeon/web/http/request_parser.h>
+#include <aeon/web/http/method.h>
+#include <aeon/web/http/status_code.h>
+#include <aeon/web/http/constants.h>
+#include <aeon/common/string.h>
+#include <aeon/common/string_view.h>
+#include <asio/io_context.hpp>
+#include <system_error>
+#include <functional>
+#include <optional>
+#include <future>
+#include <memory>
+#include <vector>
+#include <chrono>
+#include <span>
+#include <cstddef>
+#include <cstdint>
+
+namespace aeon::web::http
+{
+
+class reply_parser;
+
+namespace detail
+{
+class http_client_pool;
+} // namespace detail
+
+struct http_client_settings final
+{
+    // The maximum amount of connections that are opened to a single host. Once all of them are busy, requests are
+    // queued until a connection becomes available.
+    std::size_t max_connections_per_host = detail::default_client_max_connections_per_host;
+
+    // The maximum amount of requests that are sent over a single connection before their replies are received. A
+    // value of 1 disables pipelining. Requests that are not idempotent (ie. POST) are never pipelined.
+    std::size_t max_pipelined_requests = detail::default_client_max_pipelined_requests;
+
+    std::chrono::steady_clock::duration connect_timeout = detail::default_client_connect_timeout;
+
+    // The maximum time to wait for a (part of a) reply once a request is sent.
+    std::chrono::steady_clock::duration request_timeout = detail::default_client_request_timeout;
+
+    // Connections that have not been used for this long are closed.
+    std::chrono::steady_clock::duration idle_timeout = detail::default_client_idle_timeout;
+};
+
+struct client_request final
+{
+    http_method method = http_method::get;
+
+    // The request target; must already be url encoded.
+    common::string uri = "/";
+
+    // Additional headers, each terminated with "\r\n" (ie. "Accept: text/html\r\n"). The Host and Content-Length
+    // headers are added by the client.
+    common::string headers;
+
+    // Sent as Content-Type if not empty.
+    common::string content_type;
+
+    std::vector<std::byte> content;
+};
+
+class client_reply;
+
+/*!
+ * A reply as it is passed to a reply handler. The headers and content are views into the data received by the
+ * connection; they are only valid during the call to the handler. Use copy() to keep the reply any longer.
+ */
+class client_reply_view final
+{
+public:
+    client_reply_view() noexcept;
+
+    /*!
+     * A view of the completed reply in the given parser. It is valid until the parser is reset.
+     */
+    explicit client_reply_view(const reply_parser &parser) noexcept;
+
+    ~client_reply_view() = default;
+
+    client_reply_view(client_reply_view &&) noexcept = default;
+    auto operator=(client_reply_view &&) noexcept -> client_reply_view & = default;
+
+    client_reply_view(const client_reply_view &) noexcept = default;
+    auto operator=(const client_reply_view &) noexcept -> client_reply_view & = default;
+
+    [[nodiscard]] auto get_status_code() const noexcept -> status_code;
+    [[nodiscard]] auto get_headers() const noexcept -> std::span<const http_header>;
+
+    /*!
+     * Find a header by name (case insensitive).
+     */
+    [[nodiscard]] auto find_header(const common::string_view &name) const noexcept
+        -> std::optional<common::string_view>;
+
+    [[nodiscard]] auto get_content() const noexcept -> std::span<const std::byte>;
+    [[nodiscard]] auto get_content_string() const noexcept -> common::string_view;
+
+    /*!
+     * Copy the headers and content into a reply that owns them.
+     */
+    [[nodiscard]] auto copy() const -> client_reply;
+
+private:
+    status_code status_code_;
+    std::span<const http_header> headers_;
+    std::span<const std::byte> content_;
+};
+
+/*!
+ * A reply that owns its headers and content. They are kept in a single buffer.
+ */
+class client_reply final
+{
+public:
+    client_reply() noexcept;
+
+    /*!
+     * Copy the headers and content out of the given view.
+     */
+    explicit client_reply(const client_reply_view &reply);
+
+    ~client_reply() = default;
+
+    client_reply(client_reply &&) noexcept = default;
+    auto operator=(client_reply &&) noexcept -> client_reply & = default;
+
+    client_reply(const client_reply &) = delete;
+    auto operator=(const client_reply &) -> client_reply & = delete;
+
+    [[nodiscard]] auto get_status_code() const noexcept -> status_code;
+    [[nodiscard]] auto get_headers() const noexcept -> std::span<const http_header>;
+
+    /*!
+     * Find a header by name (case insensitive).
+     */
+    [[nodiscard]] auto find_header(const common::string_view &name) const noexcept
+        -> std::optional<common::string_view>;
+
+    [[nodiscard]] auto get_content() const noexcept -> std::span<const std::byte>;
+    [[nodiscard]] auto get_content_string() const noexcept -> common::string_view;
+
+private:
+    status_code status_code_;
+    std::vector<std::byte> data_;
+    std::vector<http_header> headers_;
+    std::span<const std::byte> content_;
+};
+
+/*!
+ * Called with the reply, or with an error if the request failed. Failures include (amongst others) timed_out,
+ * connection_refused, operation_aborted when the client was closed and bad_message when the reply could not be parsed.
+ *
+ * The reply is only valid during the call; use reply.copy() to keep it.
+ */
+using client_reply_handler = std::function<void(const std::error_code &ec, const client_reply_view &reply)>;
+
+/*!
+ * An HTTP/1.1 client that keeps a pool of keep-alive connections per host.
+ *
+ * Requests to the same host are spread over up to max_connections_per_host connections, preferring the connection with
+ * the least requests in flight. Idempotent requests are pipelined on busy connections. When a reused connection turns
+ * out to be closed by the server, idempotent requests are retried once on another connection.
+ *
+ * All connections and handlers run on the given io_context; requests can be made from any thread.
+ */
+class http_client final
+{
+public:
+    explicit http_client(asio::io_context &context, const http_client_settings &settings = {});
+
+    /*!
+     * Closes all connections. Handlers of requests that are still pending are called with operation_aborted, once the
+     * io_context runs.
+     */
+    ~http_client();
+
+    http_client(http_client &&) = delete;
+    auto operator=(http_client &&) -> http_client & = delete;
+
+    http_client(const http_client &) = delete;
+    auto operator=(const http_client &) -> http_client & = delete;
+
+    /*!
+     * Send a request. The handler is called from the io_context once the reply was received or the request failed.
+     */
+    void request_async(const common::string &host, const std::uint16_t port, client_request request,
+                       client_reply_handler handler);
+
+    /*!
+     * Send a request. If the request fails, getting the result from the future throws a std::system_error.
+     *
+     * Never wait for the future on the thread that runs the io_context, since the reply can't be handled then.
+     */
+    [[nodiscard]] auto request(const common::string &host, const std::uint16_t port, client_request request)
+        -> std::future<client_reply>;
+
+    /*!
+     * Close all connections. Pending requests fail with operation_aborted. New requests open new connections.
+     */
+    void close();
+
+private:
+    asio::io_context &context_;
+    std::shared_ptr<detail::http_client_pool> pool_;
+};
+
+} // namespace aeon::web::http
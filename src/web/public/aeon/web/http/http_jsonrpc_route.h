@@ -27,6 +27,7 @@ public:
     auto operator=(const http_jsonrpc_route &) -> http_jsonrpc_route & = delete;
 
     void register_method(const jsonrpc::method &method) const;
+    void set_batch_settings(const jsonrpc::batch_settings &settings) const;
 
 private:
     void on_http_request(http_server_socket &source, routable_http_server_session &session,
@@ -5,6 +5,7 @@
 #include <aeon/web/http/http_server_socket.h>
 #include <aeon/web/http/http_server_session.h>
 #include <aeon/sockets/tcp_server.h>
+#include <aeon/sockets/tcp_server_pool.h>
 
 namespace aeon::web::http
 {
@@ -12,4 +13,10 @@ namespace aeon::web::http
 template <typename http_server_socket_t>
 using http_server = sockets::tcp_server<http_server_socket_t, http_server_session>;
 
+/*!
+ * An http server with a thread (and io_context) per core. See sockets::tcp_server_pool.
+ */
+template <typename http_server_socket_t>
+using http_server_pool = sockets::tcp_server_pool<http_server_socket_t, http_server_session>;
+
 } // namespace aeon::web::http
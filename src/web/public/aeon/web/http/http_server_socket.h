@@ -3,33 +3,49 @@
 #pragma once
 
 #include <aeon/web/http/request.h>
+#include <aeon/web/http/request_parser.h>
 #include <aeon/web/http/status_code.h>
+#include <aeon/web/http/content_encoding.h>
 #include <aeon/sockets/tcp_socket.h>
-#include <aeon/streams/devices/memory_device.h>
-#include <aeon/streams/filters/circular_buffer_filter.h>
-#include <aeon/streams/stream.h>
 #include <aeon/common/string.h>
 #include <asio.hpp>
+#include <filesystem>
+#include <functional>
+#include <optional>
+#include <chrono>
+#include <vector>
+#include <memory>
+#include <cstdint>
 
 namespace aeon::web::http
 {
 
-namespace detail
+class http_server_session;
+
+enum class chunk_result
 {
-auto validate_http_version_string(const common::string &version_string) -> bool;
-auto validate_uri(const common::string &uri) -> bool;
-} // namespace detail
+    // The given buffer contains the next chunk.
+    data,
 
-class http_server_session;
+    // No data is available right now; call http_server_socket::resume_chunked_response() once there is.
+    pending,
+
+    // The response is complete. The given buffer may still contain a last chunk.
+    done
+};
+
+/*!
+ * Produces the content of a chunked response; one chunk per call. The given buffer is empty when called.
+ */
+using chunk_producer = std::function<chunk_result(std::vector<std::byte> &chunk)>;
 
 class http_server_socket : public sockets::tcp_socket
 {
     enum class http_state
     {
-        server_read_method,
-        server_read_headers,
-        server_read_body,
-        server_reply
+        server_read_request,
+        server_reply,
+        server_closing
     };
 
 public:
@@ -51,30 +67,141 @@ public:
     void respond(const common::string &content_type, std::vector<std::byte> data,
                  const status_code code = status_code::ok);
 
+    /*!
+     * Respond from any thread; the reply is given on the thread that handles this socket. Intended for replies that
+     * are produced on other threads, after on_http_request has returned.
+     */
+    void post_respond(const common::string &content_type, std::vector<std::byte> data,
+                      const status_code code = status_code::ok);
+
     void respond_default(const status_code code);
 
+    /*!
+     * Respond with preformatted headers; each header must end with "\r\n". The status line, Connection and
+     * Content-Length headers are added. The given part of the content is sent without copying it.
+     */
+    void respond(const status_code code, const common::string &headers,
+                 std::shared_ptr<const std::vector<std::byte>> content, const std::size_t offset,
+                 const std::size_t size);
+
+    /*!
+     * Respond with preformatted headers and a range of a file. See sockets::tcp_socket::send_file.
+     */
+    void respond_file(const status_code code, const common::string &headers, const std::filesystem::path &path,
+                      const std::uint64_t offset, const std::uint64_t size);
+
+    /*!
+     * Respond with preformatted headers only; for replies to HEAD requests and replies like 304 Not Modified that never
+     * have content. The given content length is sent as the Content-Length header.
+     */
+    void respond_headers(const status_code code, const common::string &headers, const std::uint64_t content_length);
+
+    /*!
+     * Respond with preformatted headers and content of unknown length with chunked transfer encoding. The producer is
+     * called for the next chunk only after the previous one was written to the socket, so a slow client never causes
+     * the entire content to be held in memory.
+     */
+    void respond_chunked(const status_code code, const common::string &headers, chunk_producer producer);
+
+    /*!
+     * Continue a chunked response after its producer returned pending. Must be called from the thread of the socket
+     * (ie. through asio::post).
+     */
+    void resume_chunked_response();
+
+    /*!
+     * Called for every received request. Pipelined requests are handled one at a time: the next request is only passed
+     * on after respond() was called for the current one, so replies are always sent in the order of the requests.
+     * respond() may be called after this method returns; however the headers and content of the request are only
+     * valid during this call.
+     */
     virtual void on_http_request(const request &request) = 0;
 
+    /*!
+     * Called for every piece of the content of a request when streaming request content is enabled; in that case
+     * on_http_request is called as soon as the headers are received, with empty content. A reply may be given before
+     * all content was received. Any data is only valid during this call.
+     */
+    virtual void on_http_request_content(const std::span<const std::byte> content, const bool last);
+
+    /*!
+     * Pass the content of requests to on_http_request_content as it is received instead of buffering it. This
+     * applies from the next request on.
+     */
+    void set_stream_request_content(const bool stream) noexcept;
+
+    /*!
+     * The maximum size of the content of a request when streaming request content is enabled.
+     */
+    void set_max_streamed_request_content_length(const std::size_t max_content_length) noexcept;
+
+    /*!
+     * Close the connection if no complete request was received within the given time after connecting or after the
+     * last reply. A timeout of zero disables this.
+     */
+    void set_keep_alive_timeout(const std::chrono::steady_clock::duration timeout);
+
+    /*!
+     * Close the connection after the given amount of requests were handled. A value of zero means no limit.
+     */
+    void set_max_keep_alive_requests(const std::size_t max_requests) noexcept;
+
+    /*!
+     * Compress replies given through respond() for clients that accept it. Compression runs on a separate thread pool,
+     * so the reply is sent after respond() returns. Only content types that benefit from it are compressed. Replies are
+     * not compressed by default.
+     */
+    void set_reply_compression(const reply_compression_settings &settings) noexcept;
+
 private:
+    void on_started() final;
     void on_data(const std::span<const std::byte> &data) override;
+    void on_send_complete() override;
 
-    auto __on_line(const common::string &line) -> status_code;
-
-    auto __parse_expected_content_length_and_type() -> status_code;
+    void __process(const std::span<const std::byte> data);
+    [[nodiscard]] auto __process_content(const std::span<const std::byte> data) -> std::size_t;
+    void __resume();
+    void __dispatch_request();
+    void __fail(const status_code code);
 
-    auto __enter_parse_body_state() -> status_code;
-    void __enter_reply_state();
+    [[nodiscard]] auto __format_reply_header(const status_code code, const common::string &headers,
+                                             const std::optional<std::uint64_t> content_length) const
+        -> std::vector<std::byte>;
+    void __send_reply(const status_code code, const common::string &headers, std::vector<std::byte> data);
+    void __send_compressed_reply(const status_code code, common::string headers, std::vector<std::byte> data);
+    void __finish_reply();
+    void __produce_chunk();
 
-    auto __handle_read_method_state(const common::string &line) -> status_code;
-    auto __handle_read_headers_state(const common::string &line) -> status_code;
+    void __start_keep_alive_timer();
+    void __on_keep_alive_timeout();
 
     void __reset_state();
 
     http_state state_;
     request request_;
-    streams::aggregate_device<streams::circular_buffer_filter, streams::memory_device<std::vector<char>>>
-        circular_buffer_;
-    std::streamoff expected_content_length_;
+    request_parser parser_;
+
+    // Data of pipelined requests that was received while waiting for a reply.
+    std::vector<std::byte> pending_data_;
+    bool dispatching_;
+    bool close_after_reply_;
+
+    // The content of a streamed request is still being received.
+    bool receiving_content_;
+
+    // The producer of a chunked response that is in progress.
+    chunk_producer chunk_producer_;
+    bool chunk_pending_;
+
+    reply_compression_settings compression_;
+
+    // The encoding that the client accepts for the reply to the current request.
+    content_encoding accepted_encoding_;
+
+    asio::steady_timer keep_alive_timer_;
+    std::chrono::steady_clock::duration keep_alive_timeout_;
+    std::size_t max_keep_alive_requests_;
+    std::size_t request_count_;
 };
 
 } // namespace aeon::web::http
@@ -21,4 +21,15 @@ enum class http_method
 
 [[nodiscard]] auto string_to_method(const common::string_view &str) noexcept -> http_method;
 
+/*!
+ * Returns the method as it is used in a request line (ie. "GET"), or an empty string for invalid.
+ */
+[[nodiscard]] auto method_to_string(const http_method method) noexcept -> common::string_view;
+
+/*!
+ * Returns true if sending the request multiple times has the same effect as sending it once; see RFC 7231 section
+ * 4.2.2. Only such requests may be retried automatically.
+ */
+[[nodiscard]] auto is_idempotent_method(const http_method method) noexcept -> bool;
+
 } // namespace aeon::web::http
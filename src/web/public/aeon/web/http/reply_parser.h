@@ -0,0 +1,172 @@
+// Distributed under the BSD 2-Clause License - Copyright 2012-2023 Robin Degen
+
+#pragma once
+
+#include <aeon/web/http/request_parser.h>
+#include <aeon/web/http/status_code.h>
+#include <aeon/web/http/constants.h>
+#include <aeon/web/http/chunked_decoder.h>
+#include <aeon/common/string_view.h>
+#include <string_view>
+#include <optional>
+#include <vector>
+#include <array>
+#include <span>
+#include <cstddef>
+#include <cstdint>
+
+namespace aeon::web::http
+{
+
+enum class reply_parser_result
+{
+    incomplete,
+    complete,
+    error
+};
+
+/*!
+ * An incremental HTTP/1.1 reply parser; the client side counterpart of request_parser. Data is fed to parse() as it is
+ * received; parsing resumes where the previous call left off.
+ *
+ * Like the request parser, a reply that is received in a single piece is parsed in place. Only when a reply is split
+ * over multiple calls to parse(), the partial reply is copied into an internal buffer, which is kept between replies.
+ * Headers and content are views into the given data or the internal buffer; they are only valid until the next call
+ * to parse(), finish() or reset().
+ *
+ * The length of the content is determined as described in RFC 7230 section 3.3.3: replies to HEAD requests and 1xx,
+ * 204 and 304 replies have none. Otherwise chunked transfer encoding or a Content-Length is used. If neither is given,
+ * the content ends when the server closes the connection; see finish(). Interim (1xx) replies (ie. 100 Continue) are
+ * skipped; the parser only completes on the final reply that follows them, and consumed() includes them.
+ */
+class reply_parser final
+{
+    enum class parser_state
+    {
+        status_line,
+        headers,
+        content,
+        complete,
+        error
+    };
+
+    struct text_span
+    {
+        std::uint32_t offset = 0;
+        std::uint32_t size = 0;
+    };
+
+    struct header_span
+    {
+        text_span name;
+        text_span value;
+    };
+
+public:
+    explicit reply_parser(const std::size_t max_header_size = detail::max_reply_header_size,
+                          const std::size_t max_content_length = detail::max_reply_content_length);
+
+    ~reply_parser() = default;
+
+    reply_parser(reply_parser &&) noexcept = default;
+    auto operator=(reply_parser &&) noexcept -> reply_parser & = default;
+
+    reply_parser(const reply_parser &) = delete;
+    auto operator=(const reply_parser &) -> reply_parser & = delete;
+
+    /*!
+     * Parse the given data. When this returns complete, consumed() returns how many bytes of the given data belong to
+     * the parsed reply. Any data after that (ie. the reply to a pipelined request) must be given again after calling
+     * reset().
+     */
+    [[nodiscard]] auto parse(const std::span<const std::byte> data) -> reply_parser_result;
+
+    /*!
+     * Must be called when the connection was closed. Completes a reply of which the content is delimited by closing
+     * the connection. Returns error if a reply was only partially received, and incomplete if nothing was received.
+     */
+    [[nodiscard]] auto finish() -> reply_parser_result;
+
+    /*!
+     * Prepare the parser for the next reply. The internal buffers are cleared, but their memory is kept.
+     */
+    void reset() noexcept;
+
+    /*!
+     * Must be set before parsing the reply to a HEAD request, since such a reply has headers describing content that is
+     * not sent. Cleared by reset().
+     */
+    void set_head_request(const bool head_request) noexcept;
+
+    /*!
+     * Returns true if no data of a new reply was received yet.
+     */
+    [[nodiscard]] auto is_idle() const noexcept -> bool;
+
+    /*!
+     * The amount of bytes of the data given in the last call to parse() that belong to the completed reply.
+     */
+    [[nodiscard]] auto consumed() const noexcept -> std::size_t;
+
+    /*!
+     * Returns true if the connection can be used for further requests after this reply.
+     */
+    [[nodiscard]] auto is_keep_alive() const noexcept -> bool;
+
+    [[nodiscard]] auto get_status_code() const noexcept -> status_code;
+    [[nodiscard]] auto get_reason() const noexcept -> common::string_view;
+    [[nodiscard]] auto get_headers() const noexcept -> std::span<const http_header>;
+    [[nodiscard]] auto get_content() const noexcept -> std::span<const std::byte>;
+
+private:
+    [[nodiscard]] auto parse_window(const std::string_view text) -> reply_parser_result;
+    [[nodiscard]] auto parse_content(const std::span<const std::byte> data) -> reply_parser_result;
+    [[nodiscard]] auto is_decoding_content() const noexcept -> bool;
+    [[nodiscard]] auto parse_status_line(const std::string_view text, const std::string_view line)
+        -> reply_parser_result;
+    [[nodiscard]] auto parse_header_line(const std::string_view text, const std::string_view line)
+        -> reply_parser_result;
+    [[nodiscard]] auto is_interim() const noexcept -> bool;
+    void discard_interim();
+    void begin_content(const std::size_t content_offset);
+    [[nodiscard]] auto fail() noexcept -> reply_parser_result;
+    [[nodiscard]] auto to_string_view(const text_span &span) const noexcept -> common::string_view;
+    void finalize_headers(const std::string_view text) noexcept;
+    void finalize(const std::string_view text) noexcept;
+
+    std::size_t max_header_size_;
+    std::size_t max_content_length_;
+    bool head_request_;
+
+    parser_state state_;
+    std::vector<std::byte> buffer_;
+    std::size_t consumed_;
+
+    // All offsets are relative to the start of the reply.
+    std::size_t scan_offset_;
+    std::size_t line_start_;
+    std::size_t content_offset_;
+    std::optional<std::size_t> content_length_;
+
+    bool http_1_0_;
+    bool connection_close_;
+    bool connection_keep_alive_;
+
+    // Chunked content, or content that ends when the connection is closed.
+    bool chunked_;
+    bool until_close_;
+    detail::chunked_decoder chunked_decoder_;
+    std::vector<std::byte> content_buffer_;
+
+    status_code status_code_;
+    text_span reason_span_;
+    std::array<header_span, detail::max_reply_headers> header_spans_;
+    std::size_t header_count_;
+
+    // Only filled in once the headers are complete.
+    const std::byte *base_;
+    std::array<http_header, detail::max_reply_headers> headers_;
+    std::span<const std::byte> content_;
+};
+
+} // namespace aeon::web::http
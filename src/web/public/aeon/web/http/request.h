@@ -3,20 +3,37 @@
 #pragma once
 
 #include <aeon/web/http/method.h>
-#include <aeon/streams/devices/memory_device.h>
+#include <aeon/web/http/request_parser.h>
 #include <aeon/common/string.h>
+#include <aeon/common/string_view.h>
+#include <optional>
 #include <vector>
+#include <span>
 #include <map>
 
 namespace aeon::web::http
 {
 
+/*!
+ * The value of a path parameter of a route (ie. "id" for a route mounted on "/users/:id").
+ */
+struct path_parameter
+{
+    common::string_view name;
+    common::string_view value;
+};
+
+/*!
+ * A received HTTP request. The headers and content are views into the receive buffer of the socket, and are only valid
+ * during the call to on_http_request. Copy them if they are needed afterwards.
+ */
 class request
 {
     friend class http_server_socket;
 
 public:
     explicit request(const http_method method);
+    explicit request(const http_method method, common::string uri);
     explicit request(const common::string &method, common::string uri);
 
     auto get_method() const noexcept
@@ -24,7 +41,7 @@ public:
         return method_;
     }
 
-    auto get_uri() const
+    auto get_uri() const noexcept -> const common::string &
     {
         return uri_;
     }
@@ -36,33 +53,59 @@ public:
 
     auto get_content_length() const
     {
-        return content_.size();
+        return std::size(content_);
     }
 
     auto has_content() const
     {
-        return content_.size() != 0;
+        return !std::empty(content_);
     }
 
+    /*!
+     * Get a copy of the content.
+     */
     auto get_content() const -> std::vector<std::uint8_t>;
 
+    /*!
+     * Get a copy of the content as a string.
+     */
     auto get_content_string() const -> common::string;
 
-    auto get_content_type() const -> common::string;
+    [[nodiscard]] auto get_content_view() const noexcept -> std::span<const std::byte>;
+
+    [[nodiscard]] auto get_content_type() const noexcept -> common::string_view;
+
+    [[nodiscard]] auto get_headers() const noexcept -> std::span<const http_header>;
 
-    auto get_raw_headers() const -> const std::vector<common::string> &;
+    /*!
+     * Find a header by name (case insensitive).
+     */
+    [[nodiscard]] auto find_header(const common::string_view &name) const noexcept
+        -> std::optional<common::string_view>;
+
+    /*!
+     * The path parameters of the route that handles this request. Like the headers, these are only valid during the
+     * call to on_http_request.
+     */
+    [[nodiscard]] auto get_path_parameters() const noexcept -> std::span<const path_parameter>;
+
+    /*!
+     * Find a path parameter by name.
+     */
+    [[nodiscard]] auto find_path_parameter(const common::string_view &name) const noexcept
+        -> std::optional<common::string_view>;
+
+    void set_path_parameters(const std::span<const path_parameter> parameters) noexcept;
 
 private:
-    void append_raw_http_header_line(const common::string &header_line);
-    void append_raw_content_data(const std::vector<std::byte> &data) const;
-    void set_content_type(const common::string &content_type);
+    void set_headers(const std::span<const http_header> headers) noexcept;
+    void set_content(const std::span<const std::byte> content) noexcept;
 
     http_method method_;
     common::string uri_;
-    std::vector<common::string> raw_headers_;
-
-    common::string content_type_;
-    mutable streams::memory_device<std::vector<char>> content_;
+    std::span<const http_header> headers_;
+    std::span<const std::byte> content_;
+    std::span<const path_parameter> path_parameters_;
 };
 
 auto parse_raw_http_headers(const std::vector<common::string> &raw_headers) -> std::map<common::string, common::string>;
@@ -0,0 +1,206 @@
+// Distributed under the BSD 2-Clause License - Copyright 2012-2023 Robin Degen
+
+#pragma once
+
+#include <aeon/web/http/method.h>
+#include <aeon/web/http/status_code.h>
+#include <aeon/web/http/constants.h>
+#include <aeon/web/http/chunked_decoder.h>
+#include <aeon/common/string_view.h>
+#include <string_view>
+#include <string>
+#include <optional>
+#include <vector>
+#include <array>
+#include <span>
+#include <cstddef>
+#include <cstdint>
+
+namespace aeon::web::http
+{
+
+/*!
+ * A single HTTP header. The name and value are views into the data that the request was parsed from.
+ */
+struct http_header
+{
+    common::string_view name;
+    common::string_view value;
+};
+
+/*!
+ * Find a header by name (case insensitive).
+ */
+[[nodiscard]] auto find_http_header(const std::span<const http_header> headers,
+                                    const common::string_view &name) noexcept -> std::optional<common::string_view>;
+
+enum class request_parser_result
+{
+    incomplete,
+    complete,
+    error,
+
+    // Only when streaming content: the request line and headers were parsed; the content follows.
+    headers_complete,
+
+    // Only when streaming content: a piece of the content was parsed. See get_content().
+    content
+};
+
+/*!
+ * An incremental HTTP/1.1 request parser. Data is fed to parse() as it is received; parsing resumes where the
+ * previous call left off.
+ *
+ * If a request is received in a single piece, it is parsed in place and nothing is copied. Only when a request is split
+ * over multiple calls to parse(), the partial request is copied into an internal buffer. This buffer is kept between
+ * requests, so after the first few requests no more allocations take place.
+ *
+ * The target, headers and content of a parsed request are views into the given data or the internal buffer. They are
+ * only valid until the next call to parse() or reset().
+ *
+ * Content is either given with a Content-Length or with chunked transfer encoding. Chunked content is decoded into a
+ * separate buffer. When streaming content is enabled, the content is never buffered at all. Instead parse() returns
+ * headers_complete once the headers are parsed, and then content for every piece of the content that is received.
+ * The last piece is returned along with complete. In both cases the headers are copied into the internal buffer, so
+ * that they remain valid until the request is complete.
+ */
+class request_parser final
+{
+    enum class parser_state
+    {
+        request_line,
+        headers,
+        content,
+        complete,
+        error
+    };
+
+    struct text_span
+    {
+        std::uint32_t offset = 0;
+        std::uint32_t size = 0;
+    };
+
+    struct header_span
+    {
+        text_span name;
+        text_span value;
+    };
+
+public:
+    explicit request_parser(const std::size_t max_header_size = detail::max_request_header_size,
+                            const std::size_t max_content_length = detail::max_request_content_length);
+
+    ~request_parser() = default;
+
+    request_parser(request_parser &&) noexcept = default;
+    auto operator=(request_parser &&) noexcept -> request_parser & = default;
+
+    request_parser(const request_parser &) = delete;
+    auto operator=(const request_parser &) -> request_parser & = delete;
+
+    /*!
+     * Parse the given data. When this returns complete, consumed() returns how many bytes of the given data belong to
+     * the parsed request. Any data after that (ie. a pipelined request) must be given again after calling reset().
+     * When this returns error, the reason can be retrieved through get_error().
+     */
+    [[nodiscard]] auto parse(const std::span<const std::byte> data) -> request_parser_result;
+
+    /*!
+     * Prepare the parser for the next request. The internal buffer is cleared, but its memory is kept.
+     */
+    void reset() noexcept;
+
+    /*!
+     * Pass the content on in pieces as it is received instead of buffering it. This is applied from the next request
+     * on.
+     */
+    void set_stream_content(const bool stream) noexcept;
+
+    /*!
+     * The maximum size of the content when it is streamed. Since streamed content is never buffered, this is usually
+     * much larger than the limit for buffered content given in the constructor.
+     */
+    void set_max_streamed_content_length(const std::size_t max_content_length) noexcept;
+
+    /*!
+     * Returns true if the content of the current request uses chunked transfer encoding.
+     */
+    [[nodiscard]] auto is_chunked() const noexcept -> bool;
+
+    /*!
+     * Returns true if no data of a new request was received yet.
+     */
+    [[nodiscard]] auto is_idle() const noexcept -> bool;
+
+    /*!
+     * The amount of bytes of the data given in the last call to parse() that belong to the completed request.
+     */
+    [[nodiscard]] auto consumed() const noexcept -> std::size_t;
+
+    /*!
+     * The status code that should be sent back to the client if parsing failed.
+     */
+    [[nodiscard]] auto get_error() const noexcept -> status_code;
+
+    [[nodiscard]] auto get_method() const noexcept -> http_method;
+    [[nodiscard]] auto get_method_string() const noexcept -> common::string_view;
+    [[nodiscard]] auto get_target() const noexcept -> common::string_view;
+    [[nodiscard]] auto get_headers() const noexcept -> std::span<const http_header>;
+    [[nodiscard]] auto get_content() const noexcept -> std::span<const std::byte>;
+
+private:
+    [[nodiscard]] auto parse_window(const std::string_view text) -> request_parser_result;
+    [[nodiscard]] auto parse_content(const std::span<const std::byte> data) -> request_parser_result;
+    [[nodiscard]] auto decode_content(const std::span<const std::byte> data, std::size_t &used,
+                                      std::span<const std::byte> &piece) -> detail::chunked_decoder_result;
+    [[nodiscard]] auto is_decoding_content() const noexcept -> bool;
+    [[nodiscard]] auto get_max_content_length() const noexcept -> std::size_t;
+    [[nodiscard]] auto find_line_end(const std::string_view text, std::size_t &line_end, std::size_t &next_line)
+        -> request_parser_result;
+    [[nodiscard]] auto parse_request_line(const std::string_view text, const std::string_view line)
+        -> request_parser_result;
+    [[nodiscard]] auto parse_header_line(const std::string_view text, const std::string_view line)
+        -> request_parser_result;
+    void reserve_content();
+    [[nodiscard]] auto fail(const status_code code) noexcept -> request_parser_result;
+    [[nodiscard]] auto to_string_view(const text_span &span) const noexcept -> common::string_view;
+    void finalize_headers(const std::string_view text) noexcept;
+    void finalize(const std::string_view text) noexcept;
+
+    std::size_t max_header_size_;
+    std::size_t max_content_length_;
+    std::size_t max_streamed_content_length_;
+    bool stream_content_;
+    bool next_stream_content_;
+
+    parser_state state_;
+    status_code error_;
+    std::vector<std::byte> buffer_;
+    std::size_t consumed_;
+
+    // All offsets are relative to the start of the request.
+    std::size_t scan_offset_;
+    std::size_t line_start_;
+    std::size_t content_offset_;
+    std::optional<std::size_t> content_length_;
+
+    // Chunked or streamed content
+    bool chunked_;
+    detail::chunked_decoder chunked_decoder_;
+    std::size_t content_remaining_;
+    std::vector<std::byte> content_buffer_;
+
+    http_method method_;
+    text_span method_span_;
+    text_span target_span_;
+    std::array<header_span, detail::max_request_headers> header_spans_;
+    std::size_t header_count_;
+
+    // Only filled in once the headers are complete.
+    const std::byte *base_;
+    std::array<http_header, detail::max_request_headers> headers_;
+    std::span<const std::byte> content_;
+};
+
+} // namespace aeon::web::http
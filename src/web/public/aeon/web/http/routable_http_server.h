@@ -5,10 +5,17 @@
 #include <aeon/web/http/routable_http_server_socket.h>
 #include <aeon/web/http/routable_http_server_session.h>
 #include <aeon/sockets/tcp_server.h>
+#include <aeon/sockets/tcp_server_pool.h>
 
 namespace aeon::web::http
 {
 
 using routable_http_server = sockets::tcp_server<routable_http_server_socket, routable_http_server_session>;
 
+/*!
+ * A routable http server with a thread (and io_context) per core. See sockets::tcp_server_pool.
+ */
+using routable_http_server_pool =
+    sockets::tcp_server_pool<routable_http_server_socket, routable_http_server_session>;
+
 } // namespace aeon::web::http
@@ -5,31 +5,114 @@
 #include <aeon/web/http/http_server_socket.h>
 #include <aeon/web/http/route.h>
 #include <aeon/web/http/http_server_session.h>
+#include <aeon/web/http/router.h>
+#include <aeon/web/http/method.h>
 #include <aeon/common/string.h>
+#include <optional>
 #include <memory>
+#include <vector>
+#include <atomic>
+#include <mutex>
+#include <cstdint>
 
 namespace aeon::web::http
 {
 
+/*!
+ * A session that dispatches requests to routes by their mount point.
+ *
+ * The route table is safe to use from multiple threads (see sockets::tcp_server_pool). The table is immutable; adding
+ * or removing routes publishes a new table with a new version. Every thread keeps its own reference to the table it
+ * last used, and only checks the version of the session when looking up a route. So a lookup takes no lock and does
+ * not touch memory that other threads write to, unless the routes were changed since the previous lookup on that
+ * thread.
+ *
+ * A previous table (and any route that was removed) is freed once every thread has moved on to a newer table and the
+ * last request that found a route in it is done with it; see route_match::routes. This makes changing the routes
+ * relatively expensive; it is meant to happen mostly up front.
+ */
 class routable_http_server_session final : public http_server_session
 {
+    struct route_entry
+    {
+        std::shared_ptr<route> value;
+        std::optional<http_method> method;
+    };
+
+    /*!
+     * An immutable snapshot of the routes. It shares ownership of its routes, so that a route that is removed stays
+     * alive while a request that was routed to it is still being handled.
+     */
+    struct route_table
+    {
+        router value;
+        std::vector<std::shared_ptr<route>> routes;
+    };
+
+    /*!
+     * A thread's own reference to the route table of a session. It has its own reference count, so that matches found
+     * on a thread share ownership of the table without touching a reference count that is used by other threads.
+     */
+    struct cached_table
+    {
+        const routable_http_server_session *session = nullptr;
+        std::uint64_t version = 0;
+        std::shared_ptr<const route_table> table;
+    };
+
 public:
     explicit routable_http_server_session();
     ~routable_http_server_session() final;
 
-    routable_http_server_session(routable_http_server_session &&) = default;
-    auto operator=(routable_http_server_session &&) -> routable_http_server_session & = default;
+    routable_http_server_session(routable_http_server_session &&) = delete;
+    auto operator=(routable_http_server_session &&) -> routable_http_server_session & = delete;
 
     routable_http_server_session(const routable_http_server_session &) = delete;
     auto operator=(const routable_http_server_session &) -> routable_http_server_session & = delete;
 
-    void add_route(std::unique_ptr<route> route);
+    /*!
+     * Add a route that handles all methods. The mount point may contain path parameters (ie. "/users/:id"); see
+     * router. Returns false if a route was already registered on the same mount point.
+     */
+    auto add_route(std::unique_ptr<route> route) -> bool;
+
+    /*!
+     * Add a route that only handles the given method. Returns false if a route was already registered on the same mount
+     * point for this method.
+     */
+    auto add_route(const http_method method, std::unique_ptr<route> route) -> bool;
+
     void remove_route(const common::string &mountpoint);
 
-    auto find_best_match_route(const common::string &path, common::string &route_path) const -> route *;
+    /*!
+     * Find the route for a path and method. See router::find. The match keeps the route alive, even if it is removed
+     * in the mean time. This only allocates and locks for the first lookup on a thread after the routes were changed.
+     */
+    [[nodiscard]] auto find_route(const std::string_view path, const http_method method, route_match &match) const
+        -> bool;
+
+    /*!
+     * Find the route for a path. The returned pointer keeps the route alive, even if it is removed in the mean time.
+     */
+    auto find_best_match_route(const common::string &path, common::string &route_path) const
+        -> std::shared_ptr<route>;
 
 private:
-    std::map<common::string, std::unique_ptr<route>> routes_;
+    auto insert_route(const std::optional<http_method> method, std::unique_ptr<route> route) -> bool;
+    [[nodiscard]] auto build_table(const route_entry *additional_entry) const -> std::shared_ptr<route_table>;
+    void publish_table(std::shared_ptr<const route_table> table);
+
+    [[nodiscard]] auto get_cached_table() const -> const std::shared_ptr<const route_table> &;
+    [[nodiscard]] static auto get_thread_cache() -> std::vector<cached_table> &;
+
+    // Used when changing the routes, and by a thread to get the table after the routes were changed.
+    mutable std::mutex mutex_;
+    std::vector<route_entry> routes_;
+    std::shared_ptr<const route_table> table_;
+
+    // The version of table_. Versions are unique over all sessions, so that a cached table can not be mistaken for the
+    // table of a session that was created at the same address as one that was destroyed.
+    std::atomic<std::uint64_t> version_;
 };
 
 } // namespace aeon::web::http
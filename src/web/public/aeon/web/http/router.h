@@ -0,0 +1,98 @@
+// Distributed under the BSD 2-Clause License - Copyright 2012-2023 Robin Degen
+
+#pragma once
+
+#include <aeon/web/http/method.h>
+#include <aeon/web/http/request.h>
+#include <aeon/web/http/constants.h>
+#include <aeon/common/string_view.h>
+#include <optional>
+#include <memory>
+#include <array>
+#include <span>
+#include <cstddef>
+
+namespace aeon::web::http
+{
+
+class route;
+
+/*!
+ * The result of a router lookup.
+ */
+struct route_match final
+{
+    [[nodiscard]] auto get_parameters() const noexcept -> std::span<const path_parameter>
+    {
+        return std::span{std::data(parameters), parameter_count};
+    }
+
+    // The matched route; or null if nothing matched.
+    route *matched_route = nullptr;
+
+    // True if nothing matched, but a route matched the path for another method.
+    bool method_not_allowed = false;
+
+    // The part of the path after the matched mount point.
+    std::string_view remaining_path;
+
+    // The values of the path parameters; views into the path that was looked up.
+    std::array<path_parameter, detail::max_path_parameters> parameters{};
+    std::size_t parameter_count = 0;
+
+    // Keeps the matched route alive while the match is used, when the routes can be changed from another thread (see
+    // routable_http_server_session). Not set by router::find itself.
+    std::shared_ptr<const void> routes;
+};
+
+/*!
+ * A compressed radix tree (trie) of routes by mount point.
+ *
+ * Mount points are prefixes: the route with the longest mount point that matches the start of the path is found.
+ * A mount point that only has routes for other methods is skipped, so a shorter mount point that accepts the method
+ * (ie. a static route on "/" below a POST only "/api") is used instead.
+ * A segment of a mount point that starts with ':' (ie. "/users/:id") is a path parameter; it matches a single segment
+ * of the path, up to the next '/'. Static segments take precedence over parameters.
+ *
+ * Routes can be registered for a specific method or for all methods. Looking up a route does not allocate.
+ */
+class router final
+{
+    struct node;
+
+public:
+    router();
+    ~router();
+
+    router(router &&) noexcept;
+    auto operator=(router &&) noexcept -> router &;
+
+    router(const router &) = delete;
+    auto operator=(const router &) -> router & = delete;
+
+    /*!
+     * Add a route for the given mount point. If no method is given, the route is used for all methods that do not have
+     * a route of their own. Returns false if a route was already registered for the same mount point and method, or if
+     * a path parameter with a different name was already registered at the same position.
+     */
+    [[nodiscard]] auto insert(const std::string_view mount_point, const std::optional<http_method> method,
+                              route *value) -> bool;
+
+    /*!
+     * Remove all routes from the given mount point.
+     */
+    void erase(const std::string_view mount_point) noexcept;
+
+    /*!
+     * Find the best matching route for a path. Returns false if no route matched.
+     */
+    [[nodiscard]] auto find(const std::string_view path, const http_method method, route_match &match) const noexcept
+        -> bool;
+
+private:
+    [[nodiscard]] auto find_node(const std::string_view mount_point) const noexcept -> node *;
+
+    std::unique_ptr<node> root_;
+};
+
+} // namespace aeon::web::http
@@ -4,15 +4,24 @@
 
 #include <aeon/web/http/route.h>
 #include <aeon/web/http/constants.h>
+#include <aeon/web/http/content_encoding.h>
 #include <aeon/common/string.h>
 #include <filesystem>
+#include <chrono>
+#include <memory>
 #include <vector>
 
 namespace aeon::web::http
 {
 
+class request;
+
 namespace detail
 {
+class static_file_cache;
+struct static_file;
+struct static_file_variant;
+
 auto to_url_path(const common::string &path) -> common::string;
 auto is_image_extension(const common::string &extension) -> bool;
 } // namespace detail
@@ -41,6 +50,23 @@ struct static_route_settings final
 
     // Files that should not be displayed when listing a directory.
     std::vector<common::string> hidden_files = detail::hidden_files;
+
+    // The maximum total size of the files that are kept in memory. The least recently requested files are evicted
+    // first.
+    std::size_t cache_size = detail::default_static_cache_size;
+
+    // Files larger than this are never kept in memory. Where supported they are sent with sendfile instead.
+    std::size_t max_cached_file_size = detail::default_max_static_cached_file_size;
+
+    // Cached files are checked for changes on disk at most once per interval.
+    std::chrono::steady_clock::duration cache_revalidate_interval = detail::default_static_cache_revalidate_interval;
+
+    // Serve a precompressed variant of a file (ie. index.html.gz next to index.html) to clients that accept gzip.
+    bool enable_precompressed = true;
+
+    // Compress files that are kept in memory and have no precompressed variant, if enabled. The compressed variant is
+    // cached along with the file.
+    reply_compression_settings compression;
 };
 
 class static_route final : public route
@@ -70,8 +96,9 @@ private:
 
     [[nodiscard]] auto get_path_for_default_files(const std::filesystem::path &path) const -> std::filesystem::path;
 
-    void reply_file(http_server_socket &source, routable_http_server_session &session,
-                    const std::filesystem::path &file) const;
+    void reply_file(http_server_socket &source, const request &request, const detail::static_file &file) const;
+    void reply_variant(http_server_socket &source, const request &request,
+                       const detail::static_file_variant &variant) const;
     void reply_folder(http_server_socket &source, routable_http_server_session &session,
                       const std::filesystem::path &path) const;
 
@@ -85,6 +112,7 @@ private:
 
     std::filesystem::path base_path_;
     static_route_settings settings_;
+    std::shared_ptr<detail::static_file_cache> cache_;
 };
 
 } // namespace aeon::web::http
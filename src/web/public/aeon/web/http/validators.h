@@ -2,12 +2,12 @@
 
 #pragma once
 
-#include <aeon/common/string.h>
+#include <aeon/common/string_view.h>
 
 namespace aeon::web::http::detail
 {
 
-auto validate_http_version_string(const common::string &version_string) noexcept -> bool;
-auto validate_uri(const common::string &uri) noexcept -> bool;
+auto validate_http_version_string(const common::string_view &version_string) noexcept -> bool;
+auto validate_uri(const common::string_view &uri) noexcept -> bool;
 
 } // namespace aeon::web::http::detail
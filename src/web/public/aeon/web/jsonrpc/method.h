@@ -15,7 +15,19 @@ class method
 public:
     using signature = std::function<result(const ptree::property_tree &)>;
 
+    /*!
+     * Must be called exactly once when the method is done, from any thread.
+     */
+    using result_handler = std::function<void(result)>;
+
+    /*!
+     * A method that completes later, for example when it has to wait for I/O. The params are only valid until the
+     * method returns; they must be copied if they are needed after that.
+     */
+    using async_signature = std::function<void(const ptree::property_tree &, result_handler)>;
+
     method(common::string name, signature func);
+    method(common::string name, async_signature func);
     ~method() = default;
 
     method(method &&) noexcept = default;
@@ -25,11 +37,23 @@ public:
     auto operator=(const method &) -> method & = default;
 
     [[nodiscard]] auto name() const noexcept -> const common::string &;
+    [[nodiscard]] auto is_async() const noexcept -> bool;
+
+    /*!
+     * Call a method that is not async.
+     */
     auto operator()(const ptree::property_tree &params) const -> result;
 
+    /*!
+     * Call the method, regardless of whether it is async or not. The handler is called directly for methods that
+     * are not async.
+     */
+    void operator()(const ptree::property_tree &params, result_handler handler) const;
+
 private:
     common::string name_;
     signature func_;
+    async_signature async_func_;
 };
 
 } // namespace aeon::web::jsonrpc
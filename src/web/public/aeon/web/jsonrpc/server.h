@@ -6,16 +6,46 @@
 #include <aeon/web/jsonrpc/result.h>
 #include <aeon/ptree/ptree.h>
 #include <aeon/common/string.h>
-#include <map>
+#include <aeon/common/string_hash.h>
+#include <unordered_map>
+#include <functional>
+#include <memory>
+#include <vector>
+#include <cstddef>
 
 namespace aeon::web::jsonrpc
 {
 
 auto respond(const result &result) -> ptree::property_tree;
 
+/*!
+ * Serialize a response as json by appending it to the given buffer.
+ */
+void respond(const result &result, std::vector<std::byte> &buffer);
+
+struct batch_settings final
+{
+    /*!
+     * Execute the requests of a batch in parallel on a thread pool that is shared by all servers. All methods must be
+     * thread safe when this is enabled.
+     */
+    bool parallel = false;
+
+    /*!
+     * Smaller batches are executed on the calling thread, since handing them off costs more than it saves.
+     */
+    std::size_t min_parallel_size = 4;
+};
+
 class server
 {
 public:
+    /*!
+     * Called with the serialized json response. May be called from any thread when batches are executed in parallel
+     * or when async methods are used.
+     */
+    using response_handler = std::function<void(std::vector<std::byte>)>;
+
     server() = default;
     ~server() = default;
 
@@ -27,14 +57,29 @@ public:
 
     void register_method(const method &method);
 
+    void set_batch_settings(const batch_settings &settings) noexcept;
+
+    /*!
+     * Handle a request or batch of requests without blocking on async methods. The server must outlive the request.
+     */
+    void request_async(const common::string &str, response_handler handler) const;
+
+    /*!
+     * Handle a request or batch of requests, and block until all of them are done. Async methods may complete inline on
+     * the calling thread, but must not depend on it to complete; for example by posting their completion to an
+     * io_context that is run by the calling thread. That deadlocks, since the thread is blocked until they complete.
+     */
     [[nodiscard]] auto request(const common::string &str) const -> common::string;
     [[nodiscard]] auto request(const ptree::property_tree &request) const -> ptree::property_tree;
 
 private:
-    [[nodiscard]] auto handle_requests(const ptree::property_tree &request) const -> std::vector<result>;
-    [[nodiscard]] auto handle_single_rpc_request(const ptree::property_tree &request) const -> result;
+    using results_handler = std::function<void(std::vector<result>, bool)>;
+
+    void handle_requests(std::shared_ptr<const ptree::property_tree> request, results_handler handler) const;
+    void handle_single_rpc_request(const ptree::property_tree &request, method::result_handler handler) const;
 
-    std::map<common::string, method> methods_;
+    std::unordered_map<common::string, method, common::string_hash, std::equal_to<>> methods_;
+    batch_settings batch_settings_;
 };
 
 } // namespace aeon::web::jsonrpc
@@ -0,0 +1,81 @@
+// Distributed under the BSD 2-Clause License - Copyright 2012-2023 Robin Degen
+
+#include <aeon/web/http/content_encoding.h>
+#include <aeon/compression/zlib.h>
+#include <gtest/gtest.h>
+#include <string>
+
+using namespace aeon;
+
+TEST(test_content_encoding, negotiate)
+{
+    using web::http::content_encoding;
+
+    EXPECT_EQ(content_encoding::gzip, web::http::negotiate_content_encoding("gzip, deflate, br"));
+    EXPECT_EQ(content_encoding::gzip, web::http::negotiate_content_encoding("deflate, GZIP"));
+    EXPECT_EQ(content_encoding::deflate, web::http::negotiate_content_encoding("deflate"));
+    EXPECT_EQ(content_encoding::deflate, web::http::negotiate_content_encoding("gzip;q=0.5, deflate"));
+    EXPECT_EQ(content_encoding::deflate, web::http::negotiate_content_encoding("gzip;q=0, *"));
+    EXPECT_EQ(content_encoding::gzip, web::http::negotiate_content_encoding("*"));
+    EXPECT_EQ(content_encoding::identity, web::http::negotiate_content_encoding("br"));
+    EXPECT_EQ(content_encoding::identity, web::http::negotiate_content_encoding("gzip;q=0.000, deflate; q=0"));
+    EXPECT_EQ(content_encoding::identity, web::http::negotiate_content_encoding(""));
+
+    EXPECT_TRUE(web::http::accepts_content_encoding("deflate, gzip;q=0.1", content_encoding::gzip));
+    EXPECT_FALSE(web::http::accepts_content_encoding("deflate", content_encoding::gzip));
+    EXPECT_TRUE(web::http::accepts_content_encoding("", content_encoding::identity));
+}
+
+TEST(test_content_encoding, compressible_content_types)
+{
+    EXPECT_TRUE(web::http::is_compressible_content_type("text/html"));
+    EXPECT_TRUE(web::http::is_compressible_content_type("text/plain; charset=utf-8"));
+    EXPECT_TRUE(web::http::is_compressible_content_type("application/json"));
+    EXPECT_TRUE(web::http::is_compressible_content_type("application/ld+json"));
+    EXPECT_TRUE(web::http::is_compressible_content_type("image/svg+xml"));
+    EXPECT_FALSE(web::http::is_compressible_content_type("image/png"));
+    EXPECT_FALSE(web::http::is_compressible_content_type("application/octet-stream"));
+    EXPECT_FALSE(web::http::is_compressible_content_type("application/gzip"));
+}
+
+TEST(test_content_encoding, compress_content)
+{
+    std::string content;
+
+    for (auto i = 0; i < 200; ++i)
+        content += R"({"jsonrpc": "2.0", "result": )" + std::to_string(i) + R"(, "id": 1})";
+
+    const auto data = std::as_bytes(std::span{std::data(content), std::size(content)});
+
+    const auto gzip = web::http::compress_content(data, web::http::content_encoding::gzip,
+                                                  compression::zlib_compression_mode::fastest);
+    ASSERT_FALSE(std::empty(gzip));
+    EXPECT_LT(std::size(gzip), std::size(content) / 4);
+    EXPECT_EQ(std::byte{0x1f}, gzip[0]);
+    EXPECT_EQ(std::byte{0x8b}, gzip[1]);
+
+    const auto deflate = web::http::compress_content(data, web::http::content_encoding::deflate,
+                                                     compression::zlib_compression_mode::balanced);
+    ASSERT_FALSE(std::empty(deflate));
+
+    compression::zlib_decompress decompress;
+    std::string decompressed(std::size(content), '\0');
+    auto offset = std::size_t{0};
+
+    const auto size = decompress.read(reinterpret_cast<std::byte *>(std::data(decompressed)),
+                                      static_cast<std::streamsize>(std::size(decompressed)),
+                                      [&deflate, &offset](std::byte *buffer, const std::streamsize size)
+                                      {
+                                          const auto count = std::min(std::size(deflate) - offset,
+                                                                      static_cast<std::size_t>(size));
+                                          std::copy_n(std::data(deflate) + offset, count, buffer);
+                                          offset += count;
+                                          return static_cast<std::streamsize>(count);
+                                      });
+
+    EXPECT_EQ(static_cast<std::streamsize>(std::size(content)), size);
+    EXPECT_EQ(content, decompressed);
+
+    EXPECT_TRUE(std::empty(web::http::compress_content(data, web::http::content_encoding::identity,
+                                                       compression::zlib_compression_mode::fastest)));
+}
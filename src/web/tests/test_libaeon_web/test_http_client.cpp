@@ -0,0 +1,271 @@
+// Distributed under the BSD 2-Clause License - Copyright 2012-2023 Robin Degen
+
+#include <aeon/web/http/http_client.h>
+#include <aeon/web/http/http_server.h>
+#include <gtest/gtest.h>
+#include <asio.hpp>
+#include <thread>
+#include <string>
+#include <chrono>
+#include <vector>
+#include <future>
+#include <atomic>
+
+using namespace aeon;
+
+namespace
+{
+
+constexpr std::uint16_t test_port = 38277;
+
+// Nothing listens on this port.
+constexpr std::uint16_t test_refused_port = 38278;
+
+std::atomic<int> accepted_connections = 0;
+
+/*!
+ * Replies with the uri of the request, or with the content if there is any. Requests to "/slow" are never answered.
+ * Connections are closed by the server after 3 requests, or after 200ms of inactivity.
+ */
+class echo_server_socket final : public web::http::http_server_socket
+{
+public:
+    explicit echo_server_socket(asio::ip::tcp::socket socket, [[maybe_unused]] web::http::http_server_session &session)
+        : http_server_socket{std::move(socket)}
+    {
+        ++accepted_connections;
+        set_keep_alive_timeout(std::chrono::milliseconds{200});
+        set_max_keep_alive_requests(3);
+    }
+
+    void on_http_request(const web::http::request &request) override
+    {
+        if (request.has_content())
+        {
+            respond("text/plain", request.get_content_string());
+            return;
+        }
+
+        if (request.get_uri() == "/slow")
+            return;
+
+        if (request.get_uri() == "/chunked")
+        {
+            respond_chunked(web::http::status_code::ok, "Content-Type: text/plain\r\n",
+                            [remaining = 2](std::vector<std::byte> &chunk) mutable
+                            {
+                                if (remaining-- == 0)
+                                    return web::http::chunk_result::done;
+
+                                const std::string_view data = "chunk";
+                                const auto bytes = reinterpret_cast<const std::byte *>(std::data(data));
+                                chunk.assign(bytes, bytes + std::size(data));
+                                return web::http::chunk_result::data;
+                            });
+            return;
+        }
+
+        respond("text/plain", request.get_uri());
+    }
+};
+
+class test_http_client : public ::testing::Test
+{
+public:
+    void SetUp() override
+    {
+        accepted_connections = 0;
+        server_ = std::make_unique<web::http::http_server<echo_server_socket>>(server_context_, test_port);
+        server_thread_ = std::thread{[this]() { server_context_.run(); }};
+        client_thread_ = std::thread{[this]() { client_context_.run(); }};
+    }
+
+    void TearDown() override
+    {
+        client_work_guard_.reset();
+        client_thread_.join();
+
+        server_context_.stop();
+        server_thread_.join();
+        server_.reset();
+    }
+
+protected:
+    [[nodiscard]] static auto make_request(const std::string &uri) -> web::http::client_request
+    {
+        web::http::client_request request;
+        request.uri = uri;
+        return request;
+    }
+
+    asio::io_context client_context_;
+
+private:
+    asio::executor_work_guard<asio::io_context::executor_type> client_work_guard_{
+        asio::make_work_guard(client_context_)};
+    std::thread client_thread_;
+
+    asio::io_context server_context_;
+    std::unique_ptr<web::http::http_server<echo_server_socket>> server_;
+    std::thread server_thread_;
+};
+
+} // namespace
+
+TEST_F(test_http_client, get)
+{
+    web::http::http_client client{client_context_};
+    const auto reply = client.request("127.0.0.1", test_port, make_request("/hello")).get();
+
+    EXPECT_EQ(web::http::status_code::ok, reply.get_status_code());
+    EXPECT_EQ("/hello", reply.get_content_string());
+    EXPECT_EQ("text/plain", reply.find_header("content-type"));
+    EXPECT_FALSE(std::empty(reply.get_headers()));
+}
+
+TEST_F(test_http_client, post)
+{
+    web::http::http_client client{client_context_};
+
+    auto request = make_request("/post");
+    request.method = web::http::http_method::post;
+    request.content_type = "text/plain";
+
+    const std::string_view content = "Hello world";
+    const auto bytes = reinterpret_cast<const std::byte *>(std::data(content));
+    request.content.assign(bytes, bytes + std::size(content));
+
+    const auto reply = client.request("127.0.0.1", test_port, std::move(request)).get();
+    EXPECT_EQ("Hello world", reply.get_content_string());
+}
+
+TEST_F(test_http_client, copy_reply_in_handler)
+{
+    web::http::http_client client{client_context_};
+
+    std::promise<web::http::client_reply> result;
+    client.request_async("127.0.0.1", test_port, make_request("/view"),
+                         [&result](const std::error_code &ec, const web::http::client_reply_view &reply)
+                         {
+                             EXPECT_FALSE(ec);
+                             EXPECT_EQ("/view", reply.get_content_string());
+                             result.set_value(reply.copy());
+                         });
+
+    // The copy owns its data; the view it was made from is no longer valid.
+    const auto reply = result.get_future().get();
+    EXPECT_EQ(web::http::status_code::ok, reply.get_status_code());
+    EXPECT_EQ("/view", reply.get_content_string());
+    EXPECT_EQ("text/plain", reply.find_header("content-type"));
+}
+
+TEST_F(test_http_client, head_and_chunked)
+{
+    web::http::http_client client{client_context_};
+
+    auto request = make_request("/head");
+    request.method = web::http::http_method::head;
+
+    auto head_reply = client.request("127.0.0.1", test_port, std::move(request));
+    auto chunked_reply = client.request("127.0.0.1", test_port, make_request("/chunked"));
+
+    EXPECT_TRUE(std::empty(head_reply.get().get_content()));
+    EXPECT_EQ("chunkchunk", chunked_reply.get().get_content_string());
+}
+
+TEST_F(test_http_client, connections_are_reused)
+{
+    web::http::http_client client{client_context_};
+
+    // The server closes the connection after 3 requests.
+    for (auto i = 0; i < 3; ++i)
+        EXPECT_EQ("/reuse", client.request("127.0.0.1", test_port, make_request("/reuse")).get().get_content_string());
+
+    EXPECT_EQ(1, accepted_connections);
+
+    EXPECT_EQ("/reuse", client.request("127.0.0.1", test_port, make_request("/reuse")).get().get_content_string());
+    EXPECT_EQ(2, accepted_connections);
+}
+
+TEST_F(test_http_client, pipelined_requests)
+{
+    web::http::http_client_settings settings;
+    settings.max_connections_per_host = 2;
+    settings.max_pipelined_requests = 4;
+    web::http::http_client client{client_context_, settings};
+
+    // More requests than connections and pipeline slots combined. Since the server closes connections after 3
+    // requests, some pipelined requests are not answered and have to be sent again on a new connection.
+    std::vector<std::future<web::http::client_reply>> replies;
+
+    for (auto i = 0; i < 40; ++i)
+        replies.push_back(client.request("127.0.0.1", test_port, make_request("/" + std::to_string(i))));
+
+    for (auto i = 0; i < 40; ++i)
+        EXPECT_EQ("/" + std::to_string(i), replies[i].get().get_content_string());
+
+    EXPECT_GE(accepted_connections, 40 / 3);
+}
+
+TEST_F(test_http_client, connection_closed_by_server_while_idle)
+{
+    web::http::http_client client{client_context_};
+    EXPECT_EQ("/first", client.request("127.0.0.1", test_port, make_request("/first")).get().get_content_string());
+
+    // The server closes idle connections after 200ms.
+    std::this_thread::sleep_for(std::chrono::milliseconds{300});
+
+    EXPECT_EQ("/second", client.request("127.0.0.1", test_port, make_request("/second")).get().get_content_string());
+    EXPECT_EQ(2, accepted_connections);
+}
+
+TEST_F(test_http_client, request_timeout)
+{
+    web::http::http_client_settings settings;
+    settings.request_timeout = std::chrono::milliseconds{100};
+    web::http::http_client client{client_context_, settings};
+
+    auto reply = client.request("127.0.0.1", test_port, make_request("/slow"));
+
+    try
+    {
+        [[maybe_unused]] const auto result = reply.get();
+        FAIL() << "The request should have timed out.";
+    }
+    catch (const std::system_error &e)
+    {
+        EXPECT_EQ(std::error_code{asio::error::timed_out}, e.code());
+    }
+}
+
+TEST_F(test_http_client, connection_refused)
+{
+    web::http::http_client client{client_context_};
+
+    std::promise<std::error_code> result;
+    client.request_async("127.0.0.1", test_refused_port, make_request("/"),
+                         [&result](const std::error_code &ec, const web::http::client_reply_view &)
+                         { result.set_value(ec); });
+
+    EXPECT_EQ(std::error_code{asio::error::connection_refused}, result.get_future().get());
+}
+
+TEST_F(test_http_client, close_aborts_pending_requests)
+{
+    std::future<web::http::client_reply> reply;
+
+    {
+        web::http::http_client client{client_context_};
+        reply = client.request("127.0.0.1", test_port, make_request("/slow"));
+    }
+
+    try
+    {
+        [[maybe_unused]] const auto result = reply.get();
+        FAIL() << "The request should have been aborted.";
+    }
+    catch (const std::system_error &e)
+    {
+        EXPECT_EQ(std::error_code{asio::error::operation_aborted}, e.code());
+    }
+}
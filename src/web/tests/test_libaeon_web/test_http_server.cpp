@@ -0,0 +1,483 @@
+// Distributed under the BSD 2-Clause License - Copyright 2012-2023 Robin Degen
+
+#include <aeon/web/http/http_server.h>
+#include <aeon/compression/zlib.h>
+#include <gtest/gtest.h>
+#include <asio.hpp>
+#include <thread>
+#include <string>
+#include <chrono>
+#include <vector>
+#include <atomic>
+
+using namespace aeon;
+
+namespace
+{
+
+constexpr std::uint16_t test_port = 38271;
+constexpr std::uint16_t test_pool_port = 38274;
+constexpr std::uint16_t test_stream_port = 38276;
+
+/*!
+ * Replies with the uri of the request, or with the content if there is any. If the request has an X-Deferred header,
+ * the reply is sent asynchronously; with an X-Delayed header it is sent after 100ms. If it has an X-Chunked header, the
+ * uri is sent 3 times as a chunked reply. If it has an X-Repeat header, the uri is repeated that many times. Replies
+ * are compressed for clients that accept it.
+ */
+class echo_server_socket final : public web::http::http_server_socket
+{
+public:
+    explicit echo_server_socket(asio::ip::tcp::socket socket, [[maybe_unused]] web::http::http_server_session &session)
+        : http_server_socket{std::move(socket)}
+    {
+        set_keep_alive_timeout(std::chrono::milliseconds{200});
+        set_max_keep_alive_requests(3);
+        set_reply_compression(web::http::reply_compression_settings{.enabled = true});
+    }
+
+    void on_http_request(const web::http::request &request) override
+    {
+        if (request.has_content())
+        {
+            respond("text/plain", request.get_content_string());
+            return;
+        }
+
+        if (const auto repeat = request.find_header("x-repeat"))
+        {
+            std::string content;
+
+            for (auto i = 0; i < std::stoi(std::string{std::data(*repeat), std::size(*repeat)}); ++i)
+                content += request.get_uri().str();
+
+            respond("text/plain", content);
+            return;
+        }
+
+        if (request.find_header("x-chunked"))
+        {
+            respond_chunked_uri(request.get_uri().str());
+            return;
+        }
+
+        if (request.find_header("x-delayed"))
+        {
+            auto timer = std::make_shared<asio::steady_timer>(get_io_context(), std::chrono::milliseconds{100});
+            timer->async_wait(
+                [self = std::static_pointer_cast<echo_server_socket>(shared_from_this()), uri = request.get_uri(),
+                 timer](const std::error_code) { self->respond("text/plain", uri); });
+            return;
+        }
+
+        if (!request.find_header("x-deferred"))
+        {
+            respond("text/plain", request.get_uri());
+            return;
+        }
+
+        asio::post(get_io_context(),
+                   [self = std::static_pointer_cast<echo_server_socket>(shared_from_this()), uri = request.get_uri()]()
+                   { self->respond("text/plain", uri); });
+    }
+
+private:
+    void respond_chunked_uri(const std::string &uri)
+    {
+        respond_chunked(web::http::status_code::ok, "Content-Type: text/plain\r\n",
+                        [this, uri, remaining = 3, pending = false](std::vector<std::byte> &chunk) mutable
+                        {
+                            if (remaining == 0)
+                                return web::http::chunk_result::done;
+
+                            // The second chunk is not available right away.
+                            if (remaining == 2 && !pending)
+                            {
+                                pending = true;
+                                asio::post(get_io_context(),
+                                           [self = std::static_pointer_cast<echo_server_socket>(shared_from_this())]()
+                                           { self->resume_chunked_response(); });
+                                return web::http::chunk_result::pending;
+                            }
+
+                            const auto data = reinterpret_cast<const std::byte *>(std::data(uri));
+                            chunk.assign(data, data + std::size(uri));
+                            --remaining;
+                            return web::http::chunk_result::data;
+                        });
+    }
+};
+
+/*!
+ * Streams the content of requests and replies with the amount of pieces it was received in and the content. If the
+ * request has an X-Early-Reply header, the reply is given right away instead, before the content is received.
+ */
+class stream_server_socket final : public web::http::http_server_socket
+{
+public:
+    explicit stream_server_socket(asio::ip::tcp::socket socket,
+                                  [[maybe_unused]] web::http::http_server_session &session)
+        : http_server_socket{std::move(socket)}
+        , pieces_{0}
+        , content_{}
+        , replied_{false}
+    {
+        set_stream_request_content(true);
+        set_keep_alive_timeout(std::chrono::milliseconds{100});
+    }
+
+    void on_http_request(const web::http::request &request) override
+    {
+        EXPECT_FALSE(request.has_content());
+        pieces_ = 0;
+        content_.clear();
+        replied_ = false;
+
+        if (request.find_header("x-early-reply"))
+        {
+            replied_ = true;
+            respond("text/plain", "early");
+        }
+    }
+
+    void on_http_request_content(const std::span<const std::byte> content, const bool last) override
+    {
+        if (!std::empty(content))
+            ++pieces_;
+
+        content_.append(reinterpret_cast<const char *>(std::data(content)), std::size(content));
+
+        if (last && !replied_)
+            respond("text/plain", std::to_string(pieces_) + ":" + content_);
+    }
+
+private:
+    int pieces_;
+    std::string content_;
+    bool replied_;
+};
+
+class test_http_server : public ::testing::Test
+{
+public:
+    void SetUp() override
+    {
+        server_ = std::make_unique<web::http::http_server<echo_server_socket>>(context_, test_port);
+        thread_ = std::thread{[this]() { context_.run(); }};
+    }
+
+    void TearDown() override
+    {
+        context_.stop();
+        thread_.join();
+        server_.reset();
+    }
+
+    /*!
+     * Send the given data at once, and read everything until the server closes the connection.
+     */
+    [[nodiscard]] static auto send_and_receive(const std::string &data, const std::uint16_t port = test_port)
+        -> std::string
+    {
+        asio::io_context context;
+        asio::ip::tcp::socket socket{context};
+        socket.connect(asio::ip::tcp::endpoint{asio::ip::address_v4::loopback(), port});
+
+        if (!std::empty(data))
+            asio::write(socket, asio::buffer(data));
+
+        std::string result;
+        asio::error_code ec;
+        asio::read(socket, asio::dynamic_buffer(result), ec);
+        return result;
+    }
+
+private:
+    asio::io_context context_;
+    std::unique_ptr<web::http::http_server<echo_server_socket>> server_;
+    std::thread thread_;
+};
+
+[[nodiscard]] auto count(const std::string &str, const std::string &value) -> std::size_t
+{
+    std::size_t result = 0;
+
+    for (auto offset = str.find(value); offset != std::string::npos; offset = str.find(value, offset + 1))
+        ++result;
+
+    return result;
+}
+
+} // namespace
+
+TEST_F(test_http_server, pipelined_requests)
+{
+    const auto response = send_and_receive("GET /a HTTP/1.1\r\nHost: localhost\r\n\r\n"
+                                           "GET /b HTTP/1.1\r\nHost: localhost\r\n\r\n"
+                                           "GET /c HTTP/1.1\r\nHost: localhost\r\n\r\n");
+
+    // The connection is closed after 3 requests.
+    EXPECT_EQ(3u, count(response, "HTTP/1.1 200"));
+    EXPECT_EQ(2u, count(response, "Connection: keep-alive"));
+    EXPECT_EQ(1u, count(response, "Connection: close"));
+
+    const auto a = response.find("\r\n\r\n/a");
+    const auto b = response.find("\r\n\r\n/b");
+    const auto c = response.find("\r\n\r\n/c");
+    ASSERT_NE(std::string::npos, a);
+    EXPECT_LT(a, b);
+    EXPECT_LT(b, c);
+    EXPECT_TRUE(response.ends_with("/c"));
+}
+
+TEST_F(test_http_server, deferred_replies_keep_request_order)
+{
+    const auto response = send_and_receive("GET /a HTTP/1.1\r\nX-Deferred: 1\r\n\r\n"
+                                           "GET /b HTTP/1.1\r\n\r\n"
+                                           "GET /c HTTP/1.1\r\nX-Deferred: 1\r\nConnection: close\r\n\r\n");
+
+    EXPECT_EQ(3u, count(response, "HTTP/1.1 200"));
+
+    const auto a = response.find("\r\n\r\n/a");
+    const auto b = response.find("\r\n\r\n/b");
+    const auto c = response.find("\r\n\r\n/c");
+    ASSERT_NE(std::string::npos, a);
+    EXPECT_LT(a, b);
+    EXPECT_LT(b, c);
+}
+
+TEST_F(test_http_server, pipelined_data_is_held_back_while_waiting_for_a_reply)
+{
+    // More data than is buffered for pipelined requests arrives while the first reply is still outstanding.
+    const std::string content(1024 * 1024, 'x');
+    const std::string padding(6000, 'p');
+    const auto response = send_and_receive("GET /a HTTP/1.1\r\nX-Delayed: 1\r\n\r\n"
+                                           "POST /b HTTP/1.1\r\nContent-Type: text/plain\r\nX-Padding: " +
+                                           padding + "\r\nContent-Length: " + std::to_string(std::size(content)) +
+                                           "\r\n\r\n" + content + "GET /c HTTP/1.1\r\nX-Padding: " + padding +
+                                           "\r\nConnection: close\r\n\r\n");
+
+    EXPECT_EQ(0u, response.find("HTTP/1.1 200"));
+    EXPECT_EQ(3u, count(response, "HTTP/1.1 200"));
+
+    const auto a = response.find("\r\n\r\n/a");
+    const auto b = response.find("\r\n\r\n" + content);
+    const auto c = response.find("\r\n\r\n/c");
+    ASSERT_NE(std::string::npos, a);
+    EXPECT_LT(a, b);
+    EXPECT_LT(b, c);
+    EXPECT_TRUE(response.ends_with("/c"));
+}
+
+TEST_F(test_http_server, connection_close)
+{
+    const auto response = send_and_receive("GET /a HTTP/1.1\r\nConnection: close\r\n\r\n"
+                                           "GET /b HTTP/1.1\r\n\r\n");
+
+    EXPECT_EQ(1u, count(response, "HTTP/1.1 200"));
+    EXPECT_EQ(1u, count(response, "Connection: close"));
+    EXPECT_TRUE(response.ends_with("/a"));
+}
+
+TEST_F(test_http_server, idle_timeout)
+{
+    const auto start = std::chrono::steady_clock::now();
+    const auto response = send_and_receive("");
+
+    EXPECT_TRUE(std::empty(response));
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds{2});
+}
+
+TEST_F(test_http_server, incomplete_request_timeout)
+{
+    const auto response = send_and_receive("GET /a HTTP/1.1\r\nHost: local");
+    EXPECT_EQ(0u, response.find("HTTP/1.1 408"));
+}
+
+TEST_F(test_http_server, bad_request_is_sent_before_closing)
+{
+    const auto response = send_and_receive("GET /a HTTP/1.1\r\nHost : localhost\r\n\r\n");
+    EXPECT_EQ(0u, response.find("HTTP/1.1 400"));
+    EXPECT_EQ(1u, count(response, "Connection: close"));
+}
+
+TEST_F(test_http_server, chunked_response)
+{
+    const auto response = send_and_receive("GET /a HTTP/1.1\r\nX-Chunked: 1\r\n\r\n"
+                                           "GET /b HTTP/1.1\r\nConnection: close\r\n\r\n");
+
+    EXPECT_EQ(2u, count(response, "HTTP/1.1 200"));
+    EXPECT_EQ(1u, count(response, "Transfer-Encoding: chunked"));
+    EXPECT_NE(std::string::npos, response.find("\r\n\r\n2\r\n/a\r\n2\r\n/a\r\n2\r\n/a\r\n0\r\n\r\nHTTP/1.1 200"));
+    EXPECT_TRUE(response.ends_with("\r\n\r\n/b"));
+}
+
+TEST_F(test_http_server, chunked_request)
+{
+    const auto response = send_and_receive("POST /upload HTTP/1.1\r\n"
+                                           "Content-Type: text/plain\r\n"
+                                           "Transfer-Encoding: chunked\r\n"
+                                           "Connection: close\r\n\r\n"
+                                           "5\r\nHello\r\n6\r\n world\r\n0\r\n\r\n");
+
+    EXPECT_EQ(0u, response.find("HTTP/1.1 200"));
+    EXPECT_TRUE(response.ends_with("\r\n\r\nHello world"));
+}
+
+TEST_F(test_http_server, compressed_reply)
+{
+    const auto response = send_and_receive("GET /compress HTTP/1.1\r\nX-Repeat: 200\r\n"
+                                           "Accept-Encoding: deflate\r\n\r\n"
+                                           "GET /small HTTP/1.1\r\nAccept-Encoding: deflate\r\n"
+                                           "Connection: close\r\n\r\n");
+
+    EXPECT_EQ(2u, count(response, "HTTP/1.1 200"));
+    EXPECT_EQ(1u, count(response, "Content-Encoding: deflate"));
+    EXPECT_EQ(1u, count(response, "Vary: Accept-Encoding"));
+
+    // The compressed reply is still sent before the reply to the next request.
+    const auto content_length_offset = response.find("Content-Length: ") + 16;
+    const auto content_length = std::stoul(response.substr(content_length_offset));
+    const auto content_offset = response.find("\r\n\r\n") + 4;
+    EXPECT_LT(content_length, 200u);
+    EXPECT_EQ(content_offset + content_length, response.find("HTTP/1.1 200", content_offset));
+    EXPECT_TRUE(response.ends_with("\r\n\r\n/small"));
+
+    compression::zlib_decompress decompress;
+    std::string content(1800, '\0');
+    auto offset = content_offset;
+
+    const auto size = decompress.read(reinterpret_cast<std::byte *>(std::data(content)), std::size(content),
+                                      [&](std::byte *buffer, const std::streamsize size)
+                                      {
+                                          const auto count = std::min(content_offset + content_length - offset,
+                                                                      static_cast<std::size_t>(size));
+                                          std::copy_n(reinterpret_cast<const std::byte *>(std::data(response)) + offset,
+                                                      count, buffer);
+                                          offset += count;
+                                          return static_cast<std::streamsize>(count);
+                                      });
+
+    ASSERT_EQ(1800, size);
+    EXPECT_EQ(0u, content.find("/compress/compress"));
+
+    // Clients that do not accept it get the content as is.
+    const auto identity_response = send_and_receive("GET /compress HTTP/1.1\r\nX-Repeat: 200\r\n"
+                                                    "Connection: close\r\n\r\n");
+    EXPECT_EQ(0u, count(identity_response, "Content-Encoding"));
+    EXPECT_EQ(1u, count(identity_response, "Vary: Accept-Encoding"));
+    EXPECT_EQ(1800u, std::size(identity_response) - identity_response.find("\r\n\r\n") - 4);
+}
+
+TEST(test_http_server_stream, stream_request_content)
+{
+    asio::io_context context;
+    web::http::http_server<stream_server_socket> server{context, test_stream_port};
+    std::thread thread{[&context]() { context.run(); }};
+
+    asio::io_context client_context;
+    asio::ip::tcp::socket socket{client_context};
+    socket.connect(asio::ip::tcp::endpoint{asio::ip::address_v4::loopback(), test_stream_port});
+
+    // The content is sent in parts, so that the server receives it in multiple pieces.
+    asio::write(socket, asio::buffer(std::string{"POST /upload HTTP/1.1\r\n"
+                                                 "Content-Type: text/plain\r\n"
+                                                 "Transfer-Encoding: chunked\r\n\r\n"
+                                                 "5\r\nHello\r\n"}));
+    std::this_thread::sleep_for(std::chrono::milliseconds{20});
+    asio::write(socket, asio::buffer(std::string{"6\r\n world\r\n0\r\n\r\n"
+                                                 "POST /b HTTP/1.1\r\nContent-Type: text/plain\r\n"
+                                                 "Content-Length: 3\r\nConnection: close\r\n\r\nabc"}));
+
+    std::string response;
+    asio::error_code ec;
+    asio::read(socket, asio::dynamic_buffer(response), ec);
+
+    context.stop();
+    thread.join();
+
+    EXPECT_EQ(2u, count(response, "HTTP/1.1 200"));
+    EXPECT_NE(std::string::npos, response.find("\r\n\r\n2:Hello world"));
+    EXPECT_TRUE(response.ends_with("\r\n\r\n1:abc"));
+}
+
+TEST(test_http_server_stream, slow_content_after_early_reply)
+{
+    asio::io_context context;
+    web::http::http_server<stream_server_socket> server{context, test_stream_port};
+    std::thread thread{[&context]() { context.run(); }};
+
+    asio::io_context client_context;
+    asio::ip::tcp::socket socket{client_context};
+    socket.connect(asio::ip::tcp::endpoint{asio::ip::address_v4::loopback(), test_stream_port});
+
+    // The reply is given right away, while the content keeps coming in slower than the keep-alive timeout.
+    asio::write(socket, asio::buffer(std::string{"POST /upload HTTP/1.1\r\n"
+                                                 "Content-Type: text/plain\r\n"
+                                                 "X-Early-Reply: 1\r\n"
+                                                 "Transfer-Encoding: chunked\r\n\r\n"}));
+
+    for (auto i = 0; i < 3; ++i)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds{150});
+        asio::write(socket, asio::buffer(std::string{"5\r\nHello\r\n"}));
+    }
+
+    asio::write(socket, asio::buffer(std::string{"0\r\n\r\n"
+                                                 "POST /b HTTP/1.1\r\nContent-Type: text/plain\r\n"
+                                                 "Content-Length: 3\r\nConnection: close\r\n\r\nabc"}));
+
+    std::string response;
+    asio::error_code ec;
+    asio::read(socket, asio::dynamic_buffer(response), ec);
+
+    context.stop();
+    thread.join();
+
+    EXPECT_EQ(0u, count(response, "HTTP/1.1 408"));
+    EXPECT_EQ(2u, count(response, "HTTP/1.1 200"));
+    EXPECT_NE(std::string::npos, response.find("\r\n\r\nearly"));
+    EXPECT_TRUE(response.ends_with("\r\n\r\n1:abc"));
+}
+
+class test_http_server_pool : public ::testing::TestWithParam<sockets::connection_distribution>
+{
+};
+
+TEST_P(test_http_server_pool, concurrent_connections)
+{
+    web::http::http_server_pool<echo_server_socket> server{test_pool_port, 4, GetParam()};
+    server.start();
+
+    EXPECT_EQ(4u, server.thread_count());
+
+    std::atomic<int> succeeded = 0;
+    std::vector<std::thread> clients;
+
+    for (auto i = 0; i < 8; ++i)
+    {
+        clients.emplace_back(
+            [&succeeded, i]()
+            {
+                for (auto j = 0; j < 8; ++j)
+                {
+                    const auto uri = "/" + std::to_string(i) + "/" + std::to_string(j);
+                    const auto request = "GET " + uri + " HTTP/1.1\r\n\r\n";
+                    const auto response =
+                        test_http_server::send_and_receive(request + request + request, test_pool_port);
+
+                    if (count(response, "\r\n\r\n" + uri) == 3)
+                        ++succeeded;
+                }
+            });
+    }
+
+    for (auto &client : clients)
+        client.join();
+
+    EXPECT_EQ(64, succeeded);
+}
+
+INSTANTIATE_TEST_SUITE_P(test_http_server_pool, test_http_server_pool,
+                         ::testing::Values(sockets::connection_distribution::round_robin,
+                                           sockets::connection_distribution::reuse_port));
@@ -0,0 +1,205 @@
+// Distributed under the BSD 2-Clause License - Copyright 2012-2023 Robin Degen
+
+#include <aeon/web/jsonrpc/server.h>
+#include <aeon/web/http/http_jsonrpc_route.h>
+#include <aeon/web/http/routable_http_server.h>
+#include <aeon/web/http/http_client.h>
+#include <gtest/gtest.h>
+#include <asio.hpp>
+#include <thread>
+#include <string>
+#include <mutex>
+#include <set>
+
+using namespace aeon;
+
+namespace
+{
+
+constexpr std::uint16_t test_port = 38280;
+
+[[nodiscard]] auto subtract(const ptree::property_tree &params) -> web::jsonrpc::result
+{
+    return web::jsonrpc::result{
+        ptree::property_tree{params.at("a").integer_value() - params.at("b").integer_value()}};
+}
+
+[[nodiscard]] auto make_server() -> web::jsonrpc::server
+{
+    web::jsonrpc::server server;
+    server.register_method({"subtract", subtract});
+    server.register_method({"raise_error", [](const ptree::property_tree &)
+                            { return web::jsonrpc::result{1337, "This is an error!"}; }});
+    return server;
+}
+
+[[nodiscard]] auto request(const web::jsonrpc::server &server, const std::string &str) -> std::string
+{
+    return server.request(common::string{str}).str();
+}
+
+} // namespace
+
+TEST(test_jsonrpc, single_request)
+{
+    const auto server = make_server();
+    EXPECT_EQ(R"({"jsonrpc":"2.0","result":19,"id":1})",
+              request(server, R"({"jsonrpc":"2.0","method":"subtract","params":{"a":42,"b":23},"id":1})"));
+    EXPECT_EQ(R"({"jsonrpc":"2.0","error":{"code":1337,"message":"This is an error!"},"id":2})",
+              request(server, R"({"jsonrpc":"2.0","method":"raise_error","id":2})"));
+}
+
+TEST(test_jsonrpc, invalid_requests)
+{
+    const auto server = make_server();
+    EXPECT_EQ(R"({"jsonrpc":"2.0","error":{"code":-32700,"message":"Json parse error."},"id":null})",
+              request(server, R"({"jsonrpc":"2.0","method")"));
+    EXPECT_EQ(R"({"jsonrpc":"2.0","error":{"code":-32601,"message":"Method not found."},"id":3})",
+              request(server, R"({"jsonrpc":"2.0","method":"add","id":3})"));
+    EXPECT_EQ(R"({"jsonrpc":"2.0","error":{"code":-32600,"message":"Missing 'method' field."},"id":4})",
+              request(server, R"({"jsonrpc":"2.0","id":4})"));
+    EXPECT_EQ(R"({"jsonrpc":"2.0","error":{"code":-32600,"message":"No content"},"id":null})",
+              request(server, "[]"));
+}
+
+TEST(test_jsonrpc, batch)
+{
+    const auto server = make_server();
+    EXPECT_EQ(R"([{"jsonrpc":"2.0","result":1,"id":1},)"
+              R"({"jsonrpc":"2.0","error":{"code":-32601,"message":"Method not found."},"id":2},)"
+              R"({"jsonrpc":"2.0","result":-1,"id":3}])",
+              request(server, R"([{"jsonrpc":"2.0","method":"subtract","params":{"a":2,"b":1},"id":1},)"
+                             R"({"jsonrpc":"2.0","method":"add","id":2},)"
+                             R"({"jsonrpc":"2.0","method":"subtract","params":{"a":1,"b":2},"id":3}])"));
+
+    // A batch always results in an array, even with a single request.
+    EXPECT_EQ(R"([{"jsonrpc":"2.0","result":0,"id":1}])",
+              request(server, R"([{"jsonrpc":"2.0","method":"subtract","params":{"a":1,"b":1},"id":1}])"));
+}
+
+TEST(test_jsonrpc, parallel_batch)
+{
+    std::mutex mutex;
+    std::set<std::thread::id> threads;
+
+    auto server = make_server();
+    server.set_batch_settings(web::jsonrpc::batch_settings{true, 2});
+    server.register_method({"thread", [&mutex, &threads](const ptree::property_tree &params)
+                            {
+                                const std::scoped_lock lock{mutex};
+                                threads.insert(std::this_thread::get_id());
+                                return web::jsonrpc::result{ptree::property_tree{params.integer_value()}};
+                            }});
+
+    std::string batch = "[";
+    std::string expected = "[";
+
+    for (auto i = 0; i < 64; ++i)
+    {
+        const std::string separator = i == 0 ? "" : ",";
+        batch += separator + R"({"jsonrpc":"2.0","method":"thread","params":)" + std::to_string(i) +
+                   R"(,"id":)" + std::to_string(i) + "}";
+        expected += separator + R"({"jsonrpc":"2.0","result":)" + std::to_string(i) + R"(,"id":)" +
+                    std::to_string(i) + "}";
+    }
+
+    batch += "]";
+    expected += "]";
+
+    // The results are in the order of the requests, regardless of the order in which they complete.
+    EXPECT_EQ(expected, request(server, batch));
+    EXPECT_FALSE(threads.contains(std::this_thread::get_id()));
+
+    // Small batches are executed on the calling thread.
+    threads.clear();
+    EXPECT_EQ(R"([{"jsonrpc":"2.0","result":1,"id":1}])",
+              request(server, R"([{"jsonrpc":"2.0","method":"thread","params":1,"id":1}])"));
+    EXPECT_TRUE(threads.contains(std::this_thread::get_id()));
+}
+
+TEST(test_jsonrpc, async_method)
+{
+    asio::thread_pool pool{1};
+
+    auto server = make_server();
+    server.register_method(
+        {"later", web::jsonrpc::method::async_signature{
+                      [&pool](const ptree::property_tree &params, web::jsonrpc::method::result_handler handler)
+                      {
+                          asio::post(pool, [value = params.integer_value(), handler = std::move(handler)]()
+                                     { handler(web::jsonrpc::result{ptree::property_tree{value * 2}}); });
+                      }}});
+
+    EXPECT_EQ(R"({"jsonrpc":"2.0","result":42,"id":1})",
+              request(server, R"({"jsonrpc":"2.0","method":"later","params":21,"id":1})"));
+
+    std::promise<std::string> response;
+    server.request_async(R"([{"jsonrpc":"2.0","method":"later","params":1,"id":1},)"
+                         R"({"jsonrpc":"2.0","method":"subtract","params":{"a":1,"b":1},"id":2}])",
+                         [&response](const std::vector<std::byte> data)
+                         {
+                             response.set_value(
+                                 std::string{reinterpret_cast<const char *>(std::data(data)), std::size(data)});
+                         });
+
+    EXPECT_EQ(R"([{"jsonrpc":"2.0","result":2,"id":1},{"jsonrpc":"2.0","result":0,"id":2}])",
+              response.get_future().get());
+}
+
+TEST(test_jsonrpc, http_route)
+{
+    asio::io_context server_context;
+    web::http::routable_http_server server{server_context, test_port};
+
+    auto route = std::make_unique<web::http::http_jsonrpc_route>("/api");
+    route->register_method({"subtract", subtract});
+
+    // Completes on the io_context of the server after a delay, without blocking the connection in the meantime.
+    const auto later = [&server_context](const ptree::property_tree &params,
+                                         web::jsonrpc::method::result_handler handler)
+    {
+        auto timer = std::make_shared<asio::steady_timer>(server_context, std::chrono::milliseconds{50});
+        timer->async_wait([timer, value = params.integer_value(), handler = std::move(handler)](const std::error_code)
+                          { handler(web::jsonrpc::result{ptree::property_tree{value}}); });
+    };
+
+    route->register_method({"later", web::jsonrpc::method::async_signature{later}});
+    server.get_session().add_route(std::move(route));
+    std::thread server_thread{[&server_context]() { server_context.run(); }};
+
+    asio::io_context client_context;
+    auto client_work_guard = asio::make_work_guard(client_context);
+    std::thread client_thread{[&client_context]() { client_context.run(); }};
+
+    {
+        web::http::http_client client{client_context};
+
+        const auto make_request = [](const std::string_view content)
+        {
+            web::http::client_request request;
+            request.method = web::http::http_method::post;
+            request.uri = "/api";
+            request.content_type = "application/json";
+            const auto bytes = reinterpret_cast<const std::byte *>(std::data(content));
+            request.content.assign(bytes, bytes + std::size(content));
+            return request;
+        };
+
+        auto later_reply = client.request("127.0.0.1", test_port,
+                                          make_request(R"({"jsonrpc":"2.0","method":"later","params":7,"id":1})"));
+        auto now_reply = client.request(
+            "127.0.0.1", test_port,
+            make_request(R"({"jsonrpc":"2.0","method":"subtract","params":{"a":3,"b":1},"id":2})"));
+
+        const auto now = now_reply.get();
+        EXPECT_EQ("application/json", now.find_header("content-type"));
+        EXPECT_EQ(R"({"jsonrpc":"2.0","result":2,"id":2})", now.get_content_string());
+        EXPECT_EQ(R"({"jsonrpc":"2.0","result":7,"id":1})", later_reply.get().get_content_string());
+    }
+
+    client_work_guard.reset();
+    client_thread.join();
+
+    server_context.stop();
+    server_thread.join();
+}
@@ -0,0 +1,235 @@
+// Distributed under the BSD 2-Clause License - Copyright 2012-2023 Robin Degen
+
+#include <aeon/web/http/reply_parser.h>
+#include <gtest/gtest.h>
+#include <string_view>
+#include <string>
+
+using namespace aeon;
+
+namespace
+{
+
+[[nodiscard]] auto as_bytes(const std::string_view str) noexcept -> std::span<const std::byte>
+{
+    return std::as_bytes(std::span{std::data(str), std::size(str)});
+}
+
+[[nodiscard]] auto as_string(const std::span<const std::byte> data) -> std::string
+{
+    return std::string{reinterpret_cast<const char *>(std::data(data)), std::size(data)};
+}
+
+[[nodiscard]] auto is_error(const std::string_view str) -> bool
+{
+    web::http::reply_parser parser;
+    return parser.parse(as_bytes(str)) == web::http::reply_parser_result::error;
+}
+
+const std::string_view ok_reply = "HTTP/1.1 200 OK\r\n"
+                                  "Content-Type: text/plain\r\n"
+                                  "Content-Length: 6\r\n"
+                                  "\r\n"
+                                  "Hello!";
+
+const std::string_view chunked_reply = "HTTP/1.1 200 OK\r\n"
+                                       "Transfer-Encoding: chunked\r\n"
+                                       "\r\n"
+                                       "5\r\nHello\r\n"
+                                       "7;ext=1\r\n, world\r\n"
+                                       "0\r\n"
+                                       "\r\n";
+
+} // namespace
+
+TEST(test_reply_parser, parse_in_place)
+{
+    web::http::reply_parser parser;
+    ASSERT_EQ(web::http::reply_parser_result::complete, parser.parse(as_bytes(ok_reply)));
+    EXPECT_EQ(std::size(ok_reply), parser.consumed());
+
+    EXPECT_EQ(web::http::status_code::ok, parser.get_status_code());
+    EXPECT_EQ("OK", parser.get_reason());
+    EXPECT_EQ("text/plain", web::http::find_http_header(parser.get_headers(), "content-type"));
+    EXPECT_EQ("Hello!", as_string(parser.get_content()));
+    EXPECT_TRUE(parser.is_keep_alive());
+
+    // A reply that is received at once is not copied.
+    EXPECT_EQ(reinterpret_cast<const std::byte *>(std::data(ok_reply) + std::size(ok_reply) - 6),
+              std::data(parser.get_content()));
+}
+
+TEST(test_reply_parser, parse_byte_by_byte)
+{
+    web::http::reply_parser parser;
+
+    for (std::size_t i = 0; i < std::size(ok_reply) - 1; ++i)
+        ASSERT_EQ(web::http::reply_parser_result::incomplete, parser.parse(as_bytes(ok_reply.substr(i, 1))));
+
+    ASSERT_EQ(web::http::reply_parser_result::complete,
+              parser.parse(as_bytes(ok_reply.substr(std::size(ok_reply) - 1))));
+    EXPECT_EQ(1u, parser.consumed());
+    EXPECT_EQ("Hello!", as_string(parser.get_content()));
+    EXPECT_EQ("6", web::http::find_http_header(parser.get_headers(), "Content-Length"));
+}
+
+TEST(test_reply_parser, pipelined_replies)
+{
+    const auto data = std::string{ok_reply} + std::string{chunked_reply} + std::string{ok_reply};
+    auto remaining = as_bytes(data);
+
+    web::http::reply_parser parser;
+    ASSERT_EQ(web::http::reply_parser_result::complete, parser.parse(remaining));
+    EXPECT_EQ("Hello!", as_string(parser.get_content()));
+    remaining = remaining.subspan(parser.consumed());
+
+    parser.reset();
+    ASSERT_EQ(web::http::reply_parser_result::complete, parser.parse(remaining));
+    EXPECT_EQ("Hello, world", as_string(parser.get_content()));
+    remaining = remaining.subspan(parser.consumed());
+
+    parser.reset();
+    ASSERT_EQ(web::http::reply_parser_result::complete, parser.parse(remaining));
+    EXPECT_EQ(std::size(remaining), parser.consumed());
+}
+
+TEST(test_reply_parser, parse_chunked_byte_by_byte)
+{
+    web::http::reply_parser parser;
+
+    for (std::size_t i = 0; i < std::size(chunked_reply) - 1; ++i)
+        ASSERT_EQ(web::http::reply_parser_result::incomplete, parser.parse(as_bytes(chunked_reply.substr(i, 1))));
+
+    ASSERT_EQ(web::http::reply_parser_result::complete,
+              parser.parse(as_bytes(chunked_reply.substr(std::size(chunked_reply) - 1))));
+    EXPECT_EQ("Hello, world", as_string(parser.get_content()));
+    EXPECT_EQ("chunked", web::http::find_http_header(parser.get_headers(), "transfer-encoding"));
+}
+
+TEST(test_reply_parser, no_content)
+{
+    web::http::reply_parser parser;
+    parser.set_head_request(true);
+    ASSERT_EQ(web::http::reply_parser_result::complete,
+              parser.parse(as_bytes("HTTP/1.1 200 OK\r\nContent-Length: 100\r\n\r\n")));
+    EXPECT_TRUE(std::empty(parser.get_content()));
+
+    parser.reset();
+    ASSERT_EQ(web::http::reply_parser_result::complete, parser.parse(as_bytes("HTTP/1.1 304 Not Modified\r\n\r\n")));
+    EXPECT_EQ(web::http::status_code::not_modified, parser.get_status_code());
+
+    parser.reset();
+    ASSERT_EQ(web::http::reply_parser_result::complete, parser.parse(as_bytes("HTTP/1.1 204\r\n\r\n")));
+    EXPECT_EQ("", parser.get_reason());
+}
+
+TEST(test_reply_parser, interim_replies)
+{
+    const auto data = "HTTP/1.1 100 Continue\r\n\r\n"
+                      "HTTP/1.1 103 Early Hints\r\nLink: </style.css>\r\n\r\n" +
+                      std::string{ok_reply};
+
+    web::http::reply_parser parser;
+    ASSERT_EQ(web::http::reply_parser_result::complete, parser.parse(as_bytes(data)));
+    EXPECT_EQ(std::size(data), parser.consumed());
+    EXPECT_EQ(web::http::status_code::ok, parser.get_status_code());
+    EXPECT_EQ("OK", parser.get_reason());
+    EXPECT_EQ(2u, std::size(parser.get_headers()));
+    EXPECT_FALSE(web::http::find_http_header(parser.get_headers(), "link"));
+    EXPECT_EQ("Hello!", as_string(parser.get_content()));
+
+    // The interim reply is usually received on its own, well before the final reply.
+    parser.reset();
+    ASSERT_EQ(web::http::reply_parser_result::incomplete, parser.parse(as_bytes("HTTP/1.1 100 Continue\r\n\r\n")));
+    EXPECT_FALSE(parser.is_idle());
+
+    for (std::size_t i = 0; i < std::size(chunked_reply) - 1; ++i)
+        ASSERT_EQ(web::http::reply_parser_result::incomplete, parser.parse(as_bytes(chunked_reply.substr(i, 1))));
+
+    ASSERT_EQ(web::http::reply_parser_result::complete,
+              parser.parse(as_bytes(chunked_reply.substr(std::size(chunked_reply) - 1))));
+    EXPECT_EQ(web::http::status_code::ok, parser.get_status_code());
+    EXPECT_EQ("chunked", web::http::find_http_header(parser.get_headers(), "transfer-encoding"));
+    EXPECT_EQ("Hello, world", as_string(parser.get_content()));
+
+    // Interim replies never have content, and don't make a Connection header apply to the final reply.
+    const auto with_headers =
+        "HTTP/1.1 100 Continue\r\nConnection: close\r\nContent-Length: 5\r\n\r\n" + std::string{ok_reply};
+
+    parser.reset();
+    ASSERT_EQ(web::http::reply_parser_result::complete, parser.parse(as_bytes(with_headers)));
+    EXPECT_EQ("Hello!", as_string(parser.get_content()));
+    EXPECT_TRUE(parser.is_keep_alive());
+}
+
+TEST(test_reply_parser, content_until_close)
+{
+    web::http::reply_parser parser;
+    EXPECT_EQ(web::http::reply_parser_result::incomplete, parser.parse(as_bytes("HTTP/1.0 200 OK\r\n\r\nHello")));
+    EXPECT_EQ(web::http::reply_parser_result::incomplete, parser.parse(as_bytes(" world")));
+    ASSERT_EQ(web::http::reply_parser_result::complete, parser.finish());
+    EXPECT_EQ("Hello world", as_string(parser.get_content()));
+    EXPECT_FALSE(parser.is_keep_alive());
+
+    // A reply that was cut off is an error; nothing at all is not.
+    parser.reset();
+    EXPECT_EQ(web::http::reply_parser_result::incomplete, parser.finish());
+    EXPECT_EQ(web::http::reply_parser_result::incomplete, parser.parse(as_bytes(ok_reply.substr(0, 40))));
+    EXPECT_EQ(web::http::reply_parser_result::error, parser.finish());
+}
+
+TEST(test_reply_parser, keep_alive)
+{
+    const auto keep_alive = [](const std::string_view str)
+    {
+        web::http::reply_parser parser;
+        EXPECT_EQ(web::http::reply_parser_result::complete, parser.parse(as_bytes(str)));
+        return parser.is_keep_alive();
+    };
+
+    EXPECT_FALSE(keep_alive("HTTP/1.1 200 OK\r\nConnection: close\r\nContent-Length: 0\r\n\r\n"));
+    EXPECT_FALSE(keep_alive("HTTP/1.1 200 OK\r\nConnection: Upgrade, Close\r\nContent-Length: 0\r\n\r\n"));
+    EXPECT_FALSE(keep_alive("HTTP/1.0 200 OK\r\nContent-Length: 0\r\n\r\n"));
+    EXPECT_TRUE(keep_alive("HTTP/1.0 200 OK\r\nConnection: keep-alive\r\nContent-Length: 0\r\n\r\n"));
+    EXPECT_TRUE(keep_alive("HTTP/1.1 200 OK\r\nContent-Length: 0\r\n\r\n"));
+}
+
+TEST(test_reply_parser, errors)
+{
+    EXPECT_TRUE(is_error("HTTP/2 200 OK\r\n\r\n"));
+    EXPECT_TRUE(is_error("HTTP/1.1 2000 OK\r\n\r\n"));
+    EXPECT_TRUE(is_error("HTTP/1.1 abc OK\r\n\r\n"));
+    EXPECT_TRUE(is_error("HTTP/1.1 101 Switching Protocols\r\n\r\n"));
+    EXPECT_TRUE(is_error("HTTP/1.1 099 Hmm\r\n\r\n"));
+    EXPECT_TRUE(is_error("HTTP/1.1 200 OK\r\nBad Header: value\r\n\r\n"));
+    EXPECT_TRUE(is_error("HTTP/1.1 200 OK\r\nContent-Length: 1\r\nContent-Length: 2\r\n\r\n"));
+    EXPECT_TRUE(is_error("HTTP/1.1 200 OK\r\nTransfer-Encoding: gzip\r\n\r\n"));
+    EXPECT_TRUE(is_error("HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\nxyz\r\n"));
+    EXPECT_TRUE(is_error("HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n1\r\nab\r\n"));
+}
+
+TEST(test_reply_parser, limits)
+{
+    web::http::reply_parser parser{64, 8};
+    EXPECT_EQ(web::http::reply_parser_result::error,
+              parser.parse(as_bytes("HTTP/1.1 200 OK\r\nContent-Length: 9\r\n\r\n")));
+
+    parser.reset();
+    EXPECT_EQ(web::http::reply_parser_result::error,
+              parser.parse(as_bytes("HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n5\r\nHello\r\n5\r\n")));
+
+    parser.reset();
+    EXPECT_EQ(web::http::reply_parser_result::error,
+              parser.parse(as_bytes("HTTP/1.1 200 OK\r\nX-Header: " + std::string(64, 'a'))));
+
+    parser.reset();
+    EXPECT_EQ(web::http::reply_parser_result::error, parser.parse(as_bytes("HTTP/1.0 200 OK\r\n\r\n0123456789")));
+
+    std::string many_trailers = "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n0\r\n";
+
+    for (auto i = 0; i < 20; ++i)
+        many_trailers += "A: b\r\n";
+
+    parser.reset();
+    EXPECT_EQ(web::http::reply_parser_result::error, parser.parse(as_bytes(many_trailers)));
+}
@@ -0,0 +1,311 @@
+// Distributed under the BSD 2-Clause License - Copyright 2012-2023 Robin Degen
+
+#include <aeon/web/http/request_parser.h>
+#include <gtest/gtest.h>
+#include <string_view>
+#include <string>
+
+using namespace aeon;
+
+namespace
+{
+
+[[nodiscard]] auto as_bytes(const std::string_view str) noexcept -> std::span<const std::byte>
+{
+    return std::as_bytes(std::span{std::data(str), std::size(str)});
+}
+
+[[nodiscard]] auto parse_error(const std::string_view str) -> web::http::status_code
+{
+    web::http::request_parser parser;
+
+    if (parser.parse(as_bytes(str)) != web::http::request_parser_result::error)
+        return web::http::status_code::ok;
+
+    return parser.get_error();
+}
+
+const std::string_view get_request = "GET /index.html?a=1 HTTP/1.1\r\n"
+                                     "Host: localhost\r\n"
+                                     "User-Agent:  test agent\t \r\n"
+                                     "Accept: */*\r\n"
+                                     "\r\n";
+
+const std::string_view post_request = "POST /api HTTP/1.1\r\n"
+                                      "Content-Type: application/json\r\n"
+                                      "Content-Length: 11\r\n"
+                                      "\r\n"
+                                      "{\"a\": true}";
+
+const std::string_view chunked_request = "POST /upload HTTP/1.1\r\n"
+                                         "Content-Type: text/plain\r\n"
+                                         "Transfer-Encoding: chunked\r\n"
+                                         "\r\n"
+                                         "1\r\nH\r\n"
+                                         "a;name=value\r\nello world\r\n"
+                                         "1\r\n!\r\n"
+                                         "0\r\n"
+                                         "Trailer: value\r\n"
+                                         "\r\n";
+
+[[nodiscard]] auto as_string(const std::span<const std::byte> data) -> std::string
+{
+    return std::string{reinterpret_cast<const char *>(std::data(data)), std::size(data)};
+}
+
+} // namespace
+
+TEST(test_request_parser, parse_in_place)
+{
+    web::http::request_parser parser;
+    ASSERT_EQ(web::http::request_parser_result::complete, parser.parse(as_bytes(get_request)));
+    EXPECT_EQ(std::size(get_request), parser.consumed());
+
+    EXPECT_EQ(web::http::http_method::get, parser.get_method());
+    EXPECT_EQ("GET", parser.get_method_string());
+    EXPECT_EQ("/index.html?a=1", parser.get_target());
+    EXPECT_TRUE(std::empty(parser.get_content()));
+
+    const auto headers = parser.get_headers();
+    ASSERT_EQ(3u, std::size(headers));
+    EXPECT_EQ("Host", headers[0].name);
+    EXPECT_EQ("localhost", headers[0].value);
+    EXPECT_EQ("test agent", headers[1].value);
+
+    // Header lookup is case insensitive.
+    EXPECT_EQ("*/*", web::http::find_http_header(headers, "accept"));
+    EXPECT_FALSE(web::http::find_http_header(headers, "content-length"));
+
+    // A request that is received at once is not copied.
+    EXPECT_EQ(std::data(get_request) + 4, std::data(parser.get_target()));
+    EXPECT_EQ(std::data(get_request) + 30, std::data(headers[0].name));
+}
+
+TEST(test_request_parser, parse_byte_by_byte)
+{
+    web::http::request_parser parser;
+
+    for (std::size_t i = 0; i < std::size(post_request) - 1; ++i)
+    {
+        ASSERT_EQ(web::http::request_parser_result::incomplete, parser.parse(as_bytes(post_request.substr(i, 1))));
+    }
+
+    ASSERT_EQ(web::http::request_parser_result::complete,
+              parser.parse(as_bytes(post_request.substr(std::size(post_request) - 1))));
+    EXPECT_EQ(1u, parser.consumed());
+    EXPECT_EQ(web::http::http_method::post, parser.get_method());
+    EXPECT_EQ("/api", parser.get_target());
+    EXPECT_EQ("application/json", web::http::find_http_header(parser.get_headers(), "CONTENT-TYPE"));
+
+    const auto content = parser.get_content();
+    const std::string_view content_str{reinterpret_cast<const char *>(std::data(content)), std::size(content)};
+    EXPECT_EQ("{\"a\": true}", content_str);
+}
+
+TEST(test_request_parser, parse_chunked)
+{
+    const auto data = std::string{chunked_request} + std::string{get_request};
+
+    web::http::request_parser parser;
+    ASSERT_EQ(web::http::request_parser_result::complete, parser.parse(as_bytes(data)));
+    EXPECT_EQ(std::size(chunked_request), parser.consumed());
+    EXPECT_TRUE(parser.is_chunked());
+    EXPECT_EQ("/upload", parser.get_target());
+    EXPECT_EQ("text/plain", web::http::find_http_header(parser.get_headers(), "content-type"));
+    EXPECT_EQ("Hello world!", as_string(parser.get_content()));
+
+    parser.reset();
+    ASSERT_EQ(web::http::request_parser_result::complete,
+              parser.parse(as_bytes(std::string_view{data}.substr(std::size(chunked_request)))));
+    EXPECT_FALSE(parser.is_chunked());
+    EXPECT_EQ("/index.html?a=1", parser.get_target());
+}
+
+TEST(test_request_parser, parse_chunked_byte_by_byte)
+{
+    web::http::request_parser parser;
+
+    for (std::size_t i = 0; i < std::size(chunked_request) - 1; ++i)
+    {
+        ASSERT_EQ(web::http::request_parser_result::incomplete, parser.parse(as_bytes(chunked_request.substr(i, 1))));
+    }
+
+    ASSERT_EQ(web::http::request_parser_result::complete,
+              parser.parse(as_bytes(chunked_request.substr(std::size(chunked_request) - 1))));
+    EXPECT_EQ(1u, parser.consumed());
+    EXPECT_EQ("/upload", parser.get_target());
+    EXPECT_EQ("text/plain", web::http::find_http_header(parser.get_headers(), "content-type"));
+    EXPECT_EQ("Hello world!", as_string(parser.get_content()));
+}
+
+TEST(test_request_parser, stream_content)
+{
+    web::http::request_parser parser;
+    parser.set_stream_content(true);
+
+    const std::string_view data{chunked_request};
+    const auto header_size = data.find("\r\n\r\n") + 4;
+
+    // The headers and the start of the first chunk
+    ASSERT_EQ(web::http::request_parser_result::headers_complete,
+              parser.parse(as_bytes(data.substr(0, header_size + 5))));
+    EXPECT_EQ(header_size, parser.consumed());
+    EXPECT_EQ("/upload", parser.get_target());
+
+    ASSERT_EQ(web::http::request_parser_result::content, parser.parse(as_bytes(data.substr(header_size, 5))));
+    EXPECT_EQ(4u, parser.consumed());
+    EXPECT_EQ("H", as_string(parser.get_content()));
+
+    auto remaining = data.substr(header_size + 4);
+    std::string content = "H";
+
+    while (true)
+    {
+        const auto result = parser.parse(as_bytes(remaining));
+        ASSERT_NE(web::http::request_parser_result::error, result);
+        ASSERT_NE(web::http::request_parser_result::incomplete, result);
+
+        content += as_string(parser.get_content());
+        remaining = remaining.substr(parser.consumed());
+
+        if (result == web::http::request_parser_result::complete)
+            break;
+    }
+
+    EXPECT_TRUE(std::empty(remaining));
+    EXPECT_EQ("Hello world!", content);
+
+    // The headers remain valid until the request is complete.
+    EXPECT_EQ("text/plain", web::http::find_http_header(parser.get_headers(), "content-type"));
+
+    // Content with a Content-Length is streamed as well.
+    parser.reset();
+    ASSERT_EQ(web::http::request_parser_result::headers_complete, parser.parse(as_bytes(post_request)));
+    const auto post_content = std::string_view{post_request}.substr(parser.consumed());
+    ASSERT_EQ(web::http::request_parser_result::content, parser.parse(as_bytes(post_content.substr(0, 4))));
+    EXPECT_EQ("{\"a\"", as_string(parser.get_content()));
+    ASSERT_EQ(web::http::request_parser_result::complete, parser.parse(as_bytes(post_content.substr(4))));
+    EXPECT_EQ(": true}", as_string(parser.get_content()));
+
+    parser.reset();
+    ASSERT_EQ(web::http::request_parser_result::complete, parser.parse(as_bytes(get_request)));
+}
+
+TEST(test_request_parser, parse_pipelined)
+{
+    const auto data = std::string{post_request} + std::string{get_request};
+    auto remaining = as_bytes(data);
+
+    web::http::request_parser parser;
+    ASSERT_EQ(web::http::request_parser_result::complete, parser.parse(remaining));
+    EXPECT_EQ(std::size(post_request), parser.consumed());
+    EXPECT_EQ(web::http::http_method::post, parser.get_method());
+
+    remaining = remaining.subspan(parser.consumed());
+    parser.reset();
+
+    ASSERT_EQ(web::http::request_parser_result::complete, parser.parse(remaining));
+    EXPECT_EQ(std::size(get_request), parser.consumed());
+    EXPECT_EQ(web::http::http_method::get, parser.get_method());
+    EXPECT_EQ("/index.html?a=1", parser.get_target());
+}
+
+TEST(test_request_parser, parse_split_with_trailing_data)
+{
+    const auto data = std::string{get_request} + "GET /next";
+    web::http::request_parser parser;
+
+    const std::string_view data_view{data};
+
+    ASSERT_EQ(web::http::request_parser_result::incomplete, parser.parse(as_bytes(data_view.substr(0, 20))));
+    ASSERT_EQ(web::http::request_parser_result::complete, parser.parse(as_bytes(data_view.substr(20))));
+    EXPECT_EQ(std::size(get_request) - 20, parser.consumed());
+    EXPECT_EQ("localhost", web::http::find_http_header(parser.get_headers(), "host"));
+}
+
+TEST(test_request_parser, bare_line_feeds)
+{
+    web::http::request_parser parser;
+    ASSERT_EQ(web::http::request_parser_result::complete,
+              parser.parse(as_bytes("\r\nGET / HTTP/1.1\nHost: localhost\n\n")));
+    EXPECT_EQ("/", parser.get_target());
+    EXPECT_EQ("localhost", web::http::find_http_header(parser.get_headers(), "host"));
+}
+
+TEST(test_request_parser, errors)
+{
+    using web::http::status_code;
+
+    EXPECT_EQ(status_code::bad_request, parse_error("GET /\r\n\r\n"));
+    EXPECT_EQ(status_code::bad_request, parse_error("GET / HTTP/1.1 extra\r\n\r\n"));
+    EXPECT_EQ(status_code::http_version_not_supported, parse_error("GET / HTTP/1.0\r\n\r\n"));
+    EXPECT_EQ(status_code::bad_request, parse_error("GET /<script> HTTP/1.1\r\n\r\n"));
+    EXPECT_EQ(status_code::method_not_allowed, parse_error("BREW / HTTP/1.1\r\n\r\n"));
+    EXPECT_EQ(status_code::bad_request, parse_error("GET / HTTP/1.1\r\nHost : localhost\r\n\r\n"));
+    EXPECT_EQ(status_code::bad_request, parse_error("GET / HTTP/1.1\r\nHost\r\n\r\n"));
+    EXPECT_EQ(status_code::bad_request, parse_error("GET / HTTP/1.1\r\nA: b\r\n folded\r\n\r\n"));
+    EXPECT_EQ(status_code::bad_request, parse_error("GET / HTTP/1.1\r\nA: b\x01\r\n\r\n"));
+    EXPECT_EQ(status_code::bad_request, parse_error("GET / HTTP/1.1\r\nA: b\rc\r\n\r\n"));
+    EXPECT_EQ(status_code::bad_request, parse_error("GET / HTTP/1.1\r\nContent-Length: -1\r\n\r\n"));
+    EXPECT_EQ(status_code::bad_request,
+              parse_error("GET / HTTP/1.1\r\nContent-Length: 1\r\nContent-Length: 2\r\n\r\n"));
+    EXPECT_EQ(status_code::not_implemented, parse_error("GET / HTTP/1.1\r\nTransfer-Encoding: gzip\r\n\r\n"));
+    EXPECT_EQ(status_code::not_implemented,
+              parse_error("GET / HTTP/1.1\r\nTransfer-Encoding: gzip, chunked\r\n\r\n"));
+    EXPECT_EQ(status_code::bad_request,
+              parse_error("POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\nContent-Length: 3\r\n\r\nabc"));
+    EXPECT_EQ(status_code::bad_request, parse_error("POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\nzz\r\n"));
+    EXPECT_EQ(status_code::bad_request,
+              parse_error("POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n3\r\nabcdef\r\n"));
+}
+
+TEST(test_request_parser, limits)
+{
+    using web::http::status_code;
+
+    web::http::request_parser parser{64, 16};
+    EXPECT_EQ(web::http::request_parser_result::error,
+              parser.parse(as_bytes("GET /" + std::string(100, 'a') + " HTTP/1.1\r\n\r\n")));
+    EXPECT_EQ(status_code::uri_too_long, parser.get_error());
+
+    parser.reset();
+    EXPECT_EQ(web::http::request_parser_result::error,
+              parser.parse(as_bytes("GET / HTTP/1.1\r\nA: " + std::string(100, 'a') + "\r\n\r\n")));
+    EXPECT_EQ(status_code::request_header_fields_too_large, parser.get_error());
+
+    parser.reset();
+    EXPECT_EQ(web::http::request_parser_result::error,
+              parser.parse(as_bytes("POST / HTTP/1.1\r\nContent-Length: 17\r\n\r\n")));
+    EXPECT_EQ(status_code::payload_too_large, parser.get_error());
+
+    parser.reset();
+    EXPECT_EQ(web::http::request_parser_result::error,
+              parser.parse(as_bytes("POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n11\r\n0123456789")));
+    EXPECT_EQ(status_code::payload_too_large, parser.get_error());
+
+    std::string many_headers = "GET / HTTP/1.1\r\n";
+
+    for (auto i = 0; i < 100; ++i)
+        many_headers += "A: b\r\n";
+
+    many_headers += "\r\n";
+
+    web::http::request_parser parser2;
+    EXPECT_EQ(web::http::request_parser_result::error, parser2.parse(as_bytes(many_headers)));
+    EXPECT_EQ(status_code::request_header_fields_too_large, parser2.get_error());
+
+    std::string many_trailers = "POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n0\r\n";
+
+    for (auto i = 0; i < 100; ++i)
+        many_trailers += "A: b\r\n";
+
+    parser.reset();
+    EXPECT_EQ(web::http::request_parser_result::error, parser.parse(as_bytes(many_trailers)));
+    EXPECT_EQ(status_code::request_header_fields_too_large, parser.get_error());
+
+    parser.reset();
+    EXPECT_EQ(web::http::request_parser_result::error,
+              parser.parse(as_bytes("POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n0\r\nA: " +
+                                    std::string(100, 'a'))));
+    EXPECT_EQ(status_code::request_header_fields_too_large, parser.get_error());
+}
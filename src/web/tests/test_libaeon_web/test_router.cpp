@@ -0,0 +1,296 @@
+// Distributed under the BSD 2-Clause License - Copyright 2012-2023 Robin Degen
+
+#include <aeon/web/http/router.h>
+#include <aeon/web/http/route.h>
+#include <aeon/web/http/routable_http_server_session.h>
+#include <gtest/gtest.h>
+#include <memory>
+#include <vector>
+#include <thread>
+
+using namespace aeon;
+
+namespace
+{
+
+class dummy_route final : public web::http::route
+{
+public:
+    using route::route;
+
+    void on_http_request([[maybe_unused]] web::http::http_server_socket &source,
+                         [[maybe_unused]] web::http::routable_http_server_session &session,
+                         [[maybe_unused]] const web::http::request &request) override
+    {
+    }
+};
+
+class tracked_route final : public web::http::route
+{
+public:
+    explicit tracked_route(const common::string &mount_point, bool &destroyed)
+        : route{mount_point}
+        , destroyed_{destroyed}
+    {
+    }
+
+    ~tracked_route() final
+    {
+        destroyed_ = true;
+    }
+
+    tracked_route(tracked_route &&) noexcept = delete;
+    auto operator=(tracked_route &&) noexcept -> tracked_route & = delete;
+
+    tracked_route(const tracked_route &) = delete;
+    auto operator=(const tracked_route &) -> tracked_route & = delete;
+
+    void on_http_request([[maybe_unused]] web::http::http_server_socket &source,
+                         [[maybe_unused]] web::http::routable_http_server_session &session,
+                         [[maybe_unused]] const web::http::request &request) override
+    {
+    }
+
+private:
+    bool &destroyed_;
+};
+
+class test_router : public ::testing::Test
+{
+public:
+    auto add(const char *mount_point, const std::optional<web::http::http_method> method = std::nullopt)
+        -> web::http::route *
+    {
+        routes_.push_back(std::make_unique<dummy_route>(mount_point));
+        EXPECT_TRUE(router_.insert(mount_point, method, routes_.back().get()));
+        return routes_.back().get();
+    }
+
+    [[nodiscard]] auto find(const std::string_view path,
+                            const web::http::http_method method = web::http::http_method::get) -> web::http::route *
+    {
+        if (!router_.find(path, method, match_))
+            return nullptr;
+
+        return match_.matched_route;
+    }
+
+protected:
+    web::http::router router_;
+    web::http::route_match match_;
+
+private:
+    std::vector<std::unique_ptr<dummy_route>> routes_;
+};
+
+} // namespace
+
+TEST_F(test_router, longest_prefix_match)
+{
+    const auto root = add("/");
+    const auto api = add("/api");
+    const auto api_v2 = add("/api/v2");
+    const auto apps = add("/apps");
+
+    EXPECT_EQ(root, find("/index.html"));
+    EXPECT_EQ("index.html", match_.remaining_path);
+
+    EXPECT_EQ(api, find("/api/test"));
+    EXPECT_EQ("/test", match_.remaining_path);
+
+    EXPECT_EQ(api_v2, find("/api/v2/test"));
+    EXPECT_EQ("/test", match_.remaining_path);
+
+    EXPECT_EQ(apps, find("/apps"));
+    EXPECT_EQ("", match_.remaining_path);
+
+    EXPECT_EQ(root, find("/ap"));
+    EXPECT_EQ(api, find("api"));
+}
+
+TEST_F(test_router, no_match)
+{
+    add("/api");
+    EXPECT_EQ(nullptr, find("/index.html"));
+    EXPECT_FALSE(match_.method_not_allowed);
+}
+
+TEST_F(test_router, path_parameters)
+{
+    const auto user = add("/users/:id");
+    const auto new_user = add("/users/new");
+    const auto post = add("/users/:id/posts/:post");
+
+    EXPECT_EQ(user, find("/users/42"));
+    ASSERT_EQ(1u, std::size(match_.get_parameters()));
+    EXPECT_EQ("id", match_.get_parameters()[0].name);
+    EXPECT_EQ("42", match_.get_parameters()[0].value);
+
+    EXPECT_EQ(user, find("/users/42/profile"));
+    EXPECT_EQ("/profile", match_.remaining_path);
+
+    EXPECT_EQ(new_user, find("/users/new"));
+    EXPECT_TRUE(std::empty(match_.get_parameters()));
+
+    EXPECT_EQ(post, find("/users/42/posts/7"));
+    ASSERT_EQ(2u, std::size(match_.get_parameters()));
+    EXPECT_EQ("post", match_.get_parameters()[1].name);
+    EXPECT_EQ("7", match_.get_parameters()[1].value);
+
+    // A parameter never matches an empty segment.
+    EXPECT_EQ(nullptr, find("/users/"));
+
+    // Mount points are prefixes, so the static route matches as well.
+    EXPECT_EQ(new_user, find("/users/new/posts/7"));
+    EXPECT_EQ("/posts/7", match_.remaining_path);
+}
+
+TEST_F(test_router, parameter_fallback)
+{
+    add("/files/static/readme");
+    const auto raw = add("/files/:name/raw");
+
+    // Static segments take precedence, but fall back to the parameter if they don't lead to a match.
+    EXPECT_EQ(raw, find("/files/static/raw"));
+    ASSERT_EQ(1u, std::size(match_.get_parameters()));
+    EXPECT_EQ("static", match_.get_parameters()[0].value);
+}
+
+TEST_F(test_router, methods)
+{
+    const auto get = add("/items", web::http::http_method::get);
+    const auto post = add("/items", web::http::http_method::post);
+
+    EXPECT_EQ(get, find("/items", web::http::http_method::get));
+    EXPECT_EQ(post, find("/items", web::http::http_method::post));
+
+    EXPECT_EQ(nullptr, find("/items", web::http::http_method::put));
+    EXPECT_TRUE(match_.method_not_allowed);
+
+    const auto any = add("/items");
+    EXPECT_EQ(any, find("/items", web::http::http_method::put));
+    EXPECT_EQ(get, find("/items", web::http::http_method::get));
+}
+
+TEST_F(test_router, method_fallback_to_shorter_prefix)
+{
+    const auto root = add("/");
+    const auto api = add("/api", web::http::http_method::post);
+
+    EXPECT_EQ(api, find("/api/x", web::http::http_method::post));
+    EXPECT_EQ("/x", match_.remaining_path);
+
+    // The POST only route does not accept GET, so the route on "/" is used, like for any other path below it.
+    EXPECT_EQ(root, find("/api/x", web::http::http_method::get));
+    EXPECT_FALSE(match_.method_not_allowed);
+    EXPECT_EQ("api/x", match_.remaining_path);
+}
+
+TEST_F(test_router, conflicts)
+{
+    add("/users/:id");
+    add("/users/:id", web::http::http_method::get);
+
+    dummy_route route{"/users/:name"};
+    EXPECT_FALSE(router_.insert("/users/:name", std::nullopt, &route));
+    EXPECT_FALSE(router_.insert("/users/:id", std::nullopt, &route));
+}
+
+TEST_F(test_router, erase)
+{
+    const auto root = add("/");
+    add("/api");
+    add("/api", web::http::http_method::post);
+
+    router_.erase("/api");
+    EXPECT_EQ(root, find("/api/test"));
+    EXPECT_EQ(root, find("/api/test", web::http::http_method::post));
+}
+
+TEST_F(test_router, split_nodes)
+{
+    const auto test = add("/test");
+    const auto team = add("/team");
+    const auto te = add("/te");
+    const auto toast = add("/toast");
+
+    EXPECT_EQ(test, find("/test"));
+    EXPECT_EQ(team, find("/team"));
+    EXPECT_EQ(te, find("/tea"));
+    EXPECT_EQ("a", match_.remaining_path);
+    EXPECT_EQ(toast, find("/toast/x"));
+    EXPECT_EQ(nullptr, find("/t"));
+}
+
+TEST(test_routable_http_server_session, removed_route_lives_while_matched)
+{
+    web::http::routable_http_server_session session;
+    auto destroyed = false;
+    ASSERT_TRUE(session.add_route(std::make_unique<tracked_route>("/api", destroyed)));
+
+    {
+        web::http::route_match match;
+        ASSERT_TRUE(session.find_route("/api/x", web::http::http_method::get, match));
+
+        session.remove_route("/api");
+        EXPECT_FALSE(destroyed);
+
+        web::http::route_match other;
+        EXPECT_FALSE(session.find_route("/api/x", web::http::http_method::get, other));
+    }
+
+    // The last match that referred to the old routes is gone.
+    EXPECT_TRUE(destroyed);
+}
+
+TEST(test_routable_http_server_session, best_match_route_keeps_the_route_alive)
+{
+    web::http::routable_http_server_session session;
+    auto destroyed = false;
+    ASSERT_TRUE(session.add_route(std::make_unique<tracked_route>("/api", destroyed)));
+
+    common::string route_path;
+    auto route = session.find_best_match_route("/api/x", route_path);
+    ASSERT_NE(nullptr, route);
+    EXPECT_EQ("/x", route_path);
+
+    session.remove_route("/api");
+    EXPECT_EQ(nullptr, session.find_best_match_route("/api/x", route_path));
+    EXPECT_FALSE(destroyed);
+
+    route.reset();
+    EXPECT_TRUE(destroyed);
+}
+
+TEST(test_routable_http_server_session, route_changes_are_seen_by_other_threads)
+{
+    web::http::routable_http_server_session session;
+    auto destroyed = false;
+    ASSERT_TRUE(session.add_route(std::make_unique<tracked_route>("/api", destroyed)));
+
+    const auto find_on_thread = [&session]
+    {
+        auto found = false;
+        std::thread thread{[&session, &found]
+                           {
+                               web::http::route_match match;
+                               found = session.find_route("/api/x", web::http::http_method::get, match);
+                           }};
+        thread.join();
+        return found;
+    };
+
+    EXPECT_TRUE(find_on_thread());
+
+    web::http::route_match match;
+    EXPECT_TRUE(session.find_route("/api/x", web::http::http_method::get, match));
+
+    session.remove_route("/api");
+    EXPECT_FALSE(find_on_thread());
+
+    // The table that still holds the route is only referred to by the match and the cache of this thread.
+    match = web::http::route_match{};
+    EXPECT_FALSE(destroyed);
+    EXPECT_FALSE(session.find_route("/api/x", web::http::http_method::get, match));
+    EXPECT_TRUE(destroyed);
+}
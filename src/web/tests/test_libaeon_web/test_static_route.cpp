@@ -0,0 +1,242 @@
+// Distributed under the BSD 2-Clause License - Copyright 2012-2023 Robin Degen
+
+#include <aeon/web/http/routable_http_server.h>
+#include <aeon/web/http/static_route.h>
+#include <gtest/gtest.h>
+#include <asio.hpp>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+#include <string>
+
+using namespace aeon;
+
+namespace
+{
+
+constexpr std::uint16_t test_port = 38273;
+
+const std::string small_file_content = "Hello world";
+
+void write_file(const std::filesystem::path &path, const std::string &content)
+{
+    std::ofstream stream{path, std::ios::binary};
+    stream << content;
+}
+
+[[nodiscard]] auto make_large_file_content() -> std::string
+{
+    std::string content(400 * 1024, '\0');
+
+    for (std::size_t i = 0; i < std::size(content); ++i)
+        content[i] = static_cast<char>('a' + (i * 7) % 26);
+
+    return content;
+}
+
+[[nodiscard]] auto make_script_content() -> std::string
+{
+    std::string content;
+
+    for (auto i = 0; i < 100; ++i)
+        content += "console.log(" + std::to_string(i) + ");\n";
+
+    return content;
+}
+
+class test_static_route : public ::testing::Test
+{
+public:
+    void SetUp() override
+    {
+        path_ = std::filesystem::temp_directory_path() / "aeon_test_static_route";
+        std::filesystem::remove_all(path_);
+        std::filesystem::create_directories(path_);
+
+        write_file(path_ / "small.txt", small_file_content);
+        write_file(path_ / "large.bin", make_large_file_content());
+        write_file(path_ / "page.html", "<html></html>");
+        write_file(path_ / "page.html.gz", "compressed");
+        write_file(path_ / "script.js", make_script_content());
+
+        server_ = std::make_unique<web::http::routable_http_server>(context_, test_port);
+        web::http::static_route_settings settings;
+        settings.compression.enabled = true;
+        server_->get_session().add_route(std::make_unique<web::http::static_route>("/", path_, settings));
+        thread_ = std::thread{[this]() { context_.run(); }};
+    }
+
+    void TearDown() override
+    {
+        context_.stop();
+        thread_.join();
+        server_.reset();
+        std::filesystem::remove_all(path_);
+    }
+
+    /*!
+     * Send a single request and read the reply until the server closes the connection.
+     */
+    [[nodiscard]] static auto request(const std::string &method, const std::string &uri,
+                                      const std::string &headers = "") -> std::string
+    {
+        asio::io_context context;
+        asio::ip::tcp::socket socket{context};
+        socket.connect(asio::ip::tcp::endpoint{asio::ip::address_v4::loopback(), test_port});
+
+        const auto data = method + " " + uri + " HTTP/1.1\r\nConnection: close\r\n" + headers + "\r\n";
+        asio::write(socket, asio::buffer(data));
+
+        std::string result;
+        asio::error_code ec;
+        asio::read(socket, asio::dynamic_buffer(result), ec);
+        return result;
+    }
+
+    [[nodiscard]] static auto get_header(const std::string &response, const std::string &name) -> std::string
+    {
+        const auto offset = response.find("\r\n" + name + ": ");
+
+        if (offset == std::string::npos)
+            return {};
+
+        const auto value_offset = offset + std::size(name) + 4;
+        return response.substr(value_offset, response.find("\r\n", value_offset) - value_offset);
+    }
+
+    [[nodiscard]] static auto get_content(const std::string &response) -> std::string
+    {
+        return response.substr(response.find("\r\n\r\n") + 4);
+    }
+
+private:
+    std::filesystem::path path_;
+    asio::io_context context_;
+    std::unique_ptr<web::http::routable_http_server> server_;
+    std::thread thread_;
+};
+
+} // namespace
+
+TEST_F(test_static_route, small_file)
+{
+    const auto response = request("GET", "/small.txt");
+    EXPECT_EQ(0u, response.find("HTTP/1.1 200"));
+    EXPECT_EQ("11", get_header(response, "Content-Length"));
+    EXPECT_EQ("bytes", get_header(response, "Accept-Ranges"));
+    EXPECT_FALSE(std::empty(get_header(response, "ETag")));
+    EXPECT_TRUE(get_header(response, "Last-Modified").ends_with(" GMT"));
+    EXPECT_EQ(small_file_content, get_content(response));
+
+    // The second request is served from the cache.
+    EXPECT_EQ(response, request("GET", "/small.txt"));
+}
+
+TEST_F(test_static_route, large_file)
+{
+    const auto response = request("GET", "/large.bin");
+    EXPECT_EQ(0u, response.find("HTTP/1.1 200"));
+    EXPECT_EQ(make_large_file_content(), get_content(response));
+}
+
+TEST_F(test_static_route, head)
+{
+    const auto response = request("HEAD", "/small.txt");
+    EXPECT_EQ(0u, response.find("HTTP/1.1 200"));
+    EXPECT_EQ("11", get_header(response, "Content-Length"));
+    EXPECT_TRUE(std::empty(get_content(response)));
+}
+
+TEST_F(test_static_route, not_modified)
+{
+    const auto response = request("GET", "/small.txt");
+    const auto etag = get_header(response, "ETag");
+    const auto last_modified = get_header(response, "Last-Modified");
+
+    const auto etag_response = request("GET", "/small.txt", "If-None-Match: " + etag + "\r\n");
+    EXPECT_EQ(0u, etag_response.find("HTTP/1.1 304"));
+    EXPECT_EQ(etag, get_header(etag_response, "ETag"));
+    EXPECT_TRUE(std::empty(get_content(etag_response)));
+
+    const auto date_response = request("GET", "/small.txt", "If-Modified-Since: " + last_modified + "\r\n");
+    EXPECT_EQ(0u, date_response.find("HTTP/1.1 304"));
+
+    const auto changed_response = request("GET", "/small.txt", "If-None-Match: \"other\"\r\n");
+    EXPECT_EQ(0u, changed_response.find("HTTP/1.1 200"));
+}
+
+TEST_F(test_static_route, ranges)
+{
+    const auto response = request("GET", "/small.txt", "Range: bytes=2-4\r\n");
+    EXPECT_EQ(0u, response.find("HTTP/1.1 206"));
+    EXPECT_EQ("bytes 2-4/11", get_header(response, "Content-Range"));
+    EXPECT_EQ("llo", get_content(response));
+
+    EXPECT_EQ("world", get_content(request("GET", "/small.txt", "Range: bytes=-5\r\n")));
+    EXPECT_EQ("world", get_content(request("GET", "/small.txt", "Range: bytes=6-\r\n")));
+    EXPECT_EQ("world", get_content(request("GET", "/small.txt", "Range: bytes=6-100\r\n")));
+
+    const auto not_satisfiable = request("GET", "/small.txt", "Range: bytes=20-\r\n");
+    EXPECT_EQ(0u, not_satisfiable.find("HTTP/1.1 416"));
+    EXPECT_EQ("bytes */11", get_header(not_satisfiable, "Content-Range"));
+
+    // Multiple ranges are not supported; the entire file is sent instead.
+    EXPECT_EQ(small_file_content, get_content(request("GET", "/small.txt", "Range: bytes=0-1,4-5\r\n")));
+
+    // The file was changed since the client received the first part.
+    EXPECT_EQ(small_file_content,
+              get_content(request("GET", "/small.txt", "Range: bytes=2-4\r\nIf-Range: \"other\"\r\n")));
+
+    const auto large_response = request("GET", "/large.bin", "Range: bytes=100000-100099\r\n");
+    EXPECT_EQ(0u, large_response.find("HTTP/1.1 206"));
+    EXPECT_EQ(make_large_file_content().substr(100000, 100), get_content(large_response));
+}
+
+TEST_F(test_static_route, precompressed)
+{
+    const auto response = request("GET", "/page.html", "Accept-Encoding: deflate, gzip\r\n");
+    EXPECT_EQ(0u, response.find("HTTP/1.1 200"));
+    EXPECT_EQ("gzip", get_header(response, "Content-Encoding"));
+    EXPECT_EQ("Accept-Encoding", get_header(response, "Vary"));
+    EXPECT_EQ("compressed", get_content(response));
+
+    const auto identity_response = request("GET", "/page.html");
+    EXPECT_TRUE(std::empty(get_header(identity_response, "Content-Encoding")));
+    EXPECT_EQ("Accept-Encoding", get_header(identity_response, "Vary"));
+    EXPECT_EQ("<html></html>", get_content(identity_response));
+
+    const auto refused_response = request("GET", "/page.html", "Accept-Encoding: gzip;q=0\r\n");
+    EXPECT_EQ("<html></html>", get_content(refused_response));
+}
+
+TEST_F(test_static_route, compressed)
+{
+    // The first reply is not compressed; the file is compressed in the background.
+    const auto response = request("GET", "/script.js", "Accept-Encoding: gzip\r\n");
+    EXPECT_EQ(make_script_content(), get_content(response));
+    EXPECT_EQ("Accept-Encoding", get_header(response, "Vary"));
+
+    std::string compressed_response;
+
+    for (auto i = 0; i < 100 && std::empty(get_header(compressed_response, "Content-Encoding")); ++i)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds{10});
+        compressed_response = request("GET", "/script.js", "Accept-Encoding: gzip\r\n");
+    }
+
+    EXPECT_EQ("gzip", get_header(compressed_response, "Content-Encoding"));
+    EXPECT_LT(std::size(get_content(compressed_response)), std::size(make_script_content()));
+    EXPECT_NE(get_header(response, "ETag"), get_header(compressed_response, "ETag"));
+
+    const auto content = get_content(compressed_response);
+    ASSERT_GT(std::size(content), 2u);
+    EXPECT_EQ('\x1f', content[0]);
+    EXPECT_EQ('\x8b', content[1]);
+
+    // Clients that do not accept gzip still get the file as is.
+    EXPECT_EQ(make_script_content(), get_content(request("GET", "/script.js")));
+
+    // Already compressed content is not compressed again.
+    const auto image_response = request("GET", "/large.bin", "Accept-Encoding: gzip\r\n");
+    EXPECT_TRUE(std::empty(get_header(image_response, "Content-Encoding")));
+}